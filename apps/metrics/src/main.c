@@ -62,6 +62,19 @@ METRICS_EVENT_DECLARE(my_event, my_metrics);
 /* Sample event */
 struct my_event g_event;
 
+/*
+ * Periodic event, logged once per second in batches of SAMPLE_BATCH events
+ * per log entry. Each event holds SAMPLE_SERIES_LEN readings of a slowly
+ * changing value along with their timestamps, which encode to about a byte
+ * per value with METRICS_SERIES_DOD.
+ */
+#define SAMPLE_SERIES_LEN   20
+#define SAMPLE_BATCH        8
+
+struct my_event g_sample_event;
+static struct os_callout g_sample_callout;
+static uint32_t g_sample_cnt;
+
 /* Target log instance */
 static struct log g_log;
 static struct fcb_log g_log_fcb;
@@ -96,6 +109,32 @@ init_log_instance(void)
                  LOG_SYSLEVEL);
 }
 
+static void
+sample_cb(struct os_event *ev)
+{
+    uint32_t val;
+    uint32_t ts;
+    int i;
+
+    ts = os_cputime_get32();
+
+    metrics_event_start(&g_sample_event.hdr, ts);
+    metrics_set_value(&g_sample_event.hdr, MY_METRIC_VAL_U, g_sample_cnt);
+
+    for (i = 0; i < SAMPLE_SERIES_LEN; i++) {
+        /* Simulated reading: slow drift with a bit of noise */
+        val = 2150 + g_sample_cnt / 60 + (i * 7 + g_sample_cnt) % 3 - 1;
+        metrics_set_value(&g_sample_event.hdr, MY_METRIC_VAL_SS16, val);
+        metrics_set_value(&g_sample_event.hdr, MY_METRIC_VAL_SU32,
+                          ts + os_cputime_usecs_to_ticks(i * 50000));
+    }
+
+    metrics_event_end(&g_sample_event.hdr);
+    g_sample_cnt++;
+
+    os_callout_reset(&g_sample_callout, OS_TICKS_PER_SEC);
+}
+
 int
 main(void)
 {
@@ -141,6 +180,16 @@ main(void)
         metrics_set_value(&g_event.hdr, MY_METRIC_VAL_SS32, -i);
     }
 
+    metrics_event_init(&g_sample_event.hdr, my_metrics,
+                       METRICS_SECT_COUNT(my_metrics), "sample");
+    metrics_event_register(&g_sample_event.hdr);
+    metrics_event_set_log(&g_sample_event.hdr, &g_log, LOG_MODULE_DEFAULT,
+                          LOG_LEVEL_INFO);
+    metrics_event_set_batch(&g_sample_event.hdr, SAMPLE_BATCH);
+
+    os_callout_init(&g_sample_callout, os_eventq_dflt_get(), sample_cb, NULL);
+    os_callout_reset(&g_sample_callout, OS_TICKS_PER_SEC);
+
     /*
      * event state can be dumped via shell:
      *   select metrics
@@ -164,13 +164,14 @@ boot_status_sz(uint8_t min_write_sz)
 uint32_t
 boot_trailer_sz(uint8_t min_write_sz)
 {
-    return sizeof boot_img_magic            +
+    return BOOT_HASH_CACHE_SZ               +
+           sizeof boot_img_magic            +
            boot_status_sz(min_write_sz)     +
            min_write_sz * 2;
 }
 
 static uint32_t
-boot_magic_off(const struct flash_area *fap)
+boot_hash_cache_off(const struct flash_area *fap)
 {
     uint32_t off_from_end;
     uint8_t elem_sz;
@@ -183,6 +184,12 @@ boot_magic_off(const struct flash_area *fap)
     return fap->fa_size - off_from_end;
 }
 
+static uint32_t
+boot_magic_off(const struct flash_area *fap)
+{
+    return boot_hash_cache_off(fap) + BOOT_HASH_CACHE_SZ;
+}
+
 uint32_t
 boot_status_off(const struct flash_area *fap)
 {
@@ -346,6 +353,60 @@ boot_write_image_ok(const struct flash_area *fap)
     return 0;
 }
 
+#if MYNEWT_VAL(BOOTUTIL_HASH_CACHE)
+int
+boot_read_hash_cache(const struct flash_area *fap,
+                     struct boot_hash_cache *cache)
+{
+    int rc;
+
+    rc = flash_area_read(fap, boot_hash_cache_off(fap), cache, sizeof *cache);
+    if (rc != 0) {
+        return BOOT_EFLASH;
+    }
+
+    return 0;
+}
+
+int
+boot_write_hash_cache(const struct flash_area *fap,
+                      const struct boot_hash_cache *cache)
+{
+    struct boot_hash_cache stored;
+    uint32_t off;
+    int rc;
+
+    /* The record can only be programmed at an aligned offset. */
+    if (BOOT_HASH_CACHE_SZ % flash_area_align(fap) != 0) {
+        return BOOT_EBADARGS;
+    }
+
+    /* Program and check the hash before the size and verdict, so a failed
+     * or interrupted write never leaves a verdict next to a wrong hash.
+     */
+    off = boot_hash_cache_off(fap);
+    rc = flash_area_write(fap, off, cache->bhc_hash, sizeof cache->bhc_hash);
+    if (rc != 0) {
+        return BOOT_EFLASH;
+    }
+
+    rc = flash_area_read(fap, off, &stored, sizeof stored);
+    if (rc != 0 ||
+        memcmp(stored.bhc_hash, cache->bhc_hash, sizeof stored.bhc_hash)) {
+        return BOOT_EFLASH;
+    }
+
+    rc = flash_area_write(fap, off + sizeof cache->bhc_hash,
+                          &cache->bhc_size,
+                          sizeof *cache - sizeof cache->bhc_hash);
+    if (rc != 0) {
+        return BOOT_EFLASH;
+    }
+
+    return 0;
+}
+#endif
+
 int
 boot_swap_type(void)
 {
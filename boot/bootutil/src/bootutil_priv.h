@@ -37,7 +37,7 @@ struct flash_area;
 #define BOOT_ENOMEM     6
 #define BOOT_EBADARGS   7
 
-#define BOOT_TMPBUF_SZ  256
+#define BOOT_TMPBUF_SZ  MYNEWT_VAL(BOOTUTIL_HASH_BUF_SIZE)
 
 /*
  * Maintain state of copy progress.
@@ -57,6 +57,8 @@ struct boot_status {
  *  0                   1                   2                   3
  *  0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
  * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * ~          Hash cache (40 octets, BOOTUTIL_HASH_CACHE only)     ~
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
  * ~                        MAGIC (16 octets)                      ~
  * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
  * ~                                                               ~
@@ -77,6 +79,25 @@ struct boot_swap_state {
     uint8_t image_ok;
 };
 
+/**
+ * Result of the last full validation of the image in the slot.  Written
+ * once, the record is only erased along with the trailer.
+ */
+struct boot_hash_cache {
+    uint8_t bhc_hash[32];   /* Computed image hash */
+    uint32_t bhc_size;      /* Header + image + TLV size of the image */
+    uint8_t bhc_verdict;    /* BOOT_HASH_CACHE_VALID, 0xff if unset */
+    uint8_t _pad[3];
+};
+
+#define BOOT_HASH_CACHE_VALID   0x01
+
+#if MYNEWT_VAL(BOOTUTIL_HASH_CACHE)
+#define BOOT_HASH_CACHE_SZ      (sizeof(struct boot_hash_cache))
+#else
+#define BOOT_HASH_CACHE_SZ      0
+#endif
+
 #define BOOT_STATUS_STATE_COUNT 3
 #define BOOT_STATUS_MAX_ENTRIES 128
 
@@ -98,6 +119,16 @@ int boot_write_status(struct boot_status *bs);
 int boot_schedule_test_swap(void);
 int boot_write_copy_done(const struct flash_area *fap);
 int boot_write_image_ok(const struct flash_area *fap);
+int boot_read_hash_cache(const struct flash_area *fap,
+                         struct boot_hash_cache *cache);
+int boot_write_hash_cache(const struct flash_area *fap,
+                          const struct boot_hash_cache *cache);
+
+int bootutil_img_read_hash(struct image_header *hdr,
+                           const struct flash_area *fap, uint8_t *hash);
+int bootutil_img_validate_cached(struct image_header *hdr,
+                                 const struct flash_area *fap,
+                                 uint8_t *tmp_buf, uint32_t tmp_buf_sz);
 
 uint32_t boot_status_sz(uint8_t min_write_sz);
 
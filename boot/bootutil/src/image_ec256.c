@@ -27,9 +27,11 @@
 #include "mbedtls/oid.h"
 #include "mbedtls/asn1.h"
 
-#include "tinycrypt/ecc_dsa.h"
+#include "crypto/crypto.h"
 #include "bootutil_priv.h"
 
+#define NUM_ECC_BYTES   (CRYPTO_P256_PUB_LEN / 2)
+
 /*
  * Declaring these like this adds NULL termination.
  */
@@ -40,7 +42,7 @@ static const uint8_t ec_secp256r1_oid[] = MBEDTLS_OID_EC_GRP_SECP256R1;
  * Parse the public key used for signing.
  */
 static int
-tinycrypt_import_key(uint8_t *pubkey, uint8_t *cp, uint8_t *end)
+ec256_import_key(uint8_t *pubkey, uint8_t *cp, uint8_t *end)
 {
     size_t len;
     mbedtls_asn1_buf alg;
@@ -88,7 +90,7 @@ tinycrypt_import_key(uint8_t *pubkey, uint8_t *cp, uint8_t *end)
  * Verify the tag, and that the length is 32 bytes.
  */
 static int
-tinycrypt_read_bigint(uint8_t i[NUM_ECC_BYTES], uint8_t **cp, uint8_t *end)
+ec256_read_bigint(uint8_t i[NUM_ECC_BYTES], uint8_t **cp, uint8_t *end)
 {
     size_t len;
 
@@ -110,7 +112,7 @@ tinycrypt_read_bigint(uint8_t i[NUM_ECC_BYTES], uint8_t **cp, uint8_t *end)
  * Read in signature. Signature has r and s encoded as integers.
  */
 static int
-tinycrypt_decode_sig(uint8_t signature[NUM_ECC_BYTES * 2], uint8_t *cp, uint8_t *end)
+ec256_decode_sig(uint8_t signature[NUM_ECC_BYTES * 2], uint8_t *cp, uint8_t *end)
 {
     int rc;
     size_t len;
@@ -124,11 +126,11 @@ tinycrypt_decode_sig(uint8_t signature[NUM_ECC_BYTES * 2], uint8_t *cp, uint8_t
         return -2;
     }
 
-    rc = tinycrypt_read_bigint(signature, &cp, end);
+    rc = ec256_read_bigint(signature, &cp, end);
     if (rc) {
         return -3;
     }
-    rc = tinycrypt_read_bigint(signature + NUM_ECC_BYTES, &cp, end);
+    rc = ec256_read_bigint(signature + NUM_ECC_BYTES, &cp, end);
     if (rc) {
         return -4;
     }
@@ -149,12 +151,12 @@ bootutil_verify_sig(uint8_t *hash, uint32_t hlen, uint8_t *sig, int slen,
     cp = (uint8_t *)bootutil_keys[key_id].key;
     end = cp + *bootutil_keys[key_id].len;
 
-    rc = tinycrypt_import_key(public_key, cp, end);
+    rc = ec256_import_key(public_key, cp, end);
     if (rc) {
         return -1;
     }
 
-    rc = tinycrypt_decode_sig(signature, sig, sig + slen);
+    rc = ec256_decode_sig(signature, sig, sig + slen);
     if (rc) {
         return -1;
     }
@@ -166,8 +168,8 @@ bootutil_verify_sig(uint8_t *hash, uint32_t hlen, uint8_t *sig, int slen,
         return -1;
     }
 
-    rc = uECC_verify(public_key, hash, NUM_ECC_BYTES, signature, uECC_secp256r1());
-    if (rc == 1) {
+    rc = crypto_p256_verify(public_key, hash, signature);
+    if (rc == 0) {
         return 0;
     } else {
         return -2;
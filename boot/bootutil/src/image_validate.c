@@ -29,7 +29,7 @@
 #include "bootutil/image.h"
 #include "bootutil/sign_key.h"
 
-#include "mbedtls/sha256.h"
+#include "crypto/crypto.h"
 #include "mbedtls/rsa.h"
 #include "mbedtls/ecdsa.h"
 #include "mbedtls/asn1.h"
@@ -44,19 +44,21 @@ bootutil_img_hash(struct image_header *hdr, const struct flash_area *fap,
                   uint8_t *tmp_buf, uint32_t tmp_buf_sz,
                   uint8_t *hash_result, uint8_t *seed, int seed_len)
 {
-    mbedtls_sha256_context sha256_ctx;
+    struct crypto_sha256_ctx sha256_ctx;
     uint32_t blk_sz;
     uint32_t size;
     uint32_t off;
     int rc;
 
-    mbedtls_sha256_init(&sha256_ctx);
-    mbedtls_sha256_starts(&sha256_ctx, 0);
+    rc = crypto_sha256_start(&sha256_ctx);
+    if (rc) {
+        return rc;
+    }
 
     /* in some cases (split image) the hash is seeded with data from
      * the loader image */
     if(seed && (seed_len > 0)) {
-        mbedtls_sha256_update(&sha256_ctx, seed, seed_len);
+        crypto_sha256_update(&sha256_ctx, seed, seed_len);
     }
 
     size = hdr->ih_img_size + hdr->ih_hdr_size;
@@ -78,11 +80,10 @@ bootutil_img_hash(struct image_header *hdr, const struct flash_area *fap,
         if (rc) {
             return rc;
         }
-        mbedtls_sha256_update(&sha256_ctx, tmp_buf, blk_sz);
+        crypto_sha256_update(&sha256_ctx, tmp_buf, blk_sz);
     }
-    mbedtls_sha256_finish(&sha256_ctx, hash_result);
 
-    return 0;
+    return crypto_sha256_finish(&sha256_ctx, hash_result);
 }
 
 /*
@@ -218,3 +219,113 @@ bootutil_img_validate(struct image_header *hdr, const struct flash_area *fap,
 #endif
     return 0;
 }
+
+/*
+ * Read the value of the SHA256 TLV of the image.
+ */
+int
+bootutil_img_read_hash(struct image_header *hdr, const struct flash_area *fap,
+                       uint8_t *hash)
+{
+    struct image_tlv tlv;
+    uint32_t off;
+    uint32_t size;
+    int rc;
+
+    off = hdr->ih_img_size + hdr->ih_hdr_size;
+    size = off + hdr->ih_tlv_size;
+
+    for (; off < size; off += sizeof(tlv) + tlv.it_len) {
+        rc = flash_area_read(fap, off, &tlv, sizeof tlv);
+        if (rc) {
+            return rc;
+        }
+        if (tlv.it_type == IMAGE_TLV_SHA256) {
+            if (tlv.it_len != 32) {
+                return -1;
+            }
+            return flash_area_read(fap, off + sizeof(tlv), hash, 32);
+        }
+    }
+
+    return -1;
+}
+
+#if MYNEWT_VAL(BOOTUTIL_HASH_CACHE)
+static int
+bootutil_buffer_is_erased(const void *buf, int len)
+{
+    const uint8_t *u8p;
+    int i;
+
+    u8p = buf;
+    for (i = 0; i < len; i++) {
+        if (u8p[i] != 0xff) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/*
+ * Verify the integrity of the image, trusting the verdict recorded in the
+ * trailer if it was reached for an image with the same hash TLV.  After a
+ * full validation the verdict is recorded, if the trailer record is unset.
+ *
+ * The image body is not read once a verdict is recorded: this is
+ * trust-on-first-boot, and only holds if the slot is never written other
+ * than through a swap, which erases the record.
+ *
+ * Return non-zero if image could not be validated/does not validate.
+ */
+int
+bootutil_img_validate_cached(struct image_header *hdr,
+                             const struct flash_area *fap,
+                             uint8_t *tmp_buf, uint32_t tmp_buf_sz)
+{
+    struct boot_hash_cache cache;
+    uint8_t hash[32];
+    uint32_t size;
+    int rc;
+
+    size = hdr->ih_hdr_size + hdr->ih_img_size + hdr->ih_tlv_size;
+
+    rc = boot_read_hash_cache(fap, &cache);
+    if (rc) {
+        return rc;
+    }
+
+    if (cache.bhc_verdict == BOOT_HASH_CACHE_VALID && cache.bhc_size == size &&
+        (hdr->ih_flags & IMAGE_F_SHA256) &&
+        bootutil_img_read_hash(hdr, fap, hash) == 0 &&
+        memcmp(hash, cache.bhc_hash, sizeof hash) == 0) {
+
+        return 0;
+    }
+
+    rc = bootutil_img_validate(hdr, fap, tmp_buf, tmp_buf_sz, NULL, 0, hash);
+    if (rc) {
+        return rc;
+    }
+
+    if (BOOT_HASH_CACHE_SZ % flash_area_align(fap) == 0 &&
+        bootutil_buffer_is_erased(&cache, sizeof cache)) {
+
+        memcpy(cache.bhc_hash, hash, sizeof hash);
+        cache.bhc_size = size;
+        cache.bhc_verdict = BOOT_HASH_CACHE_VALID;
+
+        rc = boot_write_hash_cache(fap, &cache);
+        if (rc != 0) {
+            /* The image itself is good.  The verdict is only written after
+             * the hash was read back intact, so the record cannot vouch for
+             * other contents; the next boots just hash the image again.
+             */
+            return 0;
+        }
+    }
+
+    return 0;
+}
+#endif
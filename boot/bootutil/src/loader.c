@@ -524,6 +524,17 @@ boot_image_check(struct image_header *hdr, const struct flash_area *fap)
             return BOOT_ENOMEM;
         }
     }
+#if MYNEWT_VAL(BOOTUTIL_HASH_CACHE)
+    /* Trust-on-first-boot: this assumes slot 0 only changes through a
+     * swap, which erases the trailer along with the recorded verdict.
+     */
+    if (fap->fa_id == FLASH_AREA_IMAGE_0) {
+        if (bootutil_img_validate_cached(hdr, fap, tmpbuf, BOOT_TMPBUF_SZ)) {
+            return BOOT_EBADIMAGE;
+        }
+        return 0;
+    }
+#endif
     if (bootutil_img_validate(hdr, fap, tmpbuf, BOOT_TMPBUF_SZ,
                               NULL, 0, NULL)) {
         return BOOT_EBADIMAGE;
@@ -0,0 +1,106 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "hash_cache_test.h"
+
+TEST_CASE(boot_test_hash_cache)
+{
+    struct image_header hdr = {
+        .ih_magic = IMAGE_MAGIC,
+        .ih_tlv_size = 4 + 32,
+        .ih_hdr_size = BOOT_TEST_HEADER_SIZE,
+        .ih_img_size = 12 * 1024,
+        .ih_flags = IMAGE_F_SHA256,
+        .ih_ver = { 0, 2, 3, 4 },
+    };
+    struct boot_hash_cache cache;
+    struct boot_hash_cache bogus;
+    const struct flash_area *fap;
+    uint8_t buf[BOOT_TMPBUF_SZ];
+    uint8_t hash[32];
+    int rc;
+
+    boot_test_util_init_flash();
+    boot_test_util_write_image(&hdr, 0);
+    boot_test_util_write_hash(&hdr, 0);
+
+    rc = flash_area_open(FLASH_AREA_IMAGE_0, &fap);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /*** First validation hashes the image and records the verdict. */
+    rc = boot_read_hash_cache(fap, &cache);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(cache.bhc_verdict == 0xff);
+
+    rc = bootutil_img_validate_cached(&hdr, fap, buf, sizeof buf);
+    TEST_ASSERT(rc == 0);
+
+    rc = bootutil_img_read_hash(&hdr, fap, hash);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = boot_read_hash_cache(fap, &cache);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(cache.bhc_verdict == BOOT_HASH_CACHE_VALID);
+    TEST_ASSERT(cache.bhc_size == hdr.ih_hdr_size + hdr.ih_img_size +
+                                  hdr.ih_tlv_size);
+    TEST_ASSERT(memcmp(cache.bhc_hash, hash, sizeof hash) == 0);
+
+    /***
+     * Change the image body behind the bootloader's back; the recorded
+     * verdict is trusted, a full validation catches it.
+     */
+    rc = flash_native_memset(boot_test_img_addrs[0].address +
+                             hdr.ih_hdr_size + 100, 0x5a, 1);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = bootutil_img_validate_cached(&hdr, fap, buf, sizeof buf);
+    TEST_ASSERT(rc == 0);
+    rc = bootutil_img_validate(&hdr, fap, buf, sizeof buf, NULL, 0, NULL);
+    TEST_ASSERT(rc != 0);
+
+    /***
+     * A record left by a different image is ignored, and not replaced.
+     */
+    boot_test_util_init_flash();
+
+    memset(&bogus, 0xff, sizeof bogus);
+    memset(bogus.bhc_hash, 0xa5, sizeof bogus.bhc_hash);
+    bogus.bhc_size = hdr.ih_hdr_size + hdr.ih_img_size + hdr.ih_tlv_size;
+    bogus.bhc_verdict = BOOT_HASH_CACHE_VALID;
+    rc = boot_write_hash_cache(fap, &bogus);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    boot_test_util_write_image(&hdr, 0);
+    boot_test_util_write_hash(&hdr, 0);
+
+    rc = bootutil_img_validate_cached(&hdr, fap, buf, sizeof buf);
+    TEST_ASSERT(rc == 0);
+
+    rc = boot_read_hash_cache(fap, &cache);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(memcmp(&cache, &bogus, sizeof cache) == 0);
+
+    /* Invalid image, stale record; still rejected. */
+    rc = flash_native_memset(boot_test_img_addrs[0].address +
+                             hdr.ih_hdr_size + 100, 0x5a, 1);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = bootutil_img_validate_cached(&hdr, fap, buf, sizeof buf);
+    TEST_ASSERT(rc != 0);
+
+    flash_area_close(fap);
+}
@@ -0,0 +1,80 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "hash_cache_test.h"
+
+/*
+ * Times slot 0 validation of a large image: hashed through the old 256 byte
+ * buffer, through the BOOTUTIL_HASH_BUF_SIZE buffer, and with the verdict
+ * recorded in the trailer.
+ */
+TEST_CASE(boot_test_hash_cache_bench)
+{
+    struct image_header hdr = {
+        .ih_magic = IMAGE_MAGIC,
+        .ih_tlv_size = 4 + 32,
+        .ih_hdr_size = BOOT_TEST_HEADER_SIZE,
+        .ih_img_size = 300 * 1024,
+        .ih_flags = IMAGE_F_SHA256,
+        .ih_ver = { 0, 2, 3, 4 },
+    };
+    const struct flash_area *fap;
+    static uint8_t buf[BOOT_TMPBUF_SZ];
+    uint32_t start;
+    uint32_t small_us;
+    uint32_t large_us;
+    uint32_t first_us;
+    uint32_t cached_us;
+    int rc;
+
+    boot_test_util_init_flash();
+    boot_test_util_write_image(&hdr, 0);
+    boot_test_util_write_hash(&hdr, 0);
+
+    rc = flash_area_open(FLASH_AREA_IMAGE_0, &fap);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    start = os_cputime_get32();
+    rc = bootutil_img_validate(&hdr, fap, buf, 256, NULL, 0, NULL);
+    small_us = os_cputime_ticks_to_usecs(os_cputime_get32() - start);
+    TEST_ASSERT(rc == 0);
+
+    start = os_cputime_get32();
+    rc = bootutil_img_validate(&hdr, fap, buf, sizeof buf, NULL, 0, NULL);
+    large_us = os_cputime_ticks_to_usecs(os_cputime_get32() - start);
+    TEST_ASSERT(rc == 0);
+
+    /* First boot records the verdict, the next ones use it. */
+    start = os_cputime_get32();
+    rc = bootutil_img_validate_cached(&hdr, fap, buf, sizeof buf);
+    first_us = os_cputime_ticks_to_usecs(os_cputime_get32() - start);
+    TEST_ASSERT(rc == 0);
+
+    start = os_cputime_get32();
+    rc = bootutil_img_validate_cached(&hdr, fap, buf, sizeof buf);
+    cached_us = os_cputime_ticks_to_usecs(os_cputime_get32() - start);
+    TEST_ASSERT(rc == 0);
+
+    flash_area_close(fap);
+
+    printf("slot 0 validation, %d byte image: %u us (256 B reads), "
+           "%u us (%d B reads), %u us first boot, %u us cached\n",
+           (int)(hdr.ih_hdr_size + hdr.ih_img_size),
+           (unsigned)small_us, (unsigned)large_us, BOOT_TMPBUF_SZ,
+           (unsigned)first_us, (unsigned)cached_us);
+}
@@ -0,0 +1,129 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef __UTIL_BASE64_STREAM_H
+#define __UTIL_BASE64_STREAM_H
+
+#include <inttypes.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct os_mbuf;
+
+/*
+ * Incremental base64 over mbuf chains.  Input is read in place, a segment
+ * at a time, and output is written into the trailing space of the
+ * destination chain, which grows from its own pool as needed.  Input can
+ * be split anywhere between calls.
+ */
+
+struct base64_encoder {
+    /* Input bytes not yet encoded; fewer than 3. */
+    uint8_t be_part[3];
+    uint8_t be_part_len;
+    uint8_t be_pad;
+};
+
+struct base64_decoder {
+    /* Sextets of the current quad, and how many there are. */
+    uint32_t bd_val;
+    uint8_t bd_cnt;
+    /* Number of '=' in the current quad. */
+    uint8_t bd_pad;
+};
+
+/**
+ * Prepares an encoder.
+ *
+ * @param enc                   The encoder to initialize.
+ * @param should_pad            Whether base64_encoder_finish() pads the
+ *                                  output to a multiple of 4 with '='.
+ */
+void base64_encoder_init(struct base64_encoder *enc, int should_pad);
+
+/**
+ * Encodes bytes from a flat buffer, appending to `dst`.
+ *
+ * @return                      0 on success; SYS_ENOMEM if `dst` could not
+ *                                  be extended.
+ */
+int base64_encoder_feed(struct base64_encoder *enc, const void *data, int len,
+                        struct os_mbuf *dst);
+
+/**
+ * Encodes `len` bytes of `src`, starting at `off`, appending to `dst`.
+ *
+ * @return                      0 on success; SYS_EINVAL if `src` holds
+ *                                  fewer than `off + len` bytes;
+ *                                  SYS_ENOMEM if `dst` could not be
+ *                                  extended.
+ */
+int base64_encoder_feed_mbuf(struct base64_encoder *enc,
+                             const struct os_mbuf *src, int off, int len,
+                             struct os_mbuf *dst);
+
+/**
+ * Encodes the last partial group, if any, and resets the encoder.
+ *
+ * @return                      0 on success; SYS_ENOMEM if `dst` could not
+ *                                  be extended.
+ */
+int base64_encoder_finish(struct base64_encoder *enc, struct os_mbuf *dst);
+
+void base64_decoder_init(struct base64_decoder *dec);
+
+/**
+ * Decodes characters from a flat buffer, appending to `dst`.  A padded
+ * group may be followed by further groups.
+ *
+ * @return                      0 on success; SYS_EINVAL on a character
+ *                                  outside the base64 alphabet or
+ *                                  misplaced padding; SYS_ENOMEM if `dst`
+ *                                  could not be extended.
+ */
+int base64_decoder_feed(struct base64_decoder *dec, const char *str, int len,
+                        struct os_mbuf *dst);
+
+/**
+ * Decodes `len` characters of `src`, starting at `off`, appending to `dst`.
+ *
+ * @return                      As base64_decoder_feed(); also SYS_EINVAL
+ *                                  if `src` holds fewer than `off + len`
+ *                                  bytes.
+ */
+int base64_decoder_feed_mbuf(struct base64_decoder *dec,
+                             const struct os_mbuf *src, int off, int len,
+                             struct os_mbuf *dst);
+
+/**
+ * Decodes the last, unpadded, group if any, and resets the decoder.
+ *
+ * @return                      0 on success; SYS_EINVAL if the input ended
+ *                                  in the middle of a group that cannot be
+ *                                  completed; SYS_ENOMEM if `dst` could not
+ *                                  be extended.
+ */
+int base64_decoder_finish(struct base64_decoder *dec, struct os_mbuf *dst);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
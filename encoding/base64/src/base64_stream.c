@@ -0,0 +1,410 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "base64/base64_stream.h"
+#include "base64_priv.h"
+
+/* Where output goes: the trailing space of the last mbuf in a chain. */
+struct base64_stream_out {
+    struct os_mbuf *bso_om;
+    struct os_mbuf *bso_last;
+};
+
+typedef int base64_stream_fn(void *state, const uint8_t *src, int len,
+                             struct base64_stream_out *out);
+
+static void
+base64_stream_out_init(struct base64_stream_out *out, struct os_mbuf *om)
+{
+    out->bso_om = om;
+    out->bso_last = om;
+    while (SLIST_NEXT(out->bso_last, om_next) != NULL) {
+        out->bso_last = SLIST_NEXT(out->bso_last, om_next);
+    }
+}
+
+/*
+ * Returns where the next output byte goes, with room for at least `min`
+ * bytes; a new mbuf is added to the chain if the last one is too full.
+ */
+static uint8_t *
+base64_stream_room(struct base64_stream_out *out, int min, int *room)
+{
+    struct os_mbuf *m;
+
+    m = out->bso_last;
+    if (OS_MBUF_TRAILINGSPACE(m) < min) {
+        m = os_mbuf_get(out->bso_om->om_omp, 0);
+        if (m == NULL) {
+            return NULL;
+        }
+        SLIST_NEXT(out->bso_last, om_next) = m;
+        out->bso_last = m;
+    }
+
+    *room = OS_MBUF_TRAILINGSPACE(m);
+    return m->om_data + m->om_len;
+}
+
+static void
+base64_stream_commit(struct base64_stream_out *out, int len)
+{
+    out->bso_last->om_len += len;
+    if (OS_MBUF_IS_PKTHDR(out->bso_om)) {
+        OS_MBUF_PKTHDR(out->bso_om)->omp_len += len;
+    }
+}
+
+/*
+ * Runs `fn` over each segment of `len` bytes of `src`, from `off` on.
+ */
+static int
+base64_stream_mbuf(const struct os_mbuf *src, int off, int len,
+                   base64_stream_fn *fn, void *state, struct os_mbuf *dst)
+{
+    struct base64_stream_out out;
+    uint16_t seg_off;
+    int seg_len;
+    int rc;
+
+    if (off < 0 || len < 0) {
+        return SYS_EINVAL;
+    }
+    if (len == 0) {
+        return 0;
+    }
+
+    src = os_mbuf_off(src, off, &seg_off);
+    if (src == NULL) {
+        return SYS_EINVAL;
+    }
+
+    base64_stream_out_init(&out, dst);
+    while (len > 0) {
+        if (src == NULL) {
+            return SYS_EINVAL;
+        }
+
+        seg_len = min(src->om_len - seg_off, len);
+        rc = fn(state, src->om_data + seg_off, seg_len, &out);
+        if (rc != 0) {
+            return rc;
+        }
+
+        len -= seg_len;
+        seg_off = 0;
+        src = SLIST_NEXT(src, om_next);
+    }
+
+    return 0;
+}
+
+static void
+base64_encode_group(const uint8_t *src, uint8_t *dst)
+{
+    uint32_t v;
+
+    v = ((uint32_t)src[0] << 16) | ((uint32_t)src[1] << 8) | src[2];
+    dst[0] = base64_chars[(v >> 18) & 0x3f];
+    dst[1] = base64_chars[(v >> 12) & 0x3f];
+    dst[2] = base64_chars[(v >> 6) & 0x3f];
+    dst[3] = base64_chars[v & 0x3f];
+}
+
+static int
+base64_encoder_run(void *state, const uint8_t *src, int len,
+                   struct base64_stream_out *out)
+{
+    struct base64_encoder *enc;
+    uint8_t *dst;
+    int room;
+    int cnt;
+    int i;
+
+    enc = state;
+
+    /* Complete a group left over from the last call. */
+    if (enc->be_part_len > 0) {
+        while (enc->be_part_len < 3 && len > 0) {
+            enc->be_part[enc->be_part_len++] = *src++;
+            len--;
+        }
+        if (enc->be_part_len < 3) {
+            return 0;
+        }
+
+        dst = base64_stream_room(out, 4, &room);
+        if (dst == NULL) {
+            return SYS_ENOMEM;
+        }
+        base64_encode_group(enc->be_part, dst);
+        base64_stream_commit(out, 4);
+        enc->be_part_len = 0;
+    }
+
+    /* Whole groups go straight from the input to the output mbuf. */
+    while (len >= 3) {
+        dst = base64_stream_room(out, 4, &room);
+        if (dst == NULL) {
+            return SYS_ENOMEM;
+        }
+
+        cnt = min(len / 3, room / 4);
+        for (i = 0; i < cnt; i++) {
+            base64_encode_group(src, dst);
+            src += 3;
+            dst += 4;
+        }
+        base64_stream_commit(out, cnt * 4);
+        len -= cnt * 3;
+    }
+
+    memcpy(enc->be_part, src, len);
+    enc->be_part_len = len;
+
+    return 0;
+}
+
+void
+base64_encoder_init(struct base64_encoder *enc, int should_pad)
+{
+    memset(enc, 0, sizeof *enc);
+    enc->be_pad = !!should_pad;
+}
+
+int
+base64_encoder_feed(struct base64_encoder *enc, const void *data, int len,
+                    struct os_mbuf *dst)
+{
+    struct base64_stream_out out;
+
+    if (len < 0) {
+        return SYS_EINVAL;
+    }
+
+    base64_stream_out_init(&out, dst);
+    return base64_encoder_run(enc, data, len, &out);
+}
+
+int
+base64_encoder_feed_mbuf(struct base64_encoder *enc,
+                         const struct os_mbuf *src, int off, int len,
+                         struct os_mbuf *dst)
+{
+    return base64_stream_mbuf(src, off, len, base64_encoder_run, enc, dst);
+}
+
+int
+base64_encoder_finish(struct base64_encoder *enc, struct os_mbuf *dst)
+{
+    struct base64_stream_out out;
+    uint8_t group[4];
+    uint8_t *ptr;
+    int room;
+    int len;
+
+    if (enc->be_part_len == 0) {
+        return 0;
+    }
+
+    memset(enc->be_part + enc->be_part_len, 0, 3 - enc->be_part_len);
+    base64_encode_group(enc->be_part, group);
+
+    /* 1 byte makes 2 characters, 2 bytes make 3. */
+    len = enc->be_part_len + 1;
+    if (enc->be_pad) {
+        memset(group + len, '=', 4 - len);
+        len = 4;
+    }
+
+    base64_stream_out_init(&out, dst);
+    ptr = base64_stream_room(&out, len, &room);
+    if (ptr == NULL) {
+        return SYS_ENOMEM;
+    }
+    memcpy(ptr, group, len);
+    base64_stream_commit(&out, len);
+
+    enc->be_part_len = 0;
+    return 0;
+}
+
+/*
+ * Writes the bytes of a complete group; fewer if it was padded.
+ */
+static int
+base64_decoder_emit(struct base64_decoder *dec, struct base64_stream_out *out)
+{
+    uint8_t *dst;
+    int room;
+    int len;
+
+    len = 3 - dec->bd_pad;
+    dst = base64_stream_room(out, len, &room);
+    if (dst == NULL) {
+        return SYS_ENOMEM;
+    }
+
+    dst[0] = dec->bd_val >> 16;
+    if (len > 1) {
+        dst[1] = dec->bd_val >> 8;
+    }
+    if (len > 2) {
+        dst[2] = dec->bd_val;
+    }
+    base64_stream_commit(out, len);
+
+    dec->bd_val = 0;
+    dec->bd_cnt = 0;
+    dec->bd_pad = 0;
+    return 0;
+}
+
+static int
+base64_decoder_run(void *state, const uint8_t *src, int len,
+                   struct base64_stream_out *out)
+{
+    struct base64_decoder *dec;
+    uint8_t *dst;
+    uint32_t v;
+    int room;
+    int cnt;
+    int rc;
+    int i;
+
+    dec = state;
+
+    while (len > 0) {
+        /*
+         * Fast path: whole groups, four lookups folded into one word and
+         * checked for invalid characters and padding with a single test.
+         * Anything unusual falls through to the one-at-a-time path below.
+         */
+        if (dec->bd_cnt == 0 && len >= 4) {
+            dst = base64_stream_room(out, 3, &room);
+            if (dst == NULL) {
+                return SYS_ENOMEM;
+            }
+
+            cnt = min(len / 4, room / 3);
+            for (i = 0; i < cnt; i++) {
+                v = ((uint32_t)base64_dec_tab[src[0]] << 24) |
+                    ((uint32_t)base64_dec_tab[src[1]] << 16) |
+                    ((uint32_t)base64_dec_tab[src[2]] << 8) |
+                    base64_dec_tab[src[3]];
+                if (v & 0xc0c0c0c0) {
+                    break;
+                }
+                v = (v >> 6 & 0xfc0000) | (v >> 4 & 0x3f000) |
+                    (v >> 2 & 0xfc0) | (v & 0x3f);
+                dst[0] = v >> 16;
+                dst[1] = v >> 8;
+                dst[2] = v;
+                src += 4;
+                dst += 3;
+            }
+            base64_stream_commit(out, i * 3);
+            len -= i * 4;
+            if (i == cnt) {
+                continue;
+            }
+        }
+
+        v = base64_dec_tab[*src++];
+        len--;
+
+        if (v == BASE64_DEC_PAD) {
+            /* At least two characters come before padding. */
+            if (dec->bd_cnt < 2) {
+                return SYS_EINVAL;
+            }
+            dec->bd_pad++;
+            v = 0;
+        } else if (v == BASE64_DEC_INVALID || dec->bd_pad > 0) {
+            return SYS_EINVAL;
+        }
+
+        dec->bd_val = (dec->bd_val << 6) | v;
+        if (++dec->bd_cnt == 4) {
+            rc = base64_decoder_emit(dec, out);
+            if (rc != 0) {
+                return rc;
+            }
+        }
+    }
+
+    return 0;
+}
+
+void
+base64_decoder_init(struct base64_decoder *dec)
+{
+    memset(dec, 0, sizeof *dec);
+}
+
+int
+base64_decoder_feed(struct base64_decoder *dec, const char *str, int len,
+                    struct os_mbuf *dst)
+{
+    struct base64_stream_out out;
+
+    if (len < 0) {
+        return SYS_EINVAL;
+    }
+
+    base64_stream_out_init(&out, dst);
+    return base64_decoder_run(dec, (const uint8_t *)str, len, &out);
+}
+
+int
+base64_decoder_feed_mbuf(struct base64_decoder *dec,
+                         const struct os_mbuf *src, int off, int len,
+                         struct os_mbuf *dst)
+{
+    return base64_stream_mbuf(src, off, len, base64_decoder_run, dec, dst);
+}
+
+int
+base64_decoder_finish(struct base64_decoder *dec, struct os_mbuf *dst)
+{
+    struct base64_stream_out out;
+    int rc;
+
+    if (dec->bd_cnt == 0) {
+        return 0;
+    }
+
+    /* A single character, or an incomplete padded group, cannot be a group. */
+    if (dec->bd_cnt == 1 || dec->bd_pad > 0) {
+        base64_decoder_init(dec);
+        return SYS_EINVAL;
+    }
+
+    /* Unpadded tail; decode as if the padding were there. */
+    dec->bd_pad = 4 - dec->bd_cnt;
+    dec->bd_val <<= 6 * dec->bd_pad;
+
+    base64_stream_out_init(&out, dst);
+    rc = base64_decoder_emit(dec, &out);
+    if (rc != 0) {
+        base64_decoder_init(dec);
+    }
+    return rc;
+}
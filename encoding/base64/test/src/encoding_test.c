@@ -24,11 +24,69 @@
 
 TEST_CASE_DECL(hex2str)
 TEST_CASE_DECL(str2hex)
+TEST_CASE_DECL(b64_stream)
+TEST_CASE_DECL(b64_stream_mbuf)
+TEST_CASE_DECL(b64_bench)
+
+#define B64_TEST_POOL_BUF_SIZE      256
+#define B64_TEST_POOL_BUF_COUNT     1024
+
+static os_membuf_t b64_test_membuf[OS_MEMPOOL_SIZE(B64_TEST_POOL_BUF_COUNT,
+                                                   B64_TEST_POOL_BUF_SIZE)];
+static struct os_mempool b64_test_mempool;
+struct os_mbuf_pool b64_test_mbuf_pool;
+
+void
+b64_test_pool_init(void)
+{
+    int rc;
+
+    rc = os_mempool_init(&b64_test_mempool, B64_TEST_POOL_BUF_COUNT,
+                         B64_TEST_POOL_BUF_SIZE, b64_test_membuf,
+                         "b64_test_pool");
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = os_mbuf_pool_init(&b64_test_mbuf_pool, &b64_test_mempool,
+                           B64_TEST_POOL_BUF_SIZE, B64_TEST_POOL_BUF_COUNT);
+    TEST_ASSERT_FATAL(rc == 0);
+}
+
+/*
+ * Builds a chain from `data`, at most `chunk` bytes per mbuf.  There is no
+ * packet header, so the chain can hold more than 64KB.
+ */
+struct os_mbuf *
+b64_test_mbuf(const void *data, int len, int chunk)
+{
+    struct os_mbuf *om;
+    struct os_mbuf *m;
+    int off;
+    int n;
+
+    om = os_mbuf_get(&b64_test_mbuf_pool, 0);
+    TEST_ASSERT_FATAL(om != NULL);
+
+    for (off = 0; off < len; off += n) {
+        n = min(len - off, chunk);
+        if (off == 0) {
+            m = om;
+        } else {
+            m = os_mbuf_get(&b64_test_mbuf_pool, 0);
+            TEST_ASSERT_FATAL(m != NULL);
+            os_mbuf_concat(om, m);
+        }
+        memcpy(m->om_data, (const uint8_t *)data + off, n);
+        m->om_len = n;
+    }
+
+    return om;
+}
 
 int
 hex_fmt_test_all(void)
 {
     hex_fmt_test_suite();
+    base64_stream_test_suite();
     return tu_case_failed;
 }
 
@@ -38,6 +96,13 @@ TEST_SUITE(hex_fmt_test_suite)
     str2hex();
 }
 
+TEST_SUITE(base64_stream_test_suite)
+{
+    b64_stream();
+    b64_stream_mbuf();
+    b64_bench();
+}
+
 #if MYNEWT_VAL(SELFTEST)
 
 int
@@ -23,6 +23,8 @@
 #include <stddef.h>
 #include "os/mynewt.h"
 #include "base64/hex.h"
+#include "base64/base64.h"
+#include "base64/base64_stream.h"
 #include "testutil/testutil.h"
 
 #ifdef __cplusplus
@@ -30,6 +32,12 @@ extern "C" {
 #endif
 
 int hex_fmt_test_suite(void);
+int base64_stream_test_suite(void);
+
+extern struct os_mbuf_pool b64_test_mbuf_pool;
+
+void b64_test_pool_init(void);
+struct os_mbuf *b64_test_mbuf(const void *data, int len, int chunk);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,140 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <stdio.h>
+#include <string.h>
+#include "encoding_test_priv.h"
+
+#define B64_BENCH_LEN       (64 * 1024)
+
+static uint8_t b64_bench_raw[B64_BENCH_LEN];
+static char b64_bench_enc[BASE64_ENCODE_SIZE(B64_BENCH_LEN) + 1];
+
+static uint32_t
+b64_bench_kbps(uint32_t start)
+{
+    uint32_t usecs;
+
+    usecs = os_cputime_ticks_to_usecs(os_cputime_get32() - start);
+    if (usecs == 0) {
+        usecs = 1;
+    }
+    return (uint64_t)B64_BENCH_LEN * 1000000 / 1024 / usecs;
+}
+
+/*
+ * The payloads are over 64KB: too long for a packet header's length, or for
+ * a single os_mbuf_cmpf().
+ */
+static int
+b64_bench_chain_len(const struct os_mbuf *om)
+{
+    int len;
+
+    len = 0;
+    for (; om != NULL; om = SLIST_NEXT(om, om_next)) {
+        len += om->om_len;
+    }
+    return len;
+}
+
+static int
+b64_bench_cmp(const struct os_mbuf *om, const void *data, int len)
+{
+    int off;
+    int rc;
+
+    for (off = 0; off < len; off += 16 * 1024) {
+        rc = os_mbuf_cmpf(om, off, (const uint8_t *)data + off,
+                          min(len - off, 16 * 1024));
+        if (rc != 0) {
+            return rc;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Reports the throughput of the flat functions, and of the streaming codec
+ * over mbuf chains, on a 64KB payload.
+ */
+TEST_CASE(b64_bench)
+{
+    struct base64_encoder enc;
+    struct base64_decoder dec;
+    struct os_mbuf *raw;
+    struct os_mbuf *om;
+    uint32_t start;
+    uint32_t kbps[4];
+    int enc_len;
+    int rc;
+    int i;
+
+    b64_test_pool_init();
+
+    for (i = 0; i < sizeof b64_bench_raw; i++) {
+        b64_bench_raw[i] = i * 13 + (i >> 10);
+    }
+
+    start = os_cputime_get32();
+    enc_len = base64_encode(b64_bench_raw, B64_BENCH_LEN, b64_bench_enc, 1);
+    kbps[0] = b64_bench_kbps(start);
+
+    start = os_cputime_get32();
+    rc = base64_decode(b64_bench_enc, b64_bench_raw);
+    kbps[1] = b64_bench_kbps(start);
+    TEST_ASSERT_FATAL(rc == B64_BENCH_LEN);
+
+    /* Chains of full mbufs, as a transport would hand them over. */
+    raw = b64_test_mbuf(b64_bench_raw, B64_BENCH_LEN, 200);
+
+    om = os_mbuf_get(&b64_test_mbuf_pool, 0);
+    TEST_ASSERT_FATAL(om != NULL);
+    start = os_cputime_get32();
+    base64_encoder_init(&enc, 1);
+    rc = base64_encoder_feed_mbuf(&enc, raw, 0, B64_BENCH_LEN, om);
+    if (rc == 0) {
+        rc = base64_encoder_finish(&enc, om);
+    }
+    kbps[2] = b64_bench_kbps(start);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(b64_bench_chain_len(om) == enc_len);
+    TEST_ASSERT(b64_bench_cmp(om, b64_bench_enc, enc_len) == 0);
+    os_mbuf_free_chain(raw);
+
+    raw = om;
+    om = os_mbuf_get(&b64_test_mbuf_pool, 0);
+    TEST_ASSERT_FATAL(om != NULL);
+    start = os_cputime_get32();
+    base64_decoder_init(&dec);
+    rc = base64_decoder_feed_mbuf(&dec, raw, 0, enc_len, om);
+    if (rc == 0) {
+        rc = base64_decoder_finish(&dec, om);
+    }
+    kbps[3] = b64_bench_kbps(start);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(b64_bench_chain_len(om) == B64_BENCH_LEN);
+    TEST_ASSERT(b64_bench_cmp(om, b64_bench_raw, B64_BENCH_LEN) == 0);
+    os_mbuf_free_chain(raw);
+    os_mbuf_free_chain(om);
+
+    printf("base64, 64KB: flat encode %lu KB/s, decode %lu KB/s; "
+           "mbuf encode %lu KB/s, decode %lu KB/s\n",
+           (unsigned long)kbps[0], (unsigned long)kbps[1],
+           (unsigned long)kbps[2], (unsigned long)kbps[3]);
+}
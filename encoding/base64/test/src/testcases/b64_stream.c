@@ -0,0 +1,140 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <string.h>
+#include "encoding_test_priv.h"
+
+static const struct {
+    const char *raw;
+    const char *enc;
+} b64_stream_vectors[] = {
+    { "",       "" },
+    { "f",      "Zg==" },
+    { "fo",     "Zm8=" },
+    { "foo",    "Zm9v" },
+    { "foob",   "Zm9vYg==" },
+    { "fooba",  "Zm9vYmE=" },
+    { "foobar", "Zm9vYmFy" },
+};
+
+#define B64_STREAM_NUM_VECTORS \
+    (sizeof b64_stream_vectors / sizeof b64_stream_vectors[0])
+
+static int
+b64_stream_decode_str(const char *str, int split, struct os_mbuf *dst)
+{
+    struct base64_decoder dec;
+    int len;
+    int rc;
+
+    len = strlen(str);
+    split = min(split, len);
+
+    base64_decoder_init(&dec);
+    rc = base64_decoder_feed(&dec, str, split, dst);
+    if (rc == 0) {
+        rc = base64_decoder_feed(&dec, str + split, len - split, dst);
+    }
+    if (rc == 0) {
+        rc = base64_decoder_finish(&dec, dst);
+    }
+    return rc;
+}
+
+TEST_CASE(b64_stream)
+{
+    struct base64_encoder enc;
+    struct os_mbuf *om;
+    const char *raw;
+    const char *enc_str;
+    int enc_len;
+    int raw_len;
+    int split;
+    int rc;
+    int i;
+    int j;
+
+    b64_test_pool_init();
+
+    for (i = 0; i < B64_STREAM_NUM_VECTORS; i++) {
+        raw = b64_stream_vectors[i].raw;
+        enc_str = b64_stream_vectors[i].enc;
+        raw_len = strlen(raw);
+        enc_len = strlen(enc_str);
+
+        /*** Encode, a byte at a time, padded. */
+        om = os_mbuf_get_pkthdr(&b64_test_mbuf_pool, 0);
+        base64_encoder_init(&enc, 1);
+        for (j = 0; j < raw_len; j++) {
+            rc = base64_encoder_feed(&enc, raw + j, 1, om);
+            TEST_ASSERT_FATAL(rc == 0);
+        }
+        rc = base64_encoder_finish(&enc, om);
+        TEST_ASSERT_FATAL(rc == 0);
+        TEST_ASSERT(OS_MBUF_PKTLEN(om) == enc_len);
+        TEST_ASSERT(os_mbuf_cmpf(om, 0, enc_str, enc_len) == 0);
+        os_mbuf_free_chain(om);
+
+        /*** Encode unpadded. */
+        om = os_mbuf_get_pkthdr(&b64_test_mbuf_pool, 0);
+        base64_encoder_init(&enc, 0);
+        rc = base64_encoder_feed(&enc, raw, raw_len, om);
+        TEST_ASSERT_FATAL(rc == 0);
+        rc = base64_encoder_finish(&enc, om);
+        TEST_ASSERT_FATAL(rc == 0);
+        while (enc_len > 0 && enc_str[enc_len - 1] == '=') {
+            enc_len--;
+        }
+        TEST_ASSERT(OS_MBUF_PKTLEN(om) == enc_len);
+        TEST_ASSERT(os_mbuf_cmpf(om, 0, enc_str, enc_len) == 0);
+        os_mbuf_free_chain(om);
+
+        /*** Decode, split at every point. */
+        for (split = 0; split <= strlen(enc_str); split++) {
+            om = os_mbuf_get_pkthdr(&b64_test_mbuf_pool, 0);
+            rc = b64_stream_decode_str(enc_str, split, om);
+            TEST_ASSERT(rc == 0);
+            TEST_ASSERT(OS_MBUF_PKTLEN(om) == raw_len);
+            TEST_ASSERT(os_mbuf_cmpf(om, 0, raw, raw_len) == 0);
+            os_mbuf_free_chain(om);
+        }
+    }
+
+    /*** Unpadded input decodes too, and padded groups can be followed. */
+    om = os_mbuf_get_pkthdr(&b64_test_mbuf_pool, 0);
+    rc = b64_stream_decode_str("Zm9vYmE", 3, om);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(os_mbuf_cmpf(om, 0, "fooba", 5) == 0);
+    os_mbuf_free_chain(om);
+
+    om = os_mbuf_get_pkthdr(&b64_test_mbuf_pool, 0);
+    rc = b64_stream_decode_str("Zg==Zm8=Zm9v", 5, om);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(OS_MBUF_PKTLEN(om) == 6);
+    TEST_ASSERT(os_mbuf_cmpf(om, 0, "ffofoo", 6) == 0);
+    os_mbuf_free_chain(om);
+
+    /*** Bad input. */
+    om = os_mbuf_get_pkthdr(&b64_test_mbuf_pool, 0);
+    TEST_ASSERT(b64_stream_decode_str("Zm9v!mFy", 0, om) == SYS_EINVAL);
+    TEST_ASSERT(b64_stream_decode_str("Zg=a", 0, om) == SYS_EINVAL);
+    TEST_ASSERT(b64_stream_decode_str("Z===", 0, om) == SYS_EINVAL);
+    TEST_ASSERT(b64_stream_decode_str("Zm9vY", 0, om) == SYS_EINVAL);
+    TEST_ASSERT(b64_stream_decode_str("Zg=", 0, om) == SYS_EINVAL);
+    os_mbuf_free_chain(om);
+}
@@ -0,0 +1,110 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <string.h>
+#include "encoding_test_priv.h"
+
+#define B64_STREAM_MBUF_LEN     1000
+
+static uint8_t b64_stream_mbuf_raw[B64_STREAM_MBUF_LEN];
+static char b64_stream_mbuf_enc[BASE64_ENCODE_SIZE(B64_STREAM_MBUF_LEN) + 1];
+
+/*
+ * Compares the streaming codec, reading and writing odd-sized mbufs, with
+ * the flat functions.
+ */
+TEST_CASE(b64_stream_mbuf)
+{
+    static const int chunks[] = { 3, 5, 64, 200 };
+    struct base64_encoder enc;
+    struct base64_decoder dec;
+    struct os_mbuf *src;
+    struct os_mbuf *dst;
+    int enc_len;
+    int first;
+    int chunk;
+    int off;
+    int len;
+    int rc;
+    int i;
+
+    b64_test_pool_init();
+
+    for (i = 0; i < sizeof b64_stream_mbuf_raw; i++) {
+        b64_stream_mbuf_raw[i] = i * 7 + (i >> 8);
+    }
+
+    for (chunk = 0; chunk < sizeof chunks / sizeof chunks[0]; chunk++) {
+        src = b64_test_mbuf(b64_stream_mbuf_raw, sizeof b64_stream_mbuf_raw,
+                            chunks[chunk]);
+
+        for (off = 0; off < 10; off++) {
+            len = sizeof b64_stream_mbuf_raw - off * 37;
+            enc_len = base64_encode(b64_stream_mbuf_raw + off, len,
+                                    b64_stream_mbuf_enc, 1);
+
+            /*** Encode from the chain, in two pieces. */
+            first = len / 3 + off;
+            dst = os_mbuf_get_pkthdr(&b64_test_mbuf_pool, 0);
+            base64_encoder_init(&enc, 1);
+            rc = base64_encoder_feed_mbuf(&enc, src, off, first, dst);
+            TEST_ASSERT_FATAL(rc == 0);
+            rc = base64_encoder_feed_mbuf(&enc, src, off + first, len - first,
+                                          dst);
+            TEST_ASSERT_FATAL(rc == 0);
+            rc = base64_encoder_finish(&enc, dst);
+            TEST_ASSERT_FATAL(rc == 0);
+
+            TEST_ASSERT_FATAL(OS_MBUF_PKTLEN(dst) == enc_len);
+            TEST_ASSERT(os_mbuf_cmpf(dst, 0, b64_stream_mbuf_enc,
+                                     enc_len) == 0);
+            os_mbuf_free_chain(dst);
+        }
+        os_mbuf_free_chain(src);
+
+        /*** Decode from a chain of the encoding. */
+        enc_len = base64_encode(b64_stream_mbuf_raw,
+                                sizeof b64_stream_mbuf_raw,
+                                b64_stream_mbuf_enc, 1);
+        src = b64_test_mbuf(b64_stream_mbuf_enc, enc_len, chunks[chunk]);
+        dst = os_mbuf_get_pkthdr(&b64_test_mbuf_pool, 0);
+        base64_decoder_init(&dec);
+        rc = base64_decoder_feed_mbuf(&dec, src, 0, enc_len, dst);
+        TEST_ASSERT_FATAL(rc == 0);
+        rc = base64_decoder_finish(&dec, dst);
+        TEST_ASSERT_FATAL(rc == 0);
+
+        TEST_ASSERT_FATAL(OS_MBUF_PKTLEN(dst) == sizeof b64_stream_mbuf_raw);
+        TEST_ASSERT(os_mbuf_cmpf(dst, 0, b64_stream_mbuf_raw,
+                                 sizeof b64_stream_mbuf_raw) == 0);
+        os_mbuf_free_chain(dst);
+
+        /*** Reading past the end of the chain fails. */
+        dst = os_mbuf_get_pkthdr(&b64_test_mbuf_pool, 0);
+        base64_decoder_init(&dec);
+        rc = base64_decoder_feed_mbuf(&dec, src, 4, enc_len, dst);
+        TEST_ASSERT(rc == SYS_EINVAL);
+        os_mbuf_free_chain(dst);
+
+        os_mbuf_free_chain(src);
+    }
+
+    /*** Every block was returned. */
+    TEST_ASSERT(b64_test_mbuf_pool.omp_pool->mp_num_free ==
+                b64_test_mbuf_pool.omp_pool->mp_num_blocks);
+}
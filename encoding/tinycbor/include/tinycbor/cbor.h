@@ -499,6 +499,8 @@ struct mgmt_cbuf {
     struct CborParser  parser;
     struct CborEncoder encoder;
     struct CborValue   it;
+    /* Set while the transport flushes the response as it is encoded. */
+    uint8_t            streaming;
 };
 
 #ifdef __cplusplus
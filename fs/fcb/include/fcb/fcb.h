@@ -78,6 +78,8 @@ struct fcb {
 
 int fcb_init(struct fcb *fcb);
 
+struct log_fcb_sum;
+
 /**
  * fcb_log is needed as the number of entries in a log
  */
@@ -89,6 +91,13 @@ struct fcb_log {
     /* Internal - tracking storage use */
     uint32_t fl_watermark_off;
 #endif
+
+#if MYNEWT_VAL(LOG_QUERY)
+    /* Optional array of f_sector_cnt sector summaries used by log_query();
+     * set before the log is registered.
+     */
+    struct log_fcb_sum *fl_sums;
+#endif
 };
 
 /**
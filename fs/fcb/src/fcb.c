@@ -23,6 +23,28 @@
 #include "fcb_priv.h"
 #include "string.h"
 
+#if MYNEWT_VAL(FCB_STATS)
+STATS_SECT_DECL(fcb_stats) fcb_stats;
+
+STATS_NAME_START(fcb_stats)
+    STATS_NAME(fcb_stats, append)
+STATS_NAME_END(fcb_stats)
+
+void
+fcb_stats_init(void)
+{
+    int rc;
+
+    /* Ensure this function only gets called by sysinit. */
+    SYSINIT_ASSERT_ACTIVE();
+
+    rc = stats_init_and_reg(STATS_HDR(fcb_stats),
+                            STATS_SIZE_INIT_PARMS(fcb_stats, STATS_SIZE_HIST),
+                            STATS_NAME_INIT_PARMS(fcb_stats), "fcb");
+    SYSINIT_PANIC_ASSERT(rc == 0);
+}
+#endif
+
 int
 fcb_init(struct fcb *fcb)
 {
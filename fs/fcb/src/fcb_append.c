@@ -66,8 +66,8 @@ fcb_append_to_scratch(struct fcb *fcb)
     return FCB_OK;
 }
 
-int
-fcb_append(struct fcb *fcb, uint16_t len, struct fcb_entry *append_loc)
+static int
+fcb_append_nostats(struct fcb *fcb, uint16_t len, struct fcb_entry *append_loc)
 {
     struct fcb_entry *active;
     struct flash_area *fa;
@@ -123,6 +123,23 @@ err:
     return rc;
 }
 
+int
+fcb_append(struct fcb *fcb, uint16_t len, struct fcb_entry *append_loc)
+{
+#if MYNEWT_VAL(FCB_STATS)
+    uint32_t start;
+    int rc;
+
+    start = os_cputime_get32();
+    rc = fcb_append_nostats(fcb, len, append_loc);
+    STATS_HIST_RECORD(fcb_stats, append,
+                      os_cputime_ticks_to_usecs(os_cputime_get32() - start));
+    return rc;
+#else
+    return fcb_append_nostats(fcb, len, append_loc);
+#endif
+}
+
 int
 fcb_append_finish(struct fcb *fcb, struct fcb_entry *loc)
 {
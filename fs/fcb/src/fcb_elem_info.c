@@ -18,6 +18,7 @@
  */
 
 #include <crc/crc8.h>
+#include <crc_stream/crc_stream.h>
 
 #include "fcb/fcb.h"
 #include "fcb_priv.h"
@@ -31,11 +32,8 @@ fcb_elem_crc8(struct fcb *fcb, struct fcb_entry *loc, uint8_t *c8p)
 {
     uint8_t tmp_str[FCB_TMP_BUF_SZ];
     int cnt;
-    int blk_sz;
     uint8_t crc8;
     uint16_t len;
-    uint32_t off;
-    uint32_t end;
     int rc;
 
     if (loc->fe_elem_off + 2 > loc->fe_area->fa_size) {
@@ -55,19 +53,13 @@ fcb_elem_crc8(struct fcb *fcb, struct fcb_entry *loc, uint8_t *c8p)
     crc8 = crc8_init();
     crc8 = crc8_calc(crc8, tmp_str, cnt);
 
-    off = loc->fe_data_off;
-    end = loc->fe_data_off + len;
-    for (; off < end; off += blk_sz) {
-        blk_sz = end - off;
-        if (blk_sz > sizeof(tmp_str)) {
-            blk_sz = sizeof(tmp_str);
-        }
-
-        rc = flash_area_read(loc->fe_area, off, tmp_str, blk_sz);
-        if (rc) {
-            return FCB_ERR_FLASH;
-        }
-        crc8 = crc8_calc(crc8, tmp_str, blk_sz);
+    if (loc->fe_data_off + len > loc->fe_area->fa_size) {
+        return FCB_ERR_FLASH;
+    }
+    rc = crc8_flash(crc8, loc->fe_area->fa_device_id,
+                    loc->fe_area->fa_off + loc->fe_data_off, len, &crc8);
+    if (rc) {
+        return FCB_ERR_FLASH;
     }
     *c8p = crc8;
 
@@ -19,6 +19,10 @@
 #ifndef __SYS_FCB_PRIV_H_
 #define __SYS_FCB_PRIV_H_
 
+#if MYNEWT_VAL(FCB_STATS)
+#include "stats/stats.h"
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -35,6 +39,14 @@ struct fcb_disk_area {
     uint16_t fd_id;
 };
 
+#if MYNEWT_VAL(FCB_STATS)
+STATS_SECT_START(fcb_stats)
+    STATS_SECT_HIST(append)
+STATS_SECT_END
+
+extern STATS_SECT_DECL(fcb_stats) fcb_stats;
+#endif
+
 int fcb_put_len(uint8_t *buf, uint16_t len);
 int fcb_get_len(uint8_t *buf, uint16_t *len);
 
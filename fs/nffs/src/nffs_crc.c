@@ -19,37 +19,37 @@
 
 #include "nffs_priv.h"
 
+/* Number of flash reads crc16_ccitt_flash() makes for len bytes */
+#define NFFS_CRC_FLASH_READS(len)                                       \
+    (((len) + MYNEWT_VAL(CRC_FLASH_BUF_SIZE) - 1) /                     \
+     MYNEWT_VAL(CRC_FLASH_BUF_SIZE))
+
 int
 nffs_crc_flash(uint16_t initial_crc, uint8_t area_idx, uint32_t area_offset,
                uint32_t len, uint16_t *out_crc)
 {
-    uint32_t chunk_len;
-    uint16_t crc;
+    const struct nffs_area *area;
     int rc;
 
-    crc = initial_crc;
-
-    /* Copy data in chunks small enough to fit in the flash buffer. */
-    while (len > 0) {
-        if (len > sizeof nffs_flash_buf) {
-            chunk_len = sizeof nffs_flash_buf;
-        } else {
-            chunk_len = len;
-        }
+    assert(area_idx < nffs_num_areas);
 
-        STATS_INC(nffs_stats, nffs_readcnt_crc);
-        rc = nffs_flash_read(area_idx, area_offset, nffs_flash_buf, chunk_len);
-        if (rc != 0) {
-            return rc;
-        }
+    area = nffs_areas + area_idx;
 
-        crc = crc16_ccitt(crc, nffs_flash_buf, chunk_len);
+    if (area_offset + len > area->na_length) {
+        return FS_EOFFSET;
+    }
 
-        area_offset += chunk_len;
-        len -= chunk_len;
+    /* util/crc_stream reads the range in CRC_FLASH_BUF_SIZE chunks, rather
+     * than through nffs_flash_read(); count each of those reads.
+     */
+    STATS_INCN(nffs_stats, nffs_readcnt_crc, NFFS_CRC_FLASH_READS(len));
+    STATS_INCN(nffs_stats, nffs_iocnt_read, NFFS_CRC_FLASH_READS(len));
+    rc = crc16_ccitt_flash(initial_crc, area->na_flash_id,
+                           area->na_offset + area_offset, len, out_crc);
+    if (rc != 0) {
+        return FS_EHW;
     }
 
-    *out_crc = crc;
     return 0;
 }
 
@@ -26,6 +26,7 @@
 #include "nffs/nffs.h"
 #include "fs/fs.h"
 #include "crc/crc16.h"
+#include "crc_stream/crc_stream.h"
 #include "stats/stats.h"
 
 #ifdef __cplusplus
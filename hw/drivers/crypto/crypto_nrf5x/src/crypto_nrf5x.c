@@ -0,0 +1,106 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+
+#include "os/mynewt.h"
+#include "nrfx.h"
+#include "crypto/crypto.h"
+#include "crypto/crypto_hw.h"
+
+/* Upper bound on the ECB polling loop; a block takes a few microseconds. */
+#define CRYPTO_NRF5X_ECB_SPINS  0x10000
+
+/*
+ * Data structure used by ECB; ECBDATAPTR points at it.
+ */
+struct crypto_nrf5x_ecb {
+    uint8_t cne_key[CRYPTO_AES_KEY_LEN];
+    uint8_t cne_plain[CRYPTO_AES_BLOCK_LEN];
+    uint8_t cne_cipher[CRYPTO_AES_BLOCK_LEN];
+};
+
+/*
+ * The ECB peripheral is shared with the BLE controller, which drives it
+ * from the link layer task.  Interrupts are disabled for the duration of
+ * one block, so neither user sees the other's operation half done.  If
+ * CCM or AAR preempts ECB (ERRORECB), the block is left to software.
+ */
+int
+crypto_hw_aes_ecb(const uint8_t *key, const uint8_t *in, uint8_t *out)
+{
+    struct crypto_nrf5x_ecb ecb;
+    os_sr_t sr;
+    int spins;
+    int rc;
+
+    memcpy(ecb.cne_key, key, sizeof ecb.cne_key);
+    memcpy(ecb.cne_plain, in, sizeof ecb.cne_plain);
+
+    rc = -1;
+
+    OS_ENTER_CRITICAL(sr);
+    NRF_ECB->TASKS_STOPECB = 1;
+    NRF_ECB->EVENTS_ENDECB = 0;
+    NRF_ECB->EVENTS_ERRORECB = 0;
+    NRF_ECB->ECBDATAPTR = (uint32_t)&ecb;
+    NRF_ECB->TASKS_STARTECB = 1;
+
+    for (spins = 0; spins < CRYPTO_NRF5X_ECB_SPINS; spins++) {
+        if (NRF_ECB->EVENTS_ENDECB) {
+            rc = 0;
+            break;
+        }
+        if (NRF_ECB->EVENTS_ERRORECB) {
+            break;
+        }
+    }
+    if (rc != 0) {
+        NRF_ECB->TASKS_STOPECB = 1;
+    }
+    NRF_ECB->EVENTS_ENDECB = 0;
+    NRF_ECB->EVENTS_ERRORECB = 0;
+    OS_EXIT_CRITICAL(sr);
+
+    if (rc == 0) {
+        memcpy(out, ecb.cne_cipher, sizeof ecb.cne_cipher);
+    }
+
+    /* The key is on the stack; don't leave it behind. */
+    memset(&ecb, 0, sizeof ecb);
+
+    return rc;
+}
+
+/*
+ * The nrf51/nrf52 have no public key accelerator; P-256 stays in software.
+ */
+int
+crypto_hw_p256_dhkey(const uint8_t *peer_pub, const uint8_t *priv,
+                     uint8_t *dhkey)
+{
+    return -1;
+}
+
+int
+crypto_hw_p256_verify(const uint8_t *pub, const uint8_t *hash,
+                      const uint8_t *sig, int *out_valid)
+{
+    return -1;
+}
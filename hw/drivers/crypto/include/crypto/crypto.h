@@ -0,0 +1,317 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef __CRYPTO_CRYPTO_H__
+#define __CRYPTO_CRYPTO_H__
+
+#include <inttypes.h>
+#include <stddef.h>
+#include "syscfg/syscfg.h"
+
+#if MYNEWT_VAL(CRYPTO_TINYCRYPT) + MYNEWT_VAL(CRYPTO_MBEDTLS) != 1
+#error "Exactly one of CRYPTO_TINYCRYPT and CRYPTO_MBEDTLS must be enabled"
+#endif
+
+#if MYNEWT_VAL(CRYPTO_TINYCRYPT)
+#include "tinycrypt/aes.h"
+#include "tinycrypt/sha256.h"
+#endif
+#if MYNEWT_VAL(CRYPTO_MBEDTLS)
+#include "mbedtls/aes.h"
+#include "mbedtls/sha256.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Common interface to the block cipher, hash and elliptic curve primitives
+ * used by the BLE host, mesh, LoRaWAN and the boot loader.  One software
+ * backend (tinycrypt or mbed TLS) is selected in syscfg; with CRYPTO_HW the
+ * MCU package can additionally take over individual operations (see
+ * crypto/crypto_hw.h).
+ *
+ * All byte strings are big-endian, as in the relevant NIST and IETF
+ * specifications.  Functions return 0 on success or a SYS_E[...] error
+ * code.
+ */
+
+#define CRYPTO_AES_KEY_LEN          16
+#define CRYPTO_AES_BLOCK_LEN        16
+#define CRYPTO_AES_CCM_NONCE_LEN    13
+#define CRYPTO_SHA256_LEN           32
+#define CRYPTO_P256_PRIV_LEN        32
+#define CRYPTO_P256_PUB_LEN         64
+#define CRYPTO_P256_DHKEY_LEN       32
+#define CRYPTO_P256_SIG_LEN         64
+
+/**
+ * An expanded AES-128 encryption key.  Key expansion costs several block
+ * encryptions' worth of work, so callers that use a key repeatedly should
+ * keep one of these around, or use the *_raw() functions, which go through
+ * an optional cache of expanded keys (CRYPTO_AES_KEY_CACHE_SIZE).
+ *
+ * The structure must not be copied; the mbed TLS schedule points into
+ * itself.
+ */
+struct crypto_aes_key {
+    uint8_t cak_raw[CRYPTO_AES_KEY_LEN];
+
+    /* CMAC subkeys, RFC 4493 section 2.3. */
+    uint8_t cak_k1[CRYPTO_AES_BLOCK_LEN];
+    uint8_t cak_k2[CRYPTO_AES_BLOCK_LEN];
+
+#if MYNEWT_VAL(CRYPTO_TINYCRYPT)
+    struct tc_aes_key_sched_struct cak_sched;
+#endif
+#if MYNEWT_VAL(CRYPTO_MBEDTLS)
+    mbedtls_aes_context cak_ctx;
+#endif
+};
+
+/** Running state of an AES-CMAC computation. */
+struct crypto_aes_cmac_ctx {
+    const struct crypto_aes_key *cac_key;
+    uint8_t cac_x[CRYPTO_AES_BLOCK_LEN];
+    uint8_t cac_buf[CRYPTO_AES_BLOCK_LEN];
+    uint8_t cac_len;
+};
+
+/** Running state of a SHA-256 computation. */
+struct crypto_sha256_ctx {
+#if MYNEWT_VAL(CRYPTO_TINYCRYPT)
+    struct tc_sha256_state_struct cs_state;
+#endif
+#if MYNEWT_VAL(CRYPTO_MBEDTLS)
+    mbedtls_sha256_context cs_ctx;
+#endif
+};
+
+/**
+ * Source of random bytes for key generation and for blinding the scalar
+ * multiplications.  Fills the buffer and returns 0, or returns nonzero on
+ * failure.
+ */
+typedef int crypto_rng_fn(void *arg, uint8_t *buf, size_t len);
+
+/**
+ * Expands a raw AES-128 key.
+ *
+ * @param key                   The key to initialize.
+ * @param raw                   The 16-byte key.
+ *
+ * @return                      0 on success; SYS_EINVAL on failure.
+ */
+int crypto_aes_key_init(struct crypto_aes_key *key, const uint8_t *raw);
+
+/**
+ * Wipes an expanded key.
+ */
+void crypto_aes_key_clear(struct crypto_aes_key *key);
+
+/**
+ * Encrypts a single block with AES-128 in ECB mode.  The input and output
+ * may overlap.
+ *
+ * @param key                   The expanded key.
+ * @param in                    The 16-byte plaintext.
+ * @param out                   On success, the 16-byte ciphertext.
+ *
+ * @return                      0 on success; nonzero on failure.
+ */
+int crypto_aes_ecb(const struct crypto_aes_key *key, const uint8_t *in,
+                   uint8_t *out);
+
+/**
+ * Begins an AES-CMAC (RFC 4493) computation.
+ */
+void crypto_aes_cmac_start(struct crypto_aes_cmac_ctx *ctx,
+                           const struct crypto_aes_key *key);
+
+/**
+ * Feeds message bytes to an AES-CMAC computation.
+ *
+ * @return                      0 on success; nonzero on failure.
+ */
+int crypto_aes_cmac_update(struct crypto_aes_cmac_ctx *ctx,
+                           const void *data, size_t len);
+
+/**
+ * Completes an AES-CMAC computation.
+ *
+ * @param mac                   On success, the 16-byte tag.
+ *
+ * @return                      0 on success; nonzero on failure.
+ */
+int crypto_aes_cmac_finish(struct crypto_aes_cmac_ctx *ctx, uint8_t *mac);
+
+/**
+ * Computes the AES-CMAC of a contiguous message.
+ */
+int crypto_aes_cmac(const struct crypto_aes_key *key, const void *data,
+                    size_t len, uint8_t *mac);
+
+/**
+ * Encrypts and authenticates a message with AES-CCM (RFC 3610) using a
+ * 13-byte nonce.  The plaintext and ciphertext may be the same buffer.
+ *
+ * @param key                   The expanded key.
+ * @param nonce                 The 13-byte nonce.
+ * @param aad                   Additional authenticated data; may be NULL
+ *                                  if aad_len is 0.
+ * @param aad_len               Length of the additional data; less than
+ *                                  0xff00.
+ * @param in                    The plaintext.
+ * @param len                   Length of the plaintext; at most 0xffff.
+ * @param out                   On success, the ciphertext (len bytes).
+ * @param mic                   On success, the authentication tag.
+ * @param mic_len               Length of the tag: 4, 6, ..., 16.
+ *
+ * @return                      0 on success; SYS_EINVAL on bad arguments.
+ */
+int crypto_aes_ccm_encrypt(const struct crypto_aes_key *key,
+                           const uint8_t *nonce,
+                           const void *aad, size_t aad_len,
+                           const uint8_t *in, size_t len, uint8_t *out,
+                           uint8_t *mic, size_t mic_len);
+
+/**
+ * Decrypts and verifies a message encrypted with crypto_aes_ccm_encrypt().
+ * The tag is compared in constant time; on mismatch the output is wiped.
+ *
+ * @return                      0 on success;
+ *                              SYS_EACCES if the tag does not match;
+ *                              SYS_EINVAL on bad arguments.
+ */
+int crypto_aes_ccm_decrypt(const struct crypto_aes_key *key,
+                           const uint8_t *nonce,
+                           const void *aad, size_t aad_len,
+                           const uint8_t *in, size_t len, uint8_t *out,
+                           const uint8_t *mic, size_t mic_len);
+
+/**
+ * Retrieves the expanded form of a raw key from the key cache, expanding it
+ * into the least recently used free cache slot on a miss.  The returned key
+ * stays valid until released with crypto_aes_key_cache_put().  If every
+ * slot is in use, the key is expanded into the caller-supplied scratch key
+ * instead.
+ *
+ * @param raw                   The 16-byte key.
+ * @param scratch               Fallback storage for the expanded key.
+ *
+ * @return                      The expanded key; NULL on failure.
+ */
+const struct crypto_aes_key *
+crypto_aes_key_cache_get(const uint8_t *raw, struct crypto_aes_key *scratch);
+
+/**
+ * Releases a key obtained with crypto_aes_key_cache_get().
+ */
+void crypto_aes_key_cache_put(const struct crypto_aes_key *key);
+
+/**
+ * Wipes every cached key.  A key that is currently in use is wiped when its
+ * last user releases it.  Call this when key material is deleted or
+ * revoked; e.g., on a mesh key refresh or at the end of a pairing.
+ */
+void crypto_aes_key_cache_flush(void);
+
+/*
+ * Raw-key variants of the functions above.  The key schedule is looked up
+ * in, or added to, the key cache.
+ */
+int crypto_aes_ecb_raw(const uint8_t *raw, const uint8_t *in, uint8_t *out);
+int crypto_aes_cmac_raw(const uint8_t *raw, const void *data, size_t len,
+                        uint8_t *mac);
+int crypto_aes_ccm_encrypt_raw(const uint8_t *raw, const uint8_t *nonce,
+                               const void *aad, size_t aad_len,
+                               const uint8_t *in, size_t len, uint8_t *out,
+                               uint8_t *mic, size_t mic_len);
+int crypto_aes_ccm_decrypt_raw(const uint8_t *raw, const uint8_t *nonce,
+                               const void *aad, size_t aad_len,
+                               const uint8_t *in, size_t len, uint8_t *out,
+                               const uint8_t *mic, size_t mic_len);
+
+/**
+ * SHA-256.  The start / update / finish functions hash a message in pieces;
+ * crypto_sha256() hashes a contiguous buffer.
+ */
+int crypto_sha256_start(struct crypto_sha256_ctx *ctx);
+int crypto_sha256_update(struct crypto_sha256_ctx *ctx, const void *data,
+                         size_t len);
+int crypto_sha256_finish(struct crypto_sha256_ctx *ctx, uint8_t *digest);
+int crypto_sha256(const void *data, size_t len, uint8_t *digest);
+
+/**
+ * Registers the random number source used for P-256 key generation when
+ * the caller does not supply one, and for side-channel blinding.
+ */
+void crypto_rng_set(crypto_rng_fn *rng, void *arg);
+
+/**
+ * Generates a P-256 key pair.
+ *
+ * @param pub                   On success, the public key (X || Y).
+ * @param priv                  On success, the private key.
+ * @param rng                   Random number source; NULL to use the one
+ *                                  registered with crypto_rng_set().
+ * @param arg                   Argument passed to the random source.
+ *
+ * @return                      0 on success;
+ *                              SYS_EINVAL if no random source is available;
+ *                              SYS_EUNKNOWN on failure.
+ */
+int crypto_p256_keypair_gen(uint8_t *pub, uint8_t *priv,
+                            crypto_rng_fn *rng, void *arg);
+
+/**
+ * Computes the P-256 Diffie-Hellman shared secret (the X coordinate of
+ * priv * peer_pub).  The peer's key is checked to be a point on the curve.
+ *
+ * @param peer_pub              The peer's public key (X || Y).
+ * @param priv                  The local private key.
+ * @param dhkey                 On success, the 32-byte shared secret.
+ *
+ * @return                      0 on success;
+ *                              SYS_EINVAL if the peer's key is invalid;
+ *                              SYS_EUNKNOWN on failure.
+ */
+int crypto_p256_dhkey(const uint8_t *peer_pub, const uint8_t *priv,
+                      uint8_t *dhkey);
+
+/**
+ * Verifies an ECDSA P-256 signature over a SHA-256 hash.
+ *
+ * @param pub                   The signer's public key (X || Y).
+ * @param hash                  The 32-byte message hash.
+ * @param sig                   The signature (R || S).
+ *
+ * @return                      0 if the signature is valid;
+ *                              SYS_EACCES if it is not;
+ *                              SYS_EINVAL if the public key is invalid.
+ */
+int crypto_p256_verify(const uint8_t *pub, const uint8_t *hash,
+                       const uint8_t *sig);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
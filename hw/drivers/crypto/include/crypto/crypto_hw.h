@@ -0,0 +1,58 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef __CRYPTO_CRYPTO_HW_H__
+#define __CRYPTO_CRYPTO_HW_H__
+
+#include <inttypes.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Hooks for MCU crypto accelerators.  With CRYPTO_HW enabled, the crypto
+ * package offers operations to these functions, which a backend package
+ * implements; e.g., hw/drivers/crypto/crypto_nrf5x.  Each returns 0 if the hardware performed the operation, or
+ * nonzero to leave it to the software backend; e.g., when the peripheral
+ * is shared with the radio and currently busy.
+ */
+
+/** Encrypts one block with a raw AES-128 key. */
+int crypto_hw_aes_ecb(const uint8_t *key, const uint8_t *in, uint8_t *out);
+
+/**
+ * Computes a P-256 shared secret.  The peer's public key has already been
+ * validated.
+ */
+int crypto_hw_p256_dhkey(const uint8_t *peer_pub, const uint8_t *priv,
+                         uint8_t *dhkey);
+
+/**
+ * Verifies an ECDSA P-256 signature; on success, *out_valid is set to 1 if
+ * the signature is good, 0 otherwise.
+ */
+int crypto_hw_p256_verify(const uint8_t *pub, const uint8_t *hash,
+                          const uint8_t *sig, int *out_valid);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,659 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <assert.h>
+#include <string.h>
+#include "os/os.h"
+#include "defs/error.h"
+#include "crypto/crypto.h"
+#include "crypto/crypto_hw.h"
+
+#if MYNEWT_VAL(CRYPTO_TINYCRYPT)
+#include "tinycrypt/constants.h"
+#endif
+
+#define CRYPTO_AES_KEY_CACHE_SIZE   MYNEWT_VAL(CRYPTO_AES_KEY_CACHE_SIZE)
+
+#if CRYPTO_AES_KEY_CACHE_SIZE > 0
+struct crypto_aes_key_cache_entry {
+    struct crypto_aes_key ckce_key;
+
+    /* Value of the cache clock when the entry was last handed out. */
+    uint32_t ckce_used;
+
+    /* Number of users holding the entry; a held entry is not evicted. */
+    uint8_t ckce_refs;
+
+    /* Whether ckce_key holds a fully expanded key. */
+    uint8_t ckce_valid;
+};
+
+static struct crypto_aes_key_cache_entry
+    crypto_aes_key_cache[CRYPTO_AES_KEY_CACHE_SIZE];
+static uint32_t crypto_aes_key_cache_clock;
+#endif
+
+static const uint8_t crypto_aes_zero_block[CRYPTO_AES_BLOCK_LEN];
+
+/**
+ * Doubles a value in GF(2^128), as used to derive the CMAC subkeys.
+ */
+static void
+crypto_aes_cmac_dbl(uint8_t *dst, const uint8_t *src)
+{
+    uint8_t carry;
+    int i;
+
+    carry = 0;
+    for (i = CRYPTO_AES_BLOCK_LEN - 1; i >= 0; i--) {
+        dst[i] = (src[i] << 1) | carry;
+        carry = src[i] >> 7;
+    }
+    if (carry) {
+        dst[CRYPTO_AES_BLOCK_LEN - 1] ^= 0x87;
+    }
+}
+
+static void
+crypto_aes_xor(uint8_t *dst, const uint8_t *src, int len)
+{
+    int i;
+
+    for (i = 0; i < len; i++) {
+        dst[i] ^= src[i];
+    }
+}
+
+int
+crypto_aes_key_init(struct crypto_aes_key *key, const uint8_t *raw)
+{
+    uint8_t l[CRYPTO_AES_BLOCK_LEN];
+    int rc;
+
+    memcpy(key->cak_raw, raw, CRYPTO_AES_KEY_LEN);
+
+#if MYNEWT_VAL(CRYPTO_TINYCRYPT)
+    if (tc_aes128_set_encrypt_key(&key->cak_sched, raw) != TC_CRYPTO_SUCCESS) {
+        return SYS_EINVAL;
+    }
+#endif
+#if MYNEWT_VAL(CRYPTO_MBEDTLS)
+    mbedtls_aes_init(&key->cak_ctx);
+    if (mbedtls_aes_setkey_enc(&key->cak_ctx, raw, 128) != 0) {
+        return SYS_EINVAL;
+    }
+#endif
+
+    rc = crypto_aes_ecb(key, crypto_aes_zero_block, l);
+    if (rc != 0) {
+        return rc;
+    }
+    crypto_aes_cmac_dbl(key->cak_k1, l);
+    crypto_aes_cmac_dbl(key->cak_k2, key->cak_k1);
+    memset(l, 0, sizeof l);
+
+    return 0;
+}
+
+void
+crypto_aes_key_clear(struct crypto_aes_key *key)
+{
+#if MYNEWT_VAL(CRYPTO_MBEDTLS)
+    mbedtls_aes_free(&key->cak_ctx);
+#endif
+    memset(key, 0, sizeof *key);
+}
+
+int
+crypto_aes_ecb(const struct crypto_aes_key *key, const uint8_t *in,
+               uint8_t *out)
+{
+#if MYNEWT_VAL(CRYPTO_HW)
+    if (crypto_hw_aes_ecb(key->cak_raw, in, out) == 0) {
+        return 0;
+    }
+#endif
+
+#if MYNEWT_VAL(CRYPTO_TINYCRYPT)
+    /* tinycrypt does not declare the schedule const, but only reads it. */
+    if (tc_aes_encrypt(out, in,
+                       (struct tc_aes_key_sched_struct *)&key->cak_sched) !=
+        TC_CRYPTO_SUCCESS) {
+
+        return SYS_EINVAL;
+    }
+#endif
+#if MYNEWT_VAL(CRYPTO_MBEDTLS)
+    if (mbedtls_aes_crypt_ecb((mbedtls_aes_context *)&key->cak_ctx,
+                              MBEDTLS_AES_ENCRYPT, in, out) != 0) {
+        return SYS_EINVAL;
+    }
+#endif
+
+    return 0;
+}
+
+void
+crypto_aes_cmac_start(struct crypto_aes_cmac_ctx *ctx,
+                      const struct crypto_aes_key *key)
+{
+    ctx->cac_key = key;
+    memset(ctx->cac_x, 0, sizeof ctx->cac_x);
+    ctx->cac_len = 0;
+}
+
+int
+crypto_aes_cmac_update(struct crypto_aes_cmac_ctx *ctx,
+                       const void *data, size_t len)
+{
+    const uint8_t *u8p;
+    size_t chunk;
+    int rc;
+
+    u8p = data;
+    while (len > 0) {
+        /* The last block gets special treatment in finish(), so a full
+         * buffer is only processed once more data arrives.
+         */
+        if (ctx->cac_len == CRYPTO_AES_BLOCK_LEN) {
+            crypto_aes_xor(ctx->cac_x, ctx->cac_buf, CRYPTO_AES_BLOCK_LEN);
+            rc = crypto_aes_ecb(ctx->cac_key, ctx->cac_x, ctx->cac_x);
+            if (rc != 0) {
+                return rc;
+            }
+            ctx->cac_len = 0;
+        }
+
+        chunk = CRYPTO_AES_BLOCK_LEN - ctx->cac_len;
+        if (chunk > len) {
+            chunk = len;
+        }
+        memcpy(ctx->cac_buf + ctx->cac_len, u8p, chunk);
+        ctx->cac_len += chunk;
+        u8p += chunk;
+        len -= chunk;
+    }
+
+    return 0;
+}
+
+int
+crypto_aes_cmac_finish(struct crypto_aes_cmac_ctx *ctx, uint8_t *mac)
+{
+    int rc;
+
+    if (ctx->cac_len == CRYPTO_AES_BLOCK_LEN) {
+        crypto_aes_xor(ctx->cac_x, ctx->cac_key->cak_k1, CRYPTO_AES_BLOCK_LEN);
+    } else {
+        memset(ctx->cac_buf + ctx->cac_len, 0,
+               CRYPTO_AES_BLOCK_LEN - ctx->cac_len);
+        ctx->cac_buf[ctx->cac_len] = 0x80;
+        crypto_aes_xor(ctx->cac_x, ctx->cac_key->cak_k2, CRYPTO_AES_BLOCK_LEN);
+    }
+    crypto_aes_xor(ctx->cac_x, ctx->cac_buf, CRYPTO_AES_BLOCK_LEN);
+
+    rc = crypto_aes_ecb(ctx->cac_key, ctx->cac_x, mac);
+
+    memset(ctx, 0, sizeof *ctx);
+    return rc;
+}
+
+int
+crypto_aes_cmac(const struct crypto_aes_key *key, const void *data,
+                size_t len, uint8_t *mac)
+{
+    struct crypto_aes_cmac_ctx ctx;
+    int rc;
+
+    crypto_aes_cmac_start(&ctx, key);
+    rc = crypto_aes_cmac_update(&ctx, data, len);
+    if (rc != 0) {
+        return rc;
+    }
+    return crypto_aes_cmac_finish(&ctx, mac);
+}
+
+/**
+ * Absorbs bytes into a CCM CBC-MAC.  *off is the number of bytes already
+ * XORed into the current block; a full block is encrypted immediately.
+ */
+static int
+crypto_aes_ccm_mac(const struct crypto_aes_key *key, uint8_t *x, int *off,
+                   const uint8_t *data, size_t len)
+{
+    size_t chunk;
+    int rc;
+
+    while (len > 0) {
+        chunk = CRYPTO_AES_BLOCK_LEN - *off;
+        if (chunk > len) {
+            chunk = len;
+        }
+        crypto_aes_xor(x + *off, data, chunk);
+        *off += chunk;
+        data += chunk;
+        len -= chunk;
+
+        if (*off == CRYPTO_AES_BLOCK_LEN) {
+            rc = crypto_aes_ecb(key, x, x);
+            if (rc != 0) {
+                return rc;
+            }
+            *off = 0;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Pads the CBC-MAC input with zeros to a block boundary.
+ */
+static int
+crypto_aes_ccm_mac_pad(const struct crypto_aes_key *key, uint8_t *x,
+                       int *off)
+{
+    if (*off == 0) {
+        return 0;
+    }
+    *off = 0;
+    return crypto_aes_ecb(key, x, x);
+}
+
+/**
+ * Common body of CCM encryption and decryption.  Computes the unencrypted
+ * CBC-MAC tag over the plaintext (which is the input when encrypting and
+ * the output when decrypting) and runs the CTR keystream over the message.
+ * On return, tag holds the tag already encrypted with keystream block 0.
+ */
+static int
+crypto_aes_ccm_crypt(const struct crypto_aes_key *key, const uint8_t *nonce,
+                     const void *aad, size_t aad_len,
+                     const uint8_t *in, size_t len, uint8_t *out,
+                     int encrypt, uint8_t *tag, size_t mic_len)
+{
+    uint8_t x[CRYPTO_AES_BLOCK_LEN];
+    uint8_t a[CRYPTO_AES_BLOCK_LEN];
+    uint8_t s[CRYPTO_AES_BLOCK_LEN];
+    uint16_t ctr;
+    size_t chunk;
+    size_t i;
+    int off;
+    int rc;
+
+    if (mic_len < 4 || mic_len > 16 || mic_len % 2 != 0 ||
+        aad_len >= 0xff00 || len > 0xffff ||
+        (aad_len > 0 && aad == NULL)) {
+
+        return SYS_EINVAL;
+    }
+
+    /* B0: flags || nonce || message length. */
+    x[0] = (aad_len > 0 ? 0x40 : 0) | (((mic_len - 2) / 2) << 3) | 0x01;
+    memcpy(x + 1, nonce, CRYPTO_AES_CCM_NONCE_LEN);
+    x[14] = len >> 8;
+    x[15] = len;
+    rc = crypto_aes_ecb(key, x, x);
+    if (rc != 0) {
+        goto done;
+    }
+
+    off = 0;
+    if (aad_len > 0) {
+        a[0] = aad_len >> 8;
+        a[1] = aad_len;
+        rc = crypto_aes_ccm_mac(key, x, &off, a, 2);
+        if (rc != 0) {
+            goto done;
+        }
+        rc = crypto_aes_ccm_mac(key, x, &off, aad, aad_len);
+        if (rc != 0) {
+            goto done;
+        }
+        rc = crypto_aes_ccm_mac_pad(key, x, &off);
+        if (rc != 0) {
+            goto done;
+        }
+    }
+
+    /* A_i: flags || nonce || counter. */
+    a[0] = 0x01;
+    memcpy(a + 1, nonce, CRYPTO_AES_CCM_NONCE_LEN);
+
+    ctr = 1;
+    for (i = 0; i < len; i += chunk) {
+        chunk = len - i;
+        if (chunk > CRYPTO_AES_BLOCK_LEN) {
+            chunk = CRYPTO_AES_BLOCK_LEN;
+        }
+
+        a[14] = ctr >> 8;
+        a[15] = ctr;
+        ctr++;
+        rc = crypto_aes_ecb(key, a, s);
+        if (rc != 0) {
+            goto done;
+        }
+
+        /* The input and output may be the same buffer; the chunk is fully
+         * read before it is overwritten.
+         */
+        if (encrypt) {
+            rc = crypto_aes_ccm_mac(key, x, &off, in + i, chunk);
+            if (rc != 0) {
+                goto done;
+            }
+            memmove(out + i, in + i, chunk);
+            crypto_aes_xor(out + i, s, chunk);
+        } else {
+            memmove(out + i, in + i, chunk);
+            crypto_aes_xor(out + i, s, chunk);
+            rc = crypto_aes_ccm_mac(key, x, &off, out + i, chunk);
+            if (rc != 0) {
+                goto done;
+            }
+        }
+    }
+    rc = crypto_aes_ccm_mac_pad(key, x, &off);
+    if (rc != 0) {
+        goto done;
+    }
+
+    a[14] = 0;
+    a[15] = 0;
+    rc = crypto_aes_ecb(key, a, s);
+    if (rc != 0) {
+        goto done;
+    }
+    memcpy(tag, x, mic_len);
+    crypto_aes_xor(tag, s, mic_len);
+
+done:
+    memset(x, 0, sizeof x);
+    memset(s, 0, sizeof s);
+    return rc;
+}
+
+int
+crypto_aes_ccm_encrypt(const struct crypto_aes_key *key,
+                       const uint8_t *nonce,
+                       const void *aad, size_t aad_len,
+                       const uint8_t *in, size_t len, uint8_t *out,
+                       uint8_t *mic, size_t mic_len)
+{
+    return crypto_aes_ccm_crypt(key, nonce, aad, aad_len, in, len, out, 1,
+                                mic, mic_len);
+}
+
+int
+crypto_aes_ccm_decrypt(const struct crypto_aes_key *key,
+                       const uint8_t *nonce,
+                       const void *aad, size_t aad_len,
+                       const uint8_t *in, size_t len, uint8_t *out,
+                       const uint8_t *mic, size_t mic_len)
+{
+    uint8_t tag[CRYPTO_AES_BLOCK_LEN];
+    uint8_t diff;
+    size_t i;
+    int rc;
+
+    rc = crypto_aes_ccm_crypt(key, nonce, aad, aad_len, in, len, out, 0,
+                              tag, mic_len);
+    if (rc != 0) {
+        memset(out, 0, len);
+        return rc;
+    }
+
+    diff = 0;
+    for (i = 0; i < mic_len; i++) {
+        diff |= tag[i] ^ mic[i];
+    }
+    if (diff != 0) {
+        memset(out, 0, len);
+        return SYS_EACCES;
+    }
+
+    return 0;
+}
+
+const struct crypto_aes_key *
+crypto_aes_key_cache_get(const uint8_t *raw, struct crypto_aes_key *scratch)
+{
+#if CRYPTO_AES_KEY_CACHE_SIZE > 0
+    struct crypto_aes_key_cache_entry *victim;
+    struct crypto_aes_key_cache_entry *entry;
+    os_sr_t sr;
+    int rc;
+    int i;
+
+    victim = NULL;
+
+    OS_ENTER_CRITICAL(sr);
+    for (i = 0; i < CRYPTO_AES_KEY_CACHE_SIZE; i++) {
+        entry = crypto_aes_key_cache + i;
+        if (entry->ckce_valid &&
+            memcmp(entry->ckce_key.cak_raw, raw, CRYPTO_AES_KEY_LEN) == 0) {
+
+            entry->ckce_refs++;
+            entry->ckce_used = ++crypto_aes_key_cache_clock;
+            OS_EXIT_CRITICAL(sr);
+            return &entry->ckce_key;
+        }
+
+        /* Prefer an empty slot, then the least recently used free one. */
+        if (entry->ckce_refs == 0) {
+            if (victim == NULL ||
+                (victim->ckce_valid && !entry->ckce_valid) ||
+                (victim->ckce_valid == entry->ckce_valid &&
+                 (int32_t)(entry->ckce_used - victim->ckce_used) < 0)) {
+
+                victim = entry;
+            }
+        }
+    }
+
+    if (victim != NULL) {
+        victim->ckce_refs = 1;
+        victim->ckce_valid = 0;
+        victim->ckce_used = ++crypto_aes_key_cache_clock;
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    if (victim != NULL) {
+        /* The slot is held but not yet valid, so nobody else touches it
+         * while the evicted key is wiped and the new schedule is expanded
+         * outside the critical section.
+         */
+        crypto_aes_key_clear(&victim->ckce_key);
+        rc = crypto_aes_key_init(&victim->ckce_key, raw);
+        if (rc != 0) {
+            crypto_aes_key_clear(&victim->ckce_key);
+        }
+
+        OS_ENTER_CRITICAL(sr);
+        if (rc == 0) {
+            victim->ckce_valid = 1;
+        } else {
+            victim->ckce_refs = 0;
+        }
+        OS_EXIT_CRITICAL(sr);
+
+        if (rc != 0) {
+            return NULL;
+        }
+        return &victim->ckce_key;
+    }
+#endif
+
+    if (crypto_aes_key_init(scratch, raw) != 0) {
+        crypto_aes_key_clear(scratch);
+        return NULL;
+    }
+    return scratch;
+}
+
+void
+crypto_aes_key_cache_put(const struct crypto_aes_key *key)
+{
+#if CRYPTO_AES_KEY_CACHE_SIZE > 0
+    struct crypto_aes_key_cache_entry *entry;
+    os_sr_t sr;
+    int i;
+
+    for (i = 0; i < CRYPTO_AES_KEY_CACHE_SIZE; i++) {
+        entry = crypto_aes_key_cache + i;
+        if (key == &entry->ckce_key) {
+            OS_ENTER_CRITICAL(sr);
+            assert(entry->ckce_refs > 0);
+            if (entry->ckce_refs > 1 || entry->ckce_valid) {
+                entry->ckce_refs--;
+                entry = NULL;
+            }
+            OS_EXIT_CRITICAL(sr);
+
+            if (entry != NULL) {
+                /* Last user of a flushed key; the slot is still held, so
+                 * wipe it before letting it go.
+                 */
+                crypto_aes_key_clear(&entry->ckce_key);
+
+                OS_ENTER_CRITICAL(sr);
+                entry->ckce_refs = 0;
+                OS_EXIT_CRITICAL(sr);
+            }
+            return;
+        }
+    }
+#endif
+
+    /* Not from the cache; a scratch key. */
+    crypto_aes_key_clear((struct crypto_aes_key *)key);
+}
+
+void
+crypto_aes_key_cache_flush(void)
+{
+#if CRYPTO_AES_KEY_CACHE_SIZE > 0
+    struct crypto_aes_key_cache_entry *entry;
+    os_sr_t sr;
+    int i;
+
+    for (i = 0; i < CRYPTO_AES_KEY_CACHE_SIZE; i++) {
+        entry = crypto_aes_key_cache + i;
+
+        OS_ENTER_CRITICAL(sr);
+        entry->ckce_valid = 0;
+        if (entry->ckce_refs == 0) {
+            /* Claim the slot so it can be wiped outside the critical
+             * section.
+             */
+            entry->ckce_refs = 1;
+        } else {
+            /* In use; the key is wiped when its last user releases it. */
+            entry = NULL;
+        }
+        OS_EXIT_CRITICAL(sr);
+
+        if (entry != NULL) {
+            crypto_aes_key_clear(&entry->ckce_key);
+
+            OS_ENTER_CRITICAL(sr);
+            entry->ckce_refs = 0;
+            OS_EXIT_CRITICAL(sr);
+        }
+    }
+#endif
+}
+
+int
+crypto_aes_ecb_raw(const uint8_t *raw, const uint8_t *in, uint8_t *out)
+{
+    const struct crypto_aes_key *key;
+    struct crypto_aes_key scratch;
+    int rc;
+
+    key = crypto_aes_key_cache_get(raw, &scratch);
+    if (key == NULL) {
+        return SYS_EINVAL;
+    }
+    rc = crypto_aes_ecb(key, in, out);
+    crypto_aes_key_cache_put(key);
+
+    return rc;
+}
+
+int
+crypto_aes_cmac_raw(const uint8_t *raw, const void *data, size_t len,
+                    uint8_t *mac)
+{
+    const struct crypto_aes_key *key;
+    struct crypto_aes_key scratch;
+    int rc;
+
+    key = crypto_aes_key_cache_get(raw, &scratch);
+    if (key == NULL) {
+        return SYS_EINVAL;
+    }
+    rc = crypto_aes_cmac(key, data, len, mac);
+    crypto_aes_key_cache_put(key);
+
+    return rc;
+}
+
+int
+crypto_aes_ccm_encrypt_raw(const uint8_t *raw, const uint8_t *nonce,
+                           const void *aad, size_t aad_len,
+                           const uint8_t *in, size_t len, uint8_t *out,
+                           uint8_t *mic, size_t mic_len)
+{
+    const struct crypto_aes_key *key;
+    struct crypto_aes_key scratch;
+    int rc;
+
+    key = crypto_aes_key_cache_get(raw, &scratch);
+    if (key == NULL) {
+        return SYS_EINVAL;
+    }
+    rc = crypto_aes_ccm_encrypt(key, nonce, aad, aad_len, in, len, out,
+                                mic, mic_len);
+    crypto_aes_key_cache_put(key);
+
+    return rc;
+}
+
+int
+crypto_aes_ccm_decrypt_raw(const uint8_t *raw, const uint8_t *nonce,
+                           const void *aad, size_t aad_len,
+                           const uint8_t *in, size_t len, uint8_t *out,
+                           const uint8_t *mic, size_t mic_len)
+{
+    const struct crypto_aes_key *key;
+    struct crypto_aes_key scratch;
+    int rc;
+
+    key = crypto_aes_key_cache_get(raw, &scratch);
+    if (key == NULL) {
+        return SYS_EINVAL;
+    }
+    rc = crypto_aes_ccm_decrypt(key, nonce, aad, aad_len, in, len, out,
+                                mic, mic_len);
+    crypto_aes_key_cache_put(key);
+
+    return rc;
+}
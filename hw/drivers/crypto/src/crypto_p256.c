@@ -0,0 +1,339 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "defs/error.h"
+#include "crypto/crypto.h"
+#include "crypto/crypto_hw.h"
+
+#if MYNEWT_VAL(CRYPTO_TINYCRYPT)
+#include "tinycrypt/constants.h"
+#include "tinycrypt/ecc.h"
+#include "tinycrypt/ecc_dh.h"
+#include "tinycrypt/ecc_dsa.h"
+#endif
+#if MYNEWT_VAL(CRYPTO_MBEDTLS)
+#include "mbedtls/ecdh.h"
+#include "mbedtls/ecdsa.h"
+#endif
+
+/* A random private key is out of range with probability ~2^-32, so running
+ * out of attempts means the random source is broken.
+ */
+#define CRYPTO_P256_KEYGEN_TRIES    16
+
+static crypto_rng_fn *crypto_rng;
+static void *crypto_rng_arg;
+
+#if MYNEWT_VAL(CRYPTO_TINYCRYPT)
+
+static int
+crypto_p256_uecc_rng(uint8_t *dst, unsigned int size)
+{
+    /* uECC expects 1 on success. */
+    return crypto_rng(crypto_rng_arg, dst, size) == 0;
+}
+
+void
+crypto_rng_set(crypto_rng_fn *rng, void *arg)
+{
+    crypto_rng = rng;
+    crypto_rng_arg = arg;
+    uECC_set_rng(rng != NULL ? crypto_p256_uecc_rng : NULL);
+}
+
+int
+crypto_p256_keypair_gen(uint8_t *pub, uint8_t *priv,
+                        crypto_rng_fn *rng, void *arg)
+{
+    int i;
+
+    if (rng == NULL) {
+        rng = crypto_rng;
+        arg = crypto_rng_arg;
+    }
+    if (rng == NULL) {
+        return SYS_EINVAL;
+    }
+
+    for (i = 0; i < CRYPTO_P256_KEYGEN_TRIES; i++) {
+        if (rng(arg, priv, CRYPTO_P256_PRIV_LEN) != 0) {
+            break;
+        }
+
+        /* Fails if the candidate is 0 or not less than the curve order. */
+        if (uECC_compute_public_key(priv, pub, uECC_secp256r1()) ==
+            TC_CRYPTO_SUCCESS) {
+
+            return 0;
+        }
+    }
+
+    memset(priv, 0, CRYPTO_P256_PRIV_LEN);
+    return SYS_EUNKNOWN;
+}
+
+int
+crypto_p256_dhkey(const uint8_t *peer_pub, const uint8_t *priv,
+                  uint8_t *dhkey)
+{
+    if (uECC_valid_public_key(peer_pub, uECC_secp256r1()) != 0) {
+        return SYS_EINVAL;
+    }
+
+#if MYNEWT_VAL(CRYPTO_HW)
+    if (crypto_hw_p256_dhkey(peer_pub, priv, dhkey) == 0) {
+        return 0;
+    }
+#endif
+
+    if (uECC_shared_secret(peer_pub, priv, dhkey, uECC_secp256r1()) !=
+        TC_CRYPTO_SUCCESS) {
+
+        return SYS_EUNKNOWN;
+    }
+
+    return 0;
+}
+
+int
+crypto_p256_verify(const uint8_t *pub, const uint8_t *hash,
+                   const uint8_t *sig)
+{
+#if MYNEWT_VAL(CRYPTO_HW)
+    int valid;
+#endif
+
+    if (uECC_valid_public_key(pub, uECC_secp256r1()) != 0) {
+        return SYS_EINVAL;
+    }
+
+#if MYNEWT_VAL(CRYPTO_HW)
+    if (crypto_hw_p256_verify(pub, hash, sig, &valid) == 0) {
+        return valid ? 0 : SYS_EACCES;
+    }
+#endif
+
+    if (uECC_verify(pub, hash, CRYPTO_SHA256_LEN, sig, uECC_secp256r1()) !=
+        TC_CRYPTO_SUCCESS) {
+
+        return SYS_EACCES;
+    }
+
+    return 0;
+}
+
+#endif
+
+#if MYNEWT_VAL(CRYPTO_MBEDTLS)
+
+struct crypto_p256_rng {
+    crypto_rng_fn *rng;
+    void *arg;
+};
+
+static int
+crypto_p256_mbedtls_rng(void *arg, unsigned char *buf, size_t len)
+{
+    struct crypto_p256_rng *r;
+
+    r = arg;
+    if (r->rng(r->arg, buf, len) != 0) {
+        return MBEDTLS_ERR_ECP_RANDOM_FAILED;
+    }
+    return 0;
+}
+
+void
+crypto_rng_set(crypto_rng_fn *rng, void *arg)
+{
+    crypto_rng = rng;
+    crypto_rng_arg = arg;
+}
+
+/**
+ * Loads the curve and, optionally, a public key, which is validated.
+ */
+static int
+crypto_p256_load(mbedtls_ecp_group *grp, mbedtls_ecp_point *q,
+                 const uint8_t *pub)
+{
+    uint8_t buf[1 + CRYPTO_P256_PUB_LEN];
+
+    if (mbedtls_ecp_group_load(grp, MBEDTLS_ECP_DP_SECP256R1) != 0) {
+        return SYS_EUNKNOWN;
+    }
+
+    if (pub != NULL) {
+        buf[0] = 0x04;  /* Uncompressed. */
+        memcpy(buf + 1, pub, CRYPTO_P256_PUB_LEN);
+        if (mbedtls_ecp_point_read_binary(grp, q, buf, sizeof buf) != 0 ||
+            mbedtls_ecp_check_pubkey(grp, q) != 0) {
+
+            return SYS_EINVAL;
+        }
+    }
+
+    return 0;
+}
+
+int
+crypto_p256_keypair_gen(uint8_t *pub, uint8_t *priv,
+                        crypto_rng_fn *rng, void *arg)
+{
+    uint8_t buf[1 + CRYPTO_P256_PUB_LEN];
+    struct crypto_p256_rng r;
+    mbedtls_ecp_group grp;
+    mbedtls_ecp_point q;
+    mbedtls_mpi d;
+    size_t olen;
+    int rc;
+
+    if (rng == NULL) {
+        rng = crypto_rng;
+        arg = crypto_rng_arg;
+    }
+    if (rng == NULL) {
+        return SYS_EINVAL;
+    }
+    r.rng = rng;
+    r.arg = arg;
+
+    mbedtls_ecp_group_init(&grp);
+    mbedtls_ecp_point_init(&q);
+    mbedtls_mpi_init(&d);
+
+    rc = crypto_p256_load(&grp, &q, NULL);
+    if (rc != 0) {
+        goto done;
+    }
+
+    if (mbedtls_ecp_gen_keypair(&grp, &d, &q, crypto_p256_mbedtls_rng,
+                                &r) != 0 ||
+        mbedtls_mpi_write_binary(&d, priv, CRYPTO_P256_PRIV_LEN) != 0 ||
+        mbedtls_ecp_point_write_binary(&grp, &q, MBEDTLS_ECP_PF_UNCOMPRESSED,
+                                       &olen, buf, sizeof buf) != 0 ||
+        olen != sizeof buf) {
+
+        rc = SYS_EUNKNOWN;
+        goto done;
+    }
+    memcpy(pub, buf + 1, CRYPTO_P256_PUB_LEN);
+
+done:
+    mbedtls_mpi_free(&d);
+    mbedtls_ecp_point_free(&q);
+    mbedtls_ecp_group_free(&grp);
+    return rc;
+}
+
+int
+crypto_p256_dhkey(const uint8_t *peer_pub, const uint8_t *priv,
+                  uint8_t *dhkey)
+{
+    struct crypto_p256_rng r;
+    mbedtls_ecp_group grp;
+    mbedtls_ecp_point q;
+    mbedtls_mpi d;
+    mbedtls_mpi z;
+    int rc;
+
+    mbedtls_ecp_group_init(&grp);
+    mbedtls_ecp_point_init(&q);
+    mbedtls_mpi_init(&d);
+    mbedtls_mpi_init(&z);
+
+    rc = crypto_p256_load(&grp, &q, peer_pub);
+    if (rc != 0) {
+        goto done;
+    }
+
+#if MYNEWT_VAL(CRYPTO_HW)
+    if (crypto_hw_p256_dhkey(peer_pub, priv, dhkey) == 0) {
+        goto done;
+    }
+#endif
+
+    r.rng = crypto_rng;
+    r.arg = crypto_rng_arg;
+    if (mbedtls_mpi_read_binary(&d, priv, CRYPTO_P256_PRIV_LEN) != 0 ||
+        mbedtls_ecdh_compute_shared(&grp, &z, &q, &d,
+                                    r.rng != NULL ?
+                                        crypto_p256_mbedtls_rng : NULL,
+                                    &r) != 0 ||
+        mbedtls_mpi_write_binary(&z, dhkey, CRYPTO_P256_DHKEY_LEN) != 0) {
+
+        rc = SYS_EUNKNOWN;
+    }
+
+done:
+    mbedtls_mpi_free(&z);
+    mbedtls_mpi_free(&d);
+    mbedtls_ecp_point_free(&q);
+    mbedtls_ecp_group_free(&grp);
+    return rc;
+}
+
+int
+crypto_p256_verify(const uint8_t *pub, const uint8_t *hash,
+                   const uint8_t *sig)
+{
+    mbedtls_ecp_group grp;
+    mbedtls_ecp_point q;
+    mbedtls_mpi r;
+    mbedtls_mpi s;
+#if MYNEWT_VAL(CRYPTO_HW)
+    int valid;
+#endif
+    int rc;
+
+    mbedtls_ecp_group_init(&grp);
+    mbedtls_ecp_point_init(&q);
+    mbedtls_mpi_init(&r);
+    mbedtls_mpi_init(&s);
+
+    rc = crypto_p256_load(&grp, &q, pub);
+    if (rc != 0) {
+        goto done;
+    }
+
+#if MYNEWT_VAL(CRYPTO_HW)
+    if (crypto_hw_p256_verify(pub, hash, sig, &valid) == 0) {
+        rc = valid ? 0 : SYS_EACCES;
+        goto done;
+    }
+#endif
+
+    if (mbedtls_mpi_read_binary(&r, sig, CRYPTO_P256_SIG_LEN / 2) != 0 ||
+        mbedtls_mpi_read_binary(&s, sig + CRYPTO_P256_SIG_LEN / 2,
+                                CRYPTO_P256_SIG_LEN / 2) != 0 ||
+        mbedtls_ecdsa_verify(&grp, hash, CRYPTO_SHA256_LEN, &q, &r, &s) != 0) {
+
+        rc = SYS_EACCES;
+    }
+
+done:
+    mbedtls_mpi_free(&s);
+    mbedtls_mpi_free(&r);
+    mbedtls_ecp_point_free(&q);
+    mbedtls_ecp_group_free(&grp);
+    return rc;
+}
+
+#endif
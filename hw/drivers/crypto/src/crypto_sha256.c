@@ -0,0 +1,101 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "defs/error.h"
+#include "crypto/crypto.h"
+
+#if MYNEWT_VAL(CRYPTO_TINYCRYPT)
+#include "tinycrypt/constants.h"
+#endif
+
+int
+crypto_sha256_start(struct crypto_sha256_ctx *ctx)
+{
+#if MYNEWT_VAL(CRYPTO_TINYCRYPT)
+    if (tc_sha256_init(&ctx->cs_state) != TC_CRYPTO_SUCCESS) {
+        return SYS_EINVAL;
+    }
+#endif
+#if MYNEWT_VAL(CRYPTO_MBEDTLS)
+    mbedtls_sha256_init(&ctx->cs_ctx);
+    if (mbedtls_sha256_starts_ret(&ctx->cs_ctx, 0) != 0) {
+        return SYS_EINVAL;
+    }
+#endif
+
+    return 0;
+}
+
+int
+crypto_sha256_update(struct crypto_sha256_ctx *ctx, const void *data,
+                     size_t len)
+{
+#if MYNEWT_VAL(CRYPTO_TINYCRYPT)
+    if (tc_sha256_update(&ctx->cs_state, data, len) != TC_CRYPTO_SUCCESS) {
+        return SYS_EINVAL;
+    }
+#endif
+#if MYNEWT_VAL(CRYPTO_MBEDTLS)
+    if (mbedtls_sha256_update_ret(&ctx->cs_ctx, data, len) != 0) {
+        return SYS_EINVAL;
+    }
+#endif
+
+    return 0;
+}
+
+int
+crypto_sha256_finish(struct crypto_sha256_ctx *ctx, uint8_t *digest)
+{
+    int rc;
+
+    rc = 0;
+
+#if MYNEWT_VAL(CRYPTO_TINYCRYPT)
+    if (tc_sha256_final(digest, &ctx->cs_state) != TC_CRYPTO_SUCCESS) {
+        rc = SYS_EINVAL;
+    }
+#endif
+#if MYNEWT_VAL(CRYPTO_MBEDTLS)
+    if (mbedtls_sha256_finish_ret(&ctx->cs_ctx, digest) != 0) {
+        rc = SYS_EINVAL;
+    }
+    mbedtls_sha256_free(&ctx->cs_ctx);
+#endif
+
+    return rc;
+}
+
+int
+crypto_sha256(const void *data, size_t len, uint8_t *digest)
+{
+    struct crypto_sha256_ctx ctx;
+    int rc;
+
+    rc = crypto_sha256_start(&ctx);
+    if (rc == 0) {
+        rc = crypto_sha256_update(&ctx, data, len);
+    }
+    if (rc == 0) {
+        rc = crypto_sha256_finish(&ctx, digest);
+    }
+
+    return rc;
+}
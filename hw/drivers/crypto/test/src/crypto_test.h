@@ -0,0 +1,57 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_CRYPTO_TEST_
+#define H_CRYPTO_TEST_
+
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * A crypto_rng_fn that hands out the scripted bytes in the structure pointed
+ * to by arg.  Once those run out, it either fails or, for backends that draw
+ * extra bytes for blinding, returns pseudo-random ones.
+ */
+struct crypto_test_rng {
+    const uint8_t *ctr_buf;
+    size_t ctr_len;
+    int ctr_fail;
+};
+int crypto_test_util_rng(void *arg, uint8_t *buf, size_t len);
+
+void crypto_test_util_fill(uint8_t *buf, int len, uint32_t seed);
+
+TEST_SUITE_DECL(crypto_test_suite);
+TEST_CASE_DECL(crypto_test_case_aes);
+TEST_CASE_DECL(crypto_test_case_cmac);
+TEST_CASE_DECL(crypto_test_case_ccm);
+TEST_CASE_DECL(crypto_test_case_key_cache);
+TEST_CASE_DECL(crypto_test_case_sha256);
+TEST_CASE_DECL(crypto_test_case_p256);
+TEST_CASE_DECL(crypto_test_case_bench);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,55 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "crypto_test.h"
+
+int
+crypto_test_util_rng(void *arg, uint8_t *buf, size_t len)
+{
+    struct crypto_test_rng *rng;
+
+    rng = arg;
+    if (rng->ctr_len == 0) {
+        if (rng->ctr_fail) {
+            return -1;
+        }
+        crypto_test_util_fill(buf, len, (uintptr_t)buf);
+        return 0;
+    }
+
+    if (len > rng->ctr_len) {
+        return -1;
+    }
+    memcpy(buf, rng->ctr_buf, len);
+    rng->ctr_buf += len;
+    rng->ctr_len -= len;
+    return 0;
+}
+
+void
+crypto_test_util_fill(uint8_t *buf, int len, uint32_t seed)
+{
+    int i;
+
+    for (i = 0; i < len; i++) {
+        seed = seed * 1103515245 + 12345;
+        buf[i] = seed >> 16;
+    }
+}
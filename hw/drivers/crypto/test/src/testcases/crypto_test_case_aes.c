@@ -0,0 +1,64 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "crypto/crypto.h"
+#include "crypto_test.h"
+
+/* FIPS-197, appendix C.1. */
+static const uint8_t crypto_test_aes_key[16] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+    0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+};
+static const uint8_t crypto_test_aes_pt[16] = {
+    0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+    0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff,
+};
+static const uint8_t crypto_test_aes_ct[16] = {
+    0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30,
+    0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a,
+};
+
+TEST_CASE(crypto_test_case_aes)
+{
+    struct crypto_aes_key key;
+    uint8_t buf[16];
+    int rc;
+
+    rc = crypto_aes_key_init(&key, crypto_test_aes_key);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = crypto_aes_ecb(&key, crypto_test_aes_pt, buf);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(memcmp(buf, crypto_test_aes_ct, 16) == 0);
+
+    /* In place. */
+    memcpy(buf, crypto_test_aes_pt, 16);
+    rc = crypto_aes_ecb(&key, buf, buf);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(memcmp(buf, crypto_test_aes_ct, 16) == 0);
+
+    /* Through the key cache. */
+    memset(buf, 0, sizeof buf);
+    rc = crypto_aes_ecb_raw(crypto_test_aes_key, crypto_test_aes_pt, buf);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(memcmp(buf, crypto_test_aes_ct, 16) == 0);
+
+    crypto_aes_key_clear(&key);
+}
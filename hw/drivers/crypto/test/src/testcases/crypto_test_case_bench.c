@@ -0,0 +1,163 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "crypto/crypto.h"
+#include "crypto_test.h"
+
+#define CRYPTO_TEST_BENCH_ROUNDS    1024
+
+/* Size of a mesh network PDU's encrypted portion. */
+#define CRYPTO_TEST_BENCH_PDU_LEN   29
+
+enum crypto_test_bench_op {
+    CRYPTO_TEST_BENCH_ECB_EXPAND,
+    CRYPTO_TEST_BENCH_ECB_RAW,
+    CRYPTO_TEST_BENCH_ECB,
+    CRYPTO_TEST_BENCH_CMAC,
+    CRYPTO_TEST_BENCH_CCM,
+    CRYPTO_TEST_BENCH_SHA256,
+    CRYPTO_TEST_BENCH_MAX,
+};
+
+static const char *crypto_test_bench_names[CRYPTO_TEST_BENCH_MAX] = {
+    [CRYPTO_TEST_BENCH_ECB_EXPAND]  = "aes-ecb, key expanded per call",
+    [CRYPTO_TEST_BENCH_ECB_RAW]     = "aes-ecb, raw key via cache",
+    [CRYPTO_TEST_BENCH_ECB]         = "aes-ecb, expanded key",
+    [CRYPTO_TEST_BENCH_CMAC]        = "aes-cmac, 29 bytes",
+    [CRYPTO_TEST_BENCH_CCM]         = "aes-ccm, 29 bytes",
+    [CRYPTO_TEST_BENCH_SHA256]      = "sha256, 1 KB",
+};
+
+static uint8_t crypto_test_bench_buf[1024];
+
+/*
+ * @return                      Time per operation, in nanoseconds.
+ */
+static uint32_t
+crypto_test_bench_run(enum crypto_test_bench_op op,
+                      struct crypto_aes_key *key)
+{
+    struct crypto_aes_key tmp;
+    uint8_t nonce[CRYPTO_AES_CCM_NONCE_LEN];
+    uint8_t out[CRYPTO_SHA256_LEN];
+    uint32_t start;
+    uint32_t usecs;
+    int i;
+
+    memset(nonce, 0, sizeof nonce);
+
+    start = os_cputime_get32();
+    for (i = 0; i < CRYPTO_TEST_BENCH_ROUNDS; i++) {
+        switch (op) {
+        case CRYPTO_TEST_BENCH_ECB_EXPAND:
+            crypto_aes_key_init(&tmp, key->cak_raw);
+            crypto_aes_ecb(&tmp, crypto_test_bench_buf, out);
+            crypto_aes_key_clear(&tmp);
+            break;
+
+        case CRYPTO_TEST_BENCH_ECB_RAW:
+            crypto_aes_ecb_raw(key->cak_raw, crypto_test_bench_buf, out);
+            break;
+
+        case CRYPTO_TEST_BENCH_ECB:
+            crypto_aes_ecb(key, crypto_test_bench_buf, out);
+            break;
+
+        case CRYPTO_TEST_BENCH_CMAC:
+            crypto_aes_cmac_raw(key->cak_raw, crypto_test_bench_buf,
+                                CRYPTO_TEST_BENCH_PDU_LEN, out);
+            break;
+
+        case CRYPTO_TEST_BENCH_CCM:
+            crypto_aes_ccm_encrypt_raw(key->cak_raw, nonce, NULL, 0,
+                                       crypto_test_bench_buf,
+                                       CRYPTO_TEST_BENCH_PDU_LEN,
+                                       crypto_test_bench_buf, out, 8);
+            break;
+
+        case CRYPTO_TEST_BENCH_SHA256:
+            crypto_sha256(crypto_test_bench_buf,
+                          sizeof crypto_test_bench_buf, out);
+            break;
+
+        default:
+            break;
+        }
+    }
+    usecs = os_cputime_ticks_to_usecs(os_cputime_get32() - start);
+
+    return (uint64_t)usecs * 1000 / CRYPTO_TEST_BENCH_ROUNDS;
+}
+
+static uint32_t
+crypto_test_bench_p256(void)
+{
+    static const uint8_t priv[32] = { [31] = 0x2a };
+    uint8_t pub[CRYPTO_P256_PUB_LEN];
+    uint8_t dhkey[CRYPTO_P256_DHKEY_LEN];
+    struct crypto_test_rng rng;
+    uint32_t start;
+    int rc;
+
+    rng.ctr_buf = priv;
+    rng.ctr_len = sizeof priv;
+    rng.ctr_fail = 0;
+    rc = crypto_p256_keypair_gen(pub, dhkey, crypto_test_util_rng, &rng);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    start = os_cputime_get32();
+    rc = crypto_p256_dhkey(pub, priv, dhkey);
+    TEST_ASSERT(rc == 0);
+
+    return os_cputime_ticks_to_usecs(os_cputime_get32() - start);
+}
+
+/*
+ * Reports the cost of each primitive with the configured backend, and of
+ * AES with and without key schedule reuse.
+ */
+TEST_CASE(crypto_test_case_bench)
+{
+    struct crypto_aes_key key;
+    uint32_t ns[CRYPTO_TEST_BENCH_MAX];
+    int op;
+    int rc;
+
+    crypto_test_util_fill(crypto_test_bench_buf,
+                          sizeof crypto_test_bench_buf, 7);
+
+    rc = crypto_aes_key_init(&key, crypto_test_bench_buf);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    for (op = 0; op < CRYPTO_TEST_BENCH_MAX; op++) {
+        ns[op] = crypto_test_bench_run(op, &key);
+        printf("%s: %lu ns\n", crypto_test_bench_names[op],
+               (unsigned long)ns[op]);
+    }
+    printf("p256 dhkey: %lu us\n", (unsigned long)crypto_test_bench_p256());
+
+    if (MYNEWT_VAL(CRYPTO_AES_KEY_CACHE_SIZE) > 0) {
+        TEST_ASSERT(ns[CRYPTO_TEST_BENCH_ECB_RAW] <
+                    ns[CRYPTO_TEST_BENCH_ECB_EXPAND]);
+    }
+
+    crypto_aes_key_clear(&key);
+}
@@ -0,0 +1,124 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "crypto/crypto.h"
+#include "crypto_test.h"
+
+/* RFC 3610, packet vector #1. */
+static const uint8_t crypto_test_ccm_key[16] = {
+    0xc0, 0xc1, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7,
+    0xc8, 0xc9, 0xca, 0xcb, 0xcc, 0xcd, 0xce, 0xcf,
+};
+static const uint8_t crypto_test_ccm_nonce[13] = {
+    0x00, 0x00, 0x00, 0x03, 0x02, 0x01, 0x00, 0xa0,
+    0xa1, 0xa2, 0xa3, 0xa4, 0xa5,
+};
+static const uint8_t crypto_test_ccm_aad[8] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+};
+static const uint8_t crypto_test_ccm_pt[23] = {
+    0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+    0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17,
+    0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e,
+};
+static const uint8_t crypto_test_ccm_ct[23] = {
+    0x58, 0x8c, 0x97, 0x9a, 0x61, 0xc6, 0x63, 0xd2,
+    0xf0, 0x66, 0xd0, 0xc2, 0xc0, 0xf9, 0x89, 0x80,
+    0x6d, 0x5f, 0x6b, 0x61, 0xda, 0xc3, 0x84,
+};
+static const uint8_t crypto_test_ccm_mic[8] = {
+    0x17, 0xe8, 0xd1, 0x2c, 0xfd, 0xf9, 0x26, 0xe0,
+};
+
+TEST_CASE(crypto_test_case_ccm)
+{
+    struct crypto_aes_key key;
+    uint8_t buf[sizeof crypto_test_ccm_pt];
+    uint8_t mic[16];
+    uint8_t mic2[16];
+    int rc;
+
+    rc = crypto_aes_key_init(&key, crypto_test_ccm_key);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = crypto_aes_ccm_encrypt(&key, crypto_test_ccm_nonce,
+                                crypto_test_ccm_aad, sizeof crypto_test_ccm_aad,
+                                crypto_test_ccm_pt, sizeof buf, buf, mic, 8);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(memcmp(buf, crypto_test_ccm_ct, sizeof buf) == 0);
+    TEST_ASSERT(memcmp(mic, crypto_test_ccm_mic, 8) == 0);
+
+    /* Decrypt in place. */
+    rc = crypto_aes_ccm_decrypt(&key, crypto_test_ccm_nonce,
+                                crypto_test_ccm_aad, sizeof crypto_test_ccm_aad,
+                                buf, sizeof buf, buf, mic, 8);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(memcmp(buf, crypto_test_ccm_pt, sizeof buf) == 0);
+
+    /* Encrypt in place through the key cache. */
+    rc = crypto_aes_ccm_encrypt_raw(crypto_test_ccm_key, crypto_test_ccm_nonce,
+                                    crypto_test_ccm_aad,
+                                    sizeof crypto_test_ccm_aad,
+                                    buf, sizeof buf, buf, mic, 8);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(memcmp(buf, crypto_test_ccm_ct, sizeof buf) == 0);
+    TEST_ASSERT(memcmp(mic, crypto_test_ccm_mic, 8) == 0);
+
+    /* A corrupted tag is rejected and the output wiped. */
+    mic[3] ^= 0x10;
+    rc = crypto_aes_ccm_decrypt_raw(crypto_test_ccm_key, crypto_test_ccm_nonce,
+                                    crypto_test_ccm_aad,
+                                    sizeof crypto_test_ccm_aad,
+                                    crypto_test_ccm_ct, sizeof buf, buf,
+                                    mic, 8);
+    TEST_ASSERT(rc == SYS_EACCES);
+    TEST_ASSERT(buf[0] == 0 && buf[sizeof buf - 1] == 0);
+
+    /* So is a corrupted ciphertext. */
+    memcpy(buf, crypto_test_ccm_ct, sizeof buf);
+    buf[20] ^= 0x01;
+    rc = crypto_aes_ccm_decrypt(&key, crypto_test_ccm_nonce,
+                                crypto_test_ccm_aad, sizeof crypto_test_ccm_aad,
+                                buf, sizeof buf, buf, crypto_test_ccm_mic, 8);
+    TEST_ASSERT(rc == SYS_EACCES);
+
+    /* No additional data, 4-byte tag; round trip. */
+    rc = crypto_aes_ccm_encrypt(&key, crypto_test_ccm_nonce, NULL, 0,
+                                crypto_test_ccm_pt, sizeof buf, buf, mic, 4);
+    TEST_ASSERT(rc == 0);
+    rc = crypto_aes_ccm_encrypt(&key, crypto_test_ccm_nonce, NULL, 0,
+                                crypto_test_ccm_pt, sizeof buf, buf, mic2, 16);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(memcmp(mic, mic2, 4) != 0);
+    rc = crypto_aes_ccm_decrypt(&key, crypto_test_ccm_nonce, NULL, 0,
+                                buf, sizeof buf, buf, mic2, 16);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(memcmp(buf, crypto_test_ccm_pt, sizeof buf) == 0);
+
+    /* Invalid tag lengths. */
+    rc = crypto_aes_ccm_encrypt(&key, crypto_test_ccm_nonce, NULL, 0,
+                                crypto_test_ccm_pt, sizeof buf, buf, mic, 5);
+    TEST_ASSERT(rc == SYS_EINVAL);
+    rc = crypto_aes_ccm_encrypt(&key, crypto_test_ccm_nonce, NULL, 0,
+                                crypto_test_ccm_pt, sizeof buf, buf, mic, 2);
+    TEST_ASSERT(rc == SYS_EINVAL);
+
+    crypto_aes_key_clear(&key);
+}
@@ -0,0 +1,96 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "crypto/crypto.h"
+#include "crypto_test.h"
+
+/* RFC 4493, section 4. */
+static const uint8_t crypto_test_cmac_key[16] = {
+    0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
+    0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c,
+};
+static const uint8_t crypto_test_cmac_msg[64] = {
+    0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96,
+    0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a,
+    0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c,
+    0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51,
+    0x30, 0xc8, 0x1c, 0x46, 0xa3, 0x5c, 0xe4, 0x11,
+    0xe5, 0xfb, 0xc1, 0x19, 0x1a, 0x0a, 0x52, 0xef,
+    0xf6, 0x9f, 0x24, 0x45, 0xdf, 0x4f, 0x9b, 0x17,
+    0xad, 0x2b, 0x41, 0x7b, 0xe6, 0x6c, 0x37, 0x10,
+};
+
+static const struct {
+    int len;
+    uint8_t mac[16];
+} crypto_test_cmac_vectors[] = {
+    { 0, { 0xbb, 0x1d, 0x69, 0x29, 0xe9, 0x59, 0x37, 0x28,
+           0x7f, 0xa3, 0x7d, 0x12, 0x9b, 0x75, 0x67, 0x46 } },
+    { 16, { 0x07, 0x0a, 0x16, 0xb4, 0x6b, 0x4d, 0x41, 0x44,
+            0xf7, 0x9b, 0xdd, 0x9d, 0xd0, 0x4a, 0x28, 0x7c } },
+    { 40, { 0xdf, 0xa6, 0x67, 0x47, 0xde, 0x9a, 0xe6, 0x30,
+            0x30, 0xca, 0x32, 0x61, 0x14, 0x97, 0xc8, 0x27 } },
+    { 64, { 0x51, 0xf0, 0xbe, 0xbf, 0x7e, 0x3b, 0x9d, 0x92,
+            0xfc, 0x49, 0x74, 0x17, 0x79, 0x36, 0x3c, 0xfe } },
+};
+
+#define CRYPTO_TEST_CMAC_NUM_VECTORS                                    \
+    (sizeof crypto_test_cmac_vectors / sizeof crypto_test_cmac_vectors[0])
+
+TEST_CASE(crypto_test_case_cmac)
+{
+    struct crypto_aes_cmac_ctx ctx;
+    struct crypto_aes_key key;
+    uint8_t mac[16];
+    int chunk;
+    int off;
+    int rc;
+    int i;
+
+    rc = crypto_aes_key_init(&key, crypto_test_cmac_key);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    for (i = 0; i < CRYPTO_TEST_CMAC_NUM_VECTORS; i++) {
+        rc = crypto_aes_cmac(&key, crypto_test_cmac_msg,
+                             crypto_test_cmac_vectors[i].len, mac);
+        TEST_ASSERT(rc == 0);
+        TEST_ASSERT(memcmp(mac, crypto_test_cmac_vectors[i].mac, 16) == 0);
+
+        rc = crypto_aes_cmac_raw(crypto_test_cmac_key, crypto_test_cmac_msg,
+                                 crypto_test_cmac_vectors[i].len, mac);
+        TEST_ASSERT(rc == 0);
+        TEST_ASSERT(memcmp(mac, crypto_test_cmac_vectors[i].mac, 16) == 0);
+
+        /* Fed in pieces that straddle block boundaries. */
+        for (chunk = 1; chunk <= 17; chunk += 8) {
+            crypto_aes_cmac_start(&ctx, &key);
+            for (off = 0; off < crypto_test_cmac_vectors[i].len; off += chunk) {
+                rc = crypto_aes_cmac_update(&ctx, crypto_test_cmac_msg + off,
+                    min(chunk, crypto_test_cmac_vectors[i].len - off));
+                TEST_ASSERT(rc == 0);
+            }
+            rc = crypto_aes_cmac_finish(&ctx, mac);
+            TEST_ASSERT(rc == 0);
+            TEST_ASSERT(memcmp(mac, crypto_test_cmac_vectors[i].mac, 16) == 0);
+        }
+    }
+
+    crypto_aes_key_clear(&key);
+}
@@ -0,0 +1,118 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "crypto/crypto.h"
+#include "crypto_test.h"
+
+#define CRYPTO_TEST_CACHE_SIZE  MYNEWT_VAL(CRYPTO_AES_KEY_CACHE_SIZE)
+
+static void
+crypto_test_cache_key(uint8_t *raw, int idx)
+{
+    memset(raw, 0xa5, CRYPTO_AES_KEY_LEN);
+    raw[0] = idx;
+}
+
+TEST_CASE(crypto_test_case_key_cache)
+{
+    const struct crypto_aes_key *keys[CRYPTO_TEST_CACHE_SIZE + 1];
+    const struct crypto_aes_key *key;
+    struct crypto_aes_key scratch;
+    uint8_t raw[CRYPTO_AES_KEY_LEN];
+    int i;
+
+    crypto_aes_key_cache_flush();
+
+    /* Repeated lookups of a key hit the same slot. */
+    crypto_test_cache_key(raw, 0);
+    keys[0] = crypto_aes_key_cache_get(raw, &scratch);
+    TEST_ASSERT_FATAL(keys[0] != NULL);
+    TEST_ASSERT(memcmp(keys[0]->cak_raw, raw, sizeof raw) == 0);
+    crypto_aes_key_cache_put(keys[0]);
+
+    key = crypto_aes_key_cache_get(raw, &scratch);
+    TEST_ASSERT(key == keys[0]);
+    crypto_aes_key_cache_put(key);
+
+    if (CRYPTO_TEST_CACHE_SIZE == 0) {
+        TEST_ASSERT(keys[0] == &scratch);
+        return;
+    }
+    TEST_ASSERT(keys[0] != &scratch);
+
+    /* Held keys are never evicted; once every slot is held, the scratch key
+     * is used.
+     */
+    for (i = 0; i <= CRYPTO_TEST_CACHE_SIZE; i++) {
+        crypto_test_cache_key(raw, i);
+        keys[i] = crypto_aes_key_cache_get(raw, &scratch);
+        TEST_ASSERT_FATAL(keys[i] != NULL);
+        TEST_ASSERT(memcmp(keys[i]->cak_raw, raw, sizeof raw) == 0);
+    }
+    TEST_ASSERT(keys[0] != &scratch);
+    TEST_ASSERT(keys[CRYPTO_TEST_CACHE_SIZE] == &scratch);
+    for (i = 0; i <= CRYPTO_TEST_CACHE_SIZE; i++) {
+        crypto_aes_key_cache_put(keys[i]);
+    }
+
+    /* The scratch key is wiped on release. */
+    TEST_ASSERT(scratch.cak_raw[0] == 0 && scratch.cak_raw[1] == 0);
+
+    if (CRYPTO_TEST_CACHE_SIZE > 1) {
+        /* Touch key 0; the least recently used slot is now key 1's. */
+        crypto_test_cache_key(raw, 0);
+        key = crypto_aes_key_cache_get(raw, &scratch);
+        TEST_ASSERT(key == keys[0]);
+        crypto_aes_key_cache_put(key);
+
+        crypto_test_cache_key(raw, 0x80);
+        key = crypto_aes_key_cache_get(raw, &scratch);
+        TEST_ASSERT(key == keys[1]);
+        crypto_aes_key_cache_put(key);
+
+        crypto_test_cache_key(raw, 0);
+        key = crypto_aes_key_cache_get(raw, &scratch);
+        TEST_ASSERT(key == keys[0]);
+        crypto_aes_key_cache_put(key);
+    }
+
+    /* Flushing wipes free slots; a held slot keeps its key for its user but
+     * no longer matches lookups.
+     */
+    crypto_test_cache_key(raw, 0);
+    key = crypto_aes_key_cache_get(raw, &scratch);
+    TEST_ASSERT(key == keys[0]);
+
+    crypto_aes_key_cache_flush();
+    TEST_ASSERT(memcmp(key->cak_raw, raw, sizeof raw) == 0);
+    for (i = 1; i < CRYPTO_TEST_CACHE_SIZE; i++) {
+        TEST_ASSERT(keys[i]->cak_raw[0] == 0 && keys[i]->cak_raw[1] == 0);
+    }
+
+    keys[1] = crypto_aes_key_cache_get(raw, &scratch);
+    TEST_ASSERT(keys[1] != key);
+    crypto_aes_key_cache_put(keys[1]);
+
+    /* The flushed slot is wiped once its last user releases it. */
+    crypto_aes_key_cache_put(key);
+    TEST_ASSERT(key->cak_raw[0] == 0 && key->cak_raw[1] == 0);
+
+    crypto_aes_key_cache_flush();
+}
@@ -0,0 +1,144 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "crypto/crypto.h"
+#include "crypto_test.h"
+
+/* Key pair A is the Bluetooth LE Secure Connections debug key. */
+static const uint8_t crypto_test_p256_priv_a[32] = {
+    0x3f, 0x49, 0xf6, 0xd4, 0xa3, 0xc5, 0x5f, 0x38,
+    0x74, 0xc9, 0xb3, 0xe3, 0xd2, 0x10, 0x3f, 0x50,
+    0x4a, 0xff, 0x60, 0x7b, 0xeb, 0x40, 0xb7, 0x99,
+    0x58, 0x99, 0xb8, 0xa6, 0xcd, 0x3c, 0x1a, 0xbd,
+};
+static const uint8_t crypto_test_p256_pub_a[64] = {
+    0x20, 0xb0, 0x03, 0xd2, 0xf2, 0x97, 0xbe, 0x2c,
+    0x5e, 0x2c, 0x83, 0xa7, 0xe9, 0xf9, 0xa5, 0xb9,
+    0xef, 0xf4, 0x91, 0x11, 0xac, 0xf4, 0xfd, 0xdb,
+    0xcc, 0x03, 0x01, 0x48, 0x0e, 0x35, 0x9d, 0xe6,
+    0xdc, 0x80, 0x9c, 0x49, 0x65, 0x2a, 0xeb, 0x6d,
+    0x63, 0x32, 0x9a, 0xbf, 0x5a, 0x52, 0x15, 0x5c,
+    0x76, 0x63, 0x45, 0xc2, 0x8f, 0xed, 0x30, 0x24,
+    0x74, 0x1c, 0x8e, 0xd0, 0x15, 0x89, 0xd2, 0x8b,
+};
+static const uint8_t crypto_test_p256_priv_b[32] = {
+    0xb6, 0x8e, 0x70, 0x7e, 0x39, 0x4c, 0x26, 0x67,
+    0x3f, 0x41, 0x24, 0x21, 0x03, 0x80, 0xbd, 0x0f,
+    0xb3, 0x48, 0x31, 0x71, 0xd7, 0xeb, 0xab, 0xac,
+    0xb8, 0xec, 0xad, 0xc6, 0xc2, 0xd6, 0xc9, 0x1e,
+};
+static const uint8_t crypto_test_p256_pub_b[64] = {
+    0xed, 0xba, 0x35, 0x1b, 0x9c, 0xd7, 0xb0, 0x26,
+    0x9c, 0x1d, 0x3c, 0xc0, 0x71, 0x07, 0x83, 0x27,
+    0xc7, 0x56, 0x83, 0x2a, 0x20, 0x40, 0x8d, 0x77,
+    0xde, 0x98, 0x4c, 0x6f, 0x35, 0x3a, 0x1f, 0x0a,
+    0x0c, 0x3b, 0x92, 0xee, 0x65, 0xdb, 0x3d, 0xfa,
+    0xf4, 0xc8, 0xcc, 0x38, 0x24, 0x03, 0x75, 0xfd,
+    0xa1, 0x48, 0xd5, 0x70, 0x59, 0x8b, 0x6b, 0x66,
+    0x4e, 0x17, 0x85, 0xfb, 0x4b, 0xa2, 0xd8, 0x17,
+};
+static const uint8_t crypto_test_p256_dhkey[32] = {
+    0xde, 0x42, 0x81, 0xba, 0x36, 0x8c, 0xcf, 0x38,
+    0x7a, 0x1d, 0x52, 0x06, 0x6d, 0xb7, 0x81, 0x06,
+    0xee, 0x0a, 0x00, 0xa1, 0xa1, 0x2e, 0xf6, 0x53,
+    0xa7, 0xcf, 0xac, 0x57, 0x00, 0x4c, 0x16, 0xed,
+};
+
+/* ECDSA signature by key B over SHA-256("abc"). */
+static const uint8_t crypto_test_p256_hash[32] = {
+    0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea,
+    0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+    0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c,
+    0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad,
+};
+static const uint8_t crypto_test_p256_sig[64] = {
+    0x8b, 0x90, 0xc0, 0x1e, 0x6c, 0x2d, 0xe8, 0xd8,
+    0x9c, 0xb9, 0x2c, 0x11, 0x0e, 0xa9, 0xe5, 0x88,
+    0x74, 0xf8, 0x4f, 0xe5, 0xcb, 0x94, 0xf5, 0x2b,
+    0x31, 0x2f, 0x3c, 0xc6, 0x7a, 0xd3, 0xfa, 0xf8,
+    0xfc, 0x03, 0xbd, 0x26, 0x16, 0xd1, 0x85, 0xcb,
+    0x7d, 0xdc, 0x77, 0x49, 0x7b, 0xf3, 0x00, 0xb0,
+    0x6b, 0x3c, 0x07, 0xf6, 0x47, 0x3d, 0x41, 0x88,
+    0xb1, 0x7d, 0x2c, 0x28, 0x65, 0x23, 0xa2, 0xaf,
+};
+
+TEST_CASE(crypto_test_case_p256)
+{
+    struct crypto_test_rng rng;
+    uint8_t pub[64];
+    uint8_t priv[32];
+    uint8_t dhkey[32];
+    uint8_t buf[64];
+    int rc;
+
+    /* With the private key drawn from a fixed "random" source, key
+     * generation yields key pair A.  The all-ones candidate drawn first is
+     * not less than the curve order and is skipped.
+     */
+    memset(buf, 0xff, 32);
+    memcpy(buf + 32, crypto_test_p256_priv_a, 32);
+    rng.ctr_buf = buf;
+    rng.ctr_len = sizeof buf;
+    rng.ctr_fail = 0;
+    rc = crypto_p256_keypair_gen(pub, priv, crypto_test_util_rng, &rng);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(memcmp(priv, crypto_test_p256_priv_a, 32) == 0);
+    TEST_ASSERT(memcmp(pub, crypto_test_p256_pub_a, 64) == 0);
+
+    /* A failing random source. */
+    rng.ctr_len = 0;
+    rng.ctr_fail = 1;
+    rc = crypto_p256_keypair_gen(pub, priv, crypto_test_util_rng, &rng);
+    TEST_ASSERT(rc != 0);
+
+    /* Both sides arrive at the same shared secret. */
+    rc = crypto_p256_dhkey(crypto_test_p256_pub_b, crypto_test_p256_priv_a,
+                           dhkey);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(memcmp(dhkey, crypto_test_p256_dhkey, 32) == 0);
+
+    rc = crypto_p256_dhkey(crypto_test_p256_pub_a, crypto_test_p256_priv_b,
+                           dhkey);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(memcmp(dhkey, crypto_test_p256_dhkey, 32) == 0);
+
+    /* A point off the curve is rejected. */
+    memcpy(pub, crypto_test_p256_pub_b, 64);
+    pub[63] ^= 0x01;
+    rc = crypto_p256_dhkey(pub, crypto_test_p256_priv_a, dhkey);
+    TEST_ASSERT(rc == SYS_EINVAL);
+
+    rc = crypto_p256_verify(crypto_test_p256_pub_b, crypto_test_p256_hash,
+                            crypto_test_p256_sig);
+    TEST_ASSERT(rc == 0);
+
+    memcpy(buf, crypto_test_p256_sig, 64);
+    buf[40] ^= 0x01;
+    rc = crypto_p256_verify(crypto_test_p256_pub_b, crypto_test_p256_hash,
+                            buf);
+    TEST_ASSERT(rc == SYS_EACCES);
+
+    rc = crypto_p256_verify(crypto_test_p256_pub_a, crypto_test_p256_hash,
+                            crypto_test_p256_sig);
+    TEST_ASSERT(rc == SYS_EACCES);
+
+    rc = crypto_p256_verify(pub, crypto_test_p256_hash, crypto_test_p256_sig);
+    TEST_ASSERT(rc == SYS_EINVAL);
+}
@@ -0,0 +1,71 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "crypto/crypto.h"
+#include "crypto_test.h"
+
+/* FIPS 180-2, appendix B.1. */
+static const uint8_t crypto_test_sha256_abc[32] = {
+    0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea,
+    0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+    0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c,
+    0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad,
+};
+
+/* SHA-256 of the bytes 0, 1, ..., 255, 0, 1, ... (1000 bytes). */
+static const uint8_t crypto_test_sha256_long[32] = {
+    0xa8, 0xaf, 0x09, 0x9b, 0xf2, 0xe8, 0x78, 0x60,
+    0x95, 0x58, 0xdb, 0xf6, 0x9d, 0x8f, 0x88, 0xf4,
+    0xa3, 0x10, 0x40, 0xa8, 0xcf, 0x84, 0xb5, 0x49,
+    0xa0, 0xcf, 0xa9, 0x12, 0xf1, 0x2f, 0xfc, 0x3f,
+};
+
+TEST_CASE(crypto_test_case_sha256)
+{
+    struct crypto_sha256_ctx ctx;
+    uint8_t digest[32];
+    uint8_t buf[1000];
+    int off;
+    int rc;
+    int i;
+
+    rc = crypto_sha256("abc", 3, digest);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(memcmp(digest, crypto_test_sha256_abc, 32) == 0);
+
+    for (i = 0; i < sizeof buf; i++) {
+        buf[i] = i;
+    }
+
+    rc = crypto_sha256(buf, sizeof buf, digest);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(memcmp(digest, crypto_test_sha256_long, 32) == 0);
+
+    /* In uneven pieces. */
+    rc = crypto_sha256_start(&ctx);
+    TEST_ASSERT_FATAL(rc == 0);
+    for (off = 0; off < sizeof buf; off += 37) {
+        rc = crypto_sha256_update(&ctx, buf + off, min(37, sizeof buf - off));
+        TEST_ASSERT(rc == 0);
+    }
+    rc = crypto_sha256_finish(&ctx, digest);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(memcmp(digest, crypto_test_sha256_long, 32) == 0);
+}
@@ -22,6 +22,9 @@
 
 #include "os/mynewt.h"
 #include "sensor/sensor.h"
+#if MYNEWT_VAL(MPU6050_READ_ASYNC)
+#include "sensor/bus.h"
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -74,6 +77,16 @@ struct mpu6050 {
     struct sensor sensor;
     struct mpu6050_cfg cfg;
     os_time_t last_read_time;
+#if MYNEWT_VAL(MPU6050_READ_ASYNC)
+    /* Asynchronous read in progress */
+    struct sensor_bus_xfer read_xfer;
+    uint8_t read_reg;
+    /* Accelerometer, temperature and gyroscope registers */
+    uint8_t read_buf[14];
+    sensor_type_t read_type;
+    sensor_data_func_t read_func;
+    void *read_arg;
+#endif
 };
 
 int mpu6050_reset(struct sensor_itf *itf);
@@ -56,10 +56,17 @@ static int mpu6050_sensor_read(struct sensor *, sensor_type_t,
         sensor_data_func_t, void *, uint32_t);
 static int mpu6050_sensor_get_config(struct sensor *, sensor_type_t,
         struct sensor_cfg *);
+#if MYNEWT_VAL(MPU6050_READ_ASYNC)
+static int mpu6050_sensor_read_async(struct sensor *, sensor_type_t,
+        sensor_data_func_t, void *);
+#endif
 
 static const struct sensor_driver g_mpu6050_sensor_driver = {
-    mpu6050_sensor_read,
-    mpu6050_sensor_get_config
+    .sd_read = mpu6050_sensor_read,
+    .sd_get_config = mpu6050_sensor_get_config,
+#if MYNEWT_VAL(MPU6050_READ_ASYNC)
+    .sd_read_async = mpu6050_sensor_read_async,
+#endif
 };
 
 /**
@@ -521,15 +528,91 @@ mpu6050_config(struct mpu6050 *mpu, struct mpu6050_cfg *cfg)
     return 0;
 }
 
+/**
+ * Converts a raw accelerometer sample, as read from ACCEL_XOUT_H onwards.
+ */
+static void
+mpu6050_accel_convert(const struct mpu6050 *mpu, const uint8_t *payload,
+                      struct sensor_accel_data *sad)
+{
+    int16_t x, y, z;
+    float lsb;
+
+    x = (((int16_t)payload[0]) << 8) | payload[1];
+    y = (((int16_t)payload[2]) << 8) | payload[3];
+    z = (((int16_t)payload[4]) << 8) | payload[5];
+
+    switch (mpu->cfg.accel_range) {
+        case MPU6050_ACCEL_RANGE_2: /* +/- 2g - 16384 LSB/g */
+        /* Falls through */
+        default:
+            lsb = 16384.0F;
+        break;
+        case MPU6050_ACCEL_RANGE_4: /* +/- 4g - 8192 LSB/g */
+            lsb = 8192.0F;
+        break;
+        case MPU6050_ACCEL_RANGE_8: /* +/- 8g - 4096 LSB/g */
+            lsb = 4096.0F;
+        break;
+        case MPU6050_ACCEL_RANGE_16: /* +/- 16g - 2048 LSB/g */
+            lsb = 2048.0F;
+        break;
+    }
+
+    sad->sad_x = (x / lsb) * STANDARD_ACCEL_GRAVITY;
+    sad->sad_x_is_valid = 1;
+    sad->sad_y = (y / lsb) * STANDARD_ACCEL_GRAVITY;
+    sad->sad_y_is_valid = 1;
+    sad->sad_z = (z / lsb) * STANDARD_ACCEL_GRAVITY;
+    sad->sad_z_is_valid = 1;
+}
+
+/**
+ * Converts a raw gyroscope sample, as read from GYRO_XOUT_H onwards.
+ */
+static void
+mpu6050_gyro_convert(const struct mpu6050 *mpu, const uint8_t *payload,
+                     struct sensor_gyro_data *sgd)
+{
+    int16_t x, y, z;
+    float lsb;
+
+    x = (((int16_t)payload[0]) << 8) | payload[1];
+    y = (((int16_t)payload[2]) << 8) | payload[3];
+    z = (((int16_t)payload[4]) << 8) | payload[5];
+
+    switch (mpu->cfg.gyro_range) {
+        case MPU6050_GYRO_RANGE_250: /* +/- 250 Deg/s - 131 LSB/Deg/s */
+        /* Falls through */
+        default:
+            lsb = 131.0F;
+        break;
+        case MPU6050_GYRO_RANGE_500: /* +/- 500 Deg/s - 65.5 LSB/Deg/s */
+            lsb = 65.5F;
+        break;
+        case MPU6050_GYRO_RANGE_1000: /* +/- 1000 Deg/s - 32.8 LSB/Deg/s */
+            lsb = 32.8F;
+        break;
+        case MPU6050_GYRO_RANGE_2000: /* +/- 2000 Deg/s - 16.4 LSB/Deg/s */
+            lsb = 16.4F;
+        break;
+    }
+
+    sgd->sgd_x = x / lsb;
+    sgd->sgd_x_is_valid = 1;
+    sgd->sgd_y = y / lsb;
+    sgd->sgd_y_is_valid = 1;
+    sgd->sgd_z = z / lsb;
+    sgd->sgd_z_is_valid = 1;
+}
+
 static int
 mpu6050_sensor_read(struct sensor *sensor, sensor_type_t type,
         sensor_data_func_t data_func, void *data_arg, uint32_t timeout)
 {
     (void)timeout;
     int rc;
-    int16_t x, y, z;
     uint8_t payload[6];
-    float lsb;
     struct sensor_itf *itf;
     struct mpu6050 *mpu;
     union {
@@ -553,33 +636,7 @@ mpu6050_sensor_read(struct sensor *sensor, sensor_type_t type,
             return rc;
         }
 
-        x = (((int16_t)payload[0]) << 8) | payload[1];
-        y = (((int16_t)payload[2]) << 8) | payload[3];
-        z = (((int16_t)payload[4]) << 8) | payload[5];
-
-        switch (mpu->cfg.accel_range) {
-            case MPU6050_ACCEL_RANGE_2: /* +/- 2g - 16384 LSB/g */
-            /* Falls through */
-            default:
-                lsb = 16384.0F;
-            break;
-            case MPU6050_ACCEL_RANGE_4: /* +/- 4g - 8192 LSB/g */
-                lsb = 8192.0F;
-            break;
-            case MPU6050_ACCEL_RANGE_8: /* +/- 8g - 4096 LSB/g */
-                lsb = 4096.0F;
-            break;
-            case MPU6050_ACCEL_RANGE_16: /* +/- 16g - 2048 LSB/g */
-                lsb = 2048.0F;
-            break;
-        }
-
-        databuf.sad.sad_x = (x / lsb) * STANDARD_ACCEL_GRAVITY;
-        databuf.sad.sad_x_is_valid = 1;
-        databuf.sad.sad_y = (y / lsb) * STANDARD_ACCEL_GRAVITY;
-        databuf.sad.sad_y_is_valid = 1;
-        databuf.sad.sad_z = (z / lsb) * STANDARD_ACCEL_GRAVITY;
-        databuf.sad.sad_z_is_valid = 1;
+        mpu6050_accel_convert(mpu, payload, &databuf.sad);
 
         rc = data_func(sensor, data_arg, &databuf.sad,
                 SENSOR_TYPE_ACCELEROMETER);
@@ -595,33 +652,7 @@ mpu6050_sensor_read(struct sensor *sensor, sensor_type_t type,
             return rc;
         }
 
-        x = (((int16_t)payload[0]) << 8) | payload[1];
-        y = (((int16_t)payload[2]) << 8) | payload[3];
-        z = (((int16_t)payload[4]) << 8) | payload[5];
-
-        switch (mpu->cfg.gyro_range) {
-            case MPU6050_GYRO_RANGE_250: /* +/- 250 Deg/s - 131 LSB/Deg/s */
-            /* Falls through */
-            default:
-                lsb = 131.0F;
-            break;
-            case MPU6050_GYRO_RANGE_500: /* +/- 500 Deg/s - 65.5 LSB/Deg/s */
-                lsb = 65.5F;
-            break;
-            case MPU6050_GYRO_RANGE_1000: /* +/- 1000 Deg/s - 32.8 LSB/Deg/s */
-                lsb = 32.8F;
-            break;
-            case MPU6050_GYRO_RANGE_2000: /* +/- 2000 Deg/s - 16.4 LSB/Deg/s */
-                lsb = 16.4F;
-            break;
-        }
-
-        databuf.sgd.sgd_x = x / lsb;
-        databuf.sgd.sgd_x_is_valid = 1;
-        databuf.sgd.sgd_y = y / lsb;
-        databuf.sgd.sgd_y_is_valid = 1;
-        databuf.sgd.sgd_z = z / lsb;
-        databuf.sgd.sgd_z_is_valid = 1;
+        mpu6050_gyro_convert(mpu, payload, &databuf.sgd);
 
         rc = data_func(sensor, data_arg, &databuf.sgd, SENSOR_TYPE_GYROSCOPE);
         if (rc) {
@@ -632,6 +663,104 @@ mpu6050_sensor_read(struct sensor *sensor, sensor_type_t type,
     return 0;
 }
 
+#if MYNEWT_VAL(MPU6050_READ_ASYNC)
+
+/**
+ * Completion of the bus transfer started by mpu6050_sensor_read_async().
+ * Runs on the sensor bus event queue.
+ */
+static void
+mpu6050_read_xfer_cb(struct sensor_bus_xfer *xfer, int status)
+{
+    struct mpu6050 *mpu;
+    const uint8_t *gyro;
+    union {
+        struct sensor_accel_data sad;
+        struct sensor_gyro_data sgd;
+    } databuf;
+
+    mpu = xfer->sbx_arg;
+
+    if (status) {
+        STATS_INC(g_mpu6050stats, read_errors);
+        goto done;
+    }
+
+    gyro = mpu->read_buf;
+
+    if (mpu->read_type & SENSOR_TYPE_ACCELEROMETER) {
+        mpu6050_accel_convert(mpu, mpu->read_buf, &databuf.sad);
+
+        status = mpu->read_func(&mpu->sensor, mpu->read_arg, &databuf.sad,
+                                SENSOR_TYPE_ACCELEROMETER);
+        if (status) {
+            goto done;
+        }
+
+        /* The burst went on through the temperature to the gyroscope */
+        gyro += MPU6050_GYRO_XOUT_H - MPU6050_ACCEL_XOUT_H;
+    }
+
+    if (mpu->read_type & SENSOR_TYPE_GYROSCOPE) {
+        mpu6050_gyro_convert(mpu, gyro, &databuf.sgd);
+
+        status = mpu->read_func(&mpu->sensor, mpu->read_arg, &databuf.sgd,
+                                SENSOR_TYPE_GYROSCOPE);
+    }
+
+done:
+    sensor_read_async_done(&mpu->sensor, status);
+}
+
+/**
+ * Queues a read of the requested samples on the sensor bus and returns
+ * without waiting for it.  Accelerometer and gyroscope are read in a
+ * single burst.
+ */
+static int
+mpu6050_sensor_read_async(struct sensor *sensor, sensor_type_t type,
+        sensor_data_func_t data_func, void *data_arg)
+{
+    struct sensor_bus_xfer *xfer;
+    struct mpu6050 *mpu;
+
+    /* If the read isn't looking for accel or gyro, don't do anything. */
+    if (!(type & SENSOR_TYPE_ACCELEROMETER) &&
+       (!(type & SENSOR_TYPE_GYROSCOPE))) {
+        return SYS_EINVAL;
+    }
+
+    mpu = (struct mpu6050 *) SENSOR_GET_DEVICE(sensor);
+    xfer = &mpu->read_xfer;
+
+    mpu->read_type = type & (SENSOR_TYPE_ACCELEROMETER |
+                             SENSOR_TYPE_GYROSCOPE);
+    mpu->read_func = data_func;
+    mpu->read_arg = data_arg;
+
+    if (type & SENSOR_TYPE_ACCELEROMETER) {
+        mpu->read_reg = MPU6050_ACCEL_XOUT_H;
+    } else {
+        mpu->read_reg = MPU6050_GYRO_XOUT_H;
+    }
+
+    memset(xfer, 0, sizeof(*xfer));
+    xfer->sbx_wbuf = &mpu->read_reg;
+    xfer->sbx_wlen = 1;
+    xfer->sbx_rbuf = mpu->read_buf;
+    if ((type & SENSOR_TYPE_ACCELEROMETER) && (type & SENSOR_TYPE_GYROSCOPE)) {
+        xfer->sbx_rlen = sizeof(mpu->read_buf);
+    } else {
+        xfer->sbx_rlen = 6;
+    }
+    xfer->sbx_cb = mpu6050_read_xfer_cb;
+    xfer->sbx_arg = mpu;
+
+    return sensor_itf_submit(SENSOR_GET_ITF(sensor), xfer);
+}
+
+#endif
+
 static int
 mpu6050_sensor_get_config(struct sensor *sensor, sensor_type_t type,
         struct sensor_cfg *cfg)
@@ -0,0 +1,198 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "os/mynewt.h"
+#include "sensor/sensor.h"
+#include "sensor/bus.h"
+#include "sensor/accel.h"
+#include "sensor/gyro.h"
+#include "mpu6050/mpu6050.h"
+#include "mpu6050_test.h"
+
+#define MTCRA_LATENCY       2
+
+/* MPU6050_ACCEL_XOUT_H and MPU6050_GYRO_XOUT_H */
+#define MTCRA_REG_ACCEL     0x3b
+#define MTCRA_REG_GYRO      0x43
+
+static struct mpu6050 mtcra_mpu;
+static struct sensor_bus_sim mtcra_bus;
+static uint8_t mtcra_regs[0x80];
+
+static struct sensor_accel_data mtcra_sad;
+static struct sensor_gyro_data mtcra_sgd;
+static int mtcra_num_accel;
+static int mtcra_num_gyro;
+static int mtcra_num_done;
+static int mtcra_status;
+
+static void
+mtcra_set_reg16(uint8_t reg, int16_t val)
+{
+    mtcra_regs[reg] = (uint16_t)val >> 8;
+    mtcra_regs[reg + 1] = (uint16_t)val & 0xff;
+}
+
+static int
+mtcra_data_func(struct sensor *sensor, void *arg, void *data,
+                sensor_type_t type)
+{
+    if (type == SENSOR_TYPE_ACCELEROMETER) {
+        mtcra_sad = *(struct sensor_accel_data *)data;
+        mtcra_num_accel++;
+    } else if (type == SENSOR_TYPE_GYROSCOPE) {
+        mtcra_sgd = *(struct sensor_gyro_data *)data;
+        mtcra_num_gyro++;
+    }
+
+    return 0;
+}
+
+static void
+mtcra_done_func(struct sensor *sensor, void *arg, int status)
+{
+    mtcra_status = status;
+    mtcra_num_done++;
+}
+
+static void
+mtcra_reset(void)
+{
+    memset(&mtcra_sad, 0, sizeof mtcra_sad);
+    memset(&mtcra_sgd, 0, sizeof mtcra_sgd);
+    mtcra_num_accel = 0;
+    mtcra_num_gyro = 0;
+    mtcra_num_done = 0;
+    mtcra_status = -1;
+}
+
+static void
+mtcra_run_ticks(int ticks)
+{
+    struct os_event *ev;
+    int i;
+
+    for (i = 0; i < ticks; i++) {
+        os_time_advance(1);
+        os_callout_tick();
+
+        while ((ev = os_eventq_get_no_wait(sensor_mgr_evq_get())) != NULL) {
+            ev->ev_cb(ev);
+        }
+    }
+}
+
+TEST_CASE(mpu6050_test_case_read_async)
+{
+    struct sensor_itf itf;
+    int rc;
+
+    sysinit();
+
+    /* 1g, -0.5g, 0 at +/- 4g; 2, -10, 0 deg/s at +/- 500 deg/s */
+    memset(mtcra_regs, 0, sizeof mtcra_regs);
+    mtcra_set_reg16(MTCRA_REG_ACCEL, 8192);
+    mtcra_set_reg16(MTCRA_REG_ACCEL + 2, -4096);
+    mtcra_set_reg16(MTCRA_REG_GYRO, 131);
+    mtcra_set_reg16(MTCRA_REG_GYRO + 2, -655);
+
+    rc = sensor_bus_sim_init(&mtcra_bus, SENSOR_ITF_I2C, 0, mtcra_regs,
+                             sizeof mtcra_regs, MTCRA_LATENCY);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    memset(&mtcra_mpu, 0, sizeof mtcra_mpu);
+    mtcra_mpu.dev.od_name = "mpu6050_0";
+
+    memset(&itf, 0, sizeof itf);
+    itf.si_type = SENSOR_ITF_I2C;
+    itf.si_num = 0;
+    itf.si_addr = MPU6050_I2C_ADDR;
+
+    rc = mpu6050_init(&mtcra_mpu.dev, &itf);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /* mpu6050_config() would program these over the bus. */
+    mtcra_mpu.cfg.accel_range = MPU6050_ACCEL_RANGE_4;
+    mtcra_mpu.cfg.gyro_range = MPU6050_GYRO_RANGE_500;
+    sensor_set_type_mask(&mtcra_mpu.sensor, SENSOR_TYPE_ALL);
+
+    /*** Both samples come from a single burst, read without blocking. */
+    mtcra_reset();
+    rc = sensor_read_async(&mtcra_mpu.sensor,
+                           SENSOR_TYPE_ACCELEROMETER | SENSOR_TYPE_GYROSCOPE,
+                           mtcra_data_func, NULL, mtcra_done_func, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(mtcra_num_done == 0);
+
+    mtcra_run_ticks(MTCRA_LATENCY);
+
+    TEST_ASSERT(mtcra_num_done == 1);
+    TEST_ASSERT(mtcra_status == 0);
+    TEST_ASSERT(mtcra_bus.sbs_xfers == 1);
+    TEST_ASSERT(mtcra_num_accel == 1);
+    TEST_ASSERT(mtcra_num_gyro == 1);
+
+    TEST_ASSERT(mtcra_sad.sad_x_is_valid && mtcra_sad.sad_y_is_valid &&
+                mtcra_sad.sad_z_is_valid);
+    TEST_ASSERT(mtcra_sad.sad_x == STANDARD_ACCEL_GRAVITY);
+    TEST_ASSERT(mtcra_sad.sad_y == -0.5F * STANDARD_ACCEL_GRAVITY);
+    TEST_ASSERT(mtcra_sad.sad_z == 0.0F);
+
+    TEST_ASSERT(mtcra_sgd.sgd_x_is_valid && mtcra_sgd.sgd_y_is_valid &&
+                mtcra_sgd.sgd_z_is_valid);
+    TEST_ASSERT(mtcra_sgd.sgd_x == 2.0F);
+    TEST_ASSERT(mtcra_sgd.sgd_y == -10.0F);
+    TEST_ASSERT(mtcra_sgd.sgd_z == 0.0F);
+
+    /*** Gyroscope only; the accelerometer is not reported. */
+    mtcra_reset();
+    rc = sensor_read_async(&mtcra_mpu.sensor, SENSOR_TYPE_GYROSCOPE,
+                           mtcra_data_func, NULL, mtcra_done_func, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    mtcra_run_ticks(MTCRA_LATENCY);
+
+    TEST_ASSERT(mtcra_num_done == 1);
+    TEST_ASSERT(mtcra_status == 0);
+    TEST_ASSERT(mtcra_bus.sbs_xfers == 2);
+    TEST_ASSERT(mtcra_num_accel == 0);
+    TEST_ASSERT(mtcra_num_gyro == 1);
+    TEST_ASSERT(mtcra_sgd.sgd_y == -10.0F);
+
+    /*** A failed transfer reaches the done callback without data. */
+    mtcra_bus.sbs_nregs = MTCRA_REG_GYRO;
+    mtcra_reset();
+    rc = sensor_read_async(&mtcra_mpu.sensor,
+                           SENSOR_TYPE_ACCELEROMETER | SENSOR_TYPE_GYROSCOPE,
+                           mtcra_data_func, NULL, mtcra_done_func, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    mtcra_run_ticks(MTCRA_LATENCY);
+
+    TEST_ASSERT(mtcra_num_done == 1);
+    TEST_ASSERT(mtcra_status == SYS_EINVAL);
+    TEST_ASSERT(mtcra_num_accel == 0);
+    TEST_ASSERT(mtcra_num_gyro == 0);
+
+    /*** Types the driver does not have are refused up front. */
+    rc = sensor_read_async(&mtcra_mpu.sensor, SENSOR_TYPE_LIGHT,
+                           mtcra_data_func, NULL, mtcra_done_func, NULL);
+    TEST_ASSERT(rc != 0);
+}
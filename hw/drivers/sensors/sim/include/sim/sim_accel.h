@@ -32,6 +32,8 @@ struct sim_accel_cfg {
     uint8_t sac_nr_axises;
     uint16_t sac_sample_itvl;
     sensor_type_t sac_mask;
+    /* Report readings in their fixed point representation */
+    uint8_t sac_fixed;
 };
 
 struct sim_accel {
@@ -86,6 +86,9 @@ sim_accel_config(struct sim_accel *sa, struct sim_accel_cfg *cfg)
     /* Overwrite the configuration associated with this generic accelleromter. */
     memcpy(&sa->sa_cfg, cfg, sizeof(*cfg));
 
+    sensor_set_fixed_types(&sa->sa_sensor,
+                           cfg->sac_fixed ? SENSOR_TYPE_ACCELEROMETER : 0);
+
     return (0);
 }
 
@@ -95,6 +98,8 @@ sim_accel_sensor_read(struct sensor *sensor, sensor_type_t type,
 {
     struct sim_accel *sa;
     struct sensor_accel_data sad;
+    struct sensor_accel_data_fixed sadf;
+    void *data;
     os_time_t now;
     uint32_t num_samples;
     int i;
@@ -137,9 +142,23 @@ sim_accel_sensor_read(struct sensor *sensor, sensor_type_t type,
         sad.sad_z = 0.0;
     }
 
+    data = &sad;
+    if (sa->sa_cfg.sac_fixed) {
+        /* Same readings, no float involved. */
+        sadf.sad_x = SENSOR_FIXED_FROM_INT(0, SENSOR_ACCEL_FIXED_SHIFT);
+        sadf.sad_y = SENSOR_FIXED_FROM_INT(0, SENSOR_ACCEL_FIXED_SHIFT);
+        sadf.sad_z = SENSOR_FIXED_FROM_INT(0, SENSOR_ACCEL_FIXED_SHIFT);
+
+        sadf.sad_x_is_valid = sad.sad_x_is_valid;
+        sadf.sad_y_is_valid = sad.sad_y_is_valid;
+        sadf.sad_z_is_valid = sad.sad_z_is_valid;
+
+        data = &sadf;
+    }
+
     /* Call data function for each of the generated readings. */
     for (i = 0; i < num_samples; i++) {
-        rc = data_func(sensor, data_arg, &sad, SENSOR_TYPE_ACCELEROMETER);
+        rc = data_func(sensor, data_arg, data, SENSOR_TYPE_ACCELEROMETER);
         if (rc != 0) {
             goto err;
         }
@@ -41,6 +41,22 @@ struct sensor_accel_data {
     uint8_t sad_z_is_valid:1;
 } __attribute__((packed));
 
+/* Fixed point representation of struct sensor_accel_data.
+ * All values are in Q16.16 m/s^2
+ */
+#define SENSOR_ACCEL_FIXED_SHIFT SENSOR_FIXED_SHIFT
+
+struct sensor_accel_data_fixed {
+    sensor_fixed_t sad_x;
+    sensor_fixed_t sad_y;
+    sensor_fixed_t sad_z;
+
+    /* Validity */
+    uint8_t sad_x_is_valid:1;
+    uint8_t sad_y_is_valid:1;
+    uint8_t sad_z_is_valid:1;
+} __attribute__((packed));
+
 #ifdef __cplusplus
 }
 #endif
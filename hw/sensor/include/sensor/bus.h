@@ -0,0 +1,259 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef __SENSOR_BUS_H__
+#define __SENSOR_BUS_H__
+
+#include "os/mynewt.h"
+#include "sensor/sensor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup SensorBusAPI
+ * @{
+ */
+
+struct sensor_bus;
+struct sensor_bus_xfer;
+
+/**
+ * Callback for a completed bus transfer, executed on the bus event queue.
+ *
+ * @param xfer The transfer that completed
+ * @param status 0 on success, non-zero error code on failure.
+ */
+typedef void (*sensor_bus_xfer_cb_t)(struct sensor_bus_xfer *xfer,
+                                     int status);
+
+/**
+ * A single bus transaction: write sbx_wlen bytes (typically the register
+ * address) and then read sbx_rlen bytes from the device.  Either length
+ * may be 0.  The descriptor and its buffers belong to the bus from
+ * sensor_bus_submit() until the callback is called.
+ */
+struct sensor_bus_xfer {
+    /* Device address on I2C, chip select pin on SPI */
+    uint16_t sbx_addr;
+
+    /* Bytes written to the device */
+    uint16_t sbx_wlen;
+    const uint8_t *sbx_wbuf;
+
+    /* Bytes read from the device after the write */
+    uint16_t sbx_rlen;
+    uint8_t *sbx_rbuf;
+
+    /* Completion callback and its argument */
+    sensor_bus_xfer_cb_t sbx_cb;
+    void *sbx_arg;
+
+    /* Transfer status, set on completion */
+    int sbx_status;
+
+    STAILQ_ENTRY(sensor_bus_xfer) sbx_next;
+};
+
+/**
+ * Bus backend.  sbb_start() starts a transfer on an idle bus and returns
+ * without waiting for it; the backend reports the end of the transfer with
+ * sensor_bus_xfer_done(), which may be called from interrupt context or
+ * from within sbb_start() itself.
+ */
+struct sensor_bus_backend {
+    int (*sbb_start)(struct sensor_bus *bus, struct sensor_bus_xfer *xfer);
+};
+
+struct sensor_bus {
+    /* Interface type and number, as in struct sensor_itf */
+    uint8_t sb_type;
+    uint8_t sb_num;
+
+    /* Backend and its private state */
+    const struct sensor_bus_backend *sb_backend;
+    void *sb_arg;
+
+    /* Event queue the transfer callbacks run on */
+    struct os_eventq *sb_evq;
+
+    /* Transfer in progress, NULL if the bus is idle */
+    struct sensor_bus_xfer *sb_cur;
+
+    /* Transfers waiting for the bus */
+    STAILQ_HEAD(, sensor_bus_xfer) sb_queue;
+
+    /* Posted on sb_evq when sb_cur completes */
+    struct os_event sb_done_ev;
+
+    SLIST_ENTRY(sensor_bus) sb_next;
+};
+
+/**
+ * Register a bus so that sensors with a matching sensor_itf can queue
+ * transfers on it.  Transfer callbacks run on the sensor manager event
+ * queue.
+ *
+ * @param bus The bus to register
+ * @param type The interface type (e.g. SENSOR_ITF_I2C)
+ * @param num The interface number
+ * @param backend The backend performing the transfers
+ * @param arg The backend private state
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+int sensor_bus_register(struct sensor_bus *bus, uint8_t type, uint8_t num,
+                        const struct sensor_bus_backend *backend, void *arg);
+
+/**
+ * Find the registered bus for an interface
+ *
+ * @param itf The sensor interface
+ *
+ * @return The bus, NULL if none is registered for the interface.
+ */
+struct sensor_bus *sensor_bus_find(const struct sensor_itf *itf);
+
+/**
+ * Queue a transfer on a bus.  Transfers on a bus run one at a time in the
+ * order they were submitted, transfers on different buses run
+ * concurrently.
+ *
+ * @param bus The bus
+ * @param xfer The transfer, sbx_addr must be set
+ *
+ * @return 0 if the transfer was queued, in which case its callback is
+ *         called exactly once, non-zero error code on failure.
+ */
+int sensor_bus_submit(struct sensor_bus *bus, struct sensor_bus_xfer *xfer);
+
+/**
+ * Queue a transfer on the bus of a sensor interface, addressed to the
+ * device of the interface (si_addr on I2C, si_cs_pin on SPI).
+ *
+ * @param itf The sensor interface
+ * @param xfer The transfer
+ *
+ * @return 0 if the transfer was queued, SYS_ENODEV if no bus is registered
+ *         for the interface.
+ */
+int sensor_itf_submit(struct sensor_itf *itf, struct sensor_bus_xfer *xfer);
+
+/**
+ * Called by the backend when the current transfer completes, may be called
+ * from interrupt context.
+ *
+ * @param bus The bus
+ * @param status 0 on success, non-zero error code on failure.
+ */
+void sensor_bus_xfer_done(struct sensor_bus *bus, int status);
+
+#if MYNEWT_VAL(SENSOR_BUS_HAL_SPI)
+/**
+ * SPI backend using hal_spi_txrx_noblock().  The SPI must be configured
+ * as master before the bus is registered; CS is driven by the backend.
+ */
+struct sensor_bus_hal_spi {
+    struct sensor_bus sbhs_bus;
+    /* Set if the port supports non-blocking transfers */
+    uint8_t sbhs_noblock;
+    /* Transmit and receive buffers */
+    uint8_t sbhs_buf[2][MYNEWT_VAL(SENSOR_BUS_SPI_BUF_SIZE)];
+};
+
+/**
+ * Register SPI interface "num" as an asynchronous sensor bus
+ *
+ * @param spi The backend state
+ * @param num The SPI interface number
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+int sensor_bus_hal_spi_init(struct sensor_bus_hal_spi *spi, uint8_t num);
+#endif
+
+#if MYNEWT_VAL(SENSOR_BUS_HAL_I2C)
+/**
+ * I2C backend.  The HAL I2C API is blocking, the transfers are run from
+ * sbhi_evq so that only the task serving that queue waits on the bus.  With
+ * no queue the transfers run in the caller's context.
+ */
+struct sensor_bus_hal_i2c {
+    struct sensor_bus sbhi_bus;
+    struct os_eventq *sbhi_evq;
+    struct os_event sbhi_ev;
+};
+
+/**
+ * Register I2C interface "num" as an asynchronous sensor bus
+ *
+ * @param i2c The backend state
+ * @param num The I2C interface number
+ * @param evq The event queue to run the blocking transfers on, may be NULL
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+int sensor_bus_hal_i2c_init(struct sensor_bus_hal_i2c *i2c, uint8_t num,
+                            struct os_eventq *evq);
+#endif
+
+#if MYNEWT_VAL(SENSOR_BUS_SIM)
+/**
+ * Simulated bus for testing.  Every device on the bus is a register file
+ * of sbs_nregs bytes; the first byte written is the register address, the
+ * remaining ones are written from there on and reads start from there.
+ * Each transfer completes sbs_latency ticks after it started.
+ */
+struct sensor_bus_sim {
+    struct sensor_bus sbs_bus;
+    uint8_t *sbs_regs;
+    uint16_t sbs_nregs;
+    os_time_t sbs_latency;
+    struct os_callout sbs_callout;
+    /* Number of transfers done */
+    uint32_t sbs_xfers;
+};
+
+/**
+ * Register a simulated bus
+ *
+ * @param sim The backend state
+ * @param type The interface type
+ * @param num The interface number
+ * @param regs The register file
+ * @param nregs The size of the register file
+ * @param latency Duration of each transfer, in os ticks
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+int sensor_bus_sim_init(struct sensor_bus_sim *sim, uint8_t type,
+                        uint8_t num, uint8_t *regs, uint16_t nregs,
+                        os_time_t latency);
+#endif
+
+/**
+ * @} SensorBusAPI
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SENSOR_BUS_H__ */
@@ -41,6 +41,22 @@ struct sensor_euler_data {
     uint8_t sed_p_is_valid:1;
 } __attribute__((packed));
 
+/* Fixed point representation of struct sensor_euler_data.
+ * All values are in Q16.16 degrees
+ */
+#define SENSOR_EULER_FIXED_SHIFT SENSOR_FIXED_SHIFT
+
+struct sensor_euler_data_fixed {
+    sensor_fixed_t sed_h;
+    sensor_fixed_t sed_r;
+    sensor_fixed_t sed_p;
+
+    /* Validity */
+    uint8_t sed_h_is_valid:1;
+    uint8_t sed_r_is_valid:1;
+    uint8_t sed_p_is_valid:1;
+} __attribute__((packed));
+
 #ifdef __cplusplus
 }
 #endif
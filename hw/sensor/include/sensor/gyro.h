@@ -40,6 +40,22 @@ struct sensor_gyro_data {
     uint8_t sgd_z_is_valid:1;
 } __attribute__((packed));
 
+/* Fixed point representation of struct sensor_gyro_data.
+ * All values are in Q16.16 degrees per sec
+ */
+#define SENSOR_GYRO_FIXED_SHIFT SENSOR_FIXED_SHIFT
+
+struct sensor_gyro_data_fixed {
+    sensor_fixed_t sgd_x;
+    sensor_fixed_t sgd_y;
+    sensor_fixed_t sgd_z;
+
+    /* Validity */
+    uint8_t sgd_x_is_valid:1;
+    uint8_t sgd_y_is_valid:1;
+    uint8_t sgd_z_is_valid:1;
+} __attribute__((packed));
+
 #ifdef __cplusplus
 }
 #endif
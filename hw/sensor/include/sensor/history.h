@@ -0,0 +1,306 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef __SENSOR_HISTORY_H__
+#define __SENSOR_HISTORY_H__
+
+#include "os/mynewt.h"
+#include "sensor/sensor.h"
+#if MYNEWT_VAL(SENSOR_HISTORY_FCB)
+#include "fcb/fcb.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup SensorHistoryAPI
+ * @{
+ */
+
+/* Most values in a sample, a quaternion has four */
+#define SENSOR_HISTORY_AXES_MAX         (4)
+
+/* Newtmgr group of the sensor history commands, a per-user group */
+#define SENSOR_HISTORY_NMGR_GROUP_ID    MYNEWT_VAL(SENSOR_HISTORY_NMGR_GROUP)
+
+/* Newtmgr commands of the sensor group */
+#define SENSOR_HISTORY_NMGR_OP_READ     (0)
+#define SENSOR_HISTORY_NMGR_OP_LIST     (1)
+
+/**
+ * A stored reading.  Values are in the fixed point representation of the
+ * sensor type.
+ */
+struct sensor_history_sample {
+    /* Sequence number, increases by one for each sample stored */
+    uint32_t shs_index;
+
+    /* Time of the reading, milliseconds since the epoch */
+    uint64_t shs_ts;
+
+    int32_t shs_val[SENSOR_HISTORY_AXES_MAX];
+};
+
+struct sensor_history;
+
+/**
+ * Called for each sample of a range query.
+ *
+ * @return 0 to continue, non-zero to stop the walk, in which case the value
+ *         is returned by sensor_history_walk().
+ */
+typedef int (*sensor_history_walk_func_t)(struct sensor_history *sh,
+        const struct sensor_history_sample *shs, void *arg);
+
+/**
+ * Position of a walk.  When the walk function stops a walk, the cursor is
+ * left on the sample it stopped on, so the next walk resumes there instead
+ * of scanning the history from the oldest sample.
+ */
+struct sensor_history_cursor {
+    /* Sequence number of the next sample to report */
+    uint32_t shc_index;
+#if MYNEWT_VAL(SENSOR_HISTORY_FCB)
+    /* FCB entry holding that sample, fe_area is NULL if unknown */
+    struct fcb_entry shc_loc;
+#endif
+};
+
+/**
+ * Storage of a history.  Records are stored oldest first; when the storage
+ * is full, the oldest records are dropped.  The walk starts at the cursor
+ * when the storage can locate it, and must leave the cursor on the record
+ * func stopped on.
+ */
+struct sensor_history_handler {
+    int (*shh_append)(struct sensor_history *sh, const void *rec, int len);
+    int (*shh_walk)(struct sensor_history *sh,
+                    struct sensor_history_cursor *cur,
+                    int (*func)(struct sensor_history *, const void *rec,
+                                void *arg),
+                    void *arg);
+    int (*shh_clear)(struct sensor_history *sh);
+};
+
+/* Handlers defined by the sensor package */
+extern const struct sensor_history_handler sensor_history_ram_handler;
+#if MYNEWT_VAL(SENSOR_HISTORY_FCB)
+extern const struct sensor_history_handler sensor_history_fcb_handler;
+#endif
+
+struct sensor_history {
+    /* Listener registered on the sensor */
+    struct sensor_listener sh_listener;
+
+    struct sensor *sh_sensor;
+    sensor_type_t sh_type;
+
+    /* Values per sample, their fractional bits and the record size */
+    uint8_t sh_axes;
+    uint8_t sh_shift;
+    uint8_t sh_rec_len;
+
+    const struct sensor_history_handler *sh_handler;
+
+    union {
+        /* RAM storage */
+        struct {
+            uint8_t *shr_buf;
+            uint16_t shr_cap;
+            uint16_t shr_head;
+            uint16_t shr_cnt;
+        } sh_ram;
+#if MYNEWT_VAL(SENSOR_HISTORY_FCB)
+        /* FCB storage */
+        struct fcb *sh_fcb;
+#endif
+    };
+
+    /* Index of the next sample */
+    uint32_t sh_next_index;
+
+    /* Samples stored and samples lost to errors */
+    uint32_t sh_stored;
+    uint32_t sh_errors;
+
+    /* Serializes appends and walks */
+    struct os_mutex sh_lock;
+
+    SLIST_ENTRY(sensor_history) sh_next;
+};
+
+/**
+ * Initialize a history kept in RAM
+ *
+ * @param sh The history
+ * @param type The sensor type stored, a single type with a fixed point
+ *        representation
+ * @param buf The ring buffer
+ * @param buf_size The size of buf; each sample takes 10 bytes plus 4 per
+ *        value
+ *
+ * @return 0 on success, SYS_ENOTSUP if the type is not supported,
+ *         SYS_EINVAL if the buffer cannot hold a sample.
+ */
+int sensor_history_init_ram(struct sensor_history *sh, sensor_type_t type,
+                            uint8_t *buf, uint16_t buf_size);
+
+#if MYNEWT_VAL(SENSOR_HISTORY_FCB)
+/**
+ * Initialize a history kept in an FCB.  The FCB must be initialized; when
+ * it fills up, its oldest sector is erased.
+ *
+ * @param sh The history
+ * @param type The sensor type stored
+ * @param fcb The FCB
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+int sensor_history_init_fcb(struct sensor_history *sh, sensor_type_t type,
+                            struct fcb *fcb);
+#endif
+
+/**
+ * Start recording the readings of a sensor and make the history available
+ * to newtmgr under the name of the sensor device.
+ *
+ * @param sensor The sensor
+ * @param sh The history
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+int sensor_history_register(struct sensor *sensor, struct sensor_history *sh);
+
+/**
+ * Stop recording, the stored samples are kept
+ *
+ * @param sh The history
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+int sensor_history_unregister(struct sensor_history *sh);
+
+/**
+ * Store a reading.  Registered histories are fed by the sensor framework.
+ *
+ * @param sh The history
+ * @param data The reading, in the fixed point representation of the type
+ * @param ts The time of the reading, may be NULL for the current time
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+int sensor_history_add(struct sensor_history *sh, const void *data,
+                       const struct os_timeval *ts);
+
+/**
+ * Walk the samples taken in the range [from, to], oldest first
+ *
+ * @param sh The history
+ * @param from Start of the range, milliseconds since the epoch
+ * @param to End of the range, 0 for no end
+ * @param index Skip samples with a lower sequence number, to resume a walk
+ * @param func Called for each sample
+ * @param arg The argument to pass to func
+ *
+ * @return 0 on success, the value returned by func if it stopped the walk,
+ *         other non-zero error code on failure.
+ */
+int sensor_history_walk(struct sensor_history *sh, uint64_t from,
+                        uint64_t to, uint32_t index,
+                        sensor_history_walk_func_t func, void *arg);
+
+/**
+ * Set a cursor to start a walk at a sequence number
+ *
+ * @param cur The cursor
+ * @param index Skip samples with a lower sequence number
+ */
+void sensor_history_cursor_init(struct sensor_history_cursor *cur,
+                                uint32_t index);
+
+/**
+ * Walk the samples taken in the range [from, to], oldest first, starting
+ * at a cursor.  If func stops the walk, the cursor is left on the sample
+ * it stopped on; walking again with the same cursor resumes there without
+ * rescanning the older samples.
+ *
+ * @param sh The history
+ * @param from Start of the range, milliseconds since the epoch
+ * @param to End of the range, 0 for no end
+ * @param cur The position to start at, updated by the walk
+ * @param func Called for each sample
+ * @param arg The argument to pass to func
+ *
+ * @return 0 on success, the value returned by func if it stopped the walk,
+ *         other non-zero error code on failure.
+ */
+int sensor_history_walk_cursor(struct sensor_history *sh, uint64_t from,
+                               uint64_t to,
+                               struct sensor_history_cursor *cur,
+                               sensor_history_walk_func_t func, void *arg);
+
+/**
+ * Drop all the samples
+ *
+ * @param sh The history
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+int sensor_history_clear(struct sensor_history *sh);
+
+/**
+ * Find the registered history of a sensor type
+ *
+ * @param devname The sensor device name
+ * @param type The sensor type
+ *
+ * @return The history, NULL if not found.
+ */
+struct sensor_history *sensor_history_find(const char *devname,
+                                           sensor_type_t type);
+
+/**
+ * Get the next registered history
+ *
+ * @param prev The previous history, NULL for the first one
+ *
+ * @return The history, NULL at the end of the list.
+ */
+struct sensor_history *sensor_history_get_next(struct sensor_history *prev);
+
+#if MYNEWT_VAL(SENSOR_HISTORY_NEWTMGR)
+/**
+ * Register the sensor newtmgr group.  Done by the sensor package at init.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+int sensor_history_nmgr_register_group(void);
+#endif
+
+/**
+ * @} SensorHistoryAPI
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SENSOR_HISTORY_H__ */
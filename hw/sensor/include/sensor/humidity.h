@@ -37,6 +37,18 @@ struct sensor_humid_data {
     uint8_t shd_humid_is_valid:1;
 } __attribute__((packed));
 
+/* Fixed point representation of struct sensor_humid_data.
+ * All values are in Q16.16 %rH
+ */
+#define SENSOR_HUMID_FIXED_SHIFT SENSOR_FIXED_SHIFT
+
+struct sensor_humid_data_fixed {
+    sensor_fixed_t shd_humid;
+
+    /* Validity */
+    uint8_t shd_humid_is_valid:1;
+} __attribute__((packed));
+
 #ifdef __cplusplus
 }
 #endif
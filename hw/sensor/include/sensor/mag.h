@@ -40,6 +40,22 @@ struct sensor_mag_data {
     uint8_t smd_z_is_valid:1;
 } __attribute__((packed));
 
+/* Fixed point representation of struct sensor_mag_data.
+ * All values are in Q16.16 uTesla
+ */
+#define SENSOR_MAG_FIXED_SHIFT SENSOR_FIXED_SHIFT
+
+struct sensor_mag_data_fixed {
+    sensor_fixed_t smd_x;
+    sensor_fixed_t smd_y;
+    sensor_fixed_t smd_z;
+
+    /* Validity */
+    uint8_t smd_x_is_valid:1;
+    uint8_t smd_y_is_valid:1;
+    uint8_t smd_z_is_valid:1;
+} __attribute__((packed));
+
 #ifdef __cplusplus
 }
 #endif
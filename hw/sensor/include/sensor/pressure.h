@@ -37,6 +37,19 @@ struct sensor_press_data {
     uint8_t spd_press_is_valid:1;
 } __attribute__((packed));
 
+/* Fixed point representation of struct sensor_press_data.
+ * All values are in Pa, in Q24.8 as Q16.16 cannot hold atmospheric
+ * pressure.
+ */
+#define SENSOR_PRESS_FIXED_SHIFT (8)
+
+struct sensor_press_data_fixed {
+    sensor_fixed_t spd_press;
+
+    /* Validity */
+    uint8_t spd_press_is_valid:1;
+} __attribute__((packed));
+
 #ifdef __cplusplus
 }
 #endif
@@ -41,6 +41,24 @@ struct sensor_quat_data {
     uint8_t sqd_w_is_valid:1;
 } __attribute__((packed));
 
+/* Fixed point representation of struct sensor_quat_data.
+ * All values are in Q16.16
+ */
+#define SENSOR_QUAT_FIXED_SHIFT SENSOR_FIXED_SHIFT
+
+struct sensor_quat_data_fixed {
+    sensor_fixed_t sqd_x;
+    sensor_fixed_t sqd_y;
+    sensor_fixed_t sqd_z;
+    sensor_fixed_t sqd_w;
+
+    /* Validity */
+    uint8_t sqd_x_is_valid:1;
+    uint8_t sqd_y_is_valid:1;
+    uint8_t sqd_z_is_valid:1;
+    uint8_t sqd_w_is_valid:1;
+} __attribute__((packed));
+
 #ifdef __cplusplus
 }
 #endif
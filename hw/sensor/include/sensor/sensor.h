@@ -157,6 +157,37 @@ typedef enum {
  */
 #define SENSOR_VALUE_TYPE_FLOAT_TRIPLET (4)
 
+/**
+ * Fixed point value, the position of the binary point is given by the
+ * per-type SENSOR_<TYPE>_FIXED_SHIFT constant (Q16.16 unless stated
+ * otherwise in the sensor type header).
+ */
+typedef int32_t sensor_fixed_t;
+
+/**
+ * Default number of fractional bits in a sensor_fixed_t value.
+ */
+#define SENSOR_FIXED_SHIFT    (16)
+
+/**
+ * Convert between sensor_fixed_t and other representations.  The float
+ * conversions are meant for the compatibility path only, drivers for parts
+ * without an FPU should build the fixed value from integer register data.
+ */
+#define SENSOR_FIXED_FROM_INT(__i, __shift) \
+    ((sensor_fixed_t)((int32_t)(__i) * (int32_t)(1UL << (__shift))))
+#define SENSOR_FIXED_FROM_MILLI(__m, __shift) \
+    ((sensor_fixed_t)(((int64_t)(__m) * (int64_t)(1UL << (__shift))) / 1000))
+#define SENSOR_FIXED_FROM_FRAC(__n, __d, __shift) \
+    ((sensor_fixed_t)(((int64_t)(__n) * (int64_t)(1UL << (__shift))) / (__d)))
+#define SENSOR_FIXED_TO_MILLI(__q, __shift) \
+    ((int32_t)(((int64_t)(__q) * 1000) / (int64_t)(1UL << (__shift))))
+#define SENSOR_FIXED_FROM_FLOAT(__f, __shift) \
+    ((sensor_fixed_t)((__f) * (float)(1UL << (__shift)) + \
+                      ((__f) < 0 ? -0.5f : 0.5f)))
+#define SENSOR_FIXED_TO_FLOAT(__q, __shift) \
+    ((float)(__q) / (float)(1UL << (__shift)))
+
 /**
  * Sensor interfaces
  */
@@ -224,6 +255,23 @@ typedef union {
 typedef int (*sensor_data_func_t)(struct sensor *, void *, void *,
              sensor_type_t);
 
+/**
+ * Callback for the end of an asynchronous sensor read.
+ *
+ * @param sensor The sensor that was read
+ * @param arg The argument provided to sensor_read_async()
+ * @param status 0 on success, non-zero error code on failure.
+ */
+typedef void (*sensor_read_done_func_t)(struct sensor *, void *, int);
+
+/* State of a sensor read, owned by the sensor framework */
+struct sensor_read_ctx {
+    sensor_data_func_t user_func;
+    void *user_arg;
+    sensor_read_done_func_t done_func;
+    void *done_arg;
+};
+
 /**
  * Callback for sending trigger notification.
  *
@@ -284,12 +332,27 @@ struct sensor_listener {
     /* Argument for the sensor listener */
     void *sl_arg;
 
+    /* Mask of sensor types for which this listener wants the fixed point
+     * representation of the data (e.g. struct sensor_accel_data_fixed)
+     * instead of the float one.  Types that have no fixed point
+     * representation are always delivered as is.
+     */
+    sensor_type_t sl_fixed_types;
+
     /* Next item in the sensor listener list.  The head of this list is
      * contained within the sensor object.
      */
     SLIST_ENTRY(sensor_listener) sl_next;
 };
 
+/**
+ * The notifier is called directly from sensor_mgr_put_notify_evt(), which
+ * may be interrupt context, with interrupts disabled.  Meant for handlers
+ * that only bump a counter or set a flag; no event is queued and the
+ * sensor manager task is not woken up for these notifiers.
+ */
+#define SENSOR_NOTIFIER_F_ISR       (0x01)
+
 /**
  * Registration for sensor event notifications
  */
@@ -308,6 +371,9 @@ struct sensor_notifier {
     /* Opaque argument for the sensor event notification handler function. */
     void *sn_arg;
 
+    /* SENSOR_NOTIFIER_F_* flags */
+    uint8_t sn_flags;
+
     /* Next item in the sensor notifier list. The head of this list is
      * contained within the sensor object.
      */
@@ -365,20 +431,41 @@ struct sensor_type_traits {
     SLIST_ENTRY(sensor_type_traits) stt_next;
 };
 
+/**
+ * Notification counters of a notify context.
+ */
+struct sensor_notify_stats {
+    /* Events reported with sensor_mgr_put_notify_evt() */
+    uint32_t sns_events;
+    /* Calls made to SENSOR_NOTIFIER_F_ISR notifiers */
+    uint32_t sns_isr_calls;
+    /* Times the context was processed on the sensor manager evq */
+    uint32_t sns_dispatched;
+    /* Events folded into an already pending dispatch */
+    uint32_t sns_coalesced;
+    /* Sum and maximum of report to dispatch latency, in microseconds */
+    uint32_t sns_lat_sum;
+    uint32_t sns_lat_max;
+};
+
+/**
+ * Notification context, one per sensor, embedded in the driver.  The context
+ * carries its own OS event, so reporting an event never allocates.  Events
+ * reported while the context is still queued are merged into the pending
+ * mask and delivered with a single dispatch.
+ */
 struct sensor_notify_ev_ctx {
     /* The sensor for which the ev cb should be called */
     struct sensor *snec_sensor;
     /* The registered event type bit map */
     sensor_event_type_t snec_evtype;
-};
-
-struct sensor_notify_os_ev {
-    /* OS event to put on the eventq for event type */
-    struct os_event snoe_evt;
-    /* The sensor event type for the event */
-    sensor_event_type_t snoe_evtype;
-    /* The sensor for which the ev cb should be called */
-    struct sensor *snoe_sensor;
+    /* Events reported and not yet dispatched, non-zero while queued */
+    sensor_event_type_t snec_pending;
+    /* os_cputime at which the context was queued */
+    uint32_t snec_post_time;
+    /* OS event put on the sensor manager evq */
+    struct os_event snec_evt;
+    struct sensor_notify_stats snec_stats;
 };
 
 /**
@@ -471,6 +558,23 @@ typedef int (*sensor_set_notification_t)(struct sensor *,
 typedef int (*sensor_unset_notification_t)(struct sensor *,
                                            sensor_event_type_t);
 
+/**
+ * Start reading a value from a sensor without waiting for the bus.  The
+ * driver queues its bus transfers (see sensor/bus.h) and returns; once the
+ * data is in, it calls data_func for each value read and then
+ * sensor_read_async_done().
+ *
+ * @param sensor The sensor to read from
+ * @param type The type(s) of sensor values to read.
+ * @param data_func The function to call with each value read.
+ * @param arg The argument to pass to the read callback.
+ *
+ * @return 0 if the read was started, non-zero error code on failure, in
+ *         which case the driver does not call sensor_read_async_done().
+ */
+typedef int (*sensor_read_async_func_t)(struct sensor *, sensor_type_t,
+                                        sensor_data_func_t, void *);
+
 /**
  * Let driver handle interrupt in the sensor context
  *
@@ -490,6 +594,7 @@ struct sensor_driver {
     sensor_set_notification_t sd_set_notification;
     sensor_unset_notification_t sd_unset_notification;
     sensor_handle_interrupt_t sd_handle_interrupt;
+    sensor_read_async_func_t sd_read_async;
 };
 
 struct sensor_timestamp {
@@ -575,6 +680,13 @@ struct sensor {
 
     /* Sensor mask */
     sensor_type_t s_mask;
+
+    /* A bit mask of the sensor types that the driver reports in their fixed
+     * point representation.  The sensor framework converts the data for
+     * listeners which expect the other representation.
+     */
+    sensor_type_t s_fixed_types;
+
     /**
      * Poll rate in MS for this sensor.
      */
@@ -583,6 +695,15 @@ struct sensor {
     /* The next time at which we want to poll data from this sensor */
     os_time_t s_next_run;
 
+    /* Position in the sensor manager poll heap, 0 if not polled */
+    uint16_t s_poll_idx;
+
+    /* Set while an asynchronous read is in progress */
+    uint8_t s_read_pending;
+
+    /* Context of the asynchronous read in progress */
+    struct sensor_read_ctx s_read_ctx;
+
     /* Sensor driver specific functions, created by the device registering the
      * sensor.
      */
@@ -769,6 +890,38 @@ int sensor_read(struct sensor *sensor, sensor_type_t type,
                 sensor_data_func_t data_func, void *arg,
                 uint32_t timeout);
 
+/**
+ * Start reading the data for sensor type "type" from the given sensor
+ * without blocking on the bus.  Drivers without an asynchronous read
+ * function are read synchronously and "done" is called before this
+ * function returns.
+ *
+ * Only one asynchronous read per sensor can be in progress.
+ *
+ * @param sensor The sensor to read data from
+ * @param type The type of sensor data to read from the sensor
+ * @param data_func The callback to call for data returned from that sensor
+ * @param arg The argument to pass to data_func
+ * @param done The callback to call when the read is over, may be NULL
+ * @param done_arg The argument to pass to done
+ *
+ * @return 0 if the read was started, in which case done is called exactly
+ *         once, SYS_EBUSY if a read is already in progress, other non-zero
+ *         error code on failure.
+ */
+int sensor_read_async(struct sensor *sensor, sensor_type_t type,
+                      sensor_data_func_t data_func, void *arg,
+                      sensor_read_done_func_t done, void *done_arg);
+
+/**
+ * Called by drivers at the end of an asynchronous read, after the data
+ * function was called for the values read.
+ *
+ * @param sensor The sensor that was read
+ * @param status 0 on success, non-zero error code on failure.
+ */
+void sensor_read_async_done(struct sensor *sensor, int status);
+
 /**
  * Set the driver functions for this sensor, along with the type of sensor
  * data available for the given sensor.
@@ -805,6 +958,47 @@ sensor_set_type_mask(struct sensor *sensor, sensor_type_t mask)
     return (0);
 }
 
+/**
+ * Set the mask of sensor types which the driver reports natively in fixed
+ * point, drivers call this at init time.
+ *
+ * @param sensor The sensor to set the mask for
+ * @param mask The fixed point sensor types
+ */
+static inline int
+sensor_set_fixed_types(struct sensor *sensor, sensor_type_t mask)
+{
+    sensor->s_fixed_types = mask;
+
+    return (0);
+}
+
+/**
+ * Convert a single float reading of sensor type "type" into its fixed point
+ * representation.
+ *
+ * @param type The sensor type of the data
+ * @param src Ptr to the float data (e.g. struct sensor_accel_data)
+ * @param dst Ptr to the fixed point data (e.g. struct sensor_accel_data_fixed)
+ *
+ * @return 0 on success, SYS_ENOTSUP if the type has no fixed point
+ *         representation.
+ */
+int sensor_data_to_fixed(sensor_type_t type, const void *src, void *dst);
+
+/**
+ * Convert a single fixed point reading of sensor type "type" into its float
+ * representation.
+ *
+ * @param type The sensor type of the data
+ * @param src Ptr to the fixed point data
+ * @param dst Ptr to the float data
+ *
+ * @return 0 on success, SYS_ENOTSUP if the type has no fixed point
+ *         representation.
+ */
+int sensor_data_from_fixed(sensor_type_t type, const void *src, void *dst);
+
 /**
  * Check if sensor type is supported by the sensor device
  *
@@ -904,7 +1098,7 @@ typedef int (*sensor_mgr_compare_func_t)(struct sensor *, void *);
  *
  * @warn This function MUST be locked by sensor_mgr_lock/unlock() if the goal is
  * to iterate through sensors (as opposed to just finding one.)  As the
- * "prev_cursor" may be resorted in the sensor list, in between calls.
+ * sensor list may change in between calls.
  *
  * @param compare_func The comparison function to use against sensors in the list.
  * @param arg The argument to provide to that comparison function
@@ -963,6 +1157,44 @@ int sensor_mgr_match_bytype(struct sensor *sensor, void *);
 int
 sensor_set_poll_rate_ms(char *devname, uint32_t poll_rate);
 
+/**
+ * Set the window within which sensors sharing an interface are polled
+ * together.  When a sensor is due, the other sensors on the same interface
+ * that are due within the window are polled right after it, under a single
+ * interface lock.
+ *
+ * @param window The window in milli seconds, 0 to only group sensors that
+ *        are already due
+ *
+ * @return 0 on success, non-zero on failure
+ */
+int
+sensor_mgr_set_poll_window_ms(uint32_t window);
+
+/**
+ * Sensor manager poll statistics, the same counters are exported in the
+ * "sensor_mgr" stats section.
+ */
+struct sensor_mgr_poll_stats {
+    /* Number of polls done */
+    uint32_t smps_polls;
+    /* Polls that shared an interface lock with an earlier sensor */
+    uint32_t smps_batched_polls;
+    /* Polls more than a tick past their deadline */
+    uint32_t smps_late_polls;
+    /* Sum and maximum of abs(poll time - deadline), in os ticks */
+    uint32_t smps_jitter_sum;
+    uint32_t smps_jitter_max;
+};
+
+/**
+ * Get a copy of the sensor manager poll statistics
+ *
+ * @param stats Ptr to the stats structure to fill
+ */
+void
+sensor_mgr_get_poll_stats(struct sensor_mgr_poll_stats *stats);
+
 /**
  * Set the sensor poll rate multiple based on the device name, sensor type
  *
@@ -1054,7 +1286,10 @@ int
 sensor_clear_high_thresh(char *devname, sensor_type_t type);
 
 /**
- * Puts a notification event on the sensor manager evq
+ * Reports sensor events.  Notifiers flagged SENSOR_NOTIFIER_F_ISR are called
+ * right away, the context is queued on the sensor manager evq for the
+ * others unless it is already pending, in which case the events are merged
+ * into the pending dispatch.  Safe to call from interrupt context.
  *
  * @param ctx Notification event context
  * @param evtype The notification event type
@@ -1063,6 +1298,16 @@ void
 sensor_mgr_put_notify_evt(struct sensor_notify_ev_ctx *ctx,
                           sensor_event_type_t evtype);
 
+/**
+ * Copies the notification counters of a notify context.
+ *
+ * @param ctx Notification event context
+ * @param stats Filled with the counters
+ */
+void
+sensor_notify_get_stats(struct sensor_notify_ev_ctx *ctx,
+                        struct sensor_notify_stats *stats);
+
 /**
  * Puts a interrupt event on the sensor manager evq
  *
@@ -0,0 +1,219 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef __SENSOR_STREAM_H__
+#define __SENSOR_STREAM_H__
+
+#include "os/mynewt.h"
+#include "sensor/sensor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup SensorStreamAPI
+ * @{
+ */
+
+/* Most values in a reading, a quaternion has four */
+#define SENSOR_STREAM_AXES_MAX  (4)
+
+/**
+ * Summary of a window of readings of one sensor type, along with the
+ * readings themselves in compressed form.  All values are in the fixed
+ * point representation of the type, with ssw_shift fractional bits.
+ */
+struct sensor_stream_window {
+    sensor_type_t ssw_type;
+
+    /* Values per reading and their fractional bits */
+    uint8_t ssw_axes;
+    uint8_t ssw_shift;
+
+    /* Low bits dropped from each value before compression */
+    uint8_t ssw_qshift;
+
+    /* Number of readings in the window */
+    uint16_t ssw_count;
+
+    /* Per axis aggregates */
+    sensor_fixed_t ssw_min[SENSOR_STREAM_AXES_MAX];
+    sensor_fixed_t ssw_max[SENSOR_STREAM_AXES_MAX];
+    sensor_fixed_t ssw_mean[SENSOR_STREAM_AXES_MAX];
+    sensor_fixed_t ssw_rms[SENSOR_STREAM_AXES_MAX];
+
+    /* Time of the first and the last reading */
+    struct os_timeval ssw_start;
+    struct os_timeval ssw_end;
+
+    /* Compressed readings, see sensor_stream_decode(); NULL if the stream
+     * has no block buffer.
+     */
+    const uint8_t *ssw_blk;
+    uint16_t ssw_blk_len;
+};
+
+struct sensor_stream;
+
+/**
+ * Called at the end of each window, from the context the readings are
+ * delivered in.  The window, and its block, are only valid during the call.
+ *
+ * @param ss The stream
+ * @param ssw The window
+ * @param arg The argument provided to sensor_stream_init()
+ */
+typedef void (*sensor_stream_func_t)(struct sensor_stream *ss,
+                                     const struct sensor_stream_window *ssw,
+                                     void *arg);
+
+struct sensor_stream {
+    /* Listener registered on the sensor */
+    struct sensor_listener ss_listener;
+
+    sensor_stream_func_t ss_func;
+    void *ss_arg;
+
+    /* Readings per window */
+    uint16_t ss_window;
+
+    /* Block buffer, may be NULL for aggregates only */
+    uint8_t *ss_buf;
+    uint16_t ss_buf_size;
+
+    /* Window in progress */
+    struct sensor_stream_window ss_cur;
+    int64_t ss_sum[SENSOR_STREAM_AXES_MAX];
+    uint64_t ss_sumsq[SENSOR_STREAM_AXES_MAX];
+    int32_t ss_prev[SENSOR_STREAM_AXES_MAX];
+
+    /* Totals, for measuring the compression ratio */
+    uint32_t ss_readings;
+    uint32_t ss_raw_bytes;
+    uint32_t ss_blk_bytes;
+};
+
+/**
+ * Initialize a stream
+ *
+ * @param ss The stream
+ * @param type The sensor type the stream aggregates, a single type
+ * @param window The number of readings per window
+ * @param buf The buffer the readings are compressed into, NULL for
+ *        aggregates only.  A window ends early when the buffer is full.
+ * @param buf_size The size of buf
+ * @param func The function called at the end of each window
+ * @param arg The argument to pass to func
+ *
+ * @return 0 on success, SYS_ENOTSUP if the type has no fixed point
+ *         representation, SYS_EINVAL on invalid arguments.
+ */
+int sensor_stream_init(struct sensor_stream *ss, sensor_type_t type,
+                       uint16_t window, uint8_t *buf, uint16_t buf_size,
+                       sensor_stream_func_t func, void *arg);
+
+/**
+ * Drop the low "qshift" bits of each value before compressing it.  Small
+ * shifts discard sensor noise that would otherwise dominate the deltas.
+ * Aggregates always use the full resolution.
+ *
+ * @param ss The stream
+ * @param qshift The number of bits to drop, 0 for lossless compression
+ */
+void sensor_stream_set_qshift(struct sensor_stream *ss, uint8_t qshift);
+
+/**
+ * Register the stream as a listener of a sensor
+ *
+ * @param sensor The sensor
+ * @param ss The stream
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+int sensor_stream_register(struct sensor *sensor, struct sensor_stream *ss);
+
+/**
+ * Unregister the stream from a sensor, the window in progress is dropped
+ *
+ * @param sensor The sensor
+ * @param ss The stream
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+int sensor_stream_unregister(struct sensor *sensor, struct sensor_stream *ss);
+
+/**
+ * Add a reading to the stream.  Streams registered on a sensor are fed by
+ * the sensor framework; this is for feeding recorded readings.
+ *
+ * @param ss The stream
+ * @param data The reading, in the fixed point representation of the type
+ * @param ts The time of the reading, may be NULL
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+int sensor_stream_add(struct sensor_stream *ss, const void *data,
+                      const struct os_timeval *ts);
+
+/**
+ * End the window in progress, if it has any readings
+ *
+ * @param ss The stream
+ */
+void sensor_stream_flush(struct sensor_stream *ss);
+
+/**
+ * Decode a compressed block.  Each value is stored as the zigzag varint
+ * of its difference to the previous value of the same axis.  The axes are
+ * interleaved: all values of a reading are stored before the next reading.
+ *
+ * @param blk The block
+ * @param len The length of the block
+ * @param axes The number of values per reading
+ * @param values Array receiving the values, count * axes entries in the
+ *        same order (x0, y0, z0, x1, ...), shifted right by the
+ *        window's ssw_qshift.
+ * @param max_values The number of entries in values
+ *
+ * @return The number of values decoded, SYS_EINVAL if the block is
+ *         malformed or values is too small.
+ */
+int sensor_stream_decode(const uint8_t *blk, int len, uint8_t axes,
+                         int32_t *values, int max_values);
+
+#if MYNEWT_VAL(SENSOR_OIC)
+/**
+ * Stream function that notifies the observers of the sensor type's OIC
+ * resource with the window encoded as CBOR.  Set the stream argument to
+ * the sensor.
+ */
+void sensor_oic_stream_tx(struct sensor_stream *ss,
+                          const struct sensor_stream_window *ssw, void *arg);
+#endif
+
+/**
+ * @} SensorStreamAPI
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SENSOR_STREAM_H__ */
@@ -37,6 +37,18 @@ struct sensor_temp_data {
     uint8_t std_temp_is_valid:1;
 } __attribute__((packed));
 
+/* Fixed point representation of struct sensor_temp_data.
+ * All values are in Q16.16 Deg C
+ */
+#define SENSOR_TEMP_FIXED_SHIFT SENSOR_FIXED_SHIFT
+
+struct sensor_temp_data_fixed {
+    sensor_fixed_t std_temp;
+
+    /* Validity */
+    uint8_t std_temp_is_valid:1;
+} __attribute__((packed));
+
 #ifdef __cplusplus
 }
 #endif
@@ -33,7 +33,9 @@
 #include "sensor/pressure.h"
 #include "sensor/humidity.h"
 #include "sensor/gyro.h"
+#include "sensor/history.h"
 #include "console/console.h"
+#include "stats/stats.h"
 
 #if MYNEWT_VAL(SENSOR_POLL_TEST_LOG)
 uint32_t test_log_idx;
@@ -51,6 +53,51 @@ struct test_log {
 os_time_t smgr_wakeup[500];
 #endif
 
+/* Define the stats section and records */
+STATS_SECT_START(sensor_mgr_stat_section)
+    /* Number of polls done by the sensor manager */
+    STATS_SECT_ENTRY(polls)
+    /* Polls that shared an interface lock with an earlier sensor */
+    STATS_SECT_ENTRY(batched_polls)
+    /* Polls more than a tick past their deadline */
+    STATS_SECT_ENTRY(late_polls)
+    /* Sum and maximum of abs(poll time - deadline), in os ticks */
+    STATS_SECT_ENTRY(jitter_sum)
+    STATS_SECT_ENTRY(jitter_max)
+    /* Sensors that could not be scheduled, poll heap full */
+    STATS_SECT_ENTRY(heap_full)
+    /* Polls skipped, the previous asynchronous read was still running */
+    STATS_SECT_ENTRY(read_overruns)
+    /* Polls skipped, the interface lock could not be taken */
+    STATS_SECT_ENTRY(itf_lock_fails)
+    /* Sensor events reported by drivers */
+    STATS_SECT_ENTRY(notify_events)
+    /* Calls made to interrupt context notifiers */
+    STATS_SECT_ENTRY(notify_isr_calls)
+    /* Events merged into an already queued notification */
+    STATS_SECT_ENTRY(notify_coalesced)
+    /* Largest report to dispatch latency, in microseconds */
+    STATS_SECT_ENTRY(notify_lat_max)
+STATS_SECT_END
+
+/* Define stat names for querying */
+STATS_NAME_START(sensor_mgr_stat_section)
+    STATS_NAME(sensor_mgr_stat_section, polls)
+    STATS_NAME(sensor_mgr_stat_section, batched_polls)
+    STATS_NAME(sensor_mgr_stat_section, late_polls)
+    STATS_NAME(sensor_mgr_stat_section, jitter_sum)
+    STATS_NAME(sensor_mgr_stat_section, jitter_max)
+    STATS_NAME(sensor_mgr_stat_section, heap_full)
+    STATS_NAME(sensor_mgr_stat_section, read_overruns)
+    STATS_NAME(sensor_mgr_stat_section, itf_lock_fails)
+    STATS_NAME(sensor_mgr_stat_section, notify_events)
+    STATS_NAME(sensor_mgr_stat_section, notify_isr_calls)
+    STATS_NAME(sensor_mgr_stat_section, notify_coalesced)
+    STATS_NAME(sensor_mgr_stat_section, notify_lat_max)
+STATS_NAME_END(sensor_mgr_stat_section)
+
+STATS_SECT_DECL(sensor_mgr_stat_section) g_sensor_mgr_stats;
+
 struct {
     struct os_mutex mgr_lock;
 
@@ -58,11 +105,42 @@ struct {
     struct os_eventq *mgr_eventq;
 
     SLIST_HEAD(, sensor) mgr_sensor_list;
+
+    /* Min-heap of the polled sensors, ordered by s_next_run.  1-based, a
+     * sensor's s_poll_idx is its position in the heap, 0 if not polled.
+     */
+    struct sensor *mgr_poll_heap[MYNEWT_VAL(SENSOR_MGR_POLL_MAX) + 1];
+    uint16_t mgr_poll_cnt;
+
+    /* Sensors on the same interface due within this many ticks of the
+     * first one are polled together.
+     */
+    os_time_t mgr_poll_window;
+
+    struct sensor_mgr_poll_stats mgr_poll_stats;
+
+    /* Largest notification latency seen, backs the notify_lat_max stat */
+    uint32_t mgr_notify_lat_max;
 } sensor_mgr;
 
-struct sensor_read_ctx {
-    sensor_data_func_t user_func;
-    void *user_arg;
+/* Storage for a single reading in either representation */
+union sensor_data_any {
+    struct sensor_accel_data sad;
+    struct sensor_accel_data_fixed sadf;
+    struct sensor_mag_data smd;
+    struct sensor_mag_data_fixed smdf;
+    struct sensor_gyro_data sgd;
+    struct sensor_gyro_data_fixed sgdf;
+    struct sensor_euler_data sed;
+    struct sensor_euler_data_fixed sedf;
+    struct sensor_quat_data sqd;
+    struct sensor_quat_data_fixed sqdf;
+    struct sensor_temp_data std;
+    struct sensor_temp_data_fixed stdf;
+    struct sensor_press_data spd;
+    struct sensor_press_data_fixed spdf;
+    struct sensor_humid_data shd;
+    struct sensor_humid_data_fixed shdf;
 };
 
 struct sensor_timestamp sensor_base_ts;
@@ -77,13 +155,6 @@ static struct os_event sensor_read_event = {
     .ev_cb = sensor_read_ev_cb,
 };
 
-#define SENSOR_NOTIFY_EVT_MEMPOOL_SIZE  \
-    OS_MEMPOOL_SIZE(MYNEWT_VAL(SENSOR_NOTIF_EVENTS_MAX), \
-                    sizeof(struct sensor_notify_os_ev))
-
-static struct os_mempool sensor_notify_evt_pool;
-static os_membuf_t sensor_notify_evt_area[SENSOR_NOTIFY_EVT_MEMPOOL_SIZE];
-
 /**
  * Lock sensor manager to access the list of sensors
  */
@@ -109,42 +180,134 @@ sensor_mgr_unlock(void)
 }
 
 static void
-sensor_mgr_remove(struct sensor *sensor)
+sensor_mgr_insert(struct sensor *sensor)
+{
+    struct sensor *cursor, *prev;
+
+    prev = NULL;
+    SLIST_FOREACH(cursor, &sensor_mgr.mgr_sensor_list, s_next) {
+        prev = cursor;
+    }
+
+    if (prev == NULL) {
+        SLIST_INSERT_HEAD(&sensor_mgr.mgr_sensor_list, sensor, s_next);
+    } else {
+        SLIST_INSERT_AFTER(prev, sensor, s_next);
+    }
+}
+
+static inline int
+sensor_poll_heap_lt(uint16_t a, uint16_t b)
 {
-    SLIST_REMOVE(&sensor_mgr.mgr_sensor_list, sensor, sensor, s_next);
+    return OS_TIME_TICK_LT(sensor_mgr.mgr_poll_heap[a]->s_next_run,
+                           sensor_mgr.mgr_poll_heap[b]->s_next_run);
 }
 
 static void
-sensor_mgr_insert(struct sensor *sensor)
+sensor_poll_heap_swap(uint16_t a, uint16_t b)
 {
-    struct sensor *cursor, *prev;
+    struct sensor **heap;
+    struct sensor *tmp;
 
-    prev = cursor = NULL;
-    if (!sensor->s_poll_rate) {
-        SLIST_FOREACH(cursor, &sensor_mgr.mgr_sensor_list, s_next) {
-            prev = cursor;
-        }
-        goto insert;
+    heap = sensor_mgr.mgr_poll_heap;
+
+    tmp = heap[a];
+    heap[a] = heap[b];
+    heap[b] = tmp;
+
+    heap[a]->s_poll_idx = a;
+    heap[b]->s_poll_idx = b;
+}
+
+static void
+sensor_poll_heap_up(uint16_t idx)
+{
+    while (idx > 1 && sensor_poll_heap_lt(idx, idx / 2)) {
+        sensor_poll_heap_swap(idx, idx / 2);
+        idx /= 2;
     }
+}
 
-    prev = cursor = NULL;
-    SLIST_FOREACH(cursor, &sensor_mgr.mgr_sensor_list, s_next) {
-        if (!cursor->s_poll_rate) {
-            break;
+static void
+sensor_poll_heap_down(uint16_t idx)
+{
+    uint16_t child;
+
+    while ((child = idx * 2) <= sensor_mgr.mgr_poll_cnt) {
+        if (child < sensor_mgr.mgr_poll_cnt &&
+            sensor_poll_heap_lt(child + 1, child)) {
+            child++;
         }
 
-        if (OS_TIME_TICK_LT(sensor->s_next_run, cursor->s_next_run)) {
+        if (!sensor_poll_heap_lt(child, idx)) {
             break;
         }
 
-        prev = cursor;
+        sensor_poll_heap_swap(idx, child);
+        idx = child;
     }
+}
 
-insert:
-    if (prev == NULL) {
-        SLIST_INSERT_HEAD(&sensor_mgr.mgr_sensor_list, sensor, s_next);
-    } else {
-        SLIST_INSERT_AFTER(prev, sensor, s_next);
+/**
+ * Insert the sensor into the poll heap, or move it to its new position if
+ * it is there already and its next run time has changed.  Must be called
+ * with the sensor manager locked.
+ *
+ * @param The sensor to schedule
+ *
+ * @return 0 on success, SYS_ENOMEM if the poll heap is full.
+ */
+static int
+sensor_poll_heap_update(struct sensor *sensor)
+{
+    uint16_t idx;
+
+    idx = sensor->s_poll_idx;
+    if (idx == 0) {
+        if (sensor_mgr.mgr_poll_cnt >= MYNEWT_VAL(SENSOR_MGR_POLL_MAX)) {
+            STATS_INC(g_sensor_mgr_stats, heap_full);
+            return SYS_ENOMEM;
+        }
+
+        idx = ++sensor_mgr.mgr_poll_cnt;
+        sensor_mgr.mgr_poll_heap[idx] = sensor;
+        sensor->s_poll_idx = idx;
+    }
+
+    sensor_poll_heap_up(idx);
+    sensor_poll_heap_down(sensor->s_poll_idx);
+
+    return 0;
+}
+
+/**
+ * Remove the sensor from the poll heap, if it is there.  Must be called
+ * with the sensor manager locked.
+ *
+ * @param The sensor to unschedule
+ */
+static void
+sensor_poll_heap_remove(struct sensor *sensor)
+{
+    struct sensor *moved;
+    uint16_t last;
+    uint16_t idx;
+
+    idx = sensor->s_poll_idx;
+    if (idx == 0) {
+        return;
+    }
+
+    last = sensor_mgr.mgr_poll_cnt--;
+    sensor->s_poll_idx = 0;
+
+    if (idx != last) {
+        moved = sensor_mgr.mgr_poll_heap[last];
+        sensor_mgr.mgr_poll_heap[idx] = moved;
+        moved->s_poll_idx = idx;
+
+        sensor_poll_heap_up(idx);
+        sensor_poll_heap_down(moved->s_poll_idx);
     }
 }
 
@@ -307,67 +470,60 @@ sensor_update_poll_rate(struct sensor *sensor, uint32_t poll_rate)
     sensor_unlock(sensor);
 }
 
-static os_time_t
-sensor_calc_nextrun_delta(struct sensor *sensor, os_time_t now)
+/**
+ * Re-arm the sensor manager wakeup callout for the earliest deadline in the
+ * poll heap.  Must be called with the sensor manager locked.
+ *
+ * @param The current OS time
+ */
+static void
+sensor_mgr_reschedule(os_time_t now)
 {
-    os_time_t sensor_ticks;
-    int delta;
+    int32_t delta;
 
-    sensor_lock(sensor);
+    if (sensor_mgr.mgr_poll_cnt == 0) {
+        os_callout_stop(&sensor_mgr.mgr_wakeup_callout);
+        return;
+    }
 
-    delta = (int32_t)(sensor->s_next_run - now);
+    delta = (int32_t)(sensor_mgr.mgr_poll_heap[1]->s_next_run - now);
     if (delta < 0) {
         /* This fires the callout right away */
-        sensor_ticks = 0;
-    } else {
-        sensor_ticks = delta;
+        delta = 0;
     }
 
-    sensor_unlock(sensor);
-
-    return sensor_ticks;
-}
-
-static struct sensor *
-sensor_find_min_nextrun_sensor(os_time_t now, os_time_t *min_nextrun)
-{
-    struct sensor *head;
-
-    head = NULL;
-
-    sensor_mgr_lock();
-
-    head = SLIST_FIRST(&sensor_mgr.mgr_sensor_list);
-
-    *min_nextrun = sensor_calc_nextrun_delta(head, now);
-
-    sensor_mgr_unlock();
-
-    return head;
-
+    os_callout_reset(&sensor_mgr.mgr_wakeup_callout, delta);
 }
 
-static void
+static int
 sensor_update_nextrun(struct sensor *sensor, os_time_t now)
 {
     os_time_t sensor_ticks;
+    int rc;
 
     os_time_ms_to_ticks(sensor->s_poll_rate, &sensor_ticks);
+    if (sensor_ticks == 0) {
+        /* Never schedule a sensor for the tick it was just polled in */
+        sensor_ticks = 1;
+    }
 
     sensor_lock(sensor);
 
-    /* Remove the sensor from the sensor list for insert. */
-    sensor_mgr_remove(sensor);
-
-    /* Set next wakeup, and insert the sensor back into the
-     * list.
+    /* Set next wakeup, and move the sensor to its new place in the poll
+     * heap.
      */
     sensor->s_next_run = sensor_ticks + now;
 
-    /* Re-insert the sensor manager, with the new wakeup time. */
-    sensor_mgr_insert(sensor);
+    if (sensor->s_poll_rate) {
+        rc = sensor_poll_heap_update(sensor);
+    } else {
+        sensor_poll_heap_remove(sensor);
+        rc = 0;
+    }
 
     sensor_unlock(sensor);
+
+    return rc;
 }
 
 /**
@@ -380,46 +536,83 @@ int
 sensor_set_poll_rate_ms(char *devname, uint32_t poll_rate)
 {
     struct sensor *sensor;
-    os_time_t next_wakeup;
+    uint32_t prev_rate;
     os_time_t now;
     int rc;
 
-    os_callout_stop(&sensor_mgr.mgr_wakeup_callout);
-
     sensor = sensor_mgr_find_next_bydevname(devname, NULL);
     if (!sensor) {
         rc = SYS_EINVAL;
         goto err;
     }
 
-    sensor_lock(sensor);
+    sensor_mgr_lock();
 
     now = os_time_get();
 
-    os_time_ms_to_ticks(poll_rate, &next_wakeup);
-
+    prev_rate = sensor->s_poll_rate;
     sensor_update_poll_rate(sensor, poll_rate);
 
-    sensor_update_nextrun(sensor, now);
-
-    sensor_unlock(sensor);
+    rc = sensor_update_nextrun(sensor, now);
+    if (rc != 0) {
+        /* Not scheduled; don't report a rate the sensor is not polled at. */
+        sensor_update_poll_rate(sensor, prev_rate);
+    }
 
-    sensor = sensor_find_min_nextrun_sensor(now, &next_wakeup);
+    sensor_mgr_reschedule(now);
 
-    os_callout_reset(&sensor_mgr.mgr_wakeup_callout, next_wakeup);
+    sensor_mgr_unlock();
 
-    return 0;
 err:
     return rc;
 }
 
+/**
+ * Set the window within which sensors sharing an interface are polled
+ * together.
+ *
+ * @param The window in milli seconds
+ */
+int
+sensor_mgr_set_poll_window_ms(uint32_t window)
+{
+    os_time_t ticks;
+    int rc;
+
+    rc = os_time_ms_to_ticks(window, &ticks);
+    if (rc) {
+        return rc;
+    }
+
+    sensor_mgr_lock();
+    sensor_mgr.mgr_poll_window = ticks;
+    sensor_mgr_unlock();
+
+    return 0;
+}
+
+/**
+ * Get a copy of the sensor manager poll statistics
+ *
+ * @param Ptr to the stats structure to fill
+ */
+void
+sensor_mgr_get_poll_stats(struct sensor_mgr_poll_stats *stats)
+{
+    sensor_mgr_lock();
+    *stats = sensor_mgr.mgr_poll_stats;
+    sensor_mgr_unlock();
+}
+
 /**
  * Register the sensor with the global sensor list. This makes the sensor
  * searchable by other packages, who may want to look it up by type.
  *
  * @param The sensor to register
  *
- * @return 0 on success, non-zero error code on failure.
+ * @return 0 on success, SYS_ENOMEM if the sensor has a poll rate and the
+ *         poll heap is full (the sensor is then not registered), non-zero
+ *         error code on other failures.
  */
 int
 sensor_mgr_register(struct sensor *sensor)
@@ -433,16 +626,30 @@ sensor_mgr_register(struct sensor *sensor)
 
     rc = sensor_lock(sensor);
     if (rc != 0) {
-        goto err;
+        goto unlock;
+    }
+
+    /* Take the poll heap slot first, so a full heap leaves the sensor
+     * unregistered rather than listed but never polled.
+     */
+    if (sensor->s_poll_rate) {
+        rc = sensor_poll_heap_update(sensor);
+        if (rc != 0) {
+            goto unlock_sensor;
+        }
     }
 
     sensor_mgr_insert(sensor);
 
+    if (sensor->s_poll_rate) {
+        sensor_mgr_reschedule(os_time_get());
+    }
+
+unlock_sensor:
     sensor_unlock(sensor);
 
+unlock:
     sensor_mgr_unlock();
-
-    return (0);
 err:
     return (rc);
 }
@@ -451,17 +658,33 @@ err:
  * run," and re-inserts it into the list
  */
 static void
-sensor_mgr_poll_bytype(struct sensor *sensor, sensor_type_t type,
-                       struct sensor_type_traits *stt, os_time_t now)
+sensor_mgr_read(struct sensor *sensor, sensor_type_t type)
 {
-    if (!stt || !stt->stt_polls_left) {
-        /* Sensor read results. Every time a sensor is read, all of its
-         * listeners are called by default. Specify NULL as a callback,
-         * because we just want to run all the listeners.
-         */
+    int rc;
 
+    /* Sensor read results. Every time a sensor is read, all of its
+     * listeners are called by default. Specify NULL as a callback,
+     * because we just want to run all the listeners.
+     *
+     * Drivers with an asynchronous read only queue their bus transfers
+     * here, so sensors on other buses are polled while they run.
+     */
+    if (sensor->s_funcs->sd_read_async != NULL) {
+        rc = sensor_read_async(sensor, type, NULL, NULL, NULL, NULL);
+        if (rc == SYS_EBUSY) {
+            STATS_INC(g_sensor_mgr_stats, read_overruns);
+        }
+    } else {
         sensor_read(sensor, type, NULL, NULL, OS_TIMEOUT_NEVER);
+    }
+}
 
+/* Returns the type if it is due to be read, 0 otherwise */
+static sensor_type_t
+sensor_mgr_poll_bytype(struct sensor *sensor, sensor_type_t type,
+                       struct sensor_type_traits *stt, os_time_t now)
+{
+    if (!stt || !stt->stt_polls_left) {
         sensor_lock(sensor);
 
         if (stt) {
@@ -486,9 +709,12 @@ sensor_mgr_poll_bytype(struct sensor *sensor, sensor_type_t type,
         /* Unlock the sensor to allow other access */
         sensor_unlock(sensor);
 
+        return type;
     } else {
         stt->stt_polls_left--;
     }
+
+    return 0;
 }
 
 static uint8_t
@@ -502,6 +728,10 @@ sensor_poll_per_type_trait(struct sensor *sensor, os_time_t now,
                            os_time_t next_wakeup)
 {
     struct sensor_type_traits *stt;
+    sensor_type_t mask;
+    sensor_type_t type;
+
+    mask = 0;
 
     /* Lock the sensor */
     sensor_lock(sensor);
@@ -516,26 +746,147 @@ sensor_poll_per_type_trait(struct sensor *sensor, os_time_t now,
          * at the poll multiple
          */
 
-        sensor_mgr_poll_bytype(sensor, stt->stt_sensor_type, stt,
-                               now);
+        type = sensor_mgr_poll_bytype(sensor, stt->stt_sensor_type, stt,
+                                      now);
+        if (!type) {
+            continue;
+        }
+
+        /* Only one asynchronous read can run at a time, the due types are
+         * read together.
+         */
+        if (sensor->s_funcs->sd_read_async != NULL) {
+            mask |= type;
+        } else {
+            sensor_mgr_read(sensor, type);
+        }
+    }
+
+    if (mask) {
+        sensor_mgr_read(sensor, mask);
     }
 
     /* Unlock the sensor to allow other access */
     sensor_unlock(sensor);
 }
 
+static void
+sensor_mgr_poll_stats_add(struct sensor *sensor, os_time_t now, int batched)
+{
+    struct sensor_mgr_poll_stats *stats;
+    uint32_t jitter;
+    int32_t delta;
+
+    stats = &sensor_mgr.mgr_poll_stats;
+
+    delta = (int32_t)(now - sensor->s_next_run);
+    jitter = delta < 0 ? -delta : delta;
+
+    stats->smps_polls++;
+    STATS_INC(g_sensor_mgr_stats, polls);
+
+    if (batched) {
+        stats->smps_batched_polls++;
+        STATS_INC(g_sensor_mgr_stats, batched_polls);
+    }
+
+    if (delta > 1) {
+        stats->smps_late_polls++;
+        STATS_INC(g_sensor_mgr_stats, late_polls);
+    }
+
+    stats->smps_jitter_sum += jitter;
+    STATS_INCN(g_sensor_mgr_stats, jitter_sum, jitter);
+
+    if (jitter > stats->smps_jitter_max) {
+        STATS_INCN(g_sensor_mgr_stats, jitter_max,
+                   jitter - stats->smps_jitter_max);
+        stats->smps_jitter_max = jitter;
+    }
+}
+
+static int
+sensor_itf_same_bus(const struct sensor_itf *a, const struct sensor_itf *b)
+{
+    if (a->si_lock != NULL || b->si_lock != NULL) {
+        return a->si_lock == b->si_lock;
+    }
+
+    return a->si_type == b->si_type && a->si_num == b->si_num;
+}
+
+struct sensor_poll_batch {
+    struct sensor *spb_sensors[MYNEWT_VAL(SENSOR_MGR_POLL_BATCH_MAX)];
+    int spb_cnt;
+};
+
+/**
+ * Add the sensors of the poll heap subtree rooted at idx that are on the
+ * same interface as the first sensor in the batch, and are due before the
+ * horizon, to the batch.  Subtrees rooted at a later deadline are skipped
+ * as a whole, so this only visits the due sensors and their children.
+ */
+static void
+sensor_poll_batch_collect(struct sensor_poll_batch *spb, uint16_t idx,
+                          os_time_t horizon)
+{
+    struct sensor *sensor;
+
+    if (idx > sensor_mgr.mgr_poll_cnt ||
+        spb->spb_cnt >= MYNEWT_VAL(SENSOR_MGR_POLL_BATCH_MAX)) {
+        return;
+    }
+
+    sensor = sensor_mgr.mgr_poll_heap[idx];
+    if (OS_TIME_TICK_GT(sensor->s_next_run, horizon)) {
+        return;
+    }
+
+    if (sensor_itf_same_bus(SENSOR_GET_ITF(sensor),
+                            SENSOR_GET_ITF(spb->spb_sensors[0]))) {
+        spb->spb_sensors[spb->spb_cnt++] = sensor;
+    }
+
+    sensor_poll_batch_collect(spb, idx * 2, horizon);
+    sensor_poll_batch_collect(spb, idx * 2 + 1, horizon);
+}
+
+static void
+sensor_mgr_poll_one(struct sensor *sensor, os_time_t now, int batched)
+{
+    sensor_lock(sensor);
+
+    sensor_mgr_poll_stats_add(sensor, now, batched);
+
+    if (sensor_type_traits_empty(sensor)) {
+        sensor_mgr_poll_bytype(sensor, sensor->s_mask, NULL, now);
+        sensor_mgr_read(sensor, sensor->s_mask);
+    } else {
+        sensor_poll_per_type_trait(sensor, now, 0);
+    }
+
+    sensor_update_nextrun(sensor, now);
+
+    sensor_unlock(sensor);
+}
+
 /**
- * Event that wakes up the sensor manager, this goes through the sensor
- * list and polls any active sensors.
+ * Event that wakes up the sensor manager, this polls the sensors whose
+ * deadline has passed, earliest first.  Each due sensor is polled along
+ * with the other sensors on its interface that are due within the poll
+ * window, under a single interface lock.
  *
  * @param OS event
  */
 static void
 sensor_mgr_wakeup_event(struct os_event *ev)
 {
-    struct sensor *cursor;
+    struct sensor_poll_batch spb;
+    struct sensor_itf *itf;
+    os_time_t horizon;
     os_time_t now;
-    os_time_t next_wakeup;
+    int rc;
+    int i;
 
     now = os_time_get();
 
@@ -545,43 +896,41 @@ sensor_mgr_wakeup_event(struct os_event *ev)
 
     sensor_mgr_lock();
 
-    cursor = NULL;
-    while (1) {
+    horizon = now + sensor_mgr.mgr_poll_window;
 
-        cursor = sensor_find_min_nextrun_sensor(now, &next_wakeup);
+    while (sensor_mgr.mgr_poll_cnt > 0 &&
+           OS_TIME_TICK_GEQ(now, sensor_mgr.mgr_poll_heap[1]->s_next_run)) {
 
-        sensor_lock(cursor);
-        /* Sensors that are not periodic are inserted at the end of the sensor
-         * list.
-         */
-        if (!cursor->s_poll_rate) {
-            sensor_unlock(cursor);
-            sensor_mgr_unlock();
-            return;
-        }
+        spb.spb_sensors[0] = sensor_mgr.mgr_poll_heap[1];
+        spb.spb_cnt = 1;
+        sensor_poll_batch_collect(&spb, 2, horizon);
+        sensor_poll_batch_collect(&spb, 3, horizon);
 
-        /* List is sorted by what runs first.  If we reached the first element that
-         * doesn't run, break out.
+        /* Drivers take the interface lock themselves; holding it across
+         * the batch keeps other users of the bus from interleaving.
+         * Asynchronous reads only hold it while queueing their transfers.
          */
-        if (next_wakeup > 0) {
-            break;
+        itf = SENSOR_GET_ITF(spb.spb_sensors[0]);
+        rc = sensor_itf_lock(itf, MYNEWT_VAL(SENSOR_MGR_ITF_LOCK_TMO));
+        if (rc != 0) {
+            /* Never read the bus without its lock; skip this round. */
+            for (i = 0; i < spb.spb_cnt; i++) {
+                STATS_INC(g_sensor_mgr_stats, itf_lock_fails);
+                sensor_update_nextrun(spb.spb_sensors[i], now);
+            }
+            continue;
         }
 
-        if (sensor_type_traits_empty(cursor)) {
-
-            sensor_mgr_poll_bytype(cursor, cursor->s_mask, NULL, now);
-        } else {
-            sensor_poll_per_type_trait(cursor, now, next_wakeup);
+        for (i = 0; i < spb.spb_cnt; i++) {
+            sensor_mgr_poll_one(spb.spb_sensors[i], now, i > 0);
         }
 
-        sensor_update_nextrun(cursor, now);
-
-        sensor_unlock(cursor);
+        sensor_itf_unlock(itf);
     }
 
-    sensor_mgr_unlock();
+    sensor_mgr_reschedule(now);
 
-    os_callout_reset(&sensor_mgr.mgr_wakeup_callout, next_wakeup);
+    sensor_mgr_unlock();
 }
 
 /**
@@ -656,12 +1005,6 @@ sensor_mgr_init(void)
     sensor_mgr_evq_set(os_eventq_dflt_get());
 #endif
 
-    rc = os_mempool_init(&sensor_notify_evt_pool,
-                         MYNEWT_VAL(SENSOR_NOTIF_EVENTS_MAX),
-                         sizeof(struct sensor_notify_os_ev), sensor_notify_evt_area,
-                         "sensor_notif_evts");
-    assert(rc == OS_OK);
-
     /**
      * Initialize sensor polling callout and set it to fire on boot.
      */
@@ -684,6 +1027,18 @@ sensor_mgr_init(void)
     os_callout_reset(&st_up_osco, OS_TICKS_PER_SEC);
 
     os_mutex_init(&sensor_mgr.mgr_lock);
+    SLIST_INIT(&sensor_mgr.mgr_sensor_list);
+
+    sensor_mgr.mgr_poll_cnt = 0;
+    memset(&sensor_mgr.mgr_poll_stats, 0, sizeof(sensor_mgr.mgr_poll_stats));
+    os_time_ms_to_ticks(MYNEWT_VAL(SENSOR_MGR_POLL_WINDOW_MS),
+                        &sensor_mgr.mgr_poll_window);
+
+    rc = stats_init_and_reg(
+        STATS_HDR(g_sensor_mgr_stats),
+        STATS_SIZE_INIT_PARMS(g_sensor_mgr_stats, STATS_SIZE_32),
+        STATS_NAME_INIT_PARMS(sensor_mgr_stat_section), "sensor_mgr");
+    SYSINIT_PANIC_ASSERT(rc == 0);
 }
 
 /**
@@ -855,6 +1210,10 @@ sensor_pkg_init(void)
 #if MYNEWT_VAL(SENSOR_CLI)
     sensor_shell_register();
 #endif
+
+#if MYNEWT_VAL(SENSOR_HISTORY_NEWTMGR)
+    SYSINIT_PANIC_ASSERT(sensor_history_nmgr_register_group() == 0);
+#endif
 }
 
 /**
@@ -1084,6 +1443,7 @@ sensor_register_notifier(struct sensor *sensor,
 {
     int rc;
     struct sensor_notifier *tmp;
+    os_sr_t sr;
 
     rc = sensor_lock(sensor);
     if (rc != 0) {
@@ -1098,7 +1458,12 @@ sensor_register_notifier(struct sensor *sensor,
         }
     }
 
+    /* The list is walked by sensor_mgr_put_notify_evt() in interrupt
+     * context, modify it with interrupts disabled.
+     */
+    OS_ENTER_CRITICAL(sr);
     SLIST_INSERT_HEAD(&sensor->s_notifier_list, notifier, sn_next);
+    OS_EXIT_CRITICAL(sr);
 
     rc = sensor_set_notification(sensor, notifier);
     if (rc != 0) {
@@ -1110,8 +1475,10 @@ sensor_register_notifier(struct sensor *sensor,
     return (0);
 
 remove:
+    OS_ENTER_CRITICAL(sr);
     SLIST_REMOVE(&sensor->s_notifier_list, notifier, sensor_notifier,
             sn_next);
+    OS_EXIT_CRITICAL(sr);
 
 err:
     sensor_unlock(sensor);
@@ -1133,6 +1500,7 @@ sensor_unregister_notifier(struct sensor *sensor,
 {
     int rc = 0;
     struct sensor_notifier *tmp;
+    os_sr_t sr;
 
     rc = sensor_lock(sensor);
     if (rc != 0) {
@@ -1141,8 +1509,10 @@ sensor_unregister_notifier(struct sensor *sensor,
 
     SLIST_FOREACH(tmp, &sensor->s_notifier_list, sn_next) {
         if (notifier == tmp) {
+            OS_ENTER_CRITICAL(sr);
             SLIST_REMOVE(&sensor->s_notifier_list, notifier, sensor_notifier,
                          sn_next);
+            OS_EXIT_CRITICAL(sr);
             break;
         }
     }
@@ -1158,27 +1528,68 @@ done:
     return (rc);
 }
 
+/**
+ * Returns the reading in the representation requested, converting it into
+ * "conv" the first time the other representation is needed.  Readings of
+ * types without a fixed point representation are returned as is.
+ */
+static void *
+sensor_read_data_repr(sensor_type_t type, void *data, int data_fixed,
+                      int want_fixed, union sensor_data_any *conv,
+                      void **conv_data)
+{
+    int rc;
+
+    if (data_fixed == want_fixed) {
+        return data;
+    }
+
+    if (*conv_data == NULL) {
+        if (want_fixed) {
+            rc = sensor_data_to_fixed(type, data, conv);
+        } else {
+            rc = sensor_data_from_fixed(type, data, conv);
+        }
+        *conv_data = rc ? data : conv;
+    }
+
+    return *conv_data;
+}
+
 static int
 sensor_read_data_func(struct sensor *sensor, void *arg, void *data,
                       sensor_type_t type)
 {
     struct sensor_listener *listener;
     struct sensor_read_ctx *ctx;
+    union sensor_data_any conv;
+    void *conv_data;
+    int data_fixed;
 
     ctx = (struct sensor_read_ctx *) arg;
 
+    data_fixed = !!(sensor->s_fixed_types & type);
+    conv_data = NULL;
+
     if ((uint8_t)(uintptr_t)(ctx->user_arg) != SENSOR_IGN_LISTENER) {
         /* Notify all listeners first */
         SLIST_FOREACH(listener, &sensor->s_listener_list, sl_next) {
             if (listener->sl_sensor_type & type) {
-                listener->sl_func(sensor, listener->sl_arg, data, type);
+                listener->sl_func(sensor, listener->sl_arg,
+                    sensor_read_data_repr(type, data, data_fixed,
+                                          !!(listener->sl_fixed_types & type),
+                                          &conv, &conv_data),
+                    type);
             }
         }
     }
 
-    /* Call data function */
+    /* Call data function, it always gets the float representation */
     if (ctx->user_func != NULL) {
-        return (ctx->user_func(sensor, ctx->user_arg, data, type));
+        return (ctx->user_func(sensor, ctx->user_arg,
+                    sensor_read_data_repr(type, data, data_fixed, 0,
+                                          &conv, &conv_data),
+                    type));
     }
 
     return (0);
@@ -1198,7 +1609,7 @@ sensor_mgr_put_interrupt_evt(struct sensor *sensor)
 }
 
 /**
- * Puts a notification event on the sensor manager evq
+ * Reports sensor events, see sensor.h
  *
  * @param ctx notification event context
  * @param evtype The notification event type
@@ -1207,24 +1618,70 @@ void
 sensor_mgr_put_notify_evt(struct sensor_notify_ev_ctx *ctx,
                           sensor_event_type_t evtype)
 {
-    struct sensor_notify_os_ev *snoe = os_memblock_get(&sensor_notify_evt_pool);
+    struct sensor_notifier *notifier;
+    sensor_event_type_t deferred;
+    sensor_event_type_t match;
+    uint32_t isr_calls;
+    os_sr_t sr;
 
-    if (!snoe) {
-        /* no free events */
-        return;
+    deferred = 0;
+    isr_calls = 0;
+
+    OS_ENTER_CRITICAL(sr);
+
+    ctx->snec_stats.sns_events++;
+
+    SLIST_FOREACH(notifier, &ctx->snec_sensor->s_notifier_list, sn_next) {
+        match = notifier->sn_sensor_event_type & evtype;
+        if (!match) {
+            continue;
+        }
+
+        if (notifier->sn_flags & SENSOR_NOTIFIER_F_ISR) {
+            notifier->sn_func(ctx->snec_sensor, notifier->sn_arg, match);
+            isr_calls++;
+        } else {
+            deferred |= match;
+        }
+    }
+    ctx->snec_stats.sns_isr_calls += isr_calls;
+
+    if (!deferred) {
+        OS_EXIT_CRITICAL(sr);
+        goto done;
+    }
+
+    if (ctx->snec_pending) {
+        /* Still queued, deliver with the pending dispatch */
+        ctx->snec_pending |= deferred;
+        ctx->snec_stats.sns_coalesced++;
+        OS_EXIT_CRITICAL(sr);
+        STATS_INC(g_sensor_mgr_stats, notify_coalesced);
+        goto done;
     }
 
-    *snoe = (struct sensor_notify_os_ev) {
-        .snoe_evt = {
-            .ev_arg = snoe,
-            .ev_cb = sensor_notify_ev_cb,
-        },
+    ctx->snec_pending = deferred;
+    ctx->snec_post_time = os_cputime_get32();
+    ctx->snec_evt.ev_cb = sensor_notify_ev_cb;
+    ctx->snec_evt.ev_arg = ctx;
+    os_eventq_put(sensor_mgr_evq_get(), &ctx->snec_evt);
 
-        .snoe_evtype = evtype,
-        .snoe_sensor = ctx->snec_sensor,
-    };
+    OS_EXIT_CRITICAL(sr);
 
-    os_eventq_put(sensor_mgr_evq_get(), &(snoe->snoe_evt));
+done:
+    STATS_INC(g_sensor_mgr_stats, notify_events);
+    STATS_INCN(g_sensor_mgr_stats, notify_isr_calls, isr_calls);
+}
+
+void
+sensor_notify_get_stats(struct sensor_notify_ev_ctx *ctx,
+                        struct sensor_notify_stats *stats)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    *stats = ctx->snec_stats;
+    OS_EXIT_CRITICAL(sr);
 }
 
 /**
@@ -1254,22 +1711,51 @@ sensor_interrupt_ev_cb(struct os_event *ev)
 static void
 sensor_notify_ev_cb(struct os_event * ev)
 {
-    struct sensor_notify_os_ev *snoe;
+    struct sensor_notify_ev_ctx *ctx;
     const struct sensor_notifier *notifier;
+    sensor_event_type_t pending;
+    sensor_event_type_t match;
+    uint32_t lat;
+    os_sr_t sr;
 
-    snoe = ev->ev_arg;
+    ctx = ev->ev_arg;
+
+    /* Take the pending events, anything reported from here on queues the
+     * context again.
+     */
+    OS_ENTER_CRITICAL(sr);
+    pending = ctx->snec_pending;
+    ctx->snec_pending = 0;
+    lat = os_cputime_ticks_to_usecs(os_cputime_get32() - ctx->snec_post_time);
+    ctx->snec_stats.sns_dispatched++;
+    ctx->snec_stats.sns_lat_sum += lat;
+    if (lat > ctx->snec_stats.sns_lat_max) {
+        ctx->snec_stats.sns_lat_max = lat;
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    if (lat > sensor_mgr.mgr_notify_lat_max) {
+        STATS_INCN(g_sensor_mgr_stats, notify_lat_max,
+                   lat - sensor_mgr.mgr_notify_lat_max);
+        sensor_mgr.mgr_notify_lat_max = lat;
+    }
+
+    /* Each event goes to the first notifier registered for it */
+    SLIST_FOREACH(notifier, &ctx->snec_sensor->s_notifier_list, sn_next) {
+        if (notifier->sn_flags & SENSOR_NOTIFIER_F_ISR) {
+            continue;
+        }
+
+        match = notifier->sn_sensor_event_type & pending;
+        if (match) {
+            pending &= ~match;
+            notifier->sn_func(ctx->snec_sensor, notifier->sn_arg, match);
+        }
 
-    SLIST_FOREACH(notifier, &snoe->snoe_sensor->s_notifier_list, sn_next) {
-        if (notifier->sn_sensor_event_type & snoe->snoe_evtype) {
-            notifier->sn_func(snoe->snoe_sensor,
-                              notifier->sn_arg,
-                              snoe->snoe_evtype);
+        if (!pending) {
             break;
         }
     }
-
-    /* Put notify os event back into the pool */
-    os_memblock_put(&sensor_notify_evt_pool, snoe);
 }
 
 static void
@@ -2145,6 +2631,7 @@ sensor_trigger_init(struct sensor *sensor, sensor_type_t type,
     sensor_trig_lner->sl_func = sensor_generate_trig;
     sensor_trig_lner->sl_sensor_type = type;
     sensor_trig_lner->sl_arg = (void *)notify;
+    sensor_trig_lner->sl_fixed_types = 0;
 
     rc = sensor_register_listener(sensor, sensor_trig_lner);
     if (rc) {
@@ -2200,3 +2687,102 @@ err:
     return (rc);
 }
 
+/**
+ * Data function of asynchronous reads, the driver calls it from its bus
+ * completion callback, without the sensor locked.
+ */
+static int
+sensor_read_async_data_func(struct sensor *sensor, void *arg, void *data,
+                            sensor_type_t type)
+{
+    int rc;
+
+    sensor_lock(sensor);
+    rc = sensor_read_data_func(sensor, arg, data, type);
+    sensor_unlock(sensor);
+
+    return (rc);
+}
+
+int
+sensor_read_async(struct sensor *sensor, sensor_type_t type,
+                  sensor_data_func_t data_func, void *arg,
+                  sensor_read_done_func_t done, void *done_arg)
+{
+    struct sensor_read_ctx src;
+    int rc;
+
+    if (sensor->s_funcs->sd_read_async == NULL) {
+        rc = sensor_read(sensor, type, data_func, arg, OS_TIMEOUT_NEVER);
+        if (rc == SYS_ENOENT) {
+            return (rc);
+        }
+        if (done != NULL) {
+            done(sensor, done_arg, rc);
+        }
+        return (0);
+    }
+
+    rc = sensor_lock(sensor);
+    if (rc) {
+        return (rc);
+    }
+
+    if (!sensor_mgr_match_bytype(sensor, (void *)&type)) {
+        rc = SYS_ENOENT;
+        goto err;
+    }
+
+    if (sensor->s_read_pending) {
+        rc = SYS_EBUSY;
+        goto err;
+    }
+
+    src.user_func = data_func;
+    src.user_arg = arg;
+    src.done_func = done;
+    src.done_arg = done_arg;
+    sensor->s_read_ctx = src;
+    sensor->s_read_pending = 1;
+
+    sensor_up_timestamp(sensor);
+
+    rc = sensor->s_funcs->sd_read_async(sensor, type,
+                                        sensor_read_async_data_func,
+                                        &sensor->s_read_ctx);
+    if (rc) {
+        sensor->s_read_pending = 0;
+        if (sensor->s_err_fn != NULL) {
+            sensor->s_err_fn(sensor, sensor->s_err_arg, rc);
+        }
+        goto err;
+    }
+
+err:
+    sensor_unlock(sensor);
+    return (rc);
+}
+
+void
+sensor_read_async_done(struct sensor *sensor, int status)
+{
+    sensor_read_done_func_t done;
+    void *done_arg;
+
+    sensor_lock(sensor);
+
+    done = sensor->s_read_ctx.done_func;
+    done_arg = sensor->s_read_ctx.done_arg;
+    sensor->s_read_pending = 0;
+
+    if (status && sensor->s_err_fn != NULL) {
+        sensor->s_err_fn(sensor, sensor->s_err_arg, status);
+    }
+
+    sensor_unlock(sensor);
+
+    if (done != NULL) {
+        done(sensor, done_arg, status);
+    }
+}
+
@@ -0,0 +1,351 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "os/mynewt.h"
+#include "sensor/sensor.h"
+#include "sensor/bus.h"
+#if MYNEWT_VAL(SENSOR_BUS_HAL_SPI)
+#include "hal/hal_spi.h"
+#include "hal/hal_gpio.h"
+#endif
+#if MYNEWT_VAL(SENSOR_BUS_HAL_I2C)
+#include "hal/hal_i2c.h"
+#endif
+
+static SLIST_HEAD(, sensor_bus) sensor_bus_list =
+    SLIST_HEAD_INITIALIZER(sensor_bus_list);
+
+static void
+sensor_bus_start(struct sensor_bus *bus, struct sensor_bus_xfer *xfer)
+{
+    int rc;
+
+    rc = bus->sb_backend->sbb_start(bus, xfer);
+    if (rc) {
+        /* Report the failure through the callback like any other */
+        sensor_bus_xfer_done(bus, rc);
+    }
+}
+
+/**
+ * Runs on the bus event queue once the current transfer is done: starts the
+ * next queued transfer before calling the completion callback, so the bus
+ * does not sit idle while the callback runs.
+ */
+static void
+sensor_bus_done_ev_cb(struct os_event *ev)
+{
+    struct sensor_bus_xfer *xfer;
+    struct sensor_bus_xfer *next;
+    struct sensor_bus *bus;
+    os_sr_t sr;
+
+    bus = ev->ev_arg;
+
+    OS_ENTER_CRITICAL(sr);
+    xfer = bus->sb_cur;
+    next = STAILQ_FIRST(&bus->sb_queue);
+    if (next != NULL) {
+        STAILQ_REMOVE_HEAD(&bus->sb_queue, sbx_next);
+    }
+    bus->sb_cur = next;
+    OS_EXIT_CRITICAL(sr);
+
+    if (next != NULL) {
+        sensor_bus_start(bus, next);
+    }
+
+    if (xfer != NULL && xfer->sbx_cb != NULL) {
+        xfer->sbx_cb(xfer, xfer->sbx_status);
+    }
+}
+
+int
+sensor_bus_register(struct sensor_bus *bus, uint8_t type, uint8_t num,
+                    const struct sensor_bus_backend *backend, void *arg)
+{
+    int rc;
+
+    if (backend == NULL || backend->sbb_start == NULL) {
+        return SYS_EINVAL;
+    }
+
+    memset(bus, 0, sizeof *bus);
+    bus->sb_type = type;
+    bus->sb_num = num;
+    bus->sb_backend = backend;
+    bus->sb_arg = arg;
+    bus->sb_evq = sensor_mgr_evq_get();
+    STAILQ_INIT(&bus->sb_queue);
+    bus->sb_done_ev.ev_cb = sensor_bus_done_ev_cb;
+    bus->sb_done_ev.ev_arg = bus;
+
+    rc = sensor_mgr_lock();
+    if (rc) {
+        return rc;
+    }
+
+    SLIST_INSERT_HEAD(&sensor_bus_list, bus, sb_next);
+
+    sensor_mgr_unlock();
+
+    return 0;
+}
+
+struct sensor_bus *
+sensor_bus_find(const struct sensor_itf *itf)
+{
+    struct sensor_bus *bus;
+
+    SLIST_FOREACH(bus, &sensor_bus_list, sb_next) {
+        if (bus->sb_type == itf->si_type && bus->sb_num == itf->si_num) {
+            break;
+        }
+    }
+
+    return bus;
+}
+
+int
+sensor_bus_submit(struct sensor_bus *bus, struct sensor_bus_xfer *xfer)
+{
+    int start;
+    os_sr_t sr;
+
+    if (xfer->sbx_wlen && xfer->sbx_wbuf == NULL) {
+        return SYS_EINVAL;
+    }
+    if (xfer->sbx_rlen && xfer->sbx_rbuf == NULL) {
+        return SYS_EINVAL;
+    }
+
+    xfer->sbx_status = 0;
+
+    OS_ENTER_CRITICAL(sr);
+    start = bus->sb_cur == NULL;
+    if (start) {
+        bus->sb_cur = xfer;
+    } else {
+        STAILQ_INSERT_TAIL(&bus->sb_queue, xfer, sbx_next);
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    if (start) {
+        sensor_bus_start(bus, xfer);
+    }
+
+    return 0;
+}
+
+int
+sensor_itf_submit(struct sensor_itf *itf, struct sensor_bus_xfer *xfer)
+{
+    struct sensor_bus *bus;
+
+    bus = sensor_bus_find(itf);
+    if (bus == NULL) {
+        return SYS_ENODEV;
+    }
+
+    if (itf->si_type == SENSOR_ITF_SPI) {
+        xfer->sbx_addr = itf->si_cs_pin;
+    } else {
+        xfer->sbx_addr = itf->si_addr;
+    }
+
+    return sensor_bus_submit(bus, xfer);
+}
+
+void
+sensor_bus_xfer_done(struct sensor_bus *bus, int status)
+{
+    bus->sb_cur->sbx_status = status;
+    os_eventq_put(bus->sb_evq, &bus->sb_done_ev);
+}
+
+#if MYNEWT_VAL(SENSOR_BUS_HAL_SPI)
+
+/* Called from interrupt context when the non-blocking transfer is done */
+static void
+sensor_bus_hal_spi_txrx_cb(void *arg, int len)
+{
+    struct sensor_bus_hal_spi *spi;
+    struct sensor_bus_xfer *xfer;
+
+    spi = arg;
+    xfer = spi->sbhs_bus.sb_cur;
+
+    hal_gpio_write(xfer->sbx_addr, 1);
+
+    if (xfer->sbx_rlen) {
+        memcpy(xfer->sbx_rbuf, &spi->sbhs_buf[1][xfer->sbx_wlen],
+               xfer->sbx_rlen);
+    }
+
+    sensor_bus_xfer_done(&spi->sbhs_bus,
+                         len == xfer->sbx_wlen + xfer->sbx_rlen ? 0 : SYS_EIO);
+}
+
+static int
+sensor_bus_hal_spi_start(struct sensor_bus *bus, struct sensor_bus_xfer *xfer)
+{
+    struct sensor_bus_hal_spi *spi;
+    int len;
+    int rc;
+
+    spi = bus->sb_arg;
+
+    /* SPI is full duplex; the read is clocked out after the write and the
+     * bytes received during the write are dropped.
+     */
+    len = xfer->sbx_wlen + xfer->sbx_rlen;
+    if (len == 0 || len > sizeof spi->sbhs_buf[0]) {
+        return SYS_EINVAL;
+    }
+
+    memcpy(spi->sbhs_buf[0], xfer->sbx_wbuf, xfer->sbx_wlen);
+    memset(&spi->sbhs_buf[0][xfer->sbx_wlen], 0, xfer->sbx_rlen);
+
+    hal_gpio_write(xfer->sbx_addr, 0);
+
+    if (spi->sbhs_noblock) {
+        rc = hal_spi_txrx_noblock(bus->sb_num, spi->sbhs_buf[0],
+                                  spi->sbhs_buf[1], len);
+        if (rc) {
+            hal_gpio_write(xfer->sbx_addr, 1);
+            return SYS_EIO;
+        }
+        return 0;
+    }
+
+    rc = hal_spi_txrx(bus->sb_num, spi->sbhs_buf[0], spi->sbhs_buf[1], len);
+    sensor_bus_hal_spi_txrx_cb(spi, rc ? 0 : len);
+
+    return 0;
+}
+
+static const struct sensor_bus_backend sensor_bus_hal_spi_backend = {
+    .sbb_start = sensor_bus_hal_spi_start,
+};
+
+int
+sensor_bus_hal_spi_init(struct sensor_bus_hal_spi *spi, uint8_t num)
+{
+    int rc;
+
+    rc = sensor_bus_register(&spi->sbhs_bus, SENSOR_ITF_SPI, num,
+                             &sensor_bus_hal_spi_backend, spi);
+    if (rc) {
+        return rc;
+    }
+
+    /* The callback can only be set with the SPI disabled.  Ports without
+     * non-blocking transfers fall back to hal_spi_txrx().
+     */
+    hal_spi_disable(num);
+    rc = hal_spi_set_txrx_cb(num, sensor_bus_hal_spi_txrx_cb, spi);
+    spi->sbhs_noblock = rc == 0;
+    hal_spi_enable(num);
+
+    return 0;
+}
+
+#endif
+
+#if MYNEWT_VAL(SENSOR_BUS_HAL_I2C)
+
+static int
+sensor_bus_hal_i2c_txrx(struct sensor_bus *bus, struct sensor_bus_xfer *xfer)
+{
+    struct hal_i2c_master_data data;
+    uint32_t timeout;
+    int rc;
+
+    timeout = os_time_ms_to_ticks32(MYNEWT_VAL(SENSOR_BUS_I2C_TIMEOUT_MS));
+
+    data.address = xfer->sbx_addr;
+
+    if (xfer->sbx_wlen) {
+        data.len = xfer->sbx_wlen;
+        data.buffer = (uint8_t *)xfer->sbx_wbuf;
+        rc = hal_i2c_master_write(bus->sb_num, &data, timeout,
+                                  xfer->sbx_rlen == 0);
+        if (rc) {
+            return SYS_EIO;
+        }
+    }
+
+    if (xfer->sbx_rlen) {
+        data.len = xfer->sbx_rlen;
+        data.buffer = xfer->sbx_rbuf;
+        rc = hal_i2c_master_read(bus->sb_num, &data, timeout, 1);
+        if (rc) {
+            return SYS_EIO;
+        }
+    }
+
+    return 0;
+}
+
+static void
+sensor_bus_hal_i2c_ev_cb(struct os_event *ev)
+{
+    struct sensor_bus_hal_i2c *i2c;
+
+    i2c = ev->ev_arg;
+
+    sensor_bus_xfer_done(&i2c->sbhi_bus,
+                         sensor_bus_hal_i2c_txrx(&i2c->sbhi_bus,
+                                                 i2c->sbhi_bus.sb_cur));
+}
+
+static int
+sensor_bus_hal_i2c_start(struct sensor_bus *bus, struct sensor_bus_xfer *xfer)
+{
+    struct sensor_bus_hal_i2c *i2c;
+
+    i2c = bus->sb_arg;
+
+    if (i2c->sbhi_evq != NULL) {
+        os_eventq_put(i2c->sbhi_evq, &i2c->sbhi_ev);
+    } else {
+        sensor_bus_xfer_done(bus, sensor_bus_hal_i2c_txrx(bus, xfer));
+    }
+
+    return 0;
+}
+
+static const struct sensor_bus_backend sensor_bus_hal_i2c_backend = {
+    .sbb_start = sensor_bus_hal_i2c_start,
+};
+
+int
+sensor_bus_hal_i2c_init(struct sensor_bus_hal_i2c *i2c, uint8_t num,
+                        struct os_eventq *evq)
+{
+    i2c->sbhi_evq = evq;
+    i2c->sbhi_ev.ev_cb = sensor_bus_hal_i2c_ev_cb;
+    i2c->sbhi_ev.ev_arg = i2c;
+
+    return sensor_bus_register(&i2c->sbhi_bus, SENSOR_ITF_I2C, num,
+                               &sensor_bus_hal_i2c_backend, i2c);
+}
+
+#endif
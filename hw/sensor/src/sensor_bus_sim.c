@@ -0,0 +1,101 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "os/mynewt.h"
+#include "sensor/sensor.h"
+#include "sensor/bus.h"
+
+#if MYNEWT_VAL(SENSOR_BUS_SIM)
+
+static int
+sensor_bus_sim_txrx(struct sensor_bus_sim *sim, struct sensor_bus_xfer *xfer)
+{
+    uint8_t reg;
+    int wlen;
+
+    if (xfer->sbx_wlen == 0) {
+        reg = 0;
+        wlen = 0;
+    } else {
+        reg = xfer->sbx_wbuf[0];
+        wlen = xfer->sbx_wlen - 1;
+    }
+
+    if (reg + wlen > sim->sbs_nregs || reg + xfer->sbx_rlen > sim->sbs_nregs) {
+        return SYS_EINVAL;
+    }
+
+    if (wlen) {
+        memcpy(&sim->sbs_regs[reg], &xfer->sbx_wbuf[1], wlen);
+    }
+    if (xfer->sbx_rlen) {
+        memcpy(xfer->sbx_rbuf, &sim->sbs_regs[reg], xfer->sbx_rlen);
+    }
+
+    return 0;
+}
+
+static void
+sensor_bus_sim_callout_cb(struct os_event *ev)
+{
+    struct sensor_bus_sim *sim;
+
+    sim = ev->ev_arg;
+
+    sim->sbs_xfers++;
+    sensor_bus_xfer_done(&sim->sbs_bus,
+                         sensor_bus_sim_txrx(sim, sim->sbs_bus.sb_cur));
+}
+
+static int
+sensor_bus_sim_start(struct sensor_bus *bus, struct sensor_bus_xfer *xfer)
+{
+    struct sensor_bus_sim *sim;
+
+    sim = bus->sb_arg;
+
+    if (sim->sbs_latency == 0) {
+        sensor_bus_sim_callout_cb(&sim->sbs_callout.c_ev);
+        return 0;
+    }
+
+    return os_callout_reset(&sim->sbs_callout, sim->sbs_latency);
+}
+
+static const struct sensor_bus_backend sensor_bus_sim_backend = {
+    .sbb_start = sensor_bus_sim_start,
+};
+
+int
+sensor_bus_sim_init(struct sensor_bus_sim *sim, uint8_t type, uint8_t num,
+                    uint8_t *regs, uint16_t nregs, os_time_t latency)
+{
+    sim->sbs_regs = regs;
+    sim->sbs_nregs = nregs;
+    sim->sbs_latency = latency;
+    sim->sbs_xfers = 0;
+    os_callout_init(&sim->sbs_callout, sensor_mgr_evq_get(),
+                    sensor_bus_sim_callout_cb, sim);
+
+    return sensor_bus_register(&sim->sbs_bus, type, num,
+                               &sensor_bus_sim_backend, sim);
+}
+
+#endif
@@ -0,0 +1,307 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "os/mynewt.h"
+#include "sensor/sensor.h"
+#include "sensor/accel.h"
+#include "sensor/mag.h"
+#include "sensor/quat.h"
+#include "sensor/euler.h"
+#include "sensor/temperature.h"
+#include "sensor/pressure.h"
+#include "sensor/humidity.h"
+#include "sensor/gyro.h"
+
+/*
+ * Copy one field, along with its validity bit, between the float and the
+ * fixed point representation of a reading.
+ */
+#define SENSOR_FIXED_CONV_TO(__d, __s, __f, __shift) do {               \
+    (__d)->__f = SENSOR_FIXED_FROM_FLOAT((__s)->__f, __shift);          \
+    (__d)->__f##_is_valid = (__s)->__f##_is_valid;                      \
+} while (0)
+
+#define SENSOR_FIXED_CONV_FROM(__d, __s, __f, __shift) do {             \
+    (__d)->__f = SENSOR_FIXED_TO_FLOAT((__s)->__f, __shift);            \
+    (__d)->__f##_is_valid = (__s)->__f##_is_valid;                      \
+} while (0)
+
+#define SENSOR_FIXED_CONV_TRIPLET(__conv, __d, __s, __p, __a, __b, __c, __shift) \
+do {                                                                    \
+    __conv(__d, __s, __p##_##__a, __shift);                             \
+    __conv(__d, __s, __p##_##__b, __shift);                             \
+    __conv(__d, __s, __p##_##__c, __shift);                             \
+} while (0)
+
+int
+sensor_data_to_fixed(sensor_type_t type, const void *src, void *dst)
+{
+    switch (type) {
+    case SENSOR_TYPE_ACCELEROMETER:
+    case SENSOR_TYPE_LINEAR_ACCEL:
+    case SENSOR_TYPE_GRAVITY: {
+        const struct sensor_accel_data *sad = src;
+        struct sensor_accel_data_fixed *sadf = dst;
+
+        SENSOR_FIXED_CONV_TRIPLET(SENSOR_FIXED_CONV_TO, sadf, sad, sad,
+                                  x, y, z, SENSOR_ACCEL_FIXED_SHIFT);
+        break;
+    }
+    case SENSOR_TYPE_MAGNETIC_FIELD: {
+        const struct sensor_mag_data *smd = src;
+        struct sensor_mag_data_fixed *smdf = dst;
+
+        SENSOR_FIXED_CONV_TRIPLET(SENSOR_FIXED_CONV_TO, smdf, smd, smd,
+                                  x, y, z, SENSOR_MAG_FIXED_SHIFT);
+        break;
+    }
+    case SENSOR_TYPE_GYROSCOPE: {
+        const struct sensor_gyro_data *sgd = src;
+        struct sensor_gyro_data_fixed *sgdf = dst;
+
+        SENSOR_FIXED_CONV_TRIPLET(SENSOR_FIXED_CONV_TO, sgdf, sgd, sgd,
+                                  x, y, z, SENSOR_GYRO_FIXED_SHIFT);
+        break;
+    }
+    case SENSOR_TYPE_EULER: {
+        const struct sensor_euler_data *sed = src;
+        struct sensor_euler_data_fixed *sedf = dst;
+
+        SENSOR_FIXED_CONV_TRIPLET(SENSOR_FIXED_CONV_TO, sedf, sed, sed,
+                                  h, r, p, SENSOR_EULER_FIXED_SHIFT);
+        break;
+    }
+    case SENSOR_TYPE_ROTATION_VECTOR: {
+        const struct sensor_quat_data *sqd = src;
+        struct sensor_quat_data_fixed *sqdf = dst;
+
+        SENSOR_FIXED_CONV_TRIPLET(SENSOR_FIXED_CONV_TO, sqdf, sqd, sqd,
+                                  x, y, z, SENSOR_QUAT_FIXED_SHIFT);
+        SENSOR_FIXED_CONV_TO(sqdf, sqd, sqd_w, SENSOR_QUAT_FIXED_SHIFT);
+        break;
+    }
+    case SENSOR_TYPE_TEMPERATURE:
+    case SENSOR_TYPE_AMBIENT_TEMPERATURE: {
+        const struct sensor_temp_data *std = src;
+        struct sensor_temp_data_fixed *stdf = dst;
+
+        SENSOR_FIXED_CONV_TO(stdf, std, std_temp, SENSOR_TEMP_FIXED_SHIFT);
+        break;
+    }
+    case SENSOR_TYPE_PRESSURE: {
+        const struct sensor_press_data *spd = src;
+        struct sensor_press_data_fixed *spdf = dst;
+
+        SENSOR_FIXED_CONV_TO(spdf, spd, spd_press, SENSOR_PRESS_FIXED_SHIFT);
+        break;
+    }
+    case SENSOR_TYPE_RELATIVE_HUMIDITY: {
+        const struct sensor_humid_data *shd = src;
+        struct sensor_humid_data_fixed *shdf = dst;
+
+        SENSOR_FIXED_CONV_TO(shdf, shd, shd_humid, SENSOR_HUMID_FIXED_SHIFT);
+        break;
+    }
+    default:
+        return SYS_ENOTSUP;
+    }
+
+    return 0;
+}
+
+int
+sensor_data_from_fixed(sensor_type_t type, const void *src, void *dst)
+{
+    switch (type) {
+    case SENSOR_TYPE_ACCELEROMETER:
+    case SENSOR_TYPE_LINEAR_ACCEL:
+    case SENSOR_TYPE_GRAVITY: {
+        const struct sensor_accel_data_fixed *sadf = src;
+        struct sensor_accel_data *sad = dst;
+
+        SENSOR_FIXED_CONV_TRIPLET(SENSOR_FIXED_CONV_FROM, sad, sadf, sad,
+                                  x, y, z, SENSOR_ACCEL_FIXED_SHIFT);
+        break;
+    }
+    case SENSOR_TYPE_MAGNETIC_FIELD: {
+        const struct sensor_mag_data_fixed *smdf = src;
+        struct sensor_mag_data *smd = dst;
+
+        SENSOR_FIXED_CONV_TRIPLET(SENSOR_FIXED_CONV_FROM, smd, smdf, smd,
+                                  x, y, z, SENSOR_MAG_FIXED_SHIFT);
+        break;
+    }
+    case SENSOR_TYPE_GYROSCOPE: {
+        const struct sensor_gyro_data_fixed *sgdf = src;
+        struct sensor_gyro_data *sgd = dst;
+
+        SENSOR_FIXED_CONV_TRIPLET(SENSOR_FIXED_CONV_FROM, sgd, sgdf, sgd,
+                                  x, y, z, SENSOR_GYRO_FIXED_SHIFT);
+        break;
+    }
+    case SENSOR_TYPE_EULER: {
+        const struct sensor_euler_data_fixed *sedf = src;
+        struct sensor_euler_data *sed = dst;
+
+        SENSOR_FIXED_CONV_TRIPLET(SENSOR_FIXED_CONV_FROM, sed, sedf, sed,
+                                  h, r, p, SENSOR_EULER_FIXED_SHIFT);
+        break;
+    }
+    case SENSOR_TYPE_ROTATION_VECTOR: {
+        const struct sensor_quat_data_fixed *sqdf = src;
+        struct sensor_quat_data *sqd = dst;
+
+        SENSOR_FIXED_CONV_TRIPLET(SENSOR_FIXED_CONV_FROM, sqd, sqdf, sqd,
+                                  x, y, z, SENSOR_QUAT_FIXED_SHIFT);
+        SENSOR_FIXED_CONV_FROM(sqd, sqdf, sqd_w, SENSOR_QUAT_FIXED_SHIFT);
+        break;
+    }
+    case SENSOR_TYPE_TEMPERATURE:
+    case SENSOR_TYPE_AMBIENT_TEMPERATURE: {
+        const struct sensor_temp_data_fixed *stdf = src;
+        struct sensor_temp_data *std = dst;
+
+        SENSOR_FIXED_CONV_FROM(std, stdf, std_temp, SENSOR_TEMP_FIXED_SHIFT);
+        break;
+    }
+    case SENSOR_TYPE_PRESSURE: {
+        const struct sensor_press_data_fixed *spdf = src;
+        struct sensor_press_data *spd = dst;
+
+        SENSOR_FIXED_CONV_FROM(spd, spdf, spd_press, SENSOR_PRESS_FIXED_SHIFT);
+        break;
+    }
+    case SENSOR_TYPE_RELATIVE_HUMIDITY: {
+        const struct sensor_humid_data_fixed *shdf = src;
+        struct sensor_humid_data *shd = dst;
+
+        SENSOR_FIXED_CONV_FROM(shd, shdf, shd_humid, SENSOR_HUMID_FIXED_SHIFT);
+        break;
+    }
+    default:
+        return SYS_ENOTSUP;
+    }
+
+    return 0;
+}
+
+/* Invalid values repeat the previous one, or read as 0 without one */
+#define SENSOR_FIXED_VAL(__v, __prev, __s, __f, __i) do {               \
+    if ((__v) != NULL) {                                                \
+        (__v)[__i] = (__s)->__f##_is_valid ? (__s)->__f :               \
+                     (__prev) != NULL ? (__prev)[__i] : 0;              \
+    }                                                                   \
+} while (0)
+
+int
+sensor_fixed_values(sensor_type_t type, const void *data,
+                     const int32_t *prev, int32_t *v, uint8_t *shift)
+{
+    switch (type) {
+    case SENSOR_TYPE_ACCELEROMETER:
+    case SENSOR_TYPE_LINEAR_ACCEL:
+    case SENSOR_TYPE_GRAVITY: {
+        const struct sensor_accel_data_fixed *sadf = data;
+
+        if (sadf != NULL) {
+            SENSOR_FIXED_VAL(v, prev, sadf, sad_x, 0);
+            SENSOR_FIXED_VAL(v, prev, sadf, sad_y, 1);
+            SENSOR_FIXED_VAL(v, prev, sadf, sad_z, 2);
+        }
+        *shift = SENSOR_ACCEL_FIXED_SHIFT;
+        return 3;
+    }
+    case SENSOR_TYPE_MAGNETIC_FIELD: {
+        const struct sensor_mag_data_fixed *smdf = data;
+
+        if (smdf != NULL) {
+            SENSOR_FIXED_VAL(v, prev, smdf, smd_x, 0);
+            SENSOR_FIXED_VAL(v, prev, smdf, smd_y, 1);
+            SENSOR_FIXED_VAL(v, prev, smdf, smd_z, 2);
+        }
+        *shift = SENSOR_MAG_FIXED_SHIFT;
+        return 3;
+    }
+    case SENSOR_TYPE_GYROSCOPE: {
+        const struct sensor_gyro_data_fixed *sgdf = data;
+
+        if (sgdf != NULL) {
+            SENSOR_FIXED_VAL(v, prev, sgdf, sgd_x, 0);
+            SENSOR_FIXED_VAL(v, prev, sgdf, sgd_y, 1);
+            SENSOR_FIXED_VAL(v, prev, sgdf, sgd_z, 2);
+        }
+        *shift = SENSOR_GYRO_FIXED_SHIFT;
+        return 3;
+    }
+    case SENSOR_TYPE_EULER: {
+        const struct sensor_euler_data_fixed *sedf = data;
+
+        if (sedf != NULL) {
+            SENSOR_FIXED_VAL(v, prev, sedf, sed_h, 0);
+            SENSOR_FIXED_VAL(v, prev, sedf, sed_r, 1);
+            SENSOR_FIXED_VAL(v, prev, sedf, sed_p, 2);
+        }
+        *shift = SENSOR_EULER_FIXED_SHIFT;
+        return 3;
+    }
+    case SENSOR_TYPE_ROTATION_VECTOR: {
+        const struct sensor_quat_data_fixed *sqdf = data;
+
+        if (sqdf != NULL) {
+            SENSOR_FIXED_VAL(v, prev, sqdf, sqd_x, 0);
+            SENSOR_FIXED_VAL(v, prev, sqdf, sqd_y, 1);
+            SENSOR_FIXED_VAL(v, prev, sqdf, sqd_z, 2);
+            SENSOR_FIXED_VAL(v, prev, sqdf, sqd_w, 3);
+        }
+        *shift = SENSOR_QUAT_FIXED_SHIFT;
+        return 4;
+    }
+    case SENSOR_TYPE_TEMPERATURE:
+    case SENSOR_TYPE_AMBIENT_TEMPERATURE: {
+        const struct sensor_temp_data_fixed *stdf = data;
+
+        if (stdf != NULL) {
+            SENSOR_FIXED_VAL(v, prev, stdf, std_temp, 0);
+        }
+        *shift = SENSOR_TEMP_FIXED_SHIFT;
+        return 1;
+    }
+    case SENSOR_TYPE_PRESSURE: {
+        const struct sensor_press_data_fixed *spdf = data;
+
+        if (spdf != NULL) {
+            SENSOR_FIXED_VAL(v, prev, spdf, spd_press, 0);
+        }
+        *shift = SENSOR_PRESS_FIXED_SHIFT;
+        return 1;
+    }
+    case SENSOR_TYPE_RELATIVE_HUMIDITY: {
+        const struct sensor_humid_data_fixed *shdf = data;
+
+        if (shdf != NULL) {
+            SENSOR_FIXED_VAL(v, prev, shdf, shd_humid, 0);
+        }
+        *shift = SENSOR_HUMID_FIXED_SHIFT;
+        return 1;
+    }
+    default:
+        return 0;
+    }
+}
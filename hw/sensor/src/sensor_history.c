@@ -0,0 +1,544 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "os/mynewt.h"
+#include "sensor/sensor.h"
+#include "sensor/history.h"
+#include "sensor_priv.h"
+#if MYNEWT_VAL(SENSOR_HISTORY_FCB)
+#include "flash_map/flash_map.h"
+#endif
+
+/* Stored sample, followed by sh_axes values */
+struct sensor_history_rec {
+    uint32_t shr_index;
+    uint32_t shr_sec;
+    uint16_t shr_ms;
+    int32_t shr_val[];
+} __attribute__((packed));
+
+#define SENSOR_HISTORY_REC_MAX  \
+    (sizeof(struct sensor_history_rec) + SENSOR_HISTORY_AXES_MAX * 4)
+
+static SLIST_HEAD(, sensor_history) sensor_history_list =
+    SLIST_HEAD_INITIALIZER(sensor_history_list);
+
+static void
+sensor_history_lock(struct sensor_history *sh)
+{
+    os_mutex_pend(&sh->sh_lock, OS_TIMEOUT_NEVER);
+}
+
+static void
+sensor_history_unlock(struct sensor_history *sh)
+{
+    os_mutex_release(&sh->sh_lock);
+}
+
+static int
+sensor_history_ram_append(struct sensor_history *sh, const void *rec,
+                          int len)
+{
+    uint16_t slot;
+
+    if (sh->sh_ram.shr_cnt < sh->sh_ram.shr_cap) {
+        slot = (sh->sh_ram.shr_head + sh->sh_ram.shr_cnt) % sh->sh_ram.shr_cap;
+        sh->sh_ram.shr_cnt++;
+    } else {
+        /* Full, overwrite the oldest */
+        slot = sh->sh_ram.shr_head;
+        sh->sh_ram.shr_head = (slot + 1) % sh->sh_ram.shr_cap;
+    }
+
+    memcpy(&sh->sh_ram.shr_buf[slot * len], rec, len);
+
+    return 0;
+}
+
+static int
+sensor_history_ram_walk(struct sensor_history *sh,
+                        struct sensor_history_cursor *cur,
+                        int (*func)(struct sensor_history *, const void *,
+                                    void *),
+                        void *arg)
+{
+    uint32_t skip;
+    uint16_t slot;
+    int rc;
+    int i;
+
+    /* Every append succeeds, so the ring holds consecutive indexes ending
+     * at sh_next_index - 1 and the cursor's record is found directly.
+     */
+    skip = cur->shc_index - (sh->sh_next_index - sh->sh_ram.shr_cnt);
+    if (skip > sh->sh_ram.shr_cnt) {
+        skip = 0;
+    }
+
+    for (i = skip; i < sh->sh_ram.shr_cnt; i++) {
+        slot = (sh->sh_ram.shr_head + i) % sh->sh_ram.shr_cap;
+        rc = func(sh, &sh->sh_ram.shr_buf[slot * sh->sh_rec_len], arg);
+        if (rc) {
+            return rc;
+        }
+    }
+
+    return 0;
+}
+
+static int
+sensor_history_ram_clear(struct sensor_history *sh)
+{
+    sh->sh_ram.shr_head = 0;
+    sh->sh_ram.shr_cnt = 0;
+
+    return 0;
+}
+
+const struct sensor_history_handler sensor_history_ram_handler = {
+    .shh_append = sensor_history_ram_append,
+    .shh_walk = sensor_history_ram_walk,
+    .shh_clear = sensor_history_ram_clear,
+};
+
+#if MYNEWT_VAL(SENSOR_HISTORY_FCB)
+
+static int
+sensor_history_fcb_append(struct sensor_history *sh, const void *rec,
+                          int len)
+{
+    struct fcb_entry loc;
+    int rc;
+
+    while (1) {
+        rc = fcb_append(sh->sh_fcb, len, &loc);
+        if (rc == 0) {
+            break;
+        }
+
+        if (rc != FCB_ERR_NOSPACE) {
+            return SYS_EIO;
+        }
+
+        rc = fcb_rotate(sh->sh_fcb);
+        if (rc) {
+            return SYS_EIO;
+        }
+    }
+
+    rc = flash_area_write(loc.fe_area, loc.fe_data_off, rec, len);
+    if (rc) {
+        return SYS_EIO;
+    }
+
+    rc = fcb_append_finish(sh->sh_fcb, &loc);
+    if (rc) {
+        return SYS_EIO;
+    }
+
+    return 0;
+}
+
+static int
+sensor_history_fcb_read(struct sensor_history *sh, struct fcb_entry *loc,
+                        void *rec)
+{
+    if (loc->fe_data_len != sh->sh_rec_len) {
+        return SYS_ENOENT;
+    }
+
+    if (flash_area_read(loc->fe_area, loc->fe_data_off, rec, sh->sh_rec_len)) {
+        return SYS_EIO;
+    }
+
+    return 0;
+}
+
+static int
+sensor_history_fcb_walk(struct sensor_history *sh,
+                        struct sensor_history_cursor *cur,
+                        int (*func)(struct sensor_history *, const void *,
+                                    void *),
+                        void *arg)
+{
+    uint8_t buf[SENSOR_HISTORY_REC_MAX];
+    struct sensor_history_rec *rec;
+    struct fcb_entry loc;
+    int rc;
+
+    rec = (struct sensor_history_rec *)buf;
+
+    /* Resume on the cursor's entry if it still holds the expected sample;
+     * its sector may have been rotated out since.
+     */
+    loc = cur->shc_loc;
+    if (loc.fe_area == NULL ||
+        sensor_history_fcb_read(sh, &loc, rec) != 0 ||
+        rec->shr_index != cur->shc_index) {
+
+        memset(&loc, 0, sizeof loc);
+        rc = fcb_getnext(sh->sh_fcb, &loc);
+    } else {
+        rc = 0;
+    }
+
+    for (; rc == 0; rc = fcb_getnext(sh->sh_fcb, &loc)) {
+        /* Skip entries written with another layout */
+        rc = sensor_history_fcb_read(sh, &loc, rec);
+        if (rc == SYS_ENOENT) {
+            continue;
+        }
+        if (rc) {
+            return rc;
+        }
+
+        rc = func(sh, rec, arg);
+        if (rc) {
+            cur->shc_loc = loc;
+            return rc;
+        }
+    }
+
+    if (rc != FCB_ERR_NOVAR) {
+        return SYS_EIO;
+    }
+
+    return 0;
+}
+
+static int
+sensor_history_fcb_clear(struct sensor_history *sh)
+{
+    return fcb_clear(sh->sh_fcb) ? SYS_EIO : 0;
+}
+
+const struct sensor_history_handler sensor_history_fcb_handler = {
+    .shh_append = sensor_history_fcb_append,
+    .shh_walk = sensor_history_fcb_walk,
+    .shh_clear = sensor_history_fcb_clear,
+};
+
+/* Continues the sequence numbers where the stored samples left off */
+static int
+sensor_history_fcb_last_index(struct sensor_history *sh, const void *data,
+                              void *arg)
+{
+    const struct sensor_history_rec *rec;
+
+    rec = data;
+    sh->sh_next_index = rec->shr_index + 1;
+
+    return 0;
+}
+
+#endif
+
+static int
+sensor_history_init(struct sensor_history *sh, sensor_type_t type,
+                    const struct sensor_history_handler *handler)
+{
+    uint8_t shift;
+    int axes;
+
+    axes = sensor_fixed_values(type, NULL, NULL, NULL, &shift);
+    if (axes == 0) {
+        return SYS_ENOTSUP;
+    }
+
+    memset(sh, 0, sizeof *sh);
+    sh->sh_type = type;
+    sh->sh_axes = axes;
+    sh->sh_shift = shift;
+    sh->sh_rec_len = sizeof(struct sensor_history_rec) + axes * 4;
+    sh->sh_handler = handler;
+
+    return os_mutex_init(&sh->sh_lock);
+}
+
+int
+sensor_history_init_ram(struct sensor_history *sh, sensor_type_t type,
+                        uint8_t *buf, uint16_t buf_size)
+{
+    int rc;
+
+    rc = sensor_history_init(sh, type, &sensor_history_ram_handler);
+    if (rc) {
+        return rc;
+    }
+
+    if (buf_size < sh->sh_rec_len) {
+        return SYS_EINVAL;
+    }
+
+    sh->sh_ram.shr_buf = buf;
+    sh->sh_ram.shr_cap = buf_size / sh->sh_rec_len;
+
+    return 0;
+}
+
+#if MYNEWT_VAL(SENSOR_HISTORY_FCB)
+int
+sensor_history_init_fcb(struct sensor_history *sh, sensor_type_t type,
+                        struct fcb *fcb)
+{
+    struct sensor_history_cursor cur;
+    int rc;
+
+    rc = sensor_history_init(sh, type, &sensor_history_fcb_handler);
+    if (rc) {
+        return rc;
+    }
+
+    sh->sh_fcb = fcb;
+
+    sensor_history_cursor_init(&cur, 0);
+    rc = sensor_history_fcb_walk(sh, &cur, sensor_history_fcb_last_index,
+                                 NULL);
+    if (rc) {
+        return rc;
+    }
+
+    return 0;
+}
+#endif
+
+int
+sensor_history_add(struct sensor_history *sh, const void *data,
+                   const struct os_timeval *ts)
+{
+    uint8_t buf[SENSOR_HISTORY_REC_MAX];
+    struct sensor_history_rec *rec;
+    struct os_timeval now;
+    int32_t v[SENSOR_HISTORY_AXES_MAX];
+    uint8_t shift;
+    int rc;
+
+    if (ts == NULL) {
+        os_gettimeofday(&now, NULL);
+        ts = &now;
+    }
+
+    sensor_fixed_values(sh->sh_type, data, NULL, v, &shift);
+
+    rec = (struct sensor_history_rec *)buf;
+    rec->shr_sec = ts->tv_sec;
+    rec->shr_ms = ts->tv_usec / 1000;
+    memcpy(rec->shr_val, v, sh->sh_axes * sizeof v[0]);
+
+    sensor_history_lock(sh);
+
+    rec->shr_index = sh->sh_next_index;
+    rc = sh->sh_handler->shh_append(sh, rec, sh->sh_rec_len);
+    if (rc == 0) {
+        sh->sh_next_index++;
+        sh->sh_stored++;
+    } else {
+        sh->sh_errors++;
+    }
+
+    sensor_history_unlock(sh);
+
+    return rc;
+}
+
+struct sensor_history_walk_arg {
+    uint64_t from;
+    uint64_t to;
+    struct sensor_history_cursor *cur;
+    sensor_history_walk_func_t func;
+    void *arg;
+};
+
+static int
+sensor_history_walk_rec(struct sensor_history *sh, const void *data,
+                        void *arg)
+{
+    struct sensor_history_walk_arg *wa;
+    const struct sensor_history_rec *rec;
+    struct sensor_history_sample shs;
+    int rc;
+
+    wa = arg;
+    rec = data;
+
+    /* Indexes wrap after 2^32 samples, compare the distance */
+    if ((int32_t)(rec->shr_index - wa->cur->shc_index) < 0) {
+        return 0;
+    }
+
+    shs.shs_ts = (uint64_t)rec->shr_sec * 1000 + rec->shr_ms;
+    if (shs.shs_ts < wa->from || (wa->to != 0 && shs.shs_ts > wa->to)) {
+        return 0;
+    }
+
+    shs.shs_index = rec->shr_index;
+    memset(shs.shs_val, 0, sizeof shs.shs_val);
+    memcpy(shs.shs_val, rec->shr_val, sh->sh_axes * sizeof shs.shs_val[0]);
+
+    rc = wa->func(sh, &shs, wa->arg);
+    if (rc) {
+        wa->cur->shc_index = rec->shr_index;
+    }
+
+    return rc;
+}
+
+void
+sensor_history_cursor_init(struct sensor_history_cursor *cur, uint32_t index)
+{
+    memset(cur, 0, sizeof *cur);
+    cur->shc_index = index;
+}
+
+int
+sensor_history_walk_cursor(struct sensor_history *sh, uint64_t from,
+                           uint64_t to, struct sensor_history_cursor *cur,
+                           sensor_history_walk_func_t func, void *arg)
+{
+    struct sensor_history_walk_arg wa;
+    int rc;
+
+    wa.from = from;
+    wa.to = to;
+    wa.cur = cur;
+    wa.func = func;
+    wa.arg = arg;
+
+    sensor_history_lock(sh);
+    rc = sh->sh_handler->shh_walk(sh, cur, sensor_history_walk_rec, &wa);
+    if (rc == 0) {
+        /* Walked to the end, nothing to resume */
+        sensor_history_cursor_init(cur, sh->sh_next_index);
+    }
+    sensor_history_unlock(sh);
+
+    return rc;
+}
+
+int
+sensor_history_walk(struct sensor_history *sh, uint64_t from, uint64_t to,
+                    uint32_t index, sensor_history_walk_func_t func,
+                    void *arg)
+{
+    struct sensor_history_cursor cur;
+
+    sensor_history_cursor_init(&cur, index);
+
+    return sensor_history_walk_cursor(sh, from, to, &cur, func, arg);
+}
+
+int
+sensor_history_clear(struct sensor_history *sh)
+{
+    int rc;
+
+    sensor_history_lock(sh);
+    rc = sh->sh_handler->shh_clear(sh);
+    sensor_history_unlock(sh);
+
+    return rc;
+}
+
+static int
+sensor_history_listener_func(struct sensor *sensor, void *arg, void *data,
+                             sensor_type_t type)
+{
+    struct sensor_history *sh;
+
+    sh = arg;
+
+    if (type != sh->sh_type) {
+        return 0;
+    }
+
+    return sensor_history_add(sh, data, &sensor->s_sts.st_ostv);
+}
+
+int
+sensor_history_register(struct sensor *sensor, struct sensor_history *sh)
+{
+    int rc;
+
+    sh->sh_sensor = sensor;
+    sh->sh_listener.sl_sensor_type = sh->sh_type;
+    sh->sh_listener.sl_fixed_types = sh->sh_type;
+    sh->sh_listener.sl_func = sensor_history_listener_func;
+    sh->sh_listener.sl_arg = sh;
+
+    rc = sensor_register_listener(sensor, &sh->sh_listener);
+    if (rc) {
+        return rc;
+    }
+
+    sensor_mgr_lock();
+    SLIST_INSERT_HEAD(&sensor_history_list, sh, sh_next);
+    sensor_mgr_unlock();
+
+    return 0;
+}
+
+int
+sensor_history_unregister(struct sensor_history *sh)
+{
+    int rc;
+
+    rc = sensor_unregister_listener(sh->sh_sensor, &sh->sh_listener);
+    if (rc) {
+        return rc;
+    }
+
+    sensor_mgr_lock();
+    SLIST_REMOVE(&sensor_history_list, sh, sensor_history, sh_next);
+    sensor_mgr_unlock();
+
+    return 0;
+}
+
+struct sensor_history *
+sensor_history_get_next(struct sensor_history *prev)
+{
+    struct sensor_history *sh;
+
+    sensor_mgr_lock();
+    if (prev == NULL) {
+        sh = SLIST_FIRST(&sensor_history_list);
+    } else {
+        sh = SLIST_NEXT(prev, sh_next);
+    }
+    sensor_mgr_unlock();
+
+    return sh;
+}
+
+struct sensor_history *
+sensor_history_find(const char *devname, sensor_type_t type)
+{
+    struct sensor_history *sh;
+
+    sh = NULL;
+    while ((sh = sensor_history_get_next(sh)) != NULL) {
+        if (sh->sh_type == type &&
+            !strcmp(sh->sh_sensor->s_dev->od_name, devname)) {
+            break;
+        }
+    }
+
+    return sh;
+}
@@ -0,0 +1,253 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(SENSOR_HISTORY_NEWTMGR)
+
+#include "mgmt/mgmt.h"
+#include "cborattr/cborattr.h"
+#include "sensor/sensor.h"
+#include "sensor/history.h"
+
+#if SENSOR_HISTORY_NMGR_GROUP_ID < MGMT_GROUP_ID_PERUSER
+#error "SENSOR_HISTORY_NMGR_GROUP must be a per-user newtmgr group"
+#endif
+
+static int sensor_history_nmgr_read(struct mgmt_cbuf *cb);
+static int sensor_history_nmgr_list(struct mgmt_cbuf *cb);
+
+static struct mgmt_group sensor_history_nmgr_group;
+
+/* ORDER MATTERS HERE.
+ * Each element represents the command ID, referenced from newtmgr.
+ */
+static struct mgmt_handler sensor_history_nmgr_group_handlers[] = {
+    [SENSOR_HISTORY_NMGR_OP_READ] = {sensor_history_nmgr_read, NULL},
+    [SENSOR_HISTORY_NMGR_OP_LIST] = {sensor_history_nmgr_list, NULL},
+};
+
+struct sensor_history_nmgr_encode {
+    CborEncoder *enc;
+    int count;
+    uint32_t next_index;
+};
+
+/* Walk stops here when the response is full */
+#define SENSOR_HISTORY_NMGR_FULL    (1)
+
+/* Where the last read stopped, so the follow-up request for next_index
+ * resumes there instead of rescanning the history.
+ */
+static struct {
+    struct sensor_history *sh;
+    struct sensor_history_cursor cur;
+} sensor_history_nmgr_session;
+
+static int
+sensor_history_nmgr_encode_sample(struct sensor_history *sh,
+                                  const struct sensor_history_sample *shs,
+                                  void *arg)
+{
+    struct sensor_history_nmgr_encode *ne;
+    CborError g_err = CborNoError;
+    CborEncoder sample;
+    int i;
+
+    ne = arg;
+
+    if (ne->count >= MYNEWT_VAL(SENSOR_HISTORY_NMGR_CHUNK)) {
+        ne->next_index = shs->shs_index;
+        return SENSOR_HISTORY_NMGR_FULL;
+    }
+
+    /* [ts, value...] */
+    g_err |= cbor_encoder_create_array(ne->enc, &sample, sh->sh_axes + 1);
+    g_err |= cbor_encode_uint(&sample, shs->shs_ts);
+    for (i = 0; i < sh->sh_axes; i++) {
+        g_err |= cbor_encode_int(&sample, shs->shs_val[i]);
+    }
+    g_err |= cbor_encoder_close_container(ne->enc, &sample);
+    if (g_err) {
+        return MGMT_ERR_ENOMEM;
+    }
+
+    ne->count++;
+
+    return 0;
+}
+
+/**
+ * Newtmgr sensor history read handler.  Returns up to
+ * SENSOR_HISTORY_NMGR_CHUNK samples taken in [from, to]; while "more" is
+ * set in the response, the client repeats the request with "index" set to
+ * the "next_index" of the response.
+ *
+ * @param cbor buffer
+ * @return 0 on success; non-zero on failure
+ */
+static int
+sensor_history_nmgr_read(struct mgmt_cbuf *cb)
+{
+    struct sensor_history_nmgr_encode ne;
+    struct sensor_history *sh;
+    char name[32] = {0};
+    uint64_t type = 0;
+    uint64_t from = 0;
+    uint64_t to = 0;
+    uint64_t index = 0;
+    CborError g_err = CborNoError;
+    CborEncoder samples;
+    int rc;
+
+    const struct cbor_attr_t attr[6] = {
+        [0] = {
+            .attribute = "name",
+            .type = CborAttrTextStringType,
+            .addr.string = name,
+            .len = sizeof(name)
+        },
+        [1] = {
+            .attribute = "type",
+            .type = CborAttrUnsignedIntegerType,
+            .addr.uinteger = &type
+        },
+        [2] = {
+            .attribute = "from",
+            .type = CborAttrUnsignedIntegerType,
+            .addr.uinteger = &from
+        },
+        [3] = {
+            .attribute = "to",
+            .type = CborAttrUnsignedIntegerType,
+            .addr.uinteger = &to
+        },
+        [4] = {
+            .attribute = "index",
+            .type = CborAttrUnsignedIntegerType,
+            .addr.uinteger = &index
+        },
+        [5] = {
+            .attribute = NULL
+        }
+    };
+
+    rc = cbor_read_object(&cb->it, attr);
+    if (rc) {
+        return MGMT_ERR_EINVAL;
+    }
+
+    sh = sensor_history_find(name, type);
+    if (sh == NULL) {
+        return MGMT_ERR_ENOENT;
+    }
+
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "shift");
+    g_err |= cbor_encode_uint(&cb->encoder, sh->sh_shift);
+
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "samples");
+    g_err |= cbor_encoder_create_array(&cb->encoder, &samples,
+                                       CborIndefiniteLength);
+
+    ne.enc = &samples;
+    ne.count = 0;
+    ne.next_index = sh->sh_next_index;
+
+    if (sensor_history_nmgr_session.sh != sh ||
+        sensor_history_nmgr_session.cur.shc_index != index) {
+        sensor_history_nmgr_session.sh = sh;
+        sensor_history_cursor_init(&sensor_history_nmgr_session.cur, index);
+    }
+
+    rc = sensor_history_walk_cursor(sh, from, to,
+                                    &sensor_history_nmgr_session.cur,
+                                    sensor_history_nmgr_encode_sample, &ne);
+
+    g_err |= cbor_encoder_close_container(&cb->encoder, &samples);
+
+    if (rc != 0 && rc != SENSOR_HISTORY_NMGR_FULL) {
+        return rc < 0 ? MGMT_ERR_EUNKNOWN : rc;
+    }
+
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "next_index");
+    g_err |= cbor_encode_uint(&cb->encoder, ne.next_index);
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "more");
+    g_err |= cbor_encode_boolean(&cb->encoder,
+                                 rc == SENSOR_HISTORY_NMGR_FULL);
+    if (g_err) {
+        return MGMT_ERR_ENOMEM;
+    }
+
+    return mgmt_cbuf_setoerr(cb, 0);
+}
+
+/**
+ * Newtmgr sensor history list handler
+ *
+ * @param cbor buffer
+ * @return 0 on success; non-zero on failure
+ */
+static int
+sensor_history_nmgr_list(struct mgmt_cbuf *cb)
+{
+    struct sensor_history *sh;
+    CborError g_err = CborNoError;
+    CborEncoder histories;
+    CborEncoder hist;
+
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "histories");
+    g_err |= cbor_encoder_create_array(&cb->encoder, &histories,
+                                       CborIndefiniteLength);
+
+    sh = NULL;
+    while ((sh = sensor_history_get_next(sh)) != NULL) {
+        g_err |= cbor_encoder_create_map(&histories, &hist,
+                                         CborIndefiniteLength);
+        g_err |= cbor_encode_text_stringz(&hist, "name");
+        g_err |= cbor_encode_text_stringz(&hist,
+                                          sh->sh_sensor->s_dev->od_name);
+        g_err |= cbor_encode_text_stringz(&hist, "type");
+        g_err |= cbor_encode_uint(&hist, sh->sh_type);
+        g_err |= cbor_encode_text_stringz(&hist, "axes");
+        g_err |= cbor_encode_uint(&hist, sh->sh_axes);
+        g_err |= cbor_encode_text_stringz(&hist, "next_index");
+        g_err |= cbor_encode_uint(&hist, sh->sh_next_index);
+        g_err |= cbor_encoder_close_container(&histories, &hist);
+    }
+
+    g_err |= cbor_encoder_close_container(&cb->encoder, &histories);
+    if (g_err) {
+        return MGMT_ERR_ENOMEM;
+    }
+
+    return mgmt_cbuf_setoerr(cb, 0);
+}
+
+int
+sensor_history_nmgr_register_group(void)
+{
+    MGMT_GROUP_SET_HANDLERS(&sensor_history_nmgr_group,
+                            sensor_history_nmgr_group_handlers);
+    sensor_history_nmgr_group.mg_group_id = SENSOR_HISTORY_NMGR_GROUP_ID;
+
+    return mgmt_group_register(&sensor_history_nmgr_group);
+}
+
+#endif
@@ -37,6 +37,7 @@
 #include "sensor/pressure.h"
 #include "sensor/humidity.h"
 #include "sensor/gyro.h"
+#include "sensor/stream.h"
 
 /* OIC */
 #include <oic/oc_rep.h>
@@ -645,6 +646,68 @@ err:
     return rc;
 }
 
+static void
+sensor_oic_stream_encode(const struct sensor_stream_window *ssw)
+{
+    oc_rep_set_uint(root, n, ssw->ssw_count);
+    oc_rep_set_uint(root, shift, ssw->ssw_shift);
+    oc_rep_set_int_array(root, min, ssw->ssw_min, ssw->ssw_axes);
+    oc_rep_set_int_array(root, max, ssw->ssw_max, ssw->ssw_axes);
+    oc_rep_set_int_array(root, mean, ssw->ssw_mean, ssw->ssw_axes);
+    oc_rep_set_int_array(root, rms, ssw->ssw_rms, ssw->ssw_axes);
+    if (ssw->ssw_blk != NULL) {
+        oc_rep_set_uint(root, qshift, ssw->ssw_qshift);
+        oc_rep_set_byte_string(root, blk, ssw->ssw_blk, ssw->ssw_blk_len);
+    }
+    oc_rep_set_uint(root, ts_secs, (long int)ssw->ssw_start.tv_sec);
+    oc_rep_set_int(root, ts_usecs, (int)ssw->ssw_start.tv_usec);
+    oc_rep_set_uint(root, te_secs, (long int)ssw->ssw_end.tv_sec);
+    oc_rep_set_int(root, te_usecs, (int)ssw->ssw_end.tv_usec);
+}
+
+/**
+ * Transmit a sensor stream window to the observers of the sensor type,
+ * as a single CBOR map with the aggregates as arrays of fixed point values
+ * and the compressed readings as a byte string.
+ */
+void
+sensor_oic_stream_tx(struct sensor_stream *ss,
+                     const struct sensor_stream_window *ssw, void *arg)
+{
+    oc_request_t request = {};
+    oc_response_t response = {};
+    oc_response_buffer_t response_buffer;
+    struct sensor_type_traits *stt;
+    struct sensor *sensor;
+    struct os_mbuf *m;
+
+    sensor = arg;
+
+    stt = sensor_get_type_traits_bytype(ssw->ssw_type, sensor);
+    if (!stt || !stt->stt_oic_res || !stt->stt_oic_res->num_observers) {
+        return;
+    }
+
+    m = os_msys_get_pkthdr(0, 0);
+    if (!m) {
+        return;
+    }
+
+    memset(&response_buffer, 0, sizeof(response_buffer));
+    response_buffer.buffer = m;
+    response_buffer.block_offset = NULL;
+    response.response_buffer = &response_buffer;
+    request.resource = stt->stt_oic_res;
+    request.response = &response;
+    oc_rep_new(m);
+    oc_rep_start_root_object();
+    sensor_oic_stream_encode(ssw);
+    oc_rep_end_root_object();
+    oc_send_response(&request, OC_STATUS_OK);
+    coap_notify_observers(stt->stt_oic_res, &response_buffer, NULL);
+    os_mbuf_free_chain(m);
+}
+
 static int
 sensor_oic_add_resource(struct sensor *sensor, sensor_type_t type)
 {
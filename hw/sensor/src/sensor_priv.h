@@ -21,9 +21,21 @@
 #define __SENSOR_PRIV_H__
 
 #include "os/mynewt.h"
+#include "sensor/sensor.h"
 
 #if MYNEWT_VAL(SENSOR_CLI)
 int sensor_shell_register(void);
 #endif
 
+/**
+ * Extract the values of a fixed point reading, axis after axis.  Invalid
+ * values are taken from "prev", or read as 0 if it is NULL.  With no
+ * reading, only returns the number of values and their fractional bits.
+ *
+ * @return The number of values, 0 if the type has no fixed point
+ *         representation.
+ */
+int sensor_fixed_values(sensor_type_t type, const void *data,
+                        const int32_t *prev, int32_t *v, uint8_t *shift);
+
 #endif /* __SENSOR_PRIV_H__ */
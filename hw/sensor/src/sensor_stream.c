@@ -0,0 +1,316 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include <limits.h>
+#include "os/mynewt.h"
+#include "sensor/sensor.h"
+#include "sensor/stream.h"
+#include "sensor_priv.h"
+
+/* Longest varint of a 32 bit value */
+#define SENSOR_STREAM_VARINT_MAX    (5)
+
+static uint32_t
+sensor_stream_isqrt(uint64_t x)
+{
+    uint64_t res;
+    uint64_t bit;
+
+    res = 0;
+    bit = 1ULL << 62;
+    while (bit > x) {
+        bit >>= 2;
+    }
+
+    while (bit != 0) {
+        if (x >= res + bit) {
+            x -= res + bit;
+            res = (res >> 1) + bit;
+        } else {
+            res >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return res;
+}
+
+static int
+sensor_stream_put_varint(uint8_t *buf, uint32_t val)
+{
+    int len;
+
+    len = 0;
+    while (val >= 0x80) {
+        buf[len++] = (val & 0x7f) | 0x80;
+        val >>= 7;
+    }
+    buf[len++] = val;
+
+    return len;
+}
+
+static void
+sensor_stream_reset(struct sensor_stream *ss)
+{
+    struct sensor_stream_window *ssw;
+    int i;
+
+    ssw = &ss->ss_cur;
+
+    ssw->ssw_count = 0;
+    ssw->ssw_blk_len = 0;
+
+    for (i = 0; i < SENSOR_STREAM_AXES_MAX; i++) {
+        ssw->ssw_min[i] = INT32_MAX;
+        ssw->ssw_max[i] = INT32_MIN;
+        ssw->ssw_mean[i] = 0;
+        ssw->ssw_rms[i] = 0;
+        ss->ss_sum[i] = 0;
+        ss->ss_sumsq[i] = 0;
+        ss->ss_prev[i] = 0;
+    }
+}
+
+static void
+sensor_stream_end(struct sensor_stream *ss)
+{
+    struct sensor_stream_window *ssw;
+    uint64_t meansq;
+    int i;
+
+    ssw = &ss->ss_cur;
+
+    for (i = 0; i < ssw->ssw_axes; i++) {
+        ssw->ssw_mean[i] = ss->ss_sum[i] / ssw->ssw_count;
+        meansq = ss->ss_sumsq[i] / ssw->ssw_count;
+        ssw->ssw_rms[i] = sensor_stream_isqrt(meansq << ssw->ssw_shift);
+    }
+
+    ssw->ssw_blk = ss->ss_buf;
+
+    ss->ss_readings += ssw->ssw_count;
+    ss->ss_raw_bytes += ssw->ssw_count * ssw->ssw_axes * sizeof(int32_t);
+    ss->ss_blk_bytes += ssw->ssw_blk_len;
+
+    if (ss->ss_func != NULL) {
+        ss->ss_func(ss, ssw, ss->ss_arg);
+    }
+
+    sensor_stream_reset(ss);
+}
+
+int
+sensor_stream_add(struct sensor_stream *ss, const void *data,
+                  const struct os_timeval *ts)
+{
+    struct sensor_stream_window *ssw;
+    int32_t v[SENSOR_STREAM_AXES_MAX];
+    uint8_t shift;
+    int32_t q;
+    int i;
+
+    ssw = &ss->ss_cur;
+
+    if (ss->ss_buf != NULL &&
+        ss->ss_buf_size - ssw->ssw_blk_len <
+        ssw->ssw_axes * SENSOR_STREAM_VARINT_MAX) {
+        sensor_stream_end(ss);
+    }
+
+    /* The previous values are kept in full resolution for the validity
+     * fallback; the deltas are taken between the quantized values.
+     */
+    sensor_fixed_values(ssw->ssw_type, data, ss->ss_prev, v, &shift);
+
+    if (ts != NULL) {
+        if (ssw->ssw_count == 0) {
+            ssw->ssw_start = *ts;
+        }
+        ssw->ssw_end = *ts;
+    }
+
+    for (i = 0; i < ssw->ssw_axes; i++) {
+        if (v[i] < ssw->ssw_min[i]) {
+            ssw->ssw_min[i] = v[i];
+        }
+        if (v[i] > ssw->ssw_max[i]) {
+            ssw->ssw_max[i] = v[i];
+        }
+        ss->ss_sum[i] += v[i];
+        ss->ss_sumsq[i] += ((int64_t)v[i] * v[i]) >> ssw->ssw_shift;
+
+        if (ss->ss_buf != NULL) {
+            q = (v[i] >> ssw->ssw_qshift) - (ss->ss_prev[i] >> ssw->ssw_qshift);
+            ssw->ssw_blk_len += sensor_stream_put_varint(
+                    &ss->ss_buf[ssw->ssw_blk_len],
+                    ((uint32_t)q << 1) ^ (uint32_t)(q >> 31));
+        }
+        ss->ss_prev[i] = v[i];
+    }
+
+    ssw->ssw_count++;
+    if (ssw->ssw_count >= ss->ss_window) {
+        sensor_stream_end(ss);
+    }
+
+    return 0;
+}
+
+void
+sensor_stream_flush(struct sensor_stream *ss)
+{
+    if (ss->ss_cur.ssw_count > 0) {
+        sensor_stream_end(ss);
+    }
+}
+
+static int
+sensor_stream_listener_func(struct sensor *sensor, void *arg, void *data,
+                            sensor_type_t type)
+{
+    struct sensor_stream *ss;
+
+    ss = arg;
+
+    if (type != ss->ss_cur.ssw_type) {
+        return 0;
+    }
+
+    return sensor_stream_add(ss, data, &sensor->s_sts.st_ostv);
+}
+
+int
+sensor_stream_init(struct sensor_stream *ss, sensor_type_t type,
+                   uint16_t window, uint8_t *buf, uint16_t buf_size,
+                   sensor_stream_func_t func, void *arg)
+{
+    uint8_t shift;
+    int axes;
+
+    if (window == 0) {
+        return SYS_EINVAL;
+    }
+
+    axes = sensor_fixed_values(type, NULL, NULL, NULL, &shift);
+    if (axes == 0) {
+        return SYS_ENOTSUP;
+    }
+
+    if (buf != NULL && buf_size < axes * SENSOR_STREAM_VARINT_MAX) {
+        return SYS_EINVAL;
+    }
+
+    memset(ss, 0, sizeof *ss);
+
+    ss->ss_listener.sl_sensor_type = type;
+    ss->ss_listener.sl_fixed_types = type;
+    ss->ss_listener.sl_func = sensor_stream_listener_func;
+    ss->ss_listener.sl_arg = ss;
+
+    ss->ss_func = func;
+    ss->ss_arg = arg;
+    ss->ss_window = window;
+    ss->ss_buf = buf;
+    ss->ss_buf_size = buf_size;
+
+    ss->ss_cur.ssw_type = type;
+    ss->ss_cur.ssw_axes = axes;
+    ss->ss_cur.ssw_shift = shift;
+
+    sensor_stream_reset(ss);
+
+    return 0;
+}
+
+void
+sensor_stream_set_qshift(struct sensor_stream *ss, uint8_t qshift)
+{
+    sensor_stream_flush(ss);
+    ss->ss_cur.ssw_qshift = qshift < 31 ? qshift : 31;
+}
+
+int
+sensor_stream_register(struct sensor *sensor, struct sensor_stream *ss)
+{
+    return sensor_register_listener(sensor, &ss->ss_listener);
+}
+
+int
+sensor_stream_unregister(struct sensor *sensor, struct sensor_stream *ss)
+{
+    int rc;
+
+    rc = sensor_unregister_listener(sensor, &ss->ss_listener);
+    if (rc) {
+        return rc;
+    }
+
+    sensor_stream_reset(ss);
+
+    return 0;
+}
+
+int
+sensor_stream_decode(const uint8_t *blk, int len, uint8_t axes,
+                     int32_t *values, int max_values)
+{
+    int32_t prev[SENSOR_STREAM_AXES_MAX] = { 0 };
+    uint32_t val;
+    int shift;
+    int off;
+    int cnt;
+    int i;
+
+    if (axes == 0 || axes > SENSOR_STREAM_AXES_MAX) {
+        return SYS_EINVAL;
+    }
+
+    off = 0;
+    cnt = 0;
+    i = 0;
+    while (off < len) {
+        val = 0;
+        shift = 0;
+        do {
+            if (off >= len || shift > 28) {
+                return SYS_EINVAL;
+            }
+            val |= (uint32_t)(blk[off] & 0x7f) << shift;
+            shift += 7;
+        } while (blk[off++] & 0x80);
+
+        if (cnt >= max_values) {
+            return SYS_EINVAL;
+        }
+
+        prev[i] += (int32_t)((val >> 1) ^ -(val & 1));
+        values[cnt++] = prev[i];
+        if (++i == axes) {
+            i = 0;
+        }
+    }
+
+    if (i != 0) {
+        return SYS_EINVAL;
+    }
+
+    return cnt;
+}
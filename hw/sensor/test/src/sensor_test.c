@@ -23,6 +23,34 @@
 TEST_SUITE(sensor_test_suite_poll)
 {
     sensor_test_case_poll_err();
+    sensor_test_case_poll_sched();
+}
+
+TEST_SUITE(sensor_test_suite_fixed)
+{
+    sensor_test_case_fixed_conv();
+    sensor_test_case_fixed_bench();
+}
+
+TEST_SUITE(sensor_test_suite_bus)
+{
+    sensor_test_case_bus_async();
+}
+
+TEST_SUITE(sensor_test_suite_stream)
+{
+    sensor_test_case_stream();
+    sensor_test_case_stream_bench();
+}
+
+TEST_SUITE(sensor_test_suite_history)
+{
+    sensor_test_case_history();
+}
+
+TEST_SUITE(sensor_test_suite_notify)
+{
+    sensor_test_case_notify();
 }
 
 #if MYNEWT_VAL(SELFTEST)
@@ -31,6 +59,11 @@ int
 main(int argc, char **argv)
 {
     sensor_test_suite_poll();
+    sensor_test_suite_fixed();
+    sensor_test_suite_bus();
+    sensor_test_suite_stream();
+    sensor_test_suite_history();
+    sensor_test_suite_notify();
 
     return tu_any_failed;
 }
@@ -25,5 +25,23 @@
 
 TEST_SUITE_DECL(sensor_test_suite_poll);
 TEST_CASE_DECL(sensor_test_case_poll_err);
+TEST_CASE_DECL(sensor_test_case_poll_sched);
+
+TEST_SUITE_DECL(sensor_test_suite_fixed);
+TEST_CASE_DECL(sensor_test_case_fixed_conv);
+TEST_CASE_DECL(sensor_test_case_fixed_bench);
+
+TEST_SUITE_DECL(sensor_test_suite_bus);
+TEST_CASE_DECL(sensor_test_case_bus_async);
+
+TEST_SUITE_DECL(sensor_test_suite_stream);
+TEST_CASE_DECL(sensor_test_case_stream);
+TEST_CASE_DECL(sensor_test_case_stream_bench);
+
+TEST_SUITE_DECL(sensor_test_suite_history);
+TEST_CASE_DECL(sensor_test_case_history);
+
+TEST_SUITE_DECL(sensor_test_suite_notify);
+TEST_CASE_DECL(sensor_test_case_notify);
 
 #endif
@@ -0,0 +1,227 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "os/mynewt.h"
+#include "sensor/sensor.h"
+#include "sensor/bus.h"
+#include "sensor/temperature.h"
+#include "sensor_test.h"
+
+#define STCBA_NUM_SENSORS   3
+#define STCBA_REG_TEMP      0x10
+#define STCBA_LATENCY       3
+
+struct stcba_sensor {
+    struct os_dev dev;
+    struct sensor sensor;
+    struct sensor_bus_xfer xfer;
+    uint8_t reg;
+    uint8_t rbuf[2];
+    sensor_data_func_t data_func;
+    void *data_arg;
+
+    /* Test results */
+    float temp;
+    int status;
+    os_time_t done_time;
+    int num_done;
+};
+
+static struct stcba_sensor stcba_sensors[STCBA_NUM_SENSORS];
+static struct sensor_bus_sim stcba_buses[2];
+static uint8_t stcba_regs[2][32];
+
+static void
+stcba_xfer_cb(struct sensor_bus_xfer *xfer, int status)
+{
+    struct sensor_temp_data std;
+    struct stcba_sensor *ss;
+
+    ss = xfer->sbx_arg;
+
+    if (status == 0) {
+        std.std_temp = (int16_t)(ss->rbuf[0] | (ss->rbuf[1] << 8)) / 100.0f;
+        std.std_temp_is_valid = 1;
+        ss->data_func(&ss->sensor, ss->data_arg, &std,
+                      SENSOR_TYPE_AMBIENT_TEMPERATURE);
+    }
+
+    sensor_read_async_done(&ss->sensor, status);
+}
+
+static int
+stcba_sensor_read_async(struct sensor *sensor, sensor_type_t type,
+                        sensor_data_func_t data_func, void *arg)
+{
+    struct stcba_sensor *ss;
+
+    ss = (struct stcba_sensor *)SENSOR_GET_DEVICE(sensor);
+
+    ss->data_func = data_func;
+    ss->data_arg = arg;
+
+    ss->reg = STCBA_REG_TEMP;
+    ss->xfer.sbx_wbuf = &ss->reg;
+    ss->xfer.sbx_wlen = 1;
+    ss->xfer.sbx_rbuf = ss->rbuf;
+    ss->xfer.sbx_rlen = sizeof ss->rbuf;
+    ss->xfer.sbx_cb = stcba_xfer_cb;
+    ss->xfer.sbx_arg = ss;
+
+    return sensor_itf_submit(SENSOR_GET_ITF(sensor), &ss->xfer);
+}
+
+static int
+stcba_data_func(struct sensor *sensor, void *arg, void *data,
+                sensor_type_t type)
+{
+    struct stcba_sensor *ss;
+
+    ss = arg;
+    ss->temp = ((struct sensor_temp_data *)data)->std_temp;
+
+    return 0;
+}
+
+static void
+stcba_done_func(struct sensor *sensor, void *arg, int status)
+{
+    struct stcba_sensor *ss;
+
+    ss = arg;
+    ss->status = status;
+    ss->done_time = os_time_get();
+    ss->num_done++;
+}
+
+static void
+stcba_run_ticks(int ticks)
+{
+    struct os_event *ev;
+    int i;
+
+    for (i = 0; i < ticks; i++) {
+        os_time_advance(1);
+        os_callout_tick();
+
+        while ((ev = os_eventq_get_no_wait(sensor_mgr_evq_get())) != NULL) {
+            ev->ev_cb(ev);
+        }
+    }
+}
+
+TEST_CASE(sensor_test_case_bus_async)
+{
+    static struct sensor_driver driver = {
+        .sd_read_async = stcba_sensor_read_async,
+    };
+    static const char *names[STCBA_NUM_SENSORS] = { "b0", "b1", "b2" };
+    /* b0 and b2 share bus 0, b1 is alone on bus 1 */
+    static const uint8_t itf_nums[STCBA_NUM_SENSORS] = { 0, 1, 0 };
+    static const uint8_t itf_addrs[STCBA_NUM_SENSORS] = { 0x20, 0x20, 0x21 };
+    struct sensor_itf itf;
+    struct stcba_sensor *ss;
+    os_time_t start;
+    int rc;
+    int i;
+
+    sysinit();
+
+    /* 21.5 C on bus 0, -3.25 C on bus 1 */
+    memset(stcba_regs, 0, sizeof stcba_regs);
+    stcba_regs[0][STCBA_REG_TEMP] = 2150 & 0xff;
+    stcba_regs[0][STCBA_REG_TEMP + 1] = 2150 >> 8;
+    stcba_regs[1][STCBA_REG_TEMP] = (uint16_t)-325 & 0xff;
+    stcba_regs[1][STCBA_REG_TEMP + 1] = (uint16_t)-325 >> 8;
+
+    for (i = 0; i < 2; i++) {
+        rc = sensor_bus_sim_init(&stcba_buses[i], SENSOR_ITF_I2C, i,
+                                 stcba_regs[i], sizeof stcba_regs[i],
+                                 STCBA_LATENCY);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+
+    for (i = 0; i < STCBA_NUM_SENSORS; i++) {
+        ss = &stcba_sensors[i];
+        memset(ss, 0, sizeof *ss);
+        ss->dev.od_name = (char *)names[i];
+
+        rc = sensor_init(&ss->sensor, &ss->dev);
+        TEST_ASSERT_FATAL(rc == 0);
+
+        rc = sensor_set_driver(&ss->sensor, SENSOR_TYPE_AMBIENT_TEMPERATURE,
+                               &driver);
+        TEST_ASSERT_FATAL(rc == 0);
+        sensor_set_type_mask(&ss->sensor, SENSOR_TYPE_ALL);
+
+        memset(&itf, 0, sizeof itf);
+        itf.si_type = SENSOR_ITF_I2C;
+        itf.si_num = itf_nums[i];
+        itf.si_addr = itf_addrs[i];
+        sensor_set_interface(&ss->sensor, &itf);
+    }
+
+    /*** Start all reads; none of them blocks. */
+    start = os_time_get();
+    for (i = 0; i < STCBA_NUM_SENSORS; i++) {
+        ss = &stcba_sensors[i];
+        rc = sensor_read_async(&ss->sensor, SENSOR_TYPE_AMBIENT_TEMPERATURE,
+                               stcba_data_func, ss, stcba_done_func, ss);
+        TEST_ASSERT_FATAL(rc == 0);
+        TEST_ASSERT(ss->num_done == 0);
+    }
+
+    /*** A second read of a sensor in progress is refused. */
+    rc = sensor_read_async(&stcba_sensors[0].sensor,
+                           SENSOR_TYPE_AMBIENT_TEMPERATURE,
+                           stcba_data_func, &stcba_sensors[0],
+                           stcba_done_func, &stcba_sensors[0]);
+    TEST_ASSERT(rc == SYS_EBUSY);
+
+    stcba_run_ticks(3 * STCBA_LATENCY);
+
+    for (i = 0; i < STCBA_NUM_SENSORS; i++) {
+        TEST_ASSERT(stcba_sensors[i].num_done == 1);
+        TEST_ASSERT(stcba_sensors[i].status == 0);
+    }
+
+    /*** Transfers on different buses overlap, those on one bus queue. */
+    TEST_ASSERT(stcba_sensors[0].done_time - start == STCBA_LATENCY);
+    TEST_ASSERT(stcba_sensors[1].done_time - start == STCBA_LATENCY);
+    TEST_ASSERT(stcba_sensors[2].done_time - start == 2 * STCBA_LATENCY);
+    TEST_ASSERT(stcba_buses[0].sbs_xfers == 2);
+    TEST_ASSERT(stcba_buses[1].sbs_xfers == 1);
+
+    TEST_ASSERT(stcba_sensors[0].temp == 21.5f);
+    TEST_ASSERT(stcba_sensors[1].temp == -3.25f);
+    TEST_ASSERT(stcba_sensors[2].temp == 21.5f);
+
+    /*** Out of range register: the error reaches the done callback. */
+    stcba_buses[1].sbs_nregs = STCBA_REG_TEMP;
+    rc = sensor_read_async(&stcba_sensors[1].sensor,
+                           SENSOR_TYPE_AMBIENT_TEMPERATURE,
+                           stcba_data_func, &stcba_sensors[1],
+                           stcba_done_func, &stcba_sensors[1]);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    stcba_run_ticks(STCBA_LATENCY);
+    TEST_ASSERT(stcba_sensors[1].num_done == 2);
+    TEST_ASSERT(stcba_sensors[1].status == SYS_EINVAL);
+}
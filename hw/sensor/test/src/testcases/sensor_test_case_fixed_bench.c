@@ -0,0 +1,124 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include "os/mynewt.h"
+#include "sensor/sensor.h"
+#include "sensor/accel.h"
+#include "sim/sim_accel.h"
+#include "sensor_test.h"
+
+#define STCFB_NUM_READS     1000
+
+static float stcfb_float_acc;
+static int64_t stcfb_fixed_acc;
+
+/* Typical listener work: accumulate the squared magnitude. */
+static int
+stcfb_float_listener(struct sensor *sensor, void *arg, void *data,
+                     sensor_type_t type)
+{
+    struct sensor_accel_data *sad;
+
+    sad = data;
+    stcfb_float_acc += sad->sad_x * sad->sad_x + sad->sad_y * sad->sad_y +
+                       sad->sad_z * sad->sad_z;
+    return 0;
+}
+
+static int
+stcfb_fixed_listener(struct sensor *sensor, void *arg, void *data,
+                     sensor_type_t type)
+{
+    struct sensor_accel_data_fixed *sadf;
+
+    sadf = data;
+    stcfb_fixed_acc += ((int64_t)sadf->sad_x * sadf->sad_x +
+                        (int64_t)sadf->sad_y * sadf->sad_y +
+                        (int64_t)sadf->sad_z * sadf->sad_z) >>
+                       SENSOR_ACCEL_FIXED_SHIFT;
+    return 0;
+}
+
+static uint32_t
+stcfb_run(struct sim_accel *sa, int fixed)
+{
+    struct sim_accel_cfg cfg = {
+        .sac_nr_samples = 1,
+        .sac_nr_axises = 3,
+        .sac_sample_itvl = 1,
+        .sac_mask = SENSOR_TYPE_ACCELEROMETER,
+        .sac_fixed = fixed,
+    };
+    struct sensor_listener lner = {
+        .sl_sensor_type = SENSOR_TYPE_ACCELEROMETER,
+        .sl_func = fixed ? stcfb_fixed_listener : stcfb_float_listener,
+        .sl_fixed_types = fixed ? SENSOR_TYPE_ACCELEROMETER : 0,
+    };
+    uint32_t start;
+    uint32_t ticks;
+    int rc;
+    int i;
+
+    rc = sim_accel_config(sa, &cfg);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = sensor_register_listener(&sa->sa_sensor, &lner);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    start = os_cputime_get32();
+    for (i = 0; i < STCFB_NUM_READS; i++) {
+        rc = sensor_read(&sa->sa_sensor, SENSOR_TYPE_ACCELEROMETER, NULL,
+                         NULL, OS_TIMEOUT_NEVER);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+    ticks = os_cputime_get32() - start;
+
+    rc = sensor_unregister_listener(&sa->sa_sensor, &lner);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    return ticks;
+}
+
+TEST_CASE(sensor_test_case_fixed_bench)
+{
+    static struct sim_accel sa;
+    uint32_t float_ticks;
+    uint32_t fixed_ticks;
+    int rc;
+
+    sysinit();
+
+    rc = sim_accel_init(&sa.sa_dev, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    sensor_set_type_mask(&sa.sa_sensor, SENSOR_TYPE_ACCELEROMETER);
+
+    /* The simulated accelerometer reports one sample per elapsed tick. */
+    os_time_advance(1);
+
+    float_ticks = stcfb_run(&sa, 0);
+    fixed_ticks = stcfb_run(&sa, 1);
+
+    TEST_ASSERT(stcfb_float_acc == 0.0f);
+    TEST_ASSERT(stcfb_fixed_acc == 0);
+
+    printf("sensor read+listener x%d: float %lu cputicks, fixed %lu cputicks\n",
+           STCFB_NUM_READS, (unsigned long)float_ticks,
+           (unsigned long)fixed_ticks);
+}
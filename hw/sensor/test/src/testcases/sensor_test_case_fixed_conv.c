@@ -0,0 +1,188 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "sensor/sensor.h"
+#include "sensor/accel.h"
+#include "sensor/light.h"
+#include "sensor_test.h"
+
+static struct sensor_accel_data stcfc_float;
+static struct sensor_accel_data_fixed stcfc_fixed;
+static struct sensor_light_data stcfc_light;
+static int stcfc_num_float;
+static int stcfc_num_fixed;
+static int stcfc_num_light;
+
+static int
+stcfc_sensor_read(struct sensor *sensor, sensor_type_t type,
+                  sensor_data_func_t data_func, void *arg, uint32_t timeout)
+{
+    struct sensor_accel_data_fixed sadf;
+    struct sensor_light_data sld;
+    int rc;
+
+    if (type & SENSOR_TYPE_ACCELEROMETER) {
+        sadf.sad_x = SENSOR_FIXED_FROM_MILLI(1500, SENSOR_ACCEL_FIXED_SHIFT);
+        sadf.sad_y = SENSOR_FIXED_FROM_MILLI(-2250, SENSOR_ACCEL_FIXED_SHIFT);
+        sadf.sad_z = 0;
+        sadf.sad_x_is_valid = 1;
+        sadf.sad_y_is_valid = 1;
+        sadf.sad_z_is_valid = 0;
+
+        rc = data_func(sensor, arg, &sadf, SENSOR_TYPE_ACCELEROMETER);
+        if (rc != 0) {
+            return rc;
+        }
+    }
+
+    if (type & SENSOR_TYPE_LIGHT) {
+        memset(&sld, 0, sizeof sld);
+        sld.sld_lux = 1234;
+        sld.sld_lux_is_valid = 1;
+
+        rc = data_func(sensor, arg, &sld, SENSOR_TYPE_LIGHT);
+        if (rc != 0) {
+            return rc;
+        }
+    }
+
+    return 0;
+}
+
+static int
+stcfc_float_listener(struct sensor *sensor, void *arg, void *data,
+                     sensor_type_t type)
+{
+    if (type == SENSOR_TYPE_ACCELEROMETER) {
+        stcfc_float = *(struct sensor_accel_data *)data;
+        stcfc_num_float++;
+    }
+    return 0;
+}
+
+static int
+stcfc_fixed_listener(struct sensor *sensor, void *arg, void *data,
+                     sensor_type_t type)
+{
+    if (type == SENSOR_TYPE_ACCELEROMETER) {
+        stcfc_fixed = *(struct sensor_accel_data_fixed *)data;
+        stcfc_num_fixed++;
+    } else if (type == SENSOR_TYPE_LIGHT) {
+        stcfc_light = *(struct sensor_light_data *)data;
+        stcfc_num_light++;
+    }
+    return 0;
+}
+
+static int
+stcfc_read_cb(struct sensor *sensor, void *arg, void *data,
+              sensor_type_t type)
+{
+    struct sensor_accel_data *sad;
+
+    if (type == SENSOR_TYPE_ACCELEROMETER) {
+        sad = data;
+        TEST_ASSERT(sad->sad_x == 1.5f);
+        TEST_ASSERT(sad->sad_y == -2.25f);
+    }
+    return 0;
+}
+
+TEST_CASE(sensor_test_case_fixed_conv)
+{
+    static struct sensor_driver driver = {
+        .sd_read = stcfc_sensor_read,
+    };
+    struct sensor_listener float_lner = {
+        .sl_sensor_type = SENSOR_TYPE_ACCELEROMETER,
+        .sl_func = stcfc_float_listener,
+    };
+    struct sensor_listener fixed_lner = {
+        .sl_sensor_type = SENSOR_TYPE_ACCELEROMETER | SENSOR_TYPE_LIGHT,
+        .sl_func = stcfc_fixed_listener,
+        .sl_fixed_types = SENSOR_TYPE_ALL,
+    };
+    struct sensor_accel_data sad;
+    struct sensor_accel_data_fixed sadf;
+    struct sensor sn;
+    int rc;
+
+    sysinit();
+
+    /*** Round trip through the conversion helpers. */
+    sad.sad_x = 9.80665f;
+    sad.sad_y = -0.5f;
+    sad.sad_z = 0.0f;
+    sad.sad_x_is_valid = 1;
+    sad.sad_y_is_valid = 1;
+    sad.sad_z_is_valid = 0;
+
+    rc = sensor_data_to_fixed(SENSOR_TYPE_ACCELEROMETER, &sad, &sadf);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(SENSOR_FIXED_TO_MILLI(sadf.sad_x,
+                                      SENSOR_ACCEL_FIXED_SHIFT) == 9806);
+    TEST_ASSERT(sadf.sad_y == -(1 << (SENSOR_ACCEL_FIXED_SHIFT - 1)));
+    TEST_ASSERT(sadf.sad_x_is_valid && sadf.sad_y_is_valid &&
+                !sadf.sad_z_is_valid);
+
+    memset(&sad, 0, sizeof sad);
+    rc = sensor_data_from_fixed(SENSOR_TYPE_ACCELEROMETER, &sadf, &sad);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(sad.sad_y == -0.5f);
+    TEST_ASSERT(sad.sad_x > 9.8066f && sad.sad_x < 9.8067f);
+
+    rc = sensor_data_to_fixed(SENSOR_TYPE_LIGHT, &sad, &sadf);
+    TEST_ASSERT(rc == SYS_ENOTSUP);
+
+    /*** Driver reporting fixed point, one listener of each kind. */
+    rc = sensor_init(&sn, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = sensor_set_driver(&sn, SENSOR_TYPE_ACCELEROMETER | SENSOR_TYPE_LIGHT,
+                           &driver);
+    TEST_ASSERT_FATAL(rc == 0);
+    sensor_set_type_mask(&sn, SENSOR_TYPE_ALL);
+    sensor_set_fixed_types(&sn, SENSOR_TYPE_ACCELEROMETER);
+
+    rc = sensor_register_listener(&sn, &float_lner);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = sensor_register_listener(&sn, &fixed_lner);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = sensor_read(&sn, SENSOR_TYPE_ACCELEROMETER | SENSOR_TYPE_LIGHT,
+                     stcfc_read_cb, NULL, OS_TIMEOUT_NEVER);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    TEST_ASSERT(stcfc_num_float == 1);
+    TEST_ASSERT(stcfc_num_fixed == 1);
+    TEST_ASSERT(stcfc_num_light == 1);
+
+    TEST_ASSERT(stcfc_float.sad_x == 1.5f);
+    TEST_ASSERT(stcfc_float.sad_y == -2.25f);
+    TEST_ASSERT(!stcfc_float.sad_z_is_valid);
+
+    TEST_ASSERT(stcfc_fixed.sad_x ==
+                SENSOR_FIXED_FROM_MILLI(1500, SENSOR_ACCEL_FIXED_SHIFT));
+    TEST_ASSERT(stcfc_fixed.sad_y ==
+                SENSOR_FIXED_FROM_MILLI(-2250, SENSOR_ACCEL_FIXED_SHIFT));
+
+    /* No fixed representation for light; delivered as is. */
+    TEST_ASSERT(stcfc_light.sld_lux == 1234);
+}
@@ -0,0 +1,218 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "os/mynewt.h"
+#include "sensor/sensor.h"
+#include "sensor/accel.h"
+#include "sensor/temperature.h"
+#include "sensor/history.h"
+#include "fcb/fcb.h"
+#include "sensor_test.h"
+
+#define STCH_MAX_SAMPLES    8
+
+static struct sensor_history_sample stch_samples[STCH_MAX_SAMPLES];
+static int stch_num_samples;
+
+/* FCB sectors, the first two 16 kB sectors of the native flash */
+static struct flash_area stch_fcb_areas[] = {
+    [0] = {
+        .fa_device_id = 0,
+        .fa_off = 0,
+        .fa_size = 0x4000,
+    },
+    [1] = {
+        .fa_device_id = 0,
+        .fa_off = 0x4000,
+        .fa_size = 0x4000,
+    },
+};
+
+static int
+stch_collect(struct sensor_history *sh,
+             const struct sensor_history_sample *shs, void *arg)
+{
+    if (stch_num_samples >= STCH_MAX_SAMPLES) {
+        return SYS_ENOMEM;
+    }
+
+    stch_samples[stch_num_samples++] = *shs;
+
+    return 0;
+}
+
+/* Checks that the samples are contiguous and counts them */
+static int
+stch_check_seq(struct sensor_history *sh,
+               const struct sensor_history_sample *shs, void *arg)
+{
+    struct sensor_history_sample *prev;
+
+    prev = arg;
+
+    if (prev->shs_ts != 0) {
+        TEST_ASSERT(shs->shs_index == prev->shs_index + 1);
+        TEST_ASSERT(shs->shs_ts == prev->shs_ts + 10);
+        TEST_ASSERT(shs->shs_val[2] == prev->shs_val[2] + 1);
+    }
+    *prev = *shs;
+    stch_num_samples++;
+
+    return 0;
+}
+
+static void
+stch_temp(struct sensor_temp_data_fixed *stdf, int temp)
+{
+    memset(stdf, 0, sizeof *stdf);
+    stdf->std_temp = SENSOR_FIXED_FROM_INT(temp, SENSOR_TEMP_FIXED_SHIFT);
+    stdf->std_temp_is_valid = 1;
+}
+
+TEST_CASE(sensor_test_case_history)
+{
+    struct sensor_temp_data_fixed stdf;
+    struct sensor_accel_data_fixed sadf;
+    struct sensor_history_cursor cur;
+    struct sensor_history_sample last;
+    struct sensor_history sh;
+    struct os_timeval ts;
+    struct fcb fcb;
+    uint8_t buf[4 * 14];
+    uint32_t index;
+    int rc;
+    int i;
+
+    sysinit();
+
+    /*** RAM ring of four temperature samples, 500 ms apart. */
+    rc = sensor_history_init_ram(&sh, SENSOR_TYPE_AMBIENT_TEMPERATURE, buf,
+                                 sizeof buf);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    for (i = 0; i < 6; i++) {
+        ts.tv_sec = 1000 + i / 2;
+        ts.tv_usec = (i % 2) * 500000;
+        stch_temp(&stdf, 20 + i);
+        rc = sensor_history_add(&sh, &stdf, &ts);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+
+    /* The two oldest were overwritten. */
+    stch_num_samples = 0;
+    rc = sensor_history_walk(&sh, 0, 0, 0, stch_collect, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT_FATAL(stch_num_samples == 4);
+    for (i = 0; i < 4; i++) {
+        TEST_ASSERT(stch_samples[i].shs_index == i + 2);
+        TEST_ASSERT(stch_samples[i].shs_ts == 1001000 + i * 500);
+        TEST_ASSERT(stch_samples[i].shs_val[0] ==
+                    SENSOR_FIXED_FROM_INT(22 + i, SENSOR_TEMP_FIXED_SHIFT));
+    }
+
+    /*** Time range, both ends included. */
+    stch_num_samples = 0;
+    rc = sensor_history_walk(&sh, 1001500, 1002000, 0, stch_collect, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(stch_num_samples == 2);
+    TEST_ASSERT(stch_samples[0].shs_index == 3);
+    TEST_ASSERT(stch_samples[1].shs_index == 4);
+
+    /*** Resuming from an index. */
+    stch_num_samples = 0;
+    rc = sensor_history_walk(&sh, 0, 0, 5, stch_collect, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(stch_num_samples == 1);
+    TEST_ASSERT(stch_samples[0].shs_index == 5);
+
+    /*** The walk function can stop the walk. */
+    stch_num_samples = STCH_MAX_SAMPLES;
+    rc = sensor_history_walk(&sh, 0, 0, 0, stch_collect, NULL);
+    TEST_ASSERT(rc == SYS_ENOMEM);
+
+    rc = sensor_history_clear(&sh);
+    TEST_ASSERT_FATAL(rc == 0);
+    stch_num_samples = 0;
+    rc = sensor_history_walk(&sh, 0, 0, 0, stch_collect, NULL);
+    TEST_ASSERT(rc == 0 && stch_num_samples == 0);
+
+    /*** FCB: the oldest sector is dropped when the FCB fills up. */
+    for (i = 0; i < 2; i++) {
+        rc = flash_area_erase(&stch_fcb_areas[i], 0,
+                              stch_fcb_areas[i].fa_size);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+
+    memset(&fcb, 0, sizeof fcb);
+    fcb.f_magic = 0x53485354;
+    fcb.f_sector_cnt = 2;
+    fcb.f_sectors = stch_fcb_areas;
+    rc = fcb_init(&fcb);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = sensor_history_init_fcb(&sh, SENSOR_TYPE_ACCELEROMETER, &fcb);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    memset(&sadf, 0, sizeof sadf);
+    sadf.sad_x_is_valid = 1;
+    sadf.sad_y_is_valid = 1;
+    sadf.sad_z_is_valid = 1;
+    for (i = 0; i < 1500; i++) {
+        ts.tv_sec = 2000 + i / 100;
+        ts.tv_usec = (i % 100) * 10000;
+        sadf.sad_z = i;
+        rc = sensor_history_add(&sh, &sadf, &ts);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+
+    memset(&last, 0, sizeof last);
+    stch_num_samples = 0;
+    rc = sensor_history_walk(&sh, 0, 0, 0, stch_check_seq, &last);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(stch_num_samples > 0 && stch_num_samples < 1500);
+    TEST_ASSERT(last.shs_index == 1499);
+    TEST_ASSERT(last.shs_val[2] == 1499);
+
+    /*** A cursor resumes on the sample the previous walk stopped on. */
+    sensor_history_cursor_init(&cur, 0);
+    stch_num_samples = 0;
+    rc = sensor_history_walk_cursor(&sh, 0, 0, &cur, stch_collect, NULL);
+    TEST_ASSERT_FATAL(rc == SYS_ENOMEM);
+    TEST_ASSERT(cur.shc_loc.fe_area != NULL);
+    TEST_ASSERT(cur.shc_index ==
+                stch_samples[STCH_MAX_SAMPLES - 1].shs_index + 1);
+    index = cur.shc_index;
+
+    stch_num_samples = 0;
+    rc = sensor_history_walk_cursor(&sh, 0, 0, &cur, stch_collect, NULL);
+    TEST_ASSERT_FATAL(rc == SYS_ENOMEM);
+    TEST_ASSERT(stch_samples[0].shs_index == index);
+    for (i = 1; i < STCH_MAX_SAMPLES; i++) {
+        TEST_ASSERT(stch_samples[i].shs_index ==
+                    stch_samples[i - 1].shs_index + 1);
+    }
+
+    /*** After a restart, the sequence continues where it stopped. */
+    rc = fcb_init(&fcb);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = sensor_history_init_fcb(&sh, SENSOR_TYPE_ACCELEROMETER, &fcb);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(sh.sh_next_index == 1500);
+}
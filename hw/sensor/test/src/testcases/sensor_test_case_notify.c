@@ -0,0 +1,171 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "sensor/sensor.h"
+#include "sensor_test.h"
+
+struct stcn_rec {
+    int calls;
+    sensor_event_type_t events;
+};
+
+static struct stcn_rec stcn_isr_rec;
+static struct stcn_rec stcn_tap_rec;
+static struct stcn_rec stcn_fall_rec;
+
+static int
+stcn_notifier(struct sensor *sensor, void *arg, sensor_event_type_t event)
+{
+    struct stcn_rec *rec;
+
+    rec = arg;
+    rec->calls++;
+    rec->events |= event;
+
+    return 0;
+}
+
+static int
+stcn_read(struct sensor *sensor, sensor_type_t type,
+          sensor_data_func_t data_func, void *arg, uint32_t timeout)
+{
+    return 0;
+}
+
+static int
+stcn_set_notification(struct sensor *sensor, sensor_event_type_t event)
+{
+    return 0;
+}
+
+static int
+stcn_unset_notification(struct sensor *sensor, sensor_event_type_t event)
+{
+    return 0;
+}
+
+static int
+stcn_run_evq(void)
+{
+    struct os_event *ev;
+    int num;
+
+    num = 0;
+    while ((ev = os_eventq_get_no_wait(sensor_mgr_evq_get())) != NULL) {
+        ev->ev_cb(ev);
+        num++;
+    }
+
+    return num;
+}
+
+TEST_CASE(sensor_test_case_notify)
+{
+    static struct sensor_driver driver = {
+        .sd_read = stcn_read,
+        .sd_set_notification = stcn_set_notification,
+        .sd_unset_notification = stcn_unset_notification,
+    };
+    static struct sensor_notifier isr_notifier = {
+        .sn_sensor_event_type = SENSOR_EVENT_TYPE_SINGLE_TAP |
+                                SENSOR_EVENT_TYPE_DOUBLE_TAP,
+        .sn_func = stcn_notifier,
+        .sn_arg = &stcn_isr_rec,
+        .sn_flags = SENSOR_NOTIFIER_F_ISR,
+    };
+    static struct sensor_notifier tap_notifier = {
+        .sn_sensor_event_type = SENSOR_EVENT_TYPE_SINGLE_TAP |
+                                SENSOR_EVENT_TYPE_DOUBLE_TAP,
+        .sn_func = stcn_notifier,
+        .sn_arg = &stcn_tap_rec,
+    };
+    static struct sensor_notifier fall_notifier = {
+        .sn_sensor_event_type = SENSOR_EVENT_TYPE_FREE_FALL,
+        .sn_func = stcn_notifier,
+        .sn_arg = &stcn_fall_rec,
+    };
+    static struct sensor_notify_ev_ctx ctx;
+    struct sensor_notify_stats stats;
+    struct sensor sn;
+    int rc;
+
+    sysinit();
+
+    rc = sensor_init(&sn, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = sensor_set_driver(&sn, SENSOR_TYPE_ACCELEROMETER, &driver);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = sensor_mgr_register(&sn);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = sensor_register_notifier(&sn, &isr_notifier);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = sensor_register_notifier(&sn, &tap_notifier);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = sensor_register_notifier(&sn, &fall_notifier);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    ctx.snec_sensor = &sn;
+
+    /*** Interrupt context notifier only; nothing gets queued. */
+    rc = sensor_unregister_notifier(&sn, &tap_notifier);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    sensor_mgr_put_notify_evt(&ctx, SENSOR_EVENT_TYPE_SINGLE_TAP);
+    TEST_ASSERT(stcn_isr_rec.calls == 1);
+    TEST_ASSERT(stcn_run_evq() == 0);
+
+    rc = sensor_register_notifier(&sn, &tap_notifier);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /***
+     * Burst of interrupts before the sensor manager gets to run: the ISR
+     * notifier sees every one of them, the others get a single dispatch
+     * with the merged event mask.
+     */
+    sensor_mgr_put_notify_evt(&ctx, SENSOR_EVENT_TYPE_SINGLE_TAP);
+    sensor_mgr_put_notify_evt(&ctx, SENSOR_EVENT_TYPE_DOUBLE_TAP);
+    sensor_mgr_put_notify_evt(&ctx, SENSOR_EVENT_TYPE_FREE_FALL);
+    sensor_mgr_put_notify_evt(&ctx, SENSOR_EVENT_TYPE_SINGLE_TAP);
+
+    TEST_ASSERT(stcn_isr_rec.calls == 4);
+    TEST_ASSERT(stcn_tap_rec.calls == 0);
+    TEST_ASSERT(stcn_fall_rec.calls == 0);
+
+    TEST_ASSERT(stcn_run_evq() == 1);
+    TEST_ASSERT(stcn_tap_rec.calls == 1);
+    TEST_ASSERT(stcn_tap_rec.events == (SENSOR_EVENT_TYPE_SINGLE_TAP |
+                                        SENSOR_EVENT_TYPE_DOUBLE_TAP));
+    TEST_ASSERT(stcn_fall_rec.calls == 1);
+    TEST_ASSERT(stcn_fall_rec.events == SENSOR_EVENT_TYPE_FREE_FALL);
+
+    /*** Once dispatched, the next interrupt queues the context again. */
+    sensor_mgr_put_notify_evt(&ctx, SENSOR_EVENT_TYPE_FREE_FALL);
+    TEST_ASSERT(stcn_run_evq() == 1);
+    TEST_ASSERT(stcn_fall_rec.calls == 2);
+    TEST_ASSERT(stcn_tap_rec.calls == 1);
+
+    sensor_notify_get_stats(&ctx, &stats);
+    TEST_ASSERT(stats.sns_events == 6);
+    TEST_ASSERT(stats.sns_isr_calls == 4);
+    TEST_ASSERT(stats.sns_dispatched == 2);
+    TEST_ASSERT(stats.sns_coalesced == 3);
+    TEST_ASSERT(stats.sns_lat_max <= stats.sns_lat_sum);
+}
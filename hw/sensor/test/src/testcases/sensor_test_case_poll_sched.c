@@ -0,0 +1,150 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "sensor/sensor.h"
+#include "sensor_test.h"
+
+#define STCPS_NUM_SENSORS   5
+
+struct stcps_sensor {
+    struct os_dev dev;
+    struct sensor sensor;
+    int num_reads;
+};
+
+static struct stcps_sensor stcps_sensors[STCPS_NUM_SENSORS];
+
+static int
+stcps_sensor_read(struct sensor *sensor, sensor_type_t type,
+                  sensor_data_func_t data_func, void *arg, uint32_t timeout)
+{
+    struct stcps_sensor *ss;
+
+    ss = (struct stcps_sensor *)SENSOR_GET_DEVICE(sensor);
+    ss->num_reads++;
+
+    return 0;
+}
+
+/**
+ * Advances OS time one tick at a time, running the sensor manager events.
+ */
+static void
+stcps_run_ticks(int ticks)
+{
+    struct os_event *ev;
+    int i;
+
+    for (i = 0; i < ticks; i++) {
+        os_time_advance(1);
+        os_callout_tick();
+
+        while ((ev = os_eventq_get_no_wait(sensor_mgr_evq_get())) != NULL) {
+            ev->ev_cb(ev);
+        }
+    }
+}
+
+TEST_CASE(sensor_test_case_poll_sched)
+{
+    static struct sensor_driver driver = {
+        .sd_read = stcps_sensor_read,
+    };
+    static const char *names[STCPS_NUM_SENSORS] = {
+        "s0", "s1", "s2", "s3", "s4"
+    };
+    /* s0 and s1 share a bus, s2 and s3 are each on their own bus */
+    static const uint32_t rates_ms[STCPS_NUM_SENSORS] = {
+        100, 110, 50, 200, 0
+    };
+    static const uint8_t itf_nums[STCPS_NUM_SENSORS] = { 0, 0, 1, 2, 0 };
+    struct sensor_mgr_poll_stats stats;
+    struct os_mutex bus_lock;
+    struct sensor_itf itf;
+    struct stcps_sensor *ss;
+    int rc;
+    int i;
+
+    sysinit();
+
+    os_mutex_init(&bus_lock);
+
+    for (i = 0; i < STCPS_NUM_SENSORS; i++) {
+        ss = &stcps_sensors[i];
+        memset(ss, 0, sizeof *ss);
+        ss->dev.od_name = (char *)names[i];
+
+        rc = sensor_init(&ss->sensor, &ss->dev);
+        TEST_ASSERT_FATAL(rc == 0);
+
+        rc = sensor_set_driver(&ss->sensor, SENSOR_TYPE_ACCELEROMETER,
+                               &driver);
+        TEST_ASSERT_FATAL(rc == 0);
+        sensor_set_type_mask(&ss->sensor, SENSOR_TYPE_ALL);
+
+        memset(&itf, 0, sizeof itf);
+        itf.si_type = SENSOR_ITF_I2C;
+        itf.si_num = itf_nums[i];
+        itf.si_lock = itf_nums[i] == 0 ? &bus_lock : NULL;
+        sensor_set_interface(&ss->sensor, &itf);
+
+        rc = sensor_mgr_register(&ss->sensor);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+
+    /* A window of two ticks lets s1 ride along with s0. */
+    rc = sensor_mgr_set_poll_window_ms(20);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    for (i = 0; i < STCPS_NUM_SENSORS; i++) {
+        rc = sensor_set_poll_rate_ms((char *)names[i], rates_ms[i]);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+
+    /*** The poll heap is full; s4 is refused and keeps its old rate. */
+    rc = sensor_set_poll_rate_ms("s4", 100);
+    TEST_ASSERT_FATAL(rc == SYS_ENOMEM);
+    TEST_ASSERT(stcps_sensors[4].sensor.s_poll_rate == 0);
+
+    stcps_run_ticks(OS_TICKS_PER_SEC);
+
+    TEST_ASSERT(stcps_sensors[0].num_reads == 10);
+    TEST_ASSERT(stcps_sensors[1].num_reads == 10);
+    TEST_ASSERT(stcps_sensors[2].num_reads == 20);
+    TEST_ASSERT(stcps_sensors[3].num_reads == 5);
+    TEST_ASSERT(stcps_sensors[4].num_reads == 0);
+
+    sensor_mgr_get_poll_stats(&stats);
+    TEST_ASSERT(stats.smps_polls == 45);
+    TEST_ASSERT(stats.smps_batched_polls == 10);
+    TEST_ASSERT(stats.smps_late_polls == 0);
+    TEST_ASSERT(stats.smps_jitter_max == 1);
+    TEST_ASSERT(stats.smps_jitter_sum == 10);
+
+    /*** Stop polling s2; the others keep their schedule. */
+    rc = sensor_set_poll_rate_ms("s2", 0);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    stcps_run_ticks(OS_TICKS_PER_SEC);
+
+    TEST_ASSERT(stcps_sensors[0].num_reads == 20);
+    TEST_ASSERT(stcps_sensors[2].num_reads == 20);
+    TEST_ASSERT(stcps_sensors[3].num_reads == 10);
+}
@@ -0,0 +1,192 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "os/mynewt.h"
+#include "sensor/sensor.h"
+#include "sensor/accel.h"
+#include "sensor/stream.h"
+#include "sim/sim_accel.h"
+#include "sensor_test.h"
+
+#define STCS_MAX_WINDOWS    8
+
+static struct sensor_stream_window stcs_windows[STCS_MAX_WINDOWS];
+static uint8_t stcs_blks[STCS_MAX_WINDOWS][64];
+static int stcs_num_windows;
+
+static void
+stcs_stream_func(struct sensor_stream *ss,
+                 const struct sensor_stream_window *ssw, void *arg)
+{
+    TEST_ASSERT_FATAL(stcs_num_windows < STCS_MAX_WINDOWS);
+
+    stcs_windows[stcs_num_windows] = *ssw;
+    if (ssw->ssw_blk != NULL) {
+        TEST_ASSERT_FATAL(ssw->ssw_blk_len <= sizeof stcs_blks[0]);
+        memcpy(stcs_blks[stcs_num_windows], ssw->ssw_blk, ssw->ssw_blk_len);
+    }
+    stcs_num_windows++;
+}
+
+static void
+stcs_accel(struct sensor_accel_data_fixed *sadf, int x, int y, int z)
+{
+    memset(sadf, 0, sizeof *sadf);
+    sadf->sad_x = SENSOR_FIXED_FROM_INT(x, SENSOR_ACCEL_FIXED_SHIFT);
+    sadf->sad_y = SENSOR_FIXED_FROM_INT(y, SENSOR_ACCEL_FIXED_SHIFT);
+    sadf->sad_z = SENSOR_FIXED_FROM_INT(z, SENSOR_ACCEL_FIXED_SHIFT);
+    sadf->sad_x_is_valid = 1;
+    sadf->sad_y_is_valid = 1;
+    sadf->sad_z_is_valid = 1;
+}
+
+TEST_CASE(sensor_test_case_stream)
+{
+    static const int readings[4][3] = {
+        { 1, 2, 3 }, { 3, -2, 3 }, { -1, 0, 3 }, { 1, 0, 3 },
+    };
+    struct sensor_accel_data_fixed sadf;
+    struct sensor_stream_window *ssw;
+    struct sensor_stream ss;
+    static struct sim_accel sa;
+    struct sim_accel_cfg cfg = {
+        .sac_nr_samples = 1,
+        .sac_nr_axises = 3,
+        .sac_sample_itvl = 1,
+        .sac_mask = SENSOR_TYPE_ACCELEROMETER,
+        .sac_fixed = 1,
+    };
+    uint8_t buf[64];
+    int32_t values[12];
+    int rc;
+    int i;
+    int j;
+
+    sysinit();
+
+    /*** Types without a fixed point representation are refused. */
+    rc = sensor_stream_init(&ss, SENSOR_TYPE_LIGHT, 4, NULL, 0,
+                            stcs_stream_func, NULL);
+    TEST_ASSERT(rc == SYS_ENOTSUP);
+
+    /*** Aggregates and lossless compression of one window. */
+    stcs_num_windows = 0;
+    rc = sensor_stream_init(&ss, SENSOR_TYPE_ACCELEROMETER, 4, buf,
+                            sizeof buf, stcs_stream_func, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    for (i = 0; i < 4; i++) {
+        stcs_accel(&sadf, readings[i][0], readings[i][1], readings[i][2]);
+        rc = sensor_stream_add(&ss, &sadf, NULL);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+
+    TEST_ASSERT_FATAL(stcs_num_windows == 1);
+    ssw = &stcs_windows[0];
+    TEST_ASSERT(ssw->ssw_count == 4);
+    TEST_ASSERT(ssw->ssw_axes == 3);
+    TEST_ASSERT(ssw->ssw_shift == SENSOR_ACCEL_FIXED_SHIFT);
+    TEST_ASSERT(ssw->ssw_min[0] == SENSOR_FIXED_FROM_INT(-1, 16));
+    TEST_ASSERT(ssw->ssw_max[0] == SENSOR_FIXED_FROM_INT(3, 16));
+    TEST_ASSERT(ssw->ssw_mean[0] == SENSOR_FIXED_FROM_INT(1, 16));
+    TEST_ASSERT(ssw->ssw_mean[1] == 0);
+    TEST_ASSERT(ssw->ssw_mean[2] == SENSOR_FIXED_FROM_INT(3, 16));
+    /* sqrt(3), sqrt(2) and 3 */
+    TEST_ASSERT(ssw->ssw_rms[0] == 113511);
+    TEST_ASSERT(ssw->ssw_rms[1] == 92681);
+    TEST_ASSERT(ssw->ssw_rms[2] == SENSOR_FIXED_FROM_INT(3, 16));
+
+    rc = sensor_stream_decode(stcs_blks[0], ssw->ssw_blk_len, 3, values, 12);
+    TEST_ASSERT_FATAL(rc == 12);
+    for (i = 0; i < 4; i++) {
+        for (j = 0; j < 3; j++) {
+            TEST_ASSERT(values[i * 3 + j] ==
+                        SENSOR_FIXED_FROM_INT(readings[i][j], 16));
+        }
+    }
+
+    /* Too small an output array is an error. */
+    rc = sensor_stream_decode(stcs_blks[0], ssw->ssw_blk_len, 3, values, 11);
+    TEST_ASSERT(rc == SYS_EINVAL);
+
+    /*** Quantization drops the fraction bits from the block only. */
+    stcs_num_windows = 0;
+    sensor_stream_set_qshift(&ss, SENSOR_ACCEL_FIXED_SHIFT);
+    for (i = 0; i < 4; i++) {
+        stcs_accel(&sadf, readings[i][0], readings[i][1], readings[i][2]);
+        sensor_stream_add(&ss, &sadf, NULL);
+    }
+    TEST_ASSERT_FATAL(stcs_num_windows == 1);
+    ssw = &stcs_windows[0];
+    TEST_ASSERT(ssw->ssw_qshift == SENSOR_ACCEL_FIXED_SHIFT);
+    TEST_ASSERT(ssw->ssw_blk_len == 12);
+    TEST_ASSERT(ssw->ssw_rms[2] == SENSOR_FIXED_FROM_INT(3, 16));
+
+    rc = sensor_stream_decode(stcs_blks[0], ssw->ssw_blk_len, 3, values, 12);
+    TEST_ASSERT_FATAL(rc == 12);
+    for (i = 0; i < 12; i++) {
+        TEST_ASSERT(values[i] == readings[i / 3][i % 3]);
+    }
+
+    /*** A full block ends the window early; flush ends a partial one. */
+    stcs_num_windows = 0;
+    rc = sensor_stream_init(&ss, SENSOR_TYPE_ACCELEROMETER, 4, buf, 15,
+                            stcs_stream_func, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    for (i = 0; i < 4; i++) {
+        stcs_accel(&sadf, readings[i][0], readings[i][1], readings[i][2]);
+        sensor_stream_add(&ss, &sadf, NULL);
+    }
+    TEST_ASSERT(stcs_num_windows == 3);
+    sensor_stream_flush(&ss);
+    TEST_ASSERT(stcs_num_windows == 4);
+    for (i = 0; i < 4; i++) {
+        TEST_ASSERT(stcs_windows[i].ssw_count == 1);
+    }
+    TEST_ASSERT(ss.ss_readings == 4);
+
+    /*** Registered on a sensor, the stream is fed by sensor reads. */
+    rc = sim_accel_init(&sa.sa_dev, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = sim_accel_config(&sa, &cfg);
+    TEST_ASSERT_FATAL(rc == 0);
+    sensor_set_type_mask(&sa.sa_sensor, SENSOR_TYPE_ACCELEROMETER);
+    os_time_advance(1);
+
+    stcs_num_windows = 0;
+    rc = sensor_stream_init(&ss, SENSOR_TYPE_ACCELEROMETER, 4, NULL, 0,
+                            stcs_stream_func, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = sensor_stream_register(&sa.sa_sensor, &ss);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    for (i = 0; i < 8; i++) {
+        rc = sensor_read(&sa.sa_sensor, SENSOR_TYPE_ACCELEROMETER, NULL,
+                         NULL, OS_TIMEOUT_NEVER);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+
+    rc = sensor_stream_unregister(&sa.sa_sensor, &ss);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    TEST_ASSERT(stcs_num_windows == 2);
+    TEST_ASSERT(stcs_windows[0].ssw_count == 4);
+    TEST_ASSERT(stcs_windows[0].ssw_blk == NULL);
+}
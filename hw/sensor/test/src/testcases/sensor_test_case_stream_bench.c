@@ -0,0 +1,209 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "os/mynewt.h"
+#include "sensor/sensor.h"
+#include "sensor/accel.h"
+#include "sensor/stream.h"
+#include "sensor_test.h"
+
+#define STCSB_WINDOW        50
+
+/* Two seconds of a wrist worn accelerometer while walking, 100 Hz, in
+ * thousandths of m/s^2.
+ */
+static const int16_t stcsb_trace[][3] = {
+    { 149, -79, 9801 }, { 131, -73, 10070 }, { 182, -38, 10373 },
+    { 199, -56, 10612 }, { 227, -47, 10814 }, { 179, -104, 11105 },
+    { 224, -55, 11291 }, { 263, -82, 11514 }, { 273, -88, 11702 },
+    { 290, -48, 11892 }, { 269, -94, 11963 }, { 314, -88, 12077 },
+    { 285, -117, 12141 }, { 297, -109, 12225 }, { 288, -126, 12217 },
+    { 282, -147, 12221 }, { 317, -140, 12136 }, { 306, -145, 12058 },
+    { 370, -143, 11969 }, { 351, -225, 11826 }, { 334, -218, 11672 },
+    { 326, -233, 11440 }, { 298, -268, 11298 }, { 383, -229, 11048 },
+    { 281, -246, 10754 }, { 312, -240, 10530 }, { 338, -268, 10314 },
+    { 368, -266, 10029 }, { 334, -327, 9760 }, { 336, -280, 9508 },
+    { 287, -276, 9161 }, { 288, -274, 8906 }, { 321, -286, 8671 },
+    { 277, -283, 8467 }, { 284, -313, 8257 }, { 268, -292, 8047 },
+    { 251, -251, 7861 }, { 177, -284, 7722 }, { 188, -238, 7607 },
+    { 210, -295, 7490 }, { 177, -225, 7430 }, { 152, -239, 7435 },
+    { 140, -235, 7413 }, { 121, -218, 7441 }, { 102, -154, 7509 },
+    { 58, -201, 7584 }, { 72, -186, 7689 }, { 75, -228, 7840 },
+    { 16, -141, 7969 }, { -21, -122, 8192 }, { -43, -65, 8403 },
+    { -64, -116, 8633 }, { -71, -171, 8862 }, { -63, -122, 9111 },
+    { -84, -63, 9385 }, { -169, -86, 9694 }, { -129, -43, 9919 },
+    { -135, -102, 10130 }, { -217, -58, 10479 }, { -200, -56, 10748 },
+    { -209, -62, 10983 }, { -201, -69, 11232 }, { -271, -41, 11474 },
+    { -253, -51, 11591 }, { -253, -112, 11772 }, { -266, -105, 11872 },
+    { -329, -57, 12002 }, { -266, -122, 12135 }, { -341, -90, 12175 },
+    { -343, -81, 12244 }, { -333, -182, 12227 }, { -337, -160, 12205 },
+    { -330, -121, 12117 }, { -316, -135, 11990 }, { -352, -204, 11932 },
+    { -346, -196, 11774 }, { -357, -269, 11613 }, { -396, -204, 11373 },
+    { -364, -237, 11176 }, { -344, -216, 10958 }, { -316, -222, 10689 },
+    { -354, -247, 10473 }, { -359, -327, 10121 }, { -356, -285, 9924 },
+    { -318, -306, 9621 }, { -263, -294, 9363 }, { -273, -303, 9107 },
+    { -301, -273, 8809 }, { -291, -275, 8557 }, { -263, -278, 8392 },
+    { -279, -334, 8168 }, { -212, -305, 7961 }, { -240, -323, 7791 },
+    { -234, -268, 7673 }, { -180, -285, 7506 }, { -153, -266, 7434 },
+    { -176, -241, 7374 }, { -116, -218, 7396 }, { -109, -191, 7433 },
+    { -87, -264, 7472 }, { -46, -206, 7547 }, { -11, -229, 7611 },
+    { 20, -195, 7761 }, { 27, -161, 7919 }, { 22, -168, 8092 },
+    { 26, -112, 8275 }, { 34, -146, 8495 }, { 81, -106, 8722 },
+    { 57, -32, 8959 }, { 113, -154, 9268 }, { 128, -39, 9522 },
+    { 133, -61, 9788 }, { 178, -60, 9999 }, { 203, -19, 10298 },
+    { 170, -54, 10542 }, { 193, -84, 10833 }, { 245, -90, 11120 },
+    { 277, -38, 11256 }, { 269, -87, 11539 }, { 208, -89, 11682 },
+    { 288, -95, 11832 }, { 298, -75, 11962 }, { 303, -101, 12086 },
+    { 309, -124, 12166 }, { 316, -117, 12176 }, { 324, -121, 12211 },
+    { 300, -127, 12188 }, { 348, -156, 12172 }, { 318, -212, 12081 },
+    { 322, -159, 11967 }, { 282, -217, 11806 }, { 340, -239, 11715 },
+    { 363, -205, 11474 }, { 386, -213, 11294 }, { 362, -201, 11067 },
+    { 370, -281, 10853 }, { 358, -271, 10574 }, { 350, -250, 10343 },
+    { 392, -250, 10043 }, { 324, -223, 9771 }, { 335, -268, 9498 },
+    { 275, -292, 9240 }, { 322, -280, 8989 }, { 304, -287, 8731 },
+    { 272, -305, 8501 }, { 231, -313, 8294 }, { 207, -304, 8078 },
+    { 212, -274, 7851 }, { 212, -287, 7763 }, { 243, -261, 7587 },
+    { 159, -269, 7552 }, { 183, -231, 7410 }, { 144, -228, 7369 },
+    { 82, -258, 7364 }, { 74, -218, 7414 }, { 106, -189, 7489 },
+    { 100, -226, 7602 }, { 25, -206, 7663 }, { 32, -153, 7812 },
+    { -19, -153, 7937 }, { -16, -141, 8159 }, { -10, -118, 8353 },
+    { -64, -119, 8596 }, { -92, -103, 8772 }, { -81, -90, 9056 },
+    { -112, -93, 9323 }, { -109, -78, 9638 }, { -146, -73, 9876 },
+    { -153, -84, 10186 }, { -187, -81, 10399 }, { -197, -73, 10663 },
+    { -197, -70, 10939 }, { -234, -34, 11227 }, { -213, -123, 11386 },
+    { -248, -53, 11558 }, { -260, -41, 11807 }, { -256, -67, 11915 },
+    { -279, -115, 12012 }, { -327, -91, 12137 }, { -317, -107, 12223 },
+    { -319, -139, 12231 }, { -313, -113, 12210 }, { -290, -102, 12156 },
+    { -333, -168, 12116 }, { -361, -153, 12063 }, { -364, -166, 11898 },
+    { -349, -214, 11800 }, { -351, -203, 11618 }, { -321, -237, 11444 },
+    { -348, -216, 11250 }, { -347, -291, 10947 }, { -309, -289, 10763 },
+    { -379, -239, 10424 }, { -334, -284, 10186 }, { -353, -283, 9925 },
+    { -320, -282, 9620 }, { -315, -317, 9399 }, { -311, -259, 9127 },
+    { -292, -311, 8887 }, { -300, -309, 8607 },
+};
+
+#define STCSB_NUM_READINGS  (sizeof stcsb_trace / sizeof stcsb_trace[0])
+
+static struct sensor_accel_data_fixed stcsb_readings[STCSB_NUM_READINGS];
+static int stcsb_next;
+static int stcsb_verify;
+
+static void
+stcsb_stream_func(struct sensor_stream *ss,
+                  const struct sensor_stream_window *ssw, void *arg)
+{
+    int32_t values[STCSB_WINDOW * 3];
+    const struct sensor_accel_data_fixed *sadf;
+    int rc;
+    int i;
+
+    if (!stcsb_verify) {
+        return;
+    }
+
+    rc = sensor_stream_decode(ssw->ssw_blk, ssw->ssw_blk_len, 3, values,
+                              STCSB_WINDOW * 3);
+    TEST_ASSERT_FATAL(rc == ssw->ssw_count * 3);
+
+    for (i = 0; i < ssw->ssw_count; i++) {
+        sadf = &stcsb_readings[stcsb_next + i];
+        TEST_ASSERT(values[i * 3] == sadf->sad_x >> ssw->ssw_qshift);
+        TEST_ASSERT(values[i * 3 + 1] == sadf->sad_y >> ssw->ssw_qshift);
+        TEST_ASSERT(values[i * 3 + 2] == sadf->sad_z >> ssw->ssw_qshift);
+    }
+    stcsb_next += ssw->ssw_count;
+}
+
+static uint32_t
+stcsb_run(uint8_t qshift, int verify, uint32_t *raw, uint32_t *blk)
+{
+    static uint8_t buf[STCSB_WINDOW * 3 * 5];
+    struct sensor_stream ss;
+    uint32_t start;
+    uint32_t ticks;
+    int rc;
+    int i;
+
+    rc = sensor_stream_init(&ss, SENSOR_TYPE_ACCELEROMETER, STCSB_WINDOW,
+                            buf, sizeof buf, stcsb_stream_func, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    sensor_stream_set_qshift(&ss, qshift);
+
+    stcsb_next = 0;
+    stcsb_verify = verify;
+
+    start = os_cputime_get32();
+    for (i = 0; i < STCSB_NUM_READINGS; i++) {
+        sensor_stream_add(&ss, &stcsb_readings[i], NULL);
+    }
+    sensor_stream_flush(&ss);
+    ticks = os_cputime_get32() - start;
+
+    TEST_ASSERT(ss.ss_readings == STCSB_NUM_READINGS);
+    if (verify) {
+        TEST_ASSERT(stcsb_next == STCSB_NUM_READINGS);
+    }
+
+    *raw = ss.ss_raw_bytes;
+    *blk = ss.ss_blk_bytes;
+
+    return ticks;
+}
+
+TEST_CASE(sensor_test_case_stream_bench)
+{
+    /* Lossless, about 1 mm/s^2 and about 16 mm/s^2 resolution */
+    static const uint8_t qshifts[] = { 0, 6, 10 };
+    struct sensor_accel_data_fixed *sadf;
+    uint32_t ticks;
+    uint32_t raw;
+    uint32_t blk;
+    int i;
+
+    sysinit();
+
+    for (i = 0; i < STCSB_NUM_READINGS; i++) {
+        sadf = &stcsb_readings[i];
+        sadf->sad_x = SENSOR_FIXED_FROM_MILLI(stcsb_trace[i][0],
+                                              SENSOR_ACCEL_FIXED_SHIFT);
+        sadf->sad_y = SENSOR_FIXED_FROM_MILLI(stcsb_trace[i][1],
+                                              SENSOR_ACCEL_FIXED_SHIFT);
+        sadf->sad_z = SENSOR_FIXED_FROM_MILLI(stcsb_trace[i][2],
+                                              SENSOR_ACCEL_FIXED_SHIFT);
+        sadf->sad_x_is_valid = 1;
+        sadf->sad_y_is_valid = 1;
+        sadf->sad_z_is_valid = 1;
+    }
+
+    for (i = 0; i < sizeof qshifts; i++) {
+        stcsb_run(qshifts[i], 1, &raw, &blk);
+        TEST_ASSERT(blk < raw);
+
+        ticks = stcsb_run(qshifts[i], 0, &raw, &blk);
+
+        printf("sensor stream qshift %d: %lu -> %lu bytes (%lu.%02lu:1), "
+               "%lu cputicks for %d readings\n",
+               qshifts[i], (unsigned long)raw, (unsigned long)blk,
+               (unsigned long)(raw / blk),
+               (unsigned long)(raw * 100 / blk % 100),
+               (unsigned long)ticks, (int)STCSB_NUM_READINGS);
+    }
+}
@@ -124,6 +124,23 @@ struct os_mqueue {
  */
 #define OS_MBUF_F_MASK(__n) (1 << (__n))
 
+/**
+ * Flag number marking an mbuf whose data lives outside its own data buffer,
+ * e.g., a buffer owned by a network stack that is lent to the mbuf instead
+ * of being copied.  Such an mbuf has no leading or trailing space.  Its pool
+ * is expected to be an extended mempool whose put callback releases the
+ * referenced buffer when the mbuf is freed.
+ */
+#define OS_MBUF_F_EXT       7
+
+/**
+ * Checks whether a given mbuf references external data
+ *
+ * @param __om The mbuf to check
+ */
+#define OS_MBUF_IS_EXT(__om) \
+    (((__om)->om_flags & OS_MBUF_F_MASK(OS_MBUF_F_EXT)) != 0)
+
 /*
  * Checks whether a given mbuf is a packet header mbuf
  *
@@ -184,6 +201,10 @@ _os_mbuf_leadingspace(struct os_mbuf *om)
     uint16_t startoff;
     uint16_t leadingspace;
 
+    if (OS_MBUF_IS_EXT(om)) {
+        return 0;
+    }
+
     startoff = 0;
     if (OS_MBUF_IS_PKTHDR(om)) {
         startoff = om->om_pkthdr_len;
@@ -218,6 +239,10 @@ _os_mbuf_trailingspace(struct os_mbuf *om)
 {
     struct os_mbuf_pool *omp;
 
+    if (OS_MBUF_IS_EXT(om)) {
+        return 0;
+    }
+
     omp = om->om_omp;
 
     return (&om->om_databuf[0] + omp->omp_databuf_len) -
@@ -375,6 +400,8 @@ struct os_mbuf *os_mbuf_get_pkthdr(struct os_mbuf_pool *omp,
 
 /**
  * Duplicate a chain of mbufs.  Return the start of the duplicated chain.
+ * A chain containing mbufs with external data (OS_MBUF_F_EXT) is copied into
+ * ordinary buffers allocated from msys.
  *
  * @param omp The mbuf pool to duplicate out of
  * @param om  The mbuf chain to duplicate
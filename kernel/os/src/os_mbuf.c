@@ -487,6 +487,43 @@ os_mbuf_appendfrom(struct os_mbuf *dst, const struct os_mbuf *src,
     return 0;
 }
 
+/*
+ * Copies a chain that references external data.  Those mbufs can hold more
+ * data than a buffer from their own pool, so the copy is made from msys.
+ */
+static struct os_mbuf *
+os_mbuf_dup_ext(struct os_mbuf *om)
+{
+    struct os_mbuf *head;
+    uint16_t len;
+    int rc;
+
+    len = os_mbuf_len(om);
+    if (OS_MBUF_IS_PKTHDR(om)) {
+        head = os_msys_get_pkthdr(len, OS_MBUF_USRHDR_LEN(om));
+        if (head == NULL) {
+            goto err;
+        }
+        _os_mbuf_copypkthdr(head, om);
+        OS_MBUF_PKTLEN(head) = 0;
+    } else {
+        head = os_msys_get(len, 0);
+        if (head == NULL) {
+            goto err;
+        }
+    }
+
+    rc = os_mbuf_appendfrom(head, om, 0, len);
+    if (rc != 0) {
+        os_mbuf_free_chain(head);
+        goto err;
+    }
+
+    return (head);
+err:
+    return (NULL);
+}
+
 struct os_mbuf *
 os_mbuf_dup(struct os_mbuf *om)
 {
@@ -494,6 +531,12 @@ os_mbuf_dup(struct os_mbuf *om)
     struct os_mbuf *head;
     struct os_mbuf *copy;
 
+    for (copy = om; copy != NULL; copy = SLIST_NEXT(copy, om_next)) {
+        if (OS_MBUF_IS_EXT(copy)) {
+            return (os_mbuf_dup_ext(om));
+        }
+    }
+
     omp = om->om_omp;
 
     head = NULL;
@@ -0,0 +1,137 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "os_test_priv.h"
+
+#define OS_MBUF_TEST_EXT_BUF_SIZE \
+    (sizeof (struct os_mbuf) + sizeof (struct os_mbuf_pkthdr) + 16)
+#define OS_MBUF_TEST_EXT_BUF_COUNT  4
+
+static os_membuf_t os_mbuf_test_ext_membuf[
+    OS_MEMPOOL_SIZE(OS_MBUF_TEST_EXT_BUF_COUNT, OS_MBUF_TEST_EXT_BUF_SIZE)];
+static struct os_mempool_ext os_mbuf_test_ext_mempool;
+static struct os_mbuf_pool os_mbuf_test_ext_pool;
+static int os_mbuf_test_ext_released;
+
+static os_error_t
+os_mbuf_test_ext_put(struct os_mempool_ext *mpe, void *data, void *arg)
+{
+    struct os_mbuf *om;
+
+    om = data;
+    if (OS_MBUF_IS_EXT(om)) {
+        os_mbuf_test_ext_released++;
+    }
+    return os_memblock_put_from_cb(&mpe->mpe_mp, data);
+}
+
+TEST_CASE(os_mbuf_test_ext)
+{
+    struct os_mbuf *om;
+    struct os_mbuf *dup;
+    struct os_mbuf *cur;
+    int rc;
+
+    os_mbuf_test_setup();
+
+    rc = os_mempool_ext_init(&os_mbuf_test_ext_mempool,
+                             OS_MBUF_TEST_EXT_BUF_COUNT,
+                             OS_MBUF_TEST_EXT_BUF_SIZE,
+                             os_mbuf_test_ext_membuf, "mbuf_ext_pool");
+    TEST_ASSERT_FATAL(rc == 0);
+    os_mbuf_test_ext_mempool.mpe_put_cb = os_mbuf_test_ext_put;
+
+    rc = os_mbuf_pool_init(&os_mbuf_test_ext_pool,
+                           &os_mbuf_test_ext_mempool.mpe_mp,
+                           OS_MBUF_TEST_EXT_BUF_SIZE,
+                           OS_MBUF_TEST_EXT_BUF_COUNT);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /* Copies of external data come out of msys. */
+    os_msys_reset();
+    rc = os_msys_register(&os_mbuf_pool);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /* Lend 600 bytes of test data to a packet header mbuf. */
+    om = os_mbuf_get_pkthdr(&os_mbuf_test_ext_pool, 0);
+    TEST_ASSERT_FATAL(om != NULL);
+    om->om_flags |= OS_MBUF_F_MASK(OS_MBUF_F_EXT);
+    om->om_data = os_mbuf_test_data;
+    om->om_len = 600;
+    OS_MBUF_PKTLEN(om) = 600;
+
+    TEST_ASSERT(OS_MBUF_IS_EXT(om));
+    TEST_ASSERT(OS_MBUF_LEADINGSPACE(om) == 0);
+    TEST_ASSERT(OS_MBUF_TRAILINGSPACE(om) == 0);
+
+    /* A duplicate is an ordinary chain holding the same bytes. */
+    dup = os_mbuf_dup(om);
+    TEST_ASSERT_FATAL(dup != NULL);
+    TEST_ASSERT(OS_MBUF_IS_PKTHDR(dup));
+    TEST_ASSERT(OS_MBUF_PKTLEN(dup) == 600);
+    TEST_ASSERT(os_mbuf_cmpf(dup, 0, os_mbuf_test_data, 600) == 0);
+    for (cur = dup; cur != NULL; cur = SLIST_NEXT(cur, om_next)) {
+        TEST_ASSERT(!OS_MBUF_IS_EXT(cur));
+        TEST_ASSERT(cur->om_omp == &os_mbuf_pool);
+    }
+    os_mbuf_free_chain(dup);
+    TEST_ASSERT(os_mbuf_pool.omp_pool->mp_num_free ==
+                MBUF_TEST_POOL_BUF_COUNT);
+
+    /* Freeing the mbuf hands the external data back to the pool owner. */
+    os_mbuf_test_ext_released = 0;
+    rc = os_mbuf_free_chain(om);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(os_mbuf_test_ext_released == 1);
+    TEST_ASSERT(os_mbuf_test_ext_mempool.mpe_mp.mp_num_free ==
+                OS_MBUF_TEST_EXT_BUF_COUNT);
+
+    /* Behind an msys packet header, growing the chain draws from msys. */
+    om = os_msys_get_pkthdr(0, 0);
+    TEST_ASSERT_FATAL(om != NULL);
+    cur = os_mbuf_get(&os_mbuf_test_ext_pool, 0);
+    TEST_ASSERT_FATAL(cur != NULL);
+    cur->om_flags |= OS_MBUF_F_MASK(OS_MBUF_F_EXT);
+    cur->om_data = os_mbuf_test_data;
+    cur->om_len = 100;
+    SLIST_NEXT(om, om_next) = cur;
+    OS_MBUF_PKTLEN(om) = 100;
+
+    rc = os_mbuf_append(om, os_mbuf_test_data + 100, 100);
+    TEST_ASSERT_FATAL(rc == 0);
+    om = os_mbuf_prepend(om, 8);
+    TEST_ASSERT_FATAL(om != NULL);
+    TEST_ASSERT(OS_MBUF_PKTLEN(om) == 208);
+    TEST_ASSERT(os_mbuf_cmpf(om, 8, os_mbuf_test_data, 200) == 0);
+    TEST_ASSERT(os_mbuf_test_ext_mempool.mpe_mp.mp_num_free ==
+                OS_MBUF_TEST_EXT_BUF_COUNT - 1);
+    for (cur = om; cur != NULL; cur = SLIST_NEXT(cur, om_next)) {
+        if (!OS_MBUF_IS_EXT(cur)) {
+            TEST_ASSERT(cur->om_omp == &os_mbuf_pool);
+        }
+    }
+
+    os_mbuf_test_ext_released = 0;
+    rc = os_mbuf_free_chain(om);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(os_mbuf_test_ext_released == 1);
+    TEST_ASSERT(os_mbuf_pool.omp_pool->mp_num_free ==
+                MBUF_TEST_POOL_BUF_COUNT);
+
+    os_msys_reset();
+}
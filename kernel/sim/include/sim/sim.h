@@ -48,6 +48,36 @@ void sim_restore_sr(os_sr_t osr);
 int sim_in_critical(void);
 void sim_tick_idle(os_time_t ticks);
 
+/** The number of simulated interrupt lines. */
+#define SIM_IRQ_CNT     8
+
+typedef void sim_irq_fn(void *arg);
+
+/**
+ * Allocates a simulated interrupt line.  The handler runs on the sim thread
+ * with interrupts disabled, as an interrupt handler would on hardware, so it
+ * may only use the OS functions that are safe in interrupt context.  Must be
+ * called before the line is pended, typically at sysinit time.
+ *
+ * @param fn                    The handler to call.
+ * @param arg                   The argument to pass to the handler.
+ *
+ * @return                      The interrupt line on success;
+ *                              -1 if no lines are left.
+ */
+int sim_irq_alloc(sim_irq_fn *fn, void *arg);
+
+/**
+ * Pends a simulated interrupt.  Unlike the rest of the OS, this function may
+ * be called from any host thread, e.g., one that blocks in a system call
+ * waiting for I/O.  The handler runs once for any number of pends that
+ * occur before it gets to run.
+ *
+ * @param irq                   The interrupt line returned by
+ *                                  sim_irq_alloc().
+ */
+void sim_irq_pend(int irq);
+
 /**
  * Prints information about a crash to stdout.  This functionality is defined
  * as a macro rather than a function to ensure that it gets inlined, enforcing
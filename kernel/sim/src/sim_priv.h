@@ -33,6 +33,7 @@ void sim_switch_tasks(void);
 void sim_tick(void);
 void sim_signals_init(void);
 void sim_signals_cleanup(void);
+void sim_irq_dispatch(void);
 
 extern pid_t sim_pid;
 
@@ -45,6 +45,15 @@
 
 pid_t sim_pid;
 
+static struct {
+    sim_irq_fn *fn;
+    void *arg;
+} sim_irqs[SIM_IRQ_CNT];
+static int sim_irq_cnt;
+
+/* Bitmap of pended interrupt lines; set from any thread. */
+static volatile uint32_t sim_irq_pending;
+
 void
 sim_switch_tasks(void)
 {
@@ -121,6 +130,51 @@ sim_tick(void)
     }
 }
 
+int
+sim_irq_alloc(sim_irq_fn *fn, void *arg)
+{
+    int irq;
+
+    if (sim_irq_cnt >= SIM_IRQ_CNT) {
+        return -1;
+    }
+
+    irq = sim_irq_cnt++;
+    sim_irqs[irq].fn = fn;
+    sim_irqs[irq].arg = arg;
+
+    return irq;
+}
+
+void
+sim_irq_pend(int irq)
+{
+    __atomic_fetch_or(&sim_irq_pending, 1UL << irq, __ATOMIC_SEQ_CST);
+
+    /* Delivered to the sim thread; other threads must block SIGIO. */
+    kill(sim_pid, SIGIO);
+}
+
+/*
+ * Runs the handlers of all pended interrupts.  Called when SIGIO is
+ * delivered.
+ */
+void
+sim_irq_dispatch(void)
+{
+    uint32_t pending;
+    int irq;
+
+    OS_ASSERT_CRITICAL();
+
+    pending = __atomic_exchange_n(&sim_irq_pending, 0, __ATOMIC_SEQ_CST);
+    while (pending != 0) {
+        irq = __builtin_ctz(pending);
+        pending &= ~(1UL << irq);
+        sim_irqs[irq].fn(sim_irqs[irq].arg);
+    }
+}
+
 static void
 sim_start_timer(void)
 {
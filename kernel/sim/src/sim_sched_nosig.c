@@ -22,9 +22,10 @@
  * does not use signals to perform context switches.  This is the less correct
  * version of sim: the OS tick timer only runs while the idle task is active.
  * Therefore, a sleeping high-priority task will not preempt a low-priority
- * task due to a timing event (e.g., delay or callout expired).  However, this
- * version of sim does not suffer from the stability issues that affect the
- * "signals" implementation.
+ * task due to a timing event (e.g., delay or callout expired).  Likewise,
+ * interrupts pended with sim_irq_pend() are only handled while the idle task
+ * is active.  However, this version of sim does not suffer from the stability
+ * issues that affect the "signals" implementation.
  *
  * To use this version of sim, disable the MCU_NATIVE_USE_SIGNALS syscfg
  * setting.
@@ -51,6 +52,7 @@
 
 static sigset_t nosigs;
 static sigset_t suspsigs;   /* signals delivered in sigsuspend() */
+static sigset_t irqsigs;    /* SIGALRM and SIGIO */
 
 static int ctx_sw_pending;
 static int interrupts_enabled = 1;
@@ -113,39 +115,32 @@ sim_in_critical(void)
 }
 
 /**
- * Unblocks the SIGALRM signal that is delivered by the OS tick timer.
+ * Unblocks the signals that simulate interrupts: SIGALRM, delivered by the
+ * OS tick timer, and SIGIO, delivered by sim_irq_pend().
  */
 static void
-unblock_timer(void)
+unblock_irqs(void)
 {
-    sigset_t sigs;
     int rc;
 
-    sigemptyset(&sigs);
-    sigaddset(&sigs, SIGALRM);
-
-    rc = sigprocmask(SIG_UNBLOCK, &sigs, NULL);
+    rc = sigprocmask(SIG_UNBLOCK, &irqsigs, NULL);
     assert(rc == 0);
 }
 
 /**
- * Blocks the SIGALRM signal that is delivered by the OS tick timer.
+ * Blocks the signals that simulate interrupts.
  */
 static void
-block_timer(void)
+block_irqs(void)
 {
-    sigset_t sigs;
     int rc;
 
-    sigemptyset(&sigs);
-    sigaddset(&sigs, SIGALRM);
-
-    rc = sigprocmask(SIG_BLOCK, &sigs, NULL);
+    rc = sigprocmask(SIG_BLOCK, &irqsigs, NULL);
     assert(rc == 0);
 }
 
 static void
-sig_handler_alrm(int sig)
+sig_handler_wake(int sig)
 {
     /* Wake the idle task. */
     sigaddset(&suspsigs, sig);
@@ -172,12 +167,12 @@ sim_tick_idle(os_time_t ticks)
         assert(rc == 0);
     }
 
-    unblock_timer();
+    unblock_irqs();
 
     sigemptyset(&suspsigs);
     sigsuspend(&nosigs);        /* Wait for a signal to wake us up */
 
-    block_timer();
+    block_irqs();
 
     /*
      * Call handlers for signals delivered to the process during sigsuspend().
@@ -187,6 +182,9 @@ sim_tick_idle(os_time_t ticks)
     if (sigismember(&suspsigs, SIGALRM)) {
         sim_tick();
     }
+    if (sigismember(&suspsigs, SIGIO)) {
+        sim_irq_dispatch();
+    }
 
     if (ticks > 0) {
         /*
@@ -204,23 +202,25 @@ sim_tick_idle(os_time_t ticks)
 void
 sim_signals_init(void)
 {
-    sigset_t sigset_alrm;
     struct sigaction sa;
     int error;
 
-    block_timer();
+    sigemptyset(&irqsigs);
+    sigaddset(&irqsigs, SIGALRM);
+    sigaddset(&irqsigs, SIGIO);
 
-    sigemptyset(&nosigs);
+    block_irqs();
 
-    sigemptyset(&sigset_alrm);
-    sigaddset(&sigset_alrm, SIGALRM);
+    sigemptyset(&nosigs);
 
     memset(&sa, 0, sizeof sa);
-    sa.sa_handler = sig_handler_alrm;
-    sa.sa_mask = sigset_alrm;
+    sa.sa_handler = sig_handler_wake;
+    sa.sa_mask = irqsigs;
     sa.sa_flags = SA_RESTART;
     error = sigaction(SIGALRM, &sa, NULL);
     assert(error == 0);
+    error = sigaction(SIGIO, &sa, NULL);
+    assert(error == 0);
 }
 
 void
@@ -233,6 +233,11 @@ sim_signals_cleanup(void)
     sa.sa_handler = SIG_DFL;
     error = sigaction(SIGALRM, &sa, NULL);
     assert(error == 0);
+
+    /* Host threads may still pend interrupts; don't let SIGIO kill us. */
+    sa.sa_handler = SIG_IGN;
+    error = sigaction(SIGIO, &sa, NULL);
+    assert(error == 0);
 }
 
 #endif /* !MYNEWT_VAL(MCU_NATIVE_USE_SIGNALS) */
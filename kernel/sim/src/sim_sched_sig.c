@@ -152,11 +152,25 @@ timer_handler(int sig)
     }
 }
 
+static void
+irq_handler(int sig)
+{
+    OS_ASSERT_CRITICAL();
+
+    if (suspended) {
+        sigaddset(&suspsigs, sig);
+    } else {
+        sim_irq_dispatch();
+    }
+}
+
+/* Simulated interrupts are handled before a pending context switch. */
 static struct {
     int num;
     void (*handler)(int sig);
 } signals[] = {
     { SIGALRM, timer_handler },
+    { SIGIO, irq_handler },
     { SIGURG, ctxsw_handler },
 };
 
@@ -255,7 +269,12 @@ sim_signals_cleanup(void)
 
     for (i = 0; i < NUMSIGS; i++) {
         memset(&sa, 0, sizeof sa);
-        sa.sa_handler = SIG_DFL;
+        /* Host threads may still pend interrupts; don't let SIGIO kill us. */
+        if (signals[i].num == SIGIO) {
+            sa.sa_handler = SIG_IGN;
+        } else {
+            sa.sa_handler = SIG_DFL;
+        }
         error = sigaction(signals[i].num, &sa, NULL);
         assert(error == 0);
     }
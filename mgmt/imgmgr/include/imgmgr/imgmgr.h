@@ -33,6 +33,7 @@ extern "C" {
 #define IMGMGR_NMGR_ID_CORELOAD     4
 #define IMGMGR_NMGR_ID_ERASE	    5
 #define IMGMGR_NMGR_ID_ERASE_STATE  6
+#define IMGMGR_NMGR_ID_DELTA        7
 
 #define IMGMGR_NMGR_MAX_NAME		64
 #define IMGMGR_NMGR_MAX_VER         25  /* 255.255.65535.4294967295\0 */
@@ -44,6 +45,31 @@ extern "C" {
 #define IMGMGR_STATE_F_ACTIVE           0x04
 #define IMGMGR_STATE_F_PERMANENT        0x08
 
+/*
+ * Delta image format, uploaded with IMGMGR_NMGR_ID_DELTA.  A delta is a
+ * struct imgmgr_delta_hdr followed by a sequence of operations which build
+ * the new image, front to back, from the running image and literal data:
+ *
+ *     IMGMGR_DELTA_OP_INSERT <len> <len bytes of data>
+ *     IMGMGR_DELTA_OP_COPY <off> <len>      len bytes of the running image,
+ *                                           starting at off
+ *
+ * Each operation is one byte followed by its arguments, encoded as
+ * unsigned LEB128 varints.
+ */
+#define IMGMGR_DELTA_MAGIC              0x544c4544  /* "DELT" */
+
+#define IMGMGR_DELTA_OP_INSERT          0
+#define IMGMGR_DELTA_OP_COPY            1
+
+struct imgmgr_delta_hdr {
+    uint32_t idh_magic;
+    /* Size of the new image. */
+    uint32_t idh_img_size;
+    /* SHA256 TLV of the image the delta applies to. */
+    uint8_t idh_base_hash[IMGMGR_HASH_LEN];
+};
+
 /** @typedef imgr_upload_fn
  * @brief Application callback that is executed when an image upload request is
  * received.
@@ -31,6 +31,9 @@
 #if MYNEWT_VAL(LOG_FCB_SLOT1)
 #include "log/log_fcb_slot1.h"
 #endif
+#if MYNEWT_VAL(IMGMGR_VERIFY_UPLOAD)
+#include "crypto/crypto.h"
+#endif
 
 #include "imgmgr/imgmgr.h"
 #include "imgmgr_priv.h"
@@ -43,6 +46,7 @@ static int imgr_erase_state(struct mgmt_cbuf *);
 struct imgr_upload_req {
     unsigned long long int off;     /* -1 if unspecified */
     unsigned long long int size;    /* -1 if unspecified */
+    unsigned long long int win;     /* 0 if unspecified */
     size_t data_len;
     size_t data_sha_len;
     uint8_t img_data[MYNEWT_VAL(IMGMGR_MAX_CHUNK_SIZE)];
@@ -102,6 +106,15 @@ static const struct mgmt_handler imgr_nmgr_handlers[] = {
             .mh_read = NULL,
             .mh_write = imgr_erase_state,
     },
+    [IMGMGR_NMGR_ID_DELTA] = {
+#if MYNEWT_VAL(IMGMGR_DELTA)
+        .mh_read = NULL,
+        .mh_write = imgr_delta_upload,
+#else
+        .mh_read = NULL,
+        .mh_write = NULL
+#endif
+    },
 };
 
 #define IMGR_HANDLER_CNT                                                \
@@ -127,8 +140,72 @@ static struct {
     /** Hash of image data; used for resumption of a partial upload. */
     uint8_t data_sha_len;
     uint8_t data_sha[IMGMGR_DATA_SHA_LEN];
+
+    /** The area is erased up to this offset. */
+    uint32_t erased_off;
+
+    /** Index of the last erased flash sector; -1 if none. */
+    int erase_sec;
+
+    /**
+     * Windowed upload: up to `win` chunks of `chunk_sz` bytes, starting at
+     * `off`, are accepted in any order.  Bit n of rx_map is set if the
+     * chunk at off + n * chunk_sz has been written.  A window of 1 is the
+     * original stop-and-wait protocol.
+     */
+    uint8_t win;
+    uint32_t chunk_sz;
+    uint32_t rx_map;
+
+#if MYNEWT_VAL(IMGMGR_VERIFY_UPLOAD)
+    /** Number of bytes covered by the image hash, 0 if not verified. */
+    uint32_t hash_len;
+
+    /** Hash of the image bytes written so far. */
+    struct crypto_sha256_ctx sha_ctx;
+#endif
 } imgr_state;
 
+#if MYNEWT_VAL(IMGMGR_ERASE_AHEAD)
+static void imgr_erase_ahead_ev_cb(struct os_event *ev);
+
+static struct os_event imgr_erase_ahead_ev = {
+    .ev_cb = imgr_erase_ahead_ev_cb,
+};
+
+/* Erase-ahead runs in its own task, so the erase overlaps the transfer of
+ * the next request instead of delaying its processing.  The lock guards
+ * imgr_state between that task and the newtmgr task.
+ */
+static struct os_task imgr_erase_task;
+static os_stack_t imgr_erase_stack[
+    OS_STACK_ALIGN(MYNEWT_VAL(IMGMGR_ERASE_TASK_STACK_SIZE))];
+static struct os_eventq imgr_erase_evq;
+static struct os_mutex imgr_erase_mtx;
+#endif
+
+void
+imgr_state_lock(void)
+{
+#if MYNEWT_VAL(IMGMGR_ERASE_AHEAD)
+    os_mutex_pend(&imgr_erase_mtx, OS_TIMEOUT_NEVER);
+#endif
+}
+
+void
+imgr_state_unlock(void)
+{
+#if MYNEWT_VAL(IMGMGR_ERASE_AHEAD)
+    os_mutex_release(&imgr_erase_mtx);
+#endif
+}
+
+bool
+imgr_upload_in_progress(void)
+{
+    return imgr_state.area_id != -1;
+}
+
 static imgr_upload_fn *imgr_upload_cb;
 static void *imgr_upload_arg;
 
@@ -140,6 +217,9 @@ static const char *imgmgr_err_str_no_slot = "no slot";
 static const char *imgmgr_err_str_flash_open_failed = "fa open fail";
 static const char *imgmgr_err_str_flash_erase_failed = "fa erase fail";
 static const char *imgmgr_err_str_flash_write_failed = "fa write fail";
+static const char *imgmgr_err_str_hash_mismatch = "hash mismatch";
+static const char *imgmgr_err_str_flash_read_failed = "fa read fail";
+static const char *imgmgr_err_str_busy = "delta upload in progress";
 #else
 #define imgmgr_err_str_app_reject                   NULL
 #define imgmgr_err_str_hdr_malformed                NULL
@@ -148,6 +228,9 @@ static const char *imgmgr_err_str_flash_write_failed = "fa write fail";
 #define imgmgr_err_str_flash_open_failed            NULL
 #define imgmgr_err_str_flash_erase_failed           NULL
 #define imgmgr_err_str_flash_write_failed           NULL
+#define imgmgr_err_str_hash_mismatch                NULL
+#define imgmgr_err_str_flash_read_failed            NULL
+#define imgmgr_err_str_busy                         NULL
 #endif
 
 #if MYNEWT_VAL(BOOTUTIL_IMAGE_FORMAT_V2)
@@ -376,7 +459,7 @@ imgmgr_find_best_area_id(void)
 }
 
 #if MYNEWT_VAL(IMGMGR_VERBOSE_ERR)
-static int
+int
 imgr_error_rsp(struct mgmt_cbuf *cb, int rc, const char *rsn)
 {
     /*
@@ -389,8 +472,6 @@ imgr_error_rsp(struct mgmt_cbuf *cb, int rc, const char *rsn)
 
     return rc;
 }
-#else
-#define imgr_error_rsp(cb, rc, rsn)         (rc)
 #endif
 
 static int
@@ -418,7 +499,9 @@ imgr_erase(struct mgmt_cbuf *cb)
             return imgr_error_rsp(cb, MGMT_ERR_EINVAL,
                                   imgmgr_err_str_flash_open_failed);
         }
+        imgr_state_lock();
         rc = flash_area_erase(fa, 0, fa->fa_size);
+        imgr_state_unlock();
         flash_area_close(fa);
         if (rc) {
             return imgr_error_rsp(cb, MGMT_ERR_EINVAL,
@@ -484,6 +567,34 @@ imgr_erase_state(struct mgmt_cbuf *cb)
     return 0;
 }
 
+/**
+ * Indicates whether a windowed upload accepts a chunk other than the one at
+ * the current offset.
+ */
+static bool
+imgr_win_accepts(const struct imgr_upload_req *req)
+{
+    uint32_t delta;
+    uint32_t idx;
+
+    if (imgr_state.win <= 1 || req->off <= imgr_state.off) {
+        return false;
+    }
+
+    delta = req->off - imgr_state.off;
+    if (delta % imgr_state.chunk_sz != 0) {
+        return false;
+    }
+
+    idx = delta / imgr_state.chunk_sz;
+    if (idx >= imgr_state.win || (imgr_state.rx_map & (1UL << idx))) {
+        /* Out of window, or a duplicate. */
+        return false;
+    }
+
+    return true;
+}
+
 /**
  * Verifies an upload request and indicates the actions that should be taken
  * during processing of the request.  This is a "read only" function in the
@@ -578,7 +689,7 @@ imgr_upload_inspect(const struct imgr_upload_req *req,
         action->area_id = imgr_state.area_id;
         action->size = imgr_state.size;
 
-        if (req->off != imgr_state.off) {
+        if (req->off != imgr_state.off && !imgr_win_accepts(req)) {
             /*
              * Invalid offset. Drop the data, and respond with the offset we're
              * expecting data for.
@@ -607,10 +718,180 @@ imgr_upload_inspect(const struct imgr_upload_req *req,
         }
     }
 
+    if (req->off != 0 && imgr_state.win > 1 &&
+        action->write_bytes != imgr_state.chunk_sz &&
+        req->off + action->write_bytes != action->size) {
+
+        /* Windowed uploads use a fixed chunk size. */
+        return 0;
+    }
+
     action->proceed = true;
     return 0;
 }
 
+/**
+ * Erases the sectors of the upload area, in order, until the area is erased
+ * up to at least the specified offset.
+ */
+static int
+imgr_erase_to(const struct flash_area *fa, uint32_t end)
+{
+    struct flash_area sector;
+    int sec;
+    int rc;
+
+    while (imgr_state.erased_off < end) {
+        sec = imgr_state.erase_sec;
+        rc = flash_area_getnext_sector(imgr_state.area_id, &sec, &sector);
+        if (rc != 0) {
+            return rc;
+        }
+
+        rc = flash_area_erase(fa, sector.fa_off - fa->fa_off, sector.fa_size);
+        if (rc != 0) {
+            return rc;
+        }
+
+        imgr_state.erase_sec = sec;
+        imgr_state.erased_off = sector.fa_off - fa->fa_off + sector.fa_size;
+    }
+
+    return 0;
+}
+
+#if MYNEWT_VAL(IMGMGR_ERASE_AHEAD)
+/**
+ * Erases the sector the next upload chunk goes to.  Runs in the erase-ahead
+ * task between two upload requests, while the client sends the next one.
+ */
+static void
+imgr_erase_ahead_ev_cb(struct os_event *ev)
+{
+    const struct flash_area *fa;
+
+    os_mutex_pend(&imgr_erase_mtx, OS_TIMEOUT_NEVER);
+
+    if (imgr_state.area_id == -1 ||
+        imgr_state.erased_off > imgr_state.off ||
+        imgr_state.off >= imgr_state.size) {
+
+        goto done;
+    }
+
+    if (flash_area_open(imgr_state.area_id, &fa) != 0) {
+        goto done;
+    }
+
+    /* A failure is reported when the next chunk tries again. */
+    (void)imgr_erase_to(fa, imgr_state.off + 1);
+
+    flash_area_close(fa);
+
+done:
+    os_mutex_release(&imgr_erase_mtx);
+}
+
+static void
+imgr_erase_task_handler(void *arg)
+{
+    while (1) {
+        os_eventq_run(&imgr_erase_evq);
+    }
+}
+#endif
+
+#if MYNEWT_VAL(IMGMGR_VERIFY_UPLOAD)
+/**
+ * Feeds the part of a written chunk covered by the image hash to the
+ * running hash.
+ */
+static void
+imgr_hash_update(uint32_t off, const uint8_t *data, int len)
+{
+    if (off >= imgr_state.hash_len) {
+        return;
+    }
+    if (off + len > imgr_state.hash_len) {
+        len = imgr_state.hash_len - off;
+    }
+    crypto_sha256_update(&imgr_state.sha_ctx, data, len);
+}
+
+/**
+ * Compares the hash of the uploaded data against the SHA256 TLV of the
+ * image.
+ *
+ * @return                      0 if the image is intact; nonzero otherwise.
+ */
+static int
+imgr_hash_check(void)
+{
+    uint8_t tlv_hash[IMGMGR_HASH_LEN];
+    uint8_t hash[IMGMGR_HASH_LEN];
+    int rc;
+
+    if (imgr_state.hash_len == 0) {
+        return 0;
+    }
+
+    crypto_sha256_finish(&imgr_state.sha_ctx, hash);
+
+    rc = imgr_read_info(flash_area_id_to_image_slot(imgr_state.area_id),
+                        NULL, tlv_hash, NULL);
+    if (rc != 0) {
+        return -1;
+    }
+
+    return memcmp(hash, tlv_hash, sizeof hash);
+}
+#endif
+
+/**
+ * Moves the upload offset over the chunks written ahead of it that are now
+ * contiguous, feeding them to the running hash from flash.
+ */
+static int
+imgr_win_advance(const struct flash_area *fa)
+{
+    uint32_t chunk_len;
+#if MYNEWT_VAL(IMGMGR_VERIFY_UPLOAD)
+    uint8_t buf[64];
+    uint32_t off;
+    int len;
+    int rc;
+#endif
+
+    while (imgr_state.rx_map & 1) {
+        chunk_len = imgr_state.size - imgr_state.off;
+        if (chunk_len > imgr_state.chunk_sz) {
+            chunk_len = imgr_state.chunk_sz;
+        }
+
+#if MYNEWT_VAL(IMGMGR_VERIFY_UPLOAD)
+        for (off = imgr_state.off;
+             off < imgr_state.off + chunk_len && off < imgr_state.hash_len;
+             off += len) {
+
+            len = imgr_state.off + chunk_len - off;
+            if (len > sizeof buf) {
+                len = sizeof buf;
+            }
+            rc = flash_area_read(fa, off, buf, len);
+            if (rc != 0) {
+                return rc;
+            }
+            imgr_hash_update(off, buf, len);
+        }
+#endif
+
+        imgr_state.off += chunk_len;
+        imgr_state.rx_map >>= 1;
+    }
+
+    return 0;
+}
+
 static int
 imgr_upload_good_rsp(struct mgmt_cbuf *cb)
 {
@@ -620,6 +901,13 @@ imgr_upload_good_rsp(struct mgmt_cbuf *cb)
     err |= cbor_encode_int(&cb->encoder, MGMT_ERR_EOK);
     err |= cbor_encode_text_stringz(&cb->encoder, "off");
     err |= cbor_encode_int(&cb->encoder, imgr_state.off);
+    if (imgr_state.win > 1) {
+        /* Windowed upload; the window and the chunks received past `off`. */
+        err |= cbor_encode_text_stringz(&cb->encoder, "win");
+        err |= cbor_encode_uint(&cb->encoder, imgr_state.win);
+        err |= cbor_encode_text_stringz(&cb->encoder, "bmp");
+        err |= cbor_encode_uint(&cb->encoder, imgr_state.rx_map);
+    }
 
     if (err != 0) {
         return MGMT_ERR_ENOMEM;
@@ -629,15 +917,16 @@ imgr_upload_good_rsp(struct mgmt_cbuf *cb)
 }
 
 static int
-imgr_upload(struct mgmt_cbuf *cb)
+imgr_upload_locked(struct mgmt_cbuf *cb)
 {
     struct imgr_upload_req req = {
         .off = -1,
         .size = -1,
+        .win = 0,
         .data_len = 0,
         .data_sha_len = 0,
     };
-    const struct cbor_attr_t off_attr[5] = {
+    const struct cbor_attr_t off_attr[6] = {
         [0] = {
             .attribute = "data",
             .type = CborAttrByteStringType,
@@ -664,18 +953,34 @@ imgr_upload(struct mgmt_cbuf *cb)
             .addr.bytestring.len = &req.data_sha_len,
             .len = sizeof(req.data_sha)
         },
-        [4] = { 0 },
+        [4] = {
+            .attribute = "win",
+            .type = CborAttrUnsignedIntegerType,
+            .addr.uinteger = &req.win,
+            .nodefault = true
+        },
+        [5] = { 0 },
     };
     int rc;
     const char *errstr = NULL;
     struct imgr_upload_action action;
     const struct flash_area *fa = NULL;
+#if MYNEWT_VAL(IMGMGR_VERIFY_UPLOAD)
+    const struct image_header *hdr;
+#endif
 
     rc = cbor_read_object(&cb->it, off_attr);
     if (rc != 0) {
         return MGMT_ERR_EINVAL;
     }
 
+#if MYNEWT_VAL(IMGMGR_DELTA)
+    /* A delta upload is writing the same slot. */
+    if (imgr_delta_in_progress()) {
+        return imgr_error_rsp(cb, MGMT_ERR_EBADSTATE, imgmgr_err_str_busy);
+    }
+#endif
+
     /* Determine what actions to take as a result of this request. */
     rc = imgr_upload_inspect(&req, &action, &errstr);
     if (rc != 0) {
@@ -725,6 +1030,21 @@ imgr_upload(struct mgmt_cbuf *cb)
         memset(&imgr_state.data_sha[req.data_sha_len], 0,
                IMGMGR_DATA_SHA_LEN - req.data_sha_len);
 
+#if MYNEWT_VAL(IMGMGR_VERIFY_UPLOAD)
+        /* The hash of a split app is seeded with its loader's hash, which
+         * need not be the running image's; such images are not verified.
+         */
+        hdr = (struct image_header *)req.img_data;
+        if ((hdr->ih_flags & IMAGE_F_SHA256) &&
+            !(hdr->ih_flags & IMAGE_F_NON_BOOTABLE)) {
+
+            imgr_state.hash_len = hdr->ih_hdr_size + hdr->ih_img_size;
+        } else {
+            imgr_state.hash_len = 0;
+        }
+        crypto_sha256_start(&imgr_state.sha_ctx);
+#endif
+
 #if MYNEWT_VAL(LOG_FCB_SLOT1)
         /*
          * If logging to slot1 is enabled, make sure it's locked before
@@ -735,12 +1055,34 @@ imgr_upload(struct mgmt_cbuf *cb)
         }
 #endif
 
+        /* The area is erased a sector at a time, just ahead of the data,
+         * rather than all at once here; erasing a whole slot blocks the
+         * newtmgr task for seconds.
+         */
+        imgr_state.erase_sec = -1;
         if (action.erase) {
-            rc = flash_area_erase(fa, 0, req.size);
-            if (rc != 0) {
-                rc = MGMT_ERR_EUNKNOWN;
-                errstr = imgmgr_err_str_flash_erase_failed;
-            }
+            imgr_state.erased_off = 0;
+        } else {
+            imgr_state.erased_off = fa->fa_size;
+        }
+
+        /* Agree on a window; the chunk size is set by this first chunk. */
+        imgr_state.win = req.win;
+        if (imgr_state.win > MYNEWT_VAL(IMGMGR_UPLOAD_WINDOW)) {
+            imgr_state.win = MYNEWT_VAL(IMGMGR_UPLOAD_WINDOW);
+        }
+        if (imgr_state.win == 0 || action.write_bytes == 0) {
+            imgr_state.win = 1;
+        }
+        imgr_state.chunk_sz = action.write_bytes;
+        imgr_state.rx_map = 0;
+    }
+
+    if (rc == 0 && action.write_bytes != 0) {
+        rc = imgr_erase_to(fa, req.off + action.write_bytes);
+        if (rc != 0) {
+            rc = MGMT_ERR_EUNKNOWN;
+            errstr = imgmgr_err_str_flash_erase_failed;
         }
     }
 
@@ -750,12 +1092,37 @@ imgr_upload(struct mgmt_cbuf *cb)
         if (rc != 0) {
             rc = MGMT_ERR_EUNKNOWN;
             errstr = imgmgr_err_str_flash_write_failed;
+        } else if (req.off != imgr_state.off) {
+            /* Ahead of the offset; remember it in the window. */
+            imgr_state.rx_map |=
+                1UL << ((req.off - imgr_state.off) / imgr_state.chunk_sz);
         } else {
+#if MYNEWT_VAL(IMGMGR_VERIFY_UPLOAD)
+            imgr_hash_update(req.off, req.img_data, action.write_bytes);
+#endif
             imgr_state.off += action.write_bytes;
-            if (imgr_state.off == imgr_state.size) {
+            imgr_state.rx_map >>= 1;
+            rc = imgr_win_advance(fa);
+            if (rc != 0) {
+                rc = MGMT_ERR_EUNKNOWN;
+                errstr = imgmgr_err_str_flash_read_failed;
+            } else if (imgr_state.off == imgr_state.size) {
                 /* Done */
+#if MYNEWT_VAL(IMGMGR_VERIFY_UPLOAD)
+                if (imgr_hash_check() != 0) {
+                    /* Make sure the corrupt image is never booted. */
+                    flash_area_erase(fa, 0, sizeof(struct image_header));
+                    rc = MGMT_ERR_EINVAL;
+                    errstr = imgmgr_err_str_hash_mismatch;
+                }
+#endif
                 imgr_state.area_id = -1;
             }
+#if MYNEWT_VAL(IMGMGR_ERASE_AHEAD)
+            if (imgr_state.area_id != -1) {
+                os_eventq_put(&imgr_erase_evq, &imgr_erase_ahead_ev);
+            }
+#endif
         }
     }
 
@@ -768,6 +1135,18 @@ imgr_upload(struct mgmt_cbuf *cb)
     return imgr_upload_good_rsp(cb);
 }
 
+static int
+imgr_upload(struct mgmt_cbuf *cb)
+{
+    int rc;
+
+    imgr_state_lock();
+    rc = imgr_upload_locked(cb);
+    imgr_state_unlock();
+
+    return rc;
+}
+
 void
 imgr_set_upload_cb(imgr_upload_fn *cb, void *arg)
 {
@@ -783,6 +1162,21 @@ imgmgr_module_init(void)
     /* Ensure this function only gets called by sysinit. */
     SYSINIT_ASSERT_ACTIVE();
 
+    imgr_state.area_id = -1;
+
+#if MYNEWT_VAL(IMGMGR_ERASE_AHEAD)
+    rc = os_mutex_init(&imgr_erase_mtx);
+    SYSINIT_PANIC_ASSERT(rc == 0);
+
+    os_eventq_init(&imgr_erase_evq);
+    rc = os_task_init(&imgr_erase_task, "imgr_erase", imgr_erase_task_handler,
+                      NULL, MYNEWT_VAL(IMGMGR_ERASE_TASK_PRIO),
+                      OS_WAIT_FOREVER, imgr_erase_stack,
+                      OS_STACK_ALIGN(
+                          MYNEWT_VAL(IMGMGR_ERASE_TASK_STACK_SIZE)));
+    SYSINIT_PANIC_ASSERT(rc == 0);
+#endif
+
     rc = mgmt_group_register(&imgr_nmgr_group);
     SYSINIT_PANIC_ASSERT(rc == 0);
 
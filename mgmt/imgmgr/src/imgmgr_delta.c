@@ -0,0 +1,560 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(IMGMGR_DELTA)
+
+#include <assert.h>
+#include <string.h>
+
+#include "flash_map/flash_map.h"
+#include "bootutil/image.h"
+#include "mgmt/mgmt.h"
+#include "cborattr/cborattr.h"
+#include "crypto/crypto.h"
+#if MYNEWT_VAL(LOG_FCB_SLOT1)
+#include "log/log_fcb_slot1.h"
+#endif
+
+#include "imgmgr/imgmgr.h"
+#include "imgmgr_priv.h"
+
+/* Size of the buffer image data goes through on its way to flash. */
+#define IMGR_DELTA_BUF_SZ       128
+
+/** Where the delta decoder is. */
+enum imgr_delta_step {
+    IMGR_DELTA_STEP_HDR,
+    IMGR_DELTA_STEP_OP,
+    IMGR_DELTA_STEP_ARG,
+    IMGR_DELTA_STEP_DATA,
+};
+
+/** Global state for delta upload in progress. */
+static struct {
+    /** Flash area being written; -1 if no upload in progress. */
+    int area_id;
+
+    /** Flash area of the image the delta applies to. */
+    int base_area_id;
+
+    /** Offset of next chunk of the delta, and the delta's size. */
+    uint32_t off;
+    uint32_t size;
+
+    /** Offset of next byte of the image, and the image's size. */
+    uint32_t img_off;
+    uint32_t img_size;
+
+    /** The area is erased up to this offset. */
+    uint32_t erased_off;
+    int erase_sec;
+
+    /** The decoder: the operation being read, and its arguments. */
+    uint8_t step;
+    uint8_t op;
+    uint8_t arg_idx;
+    uint8_t arg_shift;
+    uint32_t args[2];
+
+    /** Image data not yet written to flash. */
+    uint16_t buf_len;
+    uint8_t buf[IMGR_DELTA_BUF_SZ];
+
+    /** Bytes of the image covered by its hash; 0 if unknown. */
+    uint32_t hash_len;
+    struct crypto_sha256_ctx sha_ctx;
+
+    struct imgmgr_delta_hdr hdr;
+    uint8_t hdr_len;
+} imgr_delta = {
+    .area_id = -1,
+};
+
+#if MYNEWT_VAL(IMGMGR_VERBOSE_ERR)
+static const char *imgr_delta_err_str_malformed = "delta malformed";
+static const char *imgr_delta_err_str_base_mismatch = "base mismatch";
+static const char *imgr_delta_err_str_no_slot = "no slot";
+static const char *imgr_delta_err_str_flash = "flash fail";
+static const char *imgr_delta_err_str_hash_mismatch = "hash mismatch";
+static const char *imgr_delta_err_str_busy = "upload in progress";
+#else
+#define imgr_delta_err_str_malformed                NULL
+#define imgr_delta_err_str_base_mismatch            NULL
+#define imgr_delta_err_str_no_slot                  NULL
+#define imgr_delta_err_str_flash                    NULL
+#define imgr_delta_err_str_hash_mismatch            NULL
+#define imgr_delta_err_str_busy                     NULL
+#endif
+
+/**
+ * Writes the buffered image data to flash, erasing sectors as they are
+ * reached.
+ */
+static int
+imgr_delta_flush(const struct flash_area *fa)
+{
+    const struct image_header *hdr;
+    struct flash_area sector;
+    uint32_t off;
+    uint32_t len;
+    int rc;
+
+    if (imgr_delta.buf_len == 0) {
+        return 0;
+    }
+
+    off = imgr_delta.img_off - imgr_delta.buf_len;
+    if (off == 0) {
+        hdr = (const struct image_header *)imgr_delta.buf;
+        if (imgr_delta.buf_len < sizeof *hdr || hdr->ih_magic != IMAGE_MAGIC ||
+            !(hdr->ih_flags & IMAGE_F_SHA256)) {
+
+            return MGMT_ERR_EINVAL;
+        }
+        imgr_delta.hash_len = hdr->ih_hdr_size + hdr->ih_img_size;
+    }
+
+    while (imgr_delta.erased_off < off + imgr_delta.buf_len) {
+        rc = flash_area_getnext_sector(imgr_delta.area_id,
+                                       &imgr_delta.erase_sec, &sector);
+        if (rc != 0) {
+            return MGMT_ERR_EUNKNOWN;
+        }
+        rc = flash_area_erase(fa, sector.fa_off - fa->fa_off, sector.fa_size);
+        if (rc != 0) {
+            return MGMT_ERR_EUNKNOWN;
+        }
+        imgr_delta.erased_off = sector.fa_off - fa->fa_off + sector.fa_size;
+    }
+
+    rc = flash_area_write(fa, off, imgr_delta.buf, imgr_delta.buf_len);
+    if (rc != 0) {
+        return MGMT_ERR_EUNKNOWN;
+    }
+
+    if (off < imgr_delta.hash_len) {
+        len = imgr_delta.buf_len;
+        if (off + len > imgr_delta.hash_len) {
+            len = imgr_delta.hash_len - off;
+        }
+        crypto_sha256_update(&imgr_delta.sha_ctx, imgr_delta.buf, len);
+    }
+
+    imgr_delta.buf_len = 0;
+    return 0;
+}
+
+/**
+ * Adds image data, either from the delta (`data` != NULL) or from the base
+ * image at `base_off`.
+ */
+static int
+imgr_delta_out(const struct flash_area *fa, const struct flash_area *base_fa,
+               const uint8_t *data, uint32_t base_off, uint32_t len)
+{
+    uint32_t n;
+    int rc;
+
+    if (len > imgr_delta.img_size - imgr_delta.img_off) {
+        return MGMT_ERR_EINVAL;
+    }
+
+    while (len > 0) {
+        n = sizeof imgr_delta.buf - imgr_delta.buf_len;
+        if (n > len) {
+            n = len;
+        }
+
+        if (data != NULL) {
+            memcpy(imgr_delta.buf + imgr_delta.buf_len, data, n);
+            data += n;
+        } else {
+            rc = flash_area_read(base_fa, base_off,
+                                 imgr_delta.buf + imgr_delta.buf_len, n);
+            if (rc != 0) {
+                return MGMT_ERR_EUNKNOWN;
+            }
+            base_off += n;
+        }
+
+        imgr_delta.buf_len += n;
+        imgr_delta.img_off += n;
+        len -= n;
+
+        if (imgr_delta.buf_len == sizeof imgr_delta.buf) {
+            rc = imgr_delta_flush(fa);
+            if (rc != 0) {
+                return rc;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Runs a chunk of the delta through the decoder.  Operations can be split
+ * across chunks at any byte.
+ */
+static int
+imgr_delta_apply(const struct flash_area *fa, const uint8_t *data,
+                 uint32_t len)
+{
+    const struct flash_area *base_fa;
+    uint32_t n;
+    uint8_t b;
+    int rc;
+
+    rc = flash_area_open(imgr_delta.base_area_id, &base_fa);
+    if (rc != 0) {
+        return MGMT_ERR_EUNKNOWN;
+    }
+
+    while (len > 0) {
+        switch (imgr_delta.step) {
+        case IMGR_DELTA_STEP_HDR:
+            n = sizeof imgr_delta.hdr - imgr_delta.hdr_len;
+            if (n > len) {
+                n = len;
+            }
+            memcpy((uint8_t *)&imgr_delta.hdr + imgr_delta.hdr_len, data, n);
+            imgr_delta.hdr_len += n;
+            data += n;
+            len -= n;
+
+            if (imgr_delta.hdr_len == sizeof imgr_delta.hdr) {
+                imgr_delta.img_size = imgr_delta.hdr.idh_img_size;
+                imgr_delta.step = IMGR_DELTA_STEP_OP;
+            }
+            break;
+
+        case IMGR_DELTA_STEP_OP:
+            imgr_delta.op = *data++;
+            len--;
+            if (imgr_delta.op != IMGMGR_DELTA_OP_INSERT &&
+                imgr_delta.op != IMGMGR_DELTA_OP_COPY) {
+
+                rc = MGMT_ERR_EINVAL;
+                goto done;
+            }
+            imgr_delta.args[0] = 0;
+            imgr_delta.args[1] = 0;
+            imgr_delta.arg_idx = 0;
+            imgr_delta.arg_shift = 0;
+            imgr_delta.step = IMGR_DELTA_STEP_ARG;
+            break;
+
+        case IMGR_DELTA_STEP_ARG:
+            b = *data++;
+            len--;
+            if (imgr_delta.arg_shift > 28) {
+                rc = MGMT_ERR_EINVAL;
+                goto done;
+            }
+            imgr_delta.args[imgr_delta.arg_idx] |=
+                (uint32_t)(b & 0x7f) << imgr_delta.arg_shift;
+            imgr_delta.arg_shift += 7;
+            if (b & 0x80) {
+                break;
+            }
+
+            imgr_delta.arg_shift = 0;
+            imgr_delta.arg_idx++;
+            if (imgr_delta.op == IMGMGR_DELTA_OP_INSERT) {
+                /* INSERT <len> */
+                imgr_delta.step = IMGR_DELTA_STEP_DATA;
+            } else if (imgr_delta.arg_idx == 2) {
+                /* COPY <off> <len> */
+                if (imgr_delta.args[0] + imgr_delta.args[1] <
+                        imgr_delta.args[0] ||
+                    imgr_delta.args[0] + imgr_delta.args[1] >
+                        base_fa->fa_size) {
+
+                    rc = MGMT_ERR_EINVAL;
+                    goto done;
+                }
+                rc = imgr_delta_out(fa, base_fa, NULL, imgr_delta.args[0],
+                                    imgr_delta.args[1]);
+                if (rc != 0) {
+                    goto done;
+                }
+                imgr_delta.step = IMGR_DELTA_STEP_OP;
+            }
+            break;
+
+        case IMGR_DELTA_STEP_DATA:
+            n = imgr_delta.args[0];
+            if (n > len) {
+                n = len;
+            }
+            rc = imgr_delta_out(fa, base_fa, data, 0, n);
+            if (rc != 0) {
+                goto done;
+            }
+            data += n;
+            len -= n;
+            imgr_delta.args[0] -= n;
+            if (imgr_delta.args[0] == 0) {
+                imgr_delta.step = IMGR_DELTA_STEP_OP;
+            }
+            break;
+
+        default:
+            assert(0);
+            rc = MGMT_ERR_EUNKNOWN;
+            goto done;
+        }
+    }
+
+    /* An INSERT of nothing needs no data. */
+    if (imgr_delta.step == IMGR_DELTA_STEP_DATA && imgr_delta.args[0] == 0) {
+        imgr_delta.step = IMGR_DELTA_STEP_OP;
+    }
+
+    rc = 0;
+
+done:
+    flash_area_close(base_fa);
+    return rc;
+}
+
+/**
+ * Checks a completely rebuilt image against its SHA256 TLV.
+ */
+static int
+imgr_delta_finish(const struct flash_area *fa)
+{
+    uint8_t tlv_hash[IMGMGR_HASH_LEN];
+    uint8_t hash[IMGMGR_HASH_LEN];
+    int rc;
+
+    if (imgr_delta.step != IMGR_DELTA_STEP_OP ||
+        imgr_delta.img_off != imgr_delta.img_size) {
+
+        return MGMT_ERR_EINVAL;
+    }
+
+    rc = imgr_delta_flush(fa);
+    if (rc != 0) {
+        return rc;
+    }
+
+    if (imgr_delta.hash_len == 0 || imgr_delta.hash_len > imgr_delta.img_size) {
+        return MGMT_ERR_EINVAL;
+    }
+
+    crypto_sha256_finish(&imgr_delta.sha_ctx, hash);
+
+    rc = imgr_read_info(flash_area_id_to_image_slot(imgr_delta.area_id),
+                        NULL, tlv_hash, NULL);
+    if (rc != 0 || memcmp(hash, tlv_hash, sizeof hash) != 0) {
+        return MGMT_ERR_EINVAL;
+    }
+
+    return 0;
+}
+
+/**
+ * Starts a delta upload, if the delta applies to the running image.
+ */
+static int
+imgr_delta_start(const uint8_t *data, int data_len, const char **errstr)
+{
+    const struct imgmgr_delta_hdr *hdr;
+    uint8_t hash[IMGMGR_HASH_LEN];
+    int rc;
+
+    if (data_len < sizeof *hdr) {
+        *errstr = imgr_delta_err_str_malformed;
+        return MGMT_ERR_EINVAL;
+    }
+
+    hdr = (const struct imgmgr_delta_hdr *)data;
+    if (hdr->idh_magic != IMGMGR_DELTA_MAGIC) {
+        *errstr = imgr_delta_err_str_malformed;
+        return MGMT_ERR_EINVAL;
+    }
+
+    rc = imgr_read_info(boot_current_slot, NULL, hash, NULL);
+    if (rc != 0 || memcmp(hash, hdr->idh_base_hash, sizeof hash) != 0) {
+        *errstr = imgr_delta_err_str_base_mismatch;
+        return MGMT_ERR_EINVAL;
+    }
+
+    imgr_delta.area_id = imgmgr_find_best_area_id();
+    imgr_delta.base_area_id = flash_area_id_from_image_slot(boot_current_slot);
+    if (imgr_delta.area_id < 0 ||
+        imgr_delta.area_id == imgr_delta.base_area_id) {
+
+        imgr_delta.area_id = -1;
+        *errstr = imgr_delta_err_str_no_slot;
+        return MGMT_ERR_ENOMEM;
+    }
+
+#if MYNEWT_VAL(LOG_FCB_SLOT1)
+    if (imgr_delta.area_id == FLASH_AREA_IMAGE_1) {
+        log_fcb_slot1_lock();
+    }
+#endif
+
+    imgr_delta.off = 0;
+    imgr_delta.img_off = 0;
+    imgr_delta.img_size = 0;
+    imgr_delta.erased_off = 0;
+    imgr_delta.erase_sec = -1;
+    imgr_delta.step = IMGR_DELTA_STEP_HDR;
+    imgr_delta.hdr_len = 0;
+    imgr_delta.buf_len = 0;
+    imgr_delta.hash_len = 0;
+    crypto_sha256_start(&imgr_delta.sha_ctx);
+
+    return 0;
+}
+
+bool
+imgr_delta_in_progress(void)
+{
+    return imgr_delta.area_id != -1;
+}
+
+static int
+imgr_delta_upload_locked(struct mgmt_cbuf *cb)
+{
+    static uint8_t data[MYNEWT_VAL(IMGMGR_MAX_CHUNK_SIZE)];
+    unsigned long long off = -1;
+    unsigned long long size = -1;
+    size_t data_len = 0;
+    const struct cbor_attr_t attrs[4] = {
+        [0] = {
+            .attribute = "data",
+            .type = CborAttrByteStringType,
+            .addr.bytestring.data = data,
+            .addr.bytestring.len = &data_len,
+            .len = sizeof(data)
+        },
+        [1] = {
+            .attribute = "len",
+            .type = CborAttrUnsignedIntegerType,
+            .addr.uinteger = &size,
+            .nodefault = true
+        },
+        [2] = {
+            .attribute = "off",
+            .type = CborAttrUnsignedIntegerType,
+            .addr.uinteger = &off,
+            .nodefault = true
+        },
+        [3] = { 0 },
+    };
+    const struct flash_area *fa;
+    const char *errstr = NULL;
+    CborError g_err = CborNoError;
+    int rc;
+
+    rc = cbor_read_object(&cb->it, attrs);
+    if (rc != 0 || off == -1) {
+        return MGMT_ERR_EINVAL;
+    }
+
+    if (off == 0) {
+        if (size == -1) {
+            return imgr_error_rsp(cb, MGMT_ERR_EINVAL,
+                                  imgr_delta_err_str_malformed);
+        }
+        /* A regular upload is writing the same slot. */
+        if (imgr_upload_in_progress()) {
+            return imgr_error_rsp(cb, MGMT_ERR_EBADSTATE,
+                                  imgr_delta_err_str_busy);
+        }
+        rc = imgr_delta_start(data, data_len, &errstr);
+        if (rc != 0) {
+            return imgr_error_rsp(cb, rc, errstr);
+        }
+        imgr_delta.size = size;
+    }
+
+    if (imgr_delta.area_id != -1 && off == imgr_delta.off && data_len > 0) {
+        if (data_len > imgr_delta.size - imgr_delta.off) {
+            data_len = imgr_delta.size - imgr_delta.off;
+        }
+
+        rc = flash_area_open(imgr_delta.area_id, &fa);
+        if (rc != 0) {
+            return imgr_error_rsp(cb, MGMT_ERR_EUNKNOWN,
+                                  imgr_delta_err_str_flash);
+        }
+
+        rc = imgr_delta_apply(fa, data, data_len);
+        if (rc != 0) {
+            errstr = imgr_delta_err_str_malformed;
+        } else {
+            imgr_delta.off += data_len;
+            if (imgr_delta.off == imgr_delta.size) {
+                rc = imgr_delta_finish(fa);
+                if (rc != 0) {
+                    errstr = imgr_delta_err_str_hash_mismatch;
+                }
+                imgr_delta.area_id = -1;
+            }
+        }
+
+        if (rc != 0) {
+            /* Make sure a partly rebuilt image is never booted. */
+            flash_area_erase(fa, 0, sizeof(struct image_header));
+            imgr_delta.area_id = -1;
+        }
+
+        flash_area_close(fa);
+
+        if (rc != 0) {
+            return imgr_error_rsp(cb, rc, errstr);
+        }
+    }
+
+    /* Respond with the offset of the next chunk expected. */
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "rc");
+    g_err |= cbor_encode_int(&cb->encoder, MGMT_ERR_EOK);
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "off");
+    g_err |= cbor_encode_int(&cb->encoder, imgr_delta.off);
+    if (g_err) {
+        return MGMT_ERR_ENOMEM;
+    }
+
+    return 0;
+}
+
+/*
+ * Runs under the upload state lock, so a delta is never applied while the
+ * erase-ahead task or a regular upload works on the slot.
+ */
+int
+imgr_delta_upload(struct mgmt_cbuf *cb)
+{
+    int rc;
+
+    imgr_state_lock();
+    rc = imgr_delta_upload_locked(cb);
+    imgr_state_unlock();
+
+    return rc;
+}
+
+#endif
@@ -85,11 +85,37 @@ struct imgmgr_upload_cmd {
  * }
  */
 
+/*
+ * Request to delta upload:
+ * {
+ *      "off":<offset in delta>,
+ *      "len":<delta_size>		inspected when off = 0
+ *      "data":<base64encoded binary>
+ * }
+ *
+ *
+ * Response to delta upload:
+ * {
+ *      "off":<offset in delta>
+ * }
+ */
+
 struct mgmt_cbuf;
 
+#if MYNEWT_VAL(IMGMGR_VERBOSE_ERR)
+int imgr_error_rsp(struct mgmt_cbuf *cb, int rc, const char *rsn);
+#else
+#define imgr_error_rsp(cb, rc, rsn)         (rc)
+#endif
+
 int imgr_core_list(struct mgmt_cbuf *);
 int imgr_core_load(struct mgmt_cbuf *);
 int imgr_core_erase(struct mgmt_cbuf *);
+int imgr_delta_upload(struct mgmt_cbuf *);
+bool imgr_delta_in_progress(void);
+void imgr_state_lock(void);
+void imgr_state_unlock(void);
+bool imgr_upload_in_progress(void);
 int imgmgr_state_read(struct mgmt_cbuf *cb);
 int imgmgr_state_write(struct mgmt_cbuf *njb);
 int imgr_find_by_ver(struct image_version *find, uint8_t *hash);
@@ -0,0 +1,49 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "imgmgr_test.h"
+
+TEST_SUITE(imgmgr_test_suite_upload)
+{
+    imgmgr_test_case_upload();
+    imgmgr_test_case_upload_bench();
+    imgmgr_test_case_upload_window();
+    imgmgr_test_case_upload_window_bench();
+}
+
+TEST_SUITE(imgmgr_test_suite_delta)
+{
+    imgmgr_test_case_delta();
+    imgmgr_test_case_delta_bad();
+    imgmgr_test_case_delta_busy();
+}
+
+#if MYNEWT_VAL(SELFTEST)
+
+int
+main(int argc, char **argv)
+{
+    imgmgr_test_suite_upload();
+    imgmgr_test_suite_delta();
+
+    return tu_any_failed;
+}
+
+#endif
@@ -0,0 +1,82 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_IMGMGR_TEST_
+#define H_IMGMGR_TEST_
+
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IMGMGR_TEST_IMG_MAX     (200 * 1024)
+#define IMGMGR_TEST_RSP_MAX     8
+#define IMGMGR_TEST_DELTA_BUCKETS   8192
+
+/** The fields of an image upload response. */
+struct imgmgr_test_rsp {
+    int rc;
+    uint32_t off;
+    uint32_t win;
+    uint32_t bmp;
+};
+
+/** Image built by imgmgr_test_util_build_image(). */
+extern uint8_t imgmgr_test_img[IMGMGR_TEST_IMG_MAX];
+
+void imgmgr_test_util_init(void);
+int imgmgr_test_util_build_image(uint32_t img_size, uint8_t seed);
+int imgmgr_test_util_seal_image(uint8_t *img, uint32_t img_size, uint8_t ver);
+int imgmgr_test_util_seal_split_image(uint8_t *img, uint32_t img_size,
+                                      uint8_t ver, const uint8_t *loader_hash);
+void imgmgr_test_util_write_slot(int slot, const uint8_t *img, int len);
+void imgmgr_test_util_fill_slot(int slot, uint8_t val);
+int imgmgr_test_util_upload_chunk(const uint8_t *img, int len, uint32_t off,
+                                  int chunk_len, uint32_t *rsp_off);
+int imgmgr_test_util_upload_frame(const uint8_t *img, int len,
+                                  const uint32_t *offs, int num_chunks,
+                                  int chunk_len, int win,
+                                  struct imgmgr_test_rsp *rsps);
+int imgmgr_test_util_upload(const uint8_t *img, int len, int chunk_len);
+int imgmgr_test_util_delta_encode(const uint8_t *base, int base_len,
+                                  const uint8_t *img, int img_len,
+                                  uint8_t *delta, int delta_max);
+int imgmgr_test_util_delta_chunk(const uint8_t *delta, int len, uint32_t off,
+                                 int chunk_len, uint32_t *rsp_off);
+int imgmgr_test_util_delta_upload(const uint8_t *delta, int len,
+                                  int chunk_len);
+
+TEST_SUITE_DECL(imgmgr_test_suite_upload);
+TEST_CASE_DECL(imgmgr_test_case_upload);
+TEST_CASE_DECL(imgmgr_test_case_upload_bench);
+TEST_CASE_DECL(imgmgr_test_case_upload_window);
+TEST_CASE_DECL(imgmgr_test_case_upload_window_bench);
+
+TEST_SUITE_DECL(imgmgr_test_suite_delta);
+TEST_CASE_DECL(imgmgr_test_case_delta);
+TEST_CASE_DECL(imgmgr_test_case_delta_bad);
+TEST_CASE_DECL(imgmgr_test_case_delta_busy);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,605 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "os/mynewt.h"
+#include "flash_map/flash_map.h"
+#include "bootutil/image.h"
+#include "mgmt/mgmt.h"
+#include "newtmgr/newtmgr.h"
+#include "imgmgr/imgmgr.h"
+#include "cborattr/cborattr.h"
+#include "tinycbor/cbor_mbuf_writer.h"
+#include "mbedtls/sha256.h"
+#include "imgmgr_test.h"
+
+uint8_t imgmgr_test_img[IMGMGR_TEST_IMG_MAX];
+
+/** Loopback newtmgr transport; responses are collected here. */
+static struct nmgr_transport imgmgr_test_nt;
+static struct os_mbuf *imgmgr_test_rsps[IMGMGR_TEST_RSP_MAX];
+static int imgmgr_test_num_rsps;
+
+static int
+imgmgr_test_util_out(struct nmgr_transport *nt, struct os_mbuf *m)
+{
+    TEST_ASSERT_FATAL(imgmgr_test_num_rsps < IMGMGR_TEST_RSP_MAX);
+    imgmgr_test_rsps[imgmgr_test_num_rsps++] = m;
+
+    return 0;
+}
+
+static uint16_t
+imgmgr_test_util_mtu(struct os_mbuf *m)
+{
+    return MGMT_MAX_MTU;
+}
+
+void
+imgmgr_test_util_init(void)
+{
+    int rc;
+
+    rc = nmgr_transport_init(&imgmgr_test_nt, imgmgr_test_util_out,
+                             imgmgr_test_util_mtu);
+    TEST_ASSERT_FATAL(rc == 0);
+}
+
+/**
+ * Builds an image with a header, a body derived from `seed` and a SHA256
+ * TLV in imgmgr_test_img.
+ *
+ * @return                      The total image size.
+ */
+int
+imgmgr_test_util_build_image(uint32_t img_size, uint8_t seed)
+{
+    struct image_header hdr;
+    uint32_t off;
+    uint32_t i;
+
+    TEST_ASSERT_FATAL(sizeof hdr + img_size + sizeof(struct image_tlv) + 32 <=
+                      IMGMGR_TEST_IMG_MAX);
+
+    off = sizeof hdr;
+    for (i = 0; i < img_size; i++) {
+        imgmgr_test_img[off++] = (uint8_t)(i * 7 + (i >> 8) + seed);
+    }
+
+    return imgmgr_test_util_seal_image(imgmgr_test_img, img_size, seed);
+}
+
+static int
+imgmgr_test_util_seal(uint8_t *img, uint32_t img_size, uint8_t ver,
+                      const uint8_t *loader_hash)
+{
+    mbedtls_sha256_context ctx;
+    struct image_header hdr;
+    struct image_tlv tlv;
+    uint32_t off;
+
+    memset(&hdr, 0, sizeof hdr);
+    hdr.ih_magic = IMAGE_MAGIC;
+    hdr.ih_tlv_size = sizeof tlv + 32;
+    hdr.ih_key_id = 0xff;
+    hdr.ih_hdr_size = sizeof hdr;
+    hdr.ih_img_size = img_size;
+    hdr.ih_flags = IMAGE_F_SHA256;
+    if (loader_hash != NULL) {
+        hdr.ih_flags |= IMAGE_F_NON_BOOTABLE;
+    }
+    hdr.ih_ver.iv_major = ver;
+
+    memcpy(img, &hdr, sizeof hdr);
+    off = sizeof hdr + img_size;
+
+    mbedtls_sha256_init(&ctx);
+    mbedtls_sha256_starts(&ctx, 0);
+    if (loader_hash != NULL) {
+        mbedtls_sha256_update(&ctx, loader_hash, 32);
+    }
+    mbedtls_sha256_update(&ctx, img, off);
+
+    tlv.it_type = IMAGE_TLV_SHA256;
+    tlv._pad = 0;
+    tlv.it_len = 32;
+    memcpy(img + off, &tlv, sizeof tlv);
+    off += sizeof tlv;
+
+    mbedtls_sha256_finish(&ctx, img + off);
+    off += 32;
+
+    return off;
+}
+
+/**
+ * Writes the header and SHA256 TLV around the `img_size` byte body of the
+ * image in `img`, leaving room for the header at the front.
+ *
+ * @return                      The total image size.
+ */
+int
+imgmgr_test_util_seal_image(uint8_t *img, uint32_t img_size, uint8_t ver)
+{
+    return imgmgr_test_util_seal(img, img_size, ver, NULL);
+}
+
+/**
+ * Like imgmgr_test_util_seal_image(), but seals a split app: the image is
+ * marked non-bootable, and its hash is seeded with its loader's hash.
+ *
+ * @return                      The total image size.
+ */
+int
+imgmgr_test_util_seal_split_image(uint8_t *img, uint32_t img_size,
+                                  uint8_t ver, const uint8_t *loader_hash)
+{
+    return imgmgr_test_util_seal(img, img_size, ver, loader_hash);
+}
+
+void
+imgmgr_test_util_write_slot(int slot, const uint8_t *img, int len)
+{
+    const struct flash_area *fa;
+    int rc;
+
+    rc = flash_area_open(flash_area_id_from_image_slot(slot), &fa);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = flash_area_erase(fa, 0, fa->fa_size);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = flash_area_write(fa, 0, img, len);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    flash_area_close(fa);
+}
+
+/**
+ * Leaves the whole slot filled with a non-erased value, as an older image
+ * would.
+ */
+void
+imgmgr_test_util_fill_slot(int slot, uint8_t val)
+{
+    const struct flash_area *fa;
+    uint8_t buf[256];
+    uint32_t off;
+    int rc;
+
+    rc = flash_area_open(flash_area_id_from_image_slot(slot), &fa);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = flash_area_erase(fa, 0, fa->fa_size);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    memset(buf, val, sizeof buf);
+    for (off = 0; off < fa->fa_size; off += sizeof buf) {
+        rc = flash_area_write(fa, off, buf, sizeof buf);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+
+    flash_area_close(fa);
+}
+
+/**
+ * Appends one image or delta upload request to a newtmgr packet.  A window
+ * is requested if `win` is nonzero.
+ */
+static void
+imgmgr_test_util_append_req(struct os_mbuf *req, uint8_t id,
+                            const uint8_t *img, int len, uint32_t off,
+                            int chunk_len, int win)
+{
+    static const uint8_t pad[3];
+    struct cbor_mbuf_writer writer;
+    struct nmgr_hdr hdr;
+    CborEncoder enc;
+    CborEncoder map;
+    int hdr_off;
+    int rc;
+
+    hdr_off = OS_MBUF_PKTLEN(req);
+
+    memset(&hdr, 0, sizeof hdr);
+    hdr.nh_op = NMGR_OP_WRITE;
+    hdr.nh_group = htons(MGMT_GROUP_ID_IMAGE);
+    hdr.nh_id = id;
+    rc = os_mbuf_append(req, &hdr, sizeof hdr);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    cbor_mbuf_writer_init(&writer, req);
+    cbor_encoder_init(&enc, &writer.enc, 0);
+    rc = cbor_encoder_create_map(&enc, &map, CborIndefiniteLength);
+    rc |= cbor_encode_text_stringz(&map, "data");
+    rc |= cbor_encode_byte_string(&map, img + off, chunk_len);
+    rc |= cbor_encode_text_stringz(&map, "off");
+    rc |= cbor_encode_uint(&map, off);
+    if (off == 0) {
+        rc |= cbor_encode_text_stringz(&map, "len");
+        rc |= cbor_encode_uint(&map, len);
+        if (win != 0) {
+            rc |= cbor_encode_text_stringz(&map, "win");
+            rc |= cbor_encode_uint(&map, win);
+        }
+    }
+    rc |= cbor_encoder_close_container(&enc, &map);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    hdr.nh_len = OS_MBUF_PKTLEN(req) - hdr_off - sizeof hdr;
+
+    /* Packets following one another in a frame are 4-byte aligned. */
+    rc = os_mbuf_append(req, pad, OS_ALIGN(hdr.nh_len, 4) - hdr.nh_len);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    hdr.nh_len = htons(hdr.nh_len);
+    rc = os_mbuf_copyinto(req, hdr_off, &hdr, sizeof hdr);
+    TEST_ASSERT_FATAL(rc == 0);
+}
+
+/**
+ * Sends upload requests for the chunks at the specified offsets, all in one
+ * frame, over the loopback transport, and processes them.
+ *
+ * @param rsps                  The responses, one per chunk, are written
+ *                                  here.
+ *
+ * @return                      The number of responses received.
+ */
+static int
+imgmgr_test_util_send_frame(uint8_t id, const uint8_t *img, int len,
+                            const uint32_t *offs, int num_chunks,
+                            int chunk_len, int win,
+                            struct imgmgr_test_rsp *rsps)
+{
+    struct os_event *ev;
+    struct os_mbuf *req;
+    long long int rsp_rc;
+    long long int rsp_off;
+    long long int rsp_win;
+    long long int rsp_bmp;
+    const struct cbor_attr_t attrs[] = {
+        {
+            .attribute = "rc",
+            .type = CborAttrIntegerType,
+            .addr.integer = &rsp_rc,
+            .nodefault = true,
+        },
+        {
+            .attribute = "off",
+            .type = CborAttrIntegerType,
+            .addr.integer = &rsp_off,
+            .nodefault = true,
+        },
+        {
+            .attribute = "win",
+            .type = CborAttrIntegerType,
+            .addr.integer = &rsp_win,
+            .nodefault = true,
+        },
+        {
+            .attribute = "bmp",
+            .type = CborAttrIntegerType,
+            .addr.integer = &rsp_bmp,
+            .nodefault = true,
+        },
+        { 0 },
+    };
+    int num_rsps;
+    int clen;
+    int rc;
+    int i;
+
+    req = os_msys_get_pkthdr(0, 0);
+    TEST_ASSERT_FATAL(req != NULL);
+
+    for (i = 0; i < num_chunks; i++) {
+        clen = chunk_len;
+        if (clen > len - (int)offs[i]) {
+            clen = len - offs[i];
+        }
+        imgmgr_test_util_append_req(req, id, img, len, offs[i], clen, win);
+    }
+
+    rc = nmgr_rx_req(&imgmgr_test_nt, req);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /* Run the newtmgr task's events, including any background erase. */
+    while ((ev = os_eventq_get_no_wait(mgmt_evq_get())) != NULL) {
+        ev->ev_cb(ev);
+    }
+
+    num_rsps = imgmgr_test_num_rsps;
+    for (i = 0; i < num_rsps; i++) {
+        rsp_rc = -1;
+        rsp_off = -1;
+        rsp_win = 1;
+        rsp_bmp = 0;
+        rc = cbor_read_mbuf_attrs(imgmgr_test_rsps[i], sizeof(struct nmgr_hdr),
+                                  OS_MBUF_PKTLEN(imgmgr_test_rsps[i]) -
+                                      sizeof(struct nmgr_hdr),
+                                  attrs);
+        TEST_ASSERT_FATAL(rc == 0);
+
+        os_mbuf_free_chain(imgmgr_test_rsps[i]);
+        imgmgr_test_rsps[i] = NULL;
+
+        if (i < num_chunks) {
+            rsps[i].rc = rsp_rc;
+            rsps[i].off = rsp_off;
+            rsps[i].win = rsp_win;
+            rsps[i].bmp = rsp_bmp;
+        }
+    }
+    imgmgr_test_num_rsps = 0;
+
+    return num_rsps;
+}
+
+/**
+ * Sends image upload requests for the chunks at the specified offsets, all
+ * in one frame.
+ */
+int
+imgmgr_test_util_upload_frame(const uint8_t *img, int len,
+                              const uint32_t *offs, int num_chunks,
+                              int chunk_len, int win,
+                              struct imgmgr_test_rsp *rsps)
+{
+    return imgmgr_test_util_send_frame(IMGMGR_NMGR_ID_UPLOAD, img, len, offs,
+                                       num_chunks, chunk_len, win, rsps);
+}
+
+/**
+ * Sends one image upload request over the loopback transport and processes
+ * it.
+ *
+ * @param rsp_off               On success, the offset in the response.
+ *
+ * @return                      The rc of the response.
+ */
+int
+imgmgr_test_util_upload_chunk(const uint8_t *img, int len, uint32_t off,
+                              int chunk_len, uint32_t *rsp_off)
+{
+    struct imgmgr_test_rsp rsp;
+    int num_rsps;
+
+    num_rsps = imgmgr_test_util_upload_frame(img, len, &off, 1, chunk_len, 0,
+                                             &rsp);
+    TEST_ASSERT_FATAL(num_rsps == 1);
+
+    if (rsp_off != NULL) {
+        *rsp_off = rsp.off;
+    }
+
+    return rsp.rc;
+}
+
+/**
+ * Uploads a whole image, `chunk_len` bytes per request, following the
+ * offsets returned by the device.
+ *
+ * @return                      0 on success; the rc of the failed request
+ *                                  otherwise.
+ */
+int
+imgmgr_test_util_upload(const uint8_t *img, int len, int chunk_len)
+{
+    uint32_t next;
+    uint32_t off;
+    int rc;
+
+    off = 0;
+    while (off < len) {
+        if (chunk_len > len - off) {
+            chunk_len = len - off;
+        }
+
+        rc = imgmgr_test_util_upload_chunk(img, len, off, chunk_len, &next);
+        if (rc != 0) {
+            return rc;
+        }
+
+        TEST_ASSERT_FATAL(next > off);
+        off = next;
+    }
+
+    return 0;
+}
+
+/**
+ * Sends one delta upload request over the loopback transport and processes
+ * it.
+ *
+ * @param rsp_off               On success, the offset in the response.
+ *
+ * @return                      The rc of the response.
+ */
+int
+imgmgr_test_util_delta_chunk(const uint8_t *delta, int len, uint32_t off,
+                             int chunk_len, uint32_t *rsp_off)
+{
+    struct imgmgr_test_rsp rsp;
+    int num_rsps;
+
+    num_rsps = imgmgr_test_util_send_frame(IMGMGR_NMGR_ID_DELTA, delta, len,
+                                           &off, 1, chunk_len, 0, &rsp);
+    TEST_ASSERT_FATAL(num_rsps == 1);
+
+    if (rsp_off != NULL) {
+        *rsp_off = rsp.off;
+    }
+
+    return rsp.rc;
+}
+
+/**
+ * Uploads a whole delta, `chunk_len` bytes per request, following the
+ * offsets returned by the device.
+ *
+ * @return                      0 on success; the rc of the failed request
+ *                                  otherwise.
+ */
+int
+imgmgr_test_util_delta_upload(const uint8_t *delta, int len, int chunk_len)
+{
+    uint32_t next;
+    uint32_t off;
+    int rc;
+
+    off = 0;
+    while (off < len) {
+        rc = imgmgr_test_util_delta_chunk(delta, len, off, chunk_len, &next);
+        if (rc != 0) {
+            return rc;
+        }
+
+        TEST_ASSERT_FATAL(next > off);
+        off = next;
+    }
+
+    return 0;
+}
+
+static int
+imgmgr_test_util_put_varint(uint8_t *dst, uint32_t val)
+{
+    int len;
+
+    len = 0;
+    while (val >= 0x80) {
+        dst[len++] = (val & 0x7f) | 0x80;
+        val >>= 7;
+    }
+    dst[len++] = val;
+
+    return len;
+}
+
+static uint32_t
+imgmgr_test_util_delta_key(const uint8_t *p)
+{
+    return ((p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24) *
+            2654435761u ^ (p[4] | p[5] << 8 | p[6] << 16)) %
+           IMGMGR_TEST_DELTA_BUCKETS;
+}
+
+/**
+ * Encodes a delta which turns image `base` into image `img`.  Greedy: at
+ * each position, the longest match from either an 8-byte block index of the
+ * base image, or the base position following the previous copy, is copied;
+ * anything else is inserted.
+ *
+ * @return                      The size of the delta.
+ */
+int
+imgmgr_test_util_delta_encode(const uint8_t *base, int base_len,
+                              const uint8_t *img, int img_len,
+                              uint8_t *delta, int delta_max)
+{
+    static int32_t index[IMGMGR_TEST_DELTA_BUCKETS];
+    struct imgmgr_delta_hdr hdr;
+    const struct image_header *base_hdr;
+    uint32_t cands[2];
+    uint32_t best_off;
+    uint32_t best_len;
+    uint32_t next_base;
+    uint32_t lit_start;
+    uint32_t off;
+    uint32_t len;
+    int dlen;
+    int i;
+
+    /* The base image's hash is its SHA256 TLV, which follows the body. */
+    base_hdr = (const struct image_header *)base;
+    memset(&hdr, 0, sizeof hdr);
+    hdr.idh_magic = IMGMGR_DELTA_MAGIC;
+    hdr.idh_img_size = img_len;
+    memcpy(hdr.idh_base_hash,
+           base + base_hdr->ih_hdr_size + base_hdr->ih_img_size +
+               sizeof(struct image_tlv),
+           sizeof hdr.idh_base_hash);
+
+    memcpy(delta, &hdr, sizeof hdr);
+    dlen = sizeof hdr;
+
+    for (i = 0; i < IMGMGR_TEST_DELTA_BUCKETS; i++) {
+        index[i] = -1;
+    }
+    for (i = 0; i + 8 <= base_len; i++) {
+        index[imgmgr_test_util_delta_key(base + i)] = i;
+    }
+
+    next_base = 0;
+    lit_start = 0;
+    off = 0;
+    while (off < img_len) {
+        best_len = 0;
+        best_off = 0;
+        if (off + 8 <= img_len) {
+            cands[0] = next_base;
+            cands[1] = index[imgmgr_test_util_delta_key(img + off)];
+            for (i = 0; i < 2; i++) {
+                if (cands[i] == (uint32_t)-1) {
+                    continue;
+                }
+                len = 0;
+                while (cands[i] + len < base_len && off + len < img_len &&
+                       base[cands[i] + len] == img[off + len]) {
+                    len++;
+                }
+                if (len > best_len) {
+                    best_len = len;
+                    best_off = cands[i];
+                }
+            }
+        }
+
+        if (best_len < 16) {
+            off++;
+            next_base++;
+            if (off < img_len) {
+                continue;
+            }
+        }
+
+        /* Insert what is pending, then copy the match. */
+        len = off - lit_start;
+        if (len > 0) {
+            TEST_ASSERT_FATAL(dlen + 11 + len <= delta_max);
+            delta[dlen++] = IMGMGR_DELTA_OP_INSERT;
+            dlen += imgmgr_test_util_put_varint(delta + dlen, len);
+            memcpy(delta + dlen, img + lit_start, len);
+            dlen += len;
+        }
+
+        if (best_len >= 16) {
+            TEST_ASSERT_FATAL(dlen + 11 <= delta_max);
+            delta[dlen++] = IMGMGR_DELTA_OP_COPY;
+            dlen += imgmgr_test_util_put_varint(delta + dlen, best_off);
+            dlen += imgmgr_test_util_put_varint(delta + dlen, best_len);
+            off += best_len;
+            next_base = best_off + best_len;
+        }
+        lit_start = off;
+    }
+
+    return dlen;
+}
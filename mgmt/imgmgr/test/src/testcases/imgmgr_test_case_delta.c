@@ -0,0 +1,265 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "os/mynewt.h"
+#include "flash_map/flash_map.h"
+#include "bootutil/image.h"
+#include "mgmt/mgmt.h"
+#include "imgmgr/imgmgr.h"
+#include "imgmgr_test.h"
+
+#define IMGMGR_TEST_DELTA_BODY  (48 * 1024)
+
+static uint8_t imgmgr_test_base[IMGMGR_TEST_DELTA_BODY + 1024];
+static uint8_t imgmgr_test_new[IMGMGR_TEST_DELTA_BODY + 2048];
+static uint8_t imgmgr_test_delta[IMGMGR_TEST_DELTA_BODY + 4096];
+
+/**
+ * Uploads the delta from the base image to the new image, and checks the
+ * image rebuilt in slot 1.
+ */
+static void
+imgmgr_test_delta_round_trip(const char *name, int base_len, int new_len)
+{
+    const struct flash_area *fa;
+    uint8_t buf[256];
+    uint32_t chunk;
+    uint32_t off;
+    int delta_len;
+    int rc;
+
+    imgmgr_test_util_write_slot(0, imgmgr_test_base, base_len);
+    imgmgr_test_util_fill_slot(1, 0x5a);
+
+    delta_len = imgmgr_test_util_delta_encode(imgmgr_test_base, base_len,
+                                              imgmgr_test_new, new_len,
+                                              imgmgr_test_delta,
+                                              sizeof imgmgr_test_delta);
+
+    rc = imgmgr_test_util_delta_upload(imgmgr_test_delta, delta_len, 256);
+    TEST_ASSERT_FATAL(rc == 0, "%s: rc=%d", name, rc);
+
+    rc = flash_area_open(flash_area_id_from_image_slot(1), &fa);
+    TEST_ASSERT_FATAL(rc == 0);
+    for (off = 0; off < new_len; off += chunk) {
+        chunk = new_len - off;
+        if (chunk > sizeof buf) {
+            chunk = sizeof buf;
+        }
+        rc = flash_area_read(fa, off, buf, chunk);
+        TEST_ASSERT_FATAL(rc == 0);
+        TEST_ASSERT_FATAL(memcmp(buf, imgmgr_test_new + off, chunk) == 0,
+                          "%s: image differs at %u", name, (unsigned)off);
+    }
+    flash_area_close(fa);
+
+    printf("delta upload, %s: image %d bytes, transferred %d bytes (%d%%)\n",
+           name, new_len, delta_len, delta_len * 100 / new_len);
+}
+
+/*
+ * Round-trips pairs of images through a delta upload: a version bump, a
+ * patch in place, code inserted and removed, and an unrelated image.
+ */
+TEST_CASE(imgmgr_test_case_delta)
+{
+    const int body = IMGMGR_TEST_DELTA_BODY;
+    uint32_t seed;
+    int base_len;
+    int new_len;
+    int hdr_sz;
+    int i;
+
+    sysinit();
+    imgmgr_test_util_init();
+
+    hdr_sz = sizeof(struct image_header);
+
+    base_len = imgmgr_test_util_build_image(body, 1);
+    memcpy(imgmgr_test_base, imgmgr_test_img, base_len);
+
+    /*** Version bump; only the header and the hash change. */
+    memcpy(imgmgr_test_new, imgmgr_test_base, base_len);
+    new_len = imgmgr_test_util_seal_image(imgmgr_test_new, body, 2);
+    imgmgr_test_delta_round_trip("version bump", base_len, new_len);
+
+    /*** A 200 byte patch in the middle. */
+    memcpy(imgmgr_test_new, imgmgr_test_base, base_len);
+    for (i = 0; i < 200; i++) {
+        imgmgr_test_new[hdr_sz + 20000 + i] ^= 0xa5;
+    }
+    new_len = imgmgr_test_util_seal_image(imgmgr_test_new, body, 2);
+    imgmgr_test_delta_round_trip("patch", base_len, new_len);
+
+    /*** 1000 bytes inserted at 4 KB, 500 removed at 30 KB. */
+    memcpy(imgmgr_test_new, imgmgr_test_base, hdr_sz + 4096);
+    for (i = 0; i < 1000; i++) {
+        imgmgr_test_new[hdr_sz + 4096 + i] = i * 13;
+    }
+    memcpy(imgmgr_test_new + hdr_sz + 5096, imgmgr_test_base + hdr_sz + 4096,
+           30000 - 4096);
+    memcpy(imgmgr_test_new + hdr_sz + 30000 + 1000,
+           imgmgr_test_base + hdr_sz + 30500, body - 30500);
+    new_len = imgmgr_test_util_seal_image(imgmgr_test_new, body + 500, 2);
+    imgmgr_test_delta_round_trip("insert/remove", base_len, new_len);
+
+    /*** Nothing in common. */
+    seed = 0x12345678;
+    for (i = 0; i < body; i++) {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        imgmgr_test_new[hdr_sz + i] = seed;
+    }
+    new_len = imgmgr_test_util_seal_image(imgmgr_test_new, body, 2);
+    imgmgr_test_delta_round_trip("unrelated", base_len, new_len);
+}
+
+/*
+ * Deltas that do not apply, or do not rebuild the image they claim to, are
+ * rejected, and leave no bootable image behind.
+ */
+TEST_CASE(imgmgr_test_case_delta_bad)
+{
+    const int body = IMGMGR_TEST_DELTA_BODY;
+    struct image_header hdr;
+    const struct flash_area *fa;
+    int base_len;
+    int new_len;
+    int delta_len;
+    int rc;
+
+    sysinit();
+    imgmgr_test_util_init();
+
+    base_len = imgmgr_test_util_build_image(body, 1);
+    memcpy(imgmgr_test_base, imgmgr_test_img, base_len);
+    memcpy(imgmgr_test_new, imgmgr_test_base, base_len);
+    imgmgr_test_new[sizeof hdr + 1000] ^= 0xff;
+    new_len = imgmgr_test_util_seal_image(imgmgr_test_new, body, 2);
+
+    delta_len = imgmgr_test_util_delta_encode(imgmgr_test_base, base_len,
+                                              imgmgr_test_new, new_len,
+                                              imgmgr_test_delta,
+                                              sizeof imgmgr_test_delta);
+
+    /*** Running image is not the delta's base. */
+    new_len = imgmgr_test_util_build_image(body, 3);
+    imgmgr_test_util_write_slot(0, imgmgr_test_img, new_len);
+    imgmgr_test_util_fill_slot(1, 0xff);
+    rc = imgmgr_test_util_delta_upload(imgmgr_test_delta, delta_len, 256);
+    TEST_ASSERT(rc == MGMT_ERR_EINVAL);
+
+    /*** The rebuilt image does not match its hash.  The delta ends with the
+     * new image's hash TLV, inserted.
+     */
+    imgmgr_test_util_write_slot(0, imgmgr_test_base, base_len);
+    imgmgr_test_util_fill_slot(1, 0xff);
+    imgmgr_test_delta[delta_len - 1] ^= 0x01;
+    rc = imgmgr_test_util_delta_upload(imgmgr_test_delta, delta_len, 256);
+    TEST_ASSERT(rc == MGMT_ERR_EINVAL);
+    imgmgr_test_delta[delta_len - 1] ^= 0x01;
+
+    rc = flash_area_open(flash_area_id_from_image_slot(1), &fa);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = flash_area_read(fa, 0, &hdr, sizeof hdr);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(hdr.ih_magic != IMAGE_MAGIC);
+    flash_area_close(fa);
+
+    /*** An unknown operation. */
+    imgmgr_test_util_fill_slot(1, 0xff);
+    imgmgr_test_delta[sizeof(struct imgmgr_delta_hdr)] = 0x7f;
+    rc = imgmgr_test_util_delta_upload(imgmgr_test_delta, delta_len, 256);
+    TEST_ASSERT(rc == MGMT_ERR_EINVAL);
+}
+
+/*
+ * A delta upload and a regular upload never write the slot at the same
+ * time; whichever starts second is turned away until the first completes.
+ */
+TEST_CASE(imgmgr_test_case_delta_busy)
+{
+    const int body = IMGMGR_TEST_DELTA_BODY;
+    uint32_t seed;
+    uint32_t off;
+    int base_len;
+    int new_len;
+    int delta_len;
+    int rc;
+    int i;
+
+    sysinit();
+    imgmgr_test_util_init();
+
+    /* Unrelated images, so the delta takes many requests. */
+    base_len = imgmgr_test_util_build_image(body, 1);
+    memcpy(imgmgr_test_base, imgmgr_test_img, base_len);
+    seed = 0x87654321;
+    for (i = 0; i < body; i++) {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        imgmgr_test_new[sizeof(struct image_header) + i] = seed;
+    }
+    new_len = imgmgr_test_util_seal_image(imgmgr_test_new, body, 2);
+
+    delta_len = imgmgr_test_util_delta_encode(imgmgr_test_base, base_len,
+                                              imgmgr_test_new, new_len,
+                                              imgmgr_test_delta,
+                                              sizeof imgmgr_test_delta);
+    TEST_ASSERT_FATAL(delta_len > 256);
+
+    imgmgr_test_util_write_slot(0, imgmgr_test_base, base_len);
+    imgmgr_test_util_fill_slot(1, 0xff);
+
+    /*** A delta while a regular upload is in progress. */
+    rc = imgmgr_test_util_upload_chunk(imgmgr_test_new, new_len, 0, 256,
+                                       &off);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT_FATAL(off == 256);
+
+    rc = imgmgr_test_util_delta_chunk(imgmgr_test_delta, delta_len, 0, 256,
+                                      NULL);
+    TEST_ASSERT(rc == MGMT_ERR_EBADSTATE);
+
+    /* The regular upload is unaffected, and can be completed. */
+    rc = imgmgr_test_util_upload(imgmgr_test_new, new_len, 256);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /*** A regular upload while a delta is in progress. */
+    imgmgr_test_util_fill_slot(1, 0xff);
+    rc = imgmgr_test_util_delta_chunk(imgmgr_test_delta, delta_len, 0, 256,
+                                      &off);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT_FATAL(off == 256);
+
+    rc = imgmgr_test_util_upload_chunk(imgmgr_test_new, new_len, 0, 256,
+                                       NULL);
+    TEST_ASSERT(rc == MGMT_ERR_EBADSTATE);
+
+    /* Once the delta is through, regular uploads are accepted again. */
+    rc = imgmgr_test_util_delta_upload(imgmgr_test_delta, delta_len, 256);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = imgmgr_test_util_upload(imgmgr_test_new, new_len, 256);
+    TEST_ASSERT(rc == 0);
+}
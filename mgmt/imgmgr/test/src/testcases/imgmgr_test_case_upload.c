@@ -0,0 +1,137 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "os/mynewt.h"
+#include "flash_map/flash_map.h"
+#include "bootutil/image.h"
+#include "mgmt/mgmt.h"
+#include "imgmgr_test.h"
+
+static void
+imgmgr_test_case_upload_verify(int len)
+{
+    const struct flash_area *fa;
+    uint8_t buf[256];
+    uint32_t off;
+    int chunk;
+    int rc;
+    int i;
+
+    rc = flash_area_open(FLASH_AREA_IMAGE_1, &fa);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    for (off = 0; off < len; off += chunk) {
+        chunk = len - off;
+        if (chunk > sizeof buf) {
+            chunk = sizeof buf;
+        }
+        rc = flash_area_read(fa, off, buf, chunk);
+        TEST_ASSERT_FATAL(rc == 0);
+        TEST_ASSERT_FATAL(memcmp(buf, imgmgr_test_img + off, chunk) == 0);
+    }
+
+    /* The rest of the last sector written to was erased, the next sector
+     * was left alone.
+     */
+    rc = flash_area_read(fa, len, buf, sizeof buf);
+    TEST_ASSERT_FATAL(rc == 0);
+    for (i = 0; i < sizeof buf; i++) {
+        TEST_ASSERT_FATAL(buf[i] == 0xff);
+    }
+
+    rc = flash_area_read(fa, fa->fa_size - sizeof buf, buf, sizeof buf);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(buf[0] == 0x5a);
+
+    flash_area_close(fa);
+}
+
+TEST_CASE(imgmgr_test_case_upload)
+{
+    uint8_t loader_hash[32];
+    struct image_header hdr;
+    const struct flash_area *fa;
+    uint32_t off;
+    int len;
+    int rc;
+
+    sysinit();
+    imgmgr_test_util_init();
+
+    /* Running image in slot 0, leftovers of an older image in slot 1. */
+    len = imgmgr_test_util_build_image(16 * 1024, 1);
+    imgmgr_test_util_write_slot(0, imgmgr_test_img, len);
+    imgmgr_test_util_fill_slot(1, 0x5a);
+
+    /*** Upload spanning two flash sectors. */
+    len = imgmgr_test_util_build_image(150 * 1024, 2);
+
+    rc = imgmgr_test_util_upload(imgmgr_test_img, len, 512);
+    TEST_ASSERT_FATAL(rc == 0);
+    imgmgr_test_case_upload_verify(len);
+
+    /*** A chunk with the wrong offset is dropped. */
+    len = imgmgr_test_util_build_image(150 * 1024, 3);
+    imgmgr_test_util_fill_slot(1, 0x5a);
+
+    rc = imgmgr_test_util_upload_chunk(imgmgr_test_img, len, 0, 512, &off);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT_FATAL(off == 512);
+
+    rc = imgmgr_test_util_upload_chunk(imgmgr_test_img, len, 1024, 512, &off);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT_FATAL(off == 512);
+
+    rc = imgmgr_test_util_upload(imgmgr_test_img, len, 512);
+    TEST_ASSERT_FATAL(rc == 0);
+    imgmgr_test_case_upload_verify(len);
+
+    /***
+     * Image whose data does not match its hash TLV: the last chunk is
+     * rejected and the header is erased.
+     */
+    len = imgmgr_test_util_build_image(20 * 1024, 4);
+    imgmgr_test_img[sizeof hdr + 1000] ^= 0x01;
+    imgmgr_test_util_fill_slot(1, 0x5a);
+
+    rc = imgmgr_test_util_upload(imgmgr_test_img, len, 512);
+    TEST_ASSERT(rc == MGMT_ERR_EINVAL);
+
+    rc = flash_area_open(FLASH_AREA_IMAGE_1, &fa);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = flash_area_read(fa, 0, &hdr, sizeof hdr);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(hdr.ih_magic == 0xffffffff);
+    flash_area_close(fa);
+
+    /***
+     * Split app: its hash TLV covers the loader's hash as well, so the
+     * image is accepted as is.
+     */
+    len = imgmgr_test_util_build_image(20 * 1024, 5);
+    memset(loader_hash, 0xa5, sizeof loader_hash);
+    len = imgmgr_test_util_seal_split_image(imgmgr_test_img, 20 * 1024, 5,
+                                            loader_hash);
+    imgmgr_test_util_fill_slot(1, 0x5a);
+
+    rc = imgmgr_test_util_upload(imgmgr_test_img, len, 512);
+    TEST_ASSERT_FATAL(rc == 0);
+    imgmgr_test_case_upload_verify(len);
+}
@@ -0,0 +1,53 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include "os/mynewt.h"
+#include "imgmgr_test.h"
+
+/*
+ * Times a 192 KB upload through the newtmgr request path, into a slot
+ * that needs erasing, with the largest chunk a request can carry.
+ */
+TEST_CASE(imgmgr_test_case_upload_bench)
+{
+    uint32_t start;
+    uint32_t usecs;
+    int len;
+    int rc;
+
+    sysinit();
+    imgmgr_test_util_init();
+
+    len = imgmgr_test_util_build_image(16 * 1024, 1);
+    imgmgr_test_util_write_slot(0, imgmgr_test_img, len);
+    imgmgr_test_util_fill_slot(1, 0x5a);
+
+    len = imgmgr_test_util_build_image(192 * 1024, 5);
+
+    start = os_cputime_get32();
+    rc = imgmgr_test_util_upload(imgmgr_test_img, len,
+                                 MYNEWT_VAL(IMGMGR_MAX_CHUNK_SIZE));
+    usecs = os_cputime_ticks_to_usecs(os_cputime_get32() - start);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    printf("image upload: %d bytes in %u us, %u KB/s\n",
+           len, (unsigned)usecs,
+           (unsigned)((uint64_t)len * 1000000 / 1024 / (usecs ? usecs : 1)));
+}
@@ -0,0 +1,116 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "os/mynewt.h"
+#include "flash_map/flash_map.h"
+#include "imgmgr_test.h"
+
+#define IMGMGR_TEST_WIN_CHUNK   256
+
+static void
+imgmgr_test_window_send(int len, uint32_t off, uint32_t exp_off,
+                        uint32_t exp_bmp)
+{
+    struct imgmgr_test_rsp rsp;
+    int num_rsps;
+
+    num_rsps = imgmgr_test_util_upload_frame(imgmgr_test_img, len, &off, 1,
+                                             IMGMGR_TEST_WIN_CHUNK, 4, &rsp);
+    TEST_ASSERT_FATAL(num_rsps == 1);
+    TEST_ASSERT(rsp.rc == 0);
+    TEST_ASSERT(rsp.win == 4);
+    TEST_ASSERT(rsp.off == exp_off);
+    TEST_ASSERT(rsp.bmp == exp_bmp);
+}
+
+TEST_CASE(imgmgr_test_case_upload_window)
+{
+    struct imgmgr_test_rsp rsps[4];
+    const struct flash_area *fa;
+    uint32_t offs[4];
+    uint32_t chunk;
+    uint32_t off;
+    uint8_t buf[256];
+    int num_rsps;
+    int len;
+    int rc;
+    int i;
+
+    sysinit();
+    imgmgr_test_util_init();
+
+    len = imgmgr_test_util_build_image(16 * 1024, 1);
+    imgmgr_test_util_write_slot(0, imgmgr_test_img, len);
+    imgmgr_test_util_fill_slot(1, 0x5a);
+
+    len = imgmgr_test_util_build_image(24 * 1024 + 100, 7);
+
+    /*** First chunk asks for a window of 4. */
+    imgmgr_test_window_send(len, 0, 256, 0);
+
+    /*** Chunks ahead of the offset are kept in the bitmap. */
+    imgmgr_test_window_send(len, 3 * 256, 256, 0x4);
+    imgmgr_test_window_send(len, 2 * 256, 256, 0x6);
+
+    /*** Duplicates, chunks past the window and misaligned chunks are
+     * dropped.
+     */
+    imgmgr_test_window_send(len, 2 * 256, 256, 0x6);
+    imgmgr_test_window_send(len, 5 * 256, 256, 0x6);
+    imgmgr_test_window_send(len, 256 + 100, 256, 0x6);
+
+    /*** The missing chunk moves the offset past everything received. */
+    imgmgr_test_window_send(len, 256, 4 * 256, 0);
+
+    /*** Four chunks per frame, in reverse order, get four responses. */
+    off = 4 * 256;
+    while (off < len) {
+        for (i = 0; i < 4; i++) {
+            offs[i] = off + (3 - i) * IMGMGR_TEST_WIN_CHUNK;
+            if (offs[i] >= len) {
+                offs[i] = off;
+            }
+        }
+        num_rsps = imgmgr_test_util_upload_frame(imgmgr_test_img, len, offs,
+                                                 4, IMGMGR_TEST_WIN_CHUNK, 4,
+                                                 rsps);
+        TEST_ASSERT_FATAL(num_rsps == 4);
+        for (i = 0; i < 4; i++) {
+            TEST_ASSERT_FATAL(rsps[i].rc == 0);
+        }
+        TEST_ASSERT_FATAL(rsps[3].off > off);
+        off = rsps[3].off;
+    }
+    TEST_ASSERT(off == len);
+
+    /* The image in slot 1 is intact. */
+    rc = flash_area_open(flash_area_id_from_image_slot(1), &fa);
+    TEST_ASSERT_FATAL(rc == 0);
+    for (off = 0; off < len; off += chunk) {
+        chunk = len - off;
+        if (chunk > sizeof buf) {
+            chunk = sizeof buf;
+        }
+        rc = flash_area_read(fa, off, buf, chunk);
+        TEST_ASSERT_FATAL(rc == 0);
+        TEST_ASSERT_FATAL(memcmp(buf, imgmgr_test_img + off, chunk) == 0);
+    }
+    flash_area_close(fa);
+}
@@ -0,0 +1,132 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include "os/mynewt.h"
+#include "imgmgr_test.h"
+
+/*
+ * A BLE link, as seen by a newtmgr client: one connection event every
+ * 7.5 ms, in which up to four packets go each way.  Requests sent in one
+ * event are answered in the next.  Chunks are sized for a 251 byte data
+ * length.
+ */
+#define IMGMGR_TEST_BLE_CONN_ITVL_US    7500
+#define IMGMGR_TEST_BLE_PKTS_PER_EVT    4
+#define IMGMGR_TEST_BLE_CHUNK           176
+
+/**
+ * Uploads an image over the simulated link with the specified window.
+ *
+ * @return                      The number of connection events taken.
+ */
+static int
+imgmgr_test_window_bench_upload(int len, int win)
+{
+    struct imgmgr_test_rsp rsps[IMGMGR_TEST_BLE_PKTS_PER_EVT];
+    uint32_t offs[IMGMGR_TEST_BLE_PKTS_PER_EVT];
+    uint32_t bmp;
+    uint32_t off;
+    int num_chunks;
+    int num_rsps;
+    int events;
+    int i;
+
+    off = 0;
+    bmp = 0;
+    events = 0;
+    while (off < len) {
+        /* Send the chunks of the window the device does not have yet. */
+        num_chunks = 0;
+        for (i = 0;
+             i < win && num_chunks < IMGMGR_TEST_BLE_PKTS_PER_EVT &&
+             off + i * IMGMGR_TEST_BLE_CHUNK < len;
+             i++) {
+
+            if (off == 0 && i > 0) {
+                /* The window is only agreed on by the first chunk. */
+                break;
+            }
+            if (!(bmp & (1UL << i))) {
+                offs[num_chunks++] = off + i * IMGMGR_TEST_BLE_CHUNK;
+            }
+        }
+
+        num_rsps = imgmgr_test_util_upload_frame(imgmgr_test_img, len, offs,
+                                                 num_chunks,
+                                                 IMGMGR_TEST_BLE_CHUNK, win,
+                                                 rsps);
+        TEST_ASSERT_FATAL(num_rsps == num_chunks);
+        for (i = 0; i < num_rsps; i++) {
+            TEST_ASSERT_FATAL(rsps[i].rc == 0);
+        }
+
+        /* The responses arrive in the next event, when the client can send
+         * again.
+         */
+        events++;
+        TEST_ASSERT_FATAL(rsps[num_rsps - 1].off > off);
+        off = rsps[num_rsps - 1].off;
+        bmp = rsps[num_rsps - 1].bmp;
+    }
+
+    /* The last response. */
+    return events + 1;
+}
+
+/*
+ * Compares stop-and-wait with a windowed upload of a 64 KB image over a
+ * simulated BLE link.  The link model stands in for the air time; the
+ * whole newtmgr and imgmgr request path runs for every chunk.
+ */
+TEST_CASE(imgmgr_test_case_upload_window_bench)
+{
+    static const int wins[] = { 1, 4, 8 };
+    uint32_t start;
+    uint32_t usecs;
+    uint32_t link_us;
+    int events[sizeof wins / sizeof wins[0]];
+    int len;
+    int i;
+
+    sysinit();
+    imgmgr_test_util_init();
+
+    len = imgmgr_test_util_build_image(16 * 1024, 1);
+    imgmgr_test_util_write_slot(0, imgmgr_test_img, len);
+
+    for (i = 0; i < sizeof wins / sizeof wins[0]; i++) {
+        imgmgr_test_util_fill_slot(1, 0xff);
+        len = imgmgr_test_util_build_image(64 * 1024, 9);
+
+        start = os_cputime_get32();
+        events[i] = imgmgr_test_window_bench_upload(len, wins[i]);
+        usecs = os_cputime_ticks_to_usecs(os_cputime_get32() - start);
+
+        link_us = events[i] * IMGMGR_TEST_BLE_CONN_ITVL_US;
+        printf("windowed upload, win=%d: %d bytes in %d conn events, "
+               "%u B/s over the link; %u us of CPU\n",
+               wins[i], len, events[i],
+               (unsigned)((uint64_t)len * 1000000 / link_us),
+               (unsigned)usecs);
+    }
+
+    /* A window keeps every connection event busy. */
+    TEST_ASSERT(events[2] * 3 < events[0]);
+}
@@ -68,6 +68,21 @@ extern "C" {
 
 #define NMGR_HDR_SIZE           (8)
 
+/*
+ * Header flags.
+ *
+ * A client sets NMGR_F_STREAM in a request to accept a streamed response.
+ * The server then sends the response as it is encoded, as a series of
+ * packets which each carry their own header with NMGR_F_STREAM set; all but
+ * the last also have NMGR_F_MORE set.  Concatenating the payloads of the
+ * series gives the response.  If the handler fails after part of the
+ * response has gone out, the last packet has NMGR_F_ABORT set, and its
+ * payload is an error response on its own.
+ */
+#define NMGR_F_STREAM           (0x01)
+#define NMGR_F_MORE             (0x02)
+#define NMGR_F_ABORT            (0x04)
+
 struct nmgr_hdr {
 #if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
     uint8_t  nh_op:3;           /* NMGR_OP_XXX */
@@ -77,7 +92,7 @@ struct nmgr_hdr {
     uint8_t  _res1:5;
     uint8_t  nh_op:3;           /* NMGR_OP_XXX */
 #endif
-    uint8_t  nh_flags;          /* XXX reserved for future flags */
+    uint8_t  nh_flags;          /* NMGR_F_XXX */
     uint16_t nh_len;            /* length of the payload */
     uint16_t nh_group;          /* NMGR_GROUP_XXX */
     uint8_t  nh_seq;            /* sequence number */
@@ -107,6 +122,7 @@ struct mgmt_group {
 
 int mgmt_group_register(struct mgmt_group *group);
 int mgmt_cbuf_setoerr(struct mgmt_cbuf *njb, int errcode);
+int mgmt_cbuf_streaming(const struct mgmt_cbuf *cb);
 const struct mgmt_handler *mgmt_find_handler(uint16_t group_id,
   uint16_t handler_id);
 
@@ -154,3 +154,19 @@ mgmt_cbuf_setoerr(struct mgmt_cbuf *cb, int errcode)
 
     return 0;
 }
+
+/**
+ * Indicates whether the response is being streamed to the client as it is
+ * encoded.  If so, its size is not limited by the mbufs available, and a
+ * handler may send all of a large response at once rather than a page at a
+ * time.
+ *
+ * @param cb                    The response being encoded.
+ *
+ * @return                      1 if the response is streamed; 0 otherwise.
+ */
+int
+mgmt_cbuf_streaming(const struct mgmt_cbuf *cb)
+{
+    return cb->streaming;
+}
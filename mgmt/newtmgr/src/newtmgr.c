@@ -44,6 +44,12 @@ static struct nmgr_cbuf {
     struct cbor_mbuf_writer writer;
     struct cbor_mbuf_reader reader;
     struct os_mbuf *n_out_m;
+
+    /* Streamed response state. */
+    struct nmgr_transport *n_nt;
+    struct nmgr_hdr n_hdr;
+    uint16_t n_mtu;
+    uint8_t n_sent;
 } nmgr_task_cbuf;
 
 struct os_eventq *
@@ -92,7 +98,7 @@ nmgr_init_rsp(struct os_mbuf *m, struct nmgr_hdr *src)
 
 static void
 nmgr_send_err_rsp(struct nmgr_transport *nt, struct os_mbuf *m,
-                  struct nmgr_hdr *hdr, int status)
+                  struct nmgr_hdr *hdr, uint8_t flags, int status)
 {
     struct CborEncoder map;
     int rc;
@@ -102,6 +108,7 @@ nmgr_send_err_rsp(struct nmgr_transport *nt, struct os_mbuf *m,
         os_mbuf_free_chain(m);
         return;
     }
+    hdr->nh_flags = flags;
 
     rc = cbor_encoder_create_map(&nmgr_task_cbuf.n_b.encoder, &map,
                                  CborIndefiniteLength);
@@ -180,6 +187,124 @@ nmgr_rsp_tx(struct nmgr_transport *nt, struct os_mbuf **rsp, uint16_t mtu)
     return MGMT_ERR_EOK;
 }
 
+/**
+ * Allocates the next packet of a streamed response, with its header filled
+ * in.  Fails at once if msys is exhausted, rather than blocking the task
+ * until the transport frees what has been sent; the stream is then aborted
+ * with MGMT_ERR_ENOMEM.
+ */
+static struct os_mbuf *
+nmgr_stream_alloc(void)
+{
+    struct nmgr_hdr *hdr;
+    struct os_mbuf *src;
+    struct os_mbuf *m;
+
+    src = nmgr_task_cbuf.n_out_m;
+    m = os_msys_get_pkthdr(nmgr_task_cbuf.n_mtu, OS_MBUF_USRHDR_LEN(src));
+    if (m == NULL) {
+        return NULL;
+    }
+
+    memcpy(OS_MBUF_USRHDR(m), OS_MBUF_USRHDR(src), OS_MBUF_USRHDR_LEN(src));
+
+    hdr = (struct nmgr_hdr *)os_mbuf_extend(m, sizeof(*hdr));
+    if (hdr == NULL) {
+        os_mbuf_free_chain(m);
+        return NULL;
+    }
+    memcpy(hdr, &nmgr_task_cbuf.n_hdr, sizeof(*hdr));
+
+    return m;
+}
+
+/**
+ * Sends the current packet of a streamed response, and starts the next one.
+ */
+static int
+nmgr_stream_flush(void)
+{
+    struct nmgr_hdr *hdr;
+    struct os_mbuf *next;
+    struct os_mbuf *m;
+    int rc;
+
+    next = nmgr_stream_alloc();
+    if (next == NULL) {
+        return MGMT_ERR_ENOMEM;
+    }
+
+    m = nmgr_task_cbuf.n_out_m;
+    hdr = OS_MBUF_DATA(m, struct nmgr_hdr *);
+    hdr->nh_len = htons(OS_MBUF_PKTLEN(m) - sizeof(*hdr));
+    hdr->nh_flags = NMGR_F_STREAM | NMGR_F_MORE;
+
+    nmgr_task_cbuf.writer.m = next;
+    nmgr_task_cbuf.n_out_m = next;
+    nmgr_task_cbuf.n_sent = 1;
+
+    rc = nmgr_task_cbuf.n_nt->nt_output(nmgr_task_cbuf.n_nt, m);
+    if (rc != 0) {
+        return MGMT_ERR_EUNKNOWN;
+    }
+
+    return 0;
+}
+
+/**
+ * CBOR writer for streamed responses.  Appends to the current packet, and
+ * sends it on whenever it reaches the MTU.
+ */
+static int
+nmgr_stream_write(struct cbor_encoder_writer *arg, const char *data, int len)
+{
+    struct cbor_mbuf_writer *cb;
+    int room;
+    int rc;
+
+    cb = (struct cbor_mbuf_writer *)arg;
+
+    while (len > 0) {
+        room = nmgr_task_cbuf.n_mtu - OS_MBUF_PKTLEN(cb->m);
+        if (room <= 0) {
+            rc = nmgr_stream_flush();
+            if (rc != 0) {
+                return CborErrorOutOfMemory;
+            }
+            continue;
+        }
+        if (room > len) {
+            room = len;
+        }
+
+        rc = os_mbuf_append(cb->m, data, room);
+        if (rc != 0) {
+            return CborErrorOutOfMemory;
+        }
+        cb->enc.bytes_written += room;
+        data += room;
+        len -= room;
+    }
+
+    return CborNoError;
+}
+
+/**
+ * Switches the response being built to streaming; see NMGR_F_STREAM.
+ */
+static void
+nmgr_stream_start(struct nmgr_transport *nt, struct nmgr_hdr *rsp_hdr,
+                  uint16_t mtu)
+{
+    nmgr_task_cbuf.n_nt = nt;
+    nmgr_task_cbuf.n_mtu = mtu;
+    memcpy(&nmgr_task_cbuf.n_hdr, rsp_hdr, sizeof(*rsp_hdr));
+    nmgr_task_cbuf.n_hdr.nh_flags = NMGR_F_STREAM;
+
+    nmgr_task_cbuf.writer.enc.write = nmgr_stream_write;
+    nmgr_task_cbuf.n_b.streaming = 1;
+}
+
 static void
 nmgr_handle_req(struct nmgr_transport *nt, struct os_mbuf *req)
 {
@@ -225,8 +350,25 @@ nmgr_handle_req(struct nmgr_transport *nt, struct os_mbuf *req)
             goto err_norsp;
         }
 
+        if (rsp == NULL) {
+            /* The previous response was consumed by the transport; each
+             * request in the packet gets its own response, so a client can
+             * pipeline several requests (e.g., image upload chunks) in one
+             * frame.
+             */
+            rsp = os_msys_get_pkthdr(512, OS_MBUF_USRHDR_LEN(req));
+            if (rsp == NULL) {
+                goto err_norsp;
+            }
+            memcpy(OS_MBUF_USRHDR(rsp), OS_MBUF_USRHDR(req),
+                   OS_MBUF_USRHDR_LEN(req));
+        }
+
         hdr.nh_len = ntohs(hdr.nh_len);
 
+        nmgr_task_cbuf.n_b.streaming = 0;
+        nmgr_task_cbuf.n_sent = 0;
+
         handler = mgmt_find_handler(ntohs(hdr.nh_group), hdr.nh_id);
         if (!handler) {
             rc = MGMT_ERR_ENOENT;
@@ -241,8 +383,11 @@ nmgr_handle_req(struct nmgr_transport *nt, struct os_mbuf *req)
             rc = MGMT_ERR_ENOMEM;
             goto err_norsp;
         }
+        if ((hdr.nh_flags & NMGR_F_STREAM) && mtu > sizeof(hdr)) {
+            nmgr_stream_start(nt, rsp_hdr, mtu);
+        }
 
-        cbor_mbuf_reader_init(&nmgr_task_cbuf.reader, req, sizeof(hdr));
+        cbor_mbuf_reader_init(&nmgr_task_cbuf.reader, req, off + sizeof(hdr));
         cbor_parser_init(&nmgr_task_cbuf.reader.r, 0,
                          &nmgr_task_cbuf.n_b.parser, &nmgr_task_cbuf.n_b.it);
 
@@ -271,6 +416,9 @@ nmgr_handle_req(struct nmgr_transport *nt, struct os_mbuf *req)
         } else {
             rc = MGMT_ERR_EINVAL;
         }
+
+        /* A streamed response has moved on to a later packet. */
+        rsp = nmgr_task_cbuf.n_out_m;
         if (rc != 0) {
             goto err;
         }
@@ -283,9 +431,15 @@ nmgr_handle_req(struct nmgr_transport *nt, struct os_mbuf *req)
             goto err;
         }
 
-        rsp_hdr->nh_len +=
-            cbor_encode_bytes_written(&nmgr_task_cbuf.n_b.encoder);
-        rsp_hdr->nh_len = htons(rsp_hdr->nh_len);
+        if (nmgr_task_cbuf.n_b.streaming) {
+            rsp_hdr = OS_MBUF_DATA(rsp, struct nmgr_hdr *);
+            rsp_hdr->nh_len = htons(OS_MBUF_PKTLEN(rsp) - sizeof(*rsp_hdr));
+            rsp_hdr->nh_flags = NMGR_F_STREAM;
+        } else {
+            rsp_hdr->nh_len +=
+                cbor_encode_bytes_written(&nmgr_task_cbuf.n_b.encoder);
+            rsp_hdr->nh_len = htons(rsp_hdr->nh_len);
+        }
 
         rc = nmgr_rsp_tx(nt, &rsp, mtu);
         if (rc) {
@@ -310,7 +464,9 @@ err:
     /* Clear partially written response. */
     os_mbuf_adj(rsp, OS_MBUF_PKTLEN(rsp));
 
-    nmgr_send_err_rsp(nt, rsp, &hdr, rc);
+    nmgr_send_err_rsp(nt, rsp, &hdr,
+                      nmgr_task_cbuf.n_sent ? NMGR_F_STREAM | NMGR_F_ABORT : 0,
+                      rc);
     os_mbuf_free_chain(req);
     return;
 
@@ -0,0 +1,62 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_NEWTMGR_TEST_
+#define H_NEWTMGR_TEST_
+
+#include "os/mynewt.h"
+#include "mgmt/mgmt.h"
+#include "testutil/testutil.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Most packets a single response may be sent as. */
+#define NEWTMGR_TEST_PKT_MAX        256
+
+/** Largest response, in bytes of payload. */
+#define NEWTMGR_TEST_RSP_MAX        (32 * 1024)
+
+/** A packet sent by the test transport. */
+struct newtmgr_test_pkt {
+    const uint8_t *data;
+    int len;
+};
+
+extern uint16_t newtmgr_test_mtu;
+extern struct newtmgr_test_pkt newtmgr_test_pkts[NEWTMGR_TEST_PKT_MAX];
+extern int newtmgr_test_num_pkts;
+
+void newtmgr_test_util_init(void);
+void newtmgr_test_util_req(uint8_t op, uint16_t group, uint8_t id,
+                           uint8_t flags, const uint8_t *payload, int len);
+int newtmgr_test_util_rsp(uint8_t *dst, int max);
+int newtmgr_test_util_stream_rsp(uint8_t *dst, int max);
+void newtmgr_test_util_pkt_hdr(int idx, struct nmgr_hdr *hdr);
+
+TEST_SUITE_DECL(newtmgr_test_suite);
+TEST_CASE_DECL(newtmgr_test_case_stream);
+TEST_CASE_DECL(newtmgr_test_case_stream_log);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
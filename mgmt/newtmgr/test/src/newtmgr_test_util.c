@@ -0,0 +1,280 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "os/mynewt.h"
+#include "mgmt/mgmt.h"
+#include "newtmgr/newtmgr.h"
+#include "cborattr/cborattr.h"
+#include "newtmgr_test.h"
+
+uint16_t newtmgr_test_mtu;
+struct newtmgr_test_pkt newtmgr_test_pkts[NEWTMGR_TEST_PKT_MAX];
+int newtmgr_test_num_pkts;
+
+static uint8_t newtmgr_test_wire[NEWTMGR_TEST_RSP_MAX +
+                                 NEWTMGR_TEST_PKT_MAX * NMGR_HDR_SIZE];
+static int newtmgr_test_wire_len;
+static struct nmgr_transport newtmgr_test_nt;
+static uint8_t newtmgr_test_seq;
+
+/*
+ * A transport which hands each packet it is given straight to the test.
+ */
+static int
+newtmgr_test_out(struct nmgr_transport *nt, struct os_mbuf *m)
+{
+    struct newtmgr_test_pkt *pkt;
+    int len;
+    int rc;
+
+    len = OS_MBUF_PKTLEN(m);
+    TEST_ASSERT_FATAL(len <= newtmgr_test_mtu);
+    TEST_ASSERT_FATAL(newtmgr_test_num_pkts < NEWTMGR_TEST_PKT_MAX);
+    TEST_ASSERT_FATAL(newtmgr_test_wire_len + len <=
+                      sizeof newtmgr_test_wire);
+
+    pkt = newtmgr_test_pkts + newtmgr_test_num_pkts++;
+    pkt->data = newtmgr_test_wire + newtmgr_test_wire_len;
+    pkt->len = len;
+    rc = os_mbuf_copydata(m, 0, len, newtmgr_test_wire + newtmgr_test_wire_len);
+    TEST_ASSERT_FATAL(rc == 0);
+    newtmgr_test_wire_len += len;
+
+    os_mbuf_free_chain(m);
+    return 0;
+}
+
+static uint16_t
+newtmgr_test_get_mtu(struct os_mbuf *m)
+{
+    return newtmgr_test_mtu;
+}
+
+/*
+ * Responds with "d": [0, 1, ..., n - 1], and then fails if "fail" is set.
+ */
+static int
+newtmgr_test_seq_read(struct mgmt_cbuf *cb)
+{
+    long long int n;
+    long long int fail;
+    const struct cbor_attr_t attrs[] = {
+        {
+            .attribute = "n",
+            .type = CborAttrIntegerType,
+            .addr.integer = &n,
+        },
+        {
+            .attribute = "fail",
+            .type = CborAttrIntegerType,
+            .addr.integer = &fail,
+        },
+        { 0 },
+    };
+    CborEncoder seq;
+    CborError err;
+    int rc;
+    int i;
+
+    n = 0;
+    fail = 0;
+    rc = cbor_read_object(&cb->it, attrs);
+    if (rc != 0) {
+        return MGMT_ERR_EINVAL;
+    }
+
+    err = cbor_encode_text_stringz(&cb->encoder, "rc");
+    err |= cbor_encode_int(&cb->encoder, 0);
+    err |= cbor_encode_text_stringz(&cb->encoder, "d");
+    err |= cbor_encoder_create_array(&cb->encoder, &seq,
+                                     CborIndefiniteLength);
+    for (i = 0; i < n; i++) {
+        err |= cbor_encode_int(&seq, i);
+    }
+    err |= cbor_encoder_close_container(&cb->encoder, &seq);
+    if (err != 0) {
+        return MGMT_ERR_ENOMEM;
+    }
+
+    if (fail) {
+        return MGMT_ERR_EBADSTATE;
+    }
+
+    return 0;
+}
+
+static const struct mgmt_handler newtmgr_test_handlers[] = {
+    [0] = {
+        .mh_read = newtmgr_test_seq_read,
+        .mh_write = NULL,
+    },
+};
+
+static struct mgmt_group newtmgr_test_group = {
+    .mg_handlers = (struct mgmt_handler *)newtmgr_test_handlers,
+    .mg_handlers_count = 1,
+    .mg_group_id = MGMT_GROUP_ID_PERUSER,
+};
+
+void
+newtmgr_test_util_init(void)
+{
+    static int initialized;
+    int rc;
+
+    if (!initialized) {
+        /* Only once; a second pass would register the newtmgr groups
+         * again.
+         */
+        sysinit();
+
+        rc = nmgr_transport_init(&newtmgr_test_nt, newtmgr_test_out,
+                                 newtmgr_test_get_mtu);
+        TEST_ASSERT_FATAL(rc == 0);
+
+        rc = mgmt_group_register(&newtmgr_test_group);
+        TEST_ASSERT_FATAL(rc == 0);
+
+        initialized = 1;
+    }
+
+    newtmgr_test_mtu = 128;
+    newtmgr_test_num_pkts = 0;
+    newtmgr_test_wire_len = 0;
+}
+
+/**
+ * Sends a request over the test transport, and runs the newtmgr task until
+ * it is idle.  The packets of the response are left in newtmgr_test_pkts.
+ */
+void
+newtmgr_test_util_req(uint8_t op, uint16_t group, uint8_t id,
+                      uint8_t flags, const uint8_t *payload, int len)
+{
+    struct nmgr_hdr hdr;
+    struct os_event *ev;
+    struct os_mbuf *m;
+    int rc;
+
+    memset(&hdr, 0, sizeof hdr);
+    hdr.nh_op = op;
+    hdr.nh_flags = flags;
+    hdr.nh_len = htons(len);
+    hdr.nh_group = htons(group);
+    hdr.nh_seq = newtmgr_test_seq++;
+    hdr.nh_id = id;
+
+    m = os_msys_get_pkthdr(sizeof hdr + len, 0);
+    TEST_ASSERT_FATAL(m != NULL);
+    rc = os_mbuf_append(m, &hdr, sizeof hdr);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = os_mbuf_append(m, payload, len);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    newtmgr_test_num_pkts = 0;
+    newtmgr_test_wire_len = 0;
+
+    rc = nmgr_rx_req(&newtmgr_test_nt, m);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    while ((ev = os_eventq_get_no_wait(mgmt_evq_get())) != NULL) {
+        ev->ev_cb(ev);
+    }
+}
+
+/**
+ * Reads the header at the start of the specified packet, in host byte order.
+ */
+void
+newtmgr_test_util_pkt_hdr(int idx, struct nmgr_hdr *hdr)
+{
+    TEST_ASSERT_FATAL(idx < newtmgr_test_num_pkts);
+    TEST_ASSERT_FATAL(newtmgr_test_pkts[idx].len >= sizeof *hdr);
+
+    memcpy(hdr, newtmgr_test_pkts[idx].data, sizeof *hdr);
+    hdr->nh_len = ntohs(hdr->nh_len);
+    hdr->nh_group = ntohs(hdr->nh_group);
+}
+
+/**
+ * Reassembles a response which was sent the usual way: a single header,
+ * with the response split into MTU-sized fragments.
+ *
+ * @return                      The size of the response payload.
+ */
+int
+newtmgr_test_util_rsp(uint8_t *dst, int max)
+{
+    struct nmgr_hdr hdr;
+    int len;
+    int i;
+
+    newtmgr_test_util_pkt_hdr(0, &hdr);
+    TEST_ASSERT_FATAL(hdr.nh_flags == 0);
+
+    len = -(int)sizeof hdr;
+    for (i = 0; i < newtmgr_test_num_pkts; i++) {
+        TEST_ASSERT_FATAL(len + newtmgr_test_pkts[i].len <= max);
+        if (i == 0) {
+            memcpy(dst, newtmgr_test_pkts[i].data + sizeof hdr,
+                   newtmgr_test_pkts[i].len - sizeof hdr);
+        } else {
+            memcpy(dst + len, newtmgr_test_pkts[i].data,
+                   newtmgr_test_pkts[i].len);
+        }
+        len += newtmgr_test_pkts[i].len;
+    }
+    TEST_ASSERT_FATAL(hdr.nh_len == len);
+
+    return len;
+}
+
+/**
+ * Reassembles a streamed response, checking that each packet carries its
+ * own header and that all but the last are marked as having more to follow.
+ *
+ * @return                      The size of the response payload.
+ */
+int
+newtmgr_test_util_stream_rsp(uint8_t *dst, int max)
+{
+    struct nmgr_hdr hdr;
+    int len;
+    int i;
+
+    len = 0;
+    for (i = 0; i < newtmgr_test_num_pkts; i++) {
+        newtmgr_test_util_pkt_hdr(i, &hdr);
+        TEST_ASSERT_FATAL(hdr.nh_len == newtmgr_test_pkts[i].len - sizeof hdr);
+        TEST_ASSERT_FATAL(hdr.nh_op == NMGR_OP_READ_RSP);
+        if (i < newtmgr_test_num_pkts - 1) {
+            TEST_ASSERT_FATAL(hdr.nh_flags == (NMGR_F_STREAM | NMGR_F_MORE));
+        } else {
+            TEST_ASSERT_FATAL(hdr.nh_flags == NMGR_F_STREAM);
+        }
+
+        TEST_ASSERT_FATAL(len + hdr.nh_len <= max);
+        memcpy(dst + len, newtmgr_test_pkts[i].data + sizeof hdr,
+               hdr.nh_len);
+        len += hdr.nh_len;
+    }
+
+    return len;
+}
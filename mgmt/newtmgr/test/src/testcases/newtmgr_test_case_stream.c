@@ -0,0 +1,147 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "tinycbor/cbor.h"
+#include "tinycbor/cbor_buf_writer.h"
+#include "tinycbor/cbor_buf_reader.h"
+#include "newtmgr_test.h"
+
+static void
+newtmgr_test_seq_req(uint8_t flags, int n, int fail)
+{
+    struct cbor_buf_writer writer;
+    CborEncoder enc;
+    CborEncoder map;
+    uint8_t buf[32];
+    int rc;
+
+    cbor_buf_writer_init(&writer, buf, sizeof buf);
+    cbor_encoder_init(&enc, &writer.enc, 0);
+    rc = cbor_encoder_create_map(&enc, &map, CborIndefiniteLength);
+    rc |= cbor_encode_text_stringz(&map, "n");
+    rc |= cbor_encode_int(&map, n);
+    rc |= cbor_encode_text_stringz(&map, "fail");
+    rc |= cbor_encode_int(&map, fail);
+    rc |= cbor_encoder_close_container(&enc, &map);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    newtmgr_test_util_req(NMGR_OP_READ, MGMT_GROUP_ID_PERUSER, 0, flags,
+                          buf, cbor_buf_writer_buffer_size(&writer, buf));
+}
+
+static int
+newtmgr_test_rsp_rc(const uint8_t *rsp, int len)
+{
+    struct cbor_buf_reader reader;
+    CborParser parser;
+    CborValue root;
+    CborValue val;
+    int rc;
+
+    cbor_buf_reader_init(&reader, rsp, len);
+    rc = cbor_parser_init(&reader.r, 0, &parser, &root);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = cbor_value_map_find_value(&root, "rc", &val);
+    TEST_ASSERT_FATAL(rc == 0 && cbor_value_is_integer(&val));
+    cbor_value_get_int(&val, &rc);
+
+    return rc;
+}
+
+static void
+newtmgr_test_check_seq(const uint8_t *rsp, int len, int n)
+{
+    struct cbor_buf_reader reader;
+    CborParser parser;
+    CborValue root;
+    CborValue seq;
+    CborValue val;
+    int rc;
+    int v;
+    int i;
+
+    TEST_ASSERT_FATAL(newtmgr_test_rsp_rc(rsp, len) == 0);
+
+    cbor_buf_reader_init(&reader, rsp, len);
+    rc = cbor_parser_init(&reader.r, 0, &parser, &root);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = cbor_value_map_find_value(&root, "d", &seq);
+    TEST_ASSERT_FATAL(rc == 0 && cbor_value_is_array(&seq));
+    rc = cbor_value_enter_container(&seq, &val);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    for (i = 0; !cbor_value_at_end(&val); i++) {
+        TEST_ASSERT_FATAL(cbor_value_is_integer(&val));
+        cbor_value_get_int(&val, &v);
+        TEST_ASSERT_FATAL(v == i);
+        rc = cbor_value_advance(&val);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+    TEST_ASSERT(i == n);
+}
+
+TEST_CASE(newtmgr_test_case_stream)
+{
+    static uint8_t rsp[NEWTMGR_TEST_RSP_MAX];
+    const struct newtmgr_test_pkt *last;
+    struct nmgr_hdr hdr;
+    int len;
+    int i;
+
+    newtmgr_test_util_init();
+
+    /*** Without the flag, the response is fragmented the usual way. */
+    newtmgr_test_seq_req(0, 100, 0);
+    TEST_ASSERT(newtmgr_test_num_pkts > 1);
+    len = newtmgr_test_util_rsp(rsp, sizeof rsp);
+    newtmgr_test_check_seq(rsp, len, 100);
+
+    /*** ...and has to fit in msys all at once. */
+    newtmgr_test_seq_req(0, 2000, 0);
+    len = newtmgr_test_util_rsp(rsp, sizeof rsp);
+    TEST_ASSERT(newtmgr_test_rsp_rc(rsp, len) == MGMT_ERR_ENOMEM);
+
+    /*** A small streamed response is a single packet. */
+    newtmgr_test_seq_req(NMGR_F_STREAM, 3, 0);
+    TEST_ASSERT(newtmgr_test_num_pkts == 1);
+    len = newtmgr_test_util_stream_rsp(rsp, sizeof rsp);
+    newtmgr_test_check_seq(rsp, len, 3);
+
+    /*** A large one goes out as it is encoded, an MTU at a time. */
+    newtmgr_test_mtu = 64;
+    newtmgr_test_seq_req(NMGR_F_STREAM, 2000, 0);
+    len = newtmgr_test_util_stream_rsp(rsp, sizeof rsp);
+    TEST_ASSERT(newtmgr_test_num_pkts >= len / (64 - NMGR_HDR_SIZE));
+    newtmgr_test_check_seq(rsp, len, 2000);
+
+    /*** A handler failing midway aborts the stream with an error. */
+    newtmgr_test_seq_req(NMGR_F_STREAM, 2000, 1);
+    TEST_ASSERT_FATAL(newtmgr_test_num_pkts > 1);
+    for (i = 0; i < newtmgr_test_num_pkts - 1; i++) {
+        newtmgr_test_util_pkt_hdr(i, &hdr);
+        TEST_ASSERT(hdr.nh_flags == (NMGR_F_STREAM | NMGR_F_MORE));
+    }
+    newtmgr_test_util_pkt_hdr(i, &hdr);
+    TEST_ASSERT(hdr.nh_flags == (NMGR_F_STREAM | NMGR_F_ABORT));
+    last = newtmgr_test_pkts + i;
+    TEST_ASSERT(newtmgr_test_rsp_rc(last->data + NMGR_HDR_SIZE,
+                                    last->len - NMGR_HDR_SIZE) ==
+                MGMT_ERR_EBADSTATE);
+}
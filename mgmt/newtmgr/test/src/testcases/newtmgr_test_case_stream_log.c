@@ -0,0 +1,141 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "os/mynewt.h"
+#include "log/log.h"
+#include "tinycbor/cbor.h"
+#include "tinycbor/cbor_buf_writer.h"
+#include "tinycbor/cbor_buf_reader.h"
+#include "newtmgr_test.h"
+
+#define NEWTMGR_TEST_LOG_ENTRIES    100
+
+static struct log newtmgr_test_log;
+static struct cbmem newtmgr_test_cbmem;
+static uint8_t newtmgr_test_cbmem_buf[8192];
+
+static void
+newtmgr_test_log_req(uint8_t flags)
+{
+    struct cbor_buf_writer writer;
+    CborEncoder enc;
+    CborEncoder map;
+    uint8_t buf[64];
+    int rc;
+
+    cbor_buf_writer_init(&writer, buf, sizeof buf);
+    cbor_encoder_init(&enc, &writer.enc, 0);
+    rc = cbor_encoder_create_map(&enc, &map, CborIndefiniteLength);
+    rc |= cbor_encode_text_stringz(&map, "log_name");
+    rc |= cbor_encode_text_stringz(&map, "stream");
+    rc |= cbor_encode_text_stringz(&map, "ts");
+    rc |= cbor_encode_int(&map, 0);
+    rc |= cbor_encode_text_stringz(&map, "index");
+    rc |= cbor_encode_uint(&map, 0);
+    rc |= cbor_encoder_close_container(&enc, &map);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    newtmgr_test_util_req(NMGR_OP_READ, MGMT_GROUP_ID_LOGS, LOGS_NMGR_OP_READ,
+                          flags, buf,
+                          cbor_buf_writer_buffer_size(&writer, buf));
+}
+
+/*
+ * Counts the entries in a log read response, checking that they come in
+ * order.
+ */
+static int
+newtmgr_test_log_entries(const uint8_t *rsp, int len)
+{
+    struct cbor_buf_reader reader;
+    CborParser parser;
+    CborValue entries;
+    CborValue entry;
+    CborValue root;
+    CborValue logs;
+    CborValue log;
+    CborValue val;
+    char msg[16];
+    size_t msg_len;
+    int count;
+    int rc;
+
+    cbor_buf_reader_init(&reader, rsp, len);
+    rc = cbor_parser_init(&reader.r, 0, &parser, &root);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = cbor_value_map_find_value(&root, "logs", &logs);
+    TEST_ASSERT_FATAL(rc == 0 && cbor_value_is_array(&logs));
+    rc = cbor_value_enter_container(&logs, &log);
+    TEST_ASSERT_FATAL(rc == 0 && cbor_value_is_map(&log));
+    rc = cbor_value_map_find_value(&log, "entries", &entries);
+    TEST_ASSERT_FATAL(rc == 0 && cbor_value_is_array(&entries));
+    rc = cbor_value_enter_container(&entries, &entry);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    for (count = 0; !cbor_value_at_end(&entry); count++) {
+        rc = cbor_value_map_find_value(&entry, "msg", &val);
+        TEST_ASSERT_FATAL(rc == 0 && cbor_value_is_text_string(&val));
+        msg_len = sizeof msg;
+        rc = cbor_value_copy_text_string(&val, msg, &msg_len, NULL);
+        TEST_ASSERT_FATAL(rc == 0);
+        TEST_ASSERT(atoi(msg + strlen("entry ")) == count);
+
+        rc = cbor_value_advance(&entry);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+
+    return count;
+}
+
+TEST_CASE(newtmgr_test_case_stream_log)
+{
+    static uint8_t rsp[NEWTMGR_TEST_RSP_MAX];
+    int count;
+    int len;
+    int rc;
+    int i;
+
+    newtmgr_test_util_init();
+
+    cbmem_init(&newtmgr_test_cbmem, newtmgr_test_cbmem_buf,
+               sizeof newtmgr_test_cbmem_buf);
+    rc = log_register("stream", &newtmgr_test_log, &log_cbmem_handler,
+                      &newtmgr_test_cbmem, LOG_SYSLEVEL);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    for (i = 0; i < NEWTMGR_TEST_LOG_ENTRIES; i++) {
+        log_printf(&newtmgr_test_log, LOG_MODULE_DEFAULT, LOG_LEVEL_INFO,
+                   "entry %03d", i);
+    }
+
+    /*** A plain read returns a page of the log. */
+    newtmgr_test_log_req(0);
+    len = newtmgr_test_util_rsp(rsp, sizeof rsp);
+    count = newtmgr_test_log_entries(rsp, len);
+    TEST_ASSERT(count > 0 && count < NEWTMGR_TEST_LOG_ENTRIES);
+
+    /*** A streamed read returns all of it. */
+    newtmgr_test_log_req(NMGR_F_STREAM);
+    TEST_ASSERT(newtmgr_test_num_pkts > 1);
+    len = newtmgr_test_util_stream_rsp(rsp, sizeof rsp);
+    count = newtmgr_test_log_entries(rsp, len);
+    TEST_ASSERT(count == NEWTMGR_TEST_LOG_ENTRIES);
+}
@@ -27,12 +27,44 @@
 #include <uart/uart.h>
 
 #include <crc/crc16.h>
-#include <base64/base64.h>
+#include <base64/base64_stream.h>
 
 #define SHELL_NLIP_PKT          0x0609
 #define SHELL_NLIP_DATA         0x0414
 #define SHELL_NLIP_MAX_FRAME    128
 
+/*
+ * Raw bytes per base64 line: a multiple of 3, so that every line but the
+ * last is whole groups, and few enough that a line stays under 124
+ * characters.
+ */
+#define NMGR_UART_B64_LINE      84
+
+/*
+ * Binary frames are COBS encoded, and both preceded and followed by a zero
+ * byte:
+ *
+ *     0x00 COBS(<newtmgr packet> <crc16>) 0x00
+ *
+ * A zero byte never appears in a base64 line, so both framings can share
+ * the line.  The response goes out with the framing of the request; a
+ * client negotiates binary framing by sending its first request in a
+ * binary frame, and falls back to base64 if no binary response comes.
+ */
+#define NMGR_UART_COBS_DELIM    0x00
+#define NMGR_UART_COBS_MAX_RUN  254
+
+#define NMGR_UART_RX_BUF_SZ     MYNEWT_VAL(NMGR_UART_RX_BUF_SIZE)
+#define NMGR_UART_RX_BUF_MASK   (NMGR_UART_RX_BUF_SZ - 1)
+
+#if (NMGR_UART_RX_BUF_SZ & NMGR_UART_RX_BUF_MASK) != 0
+#error "NMGR_UART_RX_BUF_SIZE must be a power of 2"
+#endif
+
+/* What the receiver is in the middle of. */
+#define NMGR_UART_RX_LINE       0
+#define NMGR_UART_RX_BIN        1
+
 #define NUS_EV_TO_STATE(ptr)                                            \
     (struct nmgr_uart_state *)((uint8_t *)ptr -                         \
       (int)&(((struct nmgr_uart_state *)0)->nus_cb_ev))
@@ -44,16 +76,27 @@ struct nmgr_uart_state {
     struct os_mbuf *nus_tx;
     int nus_tx_off;
     struct os_mbuf_pkthdr *nus_rx_pkt;
-    struct os_mbuf_pkthdr *nus_rx_q;
     struct os_mbuf_pkthdr *nus_rx;
-};
 
-/*
- * Header for frames arriving over serial.
- */
-struct nmgr_ser_hdr {
-    uint16_t nsh_seq;
-    uint16_t nsh_len;
+    /*
+     * Bytes from the UART.  The interrupt handler only stores them here; the
+     * framing is taken apart a run at a time in task context.
+     */
+    uint8_t nus_rx_buf[NMGR_UART_RX_BUF_SZ];
+    volatile uint16_t nus_rx_head;
+    volatile uint16_t nus_rx_tail;
+    volatile uint8_t nus_rx_stalled;
+
+    /* Receiver state; task context only. */
+    uint8_t nus_rx_drop:1;
+    uint8_t nus_rx_state:1;
+#if MYNEWT_VAL(NMGR_UART_BINARY)
+    /* Respond with binary frames. */
+    uint8_t nus_binary:1;
+    uint8_t nus_bin_started:1;
+    uint8_t nus_cobs_zero:1;
+    uint8_t nus_cobs_left;
+#endif
 };
 
 static struct nmgr_uart_state nmgr_uart_state;
@@ -65,50 +108,28 @@ nmgr_uart_mtu(struct os_mbuf *m)
 }
 
 /*
- * Called by mgmt to queue packet out to UART.
+ * Base64 encodes a packet, with its CRC, into NLIP lines.
  */
-static int
-nmgr_uart_out(struct nmgr_transport *nt, struct os_mbuf *m)
+static struct os_mbuf *
+nmgr_uart_encode_b64(struct os_mbuf *m)
 {
-    struct nmgr_uart_state *nus = (struct nmgr_uart_state *)nt;
+    struct base64_encoder enc;
     struct os_mbuf_pkthdr *mpkt;
     struct os_mbuf *n;
-    uint16_t tmp_buf[6];
-    char *dst;
+    uint16_t tmp_buf[2];
     int off;
-    int boff;
-    int slen;
-    int sr;
+    int len;
     int rc;
-    int last;
-    int tx_sz;
 
-    assert(OS_MBUF_IS_PKTHDR(m));
     mpkt = OS_MBUF_PKTHDR(m);
-
-    /*
-     * Compute CRC-16 and append it to end.
-     */
     off = 0;
-    tmp_buf[0] = CRC16_INITIAL_CRC;
-    for (n = m; n; n = SLIST_NEXT(n, om_next)) {
-        tmp_buf[0] = crc16_ccitt(tmp_buf[0], n->om_data, n->om_len);
-    }
-    tmp_buf[0] = htons(tmp_buf[0]);
-    dst = os_mbuf_extend(m, sizeof(uint16_t));
-    if (!dst) {
-        goto err;
-    }
-    memcpy(dst, tmp_buf, sizeof(uint16_t));
 
-    /*
-     * Create another mbuf chain with base64 encoded data.
-     */
     n = os_msys_get(SHELL_NLIP_MAX_FRAME, 0);
-    if (!n || OS_MBUF_TRAILINGSPACE(n) < 32) {
-        goto err;
+    if (!n) {
+        return NULL;
     }
 
+    base64_encoder_init(&enc, 1);
     while (off < mpkt->omp_len) {
         /*
          * First fragment has a different header, and length of the full frame
@@ -116,44 +137,35 @@ nmgr_uart_out(struct nmgr_transport *nt, struct os_mbuf *m)
          */
         if (off == 0) {
             tmp_buf[0] = htons(SHELL_NLIP_PKT);
+            tmp_buf[1] = htons(mpkt->omp_len);
+            len = NMGR_UART_B64_LINE - sizeof(uint16_t);
         } else {
             tmp_buf[0] = htons(SHELL_NLIP_DATA);
+            len = NMGR_UART_B64_LINE;
         }
         rc = os_mbuf_append(n, tmp_buf, sizeof(uint16_t));
         if (rc) {
             goto err;
         }
-        tx_sz = 2;
-
         if (off == 0) {
-            tmp_buf[0] = htons(mpkt->omp_len);
-            boff = sizeof(uint16_t);
-        } else {
-            boff = 0;
-        }
-
-        while (off < mpkt->omp_len) {
-            slen = mpkt->omp_len - off;
-            last = 1;
-            if (slen > sizeof(tmp_buf) + boff) {
-                slen = sizeof(tmp_buf) - boff;
-                last = 0;
-            }
-            if (tx_sz + BASE64_ENCODE_SIZE(slen + boff) >= 124) {
-                break;
+            rc = base64_encoder_feed(&enc, &tmp_buf[1], sizeof(uint16_t), n);
+            if (rc) {
+                goto err;
             }
-            rc = os_mbuf_copydata(m, off, slen, (uint8_t *)tmp_buf + boff);
-            assert(rc == 0);
-
-            off += slen;
-            slen += boff;
+        }
 
-            dst = os_mbuf_extend(n, BASE64_ENCODE_SIZE(slen));
-            if (!dst) {
+        /* Straight from the packet's mbufs into the line. */
+        len = min(len, mpkt->omp_len - off);
+        rc = base64_encoder_feed_mbuf(&enc, m, off, len, n);
+        if (rc) {
+            goto err;
+        }
+        off += len;
+        if (off == mpkt->omp_len) {
+            rc = base64_encoder_finish(&enc, n);
+            if (rc) {
                 goto err;
             }
-            tx_sz += base64_encode(tmp_buf, slen, dst, last);
-            boff = 0;
         }
 
         if (os_mbuf_append(n, "\n", 1)) {
@@ -161,6 +173,119 @@ nmgr_uart_out(struct nmgr_transport *nt, struct os_mbuf *m)
         }
     }
 
+    return n;
+err:
+    os_mbuf_free_chain(n);
+    return NULL;
+}
+
+#if MYNEWT_VAL(NMGR_UART_BINARY)
+/*
+ * COBS encodes a packet, with its CRC, into a binary frame.
+ */
+static struct os_mbuf *
+nmgr_uart_encode_bin(struct os_mbuf *m)
+{
+    uint8_t run[NMGR_UART_COBS_MAX_RUN + 1];
+    struct os_mbuf *n;
+    uint8_t delim;
+    uint8_t *src;
+    int run_len;
+    int len;
+    int i;
+
+    n = os_msys_get(SHELL_NLIP_MAX_FRAME, 0);
+    if (!n) {
+        return NULL;
+    }
+
+    delim = NMGR_UART_COBS_DELIM;
+    if (os_mbuf_append(n, &delim, 1)) {
+        goto err;
+    }
+
+    /*
+     * run[0] is the code byte: the distance to the next zero, or
+     * 0xff for a full run of non-zero bytes.
+     */
+    run_len = 0;
+    for (; m; m = SLIST_NEXT(m, om_next)) {
+        src = m->om_data;
+        len = m->om_len;
+        for (i = 0; i < len; i++) {
+            if (src[i] != 0) {
+                run[++run_len] = src[i];
+                if (run_len < NMGR_UART_COBS_MAX_RUN) {
+                    continue;
+                }
+            }
+            run[0] = run_len + 1;
+            if (os_mbuf_append(n, run, run_len + 1)) {
+                goto err;
+            }
+            run_len = 0;
+        }
+    }
+    run[0] = run_len + 1;
+    if (os_mbuf_append(n, run, run_len + 1)) {
+        goto err;
+    }
+
+    if (os_mbuf_append(n, &delim, 1)) {
+        goto err;
+    }
+
+    return n;
+err:
+    os_mbuf_free_chain(n);
+    return NULL;
+}
+#endif
+
+/*
+ * Called by mgmt to queue packet out to UART.
+ */
+static int
+nmgr_uart_out(struct nmgr_transport *nt, struct os_mbuf *m)
+{
+    struct nmgr_uart_state *nus = (struct nmgr_uart_state *)nt;
+    struct os_mbuf *n;
+    uint16_t crc;
+    char *dst;
+    int sr;
+
+    assert(OS_MBUF_IS_PKTHDR(m));
+    n = NULL;
+
+    /*
+     * Compute CRC-16 and append it to end.
+     */
+    crc = CRC16_INITIAL_CRC;
+    for (n = m; n; n = SLIST_NEXT(n, om_next)) {
+        crc = crc16_ccitt(crc, n->om_data, n->om_len);
+    }
+    crc = htons(crc);
+    dst = os_mbuf_extend(m, sizeof(uint16_t));
+    if (!dst) {
+        goto err;
+    }
+    memcpy(dst, &crc, sizeof(uint16_t));
+
+    /*
+     * Create another mbuf chain with the encoded data.
+     */
+#if MYNEWT_VAL(NMGR_UART_BINARY)
+    if (nus->nus_binary) {
+        n = nmgr_uart_encode_bin(m);
+    } else
+#endif
+    {
+        n = nmgr_uart_encode_b64(m);
+    }
+    if (!n) {
+        goto err;
+    }
+
     os_mbuf_free_chain(m);
     OS_ENTER_CRITICAL(sr);
     if (!nus->nus_tx) {
@@ -221,8 +346,11 @@ nmgr_uart_tx_char(void *arg)
 static void
 nmgr_uart_rx_pkt(struct nmgr_uart_state *nus, struct os_mbuf_pkthdr *rxm)
 {
+    struct base64_decoder dec;
     struct os_mbuf *m;
-    struct nmgr_ser_hdr *nsh;
+    struct os_mbuf *pkt;
+    uint16_t seq;
+    uint16_t len;
     uint16_t crc;
     int rc;
 
@@ -232,8 +360,10 @@ nmgr_uart_rx_pkt(struct nmgr_uart_state *nus, struct os_mbuf_pkthdr *rxm)
         goto err;
     }
 
-    nsh = (struct nmgr_ser_hdr *)m->om_data;
-    switch (nsh->nsh_seq) {
+    if (os_mbuf_copydata(m, 0, sizeof(seq), &seq)) {
+        goto err;
+    }
+    switch (seq) {
     case htons(SHELL_NLIP_PKT):
         if (nus->nus_rx_pkt) {
             os_mbuf_free_chain(OS_MBUF_PKTHDR_TO_MBUF(nus->nus_rx_pkt));
@@ -249,45 +379,267 @@ nmgr_uart_rx_pkt(struct nmgr_uart_state *nus, struct os_mbuf_pkthdr *rxm)
         goto err;
     }
 
-    if (os_mbuf_append(m, "\0", 1)) {
-        /*
-         * Null-terminate the line for base64_decode's sake.
-         */
-        goto err;
-    }
-    m = os_mbuf_pullup(m, rxm->omp_len);
-    if (!m) {
-        /*
-         * Make data contiguous for base64_decode's sake.
-         */
-        goto err;
+    if (!nus->nus_rx_pkt) {
+        pkt = os_msys_get_pkthdr(SHELL_NLIP_MAX_FRAME, 0);
+        if (!pkt) {
+            goto err;
+        }
+        nus->nus_rx_pkt = OS_MBUF_PKTHDR(pkt);
     }
-    rxm = OS_MBUF_PKTHDR(m);
-    rc = base64_decode((char *)m->om_data + 2, (char *)m->om_data + 2);
-    if (rc < 0) {
-        goto err;
+    pkt = OS_MBUF_PKTHDR_TO_MBUF(nus->nus_rx_pkt);
+
+    /*
+     * Decode the line, where it sits in the receive mbufs, onto the end
+     * of the packet.  Each line is padded on its own.
+     */
+    base64_decoder_init(&dec);
+    rc = base64_decoder_feed_mbuf(&dec, m, sizeof(seq),
+                                  rxm->omp_len - sizeof(seq), pkt);
+    if (rc == 0) {
+        rc = base64_decoder_finish(&dec, pkt);
     }
-    rxm->omp_len = m->om_len = rc + 2;
-    if (nus->nus_rx_pkt) {
-        os_mbuf_adj(m, 2);
-        os_mbuf_concat(OS_MBUF_PKTHDR_TO_MBUF(nus->nus_rx_pkt), m);
-    } else {
-        nus->nus_rx_pkt = rxm;
+    os_mbuf_free_chain(m);
+    if (rc != 0) {
+        goto err_pkt;
     }
 
-    m = OS_MBUF_PKTHDR_TO_MBUF(nus->nus_rx_pkt);
-    nsh = (struct nmgr_ser_hdr *)m->om_data;
-    if (nus->nus_rx_pkt->omp_len - sizeof(*nsh) == ntohs(nsh->nsh_len)) {
-        os_mbuf_adj(m, 4);
-        os_mbuf_adj(m, -2);
-        nmgr_rx_req(&nus->nus_transport, m);
+    if (nus->nus_rx_pkt->omp_len < sizeof(len)) {
+        return;
+    }
+    os_mbuf_copydata(pkt, 0, sizeof(len), &len);
+    len = ntohs(len);
+    if (nus->nus_rx_pkt->omp_len - sizeof(len) > len) {
+        goto err_pkt;
+    }
+    if (nus->nus_rx_pkt->omp_len - sizeof(len) == len) {
+        os_mbuf_adj(pkt, sizeof(len));
+        os_mbuf_adj(pkt, -(int)sizeof(crc));
+#if MYNEWT_VAL(NMGR_UART_BINARY)
+        nus->nus_binary = 0;
+#endif
         nus->nus_rx_pkt = NULL;
+        nmgr_rx_req(&nus->nus_transport, pkt);
     }
     return;
+err_pkt:
+    os_mbuf_free_chain(pkt);
+    nus->nus_rx_pkt = NULL;
+    return;
 err:
     os_mbuf_free_chain(m);
 }
 
+/*
+ * Adds received bytes to the frame being assembled.  If it does not fit,
+ * the rest of the frame is dropped.
+ */
+static void
+nmgr_uart_rx_append(struct nmgr_uart_state *nus, const uint8_t *data, int len)
+{
+    struct os_mbuf *m;
+
+    if (nus->nus_rx_drop || len == 0) {
+        return;
+    }
+
+    if (!nus->nus_rx) {
+        m = os_msys_get_pkthdr(SHELL_NLIP_MAX_FRAME, 0);
+        if (!m) {
+            nus->nus_rx_drop = 1;
+            return;
+        }
+        nus->nus_rx = OS_MBUF_PKTHDR(m);
+    }
+
+    m = OS_MBUF_PKTHDR_TO_MBUF(nus->nus_rx);
+    if (nus->nus_rx->omp_len + len > MGMT_MAX_MTU + sizeof(uint16_t) ||
+        os_mbuf_append(m, data, len)) {
+        os_mbuf_free_chain(m);
+        nus->nus_rx = NULL;
+        nus->nus_rx_drop = 1;
+    }
+}
+
+/*
+ * Ends the frame being assembled, and hands it to the caller.
+ */
+static struct os_mbuf_pkthdr *
+nmgr_uart_rx_take(struct nmgr_uart_state *nus)
+{
+    struct os_mbuf_pkthdr *rxm;
+
+    rxm = nus->nus_rx;
+    nus->nus_rx = NULL;
+    if (nus->nus_rx_drop) {
+        nus->nus_rx_drop = 0;
+        if (rxm) {
+            os_mbuf_free_chain(OS_MBUF_PKTHDR_TO_MBUF(rxm));
+        }
+        return NULL;
+    }
+
+    return rxm;
+}
+
+#if MYNEWT_VAL(NMGR_UART_BINARY)
+/*
+ * Checks a decoded binary frame, and passes it to newtmgr.
+ */
+static void
+nmgr_uart_rx_bin_pkt(struct nmgr_uart_state *nus, struct os_mbuf_pkthdr *rxm)
+{
+    struct os_mbuf *m;
+    struct os_mbuf *n;
+    uint16_t crc;
+
+    m = OS_MBUF_PKTHDR_TO_MBUF(rxm);
+    if (rxm->omp_len <= sizeof(crc)) {
+        goto err;
+    }
+
+    /* The CRC of a packet followed by its CRC is 0. */
+    crc = CRC16_INITIAL_CRC;
+    for (n = m; n; n = SLIST_NEXT(n, om_next)) {
+        crc = crc16_ccitt(crc, n->om_data, n->om_len);
+    }
+    if (crc != 0) {
+        goto err;
+    }
+    os_mbuf_adj(m, -(int)sizeof(crc));
+
+    nus->nus_binary = 1;
+    nmgr_rx_req(&nus->nus_transport, m);
+    return;
+err:
+    os_mbuf_free_chain(m);
+}
+
+/*
+ * Decodes a run of bytes from a binary frame.
+ *
+ * @return                      The number of bytes consumed; fewer than
+ *                                  `len` if the frame ended.
+ */
+static int
+nmgr_uart_rx_bin(struct nmgr_uart_state *nus, const uint8_t *data, int len)
+{
+    struct os_mbuf_pkthdr *rxm;
+    const uint8_t *end;
+    uint8_t zero;
+    int off;
+    int n;
+
+    off = 0;
+    while (off < len) {
+        if (data[off] == NMGR_UART_COBS_DELIM) {
+            off++;
+            if (!nus->nus_bin_started) {
+                /* Leading delimiter, or a gap between frames. */
+                continue;
+            }
+            if (nus->nus_cobs_left != 0) {
+                /* Truncated run. */
+                nus->nus_rx_drop = 1;
+            }
+            nus->nus_rx_state = NMGR_UART_RX_LINE;
+            rxm = nmgr_uart_rx_take(nus);
+            if (rxm) {
+                nmgr_uart_rx_bin_pkt(nus, rxm);
+            }
+            return off;
+        }
+        nus->nus_bin_started = 1;
+
+        if (nus->nus_cobs_left == 0) {
+            /* Code byte; the previous run ended with a zero unless full. */
+            if (nus->nus_cobs_zero) {
+                zero = 0;
+                nmgr_uart_rx_append(nus, &zero, 1);
+            }
+            nus->nus_cobs_left = data[off] - 1;
+            nus->nus_cobs_zero = data[off] != NMGR_UART_COBS_MAX_RUN + 1;
+            off++;
+            continue;
+        }
+
+        /* Data bytes; copy as much of the run as has arrived. */
+        n = len - off;
+        if (n > nus->nus_cobs_left) {
+            n = nus->nus_cobs_left;
+        }
+        end = memchr(data + off, NMGR_UART_COBS_DELIM, n);
+        if (end) {
+            n = end - (data + off);
+        }
+        nmgr_uart_rx_append(nus, data + off, n);
+        nus->nus_cobs_left -= n;
+        off += n;
+    }
+
+    return off;
+}
+#endif
+
+/*
+ * Takes apart a run of bytes from the UART.
+ */
+static void
+nmgr_uart_rx_bytes(struct nmgr_uart_state *nus, const uint8_t *data, int len)
+{
+    struct os_mbuf_pkthdr *rxm;
+    int off;
+    int n;
+
+    off = 0;
+    while (off < len) {
+#if MYNEWT_VAL(NMGR_UART_BINARY)
+        if (nus->nus_rx_state == NMGR_UART_RX_BIN) {
+            off += nmgr_uart_rx_bin(nus, data + off, len - off);
+            continue;
+        }
+#endif
+
+        for (n = off; n < len; n++) {
+            if (data[n] == '\n') {
+                break;
+            }
+#if MYNEWT_VAL(NMGR_UART_BINARY)
+            if (data[n] == NMGR_UART_COBS_DELIM) {
+                break;
+            }
+#endif
+        }
+        nmgr_uart_rx_append(nus, data + off, n - off);
+        off = n;
+        if (off == len) {
+            break;
+        }
+
+        rxm = nmgr_uart_rx_take(nus);
+#if MYNEWT_VAL(NMGR_UART_BINARY)
+        if (data[off] == NMGR_UART_COBS_DELIM) {
+            /* Start of a binary frame; whatever came before is noise. */
+            if (rxm) {
+                os_mbuf_free_chain(OS_MBUF_PKTHDR_TO_MBUF(rxm));
+            }
+            nus->nus_rx_state = NMGR_UART_RX_BIN;
+            nus->nus_bin_started = 0;
+            nus->nus_cobs_left = 0;
+            nus->nus_cobs_zero = 0;
+            off++;
+            continue;
+        }
+#endif
+        /*
+         * Full line of input.
+         */
+        off++;
+        if (rxm) {
+            nmgr_uart_rx_pkt(nus, rxm);
+        }
+    }
+}
+
 /*
  * Callback from mgmt task context.
  */
@@ -295,15 +647,34 @@ static void
 nmgr_uart_rx_frame(struct os_event *ev)
 {
     struct nmgr_uart_state *nus = NUS_EV_TO_STATE(ev);
-    struct os_mbuf_pkthdr *m;
+    uint16_t head;
+    uint16_t tail;
+    int len;
     int sr;
 
+    head = nus->nus_rx_head;
+    tail = nus->nus_rx_tail;
+    while (tail != head) {
+        /* The bytes up to the head, or the end of the buffer. */
+        len = (uint16_t)(head - tail);
+        if (len > NMGR_UART_RX_BUF_SZ - (tail & NMGR_UART_RX_BUF_MASK)) {
+            len = NMGR_UART_RX_BUF_SZ - (tail & NMGR_UART_RX_BUF_MASK);
+        }
+        nmgr_uart_rx_bytes(nus, &nus->nus_rx_buf[tail & NMGR_UART_RX_BUF_MASK],
+                           len);
+        tail += len;
+        nus->nus_rx_tail = tail;
+
+        head = nus->nus_rx_head;
+    }
+
     OS_ENTER_CRITICAL(sr);
-    m = nus->nus_rx_q;
-    nus->nus_rx_q = NULL;
-    OS_EXIT_CRITICAL(sr);
-    if (m) {
-        nmgr_uart_rx_pkt(nus, m);
+    if (nus->nus_rx_stalled) {
+        nus->nus_rx_stalled = 0;
+        OS_EXIT_CRITICAL(sr);
+        uart_start_rx(nus->nus_dev);
+    } else {
+        OS_EXIT_CRITICAL(sr);
     }
 }
 
@@ -314,46 +685,27 @@ static int
 nmgr_uart_rx_char(void *arg, uint8_t data)
 {
     struct nmgr_uart_state *nus = (struct nmgr_uart_state *)arg;
-    struct os_mbuf *m;
-    int rc;
+    uint16_t used;
 
-    if (!nus->nus_rx) {
-        m = os_msys_get_pkthdr(SHELL_NLIP_MAX_FRAME, 0);
-        if (!m) {
-            return 0;
-        }
-        nus->nus_rx = OS_MBUF_PKTHDR(m);
-        if (OS_MBUF_TRAILINGSPACE(m) < SHELL_NLIP_MAX_FRAME) {
-            /*
-             * mbuf is too small.
-             */
-            os_mbuf_free_chain(m);
-            nus->nus_rx = NULL;
-            return 0;
-        }
-    }
-
-    m = OS_MBUF_PKTHDR_TO_MBUF(nus->nus_rx);
-    if (data == '\n') {
+    used = (uint16_t)(nus->nus_rx_head - nus->nus_rx_tail);
+    if (used == NMGR_UART_RX_BUF_SZ) {
         /*
-         * Full line of input. Process it outside interrupt context.
+         * Full.  The driver holds on to the byte until the task catches up
+         * and calls uart_start_rx().
          */
-        assert(!nus->nus_rx_q);
-        nus->nus_rx_q = nus->nus_rx;
-        nus->nus_rx = NULL;
+        nus->nus_rx_stalled = 1;
+        return -1;
+    }
+
+    nus->nus_rx_buf[nus->nus_rx_head & NMGR_UART_RX_BUF_MASK] = data;
+    nus->nus_rx_head++;
+
+    /*
+     * Wake the task at the end of a frame, or when the buffer is half full.
+     */
+    if (data == '\n' || data == 0 || used + 1 == NMGR_UART_RX_BUF_SZ / 2) {
         os_eventq_put(mgmt_evq_get(), &nus->nus_cb_ev);
-        return 0;
-    } else {
-        rc = os_mbuf_append(m, &data, 1);
-        if (rc == 0) {
-            return 0;
-        }
     }
-    /* failed */
-    nus->nus_rx->omp_len = 0;
-    m->om_len = 0;
-    os_mbuf_free_chain(SLIST_NEXT(m, om_next));
-    SLIST_NEXT(m, om_next) = NULL;
     return 0;
 }
 
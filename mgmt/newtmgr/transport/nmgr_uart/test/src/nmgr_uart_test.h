@@ -0,0 +1,51 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_NMGR_UART_TEST_
+#define H_NMGR_UART_TEST_
+
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Largest echo request payload. */
+#define NMGR_UART_TEST_DATA_MAX     768
+
+/** Bytes moved over the UART, in both directions, since the last reset. */
+extern int nmgr_uart_test_wire_bytes;
+
+void nmgr_uart_test_util_init(void);
+int nmgr_uart_test_util_echo(int binary, const uint8_t *data, int len);
+int nmgr_uart_test_util_enc_b64(const uint8_t *pkt, int len, uint8_t *dst);
+int nmgr_uart_test_util_enc_bin(const uint8_t *pkt, int len, uint8_t *dst);
+void nmgr_uart_test_util_rx(const uint8_t *data, int len);
+int nmgr_uart_test_util_tx_take(uint8_t *dst, int max);
+
+TEST_SUITE_DECL(nmgr_uart_test_suite);
+TEST_CASE_DECL(nmgr_uart_test_case_frame);
+TEST_CASE_DECL(nmgr_uart_test_case_bench);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
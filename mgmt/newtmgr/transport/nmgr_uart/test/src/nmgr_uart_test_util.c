@@ -0,0 +1,440 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "os/mynewt.h"
+#include "uart/uart.h"
+#include "mgmt/mgmt.h"
+#include "newtmgr/newtmgr.h"
+#include "cborattr/cborattr.h"
+#include "tinycbor/cbor_buf_writer.h"
+#include "base64/base64.h"
+#include "crc/crc16.h"
+#include "nmgr_uart_test.h"
+
+#define NMGR_UART_TEST_NLIP_PKT     0x0609
+#define NMGR_UART_TEST_NLIP_DATA    0x0414
+
+/* Raw bytes per base64 line; a multiple of 3, so lines decode on their own. */
+#define NMGR_UART_TEST_LINE_RAW     90
+
+#define NMGR_UART_TEST_FRAME_MAX    2048
+
+int nmgr_uart_test_wire_bytes;
+
+/*
+ * A UART which hands transmitted bytes straight to the test, and whose
+ * receive interrupt is driven by the test.
+ */
+static struct uart_dev nmgr_uart_test_dev;
+static struct uart_conf nmgr_uart_test_conf;
+static uint8_t nmgr_uart_test_tx[NMGR_UART_TEST_FRAME_MAX];
+static int nmgr_uart_test_tx_len;
+
+static void
+nmgr_uart_test_dev_start_tx(struct uart_dev *dev)
+{
+    int c;
+
+    while ((c = nmgr_uart_test_conf.uc_tx_char(
+                    nmgr_uart_test_conf.uc_cb_arg)) >= 0) {
+        TEST_ASSERT_FATAL(nmgr_uart_test_tx_len < sizeof nmgr_uart_test_tx);
+        nmgr_uart_test_tx[nmgr_uart_test_tx_len++] = c;
+        nmgr_uart_test_wire_bytes++;
+    }
+}
+
+static void
+nmgr_uart_test_dev_start_rx(struct uart_dev *dev)
+{
+}
+
+static int
+nmgr_uart_test_dev_open(struct os_dev *dev, uint32_t wait, void *arg)
+{
+    memcpy(&nmgr_uart_test_conf, arg, sizeof nmgr_uart_test_conf);
+    return 0;
+}
+
+static int
+nmgr_uart_test_dev_init(struct os_dev *odev, void *arg)
+{
+    struct uart_dev *dev;
+
+    dev = (struct uart_dev *)odev;
+    OS_DEV_SETHANDLERS(odev, nmgr_uart_test_dev_open, NULL);
+    dev->ud_funcs.uf_start_tx = nmgr_uart_test_dev_start_tx;
+    dev->ud_funcs.uf_start_rx = nmgr_uart_test_dev_start_rx;
+
+    return 0;
+}
+
+/*
+ * Echoes the "d" field of the request.
+ */
+static int
+nmgr_uart_test_echo(struct mgmt_cbuf *cb)
+{
+    static uint8_t data[NMGR_UART_TEST_DATA_MAX];
+    size_t len;
+    const struct cbor_attr_t attrs[] = {
+        {
+            .attribute = "d",
+            .type = CborAttrByteStringType,
+            .addr.bytestring.data = data,
+            .addr.bytestring.len = &len,
+            .len = sizeof data,
+        },
+        { 0 },
+    };
+    CborError err;
+    int rc;
+
+    len = 0;
+    rc = cbor_read_object(&cb->it, attrs);
+    if (rc != 0) {
+        return MGMT_ERR_EINVAL;
+    }
+
+    err = cbor_encode_text_stringz(&cb->encoder, "d");
+    err |= cbor_encode_byte_string(&cb->encoder, data, len);
+    if (err != 0) {
+        return MGMT_ERR_ENOMEM;
+    }
+
+    return 0;
+}
+
+static const struct mgmt_handler nmgr_uart_test_handlers[] = {
+    [0] = {
+        .mh_read = NULL,
+        .mh_write = nmgr_uart_test_echo,
+    },
+};
+
+static struct mgmt_group nmgr_uart_test_group = {
+    .mg_handlers = (struct mgmt_handler *)nmgr_uart_test_handlers,
+    .mg_handlers_count = 1,
+    .mg_group_id = MGMT_GROUP_ID_PERUSER,
+};
+
+static void
+nmgr_uart_test_util_run(void)
+{
+    struct os_event *ev;
+
+    while ((ev = os_eventq_get_no_wait(mgmt_evq_get())) != NULL) {
+        ev->ev_cb(ev);
+    }
+}
+
+void
+nmgr_uart_test_util_init(void)
+{
+    static int initialized;
+    int rc;
+
+    if (!initialized) {
+        rc = os_dev_create(&nmgr_uart_test_dev.ud_dev,
+                           MYNEWT_VAL(NMGR_UART), OS_DEV_INIT_PRIMARY, 0,
+                           nmgr_uart_test_dev_init, NULL);
+        TEST_ASSERT_FATAL(rc == 0);
+        rc = os_dev_initialize_all(OS_DEV_INIT_PRIMARY);
+        TEST_ASSERT_FATAL(rc == 0);
+
+        /* Only once; a second pass would register the newtmgr groups
+         * again.
+         */
+        sysinit();
+
+        rc = mgmt_group_register(&nmgr_uart_test_group);
+        TEST_ASSERT_FATAL(rc == 0);
+        initialized = 1;
+    }
+
+    nmgr_uart_test_tx_len = 0;
+    nmgr_uart_test_wire_bytes = 0;
+}
+
+/**
+ * Feeds bytes to the transport, as the UART receive interrupt would, and
+ * runs the newtmgr task until it is idle.
+ */
+void
+nmgr_uart_test_util_rx(const uint8_t *data, int len)
+{
+    int i;
+
+    for (i = 0; i < len; i++) {
+        while (nmgr_uart_test_conf.uc_rx_char(nmgr_uart_test_conf.uc_cb_arg,
+                                              data[i]) != 0) {
+            /* Receive buffer full; let the task catch up. */
+            nmgr_uart_test_util_run();
+        }
+    }
+    nmgr_uart_test_wire_bytes += len;
+
+    nmgr_uart_test_util_run();
+}
+
+/**
+ * Takes the bytes transmitted so far.
+ *
+ * @return                      The number of bytes.
+ */
+int
+nmgr_uart_test_util_tx_take(uint8_t *dst, int max)
+{
+    int len;
+
+    len = nmgr_uart_test_tx_len;
+    TEST_ASSERT_FATAL(len <= max);
+    memcpy(dst, nmgr_uart_test_tx, len);
+    nmgr_uart_test_tx_len = 0;
+
+    return len;
+}
+
+static void
+nmgr_uart_test_util_put16(uint8_t *dst, uint16_t val)
+{
+    dst[0] = val >> 8;
+    dst[1] = val;
+}
+
+/**
+ * Frames a packet as base64 lines, the way newtmgr does over a serial line.
+ *
+ * @return                      The size of the frame.
+ */
+int
+nmgr_uart_test_util_enc_b64(const uint8_t *pkt, int len, uint8_t *dst)
+{
+    static uint8_t raw[NMGR_UART_TEST_FRAME_MAX];
+    int raw_len;
+    int dlen;
+    int off;
+    int n;
+
+    nmgr_uart_test_util_put16(raw, len + 2);
+    memcpy(raw + 2, pkt, len);
+    nmgr_uart_test_util_put16(raw + 2 + len,
+                              crc16_ccitt(CRC16_INITIAL_CRC, pkt, len));
+    raw_len = len + 4;
+
+    dlen = 0;
+    for (off = 0; off < raw_len; off += n) {
+        nmgr_uart_test_util_put16(dst + dlen, off == 0 ?
+                                      NMGR_UART_TEST_NLIP_PKT :
+                                      NMGR_UART_TEST_NLIP_DATA);
+        dlen += 2;
+
+        n = raw_len - off;
+        if (n > NMGR_UART_TEST_LINE_RAW) {
+            n = NMGR_UART_TEST_LINE_RAW;
+        }
+        dlen += base64_encode(raw + off, n, (char *)dst + dlen, 1);
+        dst[dlen++] = '\n';
+    }
+
+    return dlen;
+}
+
+/**
+ * Frames a packet as a binary COBS frame.
+ *
+ * @return                      The size of the frame.
+ */
+int
+nmgr_uart_test_util_enc_bin(const uint8_t *pkt, int len, uint8_t *dst)
+{
+    uint8_t crc[2];
+    int code_off;
+    int dlen;
+    int i;
+    uint8_t b;
+
+    nmgr_uart_test_util_put16(crc, crc16_ccitt(CRC16_INITIAL_CRC, pkt, len));
+
+    dst[0] = 0;
+    code_off = 1;
+    dlen = 2;
+    for (i = 0; i < len + 2; i++) {
+        b = i < len ? pkt[i] : crc[i - len];
+        if (b != 0) {
+            dst[dlen++] = b;
+            if (dlen - code_off < 0xff) {
+                continue;
+            }
+        }
+        dst[code_off] = dlen - code_off;
+        code_off = dlen++;
+    }
+    dst[code_off] = dlen - code_off;
+    dst[dlen++] = 0;
+
+    return dlen;
+}
+
+static int
+nmgr_uart_test_util_dec_b64(const uint8_t *src, int len, uint8_t *pkt)
+{
+    static uint8_t raw[NMGR_UART_TEST_FRAME_MAX];
+    char line[160];
+    int raw_len;
+    int start;
+    int off;
+    int rc;
+
+    raw_len = 0;
+    start = 0;
+    for (off = 0; off < len; off++) {
+        if (src[off] != '\n') {
+            continue;
+        }
+
+        TEST_ASSERT_FATAL(off - start - 2 < sizeof line);
+        memcpy(line, src + start + 2, off - start - 2);
+        line[off - start - 2] = '\0';
+        rc = base64_decode(line, raw + raw_len);
+        TEST_ASSERT_FATAL(rc >= 0);
+        raw_len += rc;
+        start = off + 1;
+    }
+
+    TEST_ASSERT_FATAL(raw_len >= 4);
+    TEST_ASSERT_FATAL(((raw[0] << 8) | raw[1]) == raw_len - 2);
+    TEST_ASSERT_FATAL(crc16_ccitt(CRC16_INITIAL_CRC, raw + 2,
+                                  raw_len - 2) == 0);
+
+    memcpy(pkt, raw + 2, raw_len - 4);
+    return raw_len - 4;
+}
+
+static int
+nmgr_uart_test_util_dec_bin(const uint8_t *src, int len, uint8_t *pkt)
+{
+    int plen;
+    int code;
+    int off;
+
+    TEST_ASSERT_FATAL(len >= 4 && src[0] == 0 && src[len - 1] == 0);
+
+    plen = 0;
+    off = 1;
+    while (off < len - 1) {
+        code = src[off++];
+        TEST_ASSERT_FATAL(code != 0 && off + code - 1 <= len - 1);
+        memcpy(pkt + plen, src + off, code - 1);
+        plen += code - 1;
+        off += code - 1;
+        if (code != 0xff && off < len - 1) {
+            pkt[plen++] = 0;
+        }
+    }
+
+    TEST_ASSERT_FATAL(plen >= 2);
+    TEST_ASSERT_FATAL(crc16_ccitt(CRC16_INITIAL_CRC, pkt, plen) == 0);
+
+    return plen - 2;
+}
+
+/**
+ * Sends an echo request with the specified framing, and checks the response
+ * came back in the same framing, with the same data.
+ *
+ * @return                      0 if the data was echoed; -1 if there was no
+ *                                  response.
+ */
+int
+nmgr_uart_test_util_echo(int binary, const uint8_t *data, int len)
+{
+    static uint8_t frame[NMGR_UART_TEST_FRAME_MAX];
+    static uint8_t pkt[NMGR_UART_TEST_FRAME_MAX];
+    static uint8_t rsp_data[NMGR_UART_TEST_DATA_MAX];
+    struct cbor_buf_writer writer;
+    struct nmgr_hdr hdr;
+    CborEncoder enc;
+    CborEncoder map;
+    size_t rsp_len;
+    const struct cbor_attr_t attrs[] = {
+        {
+            .attribute = "d",
+            .type = CborAttrByteStringType,
+            .addr.bytestring.data = rsp_data,
+            .addr.bytestring.len = &rsp_len,
+            .len = sizeof rsp_data,
+        },
+        { 0 },
+    };
+    int frame_len;
+    int pkt_len;
+    int rc;
+
+    memset(&hdr, 0, sizeof hdr);
+    hdr.nh_op = NMGR_OP_WRITE;
+    hdr.nh_group = htons(MGMT_GROUP_ID_PERUSER);
+    hdr.nh_id = 0;
+
+    cbor_buf_writer_init(&writer, pkt + sizeof hdr, sizeof pkt - sizeof hdr);
+    cbor_encoder_init(&enc, &writer.enc, 0);
+    rc = cbor_encoder_create_map(&enc, &map, CborIndefiniteLength);
+    rc |= cbor_encode_text_stringz(&map, "d");
+    rc |= cbor_encode_byte_string(&map, data, len);
+    rc |= cbor_encoder_close_container(&enc, &map);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    pkt_len = cbor_encode_bytes_written(&enc);
+    hdr.nh_len = htons(pkt_len);
+    memcpy(pkt, &hdr, sizeof hdr);
+    pkt_len += sizeof hdr;
+
+    if (binary) {
+        frame_len = nmgr_uart_test_util_enc_bin(pkt, pkt_len, frame);
+    } else {
+        frame_len = nmgr_uart_test_util_enc_b64(pkt, pkt_len, frame);
+    }
+    nmgr_uart_test_util_rx(frame, frame_len);
+
+    frame_len = nmgr_uart_test_util_tx_take(frame, sizeof frame);
+    if (frame_len == 0) {
+        return -1;
+    }
+
+    if (binary) {
+        TEST_ASSERT_FATAL(frame[0] == 0);
+        pkt_len = nmgr_uart_test_util_dec_bin(frame, frame_len, pkt);
+    } else {
+        TEST_ASSERT_FATAL(frame[0] != 0);
+        pkt_len = nmgr_uart_test_util_dec_b64(frame, frame_len, pkt);
+    }
+
+    TEST_ASSERT_FATAL(pkt_len >= sizeof hdr);
+    memcpy(&hdr, pkt, sizeof hdr);
+    TEST_ASSERT_FATAL(hdr.nh_op == NMGR_OP_WRITE_RSP);
+    TEST_ASSERT_FATAL(ntohs(hdr.nh_len) == pkt_len - sizeof hdr);
+
+    rsp_len = 0;
+    rc = cbor_read_flat_attrs(pkt + sizeof hdr, pkt_len - sizeof hdr, attrs);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT_FATAL(rsp_len == len);
+    TEST_ASSERT_FATAL(memcmp(rsp_data, data, len) == 0);
+
+    return 0;
+}
@@ -0,0 +1,71 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include "os/mynewt.h"
+#include "nmgr_uart_test.h"
+
+#define NMGR_UART_TEST_BENCH_REQS   64
+#define NMGR_UART_TEST_BENCH_SZ     512
+
+/*
+ * Echoes 64 requests of 512 bytes, as an image upload or log dump would
+ * move them, with each framing.  Reports the bytes on the wire, the time
+ * they take at 115200 baud, and the CPU time spent on the device side and
+ * the simulated host side together.
+ */
+TEST_CASE(nmgr_uart_test_case_bench)
+{
+    static uint8_t data[NMGR_UART_TEST_BENCH_SZ];
+    static const char *names[] = { "base64", "binary" };
+    uint32_t start;
+    uint32_t usecs;
+    int wire[2];
+    int binary;
+    int rc;
+    int i;
+
+    nmgr_uart_test_util_init();
+
+    for (i = 0; i < sizeof data; i++) {
+        data[i] = i * 37 + (i >> 3);
+    }
+
+    for (binary = 0; binary < 2; binary++) {
+        nmgr_uart_test_wire_bytes = 0;
+
+        start = os_cputime_get32();
+        for (i = 0; i < NMGR_UART_TEST_BENCH_REQS; i++) {
+            rc = nmgr_uart_test_util_echo(binary, data, sizeof data);
+            TEST_ASSERT_FATAL(rc == 0);
+        }
+        usecs = os_cputime_ticks_to_usecs(os_cputime_get32() - start);
+
+        wire[binary] = nmgr_uart_test_wire_bytes;
+        printf("nmgr_uart %s: %d requests of %d bytes, %d bytes on the wire "
+               "(%u ms at 115200 baud), %u us of CPU\n",
+               names[binary], NMGR_UART_TEST_BENCH_REQS,
+               NMGR_UART_TEST_BENCH_SZ, wire[binary],
+               (unsigned)((uint64_t)wire[binary] * 10 * 1000 / 115200),
+               (unsigned)usecs);
+    }
+
+    /* Base64 alone costs a third. */
+    TEST_ASSERT(wire[1] * 5 < wire[0] * 4);
+}
@@ -0,0 +1,74 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "os/mynewt.h"
+#include "mgmt/mgmt.h"
+#include "nmgr_uart_test.h"
+
+TEST_CASE(nmgr_uart_test_case_frame)
+{
+    static uint8_t data[NMGR_UART_TEST_DATA_MAX];
+    static uint8_t frame[2048];
+    struct nmgr_hdr hdr;
+    int frame_len;
+    int rc;
+    int i;
+
+    nmgr_uart_test_util_init();
+
+    /* Zeros, runs longer than a COBS block, and everything in between. */
+    for (i = 0; i < sizeof data; i++) {
+        data[i] = i % 5 == 0 ? 0 : i;
+    }
+    memset(data + 300, 0x7e, 300);
+
+    /*** Base64 lines; the response comes back as base64. */
+    rc = nmgr_uart_test_util_echo(0, data, 100);
+    TEST_ASSERT(rc == 0);
+
+    /*** A binary frame switches the responses to binary. */
+    for (i = 0; i <= sizeof data; i += 97) {
+        rc = nmgr_uart_test_util_echo(1, data, i);
+        TEST_ASSERT(rc == 0);
+    }
+    rc = nmgr_uart_test_util_echo(1, data, sizeof data);
+    TEST_ASSERT(rc == 0);
+
+    /*** And base64 switches them back. */
+    rc = nmgr_uart_test_util_echo(0, data, sizeof data);
+    TEST_ASSERT(rc == 0);
+
+    /*** A binary frame with a bad CRC is dropped. */
+    memset(&hdr, 0, sizeof hdr);
+    hdr.nh_op = NMGR_OP_WRITE;
+    hdr.nh_group = htons(MGMT_GROUP_ID_PERUSER);
+    frame_len = nmgr_uart_test_util_enc_bin((uint8_t *)&hdr, sizeof hdr,
+                                            frame);
+    frame[frame_len - 2] ^= 0x01;
+    nmgr_uart_test_util_rx(frame, frame_len);
+    TEST_ASSERT(nmgr_uart_test_util_tx_take(frame, sizeof frame) == 0);
+
+    /*** Line noise and idle delimiters between frames are ignored. */
+    nmgr_uart_test_util_rx((uint8_t *)"\x01\x02garbage\n", 10);
+    nmgr_uart_test_util_rx((uint8_t *)"\0\0\0", 3);
+    TEST_ASSERT(nmgr_uart_test_util_tx_take(frame, sizeof frame) == 0);
+    rc = nmgr_uart_test_util_echo(1, data, 50);
+    TEST_ASSERT(rc == 0);
+}
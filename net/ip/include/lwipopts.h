@@ -26,6 +26,7 @@ extern "C" {
 #define MEM_LIBC_MALLOC			1	/* use platform malloc */
 #define LWIP_NETIF_TX_SINGLE_PBUF 	1
 #define LWIP_NETIF_LOOPBACK		1	/* yes loopback interface */
+#define LWIP_SUPPORT_CUSTOM_PBUF        1	/* mbuf backed pbufs on TX */
 
 #define TCPIP_THREAD_PRIO		5
 #define TCPIP_THREAD_STACKSIZE	((6 * 1024) / sizeof(portSTACK_TYPE))
@@ -277,6 +277,96 @@ sock_udp_data(void)
     mn_close(sock2);
 }
 
+#define SOCK_UDP_LATENCY_CNT            200
+
+/*
+ * Average request/response round trip through the stack must be well below
+ * a scheduler tick or two; a provider that polls its sockets periodically
+ * would show up here as an RTT close to its polling interval.
+ */
+#define SOCK_UDP_LATENCY_MAX_USEC       (50 * 1000)
+
+void
+sock_udp_latency(void)
+{
+    struct mn_socket *sock1;
+    struct mn_socket *sock2;
+    struct mn_sockaddr_in msin;
+    struct mn_sockaddr_in msin2;
+    union mn_socket_cb sock_cbs = {
+        .socket.readable = sud_readable
+    };
+    struct os_mbuf *m;
+    int64_t start;
+    int64_t avg;
+    uint32_t seq;
+    int rc;
+    int i;
+
+    rc = mn_socket(&sock1, MN_PF_INET, MN_SOCK_DGRAM, 0);
+    TEST_ASSERT_FATAL(rc == 0);
+    mn_socket_set_cbs(sock1, NULL, &sock_cbs);
+
+    rc = mn_socket(&sock2, MN_PF_INET, MN_SOCK_DGRAM, 0);
+    TEST_ASSERT_FATAL(rc == 0);
+    mn_socket_set_cbs(sock2, NULL, &sock_cbs);
+
+    msin.msin_family = MN_PF_INET;
+    msin.msin_len = sizeof(msin);
+    msin.msin_port = htons(12445);
+    mn_inet_pton(MN_PF_INET, "127.0.0.1", &msin.msin_addr);
+    rc = mn_bind(sock1, (struct mn_sockaddr *)&msin);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    msin2.msin_family = MN_PF_INET;
+    msin2.msin_len = sizeof(msin2);
+    msin2.msin_port = 0;
+    msin2.msin_addr.s_addr = 0;
+    rc = mn_bind(sock2, (struct mn_sockaddr *)&msin2);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    start = os_get_uptime_usec();
+    for (i = 0; i < SOCK_UDP_LATENCY_CNT; i++) {
+        /*
+         * Request: sock2 -> sock1.
+         */
+        m = os_msys_get_pkthdr(sizeof(seq), 0);
+        TEST_ASSERT_FATAL(m != NULL);
+        seq = i;
+        rc = os_mbuf_copyinto(m, 0, &seq, sizeof(seq));
+        TEST_ASSERT_FATAL(rc == 0);
+        rc = mn_sendto(sock2, m, (struct mn_sockaddr *)&msin);
+        TEST_ASSERT_FATAL(rc == 0);
+
+        rc = os_sem_pend(&test_sem, OS_TICKS_PER_SEC);
+        TEST_ASSERT_FATAL(rc == 0);
+        rc = mn_recvfrom(sock1, &m, (struct mn_sockaddr *)&msin2);
+        TEST_ASSERT_FATAL(rc == 0 && m != NULL);
+
+        /*
+         * Response: echo it back.
+         */
+        rc = mn_sendto(sock1, m, (struct mn_sockaddr *)&msin2);
+        TEST_ASSERT_FATAL(rc == 0);
+
+        rc = os_sem_pend(&test_sem, OS_TICKS_PER_SEC);
+        TEST_ASSERT_FATAL(rc == 0);
+        rc = mn_recvfrom(sock2, &m, NULL);
+        TEST_ASSERT_FATAL(rc == 0 && m != NULL);
+        rc = os_mbuf_copydata(m, 0, sizeof(seq), &seq);
+        TEST_ASSERT(rc == 0 && seq == i);
+        os_mbuf_free_chain(m);
+    }
+    avg = (os_get_uptime_usec() - start) / SOCK_UDP_LATENCY_CNT;
+
+    printf("udp request/response: %d round trips, avg rtt %lld usec\n",
+           SOCK_UDP_LATENCY_CNT, (long long)avg);
+    TEST_ASSERT(avg < SOCK_UDP_LATENCY_MAX_USEC);
+
+    mn_close(sock1);
+    mn_close(sock2);
+}
+
 void
 std_writable(void *cb_arg, int err)
 {
@@ -796,6 +886,7 @@ mn_socket_test_handler(void *arg)
     sock_listen();
     sock_tcp_connect();
     sock_udp_data();
+    sock_udp_latency();
     sock_tcp_data();
     sock_itf_list();
     sock_udp_ll();
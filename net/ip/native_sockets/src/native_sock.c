@@ -28,8 +28,11 @@
 #include <sys/ioctl.h>
 #include <sys/un.h>
 #include <stdio.h>
+#include <signal.h>
+#include <pthread.h>
 
 #include "os/mynewt.h"
+#include "sim/sim.h"
 #include "mn_socket/mn_socket.h"
 #include "mn_socket/mn_socket_ops.h"
 #include "native_sockets/native_sock.h"
@@ -40,20 +43,37 @@ static struct native_sock {
     struct mn_socket ns_sock;
     int ns_fd;
     unsigned int ns_connect:1;  /* Non-blocking connect in progress. */
-    unsigned int ns_poll:1;
     unsigned int ns_listen:1;
     uint8_t ns_type;
     uint8_t ns_pf;
+    int ns_slot;                /* Index in poll_fds; -1 if not polled. */
+    short ns_revents;           /* Reported by the poller, not handled yet. */
     struct os_sem ns_sem;
     STAILQ_HEAD(, os_mbuf_pkthdr) ns_rx;
     struct os_mbuf *ns_tx;
 } native_socks[MYNEWT_VAL(NATIVE_SOCKETS_MAX)];
 
+/*
+ * A host thread blocks in poll() on the sockets and raises a sim interrupt
+ * when one becomes ready.  Reported events are disarmed until the socket task
+ * has acted on them, so a socket with unread data does not keep the poller
+ * spinning.  Slot 0 of the poll set is the read end of a pipe used to make
+ * the poller pick up changes to the set.
+ */
 static struct native_sock_state {
-    struct pollfd poll_fds[MYNEWT_VAL(NATIVE_SOCKETS_MAX)];
+    /* Shared with the poller; protected by poll_mtx. */
+    struct pollfd poll_fds[MYNEWT_VAL(NATIVE_SOCKETS_MAX) + 1];
+    struct native_sock *poll_socks[MYNEWT_VAL(NATIVE_SOCKETS_MAX) + 1];
     int poll_fd_cnt;
+    pthread_mutex_t poll_mtx;
+    pthread_t poll_thread;
+    int wake_fds[2];
+    int irq;
+
     struct os_mutex mtx;
     struct os_task task;
+    struct os_eventq evq;
+    struct os_event ev;
 } native_sock_state;
 
 static const struct mn_socket_ops native_sock_ops = {
@@ -86,50 +106,109 @@ native_get_sock(void)
     for (i = 0; i < MYNEWT_VAL(NATIVE_SOCKETS_MAX); i++) {
         if (native_socks[i].ns_fd < 0) {
             ns = &native_socks[i];
-            ns->ns_poll = 0;
+            ns->ns_connect = 0;
             ns->ns_listen = 0;
+            ns->ns_slot = -1;
+            ns->ns_revents = 0;
             return ns;
         }
     }
     return NULL;
 }
 
-static struct native_sock *
-native_find_sock(int fd)
+/*
+ * The poll set is shared with a host thread.  Entering a critical section
+ * first keeps a sim context switch from happening while the lock is held.
+ */
+static os_sr_t
+native_sock_poll_lock(struct native_sock_state *nss)
 {
-    int i;
+    os_sr_t sr;
 
-    for (i = 0; i < MYNEWT_VAL(NATIVE_SOCKETS_MAX); i++) {
-        if (native_socks[i].ns_fd == fd) {
-            return &native_socks[i];
-        }
-    }
-    return NULL;
+    OS_ENTER_CRITICAL(sr);
+    pthread_mutex_lock(&nss->poll_mtx);
+    return sr;
 }
 
 static void
-native_sock_poll_rebuild(struct native_sock_state *nss)
+native_sock_poll_unlock(struct native_sock_state *nss, os_sr_t sr)
 {
-    struct native_sock *ns;
-    int i;
-    int j;
+    pthread_mutex_unlock(&nss->poll_mtx);
+    OS_EXIT_CRITICAL(sr);
+}
 
-    os_mutex_pend(&nss->mtx, OS_WAIT_FOREVER);
-    for (i = 0, j = 0; i < MYNEWT_VAL(NATIVE_SOCKETS_MAX); i++) {
-        ns = &native_socks[i];
-        if (ns->ns_fd < 0) {
-            continue;
+static void
+native_sock_poll_wake(struct native_sock_state *nss)
+{
+    char c = 0;
+    int rc;
+
+    /* If the pipe is full, the poller has a wakeup pending already. */
+    rc = write(nss->wake_fds[1], &c, 1);
+    (void)rc;
+}
+
+/*
+ * Arms events on a polled socket; with add set, the socket is added to the
+ * poll set if it is not in it yet.
+ */
+static void
+native_sock_poll_arm(struct native_sock_state *nss, struct native_sock *ns,
+                     short events, int add)
+{
+    struct pollfd *pfd;
+    os_sr_t sr;
+    int wake;
+
+    wake = 0;
+    sr = native_sock_poll_lock(nss);
+    if (ns->ns_slot < 0 && add) {
+        ns->ns_slot = nss->poll_fd_cnt++;
+        pfd = &nss->poll_fds[ns->ns_slot];
+        pfd->fd = ns->ns_fd;
+        pfd->events = 0;
+        nss->poll_socks[ns->ns_slot] = ns;
+    }
+    if (ns->ns_slot >= 0) {
+        pfd = &nss->poll_fds[ns->ns_slot];
+        if ((pfd->events & events) != events) {
+            pfd->events |= events;
+            wake = 1;
         }
-        if (!ns->ns_poll) {
-            continue;
+    }
+    native_sock_poll_unlock(nss, sr);
+
+    if (wake) {
+        native_sock_poll_wake(nss);
+    }
+}
+
+static void
+native_sock_poll_remove(struct native_sock_state *nss, struct native_sock *ns)
+{
+    struct native_sock *last;
+    os_sr_t sr;
+    int slot;
+
+    sr = native_sock_poll_lock(nss);
+    slot = ns->ns_slot;
+    if (slot >= 0) {
+        /* Move the last entry into the freed slot. */
+        nss->poll_fd_cnt--;
+        if (slot != nss->poll_fd_cnt) {
+            last = nss->poll_socks[nss->poll_fd_cnt];
+            nss->poll_fds[slot] = nss->poll_fds[nss->poll_fd_cnt];
+            nss->poll_socks[slot] = last;
+            last->ns_slot = slot;
         }
-        nss->poll_fds[j].fd = ns->ns_fd;
-        nss->poll_fds[j].events = POLLIN | POLLOUT;
-        nss->poll_fds[j].revents = 0;
-        j++;
+        ns->ns_slot = -1;
+    }
+    ns->ns_revents = 0;
+    native_sock_poll_unlock(nss, sr);
+
+    if (slot >= 0) {
+        native_sock_poll_wake(nss);
     }
-    nss->poll_fd_cnt = j;
-    os_mutex_release(&nss->mtx);
 }
 
 int
@@ -314,8 +393,10 @@ native_sock_close(struct mn_socket *s)
     struct native_sock_state *nss = &native_sock_state;
     struct native_sock *ns = (struct native_sock *)s;
     struct os_mbuf_pkthdr *m;
+    int i;
 
     os_mutex_pend(&nss->mtx, OS_WAIT_FOREVER);
+    native_sock_poll_remove(nss, ns);
     close(ns->ns_fd);
     ns->ns_fd = -1;
 
@@ -328,7 +409,14 @@ native_sock_close(struct mn_socket *s)
         os_mbuf_free_chain(OS_MBUF_PKTHDR_TO_MBUF(m));
     }
     os_mbuf_free_chain(ns->ns_tx);
-    native_sock_poll_rebuild(nss);
+    ns->ns_tx = NULL;
+
+    /* A listener may have a connection waiting for a free socket. */
+    for (i = 0; i < MYNEWT_VAL(NATIVE_SOCKETS_MAX); i++) {
+        if (native_socks[i].ns_fd >= 0 && native_socks[i].ns_listen) {
+            native_sock_poll_arm(nss, &native_socks[i], POLLIN, 0);
+        }
+    }
     os_mutex_release(&nss->mtx);
     return 0;
 }
@@ -361,8 +449,7 @@ native_sock_connect(struct mn_socket *s, struct mn_sockaddr *addr)
             return native_sock_err_to_mn_err(rc);
         }
     }
-    ns->ns_poll = 1;
-    native_sock_poll_rebuild(nss);
+    native_sock_poll_arm(nss, ns, in_progress ? POLLIN | POLLOUT : POLLIN, 1);
     os_mutex_release(&nss->mtx);
 
     /* Indicate writability if connection fully established. */
@@ -405,8 +492,7 @@ native_sock_bind(struct mn_socket *s, struct mn_sockaddr *addr)
         goto err;
     }
     if (ns->ns_type == SOCK_DGRAM) {
-        ns->ns_poll = 1;
-        native_sock_poll_rebuild(nss);
+        native_sock_poll_arm(nss, ns, POLLIN, 1);
     }
     os_mutex_release(&nss->mtx);
     return 0;
@@ -429,9 +515,8 @@ native_sock_listen(struct mn_socket *s, uint8_t qlen)
         os_mutex_release(&nss->mtx);
         return native_sock_err_to_mn_err(rc);
     }
-    ns->ns_poll = 1;
     ns->ns_listen = 1;
-    native_sock_poll_rebuild(nss);
+    native_sock_poll_arm(nss, ns, POLLIN, 1);
     os_mutex_release(&nss->mtx);
     return 0;
 }
@@ -484,6 +569,10 @@ native_sock_stream_tx(struct native_sock *ns, int notify)
             break;
         }
     }
+    if (ns->ns_tx) {
+        /* Socket buffer is full; continue when it drains. */
+        native_sock_poll_arm(nss, ns, POLLOUT, 0);
+    }
     os_mutex_release(&nss->mtx);
     if (notify) {
         mn_socket_writable(&ns->ns_sock, rc);
@@ -574,15 +663,21 @@ native_sock_recvfrom(struct mn_socket *s, struct os_mbuf **mp,
         }
     }
     if (rc < 0) {
-        return native_sock_err_to_mn_err(errno);
+        rc = native_sock_err_to_mn_err(errno);
+        native_sock_poll_arm(&native_sock_state, ns, POLLIN, 0);
+        return rc;
     }
     if (ns->ns_type == SOCK_STREAM && rc == 0) {
         mn_socket_readable(&ns->ns_sock, MN_ECONNABORTED);
-        ns->ns_poll = 0;
-        native_sock_poll_rebuild(&native_sock_state);
+        native_sock_poll_remove(&native_sock_state, ns);
         return MN_ECONNABORTED;
     }
 
+    /* The reader has acted on the last readable notification; ask for the
+     * next one.
+     */
+    native_sock_poll_arm(&native_sock_state, ns, POLLIN, 0);
+
     m = os_msys_get_pkthdr(rc, 0);
     if (!m) {
         return MN_ENOBUFS;
@@ -725,95 +820,238 @@ native_sock_getpeername(struct mn_socket *s, struct mn_sockaddr *addr)
 }
 
 /*
- * XXX should do this task with SIGIO as well.
+ * Host thread; blocks until a socket in the poll set becomes ready, then
+ * records the events and pends the sim interrupt.
  */
+static void *
+native_sock_poller(void *arg)
+{
+    struct native_sock_state *nss = arg;
+    struct pollfd fds[MYNEWT_VAL(NATIVE_SOCKETS_MAX) + 1];
+    struct pollfd *pfd;
+    struct native_sock *ns;
+    char buf[16];
+    int pend;
+    int cnt;
+    int rc;
+    int i;
+
+    while (1) {
+        pthread_mutex_lock(&nss->poll_mtx);
+        cnt = nss->poll_fd_cnt;
+        for (i = 0; i < cnt; i++) {
+            pfd = &nss->poll_fds[i];
+            /* poll() ignores negative descriptors. */
+            fds[i].fd = pfd->events ? pfd->fd : -1;
+            fds[i].events = pfd->events;
+            fds[i].revents = 0;
+        }
+        pthread_mutex_unlock(&nss->poll_mtx);
+
+        rc = poll(fds, cnt, -1);
+        if (rc <= 0) {
+            continue;
+        }
+
+        if (fds[0].revents) {
+            while (read(nss->wake_fds[0], buf, sizeof(buf)) > 0) {
+            }
+        }
+
+        pend = 0;
+        pthread_mutex_lock(&nss->poll_mtx);
+        for (i = 1; i < cnt; i++) {
+            if (fds[i].revents == 0) {
+                continue;
+            }
+
+            /* Skip sockets that left the set while we were polling. */
+            pfd = &nss->poll_fds[i];
+            if (i >= nss->poll_fd_cnt || pfd->fd != fds[i].fd) {
+                continue;
+            }
+
+            ns = nss->poll_socks[i];
+            ns->ns_revents |= fds[i].revents;
+            if (fds[i].revents & (POLLERR | POLLHUP | POLLNVAL)) {
+                /* These cannot be masked; stop polling until handled. */
+                pfd->events = 0;
+            } else {
+                pfd->events &= ~fds[i].revents;
+            }
+            pend = 1;
+        }
+        pthread_mutex_unlock(&nss->poll_mtx);
+
+        if (pend) {
+            sim_irq_pend(nss->irq);
+        }
+    }
+
+    return NULL;
+}
+
 static void
-socket_task(void *arg)
+native_sock_irq(void *arg)
 {
     struct native_sock_state *nss = arg;
-    struct native_sock *ns, *new_ns;
+
+    os_eventq_put(&nss->evq, &nss->ev);
+}
+
+static void
+native_sock_accept(struct native_sock_state *nss, struct native_sock *ns)
+{
+    struct native_sock *new_ns;
     struct sockaddr_storage ss;
     struct sockaddr *sa = (struct sockaddr *)&ss;
-    int revents;
-    int i;
+    socklen_t slen;
+    int fd;
+
+    new_ns = native_get_sock();
+    if (!new_ns) {
+        /* Leave the connection queued; retry when a socket is closed. */
+        return;
+    }
+    slen = sizeof(ss);
+    fd = accept(ns->ns_fd, sa, &slen);
+    native_sock_poll_arm(nss, ns, POLLIN, 0);
+    if (fd < 0) {
+        return;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+
+    new_ns->ns_fd = fd;
+    new_ns->ns_type = ns->ns_type;
+    new_ns->ns_pf = ns->ns_pf;
+    new_ns->ns_sock.ms_ops = &native_sock_ops;
+    os_mutex_release(&nss->mtx);
+    if (mn_socket_newconn(&ns->ns_sock, &new_ns->ns_sock)) {
+        /*
+         * should close
+         */
+    }
+    os_mutex_pend(&nss->mtx, OS_WAIT_FOREVER);
+    if (new_ns->ns_fd == fd) {
+        native_sock_poll_arm(nss, new_ns, POLLIN, 1);
+    }
+}
+
+static void
+native_sock_event(struct os_event *ev)
+{
+    struct native_sock_state *nss = ev->ev_arg;
+    struct native_sock *ns;
     socklen_t slen;
     int sock_err;
+    int revents;
+    os_sr_t sr;
     int rc;
+    int i;
 
     os_mutex_pend(&nss->mtx, OS_WAIT_FOREVER);
-    while (1) {
-        os_mutex_release(&nss->mtx);
-        os_time_delay(MYNEWT_VAL(NATIVE_SOCKETS_POLL_ITVL));
-        os_mutex_pend(&nss->mtx, OS_WAIT_FOREVER);
-        if (nss->poll_fd_cnt) {
-            rc = poll(nss->poll_fds, nss->poll_fd_cnt, 0);
-        } else {
-            rc = 0;
-        }
-        if (rc == 0) {
+    for (i = 0; i < MYNEWT_VAL(NATIVE_SOCKETS_MAX); i++) {
+        ns = &native_socks[i];
+
+        sr = native_sock_poll_lock(nss);
+        revents = ns->ns_revents;
+        ns->ns_revents = 0;
+        native_sock_poll_unlock(nss, sr);
+
+        if (revents == 0 || ns->ns_fd < 0) {
             continue;
         }
-        for (i = 0; i < nss->poll_fd_cnt; i++) {
-            if (nss->poll_fds[i].revents == 0) {
+
+        if (ns->ns_connect) {
+            /*
+             * The connection attempt has completed.  Report whether it
+             * succeeded.
+             */
+            ns->ns_connect = 0;
+
+            slen = sizeof(sock_err);
+            rc = getsockopt(ns->ns_fd, SOL_SOCKET, SO_ERROR,
+                            &sock_err, &slen);
+            if (rc != 0) {
+                rc = native_sock_err_to_mn_err(errno);
+            } else if (sock_err != 0) {
+                rc = native_sock_err_to_mn_err(sock_err);
+            }
+            mn_socket_writable(&ns->ns_sock, rc);
+            if (rc != 0) {
                 continue;
             }
+            revents &= ~POLLOUT;
+        }
 
-            revents = nss->poll_fds[i].revents;
-            nss->poll_fds[i].revents = 0;
-
-            ns = native_find_sock(nss->poll_fds[i].fd);
-            assert(ns);
-
-            if (revents & POLLIN) {
-                if (ns->ns_listen) {
-                    new_ns = native_get_sock();
-                    if (!new_ns) {
-                        continue;
-                    }
-                    slen = sizeof(ss);
-                    new_ns->ns_fd = accept(ns->ns_fd, sa, &slen);
-                    if (new_ns->ns_fd < 0) {
-                        continue;
-                    }
-                    new_ns->ns_type = ns->ns_type;
-                    new_ns->ns_sock.ms_ops = &native_sock_ops;
-                    os_mutex_release(&nss->mtx);
-                    if (mn_socket_newconn(&ns->ns_sock, &new_ns->ns_sock)) {
-                        /*
-                         * should close
-                         */
-                    }
-                    os_mutex_pend(&nss->mtx, OS_WAIT_FOREVER);
-                    new_ns->ns_poll = 1;
-                    native_sock_poll_rebuild(nss);
-                } else {
-                    mn_socket_readable(&ns->ns_sock, 0);
-                }
+        if (revents & (POLLIN | POLLERR | POLLHUP)) {
+            if (ns->ns_listen) {
+                native_sock_accept(nss, ns);
+            } else {
+                /* POLLIN is re-armed by native_sock_recvfrom(). */
+                mn_socket_readable(&ns->ns_sock, 0);
             }
+        }
 
-            if (revents & POLLOUT) {
-                if (ns->ns_connect) {
-                    /*
-                     * The connection attempt has completed.  Report whether it
-                     * succeeded.
-                     */
-                    ns->ns_connect = 0;
-
-                    slen = sizeof(sock_err);
-                    rc = getsockopt(ns->ns_fd, SOL_SOCKET, SO_ERROR,
-                                    &sock_err, &slen);
-                    if (rc != 0) {
-                        rc = native_sock_err_to_mn_err(errno);
-                    } else if (sock_err != 0) {
-                        rc = native_sock_err_to_mn_err(sock_err);
-                    }
-                    mn_socket_writable(&ns->ns_sock, rc);
-                } else if (ns->ns_type == SOCK_STREAM && ns->ns_tx) {
-                    native_sock_stream_tx(ns, 1);
-                }
+        if (revents & POLLOUT) {
+            if (ns->ns_type == SOCK_STREAM && ns->ns_tx) {
+                native_sock_stream_tx(ns, 1);
             }
         }
     }
+    os_mutex_release(&nss->mtx);
+}
+
+static void
+socket_task(void *arg)
+{
+    struct native_sock_state *nss = arg;
+
+    while (1) {
+        os_eventq_run(&nss->evq);
+    }
+}
+
+static int
+native_sock_poller_start(struct native_sock_state *nss)
+{
+    sigset_t all;
+    sigset_t old;
+    int rc;
+    int i;
+
+    if (pipe(nss->wake_fds) != 0) {
+        return -1;
+    }
+    for (i = 0; i < 2; i++) {
+        fcntl(nss->wake_fds[i], F_SETFL,
+              fcntl(nss->wake_fds[i], F_GETFL, 0) | O_NONBLOCK);
+    }
+
+    pthread_mutex_init(&nss->poll_mtx, NULL);
+    nss->poll_fds[0].fd = nss->wake_fds[0];
+    nss->poll_fds[0].events = POLLIN;
+    nss->poll_socks[0] = NULL;
+    nss->poll_fd_cnt = 1;
+
+    nss->irq = sim_irq_alloc(native_sock_irq, nss);
+    if (nss->irq < 0) {
+        return -1;
+    }
+
+    /*
+     * The poller inherits this mask, so the signals that drive sim (tick,
+     * interrupts, context switches) are only delivered to the sim thread.
+     */
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, &old);
+    rc = pthread_create(&nss->poll_thread, NULL, native_sock_poller, nss);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+    if (rc != 0) {
+        return -1;
+    }
+
+    return 0;
 }
 
 int
@@ -828,6 +1066,7 @@ native_sock_init(void)
 
     for (i = 0; i < MYNEWT_VAL(NATIVE_SOCKETS_MAX); i++) {
         native_socks[i].ns_fd = -1;
+        native_socks[i].ns_slot = -1;
         STAILQ_INIT(&native_socks[i].ns_rx);
     }
     sp = malloc(sizeof(os_stack_t) * MYNEWT_VAL(NATIVE_SOCKETS_STACK_SZ));
@@ -835,12 +1074,19 @@ native_sock_init(void)
         return -1;
     }
     os_mutex_init(&nss->mtx);
+    os_eventq_init(&nss->evq);
+    nss->ev.ev_cb = native_sock_event;
+    nss->ev.ev_arg = nss;
     i = os_task_init(&nss->task, "socket", socket_task, &native_sock_state,
       MYNEWT_VAL(NATIVE_SOCKETS_PRIO), OS_WAIT_FOREVER, sp,
       MYNEWT_VAL(NATIVE_SOCKETS_STACK_SZ));
     if (i) {
         return -1;
     }
+    i = native_sock_poller_start(nss);
+    if (i) {
+        return -1;
+    }
     i = mn_socket_ops_reg(&native_sock_ops);
     if (i) {
         return -1;
@@ -20,6 +20,7 @@
 #include "os/mynewt.h"
 
 #if MYNEWT_VAL(LWIP_CLI)
+#include <stdlib.h>
 #include <string.h>
 
 #include <mn_socket/mn_socket.h>
@@ -95,10 +96,138 @@ lwip_nif_up(const char *name)
     return 0;
 }
 
+#define LWIP_CLI_BENCH_PORT         12460
+#define LWIP_CLI_BENCH_MAX_SZ       1472
+
+static struct os_sem lwip_cli_bench_sem;
+
+static void
+lwip_cli_bench_readable(void *cb_arg, int err)
+{
+    os_sem_release(&lwip_cli_bench_sem);
+}
+
+static const union mn_socket_cb lwip_cli_bench_cbs = {
+    .socket.readable = lwip_cli_bench_readable
+};
+
+static struct os_mbuf *
+lwip_cli_bench_pkt(int size)
+{
+    struct os_mbuf *m;
+    uint8_t buf[64];
+    int len;
+    int i;
+
+    for (i = 0; i < sizeof(buf); i++) {
+        buf[i] = i;
+    }
+    m = os_msys_get_pkthdr(size, 0);
+    if (!m) {
+        return NULL;
+    }
+    while (size > 0) {
+        len = min(size, sizeof(buf));
+        if (os_mbuf_append(m, buf, len)) {
+            os_mbuf_free_chain(m);
+            return NULL;
+        }
+        size -= len;
+    }
+    return m;
+}
+
+/*
+ * Sends cnt datagrams of size bytes to itself over the loopback interface,
+ * one at a time, and reports the throughput.
+ */
+static int
+lwip_cli_udp_bench(int cnt, int size)
+{
+    struct mn_socket *rx_sock;
+    struct mn_socket *tx_sock;
+    struct mn_sockaddr_in msin;
+    struct os_mbuf *m;
+    int64_t start;
+    int64_t usecs;
+    uint32_t bytes;
+    int rc;
+    int i;
+
+    rx_sock = NULL;
+    tx_sock = NULL;
+    os_sem_init(&lwip_cli_bench_sem, 0);
+
+    rc = mn_socket(&rx_sock, MN_PF_INET, MN_SOCK_DGRAM, 0);
+    if (rc) {
+        goto err;
+    }
+    mn_socket_set_cbs(rx_sock, NULL, &lwip_cli_bench_cbs);
+    rc = mn_socket(&tx_sock, MN_PF_INET, MN_SOCK_DGRAM, 0);
+    if (rc) {
+        goto err;
+    }
+
+    memset(&msin, 0, sizeof(msin));
+    msin.msin_family = MN_AF_INET;
+    msin.msin_len = sizeof(msin);
+    msin.msin_port = htons(LWIP_CLI_BENCH_PORT);
+    mn_inet_pton(MN_AF_INET, "127.0.0.1", &msin.msin_addr);
+    rc = mn_bind(rx_sock, (struct mn_sockaddr *)&msin);
+    if (rc) {
+        goto err;
+    }
+
+    bytes = 0;
+    start = os_get_uptime_usec();
+    for (i = 0; i < cnt; i++) {
+        m = lwip_cli_bench_pkt(size);
+        if (!m) {
+            rc = MN_ENOBUFS;
+            goto err;
+        }
+        rc = mn_sendto(tx_sock, m, (struct mn_sockaddr *)&msin);
+        if (rc) {
+            os_mbuf_free_chain(m);
+            goto err;
+        }
+        rc = os_sem_pend(&lwip_cli_bench_sem, OS_TICKS_PER_SEC);
+        if (rc) {
+            rc = MN_ETIMEDOUT;
+            goto err;
+        }
+        while (mn_recvfrom(rx_sock, &m, NULL) == 0) {
+            bytes += OS_MBUF_PKTLEN(m);
+            os_mbuf_free_chain(m);
+        }
+    }
+    usecs = os_get_uptime_usec() - start;
+    if (usecs == 0) {
+        usecs = 1;
+    }
+    console_printf("udp %d x %d bytes: %lu bytes in %lu usec, %lu kB/s\n",
+                   cnt, size, (unsigned long)bytes, (unsigned long)usecs,
+                   (unsigned long)(bytes * 1000ULL / usecs));
+    rc = 0;
+err:
+    if (rc) {
+        console_printf("udpbench failed at %d: %d\n", i, rc);
+    }
+    if (tx_sock) {
+        mn_close(tx_sock);
+    }
+    if (rx_sock) {
+        mn_close(rx_sock);
+    }
+    return rc;
+}
+
 static int
 lwip_cli(int argc, char **argv)
 {
     int rc;
+    int cnt;
+    int size;
     struct mn_itf itf;
 
     if (argc == 1 || !strcmp(argv[1], "listif")) {
@@ -110,6 +239,15 @@ lwip_cli(int argc, char **argv)
             }
             lwip_nif_print(&itf);
         }
+    } else if (!strcmp(argv[1], "udpbench")) {
+        cnt = argc > 2 ? atoi(argv[2]) : 1000;
+        size = argc > 3 ? atoi(argv[3]) : 512;
+        if (cnt <= 0 || size <= 0 || size > LWIP_CLI_BENCH_MAX_SZ) {
+            console_printf("usage: ip udpbench [count] [size <= %d]\n",
+                           LWIP_CLI_BENCH_MAX_SZ);
+            return 0;
+        }
+        lwip_cli_udp_bench(cnt, size);
     } else if (mn_itf_get(argv[1], &itf) == 0) {
         if (argc == 2) {
             lwip_nif_print(&itf);
@@ -82,6 +82,39 @@ struct lwip_sock {
 
 static struct os_mempool lwip_sockets;
 
+#if MYNEWT_VAL(LWIP_SOCK_ZERO_COPY)
+/*
+ * Received pbufs are lent to socket consumers instead of being copied.
+ * The packet header (and source address) lives in an ordinary msys mbuf,
+ * followed by one mbuf from lwip_sock_rx_pool per pbuf whose data points
+ * into the pbuf payload.  As the chain head comes from msys, any mbufs the
+ * consumer later adds to the chain come from msys as well.  The pbuf
+ * pointer is kept in the lending mbuf's own (small) buffer; freeing the
+ * mbuf drops the pbuf reference via the mempool put callback.
+ *
+ * PBUF_POOL pbufs are never lent.  The pool is small, drivers refill their
+ * receive rings from it, and every buffer is full sized; a few unread
+ * datagrams would stall all reception on the interface.
+ */
+#define LWIP_SOCK_RX_BUF_SIZE                                           \
+    (sizeof(struct os_mbuf) + sizeof(struct pbuf *))
+
+static struct os_mempool_ext lwip_sock_rx_mempool;
+static struct os_mbuf_pool lwip_sock_rx_pool;
+
+/*
+ * Outgoing datagrams are handed to lwIP as a chain of custom PBUF_REF pbufs,
+ * one per mbuf.  Each mbuf is freed when lwIP (or the driver) releases the
+ * pbuf referencing it.
+ */
+struct lwip_sock_tx_ref {
+    struct pbuf_custom ltr_pc;
+    struct os_mbuf *ltr_om;
+};
+
+static struct os_mempool lwip_sock_tx_refs;
+#endif
+
 static int lwip_stream_tx(struct lwip_sock *s, int notify);
 
 static int
@@ -177,6 +210,129 @@ lwip_err_to_mn_err(int rc)
     }
 }
 
+#if MYNEWT_VAL(LWIP_SOCK_ZERO_COPY)
+static struct pbuf **
+lwip_sock_rx_pbuf(struct os_mbuf *om)
+{
+    return (struct pbuf **)om->om_databuf;
+}
+
+static os_error_t
+lwip_sock_rx_put(struct os_mempool_ext *mpe, void *data, void *arg)
+{
+    struct os_mbuf *om;
+
+    om = data;
+    if (OS_MBUF_IS_EXT(om)) {
+        /*
+         * Consumers free mbufs from their own tasks; pbufs must only be
+         * released with the core lock held.
+         */
+        LOCK_TCPIP_CORE();
+        pbuf_free(*lwip_sock_rx_pbuf(om));
+        UNLOCK_TCPIP_CORE();
+    }
+    return os_memblock_put_from_cb(&mpe->mpe_mp, data);
+}
+
+/*
+ * Whether the pbuf chain can be lent to a socket, instead of being copied.
+ */
+static int
+lwip_sock_rx_lendable(struct pbuf *p)
+{
+    struct pbuf *q;
+
+    for (q = p; q; q = q->next) {
+        if (q->type == PBUF_POOL) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*
+ * Wraps the pbuf chain in mbufs referencing its payload, behind an empty
+ * msys packet header mbuf.  Takes a reference on every pbuf that is lent;
+ * the caller still owns its own reference.
+ */
+static struct os_mbuf *
+lwip_sock_rx_ref(struct pbuf *p, uint16_t user_hdr_len)
+{
+    struct os_mbuf *head;
+    struct os_mbuf *last;
+    struct os_mbuf *om;
+    struct pbuf *q;
+
+    head = os_msys_get_pkthdr(0, user_hdr_len);
+    if (!head) {
+        return NULL;
+    }
+    last = head;
+    for (q = p; q; q = q->next) {
+        if (q->len == 0) {
+            continue;
+        }
+        om = os_mbuf_get(&lwip_sock_rx_pool, 0);
+        if (!om) {
+            os_mbuf_free_chain(head);
+            return NULL;
+        }
+        pbuf_ref(q);
+        *lwip_sock_rx_pbuf(om) = q;
+        om->om_flags |= OS_MBUF_F_MASK(OS_MBUF_F_EXT);
+        om->om_data = q->payload;
+        om->om_len = q->len;
+        SLIST_NEXT(last, om_next) = om;
+        last = om;
+    }
+    OS_MBUF_PKTLEN(head) = p->tot_len;
+    return head;
+}
+#endif
+
+static struct os_mbuf *
+lwip_sock_rx_copy(struct pbuf *p, uint16_t user_hdr_len)
+{
+    struct os_mbuf *m;
+    struct pbuf *q;
+
+    m = os_msys_get_pkthdr(p->tot_len, user_hdr_len);
+    if (!m) {
+        return NULL;
+    }
+    for (q = p; q; q = q->next) {
+        if (os_mbuf_append(m, q->payload, q->len)) {
+            os_mbuf_free_chain(m);
+            return NULL;
+        }
+    }
+    return m;
+}
+
+/*
+ * Converts received data to an mbuf chain.  The payload is lent when
+ * possible, and copied into msys when it comes from the pbuf pool or the
+ * reference pool is exhausted.
+ * The caller remains responsible for its reference to p.
+ */
+static struct os_mbuf *
+lwip_sock_rx_mbuf(struct pbuf *p, uint16_t user_hdr_len)
+{
+    struct os_mbuf *m;
+
+#if MYNEWT_VAL(LWIP_SOCK_ZERO_COPY)
+    if (lwip_sock_rx_lendable(p)) {
+        m = lwip_sock_rx_ref(p, user_hdr_len);
+        if (m) {
+            return m;
+        }
+    }
+#endif
+    m = lwip_sock_rx_copy(p, user_hdr_len);
+    return m;
+}
+
 #if LWIP_UDP
 static void
 lwip_sock_udp_rx(void *arg, struct udp_pcb *pcb, struct pbuf *p,
@@ -184,21 +340,14 @@ lwip_sock_udp_rx(void *arg, struct udp_pcb *pcb, struct pbuf *p,
 {
     struct lwip_sock *s = (struct lwip_sock *)arg;
     struct os_mbuf *m;
-    struct pbuf *q;
-    int off;
 
-    m = os_msys_get_pkthdr(p->tot_len, sizeof(struct mn_sockaddr_in6));
+    m = lwip_sock_rx_mbuf(p, sizeof(struct mn_sockaddr_in6));
+    pbuf_free(p);
     if (!m) {
-        pbuf_free(p);
         return;
     }
     lwip_addr_to_mn_addr((struct mn_sockaddr *)OS_MBUF_USRHDR(m),
       addr, port);
-    off = 0;
-    for (q = p; q; q = q->next) {
-        os_mbuf_copyinto(m, off, q->payload, p->len);
-    }
-    pbuf_free(p);
     STAILQ_INSERT_TAIL(&s->ls_rx, OS_MBUF_PKTHDR(m), omp_next);
     mn_socket_readable(&s->ls_sock, 0);
 }
@@ -210,8 +359,6 @@ lwip_sock_tcp_rx(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err)
 {
     struct lwip_sock *s = (struct lwip_sock *)arg;
     struct os_mbuf *m;
-    struct pbuf *q;
-    int off;
 
     if (!p) {
         /*
@@ -220,12 +367,12 @@ lwip_sock_tcp_rx(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err)
         mn_socket_readable(&s->ls_sock, MN_ECONNABORTED);
         return ERR_OK;
     }
-    m = os_msys_get_pkthdr(p->tot_len, 0);
-    assert(m);
-    /* XXX fix this */
-    off = 0;
-    for (q = p; q; q = q->next) {
-        os_mbuf_copyinto(m, off, q->payload, p->len);
+    m = lwip_sock_rx_mbuf(p, 0);
+    if (!m) {
+        /*
+         * lwIP keeps the data and offers it again later.
+         */
+        return ERR_MEM;
     }
     pbuf_free(p);
     STAILQ_INSERT_TAIL(&s->ls_rx, OS_MBUF_PKTHDR(m), omp_next);
@@ -493,16 +640,134 @@ lwip_stream_tx(struct lwip_sock *s, int notify)
     return rc;
 }
 
+#if LWIP_UDP
+#if MYNEWT_VAL(LWIP_SOCK_ZERO_COPY)
+static void
+lwip_sock_tx_ref_free(struct pbuf *p)
+{
+    struct lwip_sock_tx_ref *ltr = (struct lwip_sock_tx_ref *)p;
+
+    if (ltr->ltr_om) {
+        os_mbuf_free(ltr->ltr_om);
+    }
+    os_memblock_put(&lwip_sock_tx_refs, ltr);
+}
+
+/*
+ * Builds a pbuf chain referencing the data of mbuf chain m.  The mbufs are
+ * not owned by the pbufs until lwip_sock_tx_ref_commit() is called.
+ */
+static struct pbuf *
+lwip_sock_tx_ref(struct os_mbuf *m)
+{
+    struct lwip_sock_tx_ref *ltr;
+    struct os_mbuf *n;
+    struct pbuf *head;
+    struct pbuf *q;
+
+    head = NULL;
+    for (n = m; n; n = SLIST_NEXT(n, om_next)) {
+        if (n->om_len == 0) {
+            continue;
+        }
+        ltr = os_memblock_get(&lwip_sock_tx_refs);
+        if (!ltr) {
+            goto err;
+        }
+        ltr->ltr_om = NULL;
+        ltr->ltr_pc.custom_free_function = lwip_sock_tx_ref_free;
+        q = pbuf_alloced_custom(PBUF_RAW, n->om_len, PBUF_REF, &ltr->ltr_pc,
+                                n->om_data, n->om_len);
+        if (!q) {
+            os_memblock_put(&lwip_sock_tx_refs, ltr);
+            goto err;
+        }
+        if (!head) {
+            head = q;
+        } else {
+            pbuf_cat(head, q);
+        }
+    }
+    return head;
+err:
+    if (head) {
+        pbuf_free(head);
+    }
+    return NULL;
+}
+
+/*
+ * Hands the mbufs of m over to the pbufs built by lwip_sock_tx_ref(); each
+ * mbuf is freed with the pbuf referencing it.  Must be called while the
+ * caller still holds its reference to the pbuf chain.
+ */
+static void
+lwip_sock_tx_ref_commit(struct pbuf *p, struct os_mbuf *m)
+{
+    struct os_mbuf *next;
+
+    while (m) {
+        next = SLIST_NEXT(m, om_next);
+        SLIST_NEXT(m, om_next) = NULL;
+        if (m->om_len == 0) {
+            os_mbuf_free(m);
+        } else {
+            ((struct lwip_sock_tx_ref *)p)->ltr_om = m;
+            p = p->next;
+        }
+        m = next;
+    }
+}
+#endif
+
+static struct pbuf *
+lwip_sock_tx_copy(struct os_mbuf *m)
+{
+    struct pbuf *p;
+    struct os_mbuf *n;
+    int off;
+
+    off = 0;
+    for (n = m; n; n = SLIST_NEXT(n, om_next)) {
+        off += n->om_len;
+    }
+    p = pbuf_alloc(PBUF_TRANSPORT, off, PBUF_RAM);
+    if (!p) {
+        return NULL;
+    }
+
+    off = 0;
+    for (n = m; n; n = SLIST_NEXT(n, om_next)) {
+        pbuf_take_at(p, n->om_data, n->om_len, off);
+        off += n->om_len;
+    }
+    return p;
+}
+
+static int
+lwip_sock_udp_tx(struct lwip_sock *s, struct pbuf *p, ip_addr_t *ip_addr,
+  uint16_t port)
+{
+    int rc;
+
+    LOCK_TCPIP_CORE();
+    rc = udp_sendto(s->ls_pcb.udp, p, ip_addr, port);
+    UNLOCK_TCPIP_CORE();
+    if (rc) {
+        return lwip_err_to_mn_err(rc);
+    }
+    return 0;
+}
+#endif
+
 static int
 lwip_sendto(struct mn_socket *ms, struct os_mbuf *m,
   struct mn_sockaddr *addr)
 {
     struct lwip_sock *s = (struct lwip_sock *)ms;
     struct pbuf *p;
-    struct os_mbuf *n;
     ip_addr_t ip_addr;
     uint16_t port;
-    int off;
     int rc;
 
     switch (s->ls_type) {
@@ -515,30 +780,31 @@ lwip_sendto(struct mn_socket *ms, struct os_mbuf *m,
         if (rc) {
             return rc;
         }
-        off = 0;
-        for (n = m; n; n = SLIST_NEXT(n, om_next)) {
-            off += n->om_len;
+#if MYNEWT_VAL(LWIP_SOCK_ZERO_COPY)
+        p = lwip_sock_tx_ref(m);
+        if (p) {
+            rc = lwip_sock_udp_tx(s, p, &ip_addr, port);
+            if (!rc) {
+                /*
+                 * lwIP or the driver may still hold the pbufs; the mbufs
+                 * are freed when the last reference is dropped.
+                 */
+                lwip_sock_tx_ref_commit(p, m);
+            }
+            pbuf_free(p);
+            return rc;
         }
-        p = pbuf_alloc(PBUF_TRANSPORT, off, PBUF_RAM);
+#endif
+        p = lwip_sock_tx_copy(m);
         if (!p) {
             return MN_ENOBUFS;
         }
-
-        off = 0;
-        for (n = m; n; n = SLIST_NEXT(n, om_next)) {
-            pbuf_take_at(p, n->om_data, n->om_len, off);
-            off += n->om_len;
-        }
-        LOCK_TCPIP_CORE();
-        rc = udp_sendto(s->ls_pcb.udp, p, &ip_addr, port);
-        UNLOCK_TCPIP_CORE();
-        if (rc) {
-            rc = lwip_err_to_mn_err(rc);
-            pbuf_free(p);
-            return rc;
+        rc = lwip_sock_udp_tx(s, p, &ip_addr, port);
+        pbuf_free(p);
+        if (!rc) {
+            os_mbuf_free_chain(m);
         }
-        os_mbuf_free_chain(m);
-        return 0;
+        return rc;
 #endif
 #if LWIP_TCP
     case MN_SOCK_STREAM:
@@ -737,6 +1003,27 @@ lwip_socket_init(void)
     }
     os_mempool_init(&lwip_sockets, cnt, sizeof(struct lwip_sock), mem, "sock");
 
+#if MYNEWT_VAL(LWIP_SOCK_ZERO_COPY)
+    cnt = MYNEWT_VAL(LWIP_SOCK_RX_REF_CNT);
+    mem = os_malloc(OS_MEMPOOL_BYTES(cnt, LWIP_SOCK_RX_BUF_SIZE));
+    if (!mem) {
+        return -1;
+    }
+    os_mempool_ext_init(&lwip_sock_rx_mempool, cnt, LWIP_SOCK_RX_BUF_SIZE,
+                        mem, "sock_rx_ref");
+    lwip_sock_rx_mempool.mpe_put_cb = lwip_sock_rx_put;
+    os_mbuf_pool_init(&lwip_sock_rx_pool, &lwip_sock_rx_mempool.mpe_mp,
+                      LWIP_SOCK_RX_BUF_SIZE, cnt);
+
+    cnt = MYNEWT_VAL(LWIP_SOCK_TX_REF_CNT);
+    mem = os_malloc(OS_MEMPOOL_BYTES(cnt, sizeof(struct lwip_sock_tx_ref)));
+    if (!mem) {
+        return -1;
+    }
+    os_mempool_init(&lwip_sock_tx_refs, cnt, sizeof(struct lwip_sock_tx_ref),
+                    mem, "sock_tx_ref");
+#endif
+
     rc = mn_socket_ops_reg(&lwip_sock_ops);
     if (rc) {
         return -1;
@@ -39,6 +39,7 @@ STATS_SECT_START(lora_mac_stats)
     STATS_SECT_ENTRY(rx_errors)
     STATS_SECT_ENTRY(rx_frames)
     STATS_SECT_ENTRY(rx_mic_failures)
+    STATS_SECT_ENTRY(rx_crypto_failures)
     STATS_SECT_ENTRY(rx_mlme)
     STATS_SECT_ENTRY(rx_mcps)
     STATS_SECT_ENTRY(rx_dups)
@@ -1399,7 +1399,12 @@ typedef enum eLoRaMacStatus
     /*!
      * Cannot send frame due to too many MAC commands
      */
-    LORAMAC_STATUS_MAC_CMD_LENGTH_ERROR
+    LORAMAC_STATUS_MAC_CMD_LENGTH_ERROR,
+    /*!
+     * The frame could not be encrypted or signed; the AES key could not
+     * be set up
+     */
+    LORAMAC_STATUS_CRYPTO_FAIL
 }LoRaMacStatus_t;
 
 /*!
@@ -46,8 +46,10 @@
  * \param [IN]  dir             - Frame direction [0: uplink, 1: downlink]
  * \param [IN]  sequenceCounter - Frame sequence counter
  * \param [OUT] mic             - Computed MIC field
+ *
+ * \retval status               - 0 on success, -1 if the key could not be set up
  */
-void LoRaMacComputeMic( const uint8_t *buffer, uint16_t size, const uint8_t *key, uint32_t address, uint8_t dir, uint32_t sequenceCounter, uint32_t *mic );
+int LoRaMacComputeMic( const uint8_t *buffer, uint16_t size, const uint8_t *key, uint32_t address, uint8_t dir, uint32_t sequenceCounter, uint32_t *mic );
 
 /*!
  * Computes the LoRaMAC payload encryption
@@ -59,8 +61,10 @@ void LoRaMacComputeMic( const uint8_t *buffer, uint16_t size, const uint8_t *key
  * \param [IN]  dir             - Frame direction [0: uplink, 1: downlink]
  * \param [IN]  sequenceCounter - Frame sequence counter
  * \param [OUT] encBuffer       - Encrypted buffer
+ *
+ * \retval status               - 0 on success, -1 if the key could not be set up
  */
-void LoRaMacPayloadEncrypt( const uint8_t *buffer, uint16_t size, const uint8_t *key, uint32_t address, uint8_t dir, uint32_t sequenceCounter, uint8_t *encBuffer );
+int LoRaMacPayloadEncrypt( const uint8_t *buffer, uint16_t size, const uint8_t *key, uint32_t address, uint8_t dir, uint32_t sequenceCounter, uint8_t *encBuffer );
 
 /*!
  * Computes the LoRaMAC payload decryption
@@ -72,8 +76,10 @@ void LoRaMacPayloadEncrypt( const uint8_t *buffer, uint16_t size, const uint8_t
  * \param [IN]  dir             - Frame direction [0: uplink, 1: downlink]
  * \param [IN]  sequenceCounter - Frame sequence counter
  * \param [OUT] decBuffer       - Decrypted buffer
+ *
+ * \retval status               - 0 on success, -1 if the key could not be set up
  */
-void LoRaMacPayloadDecrypt( const uint8_t *buffer, uint16_t size, const uint8_t *key, uint32_t address, uint8_t dir, uint32_t sequenceCounter, uint8_t *decBuffer );
+int LoRaMacPayloadDecrypt( const uint8_t *buffer, uint16_t size, const uint8_t *key, uint32_t address, uint8_t dir, uint32_t sequenceCounter, uint8_t *decBuffer );
 
 /*!
  * Computes the LoRaMAC Join Request frame MIC field
@@ -82,8 +88,10 @@ void LoRaMacPayloadDecrypt( const uint8_t *buffer, uint16_t size, const uint8_t
  * \param [IN]  size            - Data buffer size
  * \param [IN]  key             - AES key to be used
  * \param [OUT] mic             - Computed MIC field
+ *
+ * \retval status               - 0 on success, -1 if the key could not be set up
  */
-void LoRaMacJoinComputeMic( const uint8_t *buffer, uint16_t size, const uint8_t *key, uint32_t *mic );
+int LoRaMacJoinComputeMic( const uint8_t *buffer, uint16_t size, const uint8_t *key, uint32_t *mic );
 
 /*!
  * Computes the LoRaMAC join frame decryption
@@ -92,8 +100,10 @@ void LoRaMacJoinComputeMic( const uint8_t *buffer, uint16_t size, const uint8_t
  * \param [IN]  size            - Data buffer size
  * \param [IN]  key             - AES key to be used
  * \param [OUT] decBuffer       - Decrypted buffer
+ *
+ * \retval status               - 0 on success, -1 if the key could not be set up
  */
-void LoRaMacJoinDecrypt( const uint8_t *buffer, uint16_t size, const uint8_t *key, uint8_t *decBuffer );
+int LoRaMacJoinDecrypt( const uint8_t *buffer, uint16_t size, const uint8_t *key, uint8_t *decBuffer );
 
 /*!
  * Computes the LoRaMAC join frame decryption
@@ -103,8 +113,10 @@ void LoRaMacJoinDecrypt( const uint8_t *buffer, uint16_t size, const uint8_t *ke
  * \param [IN]  devNonce        - Device nonce
  * \param [OUT] nwkSKey         - Network session key
  * \param [OUT] appSKey         - Application session key
+ *
+ * \retval status               - 0 on success, -1 if the key could not be set up
  */
-void LoRaMacJoinComputeSKeys( const uint8_t *key, const uint8_t *appNonce, uint16_t devNonce, uint8_t *nwkSKey, uint8_t *appSKey );
+int LoRaMacJoinComputeSKeys( const uint8_t *key, const uint8_t *appNonce, uint16_t devNonce, uint8_t *nwkSKey, uint8_t *appSKey );
 
 /*! \} defgroup LORAMAC */
 
@@ -38,6 +38,7 @@ STATS_NAME_START(lora_mac_stats)
     STATS_NAME(lora_mac_stats, rx_errors)
     STATS_NAME(lora_mac_stats, rx_frames)
     STATS_NAME(lora_mac_stats, rx_mic_failures)
+    STATS_NAME(lora_mac_stats, rx_crypto_failures)
     STATS_NAME(lora_mac_stats, rx_mlme)
     STATS_NAME(lora_mac_stats, rx_mcps)
     STATS_NAME(lora_mac_stats, rx_dups)
@@ -38,6 +38,7 @@
 #include "node/mac/LoRaMac.h"
 #include "node/mac/LoRaMacTest.h"
 #include "hal/hal_timer.h"
+#include "crypto/crypto.h"
 #include "node/lora_priv.h"
 
 #if MYNEWT_VAL(LORA_MAC_TIMER_NUM) == -1
@@ -574,13 +575,19 @@ lora_mac_join_accept_rxd(uint8_t *payload, uint16_t size)
 
     /* XXX: check for too small frame! */
 
-    LoRaMacJoinDecrypt(payload + 1, size - 1, LoRaMacAppKey,
-                       LoRaMacRxPayload + 1);
+    if (LoRaMacJoinDecrypt(payload + 1, size - 1, LoRaMacAppKey,
+                           LoRaMacRxPayload + 1) != 0) {
+        STATS_INC(lora_mac_stats, rx_crypto_failures);
+        return;
+    }
 
     LoRaMacRxPayload[0] = payload[0];
 
-    LoRaMacJoinComputeMic(LoRaMacRxPayload, size - LORAMAC_MFR_LEN,
-                          LoRaMacAppKey, &mic);
+    if (LoRaMacJoinComputeMic(LoRaMacRxPayload, size - LORAMAC_MFR_LEN,
+                              LoRaMacAppKey, &mic) != 0) {
+        STATS_INC(lora_mac_stats, rx_crypto_failures);
+        return;
+    }
 
     micRx = ( uint32_t )LoRaMacRxPayload[size - LORAMAC_MFR_LEN];
     micRx |= ( ( uint32_t )LoRaMacRxPayload[size - LORAMAC_MFR_LEN + 1] << 8 );
@@ -588,9 +595,15 @@ lora_mac_join_accept_rxd(uint8_t *payload, uint16_t size)
     micRx |= ( ( uint32_t )LoRaMacRxPayload[size - LORAMAC_MFR_LEN + 3] << 24 );
 
     if (micRx == mic) {
-        LoRaMacJoinComputeSKeys(LoRaMacAppKey, LoRaMacRxPayload + 1,
-                                g_lora_mac_data.dev_nonce, LoRaMacNwkSKey,
-                                LoRaMacAppSKey);
+        if (LoRaMacJoinComputeSKeys(LoRaMacAppKey, LoRaMacRxPayload + 1,
+                                    g_lora_mac_data.dev_nonce, LoRaMacNwkSKey,
+                                    LoRaMacAppSKey) != 0) {
+            STATS_INC(lora_mac_stats, rx_crypto_failures);
+            return;
+        }
+
+        /* Wipe cached schedules of the previous session keys. */
+        crypto_aes_key_cache_flush();
 
         temp = ( uint32_t )LoRaMacRxPayload[4];
         temp |= ( ( uint32_t )LoRaMacRxPayload[5] << 8 );
@@ -1014,8 +1027,12 @@ lora_mac_process_radio_rx(struct os_event *ev)
 
             /* Check for correct MIC */
             downLinkCounter += sequenceCounterDiff;
-            LoRaMacComputeMic(payload, size - LORAMAC_MFR_LEN, nwkSKey, address,
-                              DOWN_LINK, downLinkCounter, &mic);
+            if (LoRaMacComputeMic(payload, size - LORAMAC_MFR_LEN, nwkSKey,
+                                  address, DOWN_LINK, downLinkCounter,
+                                  &mic) != 0) {
+                STATS_INC(lora_mac_stats, rx_crypto_failures);
+                goto process_rx_done;
+            }
             if (micRx == mic) {
                 /* XXX: inc mic good stat */
                 rxi->status = LORAMAC_EVENT_INFO_STATUS_OK;
@@ -1152,13 +1169,16 @@ lora_mac_process_radio_rx(struct os_event *ev)
                 if (port == 0) {
                     STATS_INC(lora_mac_stats, rx_mlme);
                     if (fCtrl.Bits.FOptsLen == 0) {
-                        LoRaMacPayloadDecrypt( payload + appPayloadStartIndex,
-                                               frameLen,
-                                               nwkSKey,
-                                               address,
-                                               DOWN_LINK,
-                                               downLinkCounter,
-                                               LoRaMacRxPayload );
+                        if (LoRaMacPayloadDecrypt(payload + appPayloadStartIndex,
+                                                  frameLen,
+                                                  nwkSKey,
+                                                  address,
+                                                  DOWN_LINK,
+                                                  downLinkCounter,
+                                                  LoRaMacRxPayload) != 0) {
+                            STATS_INC(lora_mac_stats, rx_crypto_failures);
+                            goto process_rx_done;
+                        }
 
                         // Decode frame payload MAC commands
                         ProcessMacCommands(LoRaMacRxPayload, 0, frameLen, snr);
@@ -1176,13 +1196,16 @@ lora_mac_process_radio_rx(struct os_event *ev)
                                            snr);
                     }
 
-                    LoRaMacPayloadDecrypt( payload + appPayloadStartIndex,
-                                           frameLen,
-                                           appSKey,
-                                           address,
-                                           DOWN_LINK,
-                                           downLinkCounter,
-                                           LoRaMacRxPayload );
+                    if (LoRaMacPayloadDecrypt(payload + appPayloadStartIndex,
+                                              frameLen,
+                                              appSKey,
+                                              address,
+                                              DOWN_LINK,
+                                              downLinkCounter,
+                                              LoRaMacRxPayload) != 0) {
+                        STATS_INC(lora_mac_stats, rx_crypto_failures);
+                        goto process_rx_done;
+                    }
 
                     if (skipIndication == false ) {
                         g_lora_mac_data.rxbuf = LoRaMacRxPayload;
@@ -2166,8 +2189,10 @@ PrepareFrame(LoRaMacHeader_t *macHdr, LoRaMacFrameCtrl_t *fCtrl, uint8_t fPort,
             LoRaMacBuffer[LoRaMacBufferPktLen++] = (dev_nonce >> 8) & 0xFF;
             g_lora_mac_data.dev_nonce = dev_nonce;
 
-            LoRaMacJoinComputeMic(LoRaMacBuffer, LoRaMacBufferPktLen & 0xFF,
-                                  LoRaMacAppKey, &mic);
+            if (LoRaMacJoinComputeMic(LoRaMacBuffer, LoRaMacBufferPktLen & 0xFF,
+                                      LoRaMacAppKey, &mic) != 0) {
+                return LORAMAC_STATUS_CRYPTO_FAIL;
+            }
 
             LoRaMacBuffer[LoRaMacBufferPktLen++] = mic & 0xFF;
             LoRaMacBuffer[LoRaMacBufferPktLen++] = (mic >> 8) & 0xFF;
@@ -2298,22 +2323,26 @@ PrepareFrame(LoRaMacHeader_t *macHdr, LoRaMacFrameCtrl_t *fCtrl, uint8_t fPort,
                 } else {
                     key = LoRaMacAppSKey;
                 }
-                LoRaMacPayloadEncrypt(LoRaMacBuffer + hdrlen,
-                                      pyld_len,
-                                      key,
-                                      g_lora_mac_data.dev_addr,
-                                      UP_LINK,
-                                      g_lora_mac_data.uplink_cntr,
-                                      LoRaMacBuffer + hdrlen);
+                if (LoRaMacPayloadEncrypt(LoRaMacBuffer + hdrlen,
+                                          pyld_len,
+                                          key,
+                                          g_lora_mac_data.dev_addr,
+                                          UP_LINK,
+                                          g_lora_mac_data.uplink_cntr,
+                                          LoRaMacBuffer + hdrlen) != 0) {
+                    return LORAMAC_STATUS_CRYPTO_FAIL;
+                }
             }
             LoRaMacBufferPktLen = hdrlen + pyld_len;
-            LoRaMacComputeMic(LoRaMacBuffer,
-                              LoRaMacBufferPktLen,
-                              LoRaMacNwkSKey,
-                              g_lora_mac_data.dev_addr,
-                              UP_LINK,
-                              g_lora_mac_data.uplink_cntr,
-                              &mic);
+            if (LoRaMacComputeMic(LoRaMacBuffer,
+                                  LoRaMacBufferPktLen,
+                                  LoRaMacNwkSKey,
+                                  g_lora_mac_data.dev_addr,
+                                  UP_LINK,
+                                  g_lora_mac_data.uplink_cntr,
+                                  &mic) != 0) {
+                return LORAMAC_STATUS_CRYPTO_FAIL;
+            }
 
             LoRaMacBuffer[LoRaMacBufferPktLen + 0] = mic & 0xFF;
             LoRaMacBuffer[LoRaMacBufferPktLen + 1] = ( mic >> 8 ) & 0xFF;
@@ -2773,6 +2802,7 @@ LoRaMacMibSetRequestConfirm(MibRequestConfirm_t *mibSet)
             if (mibSet->Param.NwkSKey != NULL) {
                 memcpy( LoRaMacNwkSKey, mibSet->Param.NwkSKey,
                                sizeof( LoRaMacNwkSKey ) );
+                crypto_aes_key_cache_flush();
             } else {
                 status = LORAMAC_STATUS_PARAMETER_INVALID;
             }
@@ -2781,6 +2811,7 @@ LoRaMacMibSetRequestConfirm(MibRequestConfirm_t *mibSet)
             if (mibSet->Param.AppSKey != NULL) {
                 memcpy( LoRaMacAppSKey, mibSet->Param.AppSKey,
                                sizeof( LoRaMacAppSKey ) );
+                crypto_aes_key_cache_flush();
             } else {
                 status = LORAMAC_STATUS_PARAMETER_INVALID;
             }
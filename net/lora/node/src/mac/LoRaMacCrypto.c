@@ -22,8 +22,7 @@ Maintainer: Miguel Luis ( Semtech ), Gregory Cristian ( Semtech ) and Daniel Jä
 #include <string.h>
 #include "node/utilities.h"
 
-#include "aes.h"
-#include "cmac.h"
+#include "crypto/crypto.h"
 
 #include "node/mac/LoRaMacCrypto.h"
 
@@ -57,14 +56,14 @@ static uint8_t sBlock[] = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
                           };
 
 /*!
- * AES computation context variable
+ * AES key schedule, used when the crypto key cache has no free entry
  */
-static aes_context AesContext;
+static struct crypto_aes_key AesKey;
 
 /*!
  * CMAC computation context variable
  */
-static AES_CMAC_CTX AesCmacCtx[1];
+static struct crypto_aes_cmac_ctx AesCmacCtx;
 
 /*!
  * \brief Computes the LoRaMAC frame MIC field
@@ -76,9 +75,13 @@ static AES_CMAC_CTX AesCmacCtx[1];
  * \param [IN]  dir             Frame direction [0: uplink, 1: downlink]
  * \param [IN]  sequenceCounter Frame sequence counter
  * \param [OUT] mic Computed MIC field
+ *
+ * \retval status               0 on success, -1 if the key could not be set up
  */
-void LoRaMacComputeMic( const uint8_t *buffer, uint16_t size, const uint8_t *key, uint32_t address, uint8_t dir, uint32_t sequenceCounter, uint32_t *mic )
+int LoRaMacComputeMic( const uint8_t *buffer, uint16_t size, const uint8_t *key, uint32_t address, uint8_t dir, uint32_t sequenceCounter, uint32_t *mic )
 {
+    const struct crypto_aes_key *aesKey;
+
     MicBlockB0[5] = dir;
 
     MicBlockB0[6] = ( address ) & 0xFF;
@@ -93,27 +96,39 @@ void LoRaMacComputeMic( const uint8_t *buffer, uint16_t size, const uint8_t *key
 
     MicBlockB0[15] = size & 0xFF;
 
-    AES_CMAC_Init( AesCmacCtx );
+    aesKey = crypto_aes_key_cache_get( key, &AesKey );
+    if( aesKey == NULL )
+    {
+        return -1;
+    }
 
-    AES_CMAC_SetKey( AesCmacCtx, key );
+    crypto_aes_cmac_start( &AesCmacCtx, aesKey );
 
-    AES_CMAC_Update( AesCmacCtx, MicBlockB0, LORAMAC_MIC_BLOCK_B0_SIZE );
+    crypto_aes_cmac_update( &AesCmacCtx, MicBlockB0, LORAMAC_MIC_BLOCK_B0_SIZE );
 
-    AES_CMAC_Update( AesCmacCtx, buffer, size & 0xFF );
+    crypto_aes_cmac_update( &AesCmacCtx, buffer, size & 0xFF );
 
-    AES_CMAC_Final( Mic, AesCmacCtx );
+    crypto_aes_cmac_finish( &AesCmacCtx, Mic );
+
+    crypto_aes_key_cache_put( aesKey );
 
     *mic = ( uint32_t )( ( uint32_t )Mic[3] << 24 | ( uint32_t )Mic[2] << 16 | ( uint32_t )Mic[1] << 8 | ( uint32_t )Mic[0] );
+
+    return 0;
 }
 
-void LoRaMacPayloadEncrypt( const uint8_t *buffer, uint16_t size, const uint8_t *key, uint32_t address, uint8_t dir, uint32_t sequenceCounter, uint8_t *encBuffer )
+int LoRaMacPayloadEncrypt( const uint8_t *buffer, uint16_t size, const uint8_t *key, uint32_t address, uint8_t dir, uint32_t sequenceCounter, uint8_t *encBuffer )
 {
+    const struct crypto_aes_key *aesKey;
     uint16_t i;
     uint8_t bufferIndex = 0;
     uint16_t ctr = 1;
 
-    memset( AesContext.ksch, '\0', 240 );
-    aes_set_key( key, 16, &AesContext );
+    aesKey = crypto_aes_key_cache_get( key, &AesKey );
+    if( aesKey == NULL )
+    {
+        return -1;
+    }
 
     aBlock[5] = dir;
 
@@ -131,7 +146,7 @@ void LoRaMacPayloadEncrypt( const uint8_t *buffer, uint16_t size, const uint8_t
     {
         aBlock[15] = ( ( ctr ) & 0xFF );
         ctr++;
-        aes_encrypt( aBlock, sBlock, &AesContext );
+        crypto_aes_ecb( aesKey, aBlock, sBlock );
         for( i = 0; i < 16; i++ )
         {
             encBuffer[bufferIndex + i] = buffer[bufferIndex + i] ^ sBlock[i];
@@ -143,61 +158,81 @@ void LoRaMacPayloadEncrypt( const uint8_t *buffer, uint16_t size, const uint8_t
     if( size > 0 )
     {
         aBlock[15] = ( ( ctr ) & 0xFF );
-        aes_encrypt( aBlock, sBlock, &AesContext );
+        crypto_aes_ecb( aesKey, aBlock, sBlock );
         for( i = 0; i < size; i++ )
         {
             encBuffer[bufferIndex + i] = buffer[bufferIndex + i] ^ sBlock[i];
         }
     }
+
+    crypto_aes_key_cache_put( aesKey );
+
+    return 0;
 }
 
-void LoRaMacPayloadDecrypt( const uint8_t *buffer, uint16_t size, const uint8_t *key, uint32_t address, uint8_t dir, uint32_t sequenceCounter, uint8_t *decBuffer )
+int LoRaMacPayloadDecrypt( const uint8_t *buffer, uint16_t size, const uint8_t *key, uint32_t address, uint8_t dir, uint32_t sequenceCounter, uint8_t *decBuffer )
 {
-    LoRaMacPayloadEncrypt( buffer, size, key, address, dir, sequenceCounter, decBuffer );
+    return LoRaMacPayloadEncrypt( buffer, size, key, address, dir, sequenceCounter, decBuffer );
 }
 
-void LoRaMacJoinComputeMic( const uint8_t *buffer, uint16_t size, const uint8_t *key, uint32_t *mic )
+int LoRaMacJoinComputeMic( const uint8_t *buffer, uint16_t size, const uint8_t *key, uint32_t *mic )
 {
-    AES_CMAC_Init( AesCmacCtx );
-
-    AES_CMAC_SetKey( AesCmacCtx, key );
-
-    AES_CMAC_Update( AesCmacCtx, buffer, size & 0xFF );
-
-    AES_CMAC_Final( Mic, AesCmacCtx );
+    if( crypto_aes_cmac_raw( key, buffer, size & 0xFF, Mic ) != 0 )
+    {
+        return -1;
+    }
 
     *mic = ( uint32_t )( ( uint32_t )Mic[3] << 24 | ( uint32_t )Mic[2] << 16 | ( uint32_t )Mic[1] << 8 | ( uint32_t )Mic[0] );
+
+    return 0;
 }
 
-void LoRaMacJoinDecrypt( const uint8_t *buffer, uint16_t size, const uint8_t *key, uint8_t *decBuffer )
+int LoRaMacJoinDecrypt( const uint8_t *buffer, uint16_t size, const uint8_t *key, uint8_t *decBuffer )
 {
-    memset( AesContext.ksch, '\0', 240 );
-    aes_set_key( key, 16, &AesContext );
-    aes_encrypt( buffer, decBuffer, &AesContext );
+    const struct crypto_aes_key *aesKey;
+
+    aesKey = crypto_aes_key_cache_get( key, &AesKey );
+    if( aesKey == NULL )
+    {
+        return -1;
+    }
+
+    crypto_aes_ecb( aesKey, buffer, decBuffer );
     // Check if optional CFList is included
     if( size >= 16 )
     {
-        aes_encrypt( buffer + 16, decBuffer + 16, &AesContext );
+        crypto_aes_ecb( aesKey, buffer + 16, decBuffer + 16 );
     }
+    crypto_aes_key_cache_put( aesKey );
+
+    return 0;
 }
 
-void LoRaMacJoinComputeSKeys( const uint8_t *key, const uint8_t *appNonce, uint16_t devNonce, uint8_t *nwkSKey, uint8_t *appSKey )
+int LoRaMacJoinComputeSKeys( const uint8_t *key, const uint8_t *appNonce, uint16_t devNonce, uint8_t *nwkSKey, uint8_t *appSKey )
 {
     uint8_t nonce[16];
     uint8_t *pDevNonce = ( uint8_t * )&devNonce;
+    const struct crypto_aes_key *aesKey;
 
-    memset( AesContext.ksch, '\0', 240 );
-    aes_set_key( key, 16, &AesContext );
+    aesKey = crypto_aes_key_cache_get( key, &AesKey );
+    if( aesKey == NULL )
+    {
+        return -1;
+    }
 
     memset( nonce, 0, sizeof( nonce ) );
     nonce[0] = 0x01;
     memcpy( nonce + 1, appNonce, 6 );
     memcpy( nonce + 7, pDevNonce, 2 );
-    aes_encrypt( nonce, nwkSKey, &AesContext );
+    crypto_aes_ecb( aesKey, nonce, nwkSKey );
 
     memset( nonce, 0, sizeof( nonce ) );
     nonce[0] = 0x02;
     memcpy( nonce + 1, appNonce, 6 );
     memcpy( nonce + 7, pDevNonce, 2 );
-    aes_encrypt( nonce, appSKey, &AesContext );
+    crypto_aes_ecb( aesKey, nonce, appSKey );
+
+    crypto_aes_key_cache_put( aesKey );
+
+    return 0;
 }
@@ -13,6 +13,7 @@
 #include "mesh/mesh.h"
 
 #include "syscfg/syscfg.h"
+#include "crypto/crypto.h"
 #define BT_DBG_ENABLED MYNEWT_VAL(BLE_MESH_DEBUG_MODEL)
 #include "host/ble_hs_log.h"
 
@@ -518,6 +519,7 @@ static void _app_key_del(struct bt_mesh_app_key *key)
 
 	key->net_idx = BT_MESH_KEY_UNUSED;
 	memset(key->keys, 0, sizeof(key->keys));
+	crypto_aes_key_cache_flush();
 }
 
 static void app_key_del(struct bt_mesh_model *model,
@@ -2190,6 +2192,7 @@ static void net_key_del(struct bt_mesh_model *model,
 
 	memset(sub, 0, sizeof(*sub));
 	sub->net_idx = BT_MESH_KEY_UNUSED;
+	crypto_aes_key_cache_flush();
 
 	status = STATUS_SUCCESS;
 
@@ -13,6 +13,7 @@
 #include "mesh/mesh.h"
 
 #include "syscfg/syscfg.h"
+#include "crypto/crypto.h"
 #define BT_DBG_ENABLED (MYNEWT_VAL(BLE_MESH_DEBUG))
 #include "host/ble_hs_log.h"
 
@@ -112,6 +113,9 @@ void bt_mesh_reset(void)
 
 	bt_mesh_cfg_reset();
 
+	/* Wipe any cached key schedules of the deleted keys */
+	crypto_aes_key_cache_flush();
+
 	bt_mesh_rx_reset();
 	bt_mesh_tx_reset();
 
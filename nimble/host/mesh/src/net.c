@@ -14,6 +14,7 @@
 #include "mesh/mesh.h"
 
 #include "syscfg/syscfg.h"
+#include "crypto/crypto.h"
 #define BT_DBG_ENABLED MYNEWT_VAL(BLE_MESH_DEBUG_NET)
 #include "host/ble_hs_log.h"
 
@@ -511,6 +512,9 @@ void bt_mesh_net_revoke_keys(struct bt_mesh_subnet *sub)
 		memcpy(&key->keys[0], &key->keys[1], sizeof(key->keys[0]));
 		key->updated = false;
 	}
+
+	/* Wipe any cached key schedules of the revoked keys */
+	crypto_aes_key_cache_flush();
 }
 
 bool bt_mesh_kr_update(struct bt_mesh_subnet *sub, u8_t new_kr, bool new_key)
@@ -16,8 +16,6 @@
 #include "mesh/mesh.h"
 #include "mesh_priv.h"
 
-#include <tinycrypt/ecc.h>
-
 #include "crypto.h"
 #include "atomic.h"
 #include "adv.h"
@@ -101,6 +101,11 @@ STATS_NAME_START(ble_hs_stats)
     STATS_NAME(ble_hs_stats, pvcy_add_entry_fail)
 STATS_NAME_END(ble_hs_stats)
 
+STATS_SECT_DECL(ble_hs_lat_stats) ble_hs_lat_stats;
+STATS_NAME_START(ble_hs_lat_stats)
+    STATS_NAME(ble_hs_lat_stats, hci_cmd_tx)
+STATS_NAME_END(ble_hs_lat_stats)
+
 struct ble_npl_eventq *
 ble_hs_evq_get(void)
 {
@@ -671,6 +676,12 @@ ble_hs_init(void)
         STATS_SIZE_32), STATS_NAME_INIT_PARMS(ble_hs_stats), "ble_hs");
     SYSINIT_PANIC_ASSERT(rc == 0);
 
+    rc = stats_init_and_reg(
+        STATS_HDR(ble_hs_lat_stats), STATS_SIZE_INIT_PARMS(ble_hs_lat_stats,
+        STATS_SIZE_HIST), STATS_NAME_INIT_PARMS(ble_hs_lat_stats),
+        "ble_hs_lat");
+    SYSINIT_PANIC_ASSERT(rc == 0);
+
     rc = ble_npl_mutex_init(&ble_hs_mutex);
     SYSINIT_PANIC_ASSERT(rc == 0);
 
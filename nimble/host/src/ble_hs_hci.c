@@ -21,6 +21,7 @@
 #include <errno.h>
 #include <stdio.h>
 #include "os/os.h"
+#include "os/os_cputime.h"
 #include "mem/mem.h"
 #include "nimble/ble_hci_trans.h"
 #include "host/ble_monitor.h"
@@ -286,11 +287,13 @@ ble_hs_hci_cmd_tx(uint16_t opcode, void *cmd, uint8_t cmd_len,
                   uint8_t *out_evt_buf_len)
 {
     struct ble_hs_hci_ack ack;
+    uint32_t start;
     int rc;
 
     BLE_HS_DBG_ASSERT(ble_hs_hci_ack == NULL);
     ble_hs_hci_lock();
 
+    start = os_cputime_get32();
     rc = ble_hs_hci_cmd_send_buf(opcode, cmd, cmd_len);
     if (rc != 0) {
         goto done;
@@ -301,6 +304,8 @@ ble_hs_hci_cmd_tx(uint16_t opcode, void *cmd, uint8_t cmd_len,
         ble_hs_sched_reset(rc);
         goto done;
     }
+    STATS_HIST_RECORD(ble_hs_lat_stats, hci_cmd_tx,
+                      os_cputime_ticks_to_usecs(os_cputime_get32() - start));
 
     rc = ble_hs_hci_process_ack(opcode, evt_buf, evt_buf_len, &ack);
     if (rc != 0) {
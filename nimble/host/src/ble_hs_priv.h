@@ -88,6 +88,12 @@ STATS_SECT_START(ble_hs_stats)
 STATS_SECT_END
 extern STATS_SECT_DECL(ble_hs_stats) ble_hs_stats;
 
+/* Latency histograms, in microseconds. */
+STATS_SECT_START(ble_hs_lat_stats)
+    STATS_SECT_HIST(hci_cmd_tx)
+STATS_SECT_END
+extern STATS_SECT_DECL(ble_hs_lat_stats) ble_hs_lat_stats;
+
 extern struct os_mbuf_pool ble_hs_mbuf_pool;
 extern uint8_t ble_hs_sync_state;
 
@@ -46,6 +46,7 @@
 #include "nimble/ble.h"
 #include "nimble/nimble_opt.h"
 #include "host/ble_sm.h"
+#include "crypto/crypto.h"
 #include "ble_hs_priv.h"
 
 #if NIMBLE_BLE_SM
@@ -400,6 +401,9 @@ ble_sm_proc_free(struct ble_sm_proc *proc)
 #endif
         rc = os_memblock_put(&ble_sm_proc_pool, proc);
         BLE_HS_DBG_ASSERT_EVAL(rc == 0);
+
+        /* Don't leave the schedules of this pairing's keys cached. */
+        crypto_aes_key_cache_flush();
     }
 }
 
@@ -28,13 +28,9 @@
 #include "nimble/ble.h"
 #include "nimble/nimble_opt.h"
 #include "ble_hs_priv.h"
-#include "tinycrypt/aes.h"
-#include "tinycrypt/constants.h"
-#include "tinycrypt/utils.h"
+#include "crypto/crypto.h"
 
 #if MYNEWT_VAL(BLE_SM_SC)
-#include "tinycrypt/cmac_mode.h"
-#include "tinycrypt/ecc_dh.h"
 #if MYNEWT_VAL(TRNG)
 #include "trng/trng.h"
 #endif
@@ -57,20 +53,14 @@ ble_sm_alg_xor_128(uint8_t *p, uint8_t *q, uint8_t *r)
 static int
 ble_sm_alg_encrypt(uint8_t *key, uint8_t *plaintext, uint8_t *enc_data)
 {
-    struct tc_aes_key_sched_struct s;
+    uint8_t tmp_key[16];
     uint8_t tmp[16];
 
-    swap_buf(tmp, key, 16);
-
-    if (tc_aes128_set_encrypt_key(&s, tmp) == TC_CRYPTO_FAIL) {
-        return BLE_HS_EUNKNOWN;
-    }
-
+    swap_buf(tmp_key, key, 16);
     swap_buf(tmp, plaintext, 16);
 
-
-
-    if (tc_aes_encrypt(enc_data, tmp, &s) == TC_CRYPTO_FAIL) {
+    /* c1 encrypts twice with the same key; the cache keeps the schedule. */
+    if (crypto_aes_ecb_raw(tmp_key, tmp, enc_data) != 0) {
         return BLE_HS_EUNKNOWN;
     }
 
@@ -206,18 +196,7 @@ static int
 ble_sm_alg_aes_cmac(const uint8_t *key, const uint8_t *in, size_t len,
                     uint8_t *out)
 {
-    struct tc_aes_key_sched_struct sched;
-    struct tc_cmac_struct state;
-
-    if (tc_cmac_setup(&state, key, &sched) == TC_CRYPTO_FAIL) {
-        return BLE_HS_EUNKNOWN;
-    }
-
-    if (tc_cmac_update(&state, in, len) == TC_CRYPTO_FAIL) {
-        return BLE_HS_EUNKNOWN;
-    }
-
-    if (tc_cmac_final(out, &state) == TC_CRYPTO_FAIL) {
+    if (crypto_aes_cmac_raw(key, in, len, out) != 0) {
         return BLE_HS_EUNKNOWN;
     }
 
@@ -431,12 +410,8 @@ ble_sm_alg_gen_dhkey(uint8_t *peer_pub_key_x, uint8_t *peer_pub_key_y,
     swap_buf(&pk[32], peer_pub_key_y, 32);
     swap_buf(priv, our_priv_key, 32);
 
-    if (uECC_valid_public_key(pk, &curve_secp256r1) < 0) {
-        return BLE_HS_EUNKNOWN;
-    }
-
-    rc = uECC_shared_secret(pk, priv, dh, &curve_secp256r1);
-    if (rc == TC_CRYPTO_FAIL) {
+    rc = crypto_p256_dhkey(pk, priv, dh);
+    if (rc != 0) {
         return BLE_HS_EUNKNOWN;
     }
 
@@ -462,7 +437,7 @@ ble_sm_alg_gen_key_pair(uint8_t *pub, uint8_t *priv)
     uint8_t pk[64];
 
     do {
-        if (uECC_make_key(pk, priv, &curve_secp256r1) != TC_CRYPTO_SUCCESS) {
+        if (crypto_p256_keypair_gen(pk, priv, NULL, NULL) != 0) {
             return BLE_HS_EUNKNOWN;
         }
 
@@ -476,9 +451,9 @@ ble_sm_alg_gen_key_pair(uint8_t *pub, uint8_t *priv)
     return 0;
 }
 
-/* used by uECC to get random data */
+/* used by the crypto package to get random data */
 static int
-ble_sm_alg_rand(uint8_t *dst, unsigned int size)
+ble_sm_alg_rand(void *arg, uint8_t *dst, size_t size)
 {
 #if MYNEWT_VAL(TRNG)
     size_t num;
@@ -495,17 +470,17 @@ ble_sm_alg_rand(uint8_t *dst, unsigned int size)
     }
 #else
     if (ble_hs_hci_util_rand(dst, size)) {
-        return 0;
+        return BLE_HS_EUNKNOWN;
     }
 #endif
 
-    return 1;
+    return 0;
 }
 
 void
 ble_sm_alg_ecc_init(void)
 {
-    uECC_set_rng(ble_sm_alg_rand);
+    crypto_rng_set(ble_sm_alg_rand, NULL);
 }
 
 #endif
@@ -38,6 +38,8 @@ extern "C" {
 #define STATS_SECT_ENTRY16(__var)
 #define STATS_SECT_ENTRY32(__var)
 #define STATS_SECT_ENTRY64(__var)
+#define STATS_SECT_SUMMARY(__var)
+#define STATS_SECT_HIST(__var)
 #define STATS_RESET(__var)
 
 #define STATS_SIZE_INIT_PARMS(__sectvarname, __size) \
@@ -46,6 +48,10 @@ extern "C" {
 #define STATS_INC(__sectvarname, __var)
 #define STATS_INCN(__sectvarname, __var, __n)
 #define STATS_CLEAR(__sectvarname, __var)
+#define STATS_INC_ATOMIC(__sectvarname, __var)
+#define STATS_INCN_ATOMIC(__sectvarname, __var, __n)
+#define STATS_SUMMARY_RECORD(__sectvarname, __var, __val) ((void)(__val))
+#define STATS_HIST_RECORD(__sectvarname, __var, __val)  ((void)(__val))
 
 #define STATS_NAME_START(__name)
 #define STATS_NAME(__name, __entry)
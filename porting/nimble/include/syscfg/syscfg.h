@@ -134,6 +134,23 @@
 #define MYNEWT_VAL_UART_1_PIN_TX (-1)
 #endif
 
+/*** hw/drivers/crypto */
+#ifndef MYNEWT_VAL_CRYPTO_TINYCRYPT
+#define MYNEWT_VAL_CRYPTO_TINYCRYPT (1)
+#endif
+
+#ifndef MYNEWT_VAL_CRYPTO_MBEDTLS
+#define MYNEWT_VAL_CRYPTO_MBEDTLS (0)
+#endif
+
+#ifndef MYNEWT_VAL_CRYPTO_HW
+#define MYNEWT_VAL_CRYPTO_HW (0)
+#endif
+
+#ifndef MYNEWT_VAL_CRYPTO_AES_KEY_CACHE_SIZE
+#define MYNEWT_VAL_CRYPTO_AES_KEY_CACHE_SIZE (0)
+#endif
+
 /*** hw/mcu/nordic/nrf52xxx */
 #ifndef MYNEWT_VAL_ADC_0
 #define MYNEWT_VAL_ADC_0 (0)
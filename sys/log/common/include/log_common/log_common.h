@@ -70,6 +70,7 @@ struct log;
 #if MYNEWT_VAL(LOG_VERSION) > 2
 #define LOG_ETYPE_CBOR           (1)
 #define LOG_ETYPE_BINARY         (2)
+#define LOG_ETYPE_DICT           (3)
 #endif
 
 /* Logging medium */
@@ -96,6 +97,7 @@ struct log;
 #define LOGS_NMGR_OP_LEVEL_LIST   	(4)
 #define LOGS_NMGR_OP_LOGS_LIST    	(5)
 #define LOGS_NMGR_OP_SET_WATERMARK	(6)
+#define LOGS_NMGR_OP_QUERY        	(7)
 
 #define LOG_PRINTF_MAX_ENTRY_LEN (128)
 
@@ -25,6 +25,9 @@
 #if MYNEWT_VAL(LOG_STATS)
 #include "stats/stats.h"
 #endif
+#if MYNEWT_VAL(LOG_DICT)
+#include "log/log_dict.h"
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -32,6 +35,7 @@ extern "C" {
 
 struct log;
 struct log_entry_hdr;
+struct log_query;
 
 /**
  * Used for walks and reads; indicates part of log to access.
@@ -66,6 +70,56 @@ struct log_storage_info {
 };
 #endif
 
+#if MYNEWT_VAL(LOG_QUERY)
+#define LOG_QUERY_MODULE_WORDS  ((LOG_MODULE_MAX + 1) / 32)
+
+/**
+ * Entry filter for log_query().  log_query_init() sets up a query that
+ * accepts every entry; the caller then narrows the fields it cares about.
+ */
+struct log_query {
+    /* Accepted modules, one bit per module ID. */
+    uint32_t lq_modules[LOG_QUERY_MODULE_WORDS];
+
+    /* Entries with a lower level are skipped. */
+    uint8_t lq_min_level;
+
+    /* Accepted entry types, one bit per LOG_ETYPE_[...] value. */
+    uint8_t lq_etypes;
+
+    /* Only entries with lq_ts_min <= ts <= lq_ts_max are accepted. */
+    int64_t lq_ts_min;
+    int64_t lq_ts_max;
+
+    /* Only entries whose index >= lq_index are accepted. */
+    uint32_t lq_index;
+
+    /* Set by log_query(): number of storage sectors that were skipped
+     * without being read, based on their summaries.
+     */
+    uint32_t lq_skipped;
+};
+
+#if MYNEWT_VAL(LOG_FCB)
+#define LOG_FCB_SUM_F_USED      0x01
+
+/**
+ * Summary of the entries in one FCB sector; lets log_query() skip sectors
+ * that cannot contain a match.  Modules are hashed to one bit each
+ * (module % 32), and timestamps are kept in seconds.
+ */
+struct log_fcb_sum {
+    uint32_t lfs_modules;
+    uint32_t lfs_ts_min;
+    uint32_t lfs_ts_max;
+    uint32_t lfs_index_max;
+    uint8_t lfs_level_max;
+    uint8_t lfs_etypes;
+    uint8_t lfs_flags;
+};
+#endif
+#endif
+
 typedef int (*log_walk_func_t)(struct log *, struct log_offset *log_offset,
         void *dptr, uint16_t len);
 
@@ -94,6 +148,11 @@ typedef int (*lh_storage_info_func_t)(struct log *, struct log_storage_info *);
 #if MYNEWT_VAL(LOG_STORAGE_WATERMARK)
 typedef int (*lh_set_watermark_func_t)(struct log *, uint32_t);
 #endif
+#if MYNEWT_VAL(LOG_QUERY)
+typedef int (*lh_walk_query_func_t)(struct log *, log_walk_func_t walk_func,
+                                    struct log_offset *log_offset,
+                                    struct log_query *query);
+#endif
 typedef int (*lh_registered_func_t)(struct log *);
 
 struct log_handler {
@@ -111,6 +170,12 @@ struct log_handler {
 #endif
 #if MYNEWT_VAL(LOG_STORAGE_WATERMARK)
     lh_set_watermark_func_t log_set_watermark;
+#endif
+#if MYNEWT_VAL(LOG_QUERY)
+    /* Optional; walks only the parts of the log that may hold entries
+     * matching the query.  The walk callback still filters each entry.
+     */
+    lh_walk_query_func_t log_walk_query;
 #endif
     /* Functions called only internally (no API for apps) */
     lh_registered_func_t log_registered;
@@ -139,36 +204,48 @@ struct log_entry_hdr {
 
 #define LOG_MODULE_STR(module)      log_module_get_name(module)
 
+/*
+ * With LOG_DICT, the level macros store the format string ID and the raw
+ * arguments instead of the formatted text.
+ */
+#if MYNEWT_VAL(LOG_DICT)
+#define LOG_PRINTF(__l, __mod, __lvl, __msg, ...) log_printf_dict(__l, \
+        __mod, __lvl, LOG_DICT_FMT(__msg), ##__VA_ARGS__)
+#else
+#define LOG_PRINTF(__l, __mod, __lvl, __msg, ...) log_printf(__l, __mod, \
+        __lvl, __msg, ##__VA_ARGS__)
+#endif
+
 #if MYNEWT_VAL(LOG_LEVEL) <= LOG_LEVEL_DEBUG
-#define LOG_DEBUG(__l, __mod, __msg, ...) log_printf(__l, __mod, \
+#define LOG_DEBUG(__l, __mod, __msg, ...) LOG_PRINTF(__l, __mod, \
         LOG_LEVEL_DEBUG, __msg, ##__VA_ARGS__)
 #else
 #define LOG_DEBUG(__l, __mod, ...) IGNORE(__VA_ARGS__)
 #endif
 
 #if MYNEWT_VAL(LOG_LEVEL) <= LOG_LEVEL_INFO
-#define LOG_INFO(__l, __mod, __msg, ...) log_printf(__l, __mod, \
+#define LOG_INFO(__l, __mod, __msg, ...) LOG_PRINTF(__l, __mod, \
         LOG_LEVEL_INFO, __msg, ##__VA_ARGS__)
 #else
 #define LOG_INFO(__l, __mod, ...) IGNORE(__VA_ARGS__)
 #endif
 
 #if MYNEWT_VAL(LOG_LEVEL) <= LOG_LEVEL_WARN
-#define LOG_WARN(__l, __mod, __msg, ...) log_printf(__l, __mod, \
+#define LOG_WARN(__l, __mod, __msg, ...) LOG_PRINTF(__l, __mod, \
         LOG_LEVEL_WARN, __msg, ##__VA_ARGS__)
 #else
 #define LOG_WARN(__l, __mod, ...) IGNORE(__VA_ARGS__)
 #endif
 
 #if MYNEWT_VAL(LOG_LEVEL) <= LOG_LEVEL_ERROR
-#define LOG_ERROR(__l, __mod, __msg, ...) log_printf(__l, __mod, \
+#define LOG_ERROR(__l, __mod, __msg, ...) LOG_PRINTF(__l, __mod, \
         LOG_LEVEL_ERROR, __msg, ##__VA_ARGS__)
 #else
 #define LOG_ERROR(__l, __mod, ...) IGNORE(__VA_ARGS__)
 #endif
 
 #if MYNEWT_VAL(LOG_LEVEL) <= LOG_LEVEL_CRITICAL
-#define LOG_CRITICAL(__l, __mod, __msg, ...) log_printf(__l, __mod, \
+#define LOG_CRITICAL(__l, __mod, __msg, ...) LOG_PRINTF(__l, __mod, \
         LOG_LEVEL_CRITICAL, __msg, ##__VA_ARGS__)
 #else
 #define LOG_CRITICAL(__l, __mod, ...) IGNORE(__VA_ARGS__)
@@ -495,6 +572,23 @@ log_append_mbuf(struct log *log, uint8_t module, uint8_t level,
 
 void log_printf(struct log *log, uint8_t module, uint8_t level,
         const char *msg, ...);
+
+#if MYNEWT_VAL(LOG_DICT)
+/**
+ * @brief Writes a dictionary entry (LOG_ETYPE_DICT) to a log.
+ *
+ * The level is checked before any argument is looked at.  Usually called
+ * through the LOG_[...] macros, which place the format string in the
+ * dictionary.
+ *
+ * @param log                   The log to write to.
+ * @param module                The log module of the entry to write.
+ * @param level                 The severity of the log entry to write.
+ * @param fmt                   A format string produced by LOG_DICT_FMT().
+ */
+void log_printf_dict(struct log *log, uint8_t module, uint8_t level,
+                     const char *fmt, ...);
+#endif
 int log_read(struct log *log, void *dptr, void *buf, uint16_t off,
         uint16_t len);
 
@@ -567,6 +661,62 @@ int log_walk(struct log *log, log_walk_func_t walk_func,
  */
 int log_walk_body(struct log *log, log_walk_body_func_t walk_body_func,
         struct log_offset *log_offset);
+
+#if MYNEWT_VAL(LOG_QUERY)
+/**
+ * @brief Initializes a query that accepts every entry.
+ *
+ * @param query                 The query to initialize.
+ */
+void log_query_init(struct log_query *query);
+
+/**
+ * @brief Restricts a query to the specified modules.
+ *
+ * @param query                 The query to modify.
+ * @param modules               Array of accepted module IDs.
+ * @param count                 Number of elements in modules; 0 accepts all
+ *                                  modules.
+ */
+void log_query_set_modules(struct log_query *query, const uint8_t *modules,
+                           int count);
+
+/**
+ * @brief Indicates whether an entry matches a query.
+ *
+ * @param query                 The query to match against.
+ * @param hdr                   The header of the entry.
+ *
+ * @return                      true if the entry matches; false otherwise.
+ */
+bool log_query_match(const struct log_query *query,
+                     const struct log_entry_hdr *hdr);
+
+/**
+ * @brief Applies a callback to each entry matching a query.
+ *
+ * Similar to `log_walk_body`, except entries are selected by the query
+ * rather than by the index and timestamp in log_offset.  Handlers that keep
+ * per-sector summaries (log_fcb with fl_sums set) skip sectors that cannot
+ * hold a match without reading them.
+ *
+ * @param log                   The log to query.
+ * @param query                 Selects the entries to process.  On return,
+ *                                  lq_skipped holds the number of sectors
+ *                                  skipped.
+ * @param walk_body_func        The function to apply to each matching entry.
+ * @param log_offset            Passes lo_arg and lo_data_len to the
+ *                                  callback; lo_ts and lo_index are set by
+ *                                  this function.
+ *
+ * @return                      0 if the walk completed successfully;
+ *                              nonzero on error or if the walk was aborted.
+ */
+int log_query(struct log *log, struct log_query *query,
+              log_walk_body_func_t walk_body_func,
+              struct log_offset *log_offset);
+#endif
+
 int log_flush(struct log *log);
 
 #if MYNEWT_VAL(LOG_MODULE_LEVELS)
@@ -0,0 +1,125 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef __SYS_LOG_DICT_H__
+#define __SYS_LOG_DICT_H__
+
+#include <stdarg.h>
+#include <inttypes.h>
+#include "os/mynewt.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if MYNEWT_VAL(LOG_VERSION) < 3
+#error "LOG_DICT requires LOG_VERSION 3"
+#endif
+
+/*
+ * Dictionary log entries (LOG_ETYPE_DICT) have the following body:
+ *
+ *     [format ID (4)] [arg] [arg] ...
+ *
+ * The format ID is the offset of the format string within the `log_dict`
+ * section.  Each argument is stored in the order it appears in the format
+ * string, little endian, with the width of its C type on the target (int,
+ * long, pointers, etc.; doubles are 8 bytes).  A `*` width or precision is
+ * stored as an int ahead of the argument it applies to.  `%s` arguments are
+ * copied inline, including the terminating null.  An entry that does not fit
+ * in the encode buffer is cut after the last complete argument.
+ */
+
+/** Size of the format ID that starts every dictionary entry. */
+#define LOG_DICT_ID_SIZE        4
+
+#define LOG_DICT_SECTION        __attribute__((section("log_dict"), used))
+
+/**
+ * Places a format string literal in the `log_dict` section and evaluates to
+ * its address.  The argument must be a string literal.
+ */
+#define LOG_DICT_FMT(fmt_) (__extension__({                                 \
+    static const char log_dict_fmt_[] LOG_DICT_SECTION = "" fmt_;           \
+    log_dict_fmt_;                                                          \
+}))
+
+/**
+ * @brief Retrieves the ID of a format string in the dictionary.
+ *
+ * @param fmt                   A string produced by LOG_DICT_FMT().
+ * @param out_id                On success, the ID gets written here.
+ *
+ * @return                      0 on success;
+ *                              SYS_ENOENT if the string is not in the
+ *                                  dictionary.
+ */
+int log_dict_id(const char *fmt, uint32_t *out_id);
+
+/**
+ * @brief Looks up the format string with the specified ID.
+ *
+ * @return                      The format string on success;
+ *                              NULL if the ID is not in the dictionary.
+ */
+const char *log_dict_lookup(uint32_t id);
+
+/**
+ * @brief Encodes a dictionary entry body.
+ *
+ * Only the conversion specifiers of the format string are visited; nothing
+ * is formatted.
+ *
+ * @param buf                   The buffer to encode into.
+ * @param buf_len               The size of the buffer.
+ * @param fmt                   A string produced by LOG_DICT_FMT().
+ * @param ap                    The format arguments.
+ *
+ * @return                      The number of bytes encoded on success;
+ *                              SYS_EINVAL if the buffer cannot hold the
+ *                                  format ID;
+ *                              SYS_ENOENT if the string is not in the
+ *                                  dictionary.
+ */
+int log_dict_vencode(void *buf, int buf_len, const char *fmt, va_list ap);
+int log_dict_encode(void *buf, int buf_len, const char *fmt, ...);
+
+/**
+ * @brief Expands a dictionary entry body into text.
+ *
+ * Arguments that are missing from a truncated body are printed as `?`.
+ *
+ * @param dst                   The buffer to write the null-terminated text
+ *                                  to.
+ * @param dst_len               The size of the buffer.
+ * @param body                  The entry body.
+ * @param body_len              The length of the entry body.
+ *
+ * @return                      The length of the text (excluding the null
+ *                                  terminator) on success;
+ *                              SYS_EINVAL if the body is too short;
+ *                              SYS_ENOENT if the format ID is unknown.
+ */
+int log_dict_format(char *dst, int dst_len, const void *body, int body_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,144 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef __SYS_LOG_TIERED_H__
+#define __SYS_LOG_TIERED_H__
+
+#include "syscfg/syscfg.h"
+
+#if MYNEWT_VAL(LOG_TIERED)
+
+#include "os/mynewt.h"
+#include "log/log.h"
+#include "fcb/fcb.h"
+#include "cbmem/cbmem.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Argument for log_tiered_handler
+ *
+ * Entries are appended to a RAM front buffer (cbmem) and moved ("spilled")
+ * to FCB in bulk.  The RAM buffer is split into two halves: one takes new
+ * entries while the other one is being written to flash.  A spill packs as
+ * many entries as fit into a single FCB element, so the per-element flash
+ * overhead (length, CRC and alignment padding) is paid once per batch rather
+ * than once per entry.
+ *
+ * If the front half fills up before it is spilled, for example while the
+ * other half is still being written, it wraps like any cbmem and its oldest
+ * entries are overwritten.  Overwritten entries are counted in the log's
+ * "lost" statistic.
+ *
+ * log_tiered_init() shall be used to initialize this structure.
+ */
+struct log_tiered {
+    /* Protects appends to the front half and the swap of the halves. */
+    struct os_mutex lt_mutex;
+    /* Held while a spill is in progress and while the log is walked. */
+    struct os_mutex lt_spill_mutex;
+
+    struct log *lt_log;
+    struct log lt_fcb;
+    struct log lt_mem[2];
+    struct cbmem lt_cbmem[2];
+
+    /* Index of the half that takes new entries. */
+    uint8_t lt_front;
+    /* Set while the other half is being written to FCB. */
+    uint8_t lt_spilling;
+
+    /* Bytes appended to the front half since the last swap. */
+    uint32_t lt_front_bytes;
+    /* Front half fill level which triggers a spill. */
+    uint32_t lt_watermark;
+    /* Oldest front half sequence number before the current append. */
+    uint32_t lt_front_start_seq;
+
+    /* Position of the next entry to spill; allows resuming a spill. */
+    struct cbmem_iter lt_iter;
+    struct cbmem_entry_hdr *lt_next;
+
+    struct os_event lt_spill_ev;
+    struct os_callout lt_timer;
+};
+
+/*
+ * Initialize log data for log_tiered handler
+ *
+ * fcb_arg is the same as for log_fcb and must be initialized (fcb_init())
+ * before the log is registered.  The FCB must not be shared with a log_fcb
+ * handler: each FCB element holds a batch of entries, each one prefixed with
+ * its 16-bit length.  buf is split into two front buffer halves.
+ *
+ * @param lt             Log data structure to initialize
+ * @param fcb_arg        Log data for the FCB tier
+ * @param buf            Memory for the RAM tier
+ * @param buf_len        Size of buf, in bytes
+ *
+ * @return 0 on success, non-zero on failure
+ */
+int log_tiered_init(struct log_tiered *lt, struct fcb_log *fcb_arg,
+                    void *buf, uint32_t buf_len);
+
+/*
+ * Write all entries held in RAM to FCB
+ *
+ * Spills are normally run from the default event queue, either periodically
+ * (LOG_TIERED_SPILL_INTERVAL) or when the front half fills past
+ * LOG_TIERED_WATERMARK.  This function spills synchronously.
+ *
+ * @param log            Log registered with log_tiered_handler
+ *
+ * @return 0 on success, non-zero on failure
+ */
+int log_tiered_spill(struct log *log);
+
+/*
+ * Write RAM-held entries of all tiered logs to FCB after a fault
+ *
+ * This is called from log_reboot() on an assert or fault, so that entries
+ * written just before the crash survive the reset.  It runs with interrupts
+ * disabled for the whole multi-sector write and does not take any log
+ * mutex, so it is only meant for a system that is about to reset.  A log
+ * whose front half (lt_mutex) or FCB is in use by the interrupted code is
+ * skipped.
+ */
+void log_tiered_crash_flush(void);
+
+/*
+ * Write RAM-held entries of all tiered logs to FCB
+ *
+ * This is called from log_reboot() before a requested reset.  It takes the
+ * log mutexes like log_tiered_spill() and leaves interrupts enabled, so it
+ * must be called from task context.
+ */
+void log_tiered_spill_all(void);
+
+extern const struct log_handler log_tiered_handler;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+#endif /* __SYS_LOG_TIERED_H__ */
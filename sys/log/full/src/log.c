@@ -634,6 +634,22 @@ log_append_mbuf_body(struct log *log, uint8_t module, uint8_t level,
     return rc;
 }
 
+/**
+ * Indicates whether a write at the given level would be accepted by the log.
+ * Lets the printf functions drop an entry before they look at its arguments.
+ */
+static bool
+log_level_accepts(struct log *log, uint8_t module, uint8_t level)
+{
+    if (level >= log->l_level && level >= log_level_get(module)) {
+        return true;
+    }
+
+    LOG_STATS_INC(log, writes);
+    LOG_STATS_INC(log, drops);
+    return false;
+}
+
 void
 log_printf(struct log *log, uint8_t module, uint8_t level,
            const char *msg, ...)
@@ -642,6 +658,10 @@ log_printf(struct log *log, uint8_t module, uint8_t level,
     char buf[LOG_PRINTF_MAX_ENTRY_LEN];
     int len;
 
+    if (!log_level_accepts(log, module, level)) {
+        return;
+    }
+
     va_start(args, msg);
     len = vsnprintf(buf, LOG_PRINTF_MAX_ENTRY_LEN, msg, args);
     va_end(args);
@@ -652,6 +672,32 @@ log_printf(struct log *log, uint8_t module, uint8_t level,
     log_append_body(log, module, level, LOG_ETYPE_STRING, buf, len);
 }
 
+#if MYNEWT_VAL(LOG_DICT)
+void
+log_printf_dict(struct log *log, uint8_t module, uint8_t level,
+                const char *fmt, ...)
+{
+    va_list args;
+    uint8_t buf[LOG_PRINTF_MAX_ENTRY_LEN];
+    int len;
+
+    if (!log_level_accepts(log, module, level)) {
+        return;
+    }
+
+    va_start(args, fmt);
+    len = log_dict_vencode(buf, sizeof buf, fmt, args);
+    va_end(args);
+    if (len < 0) {
+        LOG_STATS_INC(log, writes);
+        LOG_STATS_INC(log, errs);
+        return;
+    }
+
+    log_append_body(log, module, level, LOG_ETYPE_DICT, buf, len);
+}
+#endif
+
 int
 log_walk(struct log *log, log_walk_func_t walk_func,
          struct log_offset *log_offset)
@@ -737,6 +783,118 @@ log_walk_body(struct log *log, log_walk_body_func_t walk_body_func,
     return rc;
 }
 
+#if MYNEWT_VAL(LOG_QUERY)
+void
+log_query_init(struct log_query *query)
+{
+    memset(query, 0, sizeof *query);
+    memset(query->lq_modules, 0xff, sizeof query->lq_modules);
+    query->lq_etypes = 0xff;
+    query->lq_ts_min = INT64_MIN;
+    query->lq_ts_max = INT64_MAX;
+}
+
+void
+log_query_set_modules(struct log_query *query, const uint8_t *modules,
+                      int count)
+{
+    int i;
+
+    if (count == 0) {
+        memset(query->lq_modules, 0xff, sizeof query->lq_modules);
+        return;
+    }
+
+    memset(query->lq_modules, 0, sizeof query->lq_modules);
+    for (i = 0; i < count; i++) {
+        query->lq_modules[modules[i] / 32] |= 1UL << (modules[i] % 32);
+    }
+}
+
+bool
+log_query_match(const struct log_query *query,
+                const struct log_entry_hdr *hdr)
+{
+    uint8_t etype;
+
+#if MYNEWT_VAL(LOG_VERSION) > 2
+    etype = hdr->ue_etype;
+#else
+    etype = LOG_ETYPE_STRING;
+#endif
+
+    return (query->lq_modules[hdr->ue_module / 32] &
+            (1UL << (hdr->ue_module % 32))) &&
+           hdr->ue_level >= query->lq_min_level &&
+           (query->lq_etypes & (1 << min(etype, 7))) &&
+           hdr->ue_ts >= query->lq_ts_min &&
+           hdr->ue_ts <= query->lq_ts_max &&
+           hdr->ue_index >= query->lq_index;
+}
+
+/**
+ * Argument passed to the log walk performed by `log_query`.
+ */
+struct log_query_arg {
+    const struct log_query *query;
+    log_walk_body_func_t fn;
+    void *arg;
+};
+
+static int
+log_query_fn(struct log *log, struct log_offset *log_offset, void *dptr,
+             uint16_t len)
+{
+    struct log_query_arg *lqa;
+    struct log_entry_hdr ueh;
+    int rc;
+
+    lqa = log_offset->lo_arg;
+
+    rc = log_read_hdr(log, dptr, &ueh);
+    if (rc != 0) {
+        return rc;
+    }
+    if (!log_query_match(lqa->query, &ueh)) {
+        return 0;
+    }
+
+    log_offset->lo_arg = lqa->arg;
+    rc = lqa->fn(log, log_offset, &ueh, dptr, len - sizeof ueh);
+    log_offset->lo_arg = lqa;
+
+    return rc;
+}
+
+int
+log_query(struct log *log, struct log_query *query,
+          log_walk_body_func_t walk_body_func, struct log_offset *log_offset)
+{
+    struct log_query_arg lqa = {
+        .query = query,
+        .fn = walk_body_func,
+        .arg = log_offset->lo_arg,
+    };
+    int rc;
+
+    query->lq_skipped = 0;
+
+    log_offset->lo_ts = 0;
+    log_offset->lo_index = query->lq_index;
+    log_offset->lo_arg = &lqa;
+
+    if (log->l_log->log_walk_query) {
+        rc = log->l_log->log_walk_query(log, log_query_fn, log_offset, query);
+    } else {
+        rc = log->l_log->log_walk(log, log_query_fn, log_offset);
+    }
+
+    log_offset->lo_arg = lqa.arg;
+
+    return rc;
+}
+#endif
+
 /**
  * Reads from the specified log.
  *
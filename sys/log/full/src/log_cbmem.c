@@ -160,7 +160,7 @@ log_cbmem_walk(struct log *log, log_walk_func_t walk_func,
      */
     if (log_offset->lo_ts < 0) {
         hdr = cbmem->c_entry_end;
-        if (hdr != NULL) {
+        if (hdr != NULL && !(hdr->ceh_flags & CBMEM_ENTRY_F_BUSY)) {
             rc = walk_func(log, log_offset, (void *)hdr, hdr->ceh_len);
         }
     } else {
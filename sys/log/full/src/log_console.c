@@ -40,6 +40,27 @@ log_console_print_hdr(const struct log_entry_hdr *hdr)
                    hdr->ue_ts, hdr->ue_module, hdr->ue_level);
 }
 
+static void
+log_console_write_body(const struct log_entry_hdr *hdr, const void *body,
+                       int body_len)
+{
+#if MYNEWT_VAL(LOG_DICT)
+    char text[LOG_PRINTF_MAX_ENTRY_LEN];
+    int rc;
+
+    /* Dictionary entries are expanded here, on their way out. */
+    if (hdr->ue_etype == LOG_ETYPE_DICT) {
+        rc = log_dict_format(text, sizeof text, body, body_len);
+        if (rc >= 0) {
+            console_write(text, rc);
+            return;
+        }
+    }
+#endif
+
+    console_write(body, body_len);
+}
+
 static int
 log_console_append(struct log *log, void *buf, int len)
 {
@@ -49,12 +70,13 @@ log_console_append(struct log *log, void *buf, int len)
         return (0);
     }
 
+    hdr = (struct log_entry_hdr *) buf;
     if (!console_is_midline) {
-        hdr = (struct log_entry_hdr *) buf;
         log_console_print_hdr(hdr);
     }
 
-    console_write((char *) buf + LOG_ENTRY_HDR_SIZE, len - LOG_ENTRY_HDR_SIZE);
+    log_console_write_body(hdr, (char *) buf + LOG_ENTRY_HDR_SIZE,
+                           len - LOG_ENTRY_HDR_SIZE);
 
     return (0);
 }
@@ -71,7 +93,7 @@ log_console_append_body(struct log *log, const struct log_entry_hdr *hdr,
         log_console_print_hdr(hdr);
     }
 
-    console_write(body, body_len);
+    log_console_write_body(hdr, body, body_len);
 
     return (0);
 }
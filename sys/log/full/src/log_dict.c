@@ -0,0 +1,678 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(LOG_DICT)
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include "log/log.h"
+
+/* The linker defines these for any section whose name is a C identifier. */
+extern const char __start_log_dict[];
+extern const char __stop_log_dict[];
+
+/* Keeps the section (and the symbols above) present in images that contain
+ * no dictionary log calls.
+ */
+static const char log_dict_anchor[] LOG_DICT_SECTION = "";
+
+/* Length modifiers. */
+#define LOG_DICT_LEN_NONE       0
+#define LOG_DICT_LEN_HH         1
+#define LOG_DICT_LEN_H          2
+#define LOG_DICT_LEN_L          3
+#define LOG_DICT_LEN_LL         4
+#define LOG_DICT_LEN_J          5
+#define LOG_DICT_LEN_Z          6
+#define LOG_DICT_LEN_T          7
+#define LOG_DICT_LEN_BIG_L      8
+
+/* Argument types, as passed through the variable argument list. */
+#define LOG_DICT_ARG_NONE       0
+#define LOG_DICT_ARG_INT        1
+#define LOG_DICT_ARG_LONG       2
+#define LOG_DICT_ARG_LLONG      3
+#define LOG_DICT_ARG_INTMAX     4
+#define LOG_DICT_ARG_SIZE       5
+#define LOG_DICT_ARG_PTRDIFF    6
+#define LOG_DICT_ARG_PTR        7
+#define LOG_DICT_ARG_DBL        8
+#define LOG_DICT_ARG_LDBL       9
+#define LOG_DICT_ARG_STR        10
+#define LOG_DICT_ARG_COUNT      11
+
+/* Stored size of each argument type; 0 for strings and %n. */
+static const uint8_t log_dict_arg_sizes[] = {
+    [LOG_DICT_ARG_NONE]     = 0,
+    [LOG_DICT_ARG_INT]      = sizeof (int),
+    [LOG_DICT_ARG_LONG]     = sizeof (long),
+    [LOG_DICT_ARG_LLONG]    = sizeof (long long),
+    [LOG_DICT_ARG_INTMAX]   = sizeof (intmax_t),
+    [LOG_DICT_ARG_SIZE]     = sizeof (size_t),
+    [LOG_DICT_ARG_PTRDIFF]  = sizeof (ptrdiff_t),
+    [LOG_DICT_ARG_PTR]      = sizeof (void *),
+    [LOG_DICT_ARG_DBL]      = sizeof (double),
+    [LOG_DICT_ARG_LDBL]     = sizeof (double),
+    [LOG_DICT_ARG_STR]      = 0,
+    [LOG_DICT_ARG_COUNT]    = 0,
+};
+
+/** A single conversion specification within a format string. */
+struct log_dict_spec {
+    /** Points to the '%'. */
+    const char *start;
+
+    /** Points to the length modifier, or the conversion if there is none. */
+    const char *len_start;
+
+    /** Points just past the conversion character. */
+    const char *end;
+
+    /** Number of '*' widths / precisions. */
+    uint8_t stars;
+
+    /** One of the LOG_DICT_LEN_[...] values. */
+    uint8_t len;
+
+    /** The conversion character; '\0' if the string ends early. */
+    char conv;
+};
+
+/**
+ * Finds the next conversion specification in a format string.
+ *
+ * @return                      The '%' that starts the specification;
+ *                              NULL if there are no more.
+ */
+static const char *
+log_dict_next_spec(const char *fmt, struct log_dict_spec *spec)
+{
+    const char *cp;
+
+    cp = strchr(fmt, '%');
+    if (cp == NULL) {
+        return NULL;
+    }
+
+    spec->start = cp++;
+    spec->stars = 0;
+
+    /* Flags. */
+    while (*cp != '\0' && strchr("-+ #0", *cp) != NULL) {
+        cp++;
+    }
+
+    /* Width. */
+    if (*cp == '*') {
+        spec->stars++;
+        cp++;
+    } else {
+        while (*cp >= '0' && *cp <= '9') {
+            cp++;
+        }
+    }
+
+    /* Precision. */
+    if (*cp == '.') {
+        cp++;
+        if (*cp == '*') {
+            spec->stars++;
+            cp++;
+        } else {
+            while (*cp >= '0' && *cp <= '9') {
+                cp++;
+            }
+        }
+    }
+
+    spec->len_start = cp;
+    switch (*cp) {
+    case 'h':
+        cp++;
+        if (*cp == 'h') {
+            cp++;
+            spec->len = LOG_DICT_LEN_HH;
+        } else {
+            spec->len = LOG_DICT_LEN_H;
+        }
+        break;
+
+    case 'l':
+        cp++;
+        if (*cp == 'l') {
+            cp++;
+            spec->len = LOG_DICT_LEN_LL;
+        } else {
+            spec->len = LOG_DICT_LEN_L;
+        }
+        break;
+
+    case 'q':
+        cp++;
+        spec->len = LOG_DICT_LEN_LL;
+        break;
+
+    case 'j':
+        cp++;
+        spec->len = LOG_DICT_LEN_J;
+        break;
+
+    case 'z':
+        cp++;
+        spec->len = LOG_DICT_LEN_Z;
+        break;
+
+    case 't':
+        cp++;
+        spec->len = LOG_DICT_LEN_T;
+        break;
+
+    case 'L':
+        cp++;
+        spec->len = LOG_DICT_LEN_BIG_L;
+        break;
+
+    default:
+        spec->len = LOG_DICT_LEN_NONE;
+        break;
+    }
+
+    spec->conv = *cp;
+    if (*cp != '\0') {
+        cp++;
+    }
+    spec->end = cp;
+
+    return spec->start;
+}
+
+/**
+ * Determines how the argument of a conversion is passed.
+ */
+static int
+log_dict_arg_type(const struct log_dict_spec *spec)
+{
+    switch (spec->conv) {
+    case 'd':
+    case 'i':
+    case 'u':
+    case 'o':
+    case 'x':
+    case 'X':
+        switch (spec->len) {
+        case LOG_DICT_LEN_L:
+            return LOG_DICT_ARG_LONG;
+        case LOG_DICT_LEN_LL:
+        case LOG_DICT_LEN_BIG_L:
+            return LOG_DICT_ARG_LLONG;
+        case LOG_DICT_LEN_J:
+            return LOG_DICT_ARG_INTMAX;
+        case LOG_DICT_LEN_Z:
+            return LOG_DICT_ARG_SIZE;
+        case LOG_DICT_LEN_T:
+            return LOG_DICT_ARG_PTRDIFF;
+        default:
+            return LOG_DICT_ARG_INT;
+        }
+
+    case 'c':
+        return LOG_DICT_ARG_INT;
+
+    case 'p':
+        return LOG_DICT_ARG_PTR;
+
+    case 's':
+        return LOG_DICT_ARG_STR;
+
+    case 'f':
+    case 'F':
+    case 'e':
+    case 'E':
+    case 'g':
+    case 'G':
+    case 'a':
+    case 'A':
+        if (spec->len == LOG_DICT_LEN_BIG_L) {
+            return LOG_DICT_ARG_LDBL;
+        }
+        return LOG_DICT_ARG_DBL;
+
+    default:
+        /* %%, %n, or garbage. */
+        return LOG_DICT_ARG_NONE;
+    }
+}
+
+int
+log_dict_id(const char *fmt, uint32_t *out_id)
+{
+    if (fmt < __start_log_dict || fmt >= __stop_log_dict) {
+        return SYS_ENOENT;
+    }
+
+    *out_id = fmt - __start_log_dict;
+    return 0;
+}
+
+const char *
+log_dict_lookup(uint32_t id)
+{
+    if (id >= (uintptr_t)(__stop_log_dict - __start_log_dict)) {
+        return NULL;
+    }
+
+    return __start_log_dict + id;
+}
+
+static int
+log_dict_put(uint8_t *buf, int buf_len, int off, uint64_t val, int size)
+{
+    int i;
+
+    if (off + size > buf_len) {
+        return -1;
+    }
+
+    for (i = 0; i < size; i++) {
+        buf[off++] = val;
+        val >>= 8;
+    }
+
+    return off;
+}
+
+int
+log_dict_vencode(void *buf, int buf_len, const char *fmt, va_list ap)
+{
+    struct log_dict_spec spec;
+    const char *str;
+    uint8_t *u8p;
+    uint64_t val;
+    uint32_t id;
+    double dbl;
+    int type;
+    int off;
+    int len;
+    int rc;
+    int i;
+
+    if (buf_len < LOG_DICT_ID_SIZE) {
+        return SYS_EINVAL;
+    }
+
+    rc = log_dict_id(fmt, &id);
+    if (rc != 0) {
+        return rc;
+    }
+
+    u8p = buf;
+    put_le32(u8p, id);
+    off = LOG_DICT_ID_SIZE;
+
+    while (log_dict_next_spec(fmt, &spec) != NULL) {
+        fmt = spec.end;
+
+        for (i = 0; i < spec.stars; i++) {
+            rc = log_dict_put(u8p, buf_len, off, va_arg(ap, int),
+                              sizeof (int));
+            if (rc < 0) {
+                return off;
+            }
+            off = rc;
+        }
+
+        type = log_dict_arg_type(&spec);
+        switch (type) {
+        case LOG_DICT_ARG_INT:
+            val = va_arg(ap, unsigned int);
+            break;
+        case LOG_DICT_ARG_LONG:
+            val = va_arg(ap, unsigned long);
+            break;
+        case LOG_DICT_ARG_LLONG:
+            val = va_arg(ap, unsigned long long);
+            break;
+        case LOG_DICT_ARG_INTMAX:
+            val = va_arg(ap, uintmax_t);
+            break;
+        case LOG_DICT_ARG_SIZE:
+            val = va_arg(ap, size_t);
+            break;
+        case LOG_DICT_ARG_PTRDIFF:
+            val = va_arg(ap, ptrdiff_t);
+            break;
+        case LOG_DICT_ARG_PTR:
+            val = (uintptr_t)va_arg(ap, void *);
+            break;
+        case LOG_DICT_ARG_DBL:
+        case LOG_DICT_ARG_LDBL:
+            if (type == LOG_DICT_ARG_DBL) {
+                dbl = va_arg(ap, double);
+            } else {
+                dbl = va_arg(ap, long double);
+            }
+            memcpy(&val, &dbl, sizeof val);
+            break;
+        case LOG_DICT_ARG_STR:
+            str = va_arg(ap, const char *);
+            if (str == NULL) {
+                str = "(null)";
+            }
+            len = strlen(str) + 1;
+            if (off + len > buf_len) {
+                /* Keep as much of the string as fits. */
+                len = buf_len - off;
+                if (len > 0) {
+                    memcpy(u8p + off, str, len - 1);
+                    u8p[buf_len - 1] = '\0';
+                    off = buf_len;
+                }
+                return off;
+            }
+            memcpy(u8p + off, str, len);
+            off += len;
+            continue;
+        default:
+            if (spec.conv == 'n') {
+                (void)va_arg(ap, void *);
+            }
+            continue;
+        }
+
+        rc = log_dict_put(u8p, buf_len, off, val, log_dict_arg_sizes[type]);
+        if (rc < 0) {
+            /* Cut the entry after the last complete argument. */
+            return off;
+        }
+        off = rc;
+    }
+
+    return off;
+}
+
+int
+log_dict_encode(void *buf, int buf_len, const char *fmt, ...)
+{
+    va_list ap;
+    int rc;
+
+    va_start(ap, fmt);
+    rc = log_dict_vencode(buf, buf_len, fmt, ap);
+    va_end(ap);
+
+    return rc;
+}
+
+/** Output state for log_dict_format(). */
+struct log_dict_out {
+    char *dst;
+    int dst_len;
+    int off;
+};
+
+static void
+log_dict_out_raw(struct log_dict_out *out, const char *src, int len)
+{
+    int space;
+
+    space = out->dst_len - out->off - 1;
+    if (len > space) {
+        len = space;
+    }
+    if (len > 0) {
+        memcpy(out->dst + out->off, src, len);
+        out->off += len;
+    }
+}
+
+/**
+ * Accounts for text that snprintf() wrote at the end of the output buffer.
+ */
+static void
+log_dict_out_fill(struct log_dict_out *out, int rc)
+{
+    int space;
+
+    if (rc <= 0) {
+        return;
+    }
+
+    space = out->dst_len - out->off - 1;
+    if (rc > space) {
+        rc = space;
+    }
+    out->off += rc;
+}
+
+static int
+log_dict_get(const uint8_t *body, int body_len, int *off, int size,
+             uint64_t *out_val)
+{
+    uint64_t val;
+    int i;
+
+    if (*off + size > body_len) {
+        *out_val = 0;
+        return -1;
+    }
+
+    val = 0;
+    for (i = size - 1; i >= 0; i--) {
+        val = (val << 8) | body[*off + i];
+    }
+    *off += size;
+
+    *out_val = val;
+    return 0;
+}
+
+/**
+ * Rebuilds a conversion specification for snprintf(), with '*' replaced by
+ * the recorded values and the length modifier replaced by `len_mod`.
+ */
+static int
+log_dict_build_spec(char *sf, int sf_len, const struct log_dict_spec *spec,
+                    const int *stars, const char *len_mod)
+{
+    const char *cp;
+    int star_idx;
+    int off;
+    int rc;
+
+    star_idx = 0;
+    off = 0;
+    for (cp = spec->start; cp < spec->len_start; cp++) {
+        if (*cp == '*') {
+            rc = snprintf(sf + off, sf_len - off, "%d", stars[star_idx++]);
+        } else {
+            rc = snprintf(sf + off, sf_len - off, "%c", *cp);
+        }
+        if (rc < 0 || rc >= sf_len - off) {
+            return -1;
+        }
+        off += rc;
+    }
+
+    rc = snprintf(sf + off, sf_len - off, "%s%c", len_mod, spec->conv);
+    if (rc < 0 || rc >= sf_len - off) {
+        return -1;
+    }
+
+    return 0;
+}
+
+int
+log_dict_format(char *dst, int dst_len, const void *body, int body_len)
+{
+    struct log_dict_spec spec;
+    struct log_dict_out out;
+    const uint8_t *u8p;
+    const char *fmt;
+    const char *str;
+    uint64_t val;
+    double dbl;
+    char sf[32];
+    int stars[2];
+    int shift;
+    int type;
+    int size;
+    int off;
+    int rc;
+    int i;
+
+    if (dst_len <= 0) {
+        return SYS_EINVAL;
+    }
+    dst[0] = '\0';
+
+    if (body_len < LOG_DICT_ID_SIZE) {
+        return SYS_EINVAL;
+    }
+
+    u8p = body;
+    fmt = log_dict_lookup(get_le32(u8p));
+    if (fmt == NULL) {
+        return SYS_ENOENT;
+    }
+    off = LOG_DICT_ID_SIZE;
+
+    out.dst = dst;
+    out.dst_len = dst_len;
+    out.off = 0;
+
+    while (log_dict_next_spec(fmt, &spec) != NULL) {
+        log_dict_out_raw(&out, fmt, spec.start - fmt);
+        fmt = spec.end;
+
+        if (spec.conv == '%') {
+            log_dict_out_raw(&out, "%", 1);
+            continue;
+        }
+
+        type = log_dict_arg_type(&spec);
+        if (type == LOG_DICT_ARG_NONE) {
+            if (spec.conv != 'n') {
+                log_dict_out_raw(&out, spec.start, spec.end - spec.start);
+            }
+            continue;
+        }
+
+        rc = 0;
+        for (i = 0; i < spec.stars && rc == 0; i++) {
+            rc = log_dict_get(u8p, body_len, &off, sizeof (int), &val);
+            stars[i] = (int)val;
+        }
+
+        size = log_dict_arg_sizes[type];
+        if (rc == 0 && type != LOG_DICT_ARG_STR) {
+            rc = log_dict_get(u8p, body_len, &off, size, &val);
+        }
+        if (rc != 0) {
+            log_dict_out_raw(&out, "?", 1);
+            continue;
+        }
+
+        switch (type) {
+        case LOG_DICT_ARG_STR:
+            str = (const char *)u8p + off;
+            size = strnlen(str, body_len - off);
+            if (size >= body_len - off) {
+                rc = -1;
+                break;
+            }
+            off += size + 1;
+
+            rc = log_dict_build_spec(sf, sizeof sf, &spec, stars, "");
+            if (rc == 0) {
+                log_dict_out_fill(&out, snprintf(out.dst + out.off,
+                                                 out.dst_len - out.off,
+                                                 sf, str));
+            }
+            break;
+
+        case LOG_DICT_ARG_PTR:
+            rc = log_dict_build_spec(sf, sizeof sf, &spec, stars, "");
+            if (rc == 0) {
+                log_dict_out_fill(&out, snprintf(out.dst + out.off,
+                                                 out.dst_len - out.off,
+                                                 sf, (void *)(uintptr_t)val));
+            }
+            break;
+
+        case LOG_DICT_ARG_DBL:
+        case LOG_DICT_ARG_LDBL:
+            memcpy(&dbl, &val, sizeof dbl);
+            rc = log_dict_build_spec(sf, sizeof sf, &spec, stars, "");
+            if (rc == 0) {
+                log_dict_out_fill(&out, snprintf(out.dst + out.off,
+                                                 out.dst_len - out.off,
+                                                 sf, dbl));
+            }
+            break;
+
+        default:
+            if (spec.conv == 'c') {
+                rc = log_dict_build_spec(sf, sizeof sf, &spec, stars, "");
+                if (rc == 0) {
+                    log_dict_out_fill(&out, snprintf(out.dst + out.off,
+                                                     out.dst_len - out.off,
+                                                     sf, (int)val));
+                }
+                break;
+            }
+
+            /* Apply the stored width and any hh / h narrowing, then print
+             * as a long long.
+             */
+            if (spec.len == LOG_DICT_LEN_HH) {
+                size = 1;
+            } else if (spec.len == LOG_DICT_LEN_H) {
+                size = 2;
+            }
+            shift = 64 - 8 * size;
+            if (spec.conv == 'd' || spec.conv == 'i') {
+                val = (uint64_t)((int64_t)(val << shift) >> shift);
+            } else {
+                val = (val << shift) >> shift;
+            }
+
+            rc = log_dict_build_spec(sf, sizeof sf, &spec, stars, "ll");
+            if (rc == 0) {
+                log_dict_out_fill(&out, snprintf(out.dst + out.off,
+                                                 out.dst_len - out.off,
+                                                 sf, (unsigned long long)val));
+            }
+            break;
+        }
+
+        if (rc != 0) {
+            log_dict_out_raw(&out, "?", 1);
+        }
+    }
+
+    log_dict_out_raw(&out, fmt, strlen(fmt));
+    out.dst[out.off] = '\0';
+
+    return out.off;
+}
+
+#endif
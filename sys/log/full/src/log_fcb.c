@@ -34,6 +34,81 @@ static struct flash_area sector;
 
 static int log_fcb_rtr_erase(struct log *log, void *arg);
 
+#if MYNEWT_VAL(LOG_QUERY)
+static uint32_t
+log_fcb_sum_ts(int64_t ts)
+{
+    ts /= 1000000;
+    if (ts < 0) {
+        return 0;
+    }
+    if (ts > UINT32_MAX) {
+        return UINT32_MAX;
+    }
+    return ts;
+}
+
+/**
+ * Clears the summary of the given sector, or of all sectors if fa is NULL.
+ */
+static void
+log_fcb_sum_clear(struct fcb_log *fcb_log, const struct flash_area *fa)
+{
+    struct fcb *fcb;
+
+    if (fcb_log->fl_sums == NULL) {
+        return;
+    }
+
+    fcb = &fcb_log->fl_fcb;
+    if (fa == NULL) {
+        memset(fcb_log->fl_sums, 0,
+               fcb->f_sector_cnt * sizeof *fcb_log->fl_sums);
+    } else {
+        memset(&fcb_log->fl_sums[fa - fcb->f_sectors], 0,
+               sizeof *fcb_log->fl_sums);
+    }
+}
+
+/**
+ * Adds an entry written at loc to its sector's summary.
+ */
+static void
+log_fcb_sum_add(struct fcb_log *fcb_log, const struct fcb_entry *loc,
+                const struct log_entry_hdr *hdr)
+{
+    struct log_fcb_sum *sum;
+    uint32_t ts;
+    uint8_t etype;
+
+    if (fcb_log->fl_sums == NULL) {
+        return;
+    }
+
+    sum = &fcb_log->fl_sums[loc->fe_area - fcb_log->fl_fcb.f_sectors];
+    ts = log_fcb_sum_ts(hdr->ue_ts);
+
+#if MYNEWT_VAL(LOG_VERSION) > 2
+    etype = hdr->ue_etype;
+#else
+    etype = LOG_ETYPE_STRING;
+#endif
+
+    if (!(sum->lfs_flags & LOG_FCB_SUM_F_USED)) {
+        sum->lfs_flags |= LOG_FCB_SUM_F_USED;
+        sum->lfs_ts_min = ts;
+        sum->lfs_ts_max = ts;
+    } else {
+        sum->lfs_ts_min = min(sum->lfs_ts_min, ts);
+        sum->lfs_ts_max = max(sum->lfs_ts_max, ts);
+    }
+    sum->lfs_modules |= 1UL << (hdr->ue_module % 32);
+    sum->lfs_etypes |= 1 << min(etype, 7);
+    sum->lfs_level_max = max(sum->lfs_level_max, hdr->ue_level);
+    sum->lfs_index_max = max(sum->lfs_index_max, hdr->ue_index);
+}
+#endif
+
 static int
 log_fcb_start_append(struct log *log, int len, struct fcb_entry *loc)
 {
@@ -80,6 +155,10 @@ log_fcb_start_append(struct log *log, int len, struct fcb_entry *loc)
             goto err;
         }
 
+#if MYNEWT_VAL(LOG_QUERY)
+        log_fcb_sum_clear(fcb_log, old_fa);
+#endif
+
 #if MYNEWT_VAL(LOG_STORAGE_WATERMARK)
         /*
          * FCB was rotated successfully so let's check if watermark was within
@@ -122,6 +201,15 @@ log_fcb_append(struct log *log, void *buf, int len)
 
     rc = fcb_append_finish(fcb, &loc);
 
+#if MYNEWT_VAL(LOG_QUERY)
+    if (rc == 0 && len >= sizeof(struct log_entry_hdr)) {
+        struct log_entry_hdr ueh;
+
+        memcpy(&ueh, buf, sizeof ueh);
+        log_fcb_sum_add(fcb_log, &loc, &ueh);
+    }
+#endif
+
 err:
     return (rc);
 }
@@ -211,6 +299,10 @@ log_fcb_append_body(struct log *log, const struct log_entry_hdr *hdr,
         return rc;
     }
 
+#if MYNEWT_VAL(LOG_QUERY)
+    log_fcb_sum_add(fcb_log, &loc, hdr);
+#endif
+
     return 0;
 }
 
@@ -269,6 +361,15 @@ log_fcb_append_mbuf(struct log *log, const struct os_mbuf *om)
         return rc;
     }
 
+#if MYNEWT_VAL(LOG_QUERY)
+    if (len >= sizeof(struct log_entry_hdr)) {
+        struct log_entry_hdr ueh;
+
+        os_mbuf_copydata(om, 0, sizeof ueh, &ueh);
+        log_fcb_sum_add(fcb_log, &loc, &ueh);
+    }
+#endif
+
     return 0;
 }
 
@@ -314,6 +415,10 @@ log_fcb_append_mbuf_body(struct log *log, const struct log_entry_hdr *hdr,
         return rc;
     }
 
+#if MYNEWT_VAL(LOG_QUERY)
+    log_fcb_sum_add(fcb_log, &loc, hdr);
+#endif
+
     return 0;
 }
 
@@ -410,12 +515,120 @@ log_fcb_walk(struct log *log, log_walk_func_t walk_func,
 static int
 log_fcb_flush(struct log *log)
 {
+#if MYNEWT_VAL(LOG_QUERY)
+    log_fcb_sum_clear(log->l_arg, NULL);
+#endif
     return fcb_clear(&((struct fcb_log *)log->l_arg)->fl_fcb);
 }
 
+#if MYNEWT_VAL(LOG_QUERY)
+static int
+log_fcb_sum_match(const struct log_fcb_sum *sum, const struct log_query *q)
+{
+    uint32_t modules;
+    int i;
+
+    if (!(sum->lfs_flags & LOG_FCB_SUM_F_USED)) {
+        return 0;
+    }
+    if (sum->lfs_index_max < q->lq_index ||
+        sum->lfs_level_max < q->lq_min_level ||
+        !(sum->lfs_etypes & q->lq_etypes)) {
+        return 0;
+    }
+    if ((int64_t)(sum->lfs_ts_max + 1ULL) * 1000000 <= q->lq_ts_min ||
+        (int64_t)sum->lfs_ts_min * 1000000 > q->lq_ts_max) {
+        return 0;
+    }
+
+    /* Summaries hash module IDs into 32 bits; fold the query the same way. */
+    modules = 0;
+    for (i = 0; i < LOG_QUERY_MODULE_WORDS; i++) {
+        modules |= q->lq_modules[i];
+    }
+    return (sum->lfs_modules & modules) != 0;
+}
+
+/**
+ * Walks the entries of sectors whose summary may match the query, skipping
+ * the rest without reading them.
+ */
+static int
+log_fcb_walk_query(struct log *log, log_walk_func_t walk_func,
+                   struct log_offset *log_offset, struct log_query *q)
+{
+    struct fcb_log *fl;
+    struct fcb *fcb;
+    struct flash_area *fa;
+    struct fcb_entry loc;
+    int rc;
+
+    fl = (struct fcb_log *)log->l_arg;
+    fcb = &fl->fl_fcb;
+
+    if (fl->fl_sums == NULL) {
+        return log_fcb_walk(log, walk_func, log_offset);
+    }
+
+    rc = 0;
+    fa = fcb->f_oldest;
+    while (1) {
+        if (!log_fcb_sum_match(&fl->fl_sums[fa - fcb->f_sectors], q)) {
+            q->lq_skipped++;
+        } else {
+            memset(&loc, 0, sizeof(loc));
+            loc.fe_area = fa;
+            while (fcb_getnext(fcb, &loc) == 0 && loc.fe_area == fa) {
+                rc = walk_func(log, log_offset, &loc, loc.fe_data_len);
+                if (rc) {
+                    return rc;
+                }
+            }
+        }
+
+        if (fa == fcb->f_active.fe_area) {
+            break;
+        }
+        fa++;
+        if (fa == &fcb->f_sectors[fcb->f_sector_cnt]) {
+            fa = fcb->f_sectors;
+        }
+    }
+
+    return rc;
+}
+
+/**
+ * Rebuilds sector summaries from the entries already in flash.
+ */
+static void
+log_fcb_sum_rebuild(struct fcb_log *fl)
+{
+    struct log_entry_hdr ueh;
+    struct fcb_entry loc;
+    int rc;
+
+    log_fcb_sum_clear(fl, NULL);
+
+    memset(&loc, 0, sizeof(loc));
+    while (fcb_getnext(&fl->fl_fcb, &loc) == 0) {
+        if (loc.fe_data_len < sizeof(ueh)) {
+            continue;
+        }
+        rc = flash_area_read(loc.fe_area, loc.fe_data_off, &ueh, sizeof(ueh));
+        if (rc == 0) {
+            log_fcb_sum_add(fl, &loc, &ueh);
+        }
+    }
+}
+#endif
+
 static int
 log_fcb_registered(struct log *log)
 {
+#if MYNEWT_VAL(LOG_QUERY)
+    log_fcb_sum_rebuild(log->l_arg);
+#endif
 #if MYNEWT_VAL(LOG_STORAGE_WATERMARK)
     struct fcb_log *fl;
     struct fcb *fcb;
@@ -548,13 +761,13 @@ log_fcb_set_watermark(struct log *log, uint32_t index)
  */
 static int
 log_fcb_copy_entry(struct log *log, struct fcb_entry *entry,
-                   struct fcb *dst_fcb)
+                   struct fcb_log *dst_fcb)
 {
     struct log_entry_hdr ueh;
     char data[LOG_PRINTF_MAX_ENTRY_LEN + sizeof(ueh)];
     int dlen;
     int rc;
-    struct fcb *fcb_tmp;
+    void *fcb_tmp;
 
     rc = log_fcb_read(log, entry, &ueh, 0, sizeof(ueh));
     if (rc != sizeof(ueh)) {
@@ -570,7 +783,7 @@ log_fcb_copy_entry(struct log *log, struct fcb_entry *entry,
     data[rc] = '\0';
 
     /* Changing the fcb to be logged to be dst fcb */
-    fcb_tmp = &((struct fcb_log *)log->l_arg)->fl_fcb;
+    fcb_tmp = log->l_arg;
 
     log->l_arg = dst_fcb;
     rc = log_fcb_append(log, data, dlen);
@@ -589,7 +802,7 @@ err:
  * @return 0 on success; non-zero on error
  */
 static int
-log_fcb_copy(struct log *log, struct fcb *src_fcb, struct fcb *dst_fcb,
+log_fcb_copy(struct log *log, struct fcb *src_fcb, struct fcb_log *dst_fcb,
              uint32_t offset)
 {
     struct fcb_entry entry;
@@ -621,7 +834,7 @@ static int
 log_fcb_rtr_erase(struct log *log, void *arg)
 {
     struct fcb_log *fcb_log;
-    struct fcb fcb_scratch;
+    struct fcb_log fcb_scratch;
     struct fcb *fcb;
     const struct flash_area *ptr;
     struct fcb_entry entry;
@@ -634,21 +847,22 @@ log_fcb_rtr_erase(struct log *log, void *arg)
     }
 
     fcb_log = (struct fcb_log *)arg;
-    fcb = (struct fcb *)fcb_log;
+    fcb = &fcb_log->fl_fcb;
 
+    /* Zeroed, so the scratch log keeps no entries or summaries. */
     memset(&fcb_scratch, 0, sizeof(fcb_scratch));
 
     if (flash_area_open(FLASH_AREA_IMAGE_SCRATCH, &ptr)) {
         goto err;
     }
     sector = *ptr;
-    fcb_scratch.f_sectors = &sector;
-    fcb_scratch.f_sector_cnt = 1;
-    fcb_scratch.f_magic = 0x7EADBADF;
-    fcb_scratch.f_version = g_log_info.li_version;
+    fcb_scratch.fl_fcb.f_sectors = &sector;
+    fcb_scratch.fl_fcb.f_sector_cnt = 1;
+    fcb_scratch.fl_fcb.f_magic = 0x7EADBADF;
+    fcb_scratch.fl_fcb.f_version = g_log_info.li_version;
 
     flash_area_erase(&sector, 0, sector.fa_size);
-    rc = fcb_init(&fcb_scratch);
+    rc = fcb_init(&fcb_scratch.fl_fcb);
     if (rc) {
         goto err;
     }
@@ -672,7 +886,7 @@ log_fcb_rtr_erase(struct log *log, void *arg)
     }
 
     /* Copy back from scratch */
-    rc = log_fcb_copy(log, &fcb_scratch, fcb, 0);
+    rc = log_fcb_copy(log, &fcb_scratch.fl_fcb, fcb_log, 0);
 
 err:
     return (rc);
@@ -693,6 +907,9 @@ const struct log_handler log_fcb_handler = {
 #endif
 #if MYNEWT_VAL(LOG_STORAGE_WATERMARK)
     .log_set_watermark = log_fcb_set_watermark,
+#endif
+#if MYNEWT_VAL(LOG_QUERY)
+    .log_walk_query = log_fcb_walk_query,
 #endif
     .log_registered = log_fcb_registered,
 };
@@ -41,6 +41,9 @@ static int log_nmgr_logs_list(struct mgmt_cbuf *njb);
 #if MYNEWT_VAL(LOG_STORAGE_WATERMARK)
 static int log_nmgr_set_watermark(struct mgmt_cbuf *njb);
 #endif
+#if MYNEWT_VAL(LOG_QUERY)
+static int log_nmgr_query(struct mgmt_cbuf *njb);
+#endif
 static struct mgmt_group log_nmgr_group;
 
 
@@ -56,74 +59,36 @@ static struct mgmt_handler log_nmgr_group_handlers[] = {
 #if MYNEWT_VAL(LOG_STORAGE_WATERMARK)
     [LOGS_NMGR_OP_SET_WATERMARK] = {log_nmgr_set_watermark, NULL},
 #endif
+#if MYNEWT_VAL(LOG_QUERY)
+    [LOGS_NMGR_OP_QUERY] = {log_nmgr_query, log_nmgr_query},
+#endif
 };
 
 struct log_encode_data {
     uint32_t counter;
     CborEncoder *enc;
+    int streaming;
 };
 
 /**
- * Log encode entry
- * @param log structure, log_offset, dataptr, len
- * @return 0 on success; non-zero on failure
+ * Encodes a single log entry as a map.
+ * @param log structure, the entry header and body, a buffer for the body,
+ *        the encoder
+ * @return CborNoError on success; nonzero on failure
  */
-static int
-log_nmgr_encode_entry(struct log *log, struct log_offset *log_offset,
-                      const struct log_entry_hdr *ueh, void *dptr,
-                      uint16_t len)
+static CborError
+log_nmgr_encode_one(struct log *log, const struct log_entry_hdr *ueh,
+                    void *dptr, uint16_t len, uint8_t *data, CborEncoder *enc)
 {
-    uint8_t data[128];
-    int rc;
-    int rsp_len;
     CborError g_err = CborNoError;
-    struct log_encode_data *ed = log_offset->lo_arg;
     CborEncoder rsp;
-    struct CborCntWriter cnt_writer;
-    CborEncoder cnt_encoder;
 #if MYNEWT_VAL(LOG_VERSION) > 2
     CborEncoder str_encoder;
     int off;
-#endif
-    rc = OS_OK;
-
-    /* If specified timestamp is nonzero, it is the primary criterion, and the
-     * specified index is the secondary criterion.  If specified timetsamp is
-     * zero, specified index is the only criterion.
-     *
-     * If specified timestamp == 0: encode entries whose index >=
-     *     specified index.
-     * Else: encode entries whose timestamp >= specified timestamp and whose
-     *      index >= specified index
-     */
-
-    if (log_offset->lo_ts == 0) {
-        if (log_offset->lo_index > ueh->ue_index) {
-            goto err;
-        }
-    } else if (ueh->ue_ts < log_offset->lo_ts   ||
-               (ueh->ue_ts == log_offset->lo_ts &&
-                ueh->ue_index < log_offset->lo_index)) {
-        goto err;
-    }
-
-#if MYNEWT_VAL(LOG_VERSION) < 3
-    rc = log_read_body(log, dptr, data, 0, min(len, 128));
-    if (rc < 0) {
-        rc = OS_ENOENT;
-        goto err;
-    }
-    data[rc] = 0;
+    int rc;
 #endif
 
-    /*calculate whether this would fit */
-    /* create a counting encoder for cbor */
-    cbor_cnt_writer_init(&cnt_writer);
-    cbor_encoder_init(&cnt_encoder, &cnt_writer.enc, 0);
-
-    /* NOTE This code should exactly match what is below */
-    rsp_len = log_offset->lo_data_len;
-    g_err |= cbor_encoder_create_map(&cnt_encoder, &rsp, CborIndefiniteLength);
+    g_err |= cbor_encoder_create_map(enc, &rsp, CborIndefiniteLength);
 #if MYNEWT_VAL(LOG_VERSION) > 2
     switch (ueh->ue_etype) {
     case LOG_ETYPE_CBOR:
@@ -134,6 +99,11 @@ log_nmgr_encode_entry(struct log *log, struct log_offset *log_offset,
         g_err |= cbor_encode_text_stringz(&rsp, "type");
         g_err |= cbor_encode_text_stringz(&rsp, "bin");
         break;
+    case LOG_ETYPE_DICT:
+        /* Expanded on the host by log_dict_decode.py. */
+        g_err |= cbor_encode_text_stringz(&rsp, "type");
+        g_err |= cbor_encode_text_stringz(&rsp, "dict");
+        break;
     case LOG_ETYPE_STRING:
     default:
         /* no need for type here */
@@ -152,7 +122,7 @@ log_nmgr_encode_entry(struct log *log, struct log_offset *log_offset,
      */
     g_err |= cbor_encoder_create_indef_byte_string(&rsp, &str_encoder);
     for (off = 0; off < len && !g_err; ) {
-        rc = log_read_body(log, dptr, data, off, sizeof(data));
+        rc = log_read_body(log, dptr, data, off, 128);
         if (rc < 0) {
             g_err |= 1;
             break;
@@ -173,70 +143,84 @@ log_nmgr_encode_entry(struct log *log, struct log_offset *log_offset,
     g_err |= cbor_encode_uint(&rsp,  ueh->ue_index);
     g_err |= cbor_encode_text_stringz(&rsp, "module");
     g_err |= cbor_encode_uint(&rsp,  ueh->ue_module);
-    g_err |= cbor_encoder_close_container(&cnt_encoder, &rsp);
-    rsp_len += cbor_encode_bytes_written(&cnt_encoder);
-    /*
-     * Make sure that at least single entry is returned, even in case response
-     * exceeds this magic value. This is to make sure we can read long log
-     * entries, even if they have to be read one by one.
+    g_err |= cbor_encoder_close_container(enc, &rsp);
+
+    return g_err;
+}
+
+/**
+ * Log encode entry
+ * @param log structure, log_offset, dataptr, len
+ * @return 0 on success; non-zero on failure
+ */
+static int
+log_nmgr_encode_entry(struct log *log, struct log_offset *log_offset,
+                      const struct log_entry_hdr *ueh, void *dptr,
+                      uint16_t len)
+{
+    uint8_t data[128];
+    int rc;
+    int rsp_len;
+    CborError g_err = CborNoError;
+    struct log_encode_data *ed = log_offset->lo_arg;
+    struct CborCntWriter cnt_writer;
+    CborEncoder cnt_encoder;
+    rc = OS_OK;
+
+    /* If specified timestamp is nonzero, it is the primary criterion, and the
+     * specified index is the secondary criterion.  If specified timetsamp is
+     * zero, specified index is the only criterion.
+     *
+     * If specified timestamp == 0: encode entries whose index >=
+     *     specified index.
+     * Else: encode entries whose timestamp >= specified timestamp and whose
+     *      index >= specified index
      */
-    if ((rsp_len > 400) && (ed->counter > 0)) {
-        rc = OS_ENOMEM;
+
+    if (log_offset->lo_ts == 0) {
+        if (log_offset->lo_index > ueh->ue_index) {
+            goto err;
+        }
+    } else if (ueh->ue_ts < log_offset->lo_ts   ||
+               (ueh->ue_ts == log_offset->lo_ts &&
+                ueh->ue_index < log_offset->lo_index)) {
         goto err;
     }
-    log_offset->lo_data_len = rsp_len;
 
-    g_err |= cbor_encoder_create_map(ed->enc, &rsp, CborIndefiniteLength);
-#if MYNEWT_VAL(LOG_VERSION) > 2
-    switch (ueh->ue_etype) {
-    case LOG_ETYPE_CBOR:
-        g_err |= cbor_encode_text_stringz(&rsp, "type");
-        g_err |= cbor_encode_text_stringz(&rsp, "cbor");
-        break;
-    case LOG_ETYPE_BINARY:
-        g_err |= cbor_encode_text_stringz(&rsp, "type");
-        g_err |= cbor_encode_text_stringz(&rsp, "bin");
-        break;
-    case LOG_ETYPE_STRING:
-    default:
-        /* no need for type here */
-        g_err |= cbor_encode_text_stringz(&rsp, "type");
-        g_err |= cbor_encode_text_stringz(&rsp, "str");
-        break;
+#if MYNEWT_VAL(LOG_VERSION) < 3
+    rc = log_read_body(log, dptr, data, 0, min(len, 128));
+    if (rc < 0) {
+        rc = OS_ENOENT;
+        goto err;
     }
+    data[rc] = 0;
+#endif
 
-    g_err |= cbor_encode_text_stringz(&rsp, "msg");
-
-    /*
-     * Write entry data as byte string. Since this may not fit into single
-     * chunk of data we will write as indefinite-length byte string which is
-     * basically a indefinite-length container with definite-length strings
-     * inside.
+    /* A streamed response goes out as it is encoded, so there is no need to
+     * keep it to a single page.
      */
-    g_err |= cbor_encoder_create_indef_byte_string(&rsp, &str_encoder);
-    for (off = 0; off < len && !g_err; ) {
-        rc = log_read_body(log, dptr, data, off, sizeof(data));
-        if (rc < 0) {
-            g_err |= 1;
-            break;
+    if (!ed->streaming) {
+        /*calculate whether this would fit */
+        /* create a counting encoder for cbor */
+        cbor_cnt_writer_init(&cnt_writer);
+        cbor_encoder_init(&cnt_encoder, &cnt_writer.enc, 0);
+
+        rsp_len = log_offset->lo_data_len;
+        g_err |= log_nmgr_encode_one(log, ueh, dptr, len, data, &cnt_encoder);
+        rsp_len += cbor_encode_bytes_written(&cnt_encoder);
+        /*
+         * Make sure that at least single entry is returned, even in case
+         * response exceeds this magic value. This is to make sure we can read
+         * long log entries, even if they have to be read one by one.
+         */
+        if ((rsp_len > 400) && (ed->counter > 0)) {
+            rc = OS_ENOMEM;
+            goto err;
         }
-        g_err |= cbor_encode_byte_string(&str_encoder, data, rc);
-        off += rc;
+        log_offset->lo_data_len = rsp_len;
     }
-    g_err |= cbor_encoder_close_container(&rsp, &str_encoder);
-#else
-    g_err |= cbor_encode_text_stringz(&rsp, "msg");
-    g_err |= cbor_encode_text_stringz(&rsp, (char *)data);
-#endif
-    g_err |= cbor_encode_text_stringz(&rsp, "ts");
-    g_err |= cbor_encode_int(&rsp, ueh->ue_ts);
-    g_err |= cbor_encode_text_stringz(&rsp, "level");
-    g_err |= cbor_encode_uint(&rsp, ueh->ue_level);
-    g_err |= cbor_encode_text_stringz(&rsp, "index");
-    g_err |= cbor_encode_uint(&rsp,  ueh->ue_index);
-    g_err |= cbor_encode_text_stringz(&rsp, "module");
-    g_err |= cbor_encode_uint(&rsp,  ueh->ue_module);
-    g_err |= cbor_encoder_close_container(ed->enc, &rsp);
+
+    g_err |= log_nmgr_encode_one(log, ueh, dptr, len, data, ed->enc);
 
     ed->counter++;
 
@@ -250,12 +234,14 @@ err:
 
 /**
  * Log encode entries
- * @param log structure, the encoder, timestamp, index
+ * @param log structure, the encoder, timestamp, index, whether the response
+ *        is streamed, optional query selecting the entries
  * @return 0 on success; non-zero on failure
  */
 static int
 log_encode_entries(struct log *log, CborEncoder *cb,
-                   int64_t ts, uint32_t index)
+                   int64_t ts, uint32_t index, int streaming,
+                   struct log_query *query)
 {
     int rc;
     struct log_offset log_offset;
@@ -278,7 +264,7 @@ log_encode_entries(struct log *log, CborEncoder *cb,
     g_err |= cbor_encoder_close_container(&cnt_encoder, &entries);
     rsp_len = cbor_encode_bytes_written(cb) +
               cbor_encode_bytes_written(&cnt_encoder);
-    if (rsp_len > 400) {
+    if (rsp_len > 400 && !streaming) {
         rc = OS_ENOMEM;
         goto err;
     }
@@ -288,13 +274,21 @@ log_encode_entries(struct log *log, CborEncoder *cb,
 
     ed.counter = 0;
     ed.enc = &entries;
+    ed.streaming = streaming;
 
     log_offset.lo_arg       = &ed;
     log_offset.lo_index     = index;
     log_offset.lo_ts        = ts;
     log_offset.lo_data_len  = rsp_len;
 
-    rc = log_walk_body(log, log_nmgr_encode_entry, &log_offset);
+#if MYNEWT_VAL(LOG_QUERY)
+    if (query != NULL) {
+        rc = log_query(log, query, log_nmgr_encode_entry, &log_offset);
+    } else
+#endif
+    {
+        rc = log_walk_body(log, log_nmgr_encode_entry, &log_offset);
+    }
 
     g_err |= cbor_encoder_close_container(cb, &entries);
 
@@ -305,12 +299,14 @@ err:
 /**
  * Log encode function
  * @param log structure, the encoder, json_value,
- *        timestamp, index
+ *        timestamp, index, whether the response is streamed,
+ *        optional query selecting the entries
  * @return 0 on success; non-zero on failure
  */
 static int
 log_encode(struct log *log, CborEncoder *cb,
-            int64_t ts, uint32_t index)
+            int64_t ts, uint32_t index, int streaming,
+            struct log_query *query)
 {
     int rc;
     CborEncoder logs;
@@ -323,7 +319,13 @@ log_encode(struct log *log, CborEncoder *cb,
     g_err |= cbor_encode_text_stringz(&logs, "type");
     g_err |= cbor_encode_uint(&logs, log->l_log->log_type);
 
-    rc = log_encode_entries(log, &logs, ts, index);
+    rc = log_encode_entries(log, &logs, ts, index, streaming, query);
+#if MYNEWT_VAL(LOG_QUERY)
+    if (query != NULL) {
+        g_err |= cbor_encode_text_stringz(&logs, "skipped");
+        g_err |= cbor_encode_uint(&logs, query->lq_skipped);
+    }
+#endif
     g_err |= cbor_encoder_close_container(cb, &logs);
     if (g_err) {
         return MGMT_ERR_ENOMEM;
@@ -399,7 +401,7 @@ log_nmgr_read(struct mgmt_cbuf *cb)
             continue;
         }
 
-        rc = log_encode(log, &logs, ts, index);
+        rc = log_encode(log, &logs, ts, index, mgmt_cbuf_streaming(cb), NULL);
         if (rc) {
             goto err;
         }
@@ -662,6 +664,156 @@ err:
 }
 #endif
 
+#if MYNEWT_VAL(LOG_QUERY)
+/**
+ * Newtmgr Log query handler.  Like read, but only returns entries matching
+ * the requested modules, minimum level, entry types and time range.
+ * @param cbor buffer
+ * @return 0 on success; non-zero on failure
+ */
+static int
+log_nmgr_query(struct mgmt_cbuf *cb)
+{
+    struct log_query query;
+    struct log *log;
+    int rc;
+    char name[LOG_NAME_MAX_LEN] = {0};
+    int name_len;
+    uint64_t modules[16];
+    uint8_t mod_ids[16];
+    int mod_cnt;
+    uint64_t min_level;
+    uint64_t etypes;
+    int64_t ts_min;
+    int64_t ts_max;
+    uint64_t index;
+    int i;
+    CborError g_err = CborNoError;
+    CborEncoder logs;
+
+    const struct cbor_attr_t attr[8] = {
+        [0] = {
+            .attribute = "log_name",
+            .type = CborAttrTextStringType,
+            .addr.string = name,
+            .len = sizeof(name)
+        },
+        [1] = {
+            .attribute = "modules",
+            .type = CborAttrArrayType,
+            .addr.array.element_type = CborAttrUnsignedIntegerType,
+            .addr.array.arr.uintegers.store = modules,
+            .addr.array.count = &mod_cnt,
+            .addr.array.maxlen = sizeof(modules) / sizeof(modules[0]),
+            .nodefault = true
+        },
+        [2] = {
+            .attribute = "min_level",
+            .type = CborAttrUnsignedIntegerType,
+            .addr.uinteger = &min_level
+        },
+        [3] = {
+            .attribute = "etypes",
+            .type = CborAttrUnsignedIntegerType,
+            .addr.uinteger = &etypes
+        },
+        [4] = {
+            .attribute = "ts_min",
+            .type = CborAttrIntegerType,
+            .addr.integer = &ts_min
+        },
+        [5] = {
+            .attribute = "ts_max",
+            .type = CborAttrIntegerType,
+            .addr.integer = &ts_max
+        },
+        [6] = {
+            .attribute = "index",
+            .type = CborAttrUnsignedIntegerType,
+            .addr.uinteger = &index
+        },
+        [7] = {
+            .attribute = NULL
+        }
+    };
+
+    mod_cnt = 0;
+    rc = cbor_read_object(&cb->it, attr);
+    if (rc) {
+        return rc;
+    }
+
+    /* Omitted or zero fields leave that part of the query unrestricted. */
+    log_query_init(&query);
+    for (i = 0; i < mod_cnt; i++) {
+        if (modules[i] > LOG_MODULE_MAX) {
+            return MGMT_ERR_EINVAL;
+        }
+        mod_ids[i] = modules[i];
+    }
+    log_query_set_modules(&query, mod_ids, mod_cnt);
+    query.lq_min_level = min(min_level, UINT8_MAX);
+    if (etypes != 0) {
+        query.lq_etypes = etypes;
+    }
+    if (ts_min != 0) {
+        query.lq_ts_min = ts_min;
+    }
+    if (ts_max != 0) {
+        query.lq_ts_max = ts_max;
+    }
+    query.lq_index = index;
+
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "next_index");
+    g_err |= cbor_encode_int(&cb->encoder, g_log_info.li_next_index);
+
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "logs");
+    g_err |= cbor_encoder_create_array(&cb->encoder, &logs,
+                                       CborIndefiniteLength);
+
+    name_len = strlen(name);
+    log = NULL;
+    while (1) {
+        log = log_list_get_next(log);
+        if (!log) {
+            break;
+        }
+
+        if (log->l_log->log_type == LOG_TYPE_STREAM) {
+            continue;
+        }
+
+        if ((name_len > 0) && strcmp(name, log->l_name)) {
+            continue;
+        }
+
+        rc = log_encode(log, &logs, 0, index, mgmt_cbuf_streaming(cb),
+                        &query);
+        if (rc) {
+            goto err;
+        }
+
+        if (name_len > 0) {
+            break;
+        }
+    }
+
+    if (!log && name_len > 0) {
+        rc = OS_EINVAL;
+    }
+
+err:
+    g_err |= cbor_encoder_close_container(&cb->encoder, &logs);
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "rc");
+    g_err |= cbor_encode_int(&cb->encoder, rc);
+
+    if (g_err) {
+        return MGMT_ERR_ENOMEM;
+    }
+    return 0;
+}
+#endif
+
 /**
  * Register nmgr group handlers.
  * @return 0 on success; non-zero on failure
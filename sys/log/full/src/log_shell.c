@@ -65,6 +65,19 @@ shell_log_dump_entry(struct log *log, struct log_offset *log_offset,
     case LOG_ETYPE_STRING:
         console_printf("[%llu] %s\n", ueh->ue_ts, data);
         break;
+#if MYNEWT_VAL(LOG_DICT)
+    case LOG_ETYPE_DICT: {
+        char text[sizeof data];
+
+        if (log_dict_format(text, sizeof text, data, rc) >= 0) {
+            console_printf("[%llu] %s%s\n", ueh->ue_ts, text,
+                           rc < len ? "..." : "");
+            break;
+        }
+        /* Unknown format ID; dump it as hex. */
+    }
+    /* FALLTHROUGH */
+#endif
     default:
         console_printf("[%llu] ", ueh->ue_ts);
         for (off = 0; off < rc; off += blksz) {
@@ -0,0 +1,837 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(LOG_TIERED)
+
+#include "flash_map/flash_map.h"
+#include "log/log.h"
+#include "log/log_tiered.h"
+
+#if MYNEWT_VAL(LOG_TIERED_SPILL_BUF) % 8 != 0
+#error "LOG_TIERED_SPILL_BUF must be a multiple of 8"
+#endif
+
+/*
+ * Room kept free in an FCB sector for the sector header and for the length,
+ * CRC and alignment padding of a single element.
+ */
+#define LOG_TIERED_SECTOR_OVERHEAD  32
+
+/*
+ * Walk callbacks get a pointer to this structure as dptr.  It identifies the
+ * tier an entry lives in and the tier-specific location of the entry.
+ */
+struct log_tiered_ptr {
+    struct log *ltp_log;
+    void *ltp_dptr;
+    struct fcb_entry ltp_loc;
+};
+
+/* Staging buffer for writing a batch into an FCB element. */
+struct log_tiered_wr {
+    struct fcb_entry lw_loc;
+    uint32_t lw_off;
+    int lw_buf_len;
+    uint8_t lw_buf[MYNEWT_VAL(LOG_TIERED_SPILL_BUF)];
+};
+
+static struct log *
+log_tiered_front_lock(struct log_tiered *lt)
+{
+    os_mutex_pend(&lt->lt_mutex, OS_TIMEOUT_NEVER);
+    lt->lt_front_start_seq = lt->lt_cbmem[lt->lt_front].c_start_seq;
+    return &lt->lt_mem[lt->lt_front];
+}
+
+static int
+log_tiered_front_unlock(struct log_tiered *lt, int len, int rc)
+{
+    uint32_t overwritten;
+    bool spill;
+
+    if (rc == 0) {
+        lt->lt_front_bytes += sizeof(struct cbmem_entry_hdr) + len;
+    }
+
+    /* The front half wraps if it fills before the spill gets to it; the
+     * entries it overwrote never reach flash.
+     */
+    overwritten = lt->lt_cbmem[lt->lt_front].c_start_seq -
+                  lt->lt_front_start_seq;
+    if (overwritten != 0) {
+        LOG_STATS_INCN(lt->lt_log, lost, overwritten);
+    }
+    spill = lt->lt_front_bytes >= lt->lt_watermark;
+
+    os_mutex_release(&lt->lt_mutex);
+
+    if (spill) {
+        os_eventq_put(os_eventq_dflt_get(), &lt->lt_spill_ev);
+    }
+
+    return rc;
+}
+
+static int
+log_tiered_append(struct log *log, void *buf, int len)
+{
+    struct log_tiered *lt;
+    struct log *mem;
+    int rc;
+
+    lt = log->l_arg;
+    mem = log_tiered_front_lock(lt);
+    rc = mem->l_log->log_append(mem, buf, len);
+
+    return log_tiered_front_unlock(lt, len, rc);
+}
+
+static int
+log_tiered_append_body(struct log *log, const struct log_entry_hdr *hdr,
+                       const void *body, int body_len)
+{
+    struct log_tiered *lt;
+    struct log *mem;
+    int rc;
+
+    lt = log->l_arg;
+    mem = log_tiered_front_lock(lt);
+    rc = mem->l_log->log_append_body(mem, hdr, body, body_len);
+
+    return log_tiered_front_unlock(lt, sizeof *hdr + body_len, rc);
+}
+
+static int
+log_tiered_append_mbuf(struct log *log, const struct os_mbuf *om)
+{
+    struct log_tiered *lt;
+    struct log *mem;
+    int rc;
+
+    lt = log->l_arg;
+    mem = log_tiered_front_lock(lt);
+    rc = mem->l_log->log_append_mbuf(mem, om);
+
+    return log_tiered_front_unlock(lt, os_mbuf_len(om), rc);
+}
+
+static int
+log_tiered_append_mbuf_body(struct log *log, const struct log_entry_hdr *hdr,
+                            const struct os_mbuf *om)
+{
+    struct log_tiered *lt;
+    struct log *mem;
+    int rc;
+
+    lt = log->l_arg;
+    mem = log_tiered_front_lock(lt);
+    rc = mem->l_log->log_append_mbuf_body(mem, hdr, om);
+
+    return log_tiered_front_unlock(lt, sizeof *hdr + os_mbuf_len(om), rc);
+}
+
+static int
+log_tiered_read(struct log *log, void *dptr, void *buf, uint16_t offset,
+                uint16_t len)
+{
+    struct log_tiered_ptr *ptr;
+
+    ptr = dptr;
+    return ptr->ltp_log->l_log->log_read(ptr->ltp_log, ptr->ltp_dptr, buf,
+                                         offset, len);
+}
+
+static int
+log_tiered_read_mbuf(struct log *log, void *dptr, struct os_mbuf *om,
+                     uint16_t offset, uint16_t len)
+{
+    struct log_tiered_ptr *ptr;
+
+    ptr = dptr;
+    return ptr->ltp_log->l_log->log_read_mbuf(ptr->ltp_log, ptr->ltp_dptr,
+                                              om, offset, len);
+}
+
+/**
+ * Walks the entries packed in one FCB element.  Each entry is preceded by its
+ * length (16 bits, little endian).  If last_only is set, only the final entry
+ * of the element is passed to walk_func.
+ */
+static int
+log_tiered_walk_elem(struct log *log, struct fcb_entry *loc,
+                     log_walk_func_t walk_func, struct log_offset *log_offset,
+                     bool last_only)
+{
+    struct log_tiered_ptr ptr;
+    struct log_tiered *lt;
+    uint8_t rec_hdr[2];
+    uint16_t rec_len;
+    uint32_t off;
+    int rc;
+
+    lt = log->l_arg;
+
+    ptr.ltp_log = &lt->lt_fcb;
+    ptr.ltp_dptr = &ptr.ltp_loc;
+    ptr.ltp_loc = *loc;
+
+    rc = 0;
+    off = 0;
+    while (off + sizeof rec_hdr <= loc->fe_data_len) {
+        rc = flash_area_read(loc->fe_area, loc->fe_data_off + off, rec_hdr,
+                             sizeof rec_hdr);
+        if (rc != 0) {
+            return SYS_EIO;
+        }
+        rec_len = get_le16(rec_hdr);
+        off += sizeof rec_hdr;
+
+        if (off + rec_len > loc->fe_data_len) {
+            /* Corrupt element; ignore the rest of it. */
+            break;
+        }
+
+        ptr.ltp_loc.fe_data_off = loc->fe_data_off + off;
+        ptr.ltp_loc.fe_data_len = rec_len;
+        off += rec_len;
+
+        if (last_only && off < loc->fe_data_len) {
+            continue;
+        }
+
+        rc = walk_func(log, log_offset, &ptr, rec_len);
+        if (rc != 0) {
+            break;
+        }
+    }
+
+    return rc;
+}
+
+static int
+log_tiered_walk_mem(struct log *log, int half, log_walk_func_t walk_func,
+                    struct log_offset *log_offset)
+{
+    struct log_tiered_ptr ptr;
+    struct cbmem_entry_hdr *hdr;
+    struct log_tiered *lt;
+    struct cbmem_iter iter;
+    struct cbmem *cbmem;
+    int rc;
+
+    lt = log->l_arg;
+    cbmem = &lt->lt_cbmem[half];
+
+    ptr.ltp_log = &lt->lt_mem[half];
+
+    rc = cbmem_lock_acquire(cbmem);
+    if (rc != 0) {
+        return rc;
+    }
+
+    if (half != lt->lt_front && lt->lt_spilling) {
+        /* Entries preceding lt_next have already been written to FCB. */
+        iter = lt->lt_iter;
+        hdr = lt->lt_next;
+    } else {
+        cbmem_iter_start(cbmem, &iter);
+        hdr = cbmem_iter_next(cbmem, &iter);
+    }
+
+    while (hdr != NULL) {
+        ptr.ltp_dptr = hdr;
+        rc = walk_func(log, log_offset, &ptr, hdr->ceh_len);
+        if (rc != 0) {
+            break;
+        }
+        hdr = cbmem_iter_next(cbmem, &iter);
+    }
+
+    cbmem_lock_release(cbmem);
+
+    return rc;
+}
+
+static int
+log_tiered_walk_last(struct log *log, log_walk_func_t walk_func,
+                     struct log_offset *log_offset)
+{
+    struct log_tiered_ptr ptr;
+    struct cbmem_entry_hdr *hdr;
+    struct log_tiered *lt;
+    struct fcb_entry loc;
+    struct fcb *fcb;
+    int half;
+
+    lt = log->l_arg;
+
+    half = lt->lt_front;
+    hdr = lt->lt_cbmem[half].c_entry_end;
+    if (hdr == NULL && lt->lt_spilling && lt->lt_next != NULL) {
+        half = !half;
+        hdr = lt->lt_cbmem[half].c_entry_end;
+    }
+
+    if (hdr != NULL) {
+        ptr.ltp_log = &lt->lt_mem[half];
+        ptr.ltp_dptr = hdr;
+        return walk_func(log, log_offset, &ptr, hdr->ceh_len);
+    }
+
+    fcb = &((struct fcb_log *)lt->lt_fcb.l_arg)->fl_fcb;
+    if (fcb_offset_last_n(fcb, 1, &loc) != 0) {
+        return 0;
+    }
+
+    return log_tiered_walk_elem(log, &loc, walk_func, log_offset, true);
+}
+
+/**
+ * Walks the FCB tier, then the half being spilled (if any), then the front
+ * half.  Entries are visited oldest first, so indices increase monotonically
+ * across tiers.
+ */
+static int
+log_tiered_walk(struct log *log, log_walk_func_t walk_func,
+                struct log_offset *log_offset)
+{
+    struct log_tiered *lt;
+    struct fcb_entry loc;
+    struct fcb *fcb;
+    int rc;
+
+    lt = log->l_arg;
+    fcb = &((struct fcb_log *)lt->lt_fcb.l_arg)->fl_fcb;
+
+    /* Keep entries from moving between tiers while they are walked. */
+    os_mutex_pend(&lt->lt_spill_mutex, OS_TIMEOUT_NEVER);
+
+    /*
+     * if timestamp for request is < 0, return last log entry
+     */
+    if (log_offset->lo_ts < 0) {
+        rc = log_tiered_walk_last(log, walk_func, log_offset);
+        goto done;
+    }
+
+    rc = 0;
+    memset(&loc, 0, sizeof(loc));
+    while (fcb_getnext(fcb, &loc) == 0) {
+        rc = log_tiered_walk_elem(log, &loc, walk_func, log_offset, false);
+        if (rc != 0) {
+            goto done;
+        }
+    }
+
+    if (lt->lt_spilling) {
+        rc = log_tiered_walk_mem(log, !lt->lt_front, walk_func, log_offset);
+        if (rc != 0) {
+            goto done;
+        }
+    }
+
+    rc = log_tiered_walk_mem(log, lt->lt_front, walk_func, log_offset);
+
+done:
+    os_mutex_release(&lt->lt_spill_mutex);
+    return rc;
+}
+
+static int
+log_tiered_batch_max(const struct fcb *fcb)
+{
+    int max;
+    int i;
+
+    max = MYNEWT_VAL(LOG_TIERED_BATCH_MAX);
+    for (i = 0; i < fcb->f_sector_cnt; i++) {
+        max = min(max, (int)fcb->f_sectors[i].fa_size -
+                       LOG_TIERED_SECTOR_OVERHEAD);
+    }
+
+    return min(max, FCB_MAX_LEN - 1);
+}
+
+/**
+ * Reserves an FCB element, erasing the oldest sectors as needed.
+ */
+static int
+log_tiered_fcb_start(struct log_tiered *lt, int len, struct fcb_entry *loc)
+{
+    struct fcb *fcb;
+    int rc;
+    int i;
+
+    fcb = &((struct fcb_log *)lt->lt_fcb.l_arg)->fl_fcb;
+
+    for (i = 0; ; i++) {
+        rc = fcb_append(fcb, len, loc);
+        if (rc != FCB_ERR_NOSPACE || i >= fcb->f_sector_cnt) {
+            return rc;
+        }
+
+        rc = fcb_rotate(fcb);
+        if (rc != 0) {
+            return rc;
+        }
+    }
+}
+
+static int
+log_tiered_wr_flush(struct log_tiered_wr *wr)
+{
+    int rc;
+
+    if (wr->lw_buf_len == 0) {
+        return 0;
+    }
+
+    rc = flash_area_write(wr->lw_loc.fe_area, wr->lw_loc.fe_data_off +
+                          wr->lw_off, wr->lw_buf, wr->lw_buf_len);
+    if (rc != 0) {
+        return SYS_EIO;
+    }
+
+    wr->lw_off += wr->lw_buf_len;
+    wr->lw_buf_len = 0;
+
+    return 0;
+}
+
+/**
+ * Adds data to the element being written.  Flash is only written in units of
+ * the staging buffer size, except for the tail of the element.
+ */
+static int
+log_tiered_wr_put(struct log_tiered_wr *wr, const void *data, int len)
+{
+    const uint8_t *u8p;
+    int chunk_sz;
+    int rc;
+
+    u8p = data;
+    while (len > 0) {
+        if (wr->lw_buf_len == 0 && len >= sizeof wr->lw_buf) {
+            /* Write whole buffer-sized chunks straight from RAM. */
+            chunk_sz = len - len % sizeof wr->lw_buf;
+            rc = flash_area_write(wr->lw_loc.fe_area,
+                                  wr->lw_loc.fe_data_off + wr->lw_off,
+                                  u8p, chunk_sz);
+            if (rc != 0) {
+                return SYS_EIO;
+            }
+            wr->lw_off += chunk_sz;
+        } else {
+            chunk_sz = min(len, sizeof wr->lw_buf - wr->lw_buf_len);
+            memcpy(wr->lw_buf + wr->lw_buf_len, u8p, chunk_sz);
+            wr->lw_buf_len += chunk_sz;
+
+            if (wr->lw_buf_len == sizeof wr->lw_buf) {
+                rc = log_tiered_wr_flush(wr);
+                if (rc != 0) {
+                    return rc;
+                }
+            }
+        }
+
+        u8p += chunk_sz;
+        len -= chunk_sz;
+    }
+
+    return 0;
+}
+
+/**
+ * Writes the entries of the given half, starting at lt_next, to FCB.  The
+ * position is only advanced once an element is complete, so an interrupted
+ * spill can be resumed without losing or duplicating entries.
+ */
+static int
+log_tiered_spill_half(struct log_tiered *lt, int half)
+{
+    struct log_tiered_wr wr;
+    struct cbmem_entry_hdr *end;
+    struct cbmem_entry_hdr *hdr;
+    struct cbmem_iter end_iter;
+    struct cbmem_iter iter;
+    struct cbmem *cbmem;
+    struct fcb *fcb;
+    uint8_t rec_hdr[2];
+    int batch_max;
+    int len;
+    int rc;
+
+    cbmem = &lt->lt_cbmem[half];
+    fcb = &((struct fcb_log *)lt->lt_fcb.l_arg)->fl_fcb;
+    batch_max = log_tiered_batch_max(fcb);
+
+    while (lt->lt_next != NULL) {
+        /* Size the batch: as many entries as fit in one element. */
+        end_iter = lt->lt_iter;
+        end = lt->lt_next;
+        len = 0;
+        do {
+            len += sizeof rec_hdr + end->ceh_len;
+            end = cbmem_iter_next(cbmem, &end_iter);
+        } while (end != NULL &&
+                 len + sizeof rec_hdr + end->ceh_len <= batch_max);
+
+        if (len > batch_max) {
+            /* A single entry that does not fit in any sector. */
+            LOG_STATS_INC(lt->lt_log, lost);
+            lt->lt_iter = end_iter;
+            lt->lt_next = end;
+            continue;
+        }
+
+        rc = log_tiered_fcb_start(lt, len, &wr.lw_loc);
+        if (rc != 0) {
+            return rc;
+        }
+        wr.lw_off = 0;
+        wr.lw_buf_len = 0;
+
+        iter = lt->lt_iter;
+        hdr = lt->lt_next;
+        while (hdr != end) {
+            put_le16(rec_hdr, hdr->ceh_len);
+            rc = log_tiered_wr_put(&wr, rec_hdr, sizeof rec_hdr);
+            if (rc != 0) {
+                return rc;
+            }
+            rc = log_tiered_wr_put(&wr, hdr + 1, hdr->ceh_len);
+            if (rc != 0) {
+                return rc;
+            }
+            hdr = cbmem_iter_next(cbmem, &iter);
+        }
+
+        rc = log_tiered_wr_flush(&wr);
+        if (rc != 0) {
+            return rc;
+        }
+
+        wr.lw_loc.fe_data_len = len;
+        rc = fcb_append_finish(fcb, &wr.lw_loc);
+        if (rc != 0) {
+            return rc;
+        }
+
+        lt->lt_iter = end_iter;
+        lt->lt_next = end;
+    }
+
+    return 0;
+}
+
+/**
+ * Makes the other half the front half and prepares to spill the old front.
+ * The other half is expected to be empty.
+ */
+static void
+log_tiered_swap(struct log_tiered *lt)
+{
+    struct cbmem *cbmem;
+
+    cbmem = &lt->lt_cbmem[lt->lt_front];
+
+    lt->lt_front = !lt->lt_front;
+    lt->lt_front_bytes = 0;
+
+    cbmem_iter_start(cbmem, &lt->lt_iter);
+    lt->lt_next = cbmem_iter_next(cbmem, &lt->lt_iter);
+    lt->lt_spilling = 1;
+}
+
+static int
+log_tiered_spill_lt(struct log_tiered *lt)
+{
+    int rc;
+
+    os_mutex_pend(&lt->lt_spill_mutex, OS_TIMEOUT_NEVER);
+
+    /* A spill that failed part way is resumed instead of swapping again. */
+    if (!lt->lt_spilling) {
+        os_mutex_pend(&lt->lt_mutex, OS_TIMEOUT_NEVER);
+        if (lt->lt_front_bytes != 0) {
+            log_tiered_swap(lt);
+        }
+        os_mutex_release(&lt->lt_mutex);
+
+        if (!lt->lt_spilling) {
+            rc = 0;
+            goto done;
+        }
+    }
+
+    rc = log_tiered_spill_half(lt, !lt->lt_front);
+    if (rc != 0) {
+        goto done;
+    }
+
+    rc = cbmem_flush(&lt->lt_cbmem[!lt->lt_front]);
+    if (rc != 0) {
+        goto done;
+    }
+    lt->lt_spilling = 0;
+
+done:
+    os_mutex_release(&lt->lt_spill_mutex);
+    return rc;
+}
+
+int
+log_tiered_spill(struct log *log)
+{
+    if (log->l_log != &log_tiered_handler) {
+        return SYS_EINVAL;
+    }
+
+    return log_tiered_spill_lt(log->l_arg);
+}
+
+static void
+log_tiered_spill_event(struct os_event *ev)
+{
+    struct log_tiered *lt;
+
+    lt = ev->ev_arg;
+
+    log_tiered_spill_lt(lt);
+
+#if MYNEWT_VAL(LOG_TIERED_SPILL_INTERVAL) > 0
+    os_callout_reset(&lt->lt_timer,
+                     os_time_ms_to_ticks32(
+                         MYNEWT_VAL(LOG_TIERED_SPILL_INTERVAL)));
+#endif
+}
+
+void
+log_tiered_crash_flush(void)
+{
+    struct log_tiered *lt;
+    struct log *log;
+    struct fcb *fcb;
+    os_sr_t sr;
+    int rc;
+
+    OS_ENTER_CRITICAL(sr);
+
+    log = NULL;
+    while (1) {
+        log = log_list_get_next(log);
+        if (log == NULL) {
+            break;
+        }
+
+        if (log->l_log != &log_tiered_handler) {
+            continue;
+        }
+
+        lt = log->l_arg;
+        fcb = &((struct fcb_log *)lt->lt_fcb.l_arg)->fl_fcb;
+
+        /* The interrupted code may be in the middle of an append to the
+         * front half, or of an FCB operation.
+         */
+        if (lt->lt_mutex.mu_level != 0 || fcb->f_mtx.mu_level != 0) {
+            continue;
+        }
+
+        /* Finish an interrupted spill, then spill the front half.  The RAM
+         * copies are left in place; the system is about to reset.
+         */
+        if (lt->lt_spilling) {
+            rc = log_tiered_spill_half(lt, !lt->lt_front);
+            if (rc != 0) {
+                continue;
+            }
+        }
+
+        cbmem_iter_start(&lt->lt_cbmem[lt->lt_front], &lt->lt_iter);
+        lt->lt_next = cbmem_iter_next(&lt->lt_cbmem[lt->lt_front],
+                                      &lt->lt_iter);
+        log_tiered_spill_half(lt, lt->lt_front);
+    }
+
+    OS_EXIT_CRITICAL(sr);
+}
+
+void
+log_tiered_spill_all(void)
+{
+    struct log *log;
+    int rc;
+    int i;
+
+    log = NULL;
+    while (1) {
+        log = log_list_get_next(log);
+        if (log == NULL) {
+            break;
+        }
+
+        if (log->l_log != &log_tiered_handler) {
+            continue;
+        }
+
+        /* The first spill may only finish one that was interrupted; the
+         * second one then writes the front half.
+         */
+        for (i = 0; i < 2; i++) {
+            rc = log_tiered_spill_lt(log->l_arg);
+            if (rc != 0) {
+                break;
+            }
+        }
+    }
+}
+
+static int
+log_tiered_flush(struct log *log)
+{
+    struct log_tiered *lt;
+    int rc;
+    int i;
+
+    lt = log->l_arg;
+
+    os_mutex_pend(&lt->lt_spill_mutex, OS_TIMEOUT_NEVER);
+    os_mutex_pend(&lt->lt_mutex, OS_TIMEOUT_NEVER);
+
+    for (i = 0; i < 2; i++) {
+        rc = cbmem_flush(&lt->lt_cbmem[i]);
+        if (rc != 0) {
+            goto done;
+        }
+    }
+    lt->lt_spilling = 0;
+    lt->lt_next = NULL;
+    lt->lt_front_bytes = 0;
+
+    rc = lt->lt_fcb.l_log->log_flush(&lt->lt_fcb);
+
+done:
+    os_mutex_release(&lt->lt_mutex);
+    os_mutex_release(&lt->lt_spill_mutex);
+    return rc;
+}
+
+#if MYNEWT_VAL(LOG_STORAGE_INFO)
+static int
+log_tiered_storage_info(struct log *log, struct log_storage_info *info)
+{
+    struct log_tiered *lt;
+
+    lt = log->l_arg;
+    return lt->lt_fcb.l_log->log_storage_info(&lt->lt_fcb, info);
+}
+#endif
+
+static int
+log_tiered_registered(struct log *log)
+{
+    struct log_tiered *lt;
+    int i;
+
+    lt = log->l_arg;
+    lt->lt_log = log;
+
+    /* l_log and l_arg are set in log_tiered_init() */
+
+    lt->lt_fcb.l_name = log->l_name;
+    lt->lt_fcb.l_level = log->l_level;
+
+    for (i = 0; i < 2; i++) {
+        lt->lt_mem[i].l_name = log->l_name;
+        lt->lt_mem[i].l_level = log->l_level;
+    }
+
+    if (lt->lt_fcb.l_log->log_registered) {
+        lt->lt_fcb.l_log->log_registered(&lt->lt_fcb);
+    }
+
+#if MYNEWT_VAL(LOG_TIERED_SPILL_INTERVAL) > 0
+    os_callout_reset(&lt->lt_timer,
+                     os_time_ms_to_ticks32(
+                         MYNEWT_VAL(LOG_TIERED_SPILL_INTERVAL)));
+#endif
+
+    return 0;
+}
+
+const struct log_handler log_tiered_handler = {
+    .log_type = LOG_TYPE_STORAGE,
+    .log_read = log_tiered_read,
+    .log_read_mbuf = log_tiered_read_mbuf,
+    .log_append = log_tiered_append,
+    .log_append_body = log_tiered_append_body,
+    .log_append_mbuf = log_tiered_append_mbuf,
+    .log_append_mbuf_body = log_tiered_append_mbuf_body,
+    .log_walk = log_tiered_walk,
+    .log_flush = log_tiered_flush,
+#if MYNEWT_VAL(LOG_STORAGE_INFO)
+    .log_storage_info = log_tiered_storage_info,
+#endif
+    .log_registered = log_tiered_registered,
+};
+
+int
+log_tiered_init(struct log_tiered *lt, struct fcb_log *fcb_arg,
+                void *buf, uint32_t buf_len)
+{
+    uint32_t half_len;
+    uint8_t *u8p;
+    int i;
+
+    half_len = buf_len / 2;
+    if (!fcb_arg || !buf || half_len <= sizeof(struct cbmem_entry_hdr)) {
+        return SYS_EINVAL;
+    }
+
+    memset(lt, 0, sizeof(*lt));
+
+    os_mutex_init(&lt->lt_mutex);
+    os_mutex_init(&lt->lt_spill_mutex);
+
+    lt->lt_fcb.l_log = &log_fcb_handler;
+    lt->lt_fcb.l_arg = fcb_arg;
+
+    u8p = buf;
+    for (i = 0; i < 2; i++) {
+        cbmem_init(&lt->lt_cbmem[i], u8p + i * half_len, half_len);
+        lt->lt_mem[i].l_log = &log_cbmem_handler;
+        lt->lt_mem[i].l_arg = &lt->lt_cbmem[i];
+    }
+
+    lt->lt_watermark = (uint64_t)half_len *
+                       MYNEWT_VAL(LOG_TIERED_WATERMARK) / 100;
+
+    lt->lt_spill_ev.ev_cb = log_tiered_spill_event;
+    lt->lt_spill_ev.ev_arg = lt;
+    os_callout_init(&lt->lt_timer, os_eventq_dflt_get(),
+                    log_tiered_spill_event, lt);
+
+    return 0;
+}
+
+#endif
@@ -29,6 +29,7 @@ main(int argc, char **argv)
     log_test_suite_cbmem_mbuf();
     log_test_suite_fcb_flat();
     log_test_suite_fcb_mbuf();
+    log_test_suite_tiered();
     log_test_suite_misc();
 
     return tu_any_failed;
@@ -26,6 +26,7 @@ int
 main(int argc, char **argv)
 {
     log_test_suite_fcb_flat();
+    log_test_suite_tiered();
 
     /* XXX: The current fcb mbuf implementation requires flash-alignment=1. */
 #if 0
@@ -0,0 +1,58 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_LOG_DICT_TEST_
+#define H_LOG_DICT_TEST_
+
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+#include "log/log.h"
+#include "modlog/modlog.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LOG_DICT_TEST_MODULE    LOG_MODULE_PERUSER
+
+/** Registers a cbmem log at the specified level. */
+void log_dict_test_util_setup(struct log *log, uint8_t level);
+
+/** Counts the entries in a log. */
+int log_dict_test_util_count(struct log *log);
+
+/**
+ * Expands the most recent entry of a log into text, whatever its type.
+ *
+ * @return                      The entry's type.
+ */
+int log_dict_test_util_last(struct log *log, char *dst, int dst_len);
+
+TEST_SUITE_DECL(log_dict_test_suite);
+TEST_CASE_DECL(log_dict_test_case_format);
+TEST_CASE_DECL(log_dict_test_case_trunc);
+TEST_CASE_DECL(log_dict_test_case_level);
+TEST_CASE_DECL(log_dict_test_case_cbmem);
+TEST_CASE_DECL(log_dict_test_case_bench);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
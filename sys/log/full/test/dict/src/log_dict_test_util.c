@@ -0,0 +1,116 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "log_dict_test.h"
+
+static uint8_t log_dict_test_cbmem_buf[8192];
+static struct cbmem log_dict_test_cbmem;
+
+void
+log_dict_test_util_setup(struct log *log, uint8_t level)
+{
+    int rc;
+
+    sysinit();
+
+    cbmem_init(&log_dict_test_cbmem, log_dict_test_cbmem_buf,
+               sizeof log_dict_test_cbmem_buf);
+
+    rc = log_register("dict", log, &log_cbmem_handler, &log_dict_test_cbmem,
+                      level);
+    TEST_ASSERT_FATAL(rc == 0);
+}
+
+static int
+log_dict_test_util_count_entry(struct log *log, struct log_offset *log_offset,
+                               const struct log_entry_hdr *hdr, void *dptr,
+                               uint16_t len)
+{
+    (*(int *)log_offset->lo_arg)++;
+    return 0;
+}
+
+int
+log_dict_test_util_count(struct log *log)
+{
+    struct log_offset log_offset = { 0 };
+    int count;
+    int rc;
+
+    count = 0;
+    log_offset.lo_arg = &count;
+    rc = log_walk_body(log, log_dict_test_util_count_entry, &log_offset);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    return count;
+}
+
+struct log_dict_test_util_last_arg {
+    char *dst;
+    int dst_len;
+    int etype;
+};
+
+static int
+log_dict_test_util_last_entry(struct log *log, struct log_offset *log_offset,
+                              const struct log_entry_hdr *hdr, void *dptr,
+                              uint16_t len)
+{
+    struct log_dict_test_util_last_arg *arg;
+    uint8_t body[LOG_PRINTF_MAX_ENTRY_LEN];
+    int rc;
+
+    arg = log_offset->lo_arg;
+
+    TEST_ASSERT_FATAL(len <= sizeof body);
+    rc = log_read_body(log, dptr, body, 0, len);
+    TEST_ASSERT_FATAL(rc == len);
+
+    arg->etype = hdr->ue_etype;
+    if (hdr->ue_etype == LOG_ETYPE_DICT) {
+        rc = log_dict_format(arg->dst, arg->dst_len, body, len);
+        TEST_ASSERT_FATAL(rc >= 0);
+    } else {
+        TEST_ASSERT_FATAL(len < arg->dst_len);
+        memcpy(arg->dst, body, len);
+        arg->dst[len] = '\0';
+    }
+
+    return 0;
+}
+
+int
+log_dict_test_util_last(struct log *log, char *dst, int dst_len)
+{
+    struct log_dict_test_util_last_arg arg;
+    struct log_offset log_offset = { 0 };
+    int rc;
+
+    arg.dst = dst;
+    arg.dst_len = dst_len;
+    arg.etype = -1;
+
+    log_offset.lo_arg = &arg;
+    rc = log_walk_body(log, log_dict_test_util_last_entry, &log_offset);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT_FATAL(arg.etype >= 0);
+
+    return arg.etype;
+}
@@ -0,0 +1,137 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include "log_dict_test.h"
+
+#define LOG_DICT_TEST_BENCH_ROUNDS      256
+
+/* Number of entries written by log_dict_test_bench_burst(). */
+#define LOG_DICT_TEST_BENCH_BURST       5
+
+#define LOG_DICT_TEST_BENCH_LOG(log_, dict_, lvl_, fmt_, ...) do {          \
+    if (dict_) {                                                            \
+        log_printf_dict((log_), LOG_DICT_TEST_MODULE, (lvl_),               \
+                        LOG_DICT_FMT(fmt_), ##__VA_ARGS__);                 \
+    } else {                                                                \
+        log_printf((log_), LOG_DICT_TEST_MODULE, (lvl_), fmt_,              \
+                   ##__VA_ARGS__);                                          \
+    }                                                                       \
+} while (0)
+
+/*
+ * Writes a set of entries typical of the networking stack and the management
+ * code, as text or as dictionary entries.
+ */
+static void
+log_dict_test_bench_burst(struct log *log, int dict, uint8_t level, int i)
+{
+    LOG_DICT_TEST_BENCH_LOG(log, dict, level,
+        "GAP procedure initiated: connect; peer_addr_type=%d "
+        "peer_addr=%02x:%02x:%02x:%02x:%02x:%02x scan_itvl=%d "
+        "scan_window=%d\n",
+        0, 0xc0, 0x12, 0x34, 0x56, 0x78, i & 0xff, 16, 16);
+    LOG_DICT_TEST_BENCH_LOG(log, dict, level,
+        "ble_hs_hci_cmd_tx: ogf=0x%02x ocf=0x%04x len=%d\n",
+        0x08, 0x000d, 25);
+    LOG_DICT_TEST_BENCH_LOG(log, dict, level,
+        "conn_handle=%d status=%d\n", i, 0);
+    LOG_DICT_TEST_BENCH_LOG(log, dict, level,
+        "imgmgr: upload off=%lu len=%u\n", (unsigned long)i * 512, 512);
+    LOG_DICT_TEST_BENCH_LOG(log, dict, level,
+        "%s: rc=%d\n", "fcb_append", -i);
+}
+
+static int
+log_dict_test_bench_size_entry(struct log *log, struct log_offset *log_offset,
+                               const struct log_entry_hdr *hdr, void *dptr,
+                               uint16_t len)
+{
+    *(int *)log_offset->lo_arg += len;
+    return 0;
+}
+
+/*
+ * @return                      Body bytes used by one burst.
+ */
+static int
+log_dict_test_bench_size(int dict)
+{
+    struct log_offset log_offset = { 0 };
+    struct log log;
+    int size;
+    int rc;
+
+    log_dict_test_util_setup(&log, LOG_LEVEL_DEBUG);
+    log_dict_test_bench_burst(&log, dict, LOG_LEVEL_INFO, 1000);
+
+    size = 0;
+    log_offset.lo_arg = &size;
+    rc = log_walk_body(&log, log_dict_test_bench_size_entry, &log_offset);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    return size;
+}
+
+/*
+ * @return                      Time per entry, in nanoseconds.
+ */
+static uint32_t
+log_dict_test_bench_time(int dict, uint8_t level)
+{
+    struct log log;
+    uint32_t start;
+    uint32_t usecs;
+    int i;
+
+    log_dict_test_util_setup(&log, LOG_LEVEL_INFO);
+
+    start = os_cputime_get32();
+    for (i = 0; i < LOG_DICT_TEST_BENCH_ROUNDS; i++) {
+        log_dict_test_bench_burst(&log, dict, level, i);
+    }
+    usecs = os_cputime_ticks_to_usecs(os_cputime_get32() - start);
+
+    return (uint64_t)usecs * 1000 /
+           (LOG_DICT_TEST_BENCH_ROUNDS * LOG_DICT_TEST_BENCH_BURST);
+}
+
+/*
+ * Reports the space and time taken by text and dictionary entries, and the
+ * cost of a write that is dropped by level.
+ */
+TEST_CASE(log_dict_test_case_bench)
+{
+    int text_size;
+    int dict_size;
+
+    text_size = log_dict_test_bench_size(0);
+    dict_size = log_dict_test_bench_size(1);
+
+    printf("text: %d bytes, %lu ns per entry, %lu ns per dropped entry\n",
+           text_size,
+           (unsigned long)log_dict_test_bench_time(0, LOG_LEVEL_INFO),
+           (unsigned long)log_dict_test_bench_time(0, LOG_LEVEL_DEBUG));
+    printf("dict: %d bytes, %lu ns per entry, %lu ns per dropped entry\n",
+           dict_size,
+           (unsigned long)log_dict_test_bench_time(1, LOG_LEVEL_INFO),
+           (unsigned long)log_dict_test_bench_time(1, LOG_LEVEL_DEBUG));
+
+    TEST_ASSERT(dict_size < text_size);
+}
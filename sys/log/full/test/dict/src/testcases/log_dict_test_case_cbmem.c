@@ -0,0 +1,59 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "log_dict_test.h"
+
+TEST_CASE(log_dict_test_case_cbmem)
+{
+    char text[LOG_PRINTF_MAX_ENTRY_LEN];
+    struct log log;
+    uint8_t handle;
+    int etype;
+    int rc;
+
+    log_dict_test_util_setup(&log, LOG_LEVEL_DEBUG);
+
+    /*** Text entries are unaffected. */
+    log_printf(&log, LOG_DICT_TEST_MODULE, LOG_LEVEL_INFO, "text %d", 1);
+    etype = log_dict_test_util_last(&log, text, sizeof text);
+    TEST_ASSERT(etype == LOG_ETYPE_STRING);
+    TEST_ASSERT(strcmp(text, "text 1") == 0);
+
+    /*** The level macros write dictionary entries. */
+    LOG_INFO(&log, LOG_DICT_TEST_MODULE, "conn_handle=%d status=%s\n",
+             3, "ok");
+    etype = log_dict_test_util_last(&log, text, sizeof text);
+    TEST_ASSERT(etype == LOG_ETYPE_DICT);
+    TEST_ASSERT(strcmp(text, "conn_handle=3 status=ok\n") == 0);
+
+    rc = modlog_register(LOG_DICT_TEST_MODULE, &log, LOG_LEVEL_DEBUG,
+                         &handle);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    MODLOG_DEBUG(LOG_DICT_TEST_MODULE, "addr=%02x:%02x rssi=%d",
+                 0xc0, 0x01, -70);
+    etype = log_dict_test_util_last(&log, text, sizeof text);
+    TEST_ASSERT(etype == LOG_ETYPE_DICT);
+    TEST_ASSERT(strcmp(text, "addr=c0:01 rssi=-70") == 0);
+
+    TEST_ASSERT(log_dict_test_util_count(&log) == 3);
+
+    modlog_clear();
+}
@@ -0,0 +1,80 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "log_dict_test.h"
+
+/*
+ * Encodes the format and arguments as a dictionary entry, expands it again
+ * and compares the result with snprintf().
+ */
+#define LOG_DICT_TEST_FORMAT(fmt_, ...) do {                                \
+    uint8_t body_[LOG_PRINTF_MAX_ENTRY_LEN];                                \
+    char exp_[LOG_PRINTF_MAX_ENTRY_LEN];                                    \
+    char act_[LOG_PRINTF_MAX_ENTRY_LEN];                                    \
+    int len_;                                                               \
+    int rc_;                                                                \
+                                                                            \
+    snprintf(exp_, sizeof exp_, fmt_, ##__VA_ARGS__);                       \
+    len_ = log_dict_encode(body_, sizeof body_, LOG_DICT_FMT(fmt_),         \
+                           ##__VA_ARGS__);                                  \
+    TEST_ASSERT_FATAL(len_ >= LOG_DICT_ID_SIZE);                            \
+                                                                            \
+    rc_ = log_dict_format(act_, sizeof act_, body_, len_);                  \
+    TEST_ASSERT(rc_ == strlen(exp_));                                       \
+    TEST_ASSERT(strcmp(act_, exp_) == 0,                                    \
+                "fmt=\"%s\" got \"%s\" want \"%s\"", fmt_, act_, exp_);     \
+} while (0)
+
+TEST_CASE(log_dict_test_case_format)
+{
+    uint8_t body[LOG_PRINTF_MAX_ENTRY_LEN];
+    int len;
+    int rc;
+
+    LOG_DICT_TEST_FORMAT("no arguments\n");
+    LOG_DICT_TEST_FORMAT("%d %i %u", -5, 7, 4000000000u);
+    LOG_DICT_TEST_FORMAT("%x %X %o %#x %08x", 0xbeef, 0xbeef, 8, 255, 0x12);
+    LOG_DICT_TEST_FORMAT("%+d|% d|%-5d|%5d|%.3d", 3, 3, 3, 3, 3);
+    LOG_DICT_TEST_FORMAT("%hhd %hhu %hd %hu", 300, -1, 70000, -2);
+    LOG_DICT_TEST_FORMAT("%ld %lu %lx", -123456L, 123456UL, 0xabcdefUL);
+    LOG_DICT_TEST_FORMAT("%lld %llu %llx", -1234567890123LL,
+                         18446744073709551615ULL, 0x1122334455667788ULL);
+    LOG_DICT_TEST_FORMAT("%jd %zu %td", (intmax_t)-9, (size_t)10,
+                         (ptrdiff_t)-11);
+    LOG_DICT_TEST_FORMAT("%p", (void *)body);
+    LOG_DICT_TEST_FORMAT("%c%c%c", 'a', 'b', 'c');
+    LOG_DICT_TEST_FORMAT("%s=%s", "key", "value");
+    LOG_DICT_TEST_FORMAT("[%-8s|%8.3s|%s]", "left", "truncated", "");
+    LOG_DICT_TEST_FORMAT("%*d|%-*.*s|", 6, 42, 7, 2, "xyz");
+    LOG_DICT_TEST_FORMAT("100%% %d%%", 50);
+    LOG_DICT_TEST_FORMAT("%.2f %e %g", 3.14159, -0.5, 1e10);
+
+    /*** Only the ID and the raw argument words get stored. */
+    len = log_dict_encode(body, sizeof body, LOG_DICT_FMT("%d %d"), 1, 2);
+    TEST_ASSERT(len == LOG_DICT_ID_SIZE + 2 * sizeof (int));
+
+    len = log_dict_encode(body, sizeof body, LOG_DICT_FMT("%s"), "abc");
+    TEST_ASSERT(len == LOG_DICT_ID_SIZE + 4);
+
+    /*** Strings outside the dictionary are rejected. */
+    rc = log_dict_encode(body, sizeof body, "not in the dictionary");
+    TEST_ASSERT(rc == SYS_ENOENT);
+}
@@ -0,0 +1,70 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "log_dict_test.h"
+
+/* Crashes if a dropped write looks at its arguments. */
+#define LOG_DICT_TEST_BAD_STR   ((const char *)1)
+
+TEST_CASE(log_dict_test_case_level)
+{
+    struct log log;
+    uint8_t handle;
+    int rc;
+
+    log_dict_test_util_setup(&log, LOG_LEVEL_INFO);
+
+    /*** Below the log's level. */
+    log_printf(&log, LOG_DICT_TEST_MODULE, LOG_LEVEL_DEBUG, "%s",
+               LOG_DICT_TEST_BAD_STR);
+    log_printf_dict(&log, LOG_DICT_TEST_MODULE, LOG_LEVEL_DEBUG,
+                    LOG_DICT_FMT("%s"), LOG_DICT_TEST_BAD_STR);
+    LOG_DEBUG(&log, LOG_DICT_TEST_MODULE, "%s", LOG_DICT_TEST_BAD_STR);
+    TEST_ASSERT(log_dict_test_util_count(&log) == 0);
+
+    /*** Below the module's level. */
+    rc = log_level_set(LOG_DICT_TEST_MODULE, LOG_LEVEL_WARN);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    log_printf(&log, LOG_DICT_TEST_MODULE, LOG_LEVEL_INFO, "%s",
+               LOG_DICT_TEST_BAD_STR);
+    LOG_INFO(&log, LOG_DICT_TEST_MODULE, "%s", LOG_DICT_TEST_BAD_STR);
+    TEST_ASSERT(log_dict_test_util_count(&log) == 0);
+
+    LOG_WARN(&log, LOG_DICT_TEST_MODULE, "%s", "kept");
+    TEST_ASSERT(log_dict_test_util_count(&log) == 1);
+
+    rc = log_level_set(LOG_DICT_TEST_MODULE, LOG_LEVEL_DEBUG);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /*** Below the modlog mapping's level. */
+    rc = modlog_register(LOG_DICT_TEST_MODULE, &log, LOG_LEVEL_ERROR,
+                         &handle);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    modlog_printf(LOG_DICT_TEST_MODULE, LOG_LEVEL_WARN, "%s",
+                  LOG_DICT_TEST_BAD_STR);
+    MODLOG_WARN(LOG_DICT_TEST_MODULE, "%s", LOG_DICT_TEST_BAD_STR);
+    TEST_ASSERT(log_dict_test_util_count(&log) == 1);
+
+    MODLOG_ERROR(LOG_DICT_TEST_MODULE, "%s", "kept");
+    TEST_ASSERT(log_dict_test_util_count(&log) == 2);
+
+    modlog_clear();
+}
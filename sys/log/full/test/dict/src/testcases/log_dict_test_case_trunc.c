@@ -0,0 +1,61 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "log_dict_test.h"
+
+TEST_CASE(log_dict_test_case_trunc)
+{
+    uint8_t body[LOG_DICT_ID_SIZE + sizeof (int) + 3];
+    char text[32];
+    int len;
+    int rc;
+
+    /*** A string that does not fit is cut; later arguments are missing. */
+    len = log_dict_encode(body, sizeof body, LOG_DICT_FMT("%d %s %d"),
+                          1, "abcdef", 2);
+    TEST_ASSERT_FATAL(len == sizeof body);
+
+    rc = log_dict_format(text, sizeof text, body, len);
+    TEST_ASSERT(rc == 6);
+    TEST_ASSERT(strcmp(text, "1 ab ?") == 0);
+
+    /*** An integer that does not fit is left out entirely. */
+    len = log_dict_encode(body, sizeof body, LOG_DICT_FMT("%d %d %d"),
+                          1, 2, 3);
+    TEST_ASSERT_FATAL(len == LOG_DICT_ID_SIZE + sizeof (int));
+
+    rc = log_dict_format(text, sizeof text, body, len);
+    TEST_ASSERT(strcmp(text, "1 ? ?") == 0);
+
+    /*** Output that does not fit in the text buffer is cut. */
+    len = log_dict_encode(body, sizeof body, LOG_DICT_FMT("%d abcdefgh"),
+                          12345);
+    rc = log_dict_format(text, 8, body, len);
+    TEST_ASSERT(rc == 7);
+    TEST_ASSERT(strcmp(text, "12345 a") == 0);
+
+    /*** Bodies without a valid ID are rejected. */
+    rc = log_dict_format(text, sizeof text, body, LOG_DICT_ID_SIZE - 1);
+    TEST_ASSERT(rc == SYS_EINVAL);
+
+    memset(body, 0xff, LOG_DICT_ID_SIZE);
+    rc = log_dict_format(text, sizeof text, body, LOG_DICT_ID_SIZE);
+    TEST_ASSERT(rc == SYS_ENOENT);
+}
@@ -0,0 +1,54 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_LOG_QUERY_TEST_
+#define H_LOG_QUERY_TEST_
+
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+#include "fcb/fcb.h"
+#include "log/log.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void log_query_test_util_setup_fcb(struct log *log, struct fcb_log *fcb_log,
+                                   struct flash_area *areas, int area_cnt,
+                                   struct log_fcb_sum *sums);
+
+void log_query_test_util_setup_cbmem(struct log *log);
+
+void log_query_test_util_set_time(int64_t secs);
+
+int log_query_test_util_count(struct log *log, struct log_query *query);
+
+int log_query_test_util_count_all(struct log *log,
+                                  const struct log_query *query);
+
+TEST_SUITE_DECL(log_query_test_suite);
+TEST_CASE_DECL(log_query_test_case_filter);
+TEST_CASE_DECL(log_query_test_case_fcb);
+TEST_CASE_DECL(log_query_test_case_bench);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
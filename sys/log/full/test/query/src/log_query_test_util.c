@@ -0,0 +1,145 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "log_query_test.h"
+
+static uint8_t log_query_test_cbmem_buf[8192];
+static struct cbmem log_query_test_cbmem;
+
+void
+log_query_test_util_setup_fcb(struct log *log, struct fcb_log *fcb_log,
+                              struct flash_area *areas, int area_cnt,
+                              struct log_fcb_sum *sums)
+{
+    int rc;
+    int i;
+
+    sysinit();
+
+    *fcb_log = (struct fcb_log) { 0 };
+    fcb_log->fl_fcb.f_sectors = areas;
+    fcb_log->fl_fcb.f_sector_cnt = area_cnt;
+    fcb_log->fl_fcb.f_magic = 0x7EADBADF;
+    fcb_log->fl_fcb.f_version = g_log_info.li_version;
+    fcb_log->fl_sums = sums;
+
+    for (i = 0; i < area_cnt; i++) {
+        rc = flash_area_erase(&areas[i], 0, areas[i].fa_size);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+    rc = fcb_init(&fcb_log->fl_fcb);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = log_register("query", log, &log_fcb_handler, fcb_log, LOG_SYSLEVEL);
+    TEST_ASSERT_FATAL(rc == 0);
+}
+
+void
+log_query_test_util_setup_cbmem(struct log *log)
+{
+    int rc;
+
+    sysinit();
+
+    cbmem_init(&log_query_test_cbmem, log_query_test_cbmem_buf,
+               sizeof log_query_test_cbmem_buf);
+
+    rc = log_register("query", log, &log_cbmem_handler,
+                      &log_query_test_cbmem, LOG_SYSLEVEL);
+    TEST_ASSERT_FATAL(rc == 0);
+}
+
+void
+log_query_test_util_set_time(int64_t secs)
+{
+    struct os_timeval tv;
+    int rc;
+
+    tv.tv_sec = secs;
+    tv.tv_usec = 0;
+    rc = os_settimeofday(&tv, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+}
+
+static int
+log_query_test_util_count_entry(struct log *log, struct log_offset *log_offset,
+                                const struct log_entry_hdr *hdr, void *dptr,
+                                uint16_t len)
+{
+    (*(int *)log_offset->lo_arg)++;
+    return 0;
+}
+
+/**
+ * @return                      The number of entries returned by log_query().
+ */
+int
+log_query_test_util_count(struct log *log, struct log_query *query)
+{
+    struct log_offset log_offset = { 0 };
+    int count;
+    int rc;
+
+    count = 0;
+    log_offset.lo_arg = &count;
+    rc = log_query(log, query, log_query_test_util_count_entry, &log_offset);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    return count;
+}
+
+struct log_query_test_util_all_arg {
+    const struct log_query *query;
+    int count;
+};
+
+static int
+log_query_test_util_all_entry(struct log *log, struct log_offset *log_offset,
+                              const struct log_entry_hdr *hdr, void *dptr,
+                              uint16_t len)
+{
+    struct log_query_test_util_all_arg *arg;
+
+    arg = log_offset->lo_arg;
+    if (log_query_match(arg->query, hdr)) {
+        arg->count++;
+    }
+    return 0;
+}
+
+/**
+ * @return                      The number of matching entries found by
+ *                                  reading every entry in the log.
+ */
+int
+log_query_test_util_count_all(struct log *log, const struct log_query *query)
+{
+    struct log_query_test_util_all_arg arg;
+    struct log_offset log_offset = { 0 };
+    int rc;
+
+    arg.query = query;
+    arg.count = 0;
+    log_offset.lo_arg = &arg;
+    rc = log_walk_body(log, log_query_test_util_all_entry, &log_offset);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    return arg.count;
+}
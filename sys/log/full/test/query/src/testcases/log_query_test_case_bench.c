@@ -0,0 +1,146 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "log_query_test.h"
+
+/* 512 kB of 4 kB sectors. */
+#define LOG_QUERY_TEST_BENCH_SECTORS    128
+#define LOG_QUERY_TEST_BENCH_OFF        0x00080000
+#define LOG_QUERY_TEST_BENCH_ROUNDS     8
+
+/* Seconds between entries. */
+#define LOG_QUERY_TEST_BENCH_STEP       5
+#define LOG_QUERY_TEST_BENCH_T0         1500000000
+
+#define LOG_QUERY_TEST_BENCH_MODULES    16
+#define LOG_QUERY_TEST_BENCH_MODULE     5
+
+static struct flash_area
+    log_query_test_bench_areas[LOG_QUERY_TEST_BENCH_SECTORS];
+static struct log_fcb_sum
+    log_query_test_bench_sums[LOG_QUERY_TEST_BENCH_SECTORS];
+
+/*
+ * Writes entries from a mix of modules, one in eight of them errors, until
+ * the log wraps.
+ *
+ * @return                      The time of the last entry, in seconds.
+ */
+static int64_t
+log_query_test_bench_fill(struct log *log, struct fcb_log *fcb_log)
+{
+    uint32_t seed;
+    int64_t now;
+    char body[32];
+    uint8_t level;
+    int rc;
+    int i;
+
+    seed = 1;
+    now = LOG_QUERY_TEST_BENCH_T0;
+    i = 0;
+    while (fcb_log->fl_fcb.f_oldest == &log_query_test_bench_areas[0]) {
+        seed = seed * 1103515245 + 12345;
+        level = (seed >> 16) % 8 == 0 ? LOG_LEVEL_ERROR : LOG_LEVEL_INFO;
+
+        now += LOG_QUERY_TEST_BENCH_STEP;
+        log_query_test_util_set_time(now);
+        snprintf(body, sizeof body, "event %d status %lu", i,
+                 (unsigned long)(seed >> 24));
+        rc = log_append_body(log, (seed >> 8) % LOG_QUERY_TEST_BENCH_MODULES,
+                             level, LOG_ETYPE_STRING, body, strlen(body));
+        TEST_ASSERT_FATAL(rc == 0);
+        i++;
+    }
+
+    return now;
+}
+
+/*
+ * @return                      Time per query, in microseconds.
+ */
+static uint32_t
+log_query_test_bench_time(struct log *log, struct log_query *query, int *cnt)
+{
+    uint32_t start;
+    int i;
+
+    start = os_cputime_get32();
+    for (i = 0; i < LOG_QUERY_TEST_BENCH_ROUNDS; i++) {
+        *cnt = log_query_test_util_count(log, query);
+    }
+
+    return os_cputime_ticks_to_usecs(os_cputime_get32() - start) /
+           LOG_QUERY_TEST_BENCH_ROUNDS;
+}
+
+/*
+ * Reports the time taken to find the last hour's errors from one module in a
+ * full 512 kB log, with and without sector summaries.
+ */
+TEST_CASE(log_query_test_case_bench)
+{
+    struct log_query query;
+    struct fcb_log fcb_log;
+    struct log log;
+    uint32_t full_usecs;
+    uint32_t usecs;
+    uint32_t skipped;
+    int64_t now;
+    uint8_t module;
+    int full_cnt;
+    int cnt;
+    int i;
+
+    for (i = 0; i < LOG_QUERY_TEST_BENCH_SECTORS; i++) {
+        log_query_test_bench_areas[i].fa_off =
+            LOG_QUERY_TEST_BENCH_OFF + i * 4096;
+        log_query_test_bench_areas[i].fa_size = 4096;
+    }
+
+    log_query_test_util_setup_fcb(&log, &fcb_log, log_query_test_bench_areas,
+                                  LOG_QUERY_TEST_BENCH_SECTORS,
+                                  log_query_test_bench_sums);
+    now = log_query_test_bench_fill(&log, &fcb_log);
+
+    log_query_init(&query);
+    module = LOG_QUERY_TEST_BENCH_MODULE;
+    log_query_set_modules(&query, &module, 1);
+    query.lq_min_level = LOG_LEVEL_ERROR;
+    query.lq_ts_min = (now - 3600) * 1000000;
+
+    usecs = log_query_test_bench_time(&log, &query, &cnt);
+    skipped = query.lq_skipped;
+
+    fcb_log.fl_sums = NULL;
+    full_usecs = log_query_test_bench_time(&log, &query, &full_cnt);
+    fcb_log.fl_sums = log_query_test_bench_sums;
+
+    printf("query: %d matches, %lu us; %lu of %d sectors skipped\n",
+           cnt, (unsigned long)usecs, (unsigned long)skipped,
+           LOG_QUERY_TEST_BENCH_SECTORS);
+    printf("full walk: %d matches, %lu us\n", full_cnt,
+           (unsigned long)full_usecs);
+
+    TEST_ASSERT(cnt > 0);
+    TEST_ASSERT(cnt == full_cnt);
+    TEST_ASSERT(skipped > 0);
+}
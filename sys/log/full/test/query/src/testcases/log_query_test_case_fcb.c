@@ -0,0 +1,140 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "log_query_test.h"
+
+#define LOG_QUERY_TEST_FCB_CNT          2000
+#define LOG_QUERY_TEST_FCB_T0           1500000000
+
+static struct flash_area log_query_test_fcb_areas[] = {
+    { .fa_off = 0x00080000, .fa_size = 4 * 1024 },
+    { .fa_off = 0x00081000, .fa_size = 4 * 1024 },
+    { .fa_off = 0x00082000, .fa_size = 4 * 1024 },
+    { .fa_off = 0x00083000, .fa_size = 4 * 1024 },
+    { .fa_off = 0x00084000, .fa_size = 4 * 1024 },
+    { .fa_off = 0x00085000, .fa_size = 4 * 1024 },
+    { .fa_off = 0x00086000, .fa_size = 4 * 1024 },
+    { .fa_off = 0x00087000, .fa_size = 4 * 1024 },
+};
+
+static struct log_fcb_sum
+    log_query_test_fcb_sums[sizeof log_query_test_fcb_areas /
+                            sizeof log_query_test_fcb_areas[0]];
+
+/*
+ * Verifies that a query returns the same entries as a walk of the whole log,
+ * and the expected number of them if cnt >= 0.
+ *
+ * @return                      The number of sectors skipped.
+ */
+static int
+log_query_test_fcb_check(struct log *log, struct log_query *query, int cnt)
+{
+    int all;
+    int n;
+
+    n = log_query_test_util_count(log, query);
+    all = log_query_test_util_count_all(log, query);
+    TEST_ASSERT(n == all);
+    if (cnt >= 0) {
+        TEST_ASSERT(n == cnt);
+    }
+
+    return query->lq_skipped;
+}
+
+static void
+log_query_test_fcb_queries(struct log *log, uint32_t start_index)
+{
+    struct log_query query;
+    uint8_t module;
+
+    log_query_init(&query);
+    log_query_test_fcb_check(log, &query, -1);
+
+    /* The last 100 seconds are in the newest sector or two. */
+    log_query_init(&query);
+    query.lq_ts_min = (LOG_QUERY_TEST_FCB_T0 + LOG_QUERY_TEST_FCB_CNT - 100) *
+                      1000000LL;
+    TEST_ASSERT(log_query_test_fcb_check(log, &query, 100) > 0);
+
+    /* As are the last 50 indices. */
+    log_query_init(&query);
+    query.lq_index = start_index + LOG_QUERY_TEST_FCB_CNT - 50;
+    TEST_ASSERT(log_query_test_fcb_check(log, &query, 50) > 0);
+
+    /* Every sector holds this module and level. */
+    log_query_init(&query);
+    module = 11;
+    log_query_set_modules(&query, &module, 1);
+    query.lq_min_level = LOG_LEVEL_ERROR;
+    TEST_ASSERT(log_query_test_fcb_check(log, &query, -1) == 0);
+
+    /* No sector holds this module. */
+    log_query_init(&query);
+    module = 20;
+    log_query_set_modules(&query, &module, 1);
+    TEST_ASSERT(log_query_test_fcb_check(log, &query, 0) > 0);
+}
+
+/*
+ * Queries a log that has wrapped, before and after its summaries are rebuilt
+ * at registration.
+ */
+TEST_CASE(log_query_test_case_fcb)
+{
+    struct log_query query;
+    struct fcb_log fcb_log;
+    struct log log;
+    uint32_t start_index;
+    char body[16];
+    int rc;
+    int i;
+
+    log_query_test_util_setup_fcb(&log, &fcb_log, log_query_test_fcb_areas,
+        sizeof log_query_test_fcb_areas / sizeof log_query_test_fcb_areas[0],
+        log_query_test_fcb_sums);
+
+    start_index = g_log_info.li_next_index;
+    for (i = 0; i < LOG_QUERY_TEST_FCB_CNT; i++) {
+        log_query_test_util_set_time(LOG_QUERY_TEST_FCB_T0 + i);
+        snprintf(body, sizeof body, "entry %d", i);
+        rc = log_append_body(&log, 10 + i % 4, i % 5, LOG_ETYPE_STRING,
+                             body, strlen(body));
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+
+    /* The log must have wrapped for the queries to be meaningful. */
+    log_query_init(&query);
+    TEST_ASSERT_FATAL(log_query_test_util_count_all(&log, &query) <
+                      LOG_QUERY_TEST_FCB_CNT);
+
+    log_query_test_fcb_queries(&log, start_index);
+
+    /* Simulate a reboot; the summaries are rebuilt from flash. */
+    sysinit();
+    memset(log_query_test_fcb_sums, 0xa5, sizeof log_query_test_fcb_sums);
+    rc = log_register("query", &log, &log_fcb_handler, &fcb_log,
+                      LOG_SYSLEVEL);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    log_query_test_fcb_queries(&log, start_index);
+}
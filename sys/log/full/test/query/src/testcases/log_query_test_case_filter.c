@@ -0,0 +1,97 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "log_query_test.h"
+
+#define LOG_QUERY_TEST_FILTER_CNT       100
+
+/* After 2016, so entries are stamped with the time of day. */
+#define LOG_QUERY_TEST_FILTER_T0        1500000000
+
+/*
+ * Entry i is written at T0 + i seconds by module 10 + i % 4, at level i % 5;
+ * every third entry is binary.
+ */
+static void
+log_query_test_filter_fill(struct log *log)
+{
+    char body[16];
+    int rc;
+    int i;
+
+    for (i = 0; i < LOG_QUERY_TEST_FILTER_CNT; i++) {
+        log_query_test_util_set_time(LOG_QUERY_TEST_FILTER_T0 + i);
+        snprintf(body, sizeof body, "entry %d", i);
+        rc = log_append_body(log, 10 + i % 4, i % 5,
+                             i % 3 == 0 ? LOG_ETYPE_BINARY : LOG_ETYPE_STRING,
+                             body, strlen(body));
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+}
+
+TEST_CASE(log_query_test_case_filter)
+{
+    struct log_query query;
+    struct log log;
+    uint8_t modules[2];
+    uint32_t start_index;
+
+    log_query_test_util_setup_cbmem(&log);
+    start_index = g_log_info.li_next_index;
+    log_query_test_filter_fill(&log);
+
+    /* Everything. */
+    log_query_init(&query);
+    TEST_ASSERT(log_query_test_util_count(&log, &query) ==
+                LOG_QUERY_TEST_FILTER_CNT);
+    TEST_ASSERT(query.lq_skipped == 0);
+
+    /* One module: every fourth entry. */
+    modules[0] = 11;
+    log_query_set_modules(&query, modules, 1);
+    TEST_ASSERT(log_query_test_util_count(&log, &query) == 25);
+
+    /* Two modules; level >= ERROR; i % 4 in {1, 3} and i % 5 in {3, 4}. */
+    modules[1] = 13;
+    log_query_set_modules(&query, modules, 2);
+    query.lq_min_level = LOG_LEVEL_ERROR;
+    TEST_ASSERT(log_query_test_util_count(&log, &query) == 20);
+
+    /* Time range: ten seconds, inclusive. */
+    log_query_init(&query);
+    query.lq_ts_min = (LOG_QUERY_TEST_FILTER_T0 + 40) * 1000000LL;
+    query.lq_ts_max = (LOG_QUERY_TEST_FILTER_T0 + 49) * 1000000LL;
+    TEST_ASSERT(log_query_test_util_count(&log, &query) == 10);
+
+    /* Entry type. */
+    log_query_init(&query);
+    query.lq_etypes = 1 << LOG_ETYPE_BINARY;
+    TEST_ASSERT(log_query_test_util_count(&log, &query) == 34);
+
+    /* Index. */
+    log_query_init(&query);
+    query.lq_index = start_index + 90;
+    TEST_ASSERT(log_query_test_util_count(&log, &query) == 10);
+
+    /* No module. */
+    memset(query.lq_modules, 0, sizeof query.lq_modules);
+    TEST_ASSERT(log_query_test_util_count(&log, &query) == 0);
+}
@@ -24,6 +24,7 @@
 #include "testutil/testutil.h"
 #include "fcb/fcb.h"
 #include "log/log.h"
+#include "log/log_tiered.h"
 #include "log_test_util.h"
 
 #ifdef __cplusplus
@@ -34,10 +35,15 @@ extern struct fcb log_fcb;
 extern struct log my_log;
 extern char *ltu_str_logs[];
 
+int ltu_num_strs(void);
 struct os_mbuf *ltu_flat_to_fragged_mbuf(const void *flat, int len,
                                          int frag_sz);
 void ltu_setup_fcb(struct fcb_log *fcb_log, struct log *log);
 void ltu_setup_cbmem(struct cbmem *cbmem, struct log *log);
+#if MYNEWT_VAL(LOG_TIERED)
+void ltu_setup_tiered(struct fcb_log *fcb_log, struct log_tiered *lt,
+                      struct log *log);
+#endif
 void ltu_verify_contents(struct log *log);
 
 TEST_SUITE_DECL(log_test_suite_cbmem_flat);
@@ -58,6 +64,11 @@ TEST_SUITE_DECL(log_test_suite_fcb_mbuf);
 TEST_CASE_DECL(log_test_case_fcb_append_mbuf);
 TEST_CASE_DECL(log_test_case_fcb_append_mbuf_body);
 
+TEST_SUITE_DECL(log_test_suite_tiered);
+TEST_CASE_DECL(log_test_case_tiered_append);
+TEST_CASE_DECL(log_test_case_tiered_reboot);
+TEST_CASE_DECL(log_test_case_tiered_overwrite);
+
 TEST_SUITE_DECL(log_test_suite_misc);
 TEST_CASE_DECL(log_test_case_level);
 TEST_CASE_DECL(log_test_case_append_cb);
@@ -46,6 +46,13 @@ TEST_SUITE(log_test_suite_fcb_mbuf)
     log_test_case_fcb_append_mbuf_body();
 }
 
+TEST_SUITE(log_test_suite_tiered)
+{
+    log_test_case_tiered_append();
+    log_test_case_tiered_reboot();
+    log_test_case_tiered_overwrite();
+}
+
 TEST_SUITE(log_test_suite_misc)
 {
     log_test_case_level();
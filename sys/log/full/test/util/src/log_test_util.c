@@ -42,6 +42,9 @@ char *ltu_str_logs[] = {
 };
 
 static uint8_t ltu_cbmem_buf[2048];
+#if MYNEWT_VAL(LOG_TIERED)
+static uint8_t ltu_tiered_buf[1024];
+#endif
 
 int
 ltu_num_strs(void)
@@ -91,14 +94,12 @@ ltu_flat_to_fragged_mbuf(const void *flat, int len, int frag_sz)
     return first;
 }
 
-void
-ltu_setup_fcb(struct fcb_log *fcb_log, struct log *log)
+static void
+ltu_init_fcb(struct fcb_log *fcb_log)
 {
     int rc;
     int i;
 
-    sysinit();
-
     *fcb_log = (struct fcb_log) { 0 };
 
     fcb_log->fl_fcb.f_sectors = fcb_areas;
@@ -112,7 +113,14 @@ ltu_setup_fcb(struct fcb_log *fcb_log, struct log *log)
     }
     rc = fcb_init(&fcb_log->fl_fcb);
     TEST_ASSERT(rc == 0);
+}
+
+void
+ltu_setup_fcb(struct fcb_log *fcb_log, struct log *log)
+{
+    sysinit();
 
+    ltu_init_fcb(fcb_log);
     log_register("log", log, &log_fcb_handler, fcb_log, LOG_SYSLEVEL);
 }
 
@@ -125,6 +133,24 @@ ltu_setup_cbmem(struct cbmem *cbmem, struct log *log)
     log_register("log", log, &log_cbmem_handler, cbmem, LOG_SYSLEVEL);
 }
 
+#if MYNEWT_VAL(LOG_TIERED)
+void
+ltu_setup_tiered(struct fcb_log *fcb_log, struct log_tiered *lt,
+                 struct log *log)
+{
+    int rc;
+
+    sysinit();
+
+    ltu_init_fcb(fcb_log);
+
+    rc = log_tiered_init(lt, fcb_log, ltu_tiered_buf, sizeof ltu_tiered_buf);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    log_register("log", log, &log_tiered_handler, lt, LOG_SYSLEVEL);
+}
+#endif
+
 static int
 ltu_walk_verify(struct log *log, struct log_offset *log_offset,
                 void *dptr, uint16_t len)
@@ -0,0 +1,80 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "log_test_util/log_test_util.h"
+
+#if MYNEWT_VAL(LOG_TIERED)
+
+TEST_CASE(log_test_case_tiered_append)
+{
+    struct log_tiered lt;
+    struct fcb_log fcb_log;
+    struct log log;
+    char *str;
+    int rc;
+    int i;
+
+    ltu_setup_tiered(&fcb_log, &lt, &log);
+
+    /* Spill the first entries; the rest stay in RAM.  Reads must see both
+     * tiers as one log.
+     */
+    for (i = 0; ; i++) {
+        str = ltu_str_logs[i];
+        if (!str) {
+            break;
+        }
+        if (i == 2) {
+            rc = log_tiered_spill(&log);
+            TEST_ASSERT_FATAL(rc == 0);
+        }
+        log_append_body(&log, 0, 0, LOG_ETYPE_STRING, str, strlen(str));
+    }
+
+    ltu_verify_contents(&log);
+
+    /* Spilling every tiered log moves the RAM entries to flash without
+     * losing or duplicating any.
+     */
+    for (i = 0; ; i++) {
+        str = ltu_str_logs[i];
+        if (!str) {
+            break;
+        }
+        if (i == 2) {
+            rc = log_tiered_spill(&log);
+            TEST_ASSERT_FATAL(rc == 0);
+        }
+        log_append_body(&log, 0, 0, LOG_ETYPE_STRING, str, strlen(str));
+    }
+
+    log_tiered_spill_all();
+    TEST_ASSERT(!lt.lt_spilling);
+    TEST_ASSERT(lt.lt_front_bytes == 0);
+
+    ltu_verify_contents(&log);
+}
+
+#else
+
+TEST_CASE(log_test_case_tiered_append)
+{
+}
+
+#endif
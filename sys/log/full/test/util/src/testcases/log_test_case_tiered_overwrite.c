@@ -0,0 +1,75 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "log_test_util/log_test_util.h"
+
+#if MYNEWT_VAL(LOG_TIERED)
+
+#define LTCTO_NUM_ENTRIES   40
+
+static int
+ltcto_walk_count(struct log *log, struct log_offset *log_offset,
+                 void *dptr, uint16_t len)
+{
+    (*(int *)log_offset->lo_arg)++;
+    return 0;
+}
+
+TEST_CASE(log_test_case_tiered_overwrite)
+{
+    struct log_offset log_offset;
+    struct log_tiered lt;
+    struct fcb_log fcb_log;
+    struct log log;
+    char *str;
+    int count;
+    int rc;
+    int i;
+
+    ltu_setup_tiered(&fcb_log, &lt, &log);
+
+    /* No spill runs, so the front half wraps and drops its oldest
+     * entries.
+     */
+    str = "0123456789abcdef0123456789abcdef";
+    for (i = 0; i < LTCTO_NUM_ENTRIES; i++) {
+        rc = log_append_body(&log, 0, 0, LOG_ETYPE_STRING, str, strlen(str));
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+
+    count = 0;
+    memset(&log_offset, 0, sizeof log_offset);
+    log_offset.lo_arg = &count;
+    rc = log_walk(&log, ltcto_walk_count, &log_offset);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(count > 0 && count < LTCTO_NUM_ENTRIES);
+
+    /* Every entry is either still in the log or counted as lost. */
+#if MYNEWT_VAL(LOG_STATS)
+    TEST_ASSERT(count + STATS_GET(log.l_stats, lost) == LTCTO_NUM_ENTRIES);
+#endif
+}
+
+#else
+
+TEST_CASE(log_test_case_tiered_overwrite)
+{
+}
+
+#endif
@@ -0,0 +1,107 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "log_test_util/log_test_util.h"
+
+#if MYNEWT_VAL(LOG_TIERED)
+
+static int
+ltu_num_elems(struct fcb *fcb)
+{
+    struct fcb_entry loc;
+    int num_elems;
+
+    num_elems = 0;
+    memset(&loc, 0, sizeof loc);
+    while (fcb_getnext(fcb, &loc) == 0) {
+        num_elems++;
+    }
+
+    return num_elems;
+}
+
+TEST_CASE(log_test_case_tiered_reboot)
+{
+    struct log_tiered lt;
+    struct fcb_log fcb_log;
+    struct log log;
+    uint32_t buf_len;
+    uint8_t *buf;
+    char *str;
+    int rc;
+    int i;
+
+    ltu_setup_tiered(&fcb_log, &lt, &log);
+
+    for (i = 0; ; i++) {
+        str = ltu_str_logs[i];
+        if (!str) {
+            break;
+        }
+        if (i == 2) {
+            rc = log_tiered_spill(&log);
+            TEST_ASSERT_FATAL(rc == 0);
+        }
+        log_append_body(&log, 0, 0, LOG_ETYPE_STRING, str, strlen(str));
+    }
+
+    TEST_ASSERT(ltu_num_elems(&fcb_log.fl_fcb) == 1);
+
+    /* A log whose front half was being appended to by the interrupted code
+     * is left alone.
+     */
+    lt.lt_mutex.mu_level = 1;
+    log_tiered_crash_flush();
+    lt.lt_mutex.mu_level = 0;
+    TEST_ASSERT(ltu_num_elems(&fcb_log.fl_fcb) == 1);
+
+    /* Remaining entries are written by the crash hook.  Each spill is a
+     * single FCB element.
+     */
+    log_tiered_crash_flush();
+    TEST_ASSERT(ltu_num_elems(&fcb_log.fl_fcb) == 2);
+
+    /*** Simulate a reboot: RAM contents are lost, FCB is rescanned. */
+
+    buf = lt.lt_cbmem[0].c_buf;
+    buf_len = 2 * (lt.lt_cbmem[0].c_buf_end - buf);
+
+    sysinit();
+
+    rc = fcb_init(&fcb_log.fl_fcb);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = log_tiered_init(&lt, &fcb_log, buf, buf_len);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    log_register("log", &log, &log_tiered_handler, &lt, LOG_SYSLEVEL);
+
+    /* New entries continue the index sequence of the persisted ones. */
+    TEST_ASSERT(g_log_info.li_next_index == ltu_num_strs());
+
+    ltu_verify_contents(&log);
+}
+
+#else
+
+TEST_CASE(log_test_case_tiered_reboot)
+{
+}
+
+#endif
@@ -0,0 +1,267 @@
+#!/usr/bin/env python3
+#
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#  http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+#
+
+"""
+Expands dictionary log entries (LOG_ETYPE_DICT) into text.
+
+The format strings are read from the `log_dict` section of the image's ELF
+file; use the ELF that matches the image running on the device.  Entry bodies
+are given as hex strings, either on the command line or on standard input.
+When reading standard input, the last whitespace-separated token of each line
+that is a hex string is replaced by the expanded text, so a log dump can be
+piped through unchanged.
+
+    log_dict_decode.py app.elf 00000000030000000200...
+    newtmgr log show ... | log_dict_decode.py app.elf
+    log_dict_decode.py --list app.elf
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+LOG_DICT_SECTION = 'log_dict'
+LOG_DICT_ID_SIZE = 4
+
+SPEC_RE = re.compile(r'%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d*))?'
+                     r'(hh|h|ll|l|q|j|z|t|L)?(.)?', re.S)
+
+
+class Dictionary:
+    def __init__(self, path):
+        with open(path, 'rb') as f:
+            elf = f.read()
+
+        if elf[:4] != b'\x7fELF':
+            raise ValueError('%s: not an ELF file' % path)
+        if elf[5] != 1:
+            raise ValueError('%s: big endian images are not supported' % path)
+
+        if elf[4] == 2:
+            shoff, = struct.unpack_from('<Q', elf, 0x28)
+            shentsize, shnum, shstrndx = struct.unpack_from('<HHH', elf, 0x3a)
+            shdr = '<IIQQQQIIQQ'
+            self.long_size = 8
+        else:
+            shoff, = struct.unpack_from('<I', elf, 0x20)
+            shentsize, shnum, shstrndx = struct.unpack_from('<HHH', elf, 0x2e)
+            shdr = '<IIIIIIIIII'
+            self.long_size = 4
+
+        sections = [struct.unpack_from(shdr, elf, shoff + i * shentsize)
+                    for i in range(shnum)]
+        strtab = sections[shstrndx]
+
+        self.data = None
+        for sec in sections:
+            name = elf[strtab[4] + sec[0]:].split(b'\0', 1)[0].decode()
+            if name == LOG_DICT_SECTION:
+                self.data = elf[sec[4]:sec[4] + sec[5]]
+                break
+
+        if self.data is None:
+            raise ValueError('%s: no %s section' % (path, LOG_DICT_SECTION))
+
+    def lookup(self, fmt_id):
+        if fmt_id >= len(self.data):
+            return None
+        return self.data[fmt_id:].split(b'\0', 1)[0].decode(errors='replace')
+
+    def entries(self):
+        off = 0
+        while off < len(self.data):
+            s = self.data[off:].split(b'\0', 1)[0]
+            if s:
+                yield off, s.decode(errors='replace')
+            off += len(s) + 1
+
+    def arg_size(self, conv, length):
+        if conv in 'diouxX':
+            return {
+                'l': self.long_size,
+                'll': 8, 'q': 8, 'L': 8, 'j': 8,
+                'z': self.long_size,
+                't': self.long_size,
+            }.get(length, 4)
+        if conv == 'c':
+            return 4
+        if conv == 'p':
+            return self.long_size
+        if conv in 'fFeEgGaA':
+            return 8
+        return 0
+
+
+class Body:
+    def __init__(self, data):
+        self.data = data
+        self.off = LOG_DICT_ID_SIZE
+
+    def take(self, size):
+        if self.off + size > len(self.data):
+            raise IndexError
+        val = int.from_bytes(self.data[self.off:self.off + size], 'little')
+        self.off += size
+        return val
+
+    def take_str(self):
+        end = self.data.find(b'\0', self.off)
+        if end < 0:
+            raise IndexError
+        s = self.data[self.off:end].decode(errors='replace')
+        self.off = end + 1
+        return s
+
+
+def signed(val, size):
+    bits = 8 * size
+    if val & (1 << (bits - 1)):
+        val -= 1 << bits
+    return val
+
+
+def format_one(dictionary, body, m):
+    flags, width, prec, length, conv = m.groups()
+    length = length or ''
+
+    if conv == '%':
+        return '%'
+    if conv is None or conv == 'n':
+        return ''
+    if conv not in 'diouxXcpsfFeEgGaA':
+        return m.group(0)
+
+    if width == '*':
+        width = str(signed(body.take(4), 4))
+    if prec == '*':
+        prec = str(signed(body.take(4), 4))
+
+    spec = '%' + flags + (width or '')
+    if prec is not None:
+        spec += '.' + (prec or '0')
+
+    if conv == 's':
+        return (spec + 's') % body.take_str()
+
+    size = dictionary.arg_size(conv, length)
+    val = body.take(size)
+
+    if conv in 'fFeEgGaA':
+        dbl, = struct.unpack('<d', val.to_bytes(8, 'little'))
+        if conv in 'aA':
+            s = dbl.hex()
+            return s.upper() if conv == 'A' else s
+        return (spec + conv) % dbl
+    if conv == 'c':
+        return (spec + 'c') % (val & 0xff)
+    if conv == 'p':
+        return (spec + 's') % ('0x%x' % val)
+
+    if length == 'hh':
+        size = 1
+    elif length == 'h':
+        size = 2
+    val &= (1 << (8 * size)) - 1
+    if conv in 'di':
+        val = signed(val, size)
+    return (spec + conv.replace('u', 'd').replace('i', 'd')) % val
+
+
+def decode(dictionary, data):
+    if len(data) < LOG_DICT_ID_SIZE:
+        raise ValueError('entry too short')
+
+    fmt_id = int.from_bytes(data[:LOG_DICT_ID_SIZE], 'little')
+    fmt = dictionary.lookup(fmt_id)
+    if fmt is None:
+        raise ValueError('unknown format ID %d' % fmt_id)
+
+    body = Body(data)
+    out = []
+    pos = 0
+    for m in re.finditer(r'%', fmt):
+        if m.start() < pos:
+            continue
+        spec = SPEC_RE.match(fmt, m.start())
+        out.append(fmt[pos:spec.start()])
+        try:
+            out.append(format_one(dictionary, body, spec))
+        except IndexError:
+            out.append('?')
+        pos = spec.end()
+    out.append(fmt[pos:])
+
+    return ''.join(out)
+
+
+def is_hex(tok):
+    return (len(tok) >= 2 * LOG_DICT_ID_SIZE and len(tok) % 2 == 0 and
+            re.fullmatch(r'[0-9a-fA-F]+', tok) is not None)
+
+
+def decode_line(dictionary, line):
+    toks = line.split()
+    for tok in reversed(toks):
+        if is_hex(tok):
+            try:
+                text = decode(dictionary, bytes.fromhex(tok))
+            except ValueError:
+                break
+            idx = line.rindex(tok)
+            return line[:idx] + text.rstrip('\n') + line[idx + len(tok):]
+    return line
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Expand dictionary log entries into text.')
+    parser.add_argument('elf', help='ELF file of the running image')
+    parser.add_argument('bodies', nargs='*',
+                        help='hex-encoded entry bodies; read from standard '
+                             'input if none are given')
+    parser.add_argument('--list', action='store_true',
+                        help='print the dictionary and exit')
+    args = parser.parse_args()
+
+    try:
+        dictionary = Dictionary(args.elf)
+    except (OSError, ValueError) as e:
+        sys.exit(str(e))
+
+    if args.list:
+        for fmt_id, fmt in dictionary.entries():
+            print('%6d: %r' % (fmt_id, fmt))
+        return
+
+    if args.bodies:
+        for tok in args.bodies:
+            try:
+                print(decode(dictionary, bytes.fromhex(tok)), end='')
+            except ValueError as e:
+                print('%s: %s' % (tok, e), file=sys.stderr)
+        return
+
+    for line in sys.stdin:
+        sys.stdout.write(decode_line(dictionary, line))
+
+
+if __name__ == '__main__':
+    main()
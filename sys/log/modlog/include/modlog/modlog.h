@@ -188,6 +188,22 @@ int modlog_foreach(modlog_foreach_fn *fn, void *arg);
  */
 void modlog_printf(uint8_t module, uint8_t level, const char *msg, ...);
 
+#if MYNEWT_VAL(LOG_DICT) || defined(__DOXYGEN__)
+/**
+ * @brief Writes a dictionary entry (LOG_ETYPE_DICT) to the specified log
+ * module.
+ *
+ * Only the format string ID and the raw arguments are stored.  Usually
+ * called through the MODLOG_[...] macros, which place the format string in
+ * the dictionary.
+ *
+ * @param module                The log module to write to.
+ * @param level                 The severity of the log entry to write.
+ * @param fmt                   A format string produced by LOG_DICT_FMT().
+ */
+void modlog_printf_dict(uint8_t module, uint8_t level, const char *fmt, ...);
+#endif
+
 #else /* LOG_FULL */
 
 static inline int
@@ -240,6 +256,19 @@ modlog_printf(uint8_t module, uint8_t level, const char *msg, ...)
 
 #endif
 
+/*
+ * With LOG_DICT, the level macros store the format string ID and the raw
+ * arguments instead of the formatted text.
+ */
+#if MYNEWT_VAL(LOG_DICT)
+#define MODLOG_PRINTF(ml_mod_, ml_lvl_, ml_msg_, ...) \
+    modlog_printf_dict((ml_mod_), (ml_lvl_), LOG_DICT_FMT(ml_msg_), \
+                       ##__VA_ARGS__)
+#else
+#define MODLOG_PRINTF(ml_mod_, ml_lvl_, ml_msg_, ...) \
+    modlog_printf((ml_mod_), (ml_lvl_), (ml_msg_), ##__VA_ARGS__)
+#endif
+
 #if MYNEWT_VAL(LOG_LEVEL) <= LOG_LEVEL_DEBUG || defined __DOXYGEN__
 /**
  * @brief Writes a formatted debug text entry to the specified log module.
@@ -251,7 +280,7 @@ modlog_printf(uint8_t module, uint8_t level, const char *msg, ...)
  * @param ml_msg_               The "printf" formatted string to write.
  */
 #define MODLOG_DEBUG(ml_mod_, ml_msg_, ...) \
-    modlog_printf((ml_mod_), LOG_LEVEL_DEBUG, (ml_msg_), ##__VA_ARGS__)
+    MODLOG_PRINTF((ml_mod_), LOG_LEVEL_DEBUG, ml_msg_, ##__VA_ARGS__)
 #else
 #define MODLOG_DEBUG(ml_mod_, ...) IGNORE(__VA_ARGS__)
 #endif
@@ -267,7 +296,7 @@ modlog_printf(uint8_t module, uint8_t level, const char *msg, ...)
  * @param ml_msg_               The "printf" formatted string to write.
  */
 #define MODLOG_INFO(ml_mod_, ml_msg_, ...) \
-    modlog_printf((ml_mod_), LOG_LEVEL_INFO, (ml_msg_), ##__VA_ARGS__)
+    MODLOG_PRINTF((ml_mod_), LOG_LEVEL_INFO, ml_msg_, ##__VA_ARGS__)
 #else
 #define MODLOG_INFO(ml_mod_, ...) IGNORE(__VA_ARGS__)
 #endif
@@ -283,7 +312,7 @@ modlog_printf(uint8_t module, uint8_t level, const char *msg, ...)
  * @param ml_msg_               The "printf" formatted string to write.
  */
 #define MODLOG_WARN(ml_mod_, ml_msg_, ...) \
-    modlog_printf((ml_mod_), LOG_LEVEL_WARN, (ml_msg_), ##__VA_ARGS__)
+    MODLOG_PRINTF((ml_mod_), LOG_LEVEL_WARN, ml_msg_, ##__VA_ARGS__)
 #else
 #define MODLOG_WARN(ml_mod_, ...) IGNORE(__VA_ARGS__)
 #endif
@@ -299,7 +328,7 @@ modlog_printf(uint8_t module, uint8_t level, const char *msg, ...)
  * @param ml_msg_               The "printf" formatted string to write.
  */
 #define MODLOG_ERROR(ml_mod_, ml_msg_, ...) \
-    modlog_printf((ml_mod_), LOG_LEVEL_ERROR, (ml_msg_), ##__VA_ARGS__)
+    MODLOG_PRINTF((ml_mod_), LOG_LEVEL_ERROR, ml_msg_, ##__VA_ARGS__)
 #else
 #define MODLOG_ERROR(ml_mod_, ...) IGNORE(__VA_ARGS__)
 #endif
@@ -315,7 +344,7 @@ modlog_printf(uint8_t module, uint8_t level, const char *msg, ...)
  * @param ml_msg_               The "printf" formatted string to write.
  */
 #define MODLOG_CRITICAL(ml_mod_, ml_msg_, ...) \
-    modlog_printf((ml_mod_), LOG_LEVEL_CRITICAL, (ml_msg_), ##__VA_ARGS__)
+    MODLOG_PRINTF((ml_mod_), LOG_LEVEL_CRITICAL, ml_msg_, ##__VA_ARGS__)
 #else
 #define MODLOG_CRITICAL(ml_mod_, ...) IGNORE(__VA_ARGS__)
 #endif
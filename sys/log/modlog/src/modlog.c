@@ -17,17 +17,25 @@
  * under the License.
  */
 
+#include <assert.h>
 #include <stdarg.h>
+#include <string.h>
 #include "os/mynewt.h"
-#include "rwlock/rwlock.h"
 #include "log/log.h"
 #include "modlog/modlog.h"
 
 /* Only enable modlog if logging is also enabled. */
 #if MYNEWT_VAL(LOG_FULL)
 
+/* Route level of a module that no mapping accepts. */
+#define MODLOG_LEVEL_NONE   UINT8_MAX
+
 struct modlog_mapping {
     SLIST_ENTRY(modlog_mapping) next;
+
+    /* Links the mapping into the retired list once deleted. */
+    SLIST_ENTRY(modlog_mapping) retired_next;
+
     struct modlog_desc desc;
 };
 
@@ -37,7 +45,11 @@ static os_membuf_t modlog_mapping_buf[
                     sizeof (struct modlog_mapping))
 ];
 
-static struct rwlock modlog_rwl;
+/**
+ * Serializes writers (register, delete, clear).  Log writes, lookups and
+ * iteration do not take it; see modlog_read_begin().
+ */
+static struct os_mutex modlog_mtx;
 
 SLIST_HEAD(modlog_list, modlog_mapping);
 
@@ -49,7 +61,39 @@ static struct modlog_list modlog_mappings =
  * Points to the first default mapping in the list.  Since 255 is the default
  * module, the default mappings are guaranteed to come last.
  */
-static struct modlog_mapping *modlog_first_dflt;
+static struct modlog_mapping * volatile modlog_first_dflt;
+
+/**
+ * Points to the first mapping of each module, or NULL if the module has no
+ * mappings of its own (its writes go to the default set).  The mappings of a
+ * module are contiguous in the sorted list.
+ */
+static struct modlog_mapping * volatile modlog_routes[MODLOG_MODULE_DFLT];
+
+/**
+ * The lowest level any of a module's mappings accepts (the default set's for
+ * modules without mappings); MODLOG_LEVEL_NONE if there are none.  A write
+ * below this level is dropped without looking at the mappings; with
+ * LOG_STATS, the drop is still counted against each log the module is
+ * routed to, which walks the module's mappings.
+ *
+ * Both tables are indexed by module ID and have no entry for
+ * MODLOG_MODULE_DFLT; callers must reject that ID first.
+ */
+static volatile uint8_t modlog_route_levels[MODLOG_MODULE_DFLT];
+
+/**
+ * Readers (log writes, lookups and iteration) only bracket their use of the
+ * mappings with modlog_read_begin() / modlog_read_end(); they never block.
+ * Writers update the list and the routes inside a critical section, so
+ * readers see either the old or the new list.  A deleted mapping stays in
+ * the retired list, with its `next` pointer intact, until no reader is
+ * active.  Whichever of the writer or the last reader sees the reader count
+ * reach zero returns the retired mappings to the pool.
+ */
+static uint8_t modlog_readers;
+static struct modlog_list modlog_retired =
+    SLIST_HEAD_INITIALIZER(&modlog_retired);
 
 static struct modlog_mapping *
 modlog_alloc(void)
@@ -70,6 +114,70 @@ modlog_free(struct modlog_mapping *mm)
     os_memblock_put(&modlog_mapping_pool, mm);
 }
 
+/**
+ * Returns the retired mappings to the pool if no reader is active.
+ */
+static void
+modlog_reclaim(void)
+{
+    struct modlog_mapping *next;
+    struct modlog_mapping *mm;
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    if (modlog_readers == 0) {
+        mm = SLIST_FIRST(&modlog_retired);
+        SLIST_INIT(&modlog_retired);
+    } else {
+        mm = NULL;
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    while (mm != NULL) {
+        next = SLIST_NEXT(mm, retired_next);
+        modlog_free(mm);
+        mm = next;
+    }
+}
+
+static void
+modlog_read_begin(void)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    modlog_readers++;
+    OS_EXIT_CRITICAL(sr);
+}
+
+static void
+modlog_read_end(void)
+{
+    bool reclaim;
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    modlog_readers--;
+    reclaim = modlog_readers == 0 && !SLIST_EMPTY(&modlog_retired);
+    OS_EXIT_CRITICAL(sr);
+
+    if (reclaim) {
+        modlog_reclaim();
+    }
+}
+
+static void
+modlog_lock(void)
+{
+    os_mutex_pend(&modlog_mtx, OS_TIMEOUT_NEVER);
+}
+
+static void
+modlog_unlock(void)
+{
+    os_mutex_release(&modlog_mtx);
+}
+
 static uint8_t
 modlog_infer_handle(const struct modlog_mapping *mm)
 {
@@ -137,35 +245,154 @@ modlog_find_by_module(uint8_t module, struct modlog_mapping **out_prev)
     return cur;
 }
 
+/**
+ * Finds the mappings a write to the specified module goes to.
+ *
+ * @param module                The module being written to.
+ * @param out_mapped            On success, the module of the returned
+ *                                  mappings gets written here (the module
+ *                                  itself, or MODLOG_MODULE_DFLT).
+ *
+ * @return                      The first mapping; the set continues while
+ *                                  the mapping's module is *out_mapped.
+ */
+static struct modlog_mapping *
+modlog_route(uint8_t module, uint8_t *out_mapped)
+{
+    struct modlog_mapping *mm;
+
+    assert(module != MODLOG_MODULE_DFLT);
+
+    mm = modlog_routes[module];
+    if (mm != NULL) {
+        *out_mapped = module;
+    } else {
+        mm = modlog_first_dflt;
+        *out_mapped = MODLOG_MODULE_DFLT;
+    }
+
+    return mm;
+}
+
+static uint8_t
+modlog_min_level(const struct modlog_mapping *mm)
+{
+    uint8_t module;
+    uint8_t level;
+
+    level = MODLOG_LEVEL_NONE;
+    if (mm != NULL) {
+        module = mm->desc.module;
+        for (; mm != NULL && mm->desc.module == module;
+             mm = SLIST_NEXT(mm, next)) {
+
+            if (mm->desc.min_level < level) {
+                level = mm->desc.min_level;
+            }
+        }
+    }
+
+    return level;
+}
+
+/**
+ * Recomputes the route levels affected by a change to the mappings of the
+ * specified module.
+ */
+static void
+modlog_update_levels(uint8_t module)
+{
+    uint8_t dflt_level;
+    int i;
+
+    dflt_level = modlog_min_level(modlog_first_dflt);
+
+    if (module != MODLOG_MODULE_DFLT) {
+        if (modlog_routes[module] != NULL) {
+            modlog_route_levels[module] =
+                modlog_min_level(modlog_routes[module]);
+        } else {
+            modlog_route_levels[module] = dflt_level;
+        }
+        return;
+    }
+
+    for (i = 0; i < MODLOG_MODULE_DFLT; i++) {
+        if (modlog_routes[i] == NULL) {
+            modlog_route_levels[i] = dflt_level;
+        }
+    }
+}
+
 static void
 modlog_insert(struct modlog_mapping *mm)
 {
     struct modlog_mapping *prev;
+    uint8_t module;
+    os_sr_t sr;
+
+    module = mm->desc.module;
+    modlog_find_by_module(module, &prev);
+
+    OS_ENTER_CRITICAL(sr);
 
-    modlog_find_by_module(mm->desc.module, &prev);
     if (prev == NULL) {
         SLIST_INSERT_HEAD(&modlog_mappings, mm, next);
     } else {
         SLIST_INSERT_AFTER(prev, mm, next);
     }
 
-    if (mm->desc.module == MODLOG_MODULE_DFLT) {
+    if (module == MODLOG_MODULE_DFLT) {
         modlog_first_dflt = mm;
+    } else {
+        modlog_routes[module] = mm;
     }
+
+    OS_EXIT_CRITICAL(sr);
+
+    modlog_update_levels(module);
 }
 
+/**
+ * Unlinks a mapping and retires it.  Readers that are on the mapping can
+ * still follow its `next` pointer.
+ */
 static void
 modlog_remove(struct modlog_mapping *mm, struct modlog_mapping *prev)
 {
-    if (mm == modlog_first_dflt) {
-        modlog_first_dflt = SLIST_NEXT(mm, next);
+    struct modlog_mapping *next;
+    uint8_t module;
+    os_sr_t sr;
+
+    module = mm->desc.module;
+    next = SLIST_NEXT(mm, next);
+    if (next != NULL && next->desc.module != module) {
+        next = NULL;
     }
-        
+
+    OS_ENTER_CRITICAL(sr);
+
+    if (module == MODLOG_MODULE_DFLT) {
+        if (mm == modlog_first_dflt) {
+            modlog_first_dflt = next;
+        }
+    } else {
+        if (mm == modlog_routes[module]) {
+            modlog_routes[module] = next;
+        }
+    }
+
     if (prev == NULL) {
         SLIST_REMOVE_HEAD(&modlog_mappings, next);
     } else {
         SLIST_NEXT(prev, next) = SLIST_NEXT(mm, next);
     }
+
+    SLIST_INSERT_HEAD(&modlog_retired, mm, retired_next);
+
+    OS_EXIT_CRITICAL(sr);
+
+    modlog_update_levels(module);
 }
 
 static int
@@ -211,11 +438,37 @@ modlog_delete_no_lock(uint8_t handle)
     }
 
     modlog_remove(mm, prev);
-    modlog_free(mm);
 
     return 0;
 }
 
+/**
+ * Counts a write that was dropped by the route level as a drop by each of
+ * the logs it was routed to.
+ */
+static void
+modlog_count_drops(uint8_t module)
+{
+#if MYNEWT_VAL(LOG_STATS)
+    struct modlog_mapping *mm;
+    uint8_t mapped;
+
+    assert(module != MODLOG_MODULE_DFLT);
+
+    modlog_read_begin();
+
+    for (mm = modlog_route(module, &mapped);
+         mm != NULL && mm->desc.module == mapped;
+         mm = SLIST_NEXT(mm, next)) {
+
+        LOG_STATS_INC(mm->desc.log, writes);
+        LOG_STATS_INC(mm->desc.log, drops);
+    }
+
+    modlog_read_end();
+#endif
+}
+
 static int
 modlog_append_one(struct modlog_mapping *mm, uint8_t module, uint8_t level,
                   uint8_t etype, void *data, uint16_t len)
@@ -240,28 +493,11 @@ modlog_append_no_lock(uint8_t module, uint8_t level, uint8_t etype,
                       void *data, uint16_t len)
 {
     struct modlog_mapping *mm;
+    uint8_t mapped;
     int rc;
 
-    if (module == MODLOG_MODULE_DFLT) {
-        return SYS_EINVAL;
-    }
-
-    mm = modlog_find_by_module(module, NULL);
-    if (mm != NULL) {
-        while (mm != NULL && mm->desc.module == module) {
-            rc = modlog_append_one(mm, module, level, etype, data, len);
-            if (rc != 0) {
-                return rc;
-            }
-
-            mm = SLIST_NEXT(mm, next);
-        }
-        return 0;
-    }
-
-    /* No mappings match the specified module; write to the default set. */
-    for (mm = modlog_first_dflt;
-         mm != NULL;
+    for (mm = modlog_route(module, &mapped);
+         mm != NULL && mm->desc.module == mapped;
          mm = SLIST_NEXT(mm, next)) {
 
         rc = modlog_append_one(mm, module, level, etype, data, len);
@@ -298,39 +534,81 @@ modlog_append_mbuf_no_lock(uint8_t module, uint8_t level, uint8_t etype,
                            struct os_mbuf *om)
 {
     struct modlog_mapping *mm;
-    bool found;
+    uint8_t mapped;
     int rc;
 
-    found = false;
-    SLIST_FOREACH(mm, &modlog_mappings, next) {
-        if (mm->desc.module == module) {
-            found = true;
+    for (mm = modlog_route(module, &mapped);
+         mm != NULL && mm->desc.module == mapped;
+         mm = SLIST_NEXT(mm, next)) {
 
-            rc = modlog_append_mbuf_one(mm, module, level, etype, om);
-            if (rc != 0) {
-                return rc;
-            }
-        } else if (mm->desc.module > module) {
+        rc = modlog_append_mbuf_one(mm, module, level, etype, om);
+        if (rc != 0) {
+            return rc;
+        }
+    }
+
+    return 0;
+}
+
+static bool
+modlog_mapping_accepts(const struct modlog_mapping *mm, uint8_t module,
+                       uint8_t level)
+{
+    return level >= mm->desc.min_level &&
+           level >= mm->desc.log->l_level &&
+           level >= log_level_get(module);
+}
+
+/**
+ * Indicates whether any mapping would accept a write at the given level.  If
+ * none would, the write is counted as a drop by each mapped log, as
+ * modlog_append() would have done.  Writes to MODLOG_MODULE_DFLT are never
+ * accepted.
+ */
+static bool
+modlog_level_accepts(uint8_t module, uint8_t level)
+{
+    struct modlog_mapping *first;
+    struct modlog_mapping *mm;
+    uint8_t mapped;
+    bool accepts;
+
+    if (module == MODLOG_MODULE_DFLT) {
+        return false;
+    }
+
+    if (level < modlog_route_levels[module]) {
+        modlog_count_drops(module);
+        return false;
+    }
+
+    modlog_read_begin();
+
+    accepts = false;
+    first = modlog_route(module, &mapped);
+    for (mm = first;
+         mm != NULL && mm->desc.module == mapped;
+         mm = SLIST_NEXT(mm, next)) {
+
+        if (modlog_mapping_accepts(mm, module, level)) {
+            accepts = true;
             break;
         }
     }
 
-    /* If no mappings match the specified module, write to the default set. */
-    if (!found) {
-        for (mm = modlog_first_dflt;
-             mm != NULL;
+    if (!accepts) {
+        for (mm = first;
+             mm != NULL && mm->desc.module == mapped;
              mm = SLIST_NEXT(mm, next)) {
 
-            rc = modlog_append_mbuf_one(mm, module, level, etype, om);
-            if (rc != 0) {
-                return rc;
-            }
+            LOG_STATS_INC(mm->desc.log, writes);
+            LOG_STATS_INC(mm->desc.log, drops);
         }
     }
 
-    os_mbuf_free_chain(om);
+    modlog_read_end();
 
-    return 0;
+    return accepts;
 }
 
 static int
@@ -361,7 +639,7 @@ modlog_get(uint8_t handle, struct modlog_desc *out_desc)
     struct modlog_mapping *mm;
     int rc;
 
-    rwlock_acquire_read(&modlog_rwl);
+    modlog_read_begin();
 
     mm = modlog_find(handle, NULL);
     if (mm == NULL) {
@@ -373,7 +651,7 @@ modlog_get(uint8_t handle, struct modlog_desc *out_desc)
         rc = 0;
     }
 
-    rwlock_release_read(&modlog_rwl);
+    modlog_read_end();
 
     return rc;
 }
@@ -384,9 +662,10 @@ modlog_register(uint8_t module, struct log *log, uint8_t min_level,
 {
     int rc;
 
-    rwlock_acquire_write(&modlog_rwl);
+    modlog_lock();
+    modlog_reclaim();
     rc = modlog_register_no_lock(module, log, min_level, out_handle);
-    rwlock_release_write(&modlog_rwl);
+    modlog_unlock();
 
     return rc;
 }
@@ -396,9 +675,10 @@ modlog_delete(uint8_t handle)
 {
     int rc;
 
-    rwlock_acquire_write(&modlog_rwl);
+    modlog_lock();
     rc = modlog_delete_no_lock(handle);
-    rwlock_release_write(&modlog_rwl);
+    modlog_reclaim();
+    modlog_unlock();
 
     return rc;
 }
@@ -408,14 +688,14 @@ modlog_clear(void)
 {
     struct modlog_mapping *mm;
 
-    rwlock_acquire_write(&modlog_rwl);
+    modlog_lock();
 
     while ((mm = SLIST_FIRST(&modlog_mappings)) != NULL) {
         modlog_remove(mm, NULL);
-        modlog_free(mm);
     }
+    modlog_reclaim();
 
-    rwlock_release_write(&modlog_rwl);
+    modlog_unlock();
 }
 
 int
@@ -424,9 +704,18 @@ modlog_append(uint8_t module, uint8_t level, uint8_t etype,
 {
     int rc;
 
-    rwlock_acquire_read(&modlog_rwl);
+    if (module == MODLOG_MODULE_DFLT) {
+        return SYS_EINVAL;
+    }
+
+    if (level < modlog_route_levels[module]) {
+        modlog_count_drops(module);
+        return 0;
+    }
+
+    modlog_read_begin();
     rc = modlog_append_no_lock(module, level, etype, data, len);
-    rwlock_release_read(&modlog_rwl);
+    modlog_read_end();
 
     return rc;
 }
@@ -437,9 +726,18 @@ modlog_append_mbuf(uint8_t module, uint8_t level, uint8_t etype,
 {
     int rc;
 
-    rwlock_acquire_read(&modlog_rwl);
-    rc = modlog_append_mbuf_no_lock(module, level, etype, om);
-    rwlock_release_read(&modlog_rwl);
+    if (module == MODLOG_MODULE_DFLT) {
+        rc = SYS_EINVAL;
+    } else if (level < modlog_route_levels[module]) {
+        modlog_count_drops(module);
+        rc = 0;
+    } else {
+        modlog_read_begin();
+        rc = modlog_append_mbuf_no_lock(module, level, etype, om);
+        modlog_read_end();
+    }
+
+    os_mbuf_free_chain(om);
 
     return rc;
 }
@@ -449,9 +747,9 @@ modlog_foreach(modlog_foreach_fn *fn, void *arg)
 {
     int rc;
 
-    rwlock_acquire_read(&modlog_rwl);
+    modlog_read_begin();
     rc = modlog_foreach_no_lock(fn, arg);
-    rwlock_release_read(&modlog_rwl);
+    modlog_read_end();
 
     return rc;
 }
@@ -463,6 +761,10 @@ modlog_printf(uint8_t module, uint8_t level, const char *msg, ...)
     char buf[MYNEWT_VAL(MODLOG_MAX_PRINTF_LEN)];
     int len;
 
+    if (!modlog_level_accepts(module, level)) {
+        return;
+    }
+
     va_start(args, msg);
     len = vsnprintf(buf, MYNEWT_VAL(MODLOG_MAX_PRINTF_LEN), msg, args);
     va_end(args);
@@ -474,6 +776,29 @@ modlog_printf(uint8_t module, uint8_t level, const char *msg, ...)
     modlog_append(module, level, LOG_ETYPE_STRING, buf, len);
 }
 
+#if MYNEWT_VAL(LOG_DICT)
+void
+modlog_printf_dict(uint8_t module, uint8_t level, const char *fmt, ...)
+{
+    va_list args;
+    uint8_t buf[MYNEWT_VAL(MODLOG_MAX_PRINTF_LEN)];
+    int len;
+
+    if (!modlog_level_accepts(module, level)) {
+        return;
+    }
+
+    va_start(args, fmt);
+    len = log_dict_vencode(buf, sizeof buf, fmt, args);
+    va_end(args);
+    if (len < 0) {
+        return;
+    }
+
+    modlog_append(module, level, LOG_ETYPE_DICT, buf, len);
+}
+#endif
+
 void
 modlog_init(void)
 {
@@ -487,9 +812,14 @@ modlog_init(void)
     SYSINIT_PANIC_ASSERT(rc == 0);
 
     SLIST_INIT(&modlog_mappings);
+    SLIST_INIT(&modlog_retired);
     modlog_first_dflt = NULL;
+    modlog_readers = 0;
+    memset((void *)modlog_routes, 0, sizeof modlog_routes);
+    memset((void *)modlog_route_levels, MODLOG_LEVEL_NONE,
+           sizeof modlog_route_levels);
 
-    rc = rwlock_init(&modlog_rwl);
+    rc = os_mutex_init(&modlog_mtx);
     SYSINIT_PANIC_ASSERT(rc == 0);
 
     /* Register the default console mapping if configured. */
@@ -26,6 +26,9 @@ TEST_SUITE(modlog_test_suite_all)
     modlog_test_case_basic();
     modlog_test_case_printf();
     modlog_test_case_prio();
+    modlog_test_case_level();
+    modlog_test_case_delete();
+    modlog_test_case_bench();
 }
 
 #if MYNEWT_VAL(SELFTEST)
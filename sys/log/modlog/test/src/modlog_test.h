@@ -31,5 +31,8 @@ TEST_CASE_DECL(modlog_test_case_append);
 TEST_CASE_DECL(modlog_test_case_basic);
 TEST_CASE_DECL(modlog_test_case_printf);
 TEST_CASE_DECL(modlog_test_case_prio);
+TEST_CASE_DECL(modlog_test_case_level);
+TEST_CASE_DECL(modlog_test_case_delete);
+TEST_CASE_DECL(modlog_test_case_bench);
 
 #endif
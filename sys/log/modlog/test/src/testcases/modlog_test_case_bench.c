@@ -0,0 +1,96 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include "modlog_test.h"
+
+#define MLTCB_ROUNDS    4096
+
+static int
+mltcb_log_append_body(struct log *log, const struct log_entry_hdr *hdr,
+                      const void *buf, int len)
+{
+    (*(int *)log->l_arg)++;
+    return 0;
+}
+
+static const struct log_handler mltcb_handler = {
+    .log_type = LOG_TYPE_MEMORY,
+    .log_append_body = mltcb_log_append_body,
+};
+
+/*
+ * @return                      Time per call, in nanoseconds.
+ */
+static uint32_t
+mltcb_time(uint8_t module, uint8_t level)
+{
+    uint32_t start;
+    uint32_t usecs;
+    uint8_t byte;
+    int rc;
+    int i;
+
+    byte = 0;
+    start = os_cputime_get32();
+    for (i = 0; i < MLTCB_ROUNDS; i++) {
+        rc = modlog_append(module, level, LOG_ETYPE_STRING, &byte, 1);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+    usecs = os_cputime_ticks_to_usecs(os_cputime_get32() - start);
+
+    return (uint64_t)usecs * 1000 / MLTCB_ROUNDS;
+}
+
+/*
+ * Reports the cost of an enabled write and of writes that are filtered out,
+ * either by level or because the module has no mappings.
+ */
+TEST_CASE(modlog_test_case_bench)
+{
+    struct log log;
+    int num_entries;
+    int rc;
+    int i;
+
+    sysinit();
+
+    num_entries = 0;
+    rc = log_register("bench", &log, &mltcb_handler, &num_entries, 0);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /* Fill the pool so that a search of the mapping list would show. */
+    for (i = 0; i < MYNEWT_VAL(MODLOG_MAX_MAPPINGS); i++) {
+        rc = modlog_register(i, &log, 2, NULL);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+
+    i--;
+    printf("modlog enabled: %lu ns per call\n",
+           (unsigned long)mltcb_time(i, 2));
+    TEST_ASSERT(num_entries == MLTCB_ROUNDS);
+
+    printf("modlog filtered by level: %lu ns per call\n",
+           (unsigned long)mltcb_time(i, 1));
+    printf("modlog filtered, unmapped: %lu ns per call\n",
+           (unsigned long)mltcb_time(i + 1, 2));
+    TEST_ASSERT(num_entries == MLTCB_ROUNDS);
+
+    modlog_clear();
+}
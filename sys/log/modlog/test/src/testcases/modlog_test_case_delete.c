@@ -0,0 +1,96 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "modlog_test.h"
+
+struct mltcd_foreach_arg {
+    int num_visited;
+    int num_deleted;
+};
+
+static int
+mltcd_foreach_fn(const struct modlog_desc *desc, void *arg)
+{
+    struct mltcd_foreach_arg *mfa;
+    int rc;
+
+    mfa = arg;
+    mfa->num_visited++;
+
+    /* Delete every other mapping, including the one being visited. */
+    if (desc->module % 2 == 0) {
+        rc = modlog_delete(desc->handle);
+        TEST_ASSERT_FATAL(rc == 0);
+
+        rc = modlog_get(desc->handle, NULL);
+        TEST_ASSERT(rc == SYS_ENOENT);
+
+        mfa->num_deleted++;
+    }
+
+    return 0;
+}
+
+TEST_CASE(modlog_test_case_delete)
+{
+    struct mltcd_foreach_arg mfa;
+    struct mltu_log_arg mla;
+    struct log log;
+    uint8_t handle;
+    uint8_t byte;
+    int rc;
+    int i;
+
+    sysinit();
+
+    memset(&mla, 0, sizeof mla);
+    mltu_register_log(&log, &mla, "log", 0);
+
+    /* Fill the mapping pool. */
+    for (i = 0; i < MYNEWT_VAL(MODLOG_MAX_MAPPINGS); i++) {
+        rc = modlog_register(i, &log, 0, &handle);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+    rc = modlog_register(i, &log, 0, &handle);
+    TEST_ASSERT(rc == SYS_ENOMEM);
+
+    /* Ensure mappings can be deleted from within a foreach callback. */
+    memset(&mfa, 0, sizeof mfa);
+    rc = modlog_foreach(mltcd_foreach_fn, &mfa);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(mfa.num_visited == MYNEWT_VAL(MODLOG_MAX_MAPPINGS));
+
+    /* Ensure deleted mappings were returned to the pool. */
+    for (i = 0; i < mfa.num_deleted; i++) {
+        rc = modlog_register(100 + i, &log, 0, &handle);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+    rc = modlog_register(100 + i, &log, 0, &handle);
+    TEST_ASSERT(rc == SYS_ENOMEM);
+
+    /* Ensure deleted modules are no longer routed. */
+    mltu_append(0, 4, LOG_ETYPE_STRING, &byte, 1, false);
+    TEST_ASSERT(mla.num_entries == 0);
+
+    mltu_append(1, 4, LOG_ETYPE_STRING, &byte, 1, false);
+    mltu_append(100, 4, LOG_ETYPE_STRING, &byte, 1, false);
+    TEST_ASSERT(mla.num_entries == 2);
+
+    modlog_clear();
+}
@@ -0,0 +1,117 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "modlog_test.h"
+
+TEST_CASE(modlog_test_case_level)
+{
+    struct mltu_log_arg mla1;
+    struct mltu_log_arg mla2;
+    struct log log1;
+    struct log log2;
+    uint8_t handle1;
+    uint8_t handle2;
+    uint8_t handle3;
+    uint8_t byte;
+    int rc;
+
+    sysinit();
+
+    memset(&mla1, 0, sizeof mla1);
+    mltu_register_log(&log1, &mla1, "log1", 0);
+
+    memset(&mla2, 0, sizeof mla2);
+    mltu_register_log(&log2, &mla2, "log2", 0);
+
+    /* Module 5 goes to both logs; everything else goes to log 2. */
+    rc = modlog_register(5, &log1, 2, &handle1);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = modlog_register(5, &log2, 3, &handle2);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = modlog_register(MODLOG_MODULE_DFLT, &log2, 4, &handle3);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /* Ensure each mapping of a module applies its own level. */
+    mltu_append(5, 1, LOG_ETYPE_STRING, &byte, 1, false);
+    TEST_ASSERT(mla1.num_entries == 0);
+    TEST_ASSERT(mla2.num_entries == 0);
+
+    mltu_append(5, 2, LOG_ETYPE_STRING, &byte, 1, false);
+    TEST_ASSERT(mla1.num_entries == 1);
+    TEST_ASSERT(mla2.num_entries == 0);
+
+    mltu_append(5, 3, LOG_ETYPE_STRING, &byte, 1, false);
+    TEST_ASSERT(mla1.num_entries == 2);
+    TEST_ASSERT(mla2.num_entries == 1);
+
+    /* Ensure unmapped modules use the default mapping's level. */
+    mltu_append(6, 3, LOG_ETYPE_STRING, &byte, 1, false);
+    TEST_ASSERT(mla2.num_entries == 1);
+
+    mltu_append(6, 4, LOG_ETYPE_STRING, &byte, 1, false);
+    TEST_ASSERT(mla2.num_entries == 2);
+
+    /* Delete the most verbose mapping; ensure the module's level rises. */
+    rc = modlog_delete(handle1);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    mltu_append(5, 2, LOG_ETYPE_STRING, &byte, 1, false);
+    TEST_ASSERT(mla1.num_entries == 2);
+    TEST_ASSERT(mla2.num_entries == 2);
+
+    /* Delete the last mapping; ensure module falls back to the default. */
+    rc = modlog_delete(handle2);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    mltu_append(5, 3, LOG_ETYPE_STRING, &byte, 1, false);
+    TEST_ASSERT(mla2.num_entries == 2);
+
+    mltu_append(5, 4, LOG_ETYPE_STRING, &byte, 1, false);
+    TEST_ASSERT(mla2.num_entries == 3);
+
+    /* Add a more verbose default; ensure all unmapped modules follow. */
+    rc = modlog_register(MODLOG_MODULE_DFLT, &log1, 0, &handle1);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    mltu_append(5, 0, LOG_ETYPE_STRING, &byte, 1, false);
+    mltu_append(200, 0, LOG_ETYPE_STRING, &byte, 1, false);
+    TEST_ASSERT(mla1.num_entries == 4);
+    TEST_ASSERT(mla2.num_entries == 3);
+
+    /* Ensure a mapped module is unaffected by the default's level. */
+    rc = modlog_register(7, &log2, 4, &handle2);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    mltu_append(7, 0, LOG_ETYPE_STRING, &byte, 1, false);
+    TEST_ASSERT(mla1.num_entries == 4);
+    TEST_ASSERT(mla2.num_entries == 3);
+
+    /* Ensure the default module ID cannot be written to directly. */
+    rc = modlog_append(MODLOG_MODULE_DFLT, 4, LOG_ETYPE_STRING, &byte, 1);
+    TEST_ASSERT(rc == SYS_EINVAL);
+
+    rc = modlog_append(MODLOG_MODULE_DFLT, 0, LOG_ETYPE_STRING, &byte, 1);
+    TEST_ASSERT(rc == SYS_EINVAL);
+
+    modlog_printf(MODLOG_MODULE_DFLT, 4, "x");
+    TEST_ASSERT(mla1.num_entries == 4);
+    TEST_ASSERT(mla2.num_entries == 3);
+}
@@ -133,6 +133,21 @@ extern "C" {
  * call to metrics_event_end() may be omitted as metrics_event_start() will do
  * this implicitly.
  *
+ * Each logged event is a separate log entry by default. To save flash, several
+ * events can be packed into one entry, which is then a CBOR array of the event
+ * maps; the entry is written once the batch is full or it is flushed:
+ *
+ *         metrics_event_set_batch(&my_power_event.hdr, 8);
+ *         ...
+ *         metrics_event_flush(&my_power_event.hdr);
+ *
+ * With METRICS_SERIES_DOD enabled, series are written as a CBOR byte string of
+ * zigzag varints instead of an array of integers: the first value, then the
+ * first difference, then the difference between consecutive differences
+ * (delta-of-delta). Slowly changing or evenly spaced series then take about
+ * one byte per value. sys/metrics/tools/metrics_decode.py expands such entries
+ * on the host.
+ *
  * The amount of data which can be collected for all data series of all metrics
  * in a system is limited by capacity of mempool defined by following syscfg:
  *      METRICS_POOL_COUNT - number of blocks in mempool
@@ -176,6 +191,9 @@ struct metrics_event_hdr {
     uint32_t enabled;
     uint32_t set;
     uint8_t count;
+    uint8_t batch_max;
+    uint8_t batch_cnt;
+    struct os_mbuf *batch;
     STAILQ_ENTRY(metrics_event_hdr) next;
     const struct metrics_metric_def *defs;
 };
@@ -265,6 +283,32 @@ int metrics_event_register(struct metrics_event_hdr *hdr);
 int metrics_event_set_log(struct metrics_event_hdr *hdr, struct log *log,
                           int module, int level);
 
+/**
+ * Set number of events packed into a single log entry
+ *
+ * When set to more than 1, events ended with metrics_event_end() are
+ * accumulated and logged together, as a CBOR array of event maps, once
+ * `count` events are collected. Any pending events are logged first.
+ *
+ * @param hdr    Event header
+ * @param count  Events per log entry; 0 or 1 logs each event on its own
+ *
+ * @return 0 on success, negative value otherwise
+ */
+int metrics_event_set_batch(struct metrics_event_hdr *hdr, uint8_t count);
+
+/**
+ * Log pending batched events
+ *
+ * Writes events collected for the current batch to the log instance, even if
+ * the batch is not full yet.
+ *
+ * @param hdr  Event header
+ *
+ * @return 0 on success, negative value otherwise
+ */
+int metrics_event_flush(struct metrics_event_hdr *hdr);
+
 /**
  * Start new event
  *
@@ -88,6 +88,8 @@ int
 metrics_event_set_log(struct metrics_event_hdr *hdr, struct log *log,
                       int module, int level)
 {
+    metrics_event_flush(hdr);
+
     hdr->log = log;
     hdr->log_module = module;
     hdr->log_level = level;
@@ -95,6 +97,135 @@ metrics_event_set_log(struct metrics_event_hdr *hdr, struct log *log,
     return 0;
 }
 
+int
+metrics_event_set_batch(struct metrics_event_hdr *hdr, uint8_t count)
+{
+    int rc;
+
+    rc = metrics_event_flush(hdr);
+
+    hdr->batch_max = count;
+
+    return rc;
+}
+
+int
+metrics_event_flush(struct metrics_event_hdr *hdr)
+{
+    struct os_mbuf *om;
+    uint8_t brk;
+    int rc;
+
+    om = hdr->batch;
+    if (!om) {
+        return 0;
+    }
+
+    hdr->batch = NULL;
+    hdr->batch_cnt = 0;
+
+    /* Close the array opened in metrics_event_batch() */
+    brk = 0xff;
+    rc = os_mbuf_append(om, &brk, sizeof(brk));
+    if (rc) {
+        os_mbuf_free_chain(om);
+        return -1;
+    }
+
+    if (!hdr->log) {
+        os_mbuf_free_chain(om);
+        return 0;
+    }
+
+    rc = log_append_mbuf_typed(hdr->log, hdr->log_module, hdr->log_level,
+                               LOG_ETYPE_CBOR, om);
+    if (rc) {
+        return -1;
+    }
+
+    return 0;
+}
+
+/*
+ * Returns upper bound of pool blocks needed to encode event data. Encoded
+ * series values take at most twice their raw size (8-bit values), plus some
+ * room for names and single values.
+ */
+static int
+metrics_event_blocks(struct metrics_event_hdr *hdr)
+{
+    struct metrics_event *em = (struct metrics_event *)hdr;
+    struct os_mbuf *om;
+    int cnt;
+    int i;
+
+    cnt = 2;
+
+    for (i = 0; i < hdr->count; i++) {
+        if ((hdr->defs[i].type & METRICS_TYPE_SERIES_MASK) == 0) {
+            continue;
+        }
+
+        for (om = em->vals[i].series; om; om = SLIST_NEXT(om, om_next)) {
+            cnt += 2;
+        }
+    }
+
+    return cnt;
+}
+
+/*
+ * Appends event data to the pending batch, which is logged as a single
+ * entry: an indefinite-length CBOR array of event maps.
+ */
+static int
+metrics_event_batch(struct metrics_event_hdr *hdr)
+{
+    struct os_mbuf *om;
+    uint8_t arr;
+    int len;
+
+    /*
+     * Series are freed while being encoded, so make sure this event fits
+     * before adding it to a batch which already holds pool blocks.
+     */
+    if (hdr->batch &&
+        event_metric_mempool.mp_num_free < metrics_event_blocks(hdr)) {
+        metrics_event_flush(hdr);
+    }
+
+    if (!hdr->batch) {
+        om = metrics_get_mbuf();
+        if (!om) {
+            return -1;
+        }
+
+        arr = 0x9f;
+        if (!os_mbuf_extend(om, sizeof(struct log_entry_hdr)) ||
+            os_mbuf_append(om, &arr, sizeof(arr))) {
+            os_mbuf_free_chain(om);
+            return -1;
+        }
+
+        hdr->batch = om;
+    }
+
+    len = os_mbuf_len(hdr->batch);
+    if (metrics_event_to_cbor(hdr, hdr->batch)) {
+        /* Drop partially encoded event and log what is complete */
+        os_mbuf_adj(hdr->batch, len - os_mbuf_len(hdr->batch));
+        metrics_event_flush(hdr);
+        return -1;
+    }
+
+    hdr->batch_cnt++;
+    if (hdr->batch_cnt >= hdr->batch_max) {
+        return metrics_event_flush(hdr);
+    }
+
+    return 0;
+}
+
 int
 metrics_event_start(struct metrics_event_hdr *hdr, uint32_t timestamp)
 {
@@ -117,7 +248,11 @@ metrics_event_end(struct metrics_event_hdr *hdr)
     int ret;
     int i;
 
-    if (hdr->log) {
+    ret = 0;
+
+    if (hdr->log && hdr->batch_max > 1) {
+        ret = metrics_event_batch(hdr);
+    } else if (hdr->log) {
         om = metrics_get_mbuf();
         if (om) {
             os_mbuf_extend(om, sizeof(struct log_entry_hdr));
@@ -426,6 +561,125 @@ append_series_s32_to_cbor(CborEncoder *encoder, struct os_mbuf *om)
     return 0;
 }
 
+#if MYNEWT_VAL(METRICS_SERIES_DOD)
+
+/* Longest zigzag varint of a 64-bit value */
+#define METRICS_VARINT_MAX_LEN      10
+
+/* Series bytes are written in chunks of an indefinite-length byte string */
+#define METRICS_DOD_CHUNK_LEN       32
+
+static int64_t
+series_value(const uint8_t *ptr, uint8_t type)
+{
+    uint16_t u16;
+    uint32_t u32;
+
+    switch (type) {
+    case METRICS_TYPE_SERIES_U8:
+        return *ptr;
+    case METRICS_TYPE_SERIES_S8:
+        return (int8_t)*ptr;
+    case METRICS_TYPE_SERIES_U16:
+        memcpy(&u16, ptr, sizeof(u16));
+        return le16toh(u16);
+    case METRICS_TYPE_SERIES_S16:
+        memcpy(&u16, ptr, sizeof(u16));
+        return (int16_t)le16toh(u16);
+    case METRICS_TYPE_SERIES_U32:
+        memcpy(&u32, ptr, sizeof(u32));
+        return le32toh(u32);
+    case METRICS_TYPE_SERIES_S32:
+        memcpy(&u32, ptr, sizeof(u32));
+        return (int32_t)le32toh(u32);
+    default:
+        assert(0);
+        return 0;
+    }
+}
+
+static int
+put_zigzag_varint(uint8_t *buf, int64_t val)
+{
+    uint64_t zz;
+    int len;
+
+    zz = ((uint64_t)val << 1) ^ (uint64_t)(val >> 63);
+
+    len = 0;
+    do {
+        buf[len] = zz & 0x7f;
+        zz >>= 7;
+        if (zz) {
+            buf[len] |= 0x80;
+        }
+        len++;
+    } while (zz);
+
+    return len;
+}
+
+/*
+ * Writes the first value, then the first difference, then differences between
+ * consecutive differences, each as a zigzag varint.
+ */
+static int
+append_series_dod_to_cbor(CborEncoder *encoder, struct os_mbuf *om,
+                          uint8_t type)
+{
+    uint8_t chunk[METRICS_DOD_CHUNK_LEN];
+    int64_t prev_delta;
+    int64_t delta;
+    int64_t prev;
+    int64_t val;
+    uint8_t *ptr;
+    int type_len;
+    int len;
+    int n;
+
+    type_len = type & METRICS_TYPE_SIZE_MASK;
+    prev_delta = 0;
+    prev = 0;
+    len = 0;
+    n = 0;
+
+    while (om) {
+        ptr = om->om_data;
+
+        while (ptr < om->om_data + om->om_len) {
+            if (len > sizeof(chunk) - METRICS_VARINT_MAX_LEN) {
+                if (cbor_encode_byte_string(encoder, chunk, len)) {
+                    return -1;
+                }
+                len = 0;
+            }
+
+            val = series_value(ptr, type);
+            if (n == 0) {
+                len += put_zigzag_varint(chunk + len, val);
+            } else {
+                delta = val - prev;
+                len += put_zigzag_varint(chunk + len, delta - prev_delta);
+                prev_delta = delta;
+            }
+            prev = val;
+            n++;
+
+            ptr += type_len;
+        }
+
+        om = SLIST_NEXT(om, om_next);
+    }
+
+    if (len && cbor_encode_byte_string(encoder, chunk, len)) {
+        return -1;
+    }
+
+    return 0;
+}
+
+#endif
+
 int
 metrics_event_to_cbor(struct metrics_event_hdr *hdr, struct os_mbuf *om)
 {
@@ -478,6 +732,17 @@ metrics_event_to_cbor(struct metrics_event_hdr *hdr, struct os_mbuf *om)
             continue;
         }
 
+#if MYNEWT_VAL(METRICS_SERIES_DOD)
+        rc = cbor_encoder_create_indef_byte_string(&map, &arr);
+        if (rc != 0) {
+            return -1;
+        }
+
+        rc = append_series_dod_to_cbor(&arr, v->series, def->type);
+        if (rc != 0) {
+            return -1;
+        }
+#else
         rc = cbor_encoder_create_array(&map, &arr, CborIndefiniteLength);
         if (rc != 0) {
             return -1;
@@ -505,6 +770,7 @@ metrics_event_to_cbor(struct metrics_event_hdr *hdr, struct os_mbuf *om)
         default:
             assert(0);
         }
+#endif
 
         rc = cbor_encoder_close_container(&map, &arr);
         if (rc != 0) {
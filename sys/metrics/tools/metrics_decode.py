@@ -0,0 +1,216 @@
+#!/usr/bin/env python3
+#
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#  http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+#
+
+"""
+Decodes metrics log entries (LOG_ETYPE_CBOR bodies written by sys/metrics)
+into JSON, one line per event.
+
+Batched entries (a CBOR array of events) are split into their events, and
+series encoded with METRICS_SERIES_DOD (a byte string of delta-of-delta
+zigzag varints) are expanded back into lists of integers.  Entry bodies are
+given as hex strings, either on the command line or on standard input, where
+the last hex token of each line is used.
+
+    metrics_decode.py bf626576646d7965766274731a...
+    newtmgr log show ... | metrics_decode.py
+"""
+
+import argparse
+import json
+import re
+import struct
+import sys
+
+BREAK = object()
+
+
+class Reader:
+    def __init__(self, data):
+        self.data = data
+        self.off = 0
+
+    def byte(self):
+        if self.off >= len(self.data):
+            raise ValueError('truncated CBOR')
+        b = self.data[self.off]
+        self.off += 1
+        return b
+
+    def take(self, n):
+        if self.off + n > len(self.data):
+            raise ValueError('truncated CBOR')
+        b = self.data[self.off:self.off + n]
+        self.off += n
+        return b
+
+    def arg(self, info):
+        if info < 24:
+            return info
+        if info in (24, 25, 26, 27):
+            return int.from_bytes(self.take(1 << (info - 24)), 'big')
+        raise ValueError('bad CBOR argument %d' % info)
+
+    def string(self, major, info):
+        if info != 31:
+            return self.take(self.arg(info))
+        out = b''
+        while True:
+            ib = self.byte()
+            if ib == 0xff:
+                return out
+            if ib >> 5 != major:
+                raise ValueError('bad string chunk')
+            out += self.take(self.arg(ib & 0x1f))
+
+    def item(self):
+        ib = self.byte()
+        major = ib >> 5
+        info = ib & 0x1f
+
+        if ib == 0xff:
+            return BREAK
+        if major == 0:
+            return self.arg(info)
+        if major == 1:
+            return -1 - self.arg(info)
+        if major == 2:
+            return self.string(major, info)
+        if major == 3:
+            return self.string(major, info).decode(errors='replace')
+        if major == 4:
+            out = []
+            n = None if info == 31 else self.arg(info)
+            while n is None or len(out) < n:
+                val = self.item()
+                if val is BREAK:
+                    break
+                out.append(val)
+            return out
+        if major == 5:
+            out = {}
+            n = None if info == 31 else self.arg(info)
+            while n is None or len(out) < n:
+                key = self.item()
+                if key is BREAK:
+                    break
+                out[key] = self.item()
+            return out
+        if major == 6:
+            self.arg(info)
+            return self.item()
+
+        if info == 20:
+            return False
+        if info == 21:
+            return True
+        if info in (22, 23):
+            return None
+        if info == 25:
+            return struct.unpack('>e', self.take(2))[0]
+        if info == 26:
+            return struct.unpack('>f', self.take(4))[0]
+        if info == 27:
+            return struct.unpack('>d', self.take(8))[0]
+        return self.arg(info)
+
+
+def decode_series(data):
+    vals = []
+    zz = 0
+    shift = 0
+    prev = 0
+    prev_delta = 0
+
+    for b in data:
+        zz |= (b & 0x7f) << shift
+        shift += 7
+        if b & 0x80:
+            continue
+
+        dod = (zz >> 1) ^ -(zz & 1)
+        zz = 0
+        shift = 0
+
+        if not vals:
+            val = dod
+        else:
+            delta = prev_delta + dod
+            val = prev + delta
+            prev_delta = delta
+        vals.append(val)
+        prev = val
+
+    if shift:
+        raise ValueError('truncated series')
+    return vals
+
+
+def expand_event(ev):
+    if not isinstance(ev, dict):
+        raise ValueError('not a metrics event')
+    return {k: decode_series(v) if isinstance(v, bytes) else v
+            for k, v in ev.items()}
+
+
+def decode(data):
+    r = Reader(data)
+    top = r.item()
+    if r.off != len(data):
+        raise ValueError('trailing data')
+    if isinstance(top, list):
+        return [expand_event(ev) for ev in top]
+    return [expand_event(top)]
+
+
+def is_hex(tok):
+    return (len(tok) >= 2 and len(tok) % 2 == 0 and
+            re.fullmatch(r'[0-9a-fA-F]+', tok) is not None)
+
+
+def print_events(data):
+    for ev in decode(data):
+        print(json.dumps(ev))
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Decode metrics log entries into JSON.')
+    parser.add_argument('bodies', nargs='*',
+                        help='hex-encoded entry bodies; read from standard '
+                             'input if none are given')
+    args = parser.parse_args()
+
+    toks = args.bodies
+    if not toks:
+        toks = []
+        for line in sys.stdin:
+            hexes = [t for t in line.split() if is_hex(t)]
+            if hexes:
+                toks.append(hexes[-1])
+
+    for tok in toks:
+        try:
+            print_events(bytes.fromhex(tok))
+        except ValueError as e:
+            print('%s: %s' % (tok, e), file=sys.stderr)
+
+
+if __name__ == '__main__':
+    main()
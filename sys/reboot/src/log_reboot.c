@@ -33,6 +33,9 @@
 #if MYNEWT_VAL(REBOOT_LOG_FCB)
 #include "fcb/fcb.h"
 #endif
+#if MYNEWT_VAL(LOG_TIERED)
+#include "log/log_tiered.h"
+#endif
 
 uint16_t reboot_cnt;
 static char reboot_cnt_str[12];
@@ -208,6 +211,20 @@ log_reboot(const struct log_reboot_info *info)
     }
 
     rc = log_reboot_write(info);
+
+#if MYNEWT_VAL(LOG_TIERED)
+    /* Move RAM-buffered log entries, including the one just written, to
+     * flash before the system resets.  A requested reset comes from a task,
+     * which can wait for the log locks.  Anything else is a fault or an
+     * assert, which may have interrupted a log operation and cannot block.
+     */
+    if (info->reason == HAL_RESET_REQUESTED && !os_arch_in_critical()) {
+        log_tiered_spill_all();
+    } else {
+        log_tiered_crash_flush();
+    }
+#endif
+
     if (rc != 0) {
         return rc;
     }
@@ -62,10 +62,45 @@ STATS_SECT_DECL(__name) {                   \
 #define STATS_SIZE_32 (sizeof(uint32_t))
 #define STATS_SIZE_64 (sizeof(uint64_t))
 
+/**
+ * Summary statistic: the number, range and sum of the values recorded.
+ * Recording is O(1) and takes no lock; like the counters, a reader racing
+ * with a writer may see a partially updated entry.
+ */
+struct stats_summary {
+    uint32_t ss_count;
+    uint32_t ss_min;
+    uint32_t ss_max;
+    uint64_t ss_sum;
+} __attribute__((packed, aligned(4)));
+
+#define STATS_HIST_BUCKETS MYNEWT_VAL(STATS_HIST_BUCKETS)
+
+/**
+ * Histogram statistic: a summary plus log2 buckets.  Bucket 0 counts the
+ * value 0, bucket n counts values in [2^(n-1), 2^n) and the last bucket
+ * also absorbs everything above its lower bound.
+ */
+struct stats_hist {
+    struct stats_summary sh_summary;
+    uint32_t sh_buckets[STATS_HIST_BUCKETS];
+} __attribute__((packed, aligned(4)));
+
+#define STATS_SIZE_SUMMARY (sizeof(struct stats_summary))
+#define STATS_SIZE_HIST (sizeof(struct stats_hist))
+
 #define STATS_SECT_ENTRY(__var) uint32_t STATS_SECT_VAR(__var);
 #define STATS_SECT_ENTRY16(__var) uint16_t STATS_SECT_VAR(__var);
 #define STATS_SECT_ENTRY32(__var) uint32_t STATS_SECT_VAR(__var);
 #define STATS_SECT_ENTRY64(__var) uint64_t STATS_SECT_VAR(__var);
+
+/*
+ * All entries in a section share one size, so summaries and histograms
+ * live in sections of their own (initialized with STATS_SIZE_SUMMARY or
+ * STATS_SIZE_HIST).
+ */
+#define STATS_SECT_SUMMARY(__var) struct stats_summary STATS_SECT_VAR(__var);
+#define STATS_SECT_HIST(__var) struct stats_hist STATS_SECT_VAR(__var);
 #define STATS_RESET(__var)                                              \
     memset((uint8_t *)&__var + sizeof(struct stats_hdr), 0,             \
            sizeof(__var) - sizeof(struct stats_hdr))
@@ -86,6 +121,108 @@ STATS_SECT_DECL(__name) {                   \
 #define STATS_CLEAR(__sectvarname, __var)        \
     (STATS_GET(__sectvarname, __var) = 0)
 
+static inline int
+stats_hist_bucket(uint32_t val)
+{
+    int idx;
+
+    idx = val ? 32 - __builtin_clz(val) : 0;
+    if (idx >= STATS_HIST_BUCKETS) {
+        idx = STATS_HIST_BUCKETS - 1;
+    }
+    return idx;
+}
+
+/**
+ * Returns the smallest value counted by histogram bucket idx.
+ */
+static inline uint32_t
+stats_hist_bucket_min(int idx)
+{
+    return idx ? (uint32_t)1 << (idx - 1) : 0;
+}
+
+static inline void
+stats_summary_record(struct stats_summary *ss, uint32_t val)
+{
+    if (ss->ss_count == 0 || val < ss->ss_min) {
+        ss->ss_min = val;
+    }
+    if (val > ss->ss_max) {
+        ss->ss_max = val;
+    }
+    ss->ss_sum += val;
+    ss->ss_count++;
+}
+
+static inline void
+stats_hist_record(struct stats_hist *sh, uint32_t val)
+{
+    stats_summary_record(&sh->sh_summary, val);
+    sh->sh_buckets[stats_hist_bucket(val)]++;
+}
+
+/*
+ * ISR-safe counters.  STATS_INC_ATOMIC and STATS_INCN_ATOMIC may be used on
+ * 32-bit entries from any context, including nested interrupts, without
+ * losing counts.  On cores with exclusive load/store (e.g. ARMv7-M) this
+ * compiles to an LDREX/STREX loop and interrupts stay enabled; elsewhere it
+ * falls back to a short critical section.
+ */
+#if __GCC_ATOMIC_INT_LOCK_FREE == 2 && __GCC_ATOMIC_LONG_LOCK_FREE == 2
+
+static inline void
+stats_atomic_add32(uint32_t *val, uint32_t n)
+{
+    __atomic_fetch_add(val, n, __ATOMIC_RELAXED);
+}
+
+static inline uint32_t
+stats_atomic_clear32(uint32_t *val)
+{
+    return __atomic_exchange_n(val, 0, __ATOMIC_RELAXED);
+}
+
+#else
+
+static inline void
+stats_atomic_add32(uint32_t *val, uint32_t n)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    *val += n;
+    OS_EXIT_CRITICAL(sr);
+}
+
+static inline uint32_t
+stats_atomic_clear32(uint32_t *val)
+{
+    uint32_t old;
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    old = *val;
+    *val = 0;
+    OS_EXIT_CRITICAL(sr);
+
+    return old;
+}
+
+#endif
+
+#define STATS_INC_ATOMIC(__sectvarname, __var)                  \
+    stats_atomic_add32(&STATS_GET(__sectvarname, __var), 1)
+
+#define STATS_INCN_ATOMIC(__sectvarname, __var, __n)            \
+    stats_atomic_add32(&STATS_GET(__sectvarname, __var), (__n))
+
+#define STATS_SUMMARY_RECORD(__sectvarname, __var, __val)   \
+    stats_summary_record(&STATS_GET(__sectvarname, __var), (__val))
+
+#define STATS_HIST_RECORD(__sectvarname, __var, __val)      \
+    stats_hist_record(&STATS_GET(__sectvarname, __var), (__val))
+
 #if MYNEWT_VAL(STATS_NAMES)
 
 #define STATS_NAME_MAP_NAME(__sectname) g_stats_map_ ## __sectname
@@ -120,6 +257,9 @@ int stats_init_and_reg(struct stats_hdr *shdr, uint8_t size, uint8_t cnt,
                        const struct stats_name_map *map, uint8_t map_cnt,
                        char *name);
 void stats_reset(struct stats_hdr *shdr);
+int stats_snapshot_reset(struct stats_hdr *shdr, uint32_t *dst, int dst_cnt);
+int stats_delta_encode(struct stats_hdr *shdr, uint32_t *base, uint8_t *buf,
+                       int buf_len, int *out_len);
 
 typedef int (*stats_walk_func_t)(struct stats_hdr *, void *, char *,
         uint16_t);
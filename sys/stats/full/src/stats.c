@@ -376,13 +376,146 @@ stats_reset(struct stats_hdr *hdr)
             case sizeof(uint64_t):
                 *(uint64_t *)stat_val = 0;
                 break;
+            default:
+                /* Summary or histogram. */
+                memset(stat_val, 0, hdr->s_size);
+                break;
         }
 
         /*
          * Statistics are variable sized, move forward either 16, 32 or 64
-         * bits in the structure.
+         * bits, or a whole summary / histogram, in the structure.
          */
         cur += hdr->s_size;
     }
     return;
 }
+
+/**
+ * Atomically reads and zeroes each entry of a 32-bit statistics section.
+ * Every entry is swapped with zero on its own, so an increment racing with
+ * the snapshot lands either in the returned value or in the counter; none
+ * are lost.
+ *
+ * @param shdr The statistics header to snapshot
+ * @param dst Array receiving the values, in entry order
+ * @param dst_cnt Number of elements in dst
+ *
+ * @return The number of entries read on success; SYS_EINVAL if the section
+ *         is not made of 32-bit entries.
+ */
+int
+stats_snapshot_reset(struct stats_hdr *shdr, uint32_t *dst, int dst_cnt)
+{
+    uint32_t *vals;
+    int i;
+
+    if (shdr->s_size != sizeof(uint32_t)) {
+        return SYS_EINVAL;
+    }
+
+    vals = (uint32_t *)(shdr + 1);
+    for (i = 0; i < shdr->s_cnt && i < dst_cnt; i++) {
+        dst[i] = stats_atomic_clear32(&vals[i]);
+    }
+
+    return i;
+}
+
+static int
+stats_put_varint(uint8_t *buf, int buf_len, uint32_t val)
+{
+    int off;
+
+    off = 0;
+    do {
+        if (off >= buf_len) {
+            return -1;
+        }
+        buf[off] = val & 0x7f;
+        val >>= 7;
+        if (val != 0) {
+            buf[off] |= 0x80;
+        }
+        off++;
+    } while (val != 0);
+
+    return off;
+}
+
+/**
+ * Encodes the change in each entry of a 32-bit statistics section since a
+ * caller-owned baseline, and advances the baseline past what was written.
+ * The live counters are only read, so other readers of the section are not
+ * affected.  Only entries that differ from the baseline are written, each
+ * as a pair of unsigned LEB128 varints: the gap from the previous written
+ * entry's index (the first one is relative to -1), then the count.  A
+ * section with nothing new encodes to zero bytes.
+ *
+ * Changes are taken modulo 2^32, so a counter that wrapped around since
+ * the baseline reports the increments it made.  A reset cannot be told
+ * apart from a wrap: after stats_reset(), clear the baseline as well.
+ *
+ * If buf fills up, the baseline of the entries not written is left alone,
+ * and the next call picks them up.
+ *
+ * @param shdr The statistics header to encode
+ * @param base The baseline; one element per entry of the section.  Start
+ *             with all zeros to get the counts since boot.
+ * @param buf The buffer to encode into
+ * @param buf_len The size of buf
+ * @param out_len On success, the number of bytes written
+ *
+ * @return 0 if every change was encoded; SYS_EAGAIN if buf filled up and
+ *         another call is needed; SYS_EINVAL if the section is not made of
+ *         32-bit entries.
+ */
+int
+stats_delta_encode(struct stats_hdr *shdr, uint32_t *base, uint8_t *buf,
+                   int buf_len, int *out_len)
+{
+    volatile uint32_t *vals;
+    uint32_t cur;
+    int prev;
+    int off;
+    int rc;
+    int n1;
+    int n2;
+    int i;
+
+    if (shdr->s_size != sizeof(uint32_t)) {
+        return SYS_EINVAL;
+    }
+
+    vals = (volatile uint32_t *)(shdr + 1);
+    prev = -1;
+    off = 0;
+    rc = 0;
+
+    for (i = 0; i < shdr->s_cnt; i++) {
+        /* An aligned 32-bit load is atomic on every supported core. */
+        cur = vals[i];
+        if (cur == base[i]) {
+            continue;
+        }
+
+        n1 = stats_put_varint(buf + off, buf_len - off, i - prev);
+        n2 = -1;
+        if (n1 > 0) {
+            n2 = stats_put_varint(buf + off + n1, buf_len - off - n1,
+                                  (uint32_t)(cur - base[i]));
+        }
+        if (n2 < 0) {
+            rc = SYS_EAGAIN;
+            break;
+        }
+
+        off += n1 + n2;
+        prev = i;
+
+        base[i] = cur;
+    }
+
+    *out_len = off;
+    return rc;
+}
@@ -33,20 +33,101 @@
  */
 static int stats_nmgr_read(struct mgmt_cbuf *cb);
 static int stats_nmgr_list(struct mgmt_cbuf *cb);
+static int stats_nmgr_dump(struct mgmt_cbuf *cb);
+static int stats_nmgr_delta(struct mgmt_cbuf *cb);
 
 static struct mgmt_group shell_nmgr_group;
 
 #define STATS_NMGR_ID_READ  (0)
 #define STATS_NMGR_ID_LIST  (1)
+#define STATS_NMGR_ID_DUMP  (2)
+#define STATS_NMGR_ID_DELTA (3)
+
+/* Largest binary delta returned by a single request. */
+#define STATS_NMGR_DELTA_LEN    (128)
+
+#define STATS_NMGR_DELTA_GROUPS  MYNEWT_VAL(STATS_NEWTMGR_DELTA_GROUPS)
+#define STATS_NMGR_DELTA_ENTRIES MYNEWT_VAL(STATS_NEWTMGR_DELTA_ENTRIES)
+
+#if STATS_NMGR_DELTA_GROUPS < 1 || STATS_NMGR_DELTA_ENTRIES < 1
+#error "STATS_NEWTMGR_DELTA_GROUPS and _DELTA_ENTRIES must be at least 1"
+#endif
+
+/*
+ * Values of a group as of its previous delta request.  The live counters
+ * are never cleared by a delta request, so "stat read" and other readers
+ * keep seeing the totals.
+ */
+struct stats_nmgr_delta_base {
+    struct stats_hdr *sdb_hdr;
+    uint32_t sdb_vals[STATS_NMGR_DELTA_ENTRIES];
+
+    /* Value of the delta clock at the group's last request. */
+    uint32_t sdb_used;
+};
+
+static struct stats_nmgr_delta_base
+    stats_nmgr_delta_bases[STATS_NMGR_DELTA_GROUPS];
+static uint32_t stats_nmgr_delta_clock;
 
 /* ORDER MATTERS HERE.
  * Each element represents the command ID, referenced from newtmgr.
  */
 static struct mgmt_handler shell_nmgr_group_handlers[] = {
     [STATS_NMGR_ID_READ] = {stats_nmgr_read, stats_nmgr_read},
-    [STATS_NMGR_ID_LIST] = {stats_nmgr_list, stats_nmgr_list}
+    [STATS_NMGR_ID_LIST] = {stats_nmgr_list, stats_nmgr_list},
+    [STATS_NMGR_ID_DUMP] = {stats_nmgr_dump, stats_nmgr_dump},
+    [STATS_NMGR_ID_DELTA] = {stats_nmgr_delta, stats_nmgr_delta}
 };
 
+static CborError
+stats_nmgr_encode_summary(CborEncoder *penc, struct stats_summary *ss)
+{
+    CborError g_err = CborNoError;
+
+    g_err |= cbor_encode_text_stringz(penc, "count");
+    g_err |= cbor_encode_uint(penc, ss->ss_count);
+    g_err |= cbor_encode_text_stringz(penc, "min");
+    g_err |= cbor_encode_uint(penc, ss->ss_min);
+    g_err |= cbor_encode_text_stringz(penc, "max");
+    g_err |= cbor_encode_uint(penc, ss->ss_max);
+    g_err |= cbor_encode_text_stringz(penc, "sum");
+    g_err |= cbor_encode_uint(penc, ss->ss_sum);
+
+    return (g_err);
+}
+
+/**
+ * Summaries are encoded as a map of count, min, max and sum.  Histograms add
+ * a "buckets" array; bucket n holds the values in [2^(n-1), 2^n).
+ */
+static CborError
+stats_nmgr_encode_dist(CborEncoder *penc, struct stats_hdr *hdr,
+                       void *stat_val)
+{
+    struct stats_hist *sh;
+    CborEncoder map;
+    CborEncoder buckets;
+    CborError g_err = CborNoError;
+    int i;
+
+    g_err |= cbor_encoder_create_map(penc, &map, CborIndefiniteLength);
+    g_err |= stats_nmgr_encode_summary(&map, stat_val);
+    if (hdr->s_size == STATS_SIZE_HIST) {
+        sh = stat_val;
+        g_err |= cbor_encode_text_stringz(&map, "buckets");
+        g_err |= cbor_encoder_create_array(&map, &buckets,
+                                           STATS_HIST_BUCKETS);
+        for (i = 0; i < STATS_HIST_BUCKETS; i++) {
+            g_err |= cbor_encode_uint(&buckets, sh->sh_buckets[i]);
+        }
+        g_err |= cbor_encoder_close_container(&map, &buckets);
+    }
+    g_err |= cbor_encoder_close_container(penc, &map);
+
+    return (g_err);
+}
+
 static int
 stats_nmgr_walk_func(struct stats_hdr *hdr, void *arg, char *sname,
         uint16_t stat_off)
@@ -69,6 +150,10 @@ stats_nmgr_walk_func(struct stats_hdr *hdr, void *arg, char *sname,
         case sizeof(uint64_t):
             g_err |= cbor_encode_uint(penc, *(uint64_t *) stat_val);
             break;
+        case STATS_SIZE_SUMMARY:
+        case STATS_SIZE_HIST:
+            g_err |= stats_nmgr_encode_dist(penc, hdr, stat_val);
+            break;
     }
 
     return (g_err);
@@ -151,6 +236,148 @@ stats_nmgr_list(struct mgmt_cbuf *cb)
     return (0);
 }
 
+static int
+stats_nmgr_encode_group(struct stats_hdr *hdr, void *arg)
+{
+    CborEncoder *penc = (CborEncoder *) arg;
+    CborError g_err = CborNoError;
+    CborEncoder fields;
+
+    g_err |= cbor_encode_text_stringz(penc, hdr->s_name);
+    g_err |= cbor_encoder_create_map(penc, &fields, CborIndefiniteLength);
+    stats_walk(hdr, stats_nmgr_walk_func, &fields);
+    g_err |= cbor_encoder_close_container(penc, &fields);
+
+    return (g_err);
+}
+
+/**
+ * Encodes every statistics group.  This is meant to be streamed (see
+ * NMGR_F_STREAM); otherwise the response has to fit in the mbufs available.
+ */
+static int
+stats_nmgr_dump(struct mgmt_cbuf *cb)
+{
+    CborError g_err = CborNoError;
+    CborEncoder groups;
+
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "rc");
+    g_err |= cbor_encode_int(&cb->encoder, MGMT_ERR_EOK);
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "groups");
+    g_err |= cbor_encoder_create_map(&cb->encoder, &groups,
+                                     CborIndefiniteLength);
+    g_err |= stats_group_walk(stats_nmgr_encode_group, &groups);
+    g_err |= cbor_encoder_close_container(&cb->encoder, &groups);
+
+    if (g_err) {
+        return MGMT_ERR_ENOMEM;
+    }
+    return (0);
+}
+
+/**
+ * Finds the baseline of a group, or takes over the least recently used
+ * slot.  A new baseline starts at zero, so the first delta of a group
+ * reports its totals.  The group must have at most
+ * STATS_NMGR_DELTA_ENTRIES entries.
+ */
+static struct stats_nmgr_delta_base *
+stats_nmgr_delta_base_get(struct stats_hdr *hdr)
+{
+    struct stats_nmgr_delta_base *victim;
+    struct stats_nmgr_delta_base *sdb;
+    int i;
+
+    victim = NULL;
+    for (i = 0; i < STATS_NMGR_DELTA_GROUPS; i++) {
+        sdb = &stats_nmgr_delta_bases[i];
+        if (sdb->sdb_hdr == hdr) {
+            sdb->sdb_used = ++stats_nmgr_delta_clock;
+            return sdb;
+        }
+
+        if (victim == NULL ||
+            (victim->sdb_hdr != NULL &&
+             (sdb->sdb_hdr == NULL ||
+              (int32_t)(sdb->sdb_used - victim->sdb_used) < 0))) {
+
+            victim = sdb;
+        }
+    }
+
+    memset(victim->sdb_vals, 0, sizeof victim->sdb_vals);
+    victim->sdb_hdr = hdr;
+    victim->sdb_used = ++stats_nmgr_delta_clock;
+
+    return victim;
+}
+
+/**
+ * Returns the counts of a 32-bit group accumulated since the previous delta
+ * request for that group, in the binary format of stats_delta_encode().
+ * The group's counters are not cleared.  "more" is set when the changes did
+ * not fit and another request is needed.
+ */
+static int
+stats_nmgr_delta(struct mgmt_cbuf *cb)
+{
+    struct stats_nmgr_delta_base *sdb;
+    struct stats_hdr *hdr;
+    char stats_name[STATS_NMGR_NAME_LEN];
+    uint8_t buf[STATS_NMGR_DELTA_LEN];
+    struct cbor_attr_t attrs[] = {
+        { "name", CborAttrTextStringType, .addr.string = &stats_name[0],
+            .len = sizeof(stats_name) },
+        { NULL },
+    };
+    CborError g_err = CborNoError;
+    int len;
+    int rc;
+
+    g_err = cbor_read_object(&cb->it, attrs);
+    if (g_err != 0) {
+        return MGMT_ERR_EINVAL;
+    }
+
+    hdr = stats_group_find(stats_name);
+    if (!hdr) {
+        return MGMT_ERR_EINVAL;
+    }
+
+    if (hdr->s_size != sizeof(uint32_t)) {
+        return MGMT_ERR_EINVAL;
+    }
+
+    /* No room for the baseline of so large a group. */
+    if (hdr->s_cnt > STATS_NMGR_DELTA_ENTRIES) {
+        return MGMT_ERR_ENOMEM;
+    }
+
+    sdb = stats_nmgr_delta_base_get(hdr);
+
+    rc = stats_delta_encode(hdr, sdb->sdb_vals, buf, sizeof buf, &len);
+    if (rc != 0 && rc != SYS_EAGAIN) {
+        return MGMT_ERR_EINVAL;
+    }
+
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "rc");
+    g_err |= cbor_encode_int(&cb->encoder, MGMT_ERR_EOK);
+
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "name");
+    g_err |= cbor_encode_text_stringz(&cb->encoder, stats_name);
+
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "delta");
+    g_err |= cbor_encode_byte_string(&cb->encoder, buf, len);
+
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "more");
+    g_err |= cbor_encode_boolean(&cb->encoder, rc == SYS_EAGAIN);
+
+    if (g_err) {
+        return MGMT_ERR_ENOMEM;
+    }
+    return (0);
+}
+
 /**
  * Register nmgr group handlers
  */
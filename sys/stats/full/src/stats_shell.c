@@ -36,6 +36,34 @@ static struct shell_cmd shell_stats_cmd = {
 };
 uint8_t stats_shell_registered;
 
+static void
+stats_shell_display_dist(struct stats_hdr *hdr, char *name, void *stat_val)
+{
+    struct stats_summary *ss;
+    struct stats_hist *sh;
+    int i;
+
+    ss = stat_val;
+    console_printf("%s: count=%lu min=%lu max=%lu avg=%llu sum=%llu\n", name,
+                   (unsigned long)ss->ss_count, (unsigned long)ss->ss_min,
+                   (unsigned long)ss->ss_max,
+                   ss->ss_count ? ss->ss_sum / ss->ss_count : 0ULL,
+                   (unsigned long long)ss->ss_sum);
+
+    if (hdr->s_size != STATS_SIZE_HIST) {
+        return;
+    }
+
+    sh = stat_val;
+    for (i = 0; i < STATS_HIST_BUCKETS; i++) {
+        if (sh->sh_buckets[i] != 0) {
+            console_printf("    >=%lu: %lu\n",
+                           (unsigned long)stats_hist_bucket_min(i),
+                           (unsigned long)sh->sh_buckets[i]);
+        }
+    }
+}
+
 static int 
 stats_shell_display_entry(struct stats_hdr *hdr, void *arg, char *name,
         uint16_t stat_off)
@@ -53,6 +81,10 @@ stats_shell_display_entry(struct stats_hdr *hdr, void *arg, char *name,
         case sizeof(uint64_t):
             console_printf("%s: %llu\n", name, *(uint64_t *) stat_val);
             break;
+        case STATS_SIZE_SUMMARY:
+        case STATS_SIZE_HIST:
+            stats_shell_display_dist(hdr, name, stat_val);
+            break;
         default:
             console_printf("Unknown stat size for %s %u\n", name, 
                     hdr->s_size);
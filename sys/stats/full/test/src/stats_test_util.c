@@ -0,0 +1,65 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "stats_test.h"
+
+/**
+ * Decodes the output of stats_delta_encode(), adding each count to
+ * totals[index].
+ *
+ * @return The number of counts decoded; -1 on malformed input.
+ */
+int
+stu_delta_decode(const uint8_t *buf, int len, uint32_t *totals, int cnt)
+{
+    uint32_t vals[2];
+    int shift;
+    int idx;
+    int off;
+    int num;
+    int i;
+
+    idx = -1;
+    off = 0;
+    num = 0;
+
+    while (off < len) {
+        for (i = 0; i < 2; i++) {
+            vals[i] = 0;
+            shift = 0;
+            do {
+                if (off >= len || shift > 28) {
+                    return -1;
+                }
+                vals[i] |= (uint32_t)(buf[off] & 0x7f) << shift;
+                shift += 7;
+            } while (buf[off++] & 0x80);
+        }
+
+        idx += vals[0];
+        if (vals[0] == 0 || idx >= cnt || vals[1] == 0) {
+            return -1;
+        }
+        totals[idx] += vals[1];
+        num++;
+    }
+
+    return num;
+}
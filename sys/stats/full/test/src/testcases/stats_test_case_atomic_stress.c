@@ -0,0 +1,145 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "stats_test.h"
+
+/*
+ * Tasks at different priorities increment a shared section while the test
+ * task reads it with stats_delta_encode().  The writers sleep at different
+ * rates, so increments and reads are preempted by one another, as they are
+ * by interrupts on a device.  Every count must be reported exactly once,
+ * and the counters must end up holding every increment.
+ */
+
+#define STAS_NUM_WRITERS        3
+#define STAS_WRITER_PRIO        10
+#define STAS_STACK_SIZE         1024
+#define STAS_NUM_INCS           20000
+
+STATS_SECT_START(stas_stats)
+    STATS_SECT_ENTRY(w0)
+    STATS_SECT_ENTRY(w1)
+    STATS_SECT_ENTRY(w2)
+    STATS_SECT_ENTRY(shared)
+STATS_SECT_END
+
+#define STAS_NUM_ENTRIES        (STAS_NUM_WRITERS + 1)
+#define STAS_SHARED_IDX         STAS_NUM_WRITERS
+
+static STATS_SECT_DECL(stas_stats) stas_stats;
+
+static struct os_task stas_tasks[STAS_NUM_WRITERS];
+static os_stack_t stas_stacks[STAS_NUM_WRITERS][STAS_STACK_SIZE];
+
+static int stas_num_done;
+
+static void
+stas_writer(void *arg)
+{
+    os_sr_t sr;
+    int writer;
+    int i;
+
+    writer = (intptr_t)arg;
+
+    for (i = 0; i < STAS_NUM_INCS; i++) {
+        switch (writer) {
+        case 0:
+            STATS_INC_ATOMIC(stas_stats, w0);
+            break;
+        case 1:
+            STATS_INC_ATOMIC(stas_stats, w1);
+            break;
+        default:
+            STATS_INC_ATOMIC(stas_stats, w2);
+            break;
+        }
+        STATS_INCN_ATOMIC(stas_stats, shared, writer + 1);
+
+        if (i % (64 + 32 * writer) == 0) {
+            os_time_delay(1);
+        }
+    }
+
+    OS_ENTER_CRITICAL(sr);
+    stas_num_done++;
+    OS_EXIT_CRITICAL(sr);
+
+    while (1) {
+        os_time_delay(OS_TICKS_PER_SEC);
+    }
+}
+
+static void
+stas_drain(uint32_t *base, uint32_t *totals)
+{
+    uint8_t buf[4];
+    int len;
+    int rc;
+
+    /* A tiny buffer so that deltas regularly span several calls. */
+    do {
+        rc = stats_delta_encode(STATS_HDR(stas_stats), base, buf, sizeof buf,
+                                &len);
+        TEST_ASSERT_FATAL(rc == 0 || rc == SYS_EAGAIN);
+        TEST_ASSERT_FATAL(stu_delta_decode(buf, len, totals,
+                                           STAS_NUM_ENTRIES) >= 0);
+    } while (rc == SYS_EAGAIN);
+}
+
+TEST_CASE_TASK(stats_test_case_atomic_stress)
+{
+    uint32_t totals[STAS_NUM_ENTRIES];
+    uint32_t base[STAS_NUM_ENTRIES];
+    int passes;
+    int rc;
+    int i;
+
+    rc = stats_init(STATS_HDR(stas_stats),
+                    STATS_SIZE_INIT_PARMS(stas_stats, STATS_SIZE_32), NULL, 0);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    for (i = 0; i < STAS_NUM_WRITERS; i++) {
+        rc = os_task_init(&stas_tasks[i], "stats_writer", stas_writer,
+                          (void *)(intptr_t)i, STAS_WRITER_PRIO + i,
+                          OS_WAIT_FOREVER, stas_stacks[i], STAS_STACK_SIZE);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+
+    memset(totals, 0, sizeof totals);
+    memset(base, 0, sizeof base);
+    passes = 0;
+    while (stas_num_done < STAS_NUM_WRITERS) {
+        stas_drain(base, totals);
+        passes++;
+    }
+    stas_drain(base, totals);
+    passes++;
+
+    for (i = 0; i < STAS_NUM_WRITERS; i++) {
+        TEST_ASSERT(totals[i] == STAS_NUM_INCS);
+    }
+    TEST_ASSERT(totals[STAS_SHARED_IDX] == STAS_NUM_INCS * (1 + 2 + 3));
+    TEST_ASSERT(passes > 2);
+
+    TEST_ASSERT(stas_stats.sw0 == STAS_NUM_INCS);
+    TEST_ASSERT(stas_stats.sw1 == STAS_NUM_INCS);
+    TEST_ASSERT(stas_stats.sw2 == STAS_NUM_INCS);
+    TEST_ASSERT(stas_stats.sshared == STAS_NUM_INCS * (1 + 2 + 3));
+}
@@ -0,0 +1,192 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "stats_test.h"
+
+#define STD_NUM_ENTRIES     20
+
+STATS_SECT_START(std_stats)
+    STATS_SECT_ENTRY(e0)
+    STATS_SECT_ENTRY(e1)
+    STATS_SECT_ENTRY(e2)
+    STATS_SECT_ENTRY(e3)
+    STATS_SECT_ENTRY(e4)
+    STATS_SECT_ENTRY(e5)
+    STATS_SECT_ENTRY(e6)
+    STATS_SECT_ENTRY(e7)
+    STATS_SECT_ENTRY(e8)
+    STATS_SECT_ENTRY(e9)
+    STATS_SECT_ENTRY(e10)
+    STATS_SECT_ENTRY(e11)
+    STATS_SECT_ENTRY(e12)
+    STATS_SECT_ENTRY(e13)
+    STATS_SECT_ENTRY(e14)
+    STATS_SECT_ENTRY(e15)
+    STATS_SECT_ENTRY(e16)
+    STATS_SECT_ENTRY(e17)
+    STATS_SECT_ENTRY(e18)
+    STATS_SECT_ENTRY(e19)
+STATS_SECT_END
+
+STATS_SECT_START(std_stats16)
+    STATS_SECT_ENTRY16(a)
+STATS_SECT_END
+
+static STATS_SECT_DECL(std_stats) std_stats;
+static STATS_SECT_DECL(std_stats16) std_stats16;
+
+static uint32_t *
+std_vals(void)
+{
+    return (uint32_t *)(&std_stats.s_hdr + 1);
+}
+
+static void
+std_check_vals(const uint32_t *expected)
+{
+    int i;
+
+    for (i = 0; i < STD_NUM_ENTRIES; i++) {
+        TEST_ASSERT(std_vals()[i] == expected[i]);
+    }
+}
+
+TEST_CASE(stats_test_case_delta)
+{
+    uint32_t expected[STD_NUM_ENTRIES];
+    uint32_t totals[STD_NUM_ENTRIES];
+    uint32_t base[STD_NUM_ENTRIES];
+    uint32_t snap[STD_NUM_ENTRIES];
+    uint8_t buf[64];
+    int passes;
+    int len;
+    int rc;
+    int i;
+
+    sysinit();
+
+    rc = stats_init(STATS_HDR(std_stats),
+                    STATS_SIZE_INIT_PARMS(std_stats, STATS_SIZE_32), NULL, 0);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = stats_init(STATS_HDR(std_stats16),
+                    STATS_SIZE_INIT_PARMS(std_stats16, STATS_SIZE_16),
+                    NULL, 0);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT_FATAL(std_stats.s_hdr.s_cnt == STD_NUM_ENTRIES);
+
+    memset(base, 0, sizeof base);
+
+    /*** Nothing changed; nothing encoded. */
+    rc = stats_delta_encode(STATS_HDR(std_stats), base, buf, sizeof buf,
+                            &len);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(len == 0);
+
+    /*** Only changed entries are encoded; the counters are left alone. */
+    STATS_INC_ATOMIC(std_stats, e0);
+    STATS_INCN_ATOMIC(std_stats, e3, 200);
+    STATS_INCN_ATOMIC(std_stats, e19, 0xffffffff);
+
+    rc = stats_delta_encode(STATS_HDR(std_stats), base, buf, sizeof buf,
+                            &len);
+    TEST_ASSERT(rc == 0);
+
+    /* (1, 1), (3, 200 in two bytes), (16, 0xffffffff in five bytes). */
+    TEST_ASSERT(len == 2 + 3 + 6);
+
+    memset(totals, 0, sizeof totals);
+    rc = stu_delta_decode(buf, len, totals, STD_NUM_ENTRIES);
+    TEST_ASSERT(rc == 3);
+    TEST_ASSERT(totals[0] == 1);
+    TEST_ASSERT(totals[3] == 200);
+    TEST_ASSERT(totals[19] == 0xffffffff);
+    std_check_vals(totals);
+    TEST_ASSERT(memcmp(base, totals, sizeof base) == 0);
+
+    /*** The next delta only reports what changed since the baseline. */
+    STATS_INCN_ATOMIC(std_stats, e3, 5);
+
+    rc = stats_delta_encode(STATS_HDR(std_stats), base, buf, sizeof buf,
+                            &len);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(len == 2);
+    TEST_ASSERT(buf[0] == 4 && buf[1] == 5);
+    TEST_ASSERT(std_stats.se3 == 205);
+
+    /*** A counter that wraps reports the increments past the wrap. */
+    STATS_INCN_ATOMIC(std_stats, e3, 0xfffffffe - 205);
+
+    rc = stats_delta_encode(STATS_HDR(std_stats), base, buf, sizeof buf,
+                            &len);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(base[3] == 0xfffffffe);
+
+    STATS_INCN_ATOMIC(std_stats, e3, 5);
+    TEST_ASSERT(std_stats.se3 == 3);
+
+    rc = stats_delta_encode(STATS_HDR(std_stats), base, buf, sizeof buf,
+                            &len);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(len == 2);
+    TEST_ASSERT(buf[0] == 4 && buf[1] == 5);
+    TEST_ASSERT(base[3] == 3);
+
+    /*** A small buffer takes several calls; no counts are lost. */
+    stats_reset(STATS_HDR(std_stats));
+    memset(base, 0, sizeof base);
+    memset(expected, 0, sizeof expected);
+    for (i = 0; i < STD_NUM_ENTRIES; i++) {
+        expected[i] = i * 1000 + 1;
+        std_vals()[i] = expected[i];
+    }
+
+    memset(totals, 0, sizeof totals);
+    passes = 0;
+    do {
+        rc = stats_delta_encode(STATS_HDR(std_stats), base, buf, 5, &len);
+        TEST_ASSERT_FATAL(rc == 0 || rc == SYS_EAGAIN);
+        TEST_ASSERT_FATAL(stu_delta_decode(buf, len, totals,
+                                           STD_NUM_ENTRIES) >= 0);
+        passes++;
+        TEST_ASSERT_FATAL(passes <= STD_NUM_ENTRIES + 1);
+    } while (rc == SYS_EAGAIN);
+
+    TEST_ASSERT(passes > 1);
+    TEST_ASSERT(memcmp(totals, expected, sizeof totals) == 0);
+    std_check_vals(expected);
+
+    /*** Snapshot-and-reset. */
+    stats_reset(STATS_HDR(std_stats));
+    STATS_INCN_ATOMIC(std_stats, e1, 7);
+    STATS_INC_ATOMIC(std_stats, e2);
+    rc = stats_snapshot_reset(STATS_HDR(std_stats), snap, STD_NUM_ENTRIES);
+    TEST_ASSERT(rc == STD_NUM_ENTRIES);
+    TEST_ASSERT(snap[0] == 0);
+    TEST_ASSERT(snap[1] == 7);
+    TEST_ASSERT(snap[2] == 1);
+    memset(expected, 0, sizeof expected);
+    std_check_vals(expected);
+
+    /*** Only 32-bit sections are supported. */
+    rc = stats_delta_encode(STATS_HDR(std_stats16), base, buf, sizeof buf,
+                            &len);
+    TEST_ASSERT(rc == SYS_EINVAL);
+    rc = stats_snapshot_reset(STATS_HDR(std_stats16), snap, 1);
+    TEST_ASSERT(rc == SYS_EINVAL);
+}
@@ -25,11 +25,20 @@
 extern "C" {
 #endif
 
+/** Entry space is reserved, but its contents are still being written. */
+#define CBMEM_ENTRY_F_BUSY      0x8000
+
+/** Multi-producer cbmems keep a sequence number in the low flag bits. */
+#define CBMEM_ENTRY_SEQ_MASK    0x7fff
+
 struct cbmem_entry_hdr {
     uint16_t ceh_len;
     uint16_t ceh_flags;
 } __attribute__((packed));
 
+/** Appends do not take the lock; see cbmem_init_mp(). */
+#define CBMEM_F_MP              0x01
+
 struct cbmem {
     struct os_mutex c_lock;
 
@@ -38,12 +47,30 @@ struct cbmem {
     uint8_t *c_buf;
     uint8_t *c_buf_end;
     uint8_t *c_buf_cur_end;
+
+    uint8_t c_flags;
+
+    /* Multi-producer only. */
+    uint8_t c_num_busy;
+    uint32_t c_drops;
+
+    /* Sequence numbers of the next entry and of the oldest entry. */
+    uint32_t c_seq;
+    uint32_t c_start_seq;
+
+    /* The entry an iterator returned last, for validating reads. */
+    struct cbmem_entry_hdr *c_read_hdr;
+    uint32_t c_read_seq;
 };
 
 struct cbmem_iter {
     struct cbmem_entry_hdr *ci_start;
     struct cbmem_entry_hdr *ci_cur;
     struct cbmem_entry_hdr *ci_end;
+
+    /* Multi-producer only. */
+    uint32_t ci_seq;
+    uint32_t ci_end_seq;
 };
 
 /**
@@ -78,6 +105,34 @@ typedef int (*cbmem_walk_func_t)(struct cbmem *, struct cbmem_entry_hdr *,
 int cbmem_lock_acquire(struct cbmem *cbmem);
 int cbmem_lock_release(struct cbmem *cbmem);
 int cbmem_init(struct cbmem *cbmem, void *buf, uint32_t buf_len);
+
+/**
+ * @brief Initializes a multi-producer cbmem.
+ *
+ * Appends to a multi-producer cbmem never block, so they can be made from
+ * interrupt context and from any number of tasks at once.  A writer
+ * reserves space for its entry in a short critical section and copies the
+ * data with interrupts enabled; the entry is marked busy until the copy is
+ * done, and iterators skip it until then.  An append that would overwrite
+ * an entry that is still being written is dropped (see cbmem_drops()).
+ *
+ * Reads, walks and flushes still take the cbmem lock, and must be done
+ * from task context.  A read of an entry that is overwritten while it is
+ * being copied fails.
+ *
+ * @param cbmem                 The cbmem to initialize.
+ * @param buf                   Backing storage for entries.
+ * @param buf_len               Size of the backing storage, in bytes.
+ *
+ * @return                      0 on success; nonzero on failure.
+ */
+int cbmem_init_mp(struct cbmem *cbmem, void *buf, uint32_t buf_len);
+
+/**
+ * @brief Returns the number of appends a multi-producer cbmem has dropped.
+ */
+uint32_t cbmem_drops(const struct cbmem *cbmem);
+
 int cbmem_append(struct cbmem *cbmem, void *data, uint16_t len);
 int cbmem_append_mbuf(struct cbmem *cbmem, const struct os_mbuf *om);
 
@@ -35,6 +35,27 @@ cbmem_init(struct cbmem *cbmem, void *buf, uint32_t buf_len)
     return (0);
 }
 
+int
+cbmem_init_mp(struct cbmem *cbmem, void *buf, uint32_t buf_len)
+{
+    int rc;
+
+    rc = cbmem_init(cbmem, buf, buf_len);
+    if (rc != 0) {
+        return rc;
+    }
+
+    cbmem->c_flags = CBMEM_F_MP;
+
+    return (0);
+}
+
+uint32_t
+cbmem_drops(const struct cbmem *cbmem)
+{
+    return cbmem->c_drops;
+}
+
 int
 cbmem_lock_acquire(struct cbmem *cbmem)
 {
@@ -74,20 +95,94 @@ err:
 }
 
 
+#define CBMEM_IS_MP(cbmem_)         ((cbmem_)->c_flags & CBMEM_F_MP)
+
+/**
+ * Indicates whether the entry with the given sequence number has not been
+ * discarded yet.  Must be called with interrupts disabled.
+ */
+static bool
+cbmem_seq_retained(const struct cbmem *cbmem, uint32_t seq)
+{
+    return cbmem->c_entry_start != NULL &&
+           (int32_t)(seq - cbmem->c_start_seq) >= 0;
+}
+
+/**
+ * Indicates whether any entry in [hdr, stop) is still being written.
+ */
+static bool
+cbmem_range_busy(const struct cbmem_entry_hdr *hdr, const uint8_t *stop)
+{
+    while ((const uint8_t *) hdr < stop) {
+        if (hdr->ceh_flags & CBMEM_ENTRY_F_BUSY) {
+            return true;
+        }
+        hdr = CBMEM_ENTRY_NEXT(hdr);
+    }
+
+    return false;
+}
+
 static int
-cbmem_append_internal(struct cbmem *cbmem, const void *data, uint16_t len,
-                      copy_data_func_t *copy_func)
+cbmem_range_count(const struct cbmem_entry_hdr *hdr, const uint8_t *stop)
+{
+    int count;
+
+    count = 0;
+    while ((const uint8_t *) hdr < stop) {
+        hdr = CBMEM_ENTRY_NEXT(hdr);
+        count++;
+    }
+
+    return count;
+}
+
+/**
+ * Indicates whether hdr points into the range of retained entries.  Must be
+ * called with interrupts disabled for multi-producer cbmems.
+ */
+static bool
+cbmem_entry_live(const struct cbmem *cbmem, const struct cbmem_entry_hdr *hdr)
+{
+    if (cbmem->c_entry_start == NULL) {
+        return false;
+    }
+
+    if (cbmem->c_entry_start <= cbmem->c_entry_end) {
+        return hdr >= cbmem->c_entry_start && hdr <= cbmem->c_entry_end;
+    }
+
+    return (hdr >= cbmem->c_entry_start &&
+            (uint8_t *) hdr < cbmem->c_buf_cur_end) ||
+           hdr <= cbmem->c_entry_end;
+}
+
+/**
+ * Reserves space for a new entry, discarding the oldest entries as
+ * necessary.  The cbmem is not modified on failure.  Must be called with
+ * the lock held, or with interrupts disabled for multi-producer cbmems.
+ */
+static int
+cbmem_reserve(struct cbmem *cbmem, uint16_t len,
+              struct cbmem_entry_hdr **out_dst)
 {
     struct cbmem_entry_hdr *dst;
+    uint8_t *buf_cur_end;
     uint8_t *start;
     uint8_t *end;
-    int rc;
+    int discarded;
+    bool mp;
 
-    rc = cbmem_lock_acquire(cbmem);
-    if (rc != 0) {
-        goto err;
+    if (sizeof(*dst) + len > cbmem->c_buf_end - cbmem->c_buf) {
+        return (SYS_ENOMEM);
     }
 
+    mp = CBMEM_IS_MP(cbmem);
+    discarded = 0;
+    buf_cur_end = cbmem->c_buf_cur_end;
+    start = (uint8_t *) cbmem->c_entry_start;
+
     if (cbmem->c_entry_end) {
         dst = CBMEM_ENTRY_NEXT(cbmem->c_entry_end);
     } else {
@@ -99,11 +194,18 @@ cbmem_append_internal(struct cbmem *cbmem, const void *data, uint16_t len,
      * the item to the beginning of the buffer.
      */
     if (end > cbmem->c_buf_end) {
-        cbmem->c_buf_cur_end = (uint8_t *) dst;
+        buf_cur_end = (uint8_t *) dst;
         dst = (struct cbmem_entry_hdr *) cbmem->c_buf;
         end = (uint8_t *) dst + len + sizeof(*dst);
-        if ((uint8_t *) cbmem->c_entry_start >= cbmem->c_buf_cur_end) {
-            cbmem->c_entry_start = (struct cbmem_entry_hdr *) cbmem->c_buf;
+        if (start >= buf_cur_end) {
+            /* The entries past the new end are discarded. */
+            if (mp && cbmem_range_busy((struct cbmem_entry_hdr *) start,
+                                       cbmem->c_buf_cur_end)) {
+                return (SYS_EBUSY);
+            }
+            discarded = cbmem_range_count((struct cbmem_entry_hdr *) start,
+                                          cbmem->c_buf_cur_end);
+            start = cbmem->c_buf;
         }
     }
 
@@ -111,28 +213,101 @@ cbmem_append_internal(struct cbmem *cbmem, const void *data, uint16_t len,
      * start of the buffer, move start forward until you don't overwrite it
      * anymore.
      */
-    start = (uint8_t *) cbmem->c_entry_start;
     if (start && (uint8_t *) dst < start + CBMEM_ENTRY_SIZE(start) &&
             end > start) {
         while (start < end) {
+            if (mp && ((struct cbmem_entry_hdr *) start)->ceh_flags &
+                      CBMEM_ENTRY_F_BUSY) {
+                return (SYS_EBUSY);
+            }
             start = (uint8_t *) CBMEM_ENTRY_NEXT(start);
-            if (start == cbmem->c_buf_cur_end) {
+            discarded++;
+            if (start == buf_cur_end) {
                 start = cbmem->c_buf;
                 break;
             }
         }
+    }
+
+    cbmem->c_buf_cur_end = buf_cur_end;
+    if (start) {
         cbmem->c_entry_start = (struct cbmem_entry_hdr *) start;
+        cbmem->c_start_seq += discarded;
+    } else {
+        cbmem->c_entry_start = dst;
+        cbmem->c_start_seq = cbmem->c_seq;
+    }
+    cbmem->c_seq++;
+
+    *out_dst = dst;
+    return (0);
+}
+
+static int
+cbmem_append_mp(struct cbmem *cbmem, const void *data, uint16_t len,
+                copy_data_func_t *copy_func)
+{
+    struct cbmem_entry_hdr *dst;
+    os_sr_t sr;
+    int rc;
+
+    OS_ENTER_CRITICAL(sr);
+    rc = cbmem_reserve(cbmem, len, &dst);
+    if (rc != 0) {
+        cbmem->c_drops++;
+        OS_EXIT_CRITICAL(sr);
+        return (rc);
+    }
+
+    dst->ceh_len = len;
+    dst->ceh_flags = CBMEM_ENTRY_F_BUSY |
+                     ((cbmem->c_seq - 1) & CBMEM_ENTRY_SEQ_MASK);
+    cbmem->c_entry_end = dst;
+    cbmem->c_num_busy++;
+    OS_EXIT_CRITICAL(sr);
+
+    /* Other writers can reserve entries, and readers can skip this one,
+     * while it is being filled in.
+     */
+    copy_func((uint8_t *) dst + sizeof(*dst), data, len);
+
+    OS_ENTER_CRITICAL(sr);
+    dst->ceh_flags &= ~CBMEM_ENTRY_F_BUSY;
+    cbmem->c_num_busy--;
+    OS_EXIT_CRITICAL(sr);
+
+    return (0);
+}
+
+static int
+cbmem_append_internal(struct cbmem *cbmem, const void *data, uint16_t len,
+                      copy_data_func_t *copy_func)
+{
+    struct cbmem_entry_hdr *dst;
+    int rc;
+
+    if (CBMEM_IS_MP(cbmem)) {
+        return cbmem_append_mp(cbmem, data, len, copy_func);
+    }
+
+    rc = cbmem_lock_acquire(cbmem);
+    if (rc != 0) {
+        goto err;
+    }
+
+    rc = cbmem_reserve(cbmem, len, &dst);
+    if (rc != 0) {
+        cbmem_lock_release(cbmem);
+        goto err;
     }
 
     /* Copy the entry into the log
      */
     dst->ceh_len = len;
+    dst->ceh_flags = 0;
     copy_func((uint8_t *) dst + sizeof(*dst), data, len);
 
     cbmem->c_entry_end = dst;
-    if (!cbmem->c_entry_start) {
-        cbmem->c_entry_start = dst;
-    }
 
     rc = cbmem_lock_release(cbmem);
     if (rc != 0) {
@@ -226,9 +401,69 @@ cbmem_append_scat_gath(struct cbmem *cbmem, const struct cbmem_scat_gath *sg)
 void
 cbmem_iter_start(struct cbmem *cbmem, struct cbmem_iter *iter)
 {
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+
     iter->ci_start = cbmem->c_entry_start;
     iter->ci_cur = cbmem->c_entry_start;
     iter->ci_end = cbmem->c_entry_end;
+
+    if (CBMEM_IS_MP(cbmem)) {
+        iter->ci_seq = cbmem->c_start_seq;
+        iter->ci_end_seq = cbmem->c_seq - 1;
+    }
+
+    OS_EXIT_CRITICAL(sr);
+}
+
+/**
+ * Iterates a multi-producer cbmem.  Entries that are still being written
+ * are skipped.  If writers discard the iterator's position between calls,
+ * iteration resumes at the oldest remaining entry.  Iteration stops after
+ * the entry that was newest when the iterator was started.
+ */
+static struct cbmem_entry_hdr *
+cbmem_iter_next_mp(struct cbmem *cbmem, struct cbmem_iter *iter)
+{
+    struct cbmem_entry_hdr *hdr;
+    bool busy;
+    os_sr_t sr;
+
+    do {
+        OS_ENTER_CRITICAL(sr);
+
+        if (!cbmem_seq_retained(cbmem, iter->ci_seq)) {
+            iter->ci_cur = cbmem->c_entry_start;
+            iter->ci_seq = cbmem->c_start_seq;
+        }
+
+        hdr = iter->ci_cur;
+        if (hdr == NULL || (int32_t)(iter->ci_seq - iter->ci_end_seq) > 0) {
+            iter->ci_cur = NULL;
+            OS_EXIT_CRITICAL(sr);
+            return NULL;
+        }
+
+        /* c_buf_cur_end is only meaningful while the entries wrap. */
+        iter->ci_cur = CBMEM_ENTRY_NEXT(hdr);
+        if (cbmem->c_entry_start > cbmem->c_entry_end &&
+            (uint8_t *) iter->ci_cur == cbmem->c_buf_cur_end) {
+
+            iter->ci_cur = (struct cbmem_entry_hdr *) cbmem->c_buf;
+        }
+
+        busy = hdr->ceh_flags & CBMEM_ENTRY_F_BUSY;
+        if (!busy) {
+            cbmem->c_read_hdr = hdr;
+            cbmem->c_read_seq = iter->ci_seq;
+        }
+        iter->ci_seq++;
+
+        OS_EXIT_CRITICAL(sr);
+    } while (busy);
+
+    return hdr;
 }
 
 struct cbmem_entry_hdr *
@@ -236,6 +471,10 @@ cbmem_iter_next(struct cbmem *cbmem, struct cbmem_iter *iter)
 {
     struct cbmem_entry_hdr *hdr;
 
+    if (CBMEM_IS_MP(cbmem)) {
+        return cbmem_iter_next_mp(cbmem, iter);
+    }
+
     if (iter->ci_start > iter->ci_end) {
         hdr = iter->ci_cur;
         iter->ci_cur = CBMEM_ENTRY_NEXT(iter->ci_cur);
@@ -264,6 +503,7 @@ err:
 int
 cbmem_flush(struct cbmem *cbmem)
 {
+    os_sr_t sr;
     int rc;
 
     rc = cbmem_lock_acquire(cbmem);
@@ -271,9 +511,23 @@ cbmem_flush(struct cbmem *cbmem)
         goto err;
     }
 
-    cbmem->c_entry_start = NULL;
-    cbmem->c_entry_end = NULL;
-    cbmem->c_buf_cur_end = NULL;
+    OS_ENTER_CRITICAL(sr);
+    if (cbmem->c_num_busy != 0) {
+        /* A writer is still filling in an entry in the buffer. */
+        rc = SYS_EBUSY;
+    } else {
+        cbmem->c_entry_start = NULL;
+        cbmem->c_entry_end = NULL;
+        cbmem->c_buf_cur_end = NULL;
+        cbmem->c_start_seq = cbmem->c_seq;
+        cbmem->c_read_hdr = NULL;
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    if (rc != 0) {
+        cbmem_lock_release(cbmem);
+        goto err;
+    }
 
     rc = cbmem_lock_release(cbmem);
     if (rc != 0) {
@@ -285,10 +539,82 @@ err:
     return (rc);
 }
 
+/**
+ * Indicates whether a multi-producer entry is still retained.  The entry an
+ * iterator returned last is checked by sequence number; any other entry is
+ * only checked against the range of retained entries.  Must be called with
+ * interrupts disabled.
+ */
+static bool
+cbmem_entry_valid(const struct cbmem *cbmem, const struct cbmem_entry_hdr *hdr)
+{
+    if (hdr == cbmem->c_read_hdr) {
+        return cbmem_seq_retained(cbmem, cbmem->c_read_seq);
+    } else {
+        return cbmem_entry_live(cbmem, hdr);
+    }
+}
+
+/**
+ * Copies the header of an entry that is about to be read.  Fails if the
+ * entry of a multi-producer cbmem is no longer retained or is still being
+ * written.
+ */
+static int
+cbmem_entry_snapshot(struct cbmem *cbmem, const struct cbmem_entry_hdr *hdr,
+                     struct cbmem_entry_hdr *out_hdr)
+{
+    os_sr_t sr;
+    int rc;
+
+    if (!CBMEM_IS_MP(cbmem)) {
+        *out_hdr = *hdr;
+        return (0);
+    }
+
+    OS_ENTER_CRITICAL(sr);
+    if (!cbmem_entry_valid(cbmem, hdr) ||
+        hdr->ceh_flags & CBMEM_ENTRY_F_BUSY) {
+
+        rc = -1;
+    } else {
+        *out_hdr = *hdr;
+        rc = 0;
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    return (rc);
+}
+
+/**
+ * Indicates whether an entry read after cbmem_entry_snapshot() was left
+ * intact by concurrent writers.
+ */
+static bool
+cbmem_entry_unchanged(struct cbmem *cbmem, const struct cbmem_entry_hdr *hdr,
+                      const struct cbmem_entry_hdr *snap)
+{
+    bool unchanged;
+    os_sr_t sr;
+
+    if (!CBMEM_IS_MP(cbmem)) {
+        return true;
+    }
+
+    OS_ENTER_CRITICAL(sr);
+    unchanged = cbmem_entry_valid(cbmem, hdr) &&
+                hdr->ceh_len == snap->ceh_len &&
+                hdr->ceh_flags == snap->ceh_flags;
+    OS_EXIT_CRITICAL(sr);
+
+    return unchanged;
+}
+
 int
 cbmem_read(struct cbmem *cbmem, struct cbmem_entry_hdr *hdr, void *buf,
         uint16_t off, uint16_t len)
 {
+    struct cbmem_entry_hdr snap;
     int rc;
 
     rc = cbmem_lock_acquire(cbmem);
@@ -296,14 +622,20 @@ cbmem_read(struct cbmem *cbmem, struct cbmem_entry_hdr *hdr, void *buf,
         goto err;
     }
 
+    rc = cbmem_entry_snapshot(cbmem, hdr, &snap);
+    if (rc != 0) {
+        cbmem_lock_release(cbmem);
+        goto err;
+    }
+
     /* Only read the maximum number of bytes, if we exceed that,
      * truncate the read.
      */
-    if (off + len > hdr->ceh_len) {
-        len = hdr->ceh_len - off;
+    if (off + len > snap.ceh_len) {
+        len = snap.ceh_len - off;
     }
 
-    if (off > hdr->ceh_len) {
+    if (off > snap.ceh_len) {
         rc = -1;
         cbmem_lock_release(cbmem);
         goto err;
@@ -311,6 +643,11 @@ cbmem_read(struct cbmem *cbmem, struct cbmem_entry_hdr *hdr, void *buf,
 
     memcpy(buf, (uint8_t *) hdr + sizeof(*hdr) + off, len);
 
+    if (!cbmem_entry_unchanged(cbmem, hdr, &snap)) {
+        cbmem_lock_release(cbmem);
+        goto err;
+    }
+
     rc = cbmem_lock_release(cbmem);
     if (rc != 0) {
         goto err;
@@ -324,6 +661,7 @@ err:
 int cbmem_read_mbuf(struct cbmem *cbmem, struct cbmem_entry_hdr *hdr,
                     struct os_mbuf *om, uint16_t off, uint16_t len)
 {
+    struct cbmem_entry_hdr snap;
     int rc;
 
     rc = cbmem_lock_acquire(cbmem);
@@ -331,14 +669,20 @@ int cbmem_read_mbuf(struct cbmem *cbmem, struct cbmem_entry_hdr *hdr,
         goto err;
     }
 
+    rc = cbmem_entry_snapshot(cbmem, hdr, &snap);
+    if (rc != 0) {
+        cbmem_lock_release(cbmem);
+        goto err;
+    }
+
     /* Only read the maximum number of bytes, if we exceed that,
      * truncate the read.
      */
-    if (off + len > hdr->ceh_len) {
-        len = hdr->ceh_len - off;
+    if (off + len > snap.ceh_len) {
+        len = snap.ceh_len - off;
     }
 
-    if (off > hdr->ceh_len) {
+    if (off > snap.ceh_len) {
         rc = -1;
         cbmem_lock_release(cbmem);
         goto err;
@@ -350,6 +694,13 @@ int cbmem_read_mbuf(struct cbmem *cbmem, struct cbmem_entry_hdr *hdr,
         goto err;
     }
 
+    if (!cbmem_entry_unchanged(cbmem, hdr, &snap)) {
+        /* The caller's mbuf now holds the garbled bytes; drop them. */
+        os_mbuf_adj(om, -len);
+        cbmem_lock_release(cbmem);
+        goto err;
+    }
+
     cbmem_lock_release(cbmem);
 
     return (len);
@@ -0,0 +1,121 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "cbmem_test.h"
+
+#define CTMP_BUF_SIZE       256
+#define CTMP_ENTRY_SIZE     12
+
+static uint8_t ctmp_buf[CTMP_BUF_SIZE];
+
+static int
+ctmp_count(struct cbmem *cbmem)
+{
+    struct cbmem_iter iter;
+    int count;
+
+    count = 0;
+    cbmem_iter_start(cbmem, &iter);
+    while (cbmem_iter_next(cbmem, &iter) != NULL) {
+        count++;
+    }
+
+    return count;
+}
+
+TEST_CASE(cbmem_test_case_mp)
+{
+    struct cbmem_entry_hdr *busy;
+    struct cbmem cbmem;
+    uint8_t entry[CTMP_ENTRY_SIZE];
+    uint8_t byte;
+    int num_entries;
+    int rc;
+    int i;
+
+    rc = cbmem_init_mp(&cbmem, ctmp_buf, sizeof ctmp_buf);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /* Overflow the buffer; ensure the oldest entries are discarded as with
+     * a locked cbmem.
+     */
+    memset(entry, 0, sizeof entry);
+    for (i = 0; i < 40; i++) {
+        entry[0] = i;
+        rc = cbmem_append(&cbmem, entry, sizeof entry);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+
+    num_entries = CTMP_BUF_SIZE /
+                  (sizeof (struct cbmem_entry_hdr) + CTMP_ENTRY_SIZE);
+    TEST_ASSERT(ctmp_count(&cbmem) == num_entries);
+
+    byte = 40 - num_entries;
+    rc = cbmem_walk(&cbmem, cbmem_test_case_1_walk, &byte);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(byte == 40);
+
+    /* Simulate a writer that was preempted while filling in the newest
+     * entry.
+     */
+    busy = cbmem.c_entry_end;
+    busy->ceh_flags |= CBMEM_ENTRY_F_BUSY;
+    cbmem.c_num_busy++;
+
+    /* Ensure readers skip it and cannot read it. */
+    TEST_ASSERT(ctmp_count(&cbmem) == num_entries - 1);
+    rc = cbmem_read(&cbmem, busy, &byte, 0, 1);
+    TEST_ASSERT(rc == -1);
+
+    /* Ensure it can't be flushed away. */
+    rc = cbmem_flush(&cbmem);
+    TEST_ASSERT(rc == SYS_EBUSY);
+
+    /* Wrap around until the busy entry is next to be overwritten; ensure
+     * appends are dropped rather than overwrite it.
+     */
+    for (i = 0; i < num_entries - 1; i++) {
+        rc = cbmem_append(&cbmem, entry, sizeof entry);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+    rc = cbmem_append(&cbmem, entry, sizeof entry);
+    TEST_ASSERT(rc == SYS_EBUSY);
+    TEST_ASSERT(cbmem_drops(&cbmem) == 1);
+
+    /* Complete the write; ensure the entry is visible and the buffer can be
+     * appended to again.
+     */
+    busy->ceh_flags &= ~CBMEM_ENTRY_F_BUSY;
+    cbmem.c_num_busy--;
+
+    TEST_ASSERT(ctmp_count(&cbmem) == num_entries);
+    rc = cbmem_read(&cbmem, busy, &byte, 0, 1);
+    TEST_ASSERT(rc == 1);
+    TEST_ASSERT(byte == 39);
+
+    rc = cbmem_append(&cbmem, entry, sizeof entry);
+    TEST_ASSERT(rc == 0);
+
+    rc = cbmem_flush(&cbmem);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(ctmp_count(&cbmem) == 0);
+
+    /* Ensure an entry that does not fit in the buffer is rejected. */
+    rc = cbmem_append(&cbmem, ctmp_buf, sizeof ctmp_buf);
+    TEST_ASSERT(rc == SYS_ENOMEM);
+}
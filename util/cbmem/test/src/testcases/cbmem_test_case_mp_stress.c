@@ -0,0 +1,249 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "cbmem_test.h"
+
+/*
+ * Several tasks append to a small multi-producer cbmem at different
+ * priorities, so that writers are preempted in the middle of appends, while
+ * the test task walks the buffer and checks every entry it can read.
+ */
+
+#define CTMS_NUM_WRITERS        3
+#define CTMS_WRITER_PRIO        10
+#define CTMS_STACK_SIZE         1024
+#define CTMS_NUM_APPENDS        5000
+#define CTMS_BUF_SIZE           1024
+#define CTMS_DATA_MAX_LEN       40
+
+#define CTMS_BENCH_ROUNDS       4096
+
+struct ctms_entry {
+    uint8_t writer;
+    uint8_t pad;
+    uint16_t seq;
+    uint8_t data[CTMS_DATA_MAX_LEN];
+};
+
+struct ctms_walk_arg {
+    int32_t last_seq[CTMS_NUM_WRITERS];
+    int num_valid;
+    int num_lost;
+};
+
+static struct cbmem ctms_cbmem;
+static uint8_t ctms_buf[CTMS_BUF_SIZE];
+
+static struct os_task ctms_tasks[CTMS_NUM_WRITERS];
+static os_stack_t ctms_stacks[CTMS_NUM_WRITERS][CTMS_STACK_SIZE];
+
+static uint32_t ctms_drops[CTMS_NUM_WRITERS];
+static int ctms_num_errors;
+static int ctms_num_done;
+
+static int
+ctms_fill(struct ctms_entry *entry, int writer, int seq)
+{
+    int data_len;
+    int i;
+
+    data_len = (seq * 7 + writer) % CTMS_DATA_MAX_LEN;
+
+    entry->writer = writer;
+    entry->pad = 0;
+    entry->seq = seq;
+    for (i = 0; i < data_len; i++) {
+        entry->data[i] = writer * 31 + seq + i;
+    }
+
+    return offsetof(struct ctms_entry, data) + data_len;
+}
+
+static bool
+ctms_entry_valid(const struct ctms_entry *entry, int len)
+{
+    struct ctms_entry expected;
+    int expected_len;
+
+    if (len < offsetof(struct ctms_entry, data) ||
+        entry->writer >= CTMS_NUM_WRITERS) {
+
+        return false;
+    }
+
+    expected_len = ctms_fill(&expected, entry->writer, entry->seq);
+    return len == expected_len && memcmp(entry, &expected, len) == 0;
+}
+
+static void
+ctms_writer(void *arg)
+{
+    struct ctms_entry entry;
+    os_sr_t sr;
+    int writer;
+    int len;
+    int rc;
+    int i;
+
+    writer = (intptr_t)arg;
+
+    for (i = 0; i < CTMS_NUM_APPENDS; i++) {
+        len = ctms_fill(&entry, writer, i);
+        rc = cbmem_append(&ctms_cbmem, &entry, len);
+        if (rc == SYS_EBUSY) {
+            ctms_drops[writer]++;
+        } else if (rc != 0) {
+            ctms_num_errors++;
+        }
+
+        /* Sleep at different rates so the writers preempt one another. */
+        if (i % (16 + 8 * writer) == 0) {
+            os_time_delay(1);
+        }
+    }
+
+    OS_ENTER_CRITICAL(sr);
+    ctms_num_done++;
+    OS_EXIT_CRITICAL(sr);
+
+    while (1) {
+        os_time_delay(OS_TICKS_PER_SEC);
+    }
+}
+
+static int
+ctms_walk(struct cbmem *cbmem, struct cbmem_entry_hdr *hdr, void *arg)
+{
+    struct ctms_walk_arg *cwa;
+    struct ctms_entry entry;
+    int rc;
+
+    cwa = arg;
+
+    rc = cbmem_read(cbmem, hdr, &entry, 0, sizeof entry);
+    if (rc < 0) {
+        /* Overwritten while being read. */
+        cwa->num_lost++;
+        return 0;
+    }
+
+    TEST_ASSERT_FATAL(ctms_entry_valid(&entry, rc));
+
+    /* Each writer's entries must be seen in the order they were written. */
+    TEST_ASSERT_FATAL(entry.seq > cwa->last_seq[entry.writer]);
+    cwa->last_seq[entry.writer] = entry.seq;
+
+    cwa->num_valid++;
+
+    return 0;
+}
+
+static void
+ctms_check(struct ctms_walk_arg *cwa)
+{
+    int rc;
+    int i;
+
+    memset(cwa, 0, sizeof *cwa);
+    for (i = 0; i < CTMS_NUM_WRITERS; i++) {
+        cwa->last_seq[i] = -1;
+    }
+
+    rc = cbmem_walk(&ctms_cbmem, ctms_walk, cwa);
+    TEST_ASSERT_FATAL(rc == 0);
+}
+
+/**
+ * @return                      Time per append, in nanoseconds.
+ */
+static uint32_t
+ctms_bench(struct cbmem *cbmem)
+{
+    struct ctms_entry entry;
+    uint32_t start;
+    uint32_t usecs;
+    int len;
+    int rc;
+    int i;
+
+    len = ctms_fill(&entry, 0, 32);
+
+    start = os_cputime_get32();
+    for (i = 0; i < CTMS_BENCH_ROUNDS; i++) {
+        rc = cbmem_append(cbmem, &entry, len);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+    usecs = os_cputime_ticks_to_usecs(os_cputime_get32() - start);
+
+    return (uint64_t)usecs * 1000 / CTMS_BENCH_ROUNDS;
+}
+
+TEST_CASE_TASK(cbmem_test_case_mp_stress)
+{
+    struct ctms_walk_arg cwa;
+    uint32_t drops;
+    int num_walks;
+    int rc;
+    int i;
+
+    rc = cbmem_init_mp(&ctms_cbmem, ctms_buf, sizeof ctms_buf);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    for (i = 0; i < CTMS_NUM_WRITERS; i++) {
+        rc = os_task_init(&ctms_tasks[i], "cbmem_writer", ctms_writer,
+                          (void *)(intptr_t)i, CTMS_WRITER_PRIO + i,
+                          OS_WAIT_FOREVER, ctms_stacks[i], CTMS_STACK_SIZE);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+
+    /* Walk the buffer while the writers are running. */
+    num_walks = 0;
+    while (ctms_num_done < CTMS_NUM_WRITERS) {
+        ctms_check(&cwa);
+        num_walks++;
+    }
+
+    TEST_ASSERT(ctms_num_errors == 0);
+    TEST_ASSERT(ctms_cbmem.c_num_busy == 0);
+
+    drops = 0;
+    for (i = 0; i < CTMS_NUM_WRITERS; i++) {
+        drops += ctms_drops[i];
+    }
+    TEST_ASSERT(cbmem_drops(&ctms_cbmem) == drops);
+
+    /* Once the writers are done, every retained entry must be readable. */
+    ctms_check(&cwa);
+    TEST_ASSERT(cwa.num_valid > 0);
+    TEST_ASSERT(cwa.num_lost == 0);
+
+    printf("cbmem mp stress: %d walks, %lu drops\n",
+           num_walks, (unsigned long)drops);
+
+    /*** Compare append latency with the locked cbmem. */
+
+    rc = cbmem_init(&ctms_cbmem, ctms_buf, sizeof ctms_buf);
+    TEST_ASSERT_FATAL(rc == 0);
+    printf("cbmem locked append: %lu ns\n",
+           (unsigned long)ctms_bench(&ctms_cbmem));
+
+    rc = cbmem_init_mp(&ctms_cbmem, ctms_buf, sizeof ctms_buf);
+    TEST_ASSERT_FATAL(rc == 0);
+    printf("cbmem mp append: %lu ns\n",
+           (unsigned long)ctms_bench(&ctms_cbmem));
+}
@@ -0,0 +1,45 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef _UTIL_CRC_HW_H_
+#define _UTIL_CRC_HW_H_
+
+#include <inttypes.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Hooks for an MCU CRC peripheral.  With CRC_HW enabled, crc16_ccitt() and
+ * crc32_calc() offer buffers of at least CRC_HW_MIN_LEN bytes to these
+ * functions, which the MCU package implements.  The arguments and result
+ * are as for the software functions.  Each returns 0 if the peripheral
+ * computed the CRC, or nonzero to leave it to software; e.g., when the
+ * peripheral is in use or the buffer is not suitably aligned for DMA.
+ */
+int crc_hw_crc16_ccitt(uint16_t initial_crc, const void *buf, int len,
+                       uint16_t *out_crc);
+int crc_hw_crc32(uint32_t crc, const void *buf, int len, uint32_t *out_crc);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
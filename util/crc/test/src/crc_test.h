@@ -0,0 +1,49 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_CRC_TEST_
+#define H_CRC_TEST_
+
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Bit-at-a-time versions of each CRC, straight from the definitions, to
+ * check the table-driven ones against and to measure them against.
+ */
+uint8_t crc_test_ref_crc8(uint8_t crc, const void *buf, int len);
+uint16_t crc_test_ref_crc16(uint16_t crc, const void *buf, int len);
+uint32_t crc_test_ref_crc32(uint32_t crc, const void *buf, int len);
+
+void crc_test_util_fill(uint8_t *buf, int len, uint32_t seed);
+
+TEST_SUITE_DECL(crc_test_suite);
+TEST_CASE_DECL(crc_test_case_check);
+TEST_CASE_DECL(crc_test_case_slice);
+TEST_CASE_DECL(crc_test_case_bench);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,110 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include "os/mynewt.h"
+#include "crc/crc8.h"
+#include "crc/crc16.h"
+#include "crc/crc32.h"
+#include "crc_test.h"
+
+#define CRC_TEST_BENCH_LEN      (64 * 1024)
+#define CRC_TEST_BENCH_ROUNDS   8
+
+enum crc_test_bench_alg {
+    CRC_TEST_BENCH_CRC8,
+    CRC_TEST_BENCH_CRC16,
+    CRC_TEST_BENCH_CRC32,
+};
+
+static uint8_t crc_test_bench_buf[CRC_TEST_BENCH_LEN];
+
+/* Keeps the compiler from discarding the work. */
+static volatile uint32_t crc_test_bench_sink;
+
+/*
+ * @return                      Throughput, in KB/s.
+ */
+static uint32_t
+crc_test_bench_run(enum crc_test_bench_alg alg, int ref)
+{
+    uint32_t start;
+    uint32_t usecs;
+    uint32_t crc;
+    int i;
+
+    crc = 0;
+    start = os_cputime_get32();
+    for (i = 0; i < CRC_TEST_BENCH_ROUNDS; i++) {
+        switch (alg) {
+        case CRC_TEST_BENCH_CRC8:
+            crc += ref ?
+                crc_test_ref_crc8(crc, crc_test_bench_buf, CRC_TEST_BENCH_LEN) :
+                crc8_calc(crc, crc_test_bench_buf, CRC_TEST_BENCH_LEN);
+            break;
+
+        case CRC_TEST_BENCH_CRC16:
+            crc += ref ?
+                crc_test_ref_crc16(crc, crc_test_bench_buf,
+                                   CRC_TEST_BENCH_LEN) :
+                crc16_ccitt(crc, crc_test_bench_buf, CRC_TEST_BENCH_LEN);
+            break;
+
+        case CRC_TEST_BENCH_CRC32:
+            crc += ref ?
+                crc_test_ref_crc32(crc, crc_test_bench_buf,
+                                   CRC_TEST_BENCH_LEN) :
+                crc32_calc(crc, crc_test_bench_buf, CRC_TEST_BENCH_LEN);
+            break;
+        }
+    }
+    usecs = os_cputime_ticks_to_usecs(os_cputime_get32() - start);
+    crc_test_bench_sink = crc;
+
+    if (usecs == 0) {
+        usecs = 1;
+    }
+    return (uint64_t)CRC_TEST_BENCH_LEN * CRC_TEST_BENCH_ROUNDS * 1000000 /
+           1024 / usecs;
+}
+
+/*
+ * Reports the throughput of each CRC, as configured (CRC_SLICE, CRC_HW), and
+ * of its bit-at-a-time definition.
+ */
+TEST_CASE(crc_test_case_bench)
+{
+    static const char *names[] = { "crc8", "crc16", "crc32" };
+    uint32_t kbps;
+    uint32_t ref_kbps;
+    int alg;
+
+    crc_test_util_fill(crc_test_bench_buf, sizeof crc_test_bench_buf, 4);
+
+    for (alg = CRC_TEST_BENCH_CRC8; alg <= CRC_TEST_BENCH_CRC32; alg++) {
+        kbps = crc_test_bench_run(alg, 0);
+        ref_kbps = crc_test_bench_run(alg, 1);
+
+        printf("%s: %lu KB/s with CRC_SLICE=%d; %lu KB/s bitwise\n",
+               names[alg], (unsigned long)kbps, MYNEWT_VAL(CRC_SLICE),
+               (unsigned long)ref_kbps);
+
+        TEST_ASSERT(kbps > ref_kbps);
+    }
+}
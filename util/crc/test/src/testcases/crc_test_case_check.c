@@ -0,0 +1,56 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "crc/crc8.h"
+#include "crc/crc16.h"
+#include "crc/crc32.h"
+#include "crc_test.h"
+
+TEST_CASE(crc_test_case_check)
+{
+    static const char check[] = "123456789";
+    uint32_t crc32;
+    uint16_t crc16;
+    uint8_t crc8;
+
+    /* The standard check values: CRC-8, CRC-16/XMODEM and CRC-32. */
+    crc8 = crc8_calc(0, (void *)check, 9);
+    TEST_ASSERT(crc8 == 0xf4);
+
+    crc16 = crc16_ccitt(CRC16_INITIAL_CRC, check, 9);
+    TEST_ASSERT(crc16 == 0x31c3);
+
+    crc32 = crc32_calc(CRC32_INITIAL_CRC, check, 9);
+    TEST_ASSERT(crc32 == 0xcbf43926);
+
+    /* Continuing a CRC gives the same result as a single call. */
+    crc32 = crc32_calc(CRC32_INITIAL_CRC, check, 4);
+    crc32 = crc32_calc(crc32, check + 4, 5);
+    TEST_ASSERT(crc32 == 0xcbf43926);
+
+    crc16 = crc16_ccitt(CRC16_INITIAL_CRC, check, 5);
+    crc16 = crc16_ccitt(crc16, check + 5, 4);
+    TEST_ASSERT(crc16 == 0x31c3);
+
+    /* Empty buffers leave the CRC alone. */
+    TEST_ASSERT(crc32_calc(0x12345678, check, 0) == 0x12345678);
+    TEST_ASSERT(crc16_ccitt(0x1234, check, 0) == 0x1234);
+    TEST_ASSERT(crc8_calc(0x12, (void *)check, 0) == 0x12);
+}
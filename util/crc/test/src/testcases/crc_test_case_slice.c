@@ -0,0 +1,56 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "crc/crc8.h"
+#include "crc/crc16.h"
+#include "crc/crc32.h"
+#include "crc_test.h"
+
+/*
+ * Checks every length and alignment around the slice width against the
+ * bitwise definitions, so the bulk loop and the tail loop both get used.
+ */
+TEST_CASE(crc_test_case_slice)
+{
+    static uint8_t buf[256 + 8];
+    uint32_t crc32;
+    uint16_t crc16;
+    uint8_t crc8;
+    int align;
+    int len;
+
+    crc_test_util_fill(buf, sizeof buf, 1);
+
+    for (align = 0; align < 8; align++) {
+        for (len = 0; len <= 256; len++) {
+            crc8 = crc8_init();
+            TEST_ASSERT_FATAL(crc8_calc(crc8, buf + align, len) ==
+                              crc_test_ref_crc8(crc8, buf + align, len));
+
+            crc16 = len * 0x0101;
+            TEST_ASSERT_FATAL(crc16_ccitt(crc16, buf + align, len) ==
+                              crc_test_ref_crc16(crc16, buf + align, len));
+
+            crc32 = len * 0x01010101;
+            TEST_ASSERT_FATAL(crc32_calc(crc32, buf + align, len) ==
+                              crc_test_ref_crc32(crc32, buf + align, len));
+        }
+    }
+}
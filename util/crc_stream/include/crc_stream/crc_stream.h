@@ -0,0 +1,70 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_CRC_STREAM_
+#define H_CRC_STREAM_
+
+#include <inttypes.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct os_mbuf;
+
+/**
+ * @brief CRCs over mbuf chains and flash
+ *
+ * Each function continues a CRC from util/crc over data that is not in one
+ * contiguous buffer: part of an mbuf chain, checksummed in place, or a range
+ * of a flash device, read through a CRC_FLASH_BUF_SIZE stack buffer.  The
+ * first argument is the CRC so far (crc8_init(), CRC16_INITIAL_CRC or
+ * CRC32_INITIAL_CRC to start); on success, the updated CRC is written to
+ * out_crc.
+ *
+ * The *_mbuf() functions return 0 on success, SYS_EINVAL if the chain is
+ * shorter than off + len.  The *_flash() functions return 0 on success,
+ * SYS_EIO on a read failure.
+ * @{
+ */
+
+int crc8_mbuf(uint8_t val, const struct os_mbuf *om, int off, int len,
+              uint8_t *out_crc);
+int crc8_flash(uint8_t val, uint8_t flash_id, uint32_t addr, uint32_t len,
+               uint8_t *out_crc);
+
+int crc16_ccitt_mbuf(uint16_t initial_crc, const struct os_mbuf *om, int off,
+                     int len, uint16_t *out_crc);
+int crc16_ccitt_flash(uint16_t initial_crc, uint8_t flash_id, uint32_t addr,
+                      uint32_t len, uint16_t *out_crc);
+
+int crc32_mbuf(uint32_t crc, const struct os_mbuf *om, int off, int len,
+               uint32_t *out_crc);
+int crc32_flash(uint32_t crc, uint8_t flash_id, uint32_t addr, uint32_t len,
+                uint32_t *out_crc);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
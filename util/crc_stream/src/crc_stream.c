@@ -0,0 +1,174 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "hal/hal_flash.h"
+#include "crc/crc8.h"
+#include "crc/crc16.h"
+#include "crc/crc32.h"
+#include "crc_stream/crc_stream.h"
+
+typedef uint32_t crc_stream_update_fn(uint32_t crc, const void *buf, int len);
+
+static int
+crc_stream_mbuf(crc_stream_update_fn *update, uint32_t crc,
+                const struct os_mbuf *om, int off, int len, uint32_t *out_crc)
+{
+    uint16_t moff;
+    int chunk;
+
+    om = os_mbuf_off(om, off, &moff);
+    while (len > 0) {
+        if (om == NULL) {
+            return SYS_EINVAL;
+        }
+
+        chunk = om->om_len - moff;
+        if (chunk > len) {
+            chunk = len;
+        }
+        crc = update(crc, om->om_data + moff, chunk);
+        len -= chunk;
+
+        om = SLIST_NEXT(om, om_next);
+        moff = 0;
+    }
+
+    *out_crc = crc;
+    return 0;
+}
+
+static int
+crc_stream_flash(crc_stream_update_fn *update, uint32_t crc, uint8_t flash_id,
+                 uint32_t addr, uint32_t len, uint32_t *out_crc)
+{
+    uint8_t buf[MYNEWT_VAL(CRC_FLASH_BUF_SIZE)];
+    uint32_t chunk;
+    int rc;
+
+    while (len > 0) {
+        chunk = len;
+        if (chunk > sizeof(buf)) {
+            chunk = sizeof(buf);
+        }
+
+        rc = hal_flash_read(flash_id, addr, buf, chunk);
+        if (rc != 0) {
+            return SYS_EIO;
+        }
+        crc = update(crc, buf, chunk);
+
+        addr += chunk;
+        len -= chunk;
+    }
+
+    *out_crc = crc;
+    return 0;
+}
+
+static uint32_t
+crc_stream_crc8(uint32_t crc, const void *buf, int len)
+{
+    return crc8_calc(crc, (void *)buf, len);
+}
+
+static uint32_t
+crc_stream_crc16_ccitt(uint32_t crc, const void *buf, int len)
+{
+    return crc16_ccitt(crc, buf, len);
+}
+
+static uint32_t
+crc_stream_crc32(uint32_t crc, const void *buf, int len)
+{
+    return crc32_calc(crc, buf, len);
+}
+
+int
+crc8_mbuf(uint8_t val, const struct os_mbuf *om, int off, int len,
+          uint8_t *out_crc)
+{
+    uint32_t crc;
+    int rc;
+
+    rc = crc_stream_mbuf(crc_stream_crc8, val, om, off, len, &crc);
+    if (rc == 0) {
+        *out_crc = crc;
+    }
+    return rc;
+}
+
+int
+crc8_flash(uint8_t val, uint8_t flash_id, uint32_t addr, uint32_t len,
+           uint8_t *out_crc)
+{
+    uint32_t crc;
+    int rc;
+
+    rc = crc_stream_flash(crc_stream_crc8, val, flash_id, addr, len, &crc);
+    if (rc == 0) {
+        *out_crc = crc;
+    }
+    return rc;
+}
+
+int
+crc16_ccitt_mbuf(uint16_t initial_crc, const struct os_mbuf *om, int off,
+                 int len, uint16_t *out_crc)
+{
+    uint32_t crc;
+    int rc;
+
+    rc = crc_stream_mbuf(crc_stream_crc16_ccitt, initial_crc, om, off, len,
+                         &crc);
+    if (rc == 0) {
+        *out_crc = crc;
+    }
+    return rc;
+}
+
+int
+crc16_ccitt_flash(uint16_t initial_crc, uint8_t flash_id, uint32_t addr,
+                  uint32_t len, uint16_t *out_crc)
+{
+    uint32_t crc;
+    int rc;
+
+    rc = crc_stream_flash(crc_stream_crc16_ccitt, initial_crc, flash_id, addr,
+                          len, &crc);
+    if (rc == 0) {
+        *out_crc = crc;
+    }
+    return rc;
+}
+
+int
+crc32_mbuf(uint32_t crc, const struct os_mbuf *om, int off, int len,
+           uint32_t *out_crc)
+{
+    return crc_stream_mbuf(crc_stream_crc32, crc, om, off, len, out_crc);
+}
+
+int
+crc32_flash(uint32_t crc, uint8_t flash_id, uint32_t addr, uint32_t len,
+            uint32_t *out_crc)
+{
+    return crc_stream_flash(crc_stream_crc32, crc, flash_id, addr, len,
+                            out_crc);
+}
@@ -0,0 +1,75 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "flash_map/flash_map.h"
+#include "crc/crc8.h"
+#include "crc/crc16.h"
+#include "crc/crc32.h"
+#include "crc_stream/crc_stream.h"
+#include "crc_stream_test.h"
+
+#define CRC_STREAM_TEST_FLASH_LEN  3000
+
+TEST_CASE(crc_stream_test_case_flash)
+{
+    static uint8_t buf[CRC_STREAM_TEST_FLASH_LEN];
+    const struct flash_area *fa;
+    uint32_t crc32;
+    uint16_t crc16;
+    uint8_t crc8;
+    uint32_t addr;
+    int off;
+    int len;
+    int rc;
+
+    crc_stream_test_util_fill(buf, sizeof buf, 3);
+
+    rc = flash_area_open(FLASH_AREA_IMAGE_1, &fa);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = flash_area_erase(fa, 0, sizeof buf);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = flash_area_write(fa, 0, buf, sizeof buf);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /* Lengths either side of the read buffer size. */
+    for (off = 0; off < 200; off += 67) {
+        for (len = 0; len < sizeof buf - off; len += len / 2 + 1) {
+            addr = fa->fa_off + off;
+
+            rc = crc8_flash(crc8_init(), fa->fa_device_id, addr, len, &crc8);
+            TEST_ASSERT(rc == 0);
+            TEST_ASSERT(crc8 == crc8_calc(crc8_init(), buf + off, len));
+
+            rc = crc16_ccitt_flash(CRC16_INITIAL_CRC, fa->fa_device_id, addr,
+                                   len, &crc16);
+            TEST_ASSERT(rc == 0);
+            TEST_ASSERT(crc16 ==
+                        crc16_ccitt(CRC16_INITIAL_CRC, buf + off, len));
+
+            rc = crc32_flash(CRC32_INITIAL_CRC, fa->fa_device_id, addr, len,
+                             &crc32);
+            TEST_ASSERT(rc == 0);
+            TEST_ASSERT(crc32 ==
+                        crc32_calc(CRC32_INITIAL_CRC, buf + off, len));
+        }
+    }
+
+    flash_area_close(fa);
+}
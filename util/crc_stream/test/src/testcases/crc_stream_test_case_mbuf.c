@@ -0,0 +1,73 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "crc/crc8.h"
+#include "crc/crc16.h"
+#include "crc/crc32.h"
+#include "crc_stream/crc_stream.h"
+#include "crc_stream_test.h"
+
+#define CRC_STREAM_TEST_MBUF_LEN   1000
+
+TEST_CASE(crc_stream_test_case_mbuf)
+{
+    static uint8_t buf[CRC_STREAM_TEST_MBUF_LEN];
+    struct os_mbuf *om;
+    uint32_t crc32;
+    uint16_t crc16;
+    uint8_t crc8;
+    int off;
+    int len;
+    int rc;
+
+    crc_stream_test_util_fill(buf, sizeof buf, 2);
+
+    /* Build the chain in small, uneven pieces so it spans many mbufs. */
+    om = os_msys_get_pkthdr(0, 0);
+    TEST_ASSERT_FATAL(om != NULL);
+    for (off = 0; off < sizeof buf; off += len) {
+        len = min(sizeof buf - off, 37);
+        rc = os_mbuf_append(om, buf + off, len);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+    TEST_ASSERT_FATAL(SLIST_NEXT(om, om_next) != NULL);
+
+    for (off = 0; off < sizeof buf; off += 97) {
+        len = sizeof buf - off - off / 3;
+
+        rc = crc8_mbuf(crc8_init(), om, off, len, &crc8);
+        TEST_ASSERT(rc == 0);
+        TEST_ASSERT(crc8 == crc8_calc(crc8_init(), buf + off, len));
+
+        rc = crc16_ccitt_mbuf(CRC16_INITIAL_CRC, om, off, len, &crc16);
+        TEST_ASSERT(rc == 0);
+        TEST_ASSERT(crc16 == crc16_ccitt(CRC16_INITIAL_CRC, buf + off, len));
+
+        rc = crc32_mbuf(CRC32_INITIAL_CRC, om, off, len, &crc32);
+        TEST_ASSERT(rc == 0);
+        TEST_ASSERT(crc32 == crc32_calc(CRC32_INITIAL_CRC, buf + off, len));
+    }
+
+    /* Running off the end of the chain is an error. */
+    rc = crc32_mbuf(CRC32_INITIAL_CRC, om, 10, sizeof buf, &crc32);
+    TEST_ASSERT(rc == SYS_EINVAL);
+
+    os_mbuf_free_chain(om);
+}